@@ -0,0 +1,90 @@
+#include "perf-report.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <liquid/codec.h>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Runs a function repeatedly and reports its throughput and
+ *        hardware counters.
+ *
+ * @param name The name of the measurement.
+ * @param count The number of values the function processes.
+ * @param run The function.
+ */
+template <typename F>
+static void
+measure(const char *name, usize_t count, F run)
+{
+    const int rounds = 20;
+    run();
+
+    perf_sample_t counters = perf_report_start();
+    auto          start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i)
+    {
+        run();
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    double values = (double)count * rounds / elapsed.count();
+    std::printf("%-28s %8.0f M values/s %8.2f GB/s of raw values", name,
+                values / 1e6, values * sizeof(uint_t) / 1e9);
+    perf_report_end(counters, (double)count * rounds * sizeof(uint_t));
+}
+
+/**
+ * @brief Measures the codecs on sorted ids and on raw copies for
+ *        comparison.
+ */
+int
+main()
+{
+    const usize_t       count = 1u << 24;
+    std::vector<uint_t> ids(count);
+    std::mt19937_64     rng(1);
+    uint_t              id = 0;
+    for (uint_t &value : ids)
+    {
+        id += 1 + (uint_t)(rng() % 32);
+        value = id;
+    }
+
+    std::vector<uint_t> deltas(count);
+    std::vector<uint_t> decoded(count);
+    std::vector<uint_t> encoded(codec_for_bound(count));
+    codec_delta_encode(deltas.data(), ids.data(), count, 0);
+    uint_t *end = codec_for_encode(encoded.data(), deltas.data(), count);
+    std::printf("%zu ids packed into %.2f bits each\n", (size_t)count,
+                32.0 * (double)(end - encoded.data()) / (double)count);
+
+    measure("memcpy", count, [&] {
+        std::memcpy(decoded.data(), ids.data(), count * sizeof(uint_t));
+    });
+    measure("delta encode", count, [&] {
+        codec_delta_encode(deltas.data(), ids.data(), count, 0);
+    });
+    measure("delta decode", count, [&] {
+        codec_delta_decode(decoded.data(), deltas.data(), count, 0);
+    });
+    measure("frame-of-reference encode", count, [&] {
+        codec_for_encode(encoded.data(), deltas.data(), count);
+    });
+    measure("frame-of-reference decode", count, [&] {
+        codec_for_decode(decoded.data(), encoded.data(), end, count);
+    });
+    measure("decode and prefix sum", count, [&] {
+        codec_for_decode(decoded.data(), encoded.data(), end, count);
+        codec_delta_decode(decoded.data(), decoded.data(), count, 0);
+    });
+    measure("fused delta encode", count, [&] {
+        codec_for_delta_encode(encoded.data(), ids.data(), count, 0);
+    });
+    measure("fused delta decode", count, [&] {
+        codec_for_delta_decode(decoded.data(), encoded.data(), end, count, 0);
+    });
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <liquid/fs-watch.h>
+#include <string>
+#include <vector>
+
+#if defined(LIQUID_TARGET_OS_POSIX_LIKE)
+    #include <ftw.h>
+    #include <sys/stat.h>
+
+/**
+ * @def DIRECTORIES
+ * @brief The directories of the tree.
+ */
+    #define DIRECTORIES 200
+
+/**
+ * @def FILES
+ * @brief The files in each directory of the tree.
+ */
+    #define FILES 100
+
+/**
+ * @def CHANGES
+ * @brief The changes whose delivery is timed.
+ */
+    #define CHANGES 50
+
+/**
+ * @def DEBOUNCE
+ * @brief The debounce time of the watcher in milliseconds.
+ */
+    #define DEBOUNCE 10
+
+/**
+ * @brief Removes a file or an empty directory.
+ * @return Zero to go on.
+ */
+static int
+remove_entry(const char *path, const struct stat *, int, struct FTW *)
+{
+    return remove(path);
+}
+
+/**
+ * @brief Counts the batches delivered to the watcher.
+ * @param watch The watcher.
+ * @param changes The changes.
+ * @param count The number of changes.
+ */
+static void
+on_changes(fs_watch_t *watch, const fs_watch_change_t *changes,
+           usize_t count)
+{
+    (void)changes;
+    (void)count;
+    ++*static_cast<usize_t *>(watch->data);
+}
+
+/**
+ * @brief Compares polling a tree with stat to watching it for changes.
+ */
+int
+main()
+{
+    char name[] = "/tmp/liquid-bench-XXXXXX";
+    if (!mkdtemp(name))
+    {
+        std::perror("mkdtemp");
+        return EXIT_FAILURE;
+    }
+    std::string              root = name;
+    std::vector<std::string> files;
+    for (usize_t i = 0; i < DIRECTORIES; ++i)
+    {
+        std::string directory = root + "/" + std::to_string(i);
+        mkdir(directory.c_str(), 0700);
+        for (usize_t j = 0; j < FILES; ++j)
+        {
+            files.push_back(directory + "/" + std::to_string(j));
+            FILE *file = std::fopen(files.back().c_str(), "w");
+            if (file)
+            {
+                std::fclose(file);
+            }
+        }
+    }
+
+    // Polling pays for every file on every pass, changed or not.
+    struct stat status;
+    auto        start = std::chrono::steady_clock::now();
+    for (const std::string &file : files)
+    {
+        stat(file.c_str(), &status);
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::printf("%-24s %8zu files %8.2f ms per pass\n", "stat poll",
+                files.size(), elapsed.count() * 1e3);
+
+    event_loop_t loop;
+    fs_watch_t   watch;
+    usize_t      batches = 0;
+    bool         looping = event_loop_init(&loop, nullptr);
+    bool         watching = looping
+                    && fs_watch_init(&watch, &loop, on_changes, DEBOUNCE);
+    bool         ok = watching;
+    if (ok)
+    {
+        watch.data = &batches;
+        start = std::chrono::steady_clock::now();
+        ok = fs_watch_add(&watch, root.c_str(), FS_WATCH_RECURSIVE);
+        elapsed = std::chrono::steady_clock::now() - start;
+        std::printf("%-24s %8zu files %8.2f ms to watch\n", "fs_watch_add",
+                    files.size(), elapsed.count() * 1e3);
+    }
+
+    // The watcher costs nothing while idle, a change is delivered once the
+    // debounce time has passed.
+    start = std::chrono::steady_clock::now();
+    for (usize_t i = 0; ok && i < CHANGES; ++i)
+    {
+        FILE *file = std::fopen(files[i * 97 % files.size()].c_str(), "a");
+        ok = file && std::fputs("change", file) >= 0;
+        if (file)
+        {
+            std::fclose(file);
+        }
+        for (usize_t seen = batches; ok && batches == seen;)
+        {
+            ok = event_loop_run_once(&loop, EVENT_INFINITE);
+        }
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    if (ok)
+    {
+        std::printf("%-24s %8d ms wait  %8.2f ms per change\n", "fs_watch",
+                    DEBOUNCE, elapsed.count() / CHANGES * 1e3);
+    }
+    else
+    {
+        std::perror("fs_watch");
+    }
+
+    if (watching)
+    {
+        fs_watch_free(&watch);
+    }
+    if (looping)
+    {
+        event_loop_free(&loop);
+    }
+    nftw(root.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+#else
+int
+main()
+{
+    return EXIT_SUCCESS;
+}
+#endif
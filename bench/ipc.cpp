@@ -0,0 +1,158 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <liquid/ipc.h>
+#include <thread>
+
+/**
+ * @def PAYLOAD_SIZE
+ * @brief The size of the messages, typical of telemetry.
+ */
+#define PAYLOAD_SIZE 64
+
+/**
+ * @def MESSAGES
+ * @brief The messages passed by each measurement.
+ */
+#define MESSAGES 2000000
+
+/**
+ * @brief Streams messages from a producer thread to the consumer, writing
+ *        and reading them in place.
+ *
+ * @param name The name of the measurement.
+ * @param ring The name of the ring.
+ * @param flags The flags of the ring.
+ * @return True on success, false if a ring could not be opened.
+ */
+static bool
+throughput(const char *name, const char *ring, uint_t flags)
+{
+    ipc_ring_t consumer;
+    ipc_shm_remove(ring);
+    if (!ipc_ring_create(&consumer, ring, 1 << 20, flags))
+    {
+        return false;
+    }
+
+    auto        start = std::chrono::steady_clock::now();
+    std::thread producer(
+        [ring]
+        {
+            ipc_ring_t producer;
+            if (!ipc_ring_open(&producer, ring))
+            {
+                return;
+            }
+            for (usize_t i = 0; i < MESSAGES; ++i)
+            {
+                void *message =
+                    ipc_ring_reserve(&producer, PAYLOAD_SIZE, IPC_INFINITE);
+                std::memset(message, (int)i, PAYLOAD_SIZE);
+                ipc_ring_commit(&producer, message);
+            }
+            ipc_ring_close(&producer);
+        });
+
+    ullong_t sum = 0;
+    for (usize_t i = 0; i < MESSAGES; ++i)
+    {
+        usize_t        size;
+        const uchar_t *message =
+            (const uchar_t *)ipc_ring_peek(&consumer, &size, 5000);
+        if (!message)
+        {
+            break;
+        }
+        sum += message[size - 1];
+        ipc_ring_release(&consumer);
+    }
+    producer.join();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    std::printf("%-24s %8.2f Mmessages/s %8.2f GB/s (%llu)\n", name,
+                MESSAGES / elapsed.count() / 1e6,
+                (double)MESSAGES * PAYLOAD_SIZE / elapsed.count() / 1e9, sum);
+    ipc_ring_close(&consumer);
+    ipc_shm_remove(ring);
+    return true;
+}
+
+/**
+ * @brief Bounces a message between two threads over a ring each way,
+ *        reporting the round trip.
+ *
+ * @param name The name of the measurement.
+ * @return True on success, false if a ring could not be opened.
+ */
+static bool
+latency(const char *name)
+{
+    const usize_t rounds = MESSAGES / 10;
+
+    ipc_ring_t ping, pong;
+    ipc_shm_remove("liquid_bench_ping");
+    ipc_shm_remove("liquid_bench_pong");
+    if (!ipc_ring_create(&ping, "liquid_bench_ping", 4096,
+                         IPC_SINGLE_PRODUCER)
+        || !ipc_ring_create(&pong, "liquid_bench_pong", 4096,
+                            IPC_SINGLE_PRODUCER))
+    {
+        return false;
+    }
+
+    std::thread echo(
+        [&ping, &pong, rounds]
+        {
+            char    message[PAYLOAD_SIZE];
+            usize_t size;
+            for (usize_t i = 0; i < rounds; ++i)
+            {
+                ipc_ring_receive(&ping, message, sizeof(message), &size,
+                                 IPC_INFINITE);
+                ipc_ring_send(&pong, message, size, IPC_INFINITE);
+            }
+        });
+
+    char    message[PAYLOAD_SIZE] = {0};
+    usize_t size;
+    auto    start = std::chrono::steady_clock::now();
+    for (usize_t i = 0; i < rounds; ++i)
+    {
+        ipc_ring_send(&ping, message, sizeof(message), IPC_INFINITE);
+        ipc_ring_receive(&pong, message, sizeof(message), &size,
+                         IPC_INFINITE);
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    echo.join();
+
+    std::printf("%-24s %8.0f ns round trip\n", name,
+                elapsed.count() / rounds * 1e9);
+    ipc_ring_close(&ping);
+    ipc_ring_close(&pong);
+    ipc_shm_remove("liquid_bench_ping");
+    ipc_shm_remove("liquid_bench_pong");
+    return true;
+}
+
+/**
+ * @brief Measures the throughput of a ring with one producer, with and
+ *        without IPC_SINGLE_PRODUCER, and the round trip between two
+ *        threads.
+ */
+int
+main()
+{
+    bool ok = throughput("ipc_ring mpsc", "liquid_bench_mpsc", 0)
+              && throughput("ipc_ring spsc", "liquid_bench_spsc",
+                            IPC_SINGLE_PRODUCER)
+              && latency("ipc_ring round trip");
+    if (!ok)
+    {
+        std::perror("ipc_ring");
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
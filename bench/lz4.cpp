@@ -0,0 +1,105 @@
+#include "perf-report.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <liquid/lz4.h>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Runs a function repeatedly and reports its throughput and
+ *        hardware counters.
+ *
+ * @param name The name of the measurement.
+ * @param size The number of bytes the function processes.
+ * @param rounds The number of runs to time.
+ * @param run The function.
+ */
+template <typename F>
+static void
+measure(const char *name, usize_t size, int rounds, F run)
+{
+    run();
+
+    perf_sample_t counters = perf_report_start();
+    auto          start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i)
+    {
+        run();
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    std::printf("%-28s %8.0f MB/s", name,
+                (double)size * rounds / elapsed.count() / 1e6);
+    perf_report_end(counters, (double)size * rounds);
+}
+
+/**
+ * @brief Generates log-like text.
+ * @param size The size of the text.
+ * @return The text.
+ */
+static std::vector<uchar_t>
+make_log(usize_t size)
+{
+    static const char *const levels[] = {"INFO", "WARN", "DEBUG", "ERROR"};
+    static const char *const events[] = {"request served", "cache miss",
+                                         "connection closed",
+                                         "retrying upload", "user logged in"};
+
+    std::mt19937         rng(5);
+    std::vector<uchar_t> text;
+    char                 line[128];
+    for (uint_t second = 0; text.size() < size; second += rng() % 3)
+    {
+        int length = std::snprintf(
+            line, sizeof(line),
+            "2024-05-01 12:%02u:%02u %s [worker-%u] %s id=%u latency=%ums\n",
+            second / 60 % 60, second % 60, levels[rng() % 4],
+            (unsigned)(rng() % 16), events[rng() % 5],
+            (unsigned)(rng() % 100000), (unsigned)(rng() % 500));
+        text.insert(text.end(), line, line + length);
+    }
+    text.resize(size);
+    return text;
+}
+
+/**
+ * @brief Measures compression and decompression of text at several levels.
+ */
+int
+main()
+{
+    const usize_t        size = 16u << 20;
+    std::vector<uchar_t> text = make_log(size);
+    std::vector<uchar_t> packed(lz4_frame_bound(size));
+    std::vector<uchar_t> unpacked(size);
+
+    for (uint_t level : {1u, 3u, 6u, 9u})
+    {
+        lz4_state_t state;
+        if (!lz4_init(&state, level, nullptr))
+        {
+            return EXIT_FAILURE;
+        }
+
+        uchar_t *end = nullptr;
+        char     name[64];
+        std::snprintf(name, sizeof(name), "level %u compress", level);
+        measure(name, size, level == 1 ? 10 : 2, [&] {
+            end = lz4_frame_compress(&state, packed.data(),
+                                     packed.data() + packed.size(),
+                                     text.data(), text.data() + size);
+        });
+        std::snprintf(name, sizeof(name), "level %u decompress", level);
+        measure(name, size, 10, [&] {
+            lz4_frame_decompress(unpacked.data(), unpacked.data() + size,
+                                 packed.data(), end, nullptr);
+        });
+        std::printf("%-28s %8.3f\n", "ratio",
+                    (double)size / (double)(end - packed.data()));
+        lz4_free(&state);
+    }
+    return EXIT_SUCCESS;
+}
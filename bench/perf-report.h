@@ -0,0 +1,89 @@
+/**
+ * @file perf-report.h
+ * @brief Hardware counters around the measurements of the benchmarks.
+ *
+ * The counters tell kernels bound by memory, with a low IPC and many cache
+ * misses per byte, from kernels bound by computation. Where they cannot
+ * be opened the measurements report their time only.
+ */
+
+#ifndef LIQUID_BENCH_PERF_REPORT_H
+#define LIQUID_BENCH_PERF_REPORT_H
+
+#include <cstdio>
+#include <liquid/perf.h>
+
+/**
+ * @brief Opens the counters of the benchmark once.
+ * @return The group, which stays open until the process exits.
+ */
+static inline perf_t *
+perf_report_group()
+{
+    static perf_t group;
+    static bool   opened = [] {
+        bool ok = perf_open(&group);
+        if (!ok)
+        {
+            std::printf("no hardware counters, reporting time only\n");
+        }
+        return ok;
+    }();
+    (void)opened;
+    return &group;
+}
+
+/**
+ * @brief Reads the counters at the start of a measurement.
+ * @return The sample.
+ */
+static inline perf_sample_t
+perf_report_start()
+{
+    perf_sample_t start;
+    perf_read(perf_report_group(), &start);
+    return start;
+}
+
+/**
+ * @brief Ends the line of a measurement with the IPC and the misses per
+ *        unit of work.
+ *
+ * @param start The sample at the start of the measurement.
+ * @param units The units of work done by the measurement.
+ * @param unit The name of the unit.
+ */
+static inline void
+perf_report_end_per(const perf_sample_t &start, double units,
+                    const char *unit)
+{
+    perf_sample_t end, delta;
+    perf_read(perf_report_group(), &end);
+    perf_sample_delta(&start, &end, &delta);
+    if (!delta.valid)
+    {
+        std::printf("\n");
+        return;
+    }
+
+    std::printf("  IPC %4.2f  misses/%s cache %7.3f branch %7.3f dTLB %7.3f\n",
+                perf_ipc(&delta), unit,
+                perf_per_unit(&delta, PERF_CACHE_MISSES, units),
+                perf_per_unit(&delta, PERF_BRANCH_MISSES, units),
+                perf_per_unit(&delta, PERF_DTLB_MISSES, units));
+}
+
+/**
+ * @brief Ends the line of a measurement with the IPC and the misses per
+ *        KB processed.
+ *
+ * @param start The sample at the start of the measurement.
+ * @param bytes The bytes processed by the measurement.
+ */
+static inline void
+perf_report_end(const perf_sample_t &start, double bytes)
+{
+    perf_report_end_per(start, bytes / 1024, "KB");
+}
+
+#endif // LIQUID_BENCH_PERF_REPORT_H
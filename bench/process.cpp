@@ -0,0 +1,122 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <liquid/process.h>
+#include <vector>
+
+#if defined(LIQUID_TARGET_OS_POSIX_LIKE)
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+/**
+ * @def SPAWNS
+ * @brief The children started by each measurement.
+ */
+#define SPAWNS 200
+
+/**
+ * @brief Starts children that exit at once and waits for each of them.
+ *
+ * @param name The name of the measurement.
+ * @param footprint The megabytes of memory the parent has touched.
+ * @return True on success, false if a child could not be started.
+ */
+static bool
+measure_spawn(const char *name, usize_t footprint)
+{
+    const char_t     *argv[] = {"true", nullptr};
+    process_options_t options = {
+        argv, nullptr, nullptr, {PROCESS_NULL, PROCESS_NULL, PROCESS_NULL},
+        0};
+
+    auto start = std::chrono::steady_clock::now();
+    for (usize_t i = 0; i < SPAWNS; ++i)
+    {
+        process_t process;
+        if (!process_spawn(&process, &options)
+            || !process_wait(&process, -1))
+        {
+            return false;
+        }
+        process_close(&process);
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::printf("%-24s %6zu MB %8.1f us per child\n", name, (size_t)footprint,
+                elapsed.count() / SPAWNS * 1e6);
+    return true;
+}
+
+#if defined(LIQUID_TARGET_OS_POSIX_LIKE)
+/**
+ * @brief Starts children with fork and execvp, which copies the page
+ *        tables of the parent, for comparison.
+ *
+ * @param name The name of the measurement.
+ * @param footprint The megabytes of memory the parent has touched.
+ * @return True on success, false if a child could not be started.
+ */
+static bool
+measure_fork(const char *name, usize_t footprint)
+{
+    char *argv[] = {const_cast<char *>("true"), nullptr};
+
+    auto start = std::chrono::steady_clock::now();
+    for (usize_t i = 0; i < SPAWNS; ++i)
+    {
+        pid_t id = fork();
+        if (id < 0)
+        {
+            return false;
+        }
+        if (!id)
+        {
+            execvp(argv[0], argv);
+            _exit(127);
+        }
+        waitpid(id, nullptr, 0);
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::printf("%-24s %6zu MB %8.1f us per child\n", name, (size_t)footprint,
+                elapsed.count() / SPAWNS * 1e6);
+    return true;
+}
+#endif
+
+/**
+ * @brief Measures the cost of starting a child as the memory of the parent
+ *        grows, with process_spawn and with fork.
+ */
+int
+main()
+{
+    std::vector<char *> blocks;
+    usize_t             footprint = 0;
+    bool                ok = true;
+    for (usize_t target : {0, 256, 1024})
+    {
+        // The memory is touched so that it is mapped in the page tables.
+        for (; footprint < target; ++footprint)
+        {
+            char *block = static_cast<char *>(std::malloc(1 << 20));
+            std::memset(block, 1, 1 << 20);
+            blocks.push_back(block);
+        }
+        ok = ok && measure_spawn("process_spawn", footprint);
+#if defined(LIQUID_TARGET_OS_POSIX_LIKE)
+        ok = ok && measure_fork("fork/exec", footprint);
+#endif
+    }
+    for (char *block : blocks)
+    {
+        std::free(block);
+    }
+    if (!ok)
+    {
+        std::perror("spawn");
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,129 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <liquid/socket.h>
+#include <vector>
+
+/**
+ * @def PAYLOAD_SIZE
+ * @brief The size of the datagrams, typical of telemetry.
+ */
+#define PAYLOAD_SIZE 64
+
+/**
+ * @brief Sends bursts of datagrams over loopback and receives them,
+ *        reporting the throughput of sending and of receiving apart.
+ *
+ * @param name The name of the measurement.
+ * @param receiver The receiving socket.
+ * @param sender The sending socket.
+ * @param out The messages of a burst to send.
+ * @param in The messages to receive a burst into.
+ * @param batched Whether the burst goes through the batch functions.
+ * @return True on success, false if a socket call failed.
+ */
+static bool
+measure(const char *name, socket_handle_t receiver, socket_handle_t sender,
+        std::vector<socket_message_t> &out, std::vector<socket_message_t> &in,
+        bool batched)
+{
+    const usize_t rounds = 20000;
+    const usize_t burst = out.size();
+
+    std::chrono::duration<double> sending(0), receiving(0);
+    for (usize_t round = 0; round < rounds; ++round)
+    {
+        auto    start = std::chrono::steady_clock::now();
+        usize_t done = 0;
+        if (batched)
+        {
+            if (!socket_send_batch(sender, out.data(), burst, 0, &done)
+                || done != burst)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            for (socket_message_t &message : out)
+            {
+                if (!socket_send(sender, &message, 0))
+                {
+                    return false;
+                }
+            }
+        }
+
+        // Loopback delivers synchronously, so the burst is there.
+        auto middle = std::chrono::steady_clock::now();
+        sending += middle - start;
+        done = 0;
+        while (done < burst)
+        {
+            usize_t received = 0;
+            if (batched)
+            {
+                if (!socket_recv_batch(receiver, &in[done],
+                                       burst - done, &received))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                if (!socket_recv(receiver, &in[done]))
+                {
+                    return false;
+                }
+                received = 1;
+            }
+            done += received;
+        }
+        receiving += std::chrono::steady_clock::now() - middle;
+    }
+
+    std::printf("%-24s send %8.2f recv %8.2f Mpackets/s\n", name,
+                (double)(rounds * burst) / sending.count() / 1e6,
+                (double)(rounds * burst) / receiving.count() / 1e6);
+    return true;
+}
+
+/**
+ * @brief Measures UDP over loopback with a system call per datagram and
+ *        with batches of SOCKET_BATCH datagrams.
+ */
+int
+main()
+{
+    socket_address_t address;
+    socket_handle_t  receiver, sender;
+    if (!socket_address_ip(&address, "127.0.0.1", 0)
+        || !socket_open(&receiver, &address, SOCKET_DATAGRAM)
+        || !socket_bind(receiver, &address, 0)
+        || !socket_local_address(receiver, &address)
+        || !socket_set_buffer_sizes(receiver, 4 << 20, 0)
+        || !socket_open(&sender, &address, SOCKET_DATAGRAM))
+    {
+        std::perror("socket");
+        return EXIT_FAILURE;
+    }
+
+    static char                   payload[SOCKET_BATCH][PAYLOAD_SIZE];
+    std::vector<socket_buffer_t>  buffers(SOCKET_BATCH);
+    std::vector<socket_message_t> out(SOCKET_BATCH);
+    std::vector<socket_message_t> in(SOCKET_BATCH);
+    for (usize_t i = 0; i < SOCKET_BATCH; ++i)
+    {
+        buffers[i].data = payload[i];
+        buffers[i].size = PAYLOAD_SIZE;
+        out[i] = {&buffers[i], 1, &address, 0, 0};
+        in[i] = {&buffers[i], 1, nullptr, 0, 0};
+    }
+
+    bool ok = measure("socket_send/recv", receiver, sender, out, in, false)
+              && measure("socket_send/recv_batch", receiver, sender, out, in,
+                         true);
+    socket_close(receiver);
+    socket_close(sender);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,166 @@
+#include "perf-report.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <liquid/sort.h>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Runs a function repeatedly and reports its throughput and
+ *        hardware counters.
+ *
+ * @param name The name of the measurement.
+ * @param count The number of keys the function processes.
+ * @param size The size of a key in bytes.
+ * @param rounds The number of runs to time.
+ * @param run The function.
+ */
+template <typename F>
+static void
+measure(const char *name, usize_t count, usize_t size, int rounds, F run)
+{
+    run();
+
+    perf_sample_t counters = perf_report_start();
+    auto          start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i)
+    {
+        run();
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    std::printf("%-32s %8.1f Mkeys/s", name,
+                (double)count * rounds / elapsed.count() / 1e6);
+    perf_report_end(counters, (double)count * rounds * size);
+}
+
+/**
+ * @brief Compares two 64-bit keys for qsort.
+ * @param a The first key.
+ * @param b The second key.
+ * @return The order of the keys.
+ */
+static int
+compare_ullong(const void *a, const void *b)
+{
+    ullong_t x = *(const ullong_t *)a;
+    ullong_t y = *(const ullong_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Measures the sorts of random 64-bit keys against qsort and
+ *        std::sort, and the searches against std::lower_bound.
+ *
+ * Each sort run includes copying the unsorted keys into place.
+ */
+int
+main()
+{
+    const usize_t         count = 1u << 24;
+    std::mt19937_64       rng(7);
+    std::vector<ullong_t> keys(count);
+    for (ullong_t &key : keys)
+    {
+        key = rng();
+    }
+    std::vector<ullong_t> work(count);
+    std::vector<ullong_t> scratch(count);
+
+    measure("qsort", count, sizeof(ullong_t), 2,
+            [&]
+            {
+                work = keys;
+                std::qsort(work.data(), count, sizeof(ullong_t),
+                           compare_ullong);
+            });
+    measure("std::sort", count, sizeof(ullong_t), 2,
+            [&]
+            {
+                work = keys;
+                std::sort(work.begin(), work.end());
+            });
+    measure("sort_ullong", count, sizeof(ullong_t), 2,
+            [&]
+            {
+                work = keys;
+                sort_ullong(work.data(), count);
+            });
+    measure("sort_radix_ullong in place", count, sizeof(ullong_t), 2,
+            [&]
+            {
+                work = keys;
+                sort_radix_ullong(work.data(), count, nullptr);
+            });
+    measure("sort_radix_ullong with scratch", count, sizeof(ullong_t), 2,
+            [&]
+            {
+                work = keys;
+                sort_radix_ullong(work.data(), count, scratch.data());
+            });
+
+    std::vector<uint_t> narrow(count);
+    std::vector<uint_t> narrow_work(count);
+    std::vector<uint_t> narrow_scratch(count);
+    for (uint_t &key : narrow)
+    {
+        key = (uint_t)rng();
+    }
+    measure("sort_uint", count, sizeof(uint_t), 2,
+            [&]
+            {
+                narrow_work = narrow;
+                sort_uint(narrow_work.data(), count);
+            });
+    measure("sort_radix_uint with scratch", count, sizeof(uint_t), 2,
+            [&]
+            {
+                narrow_work = narrow;
+                sort_radix_uint(narrow_work.data(), count,
+                                narrow_scratch.data());
+            });
+
+    // Search the sorted keys in random order, beyond the caches.
+    std::vector<uint_t> layout(count);
+    std::vector<uint_t> probes(1u << 22);
+    sort_eytzinger_uint(layout.data(), narrow_work.data(), count);
+    for (uint_t &probe : probes)
+    {
+        probe = (uint_t)rng();
+    }
+
+    usize_t sum = 0;
+    measure("std::lower_bound", probes.size(), sizeof(uint_t), 3,
+            [&]
+            {
+                for (uint_t probe : probes)
+                {
+                    sum += std::lower_bound(narrow_work.begin(),
+                                            narrow_work.end(), probe)
+                           - narrow_work.begin();
+                }
+            });
+    measure("sort_lower_bound_uint", probes.size(), sizeof(uint_t), 3,
+            [&]
+            {
+                for (uint_t probe : probes)
+                {
+                    sum += sort_lower_bound_uint(narrow_work.data(), count,
+                                                 probe);
+                }
+            });
+    measure("sort_eytzinger_lower_bound_uint", probes.size(), sizeof(uint_t), 3,
+            [&]
+            {
+                for (uint_t probe : probes)
+                {
+                    sum += sort_eytzinger_lower_bound_uint(layout.data(),
+                                                           count, probe);
+                }
+            });
+
+    return sum ? EXIT_SUCCESS : EXIT_FAILURE;
+}
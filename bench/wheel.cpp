@@ -0,0 +1,139 @@
+#include "perf-report.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <liquid/wheel.h>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+/**
+ * @def TIMER_COUNT
+ * @brief The number of timers, as many as the connections of a busy server.
+ */
+#define TIMER_COUNT 1000000
+
+/**
+ * @brief Counts an expiry.
+ * @param wheel The wheel, its data points to the counter.
+ * @param timer The timer.
+ */
+static void
+on_timer(wheel_t *wheel, wheel_timer_t *timer)
+{
+    (void)timer;
+    ++*static_cast<usize_t *>(wheel->data);
+}
+
+/**
+ * @brief Prints the rate and the hardware counters of a measurement.
+ *
+ * @param name The name of the measurement.
+ * @param count The number of operations.
+ * @param start The time the measurement started.
+ * @param counters The counters when the measurement started.
+ */
+static void
+report(const char *name, usize_t count,
+       std::chrono::steady_clock::time_point start,
+       const perf_sample_t &counters)
+{
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::printf("%-24s %8.2f Mops/s", name,
+                (double)count / elapsed.count() / 1e6);
+    perf_report_end_per(counters, (double)count, "op");
+}
+
+/**
+ * @brief Starts timeouts of up to a minute in milliseconds, restarts each
+ *        of them as traffic would, then lets a minute pass, with the wheel
+ *        and with a binary heap that leaves restarted entries stale.
+ */
+int
+main()
+{
+    std::mt19937_64       rng(44);
+    std::vector<ullong_t> timeouts(TIMER_COUNT);
+    for (ullong_t &timeout : timeouts)
+    {
+        timeout = rng() % 60000 + 1;
+    }
+
+    usize_t expired = 0;
+    wheel_t wheel;
+    wheel_init(&wheel, nullptr, 0);
+    wheel.data = &expired;
+    std::vector<wheel_timer_t> timers(TIMER_COUNT);
+
+    perf_sample_t counters = perf_report_start();
+    auto          start = std::chrono::steady_clock::now();
+    for (usize_t i = 0; i < TIMER_COUNT; ++i)
+    {
+        wheel_timer_init(&timers[i], on_timer, nullptr);
+        wheel_timer_start(&wheel, &timers[i], timeouts[i]);
+    }
+    report("wheel start", TIMER_COUNT, start, counters);
+
+    counters = perf_report_start();
+    start = std::chrono::steady_clock::now();
+    for (usize_t i = 0; i < TIMER_COUNT; ++i)
+    {
+        wheel_timer_start(&wheel, &timers[i], timeouts[TIMER_COUNT - 1 - i]);
+    }
+    report("wheel restart", TIMER_COUNT, start, counters);
+
+    counters = perf_report_start();
+    start = std::chrono::steady_clock::now();
+    for (ullong_t now = 1; now <= 60000; ++now)
+    {
+        wheel_advance(&wheel, now);
+    }
+    report("wheel expire", expired, start, counters);
+    wheel_free(&wheel);
+
+    // The heap cannot find an entry to move it, so a restart pushes a new
+    // one and the expiry skips those of an older generation.
+    typedef std::pair<ullong_t, usize_t> entry_t;
+    std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>>
+                          heap;
+    std::vector<ullong_t> deadlines(TIMER_COUNT);
+
+    counters = perf_report_start();
+    start = std::chrono::steady_clock::now();
+    for (usize_t i = 0; i < TIMER_COUNT; ++i)
+    {
+        deadlines[i] = timeouts[i];
+        heap.emplace(deadlines[i], i);
+    }
+    report("heap start", TIMER_COUNT, start, counters);
+
+    counters = perf_report_start();
+    start = std::chrono::steady_clock::now();
+    for (usize_t i = 0; i < TIMER_COUNT; ++i)
+    {
+        deadlines[i] = timeouts[TIMER_COUNT - 1 - i];
+        heap.emplace(deadlines[i], i);
+    }
+    report("heap restart", TIMER_COUNT, start, counters);
+
+    expired = 0;
+    counters = perf_report_start();
+    start = std::chrono::steady_clock::now();
+    for (ullong_t now = 1; now <= 60000; ++now)
+    {
+        while (!heap.empty() && heap.top().first <= now)
+        {
+            entry_t top = heap.top();
+            heap.pop();
+            if (top.first == deadlines[top.second])
+            {
+                deadlines[top.second] = 0;
+                ++expired;
+            }
+        }
+    }
+    report("heap expire", expired, start, counters);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file alloc.h
+ * @brief Allocator interface shared by the containers of the library.
+ *
+ * An allocator is a single resize function paired with an opaque context.
+ * The same function allocates (old size is zero), resizes and releases
+ * (new size is zero) memory blocks, which lets containers switch between
+ * the system heap, an arena or a pool without changing their code.
+ */
+
+#ifndef LIQUID_ALLOC_H
+#define LIQUID_ALLOC_H
+
+#include "usize.h"
+
+/**
+ * @def LIQUID_ALLOC_ALIGNMENT
+ * @brief Alignment of the blocks carved out by the arena and the pool.
+ */
+#define LIQUID_ALLOC_ALIGNMENT 16
+
+/**
+ * @def LIQUID_ALLOC_MAP_THRESHOLD
+ * @brief Size starting from which the system allocator maps blocks
+ *        directly from the operating system.
+ *
+ * Mapped blocks are resized by remapping their pages where the platform
+ * supports it (mremap on Linux), so large buffers grow without copying.
+ */
+#define LIQUID_ALLOC_MAP_THRESHOLD (1024 * 1024)
+
+/**
+ * @def LIQUID_ALLOC_ALIGN(size)
+ * @brief Rounds a size up to the allocator alignment.
+ * @param size The size to round up.
+ * @return The rounded size.
+ */
+#define LIQUID_ALLOC_ALIGN(size)                                               \
+    (((size) + (LIQUID_ALLOC_ALIGNMENT - 1))                                   \
+     & ~(usize_t)(LIQUID_ALLOC_ALIGNMENT - 1))
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @typedef void *(alloc_fn)(void *ctx, void *ptr, usize_t old_size,
+ *                           usize_t new_size)
+ * @brief A type definition for the resize function of an allocator.
+ *
+ * @param ctx The allocator context.
+ * @param ptr The block to resize or nullptr to allocate a new one.
+ * @param old_size The size the block was allocated with, zero for new blocks.
+ * @param new_size The requested size, zero to release the block.
+ * @return The resized block, or nullptr if the block was released
+ *         or the allocation failed (the original block is left intact).
+ *
+ * @note Callers must always pass the exact size the block currently has,
+ *       allocators rely on it instead of keeping per-block headers.
+ */
+typedef void *(alloc_fn)(void *ctx, void *ptr, usize_t old_size,
+                         usize_t new_size);
+
+/**
+ * @struct allocator
+ * @brief An allocator function bound to its context.
+ */
+typedef struct allocator
+{
+    alloc_fn *fn;  ///< The resize function.
+    void     *ctx; ///< The context passed to the resize function.
+} allocator_t;
+
+/**
+ * @brief Retrieves the system allocator.
+ *
+ * Small blocks are served by the process heap; blocks larger than
+ * LIQUID_ALLOC_MAP_THRESHOLD are mapped from the operating system.
+ *
+ * @return A pointer to the static system allocator.
+ */
+const allocator_t *
+alloc_system();
+
+/**
+ * @brief The resize function of the system allocator.
+ * @see alloc_fn
+ */
+void *
+alloc_system_fn(void *ctx, void *ptr, usize_t old_size, usize_t new_size);
+
+/**
+ * @brief The resize function of the process heap.
+ * @see alloc_fn
+ */
+void *
+alloc_heap_fn(void *ctx, void *ptr, usize_t old_size, usize_t new_size);
+
+/**
+ * @brief Allocates a block of memory.
+ *
+ * @param allocator The allocator to use, nullptr selects the system one.
+ * @param size The size of the block in bytes.
+ * @return The allocated block or nullptr on failure.
+ */
+void *
+alloc_new(const allocator_t *allocator, usize_t size);
+
+/**
+ * @brief Resizes a block of memory.
+ *
+ * @param allocator The allocator the block belongs to,
+ *                  nullptr selects the system one.
+ * @param ptr The block to resize.
+ * @param old_size The current size of the block.
+ * @param new_size The requested size of the block.
+ * @return The resized block or nullptr on failure,
+ *         in which case the original block is left intact.
+ */
+void *
+alloc_resize(const allocator_t *allocator, void *ptr, usize_t old_size,
+             usize_t new_size);
+
+/**
+ * @brief Releases a block of memory.
+ *
+ * @param allocator The allocator the block belongs to,
+ *                  nullptr selects the system one.
+ * @param ptr The block to release.
+ * @param size The current size of the block.
+ */
+void
+alloc_delete(const allocator_t *allocator, void *ptr, usize_t size);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // LIQUID_ALLOC_H
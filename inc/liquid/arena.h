@@ -0,0 +1,98 @@
+/**
+ * @file arena.h
+ * @brief Bump allocator that releases all of its blocks at once.
+ *
+ * The arena carves allocations out of large chunks requested from a parent
+ * allocator. Individual releases are no-ops except for the most recent
+ * allocation, which can also be resized in place. This makes the arena
+ * a good backing store for containers that only grow.
+ */
+
+#ifndef LIQUID_ARENA_H
+#define LIQUID_ARENA_H
+
+#include "alloc.h"
+
+/**
+ * @def LIQUID_ARENA_CHUNK_SIZE
+ * @brief The default size of the chunks requested by an arena.
+ */
+#define LIQUID_ARENA_CHUNK_SIZE (64 * 1024)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @struct arena_chunk
+ * @brief A chunk of memory owned by an arena.
+ */
+typedef struct arena_chunk
+{
+    struct arena_chunk *prev; ///< The previously filled chunk.
+    usize_t             size; ///< The usable size of the chunk.
+    usize_t             used; ///< The number of bytes handed out.
+} arena_chunk_t;
+
+/**
+ * @struct arena
+ * @brief A bump allocator.
+ */
+typedef struct arena
+{
+    allocator_t        allocator;  ///< The allocator interface of the arena.
+    const allocator_t *parent;     ///< The allocator chunks are taken from.
+    arena_chunk_t     *chunk;      ///< The chunk allocations are served from.
+    void              *last;       ///< The most recent allocation.
+    usize_t            chunk_size; ///< The minimal size of new chunks.
+} arena_t;
+
+/**
+ * @brief Initializes an arena.
+ *
+ * @param arena The arena to initialize.
+ * @param parent The allocator for the chunks, nullptr selects the system one.
+ * @param chunk_size The minimal size of the chunks,
+ *                   zero selects LIQUID_ARENA_CHUNK_SIZE.
+ */
+void
+arena_init(arena_t *arena, const allocator_t *parent, usize_t chunk_size);
+
+/**
+ * @brief Releases every chunk owned by an arena.
+ * @param arena The arena to release.
+ */
+void
+arena_free(arena_t *arena);
+
+/**
+ * @brief Invalidates every allocation while keeping the newest chunk.
+ * @param arena The arena to reset.
+ */
+void
+arena_reset(arena_t *arena);
+
+/**
+ * @brief Allocates a block from an arena.
+ *
+ * @param arena The arena to allocate from.
+ * @param size The size of the block in bytes.
+ * @return The allocated block aligned to LIQUID_ALLOC_ALIGNMENT
+ *         or nullptr on failure.
+ */
+void *
+arena_alloc(arena_t *arena, usize_t size);
+
+/**
+ * @brief The resize function of an arena, its context is the arena itself.
+ * @see alloc_fn
+ */
+void *
+arena_alloc_fn(void *ctx, void *ptr, usize_t old_size, usize_t new_size);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // LIQUID_ARENA_H
@@ -42,6 +42,21 @@ extern "C"
 void *
 array_raw_copy(void *dest, const void *src, usize_t n);
 
+/**
+ * @brief Moves 'n' bytes from source to destination.
+ *
+ * Unlike array_raw_copy, the memory areas may overlap: the bytes are copied
+ * in the direction that never overwrites source bytes before they are read.
+ * Aligned runs are moved a machine word at a time.
+ *
+ * @param dest Pointer to the destination array.
+ * @param src Pointer to the source of data to be moved.
+ * @param n The number of bytes to move.
+ * @return Pointer to the next byte in 'dest' after the last moved byte.
+ */
+void *
+array_raw_move(void *dest, const void *src, usize_t n);
+
 /**
  * @brief Find the position of a value within an array.
  *
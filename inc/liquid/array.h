@@ -1,13 +1,188 @@
 /**
  * @file array.h
- * @brief Header file for defining utilities related to array operations.
+ * @brief Growable array of fixed-size items.
  *
- * This header defines macros that are useful for array operations such as
- * calculating the size of an array dynamically within the code. The macro
- * is designed to be portable and easy to use in various array operations.
+ * The array keeps its items in a single contiguous block obtained from an
+ * allocator and grows it geometrically. Items are moved with the array_raw
+ * kernels, so the container works for any trivially copyable type; the
+ * typed access macros below keep call sites readable.
  */
 
 #ifndef LIQUID_ARRAY_H
 #define LIQUID_ARRAY_H
 
+#include "alloc.h"
+
+/**
+ * @def ARRAY_GROWTH_DEFAULT
+ * @brief The default growth factor of an array, in percent.
+ */
+#define ARRAY_GROWTH_DEFAULT 150
+
+/**
+ * @def ARRAY_CAPACITY_MIN
+ * @brief The capacity an empty array jumps to on the first insertion.
+ */
+#define ARRAY_CAPACITY_MIN 8
+
+/**
+ * @def ARRAY_INIT(array, type, allocator)
+ * @brief Initializes an array of items of the given type.
+ * @param array Pointer to the array to initialize.
+ * @param type The type of the items.
+ * @param allocator The allocator to use, nullptr selects the system one.
+ */
+#define ARRAY_INIT(array, type, allocator)                                     \
+    array_init(array, sizeof(type), allocator)
+
+/**
+ * @def ARRAY_DATA(array, type)
+ * @brief Retrieves the items of an array as a typed pointer.
+ * @param array Pointer to the array.
+ * @param type The type of the items.
+ * @return Pointer to the first item.
+ */
+#define ARRAY_DATA(array, type) ((type *)(array)->data)
+
+/**
+ * @def ARRAY_AT(array, type, index)
+ * @brief Accesses an item of an array without bounds checking.
+ * @param array Pointer to the array.
+ * @param type The type of the items.
+ * @param index The index of the item.
+ * @return The item as an lvalue.
+ */
+#define ARRAY_AT(array, type, index) (ARRAY_DATA(array, type)[index])
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @struct array
+ * @brief A growable array.
+ */
+typedef struct array
+{
+    void              *data;      ///< The items.
+    usize_t            size;      ///< The number of items.
+    usize_t            capacity;  ///< The number of items that fit in data.
+    usize_t            item_size; ///< The size of an item in bytes.
+    uint_t             growth;    ///< The growth factor in percent.
+    const allocator_t *allocator; ///< The allocator of the data block.
+} array_t;
+
+/**
+ * @brief Initializes an empty array.
+ *
+ * @param array The array to initialize.
+ * @param item_size The size of an item in bytes.
+ * @param allocator The allocator to use, nullptr selects the system one.
+ */
+void
+array_init(array_t *array, usize_t item_size, const allocator_t *allocator);
+
+/**
+ * @brief Releases the items of an array.
+ * @param array The array to release.
+ */
+void
+array_free(array_t *array);
+
+/**
+ * @brief Changes the growth factor of an array.
+ *
+ * @param array The array.
+ * @param growth The growth factor in percent, must be greater than 100.
+ */
+void
+array_set_growth(array_t *array, uint_t growth);
+
+/**
+ * @brief Ensures that an array can hold the given number of items
+ *        without reallocating.
+ *
+ * @param array The array.
+ * @param capacity The number of items.
+ * @return Pointer to the items or nullptr on failure.
+ */
+void *
+array_reserve(array_t *array, usize_t capacity);
+
+/**
+ * @brief Shrinks the storage of an array to its size.
+ * @param array The array.
+ * @return Pointer to the items, nullptr if the array became empty
+ *         or the reallocation failed.
+ */
+void *
+array_shrink(array_t *array);
+
+/**
+ * @brief Removes all items from an array while keeping its storage.
+ * @param array The array.
+ */
+void
+array_clear(array_t *array);
+
+/**
+ * @brief Accesses an item of an array with bounds checking.
+ *
+ * @param array The array.
+ * @param index The index of the item.
+ * @return Pointer to the item or nullptr if the index is out of range.
+ */
+void *
+array_at(const array_t *array, usize_t index);
+
+/**
+ * @brief Appends an item to the end of an array.
+ *
+ * @param array The array.
+ * @param item The item to copy, nullptr leaves the new item uninitialized.
+ * @return Pointer to the appended item or nullptr on failure.
+ */
+void *
+array_push(array_t *array, const void *item);
+
+/**
+ * @brief Removes the last item of an array.
+ *
+ * @param array The array.
+ * @return Pointer to the removed item, which stays valid until the next
+ *         modification of the array, or nullptr if the array is empty.
+ */
+void *
+array_pop(array_t *array);
+
+/**
+ * @brief Inserts items at the given position of an array.
+ *
+ * @param array The array.
+ * @param index The position, at most the size of the array.
+ * @param items The items to copy, nullptr leaves them uninitialized. They
+ *              may be items of the array itself.
+ * @param count The number of items.
+ * @return Pointer to the first inserted item or nullptr on failure.
+ */
+void *
+array_insert(array_t *array, usize_t index, const void *items, usize_t count);
+
+/**
+ * @brief Removes items from an array.
+ *
+ * @param array The array.
+ * @param index The position of the first item to remove.
+ * @param count The number of items to remove.
+ * @return Pointer to the item that follows the removed ones
+ *         or nullptr if the range is out of bounds.
+ */
+void *
+array_erase(array_t *array, usize_t index, usize_t count);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
 #endif // LIQUID_ARRAY_H
@@ -1,11 +1,27 @@
 /**
  * @file bitflag.h
- * @brief Utility macros for performing bit operations.
+ * @brief Utility macros and functions for performing bit operations.
+ *
+ * The functions on whole words map to compiler builtins or intrinsics where
+ * available and to portable code otherwise. They are inline, so calls with
+ * constant arguments fold to constants.
  */
 
 #ifndef LIQUID_BITFLAG_H
 #define LIQUID_BITFLAG_H
 
+#include "int.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+    #include <stdlib.h>
+#endif
+
+#if defined(__BMI2__) && (defined(__x86_64__) || defined(_M_X64))
+    #include <immintrin.h>
+    #define BITFLAG_BMI2
+#endif
+
 /**
  * @brief Sets the bits specified by mask v in variable x.
  *
@@ -107,12 +123,18 @@
 /**
  * @brief Rotates the bits of x to the left n times.
  *
+ * Both shift counts are reduced modulo the width of x, so a rotation by
+ * zero or by the full width is defined and returns x. Compilers turn the
+ * expression into a single rotate instruction.
+ *
  * @param x The variable whose bits are to be rotated.
  * @param n The number of positions to rotate to the left.
  * @return The value of x after the bits have been rotated.
+ * @see bitflag_rotl64
  */
 #define BITFLAG_ROTATE_LEFT(x, n)                                              \
-    (((x) << (n)) | ((x) >> (sizeof(x) * 8 - (n))))
+    (((x) << ((n) & (sizeof(x) * 8 - 1)))                                      \
+     | ((x) >> (-(n) & (sizeof(x) * 8 - 1))))
 
 /**
  * @brief Rotates the bits of x to the right n times.
@@ -120,9 +142,11 @@
  * @param x The variable whose bits are to be rotated.
  * @param n The number of positions to rotate to the right.
  * @return The value of x after the bits have been rotated.
+ * @see BITFLAG_ROTATE_LEFT
  */
 #define BITFLAG_ROTATE_RIGHT(x, n)                                             \
-    (((x) >> (n)) | ((x) << (sizeof(x) * 8 - (n))))
+    (((x) >> ((n) & (sizeof(x) * 8 - 1)))                                      \
+     | ((x) << (-(n) & (sizeof(x) * 8 - 1))))
 
 // -----------------------------------------------------------------------------
 // Provides a set of bitflag definitions for easy access
@@ -238,4 +262,340 @@
  */
 #define BITFLAG_MIN_UINT(type) ((type)0)
 
+// -----------------------------------------------------------------------------
+// The following functions operate on whole 32 and 64-bit words. Counting
+// functions accept zero and return the width of the word for it, matching
+// the LZCNT and TZCNT instructions.
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Counts the trailing zero bits of a 32-bit value.
+ * @param x The value.
+ * @return The index of the lowest set bit, or 32 if x is zero.
+ */
+static inline uint_t
+bitflag_ctz32(uint_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return x ? (uint_t)__builtin_ctz(x) : 32;
+#elif defined(_MSC_VER)
+    unsigned long index;
+    return _BitScanForward(&index, x) ? (uint_t)index : 32;
+#else
+    uint_t count = 0;
+    if (!x)
+    {
+        return 32;
+    }
+    for (; !(x & 1); x >>= 1)
+    {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+/**
+ * @brief Counts the trailing zero bits of a 64-bit value.
+ * @param x The value.
+ * @return The index of the lowest set bit, or 64 if x is zero.
+ */
+static inline uint_t
+bitflag_ctz64(ullong_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return x ? (uint_t)__builtin_ctzll(x) : 64;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    return _BitScanForward64(&index, x) ? (uint_t)index : 64;
+#else
+    return (uint_t)x ? bitflag_ctz32((uint_t)x)
+                     : 32 + bitflag_ctz32((uint_t)(x >> 32));
+#endif
+}
+
+/**
+ * @brief Counts the leading zero bits of a 32-bit value.
+ * @param x The value.
+ * @return The number of clear bits above the highest set bit, or 32 if x
+ *         is zero.
+ */
+static inline uint_t
+bitflag_clz32(uint_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return x ? (uint_t)__builtin_clz(x) : 32;
+#elif defined(_MSC_VER)
+    unsigned long index;
+    return _BitScanReverse(&index, x) ? 31 - (uint_t)index : 32;
+#else
+    uint_t count = 0;
+    if (!x)
+    {
+        return 32;
+    }
+    for (; !(x & 0x80000000u); x <<= 1)
+    {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+/**
+ * @brief Counts the leading zero bits of a 64-bit value.
+ * @param x The value.
+ * @return The number of clear bits above the highest set bit, or 64 if x
+ *         is zero.
+ */
+static inline uint_t
+bitflag_clz64(ullong_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return x ? (uint_t)__builtin_clzll(x) : 64;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    return _BitScanReverse64(&index, x) ? 63 - (uint_t)index : 64;
+#else
+    return x >> 32 ? bitflag_clz32((uint_t)(x >> 32))
+                   : 32 + bitflag_clz32((uint_t)x);
+#endif
+}
+
+/**
+ * @brief Counts the set bits of a 32-bit value.
+ * @param x The value.
+ * @return The number of set bits.
+ */
+static inline uint_t
+bitflag_popcount32(uint_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint_t)__builtin_popcount(x);
+#else
+    x -= (x >> 1) & 0x55555555u;
+    x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+    x = (x + (x >> 4)) & 0x0F0F0F0Fu;
+    return (x * 0x01010101u) >> 24;
+#endif
+}
+
+/**
+ * @brief Counts the set bits of a 64-bit value.
+ * @param x The value.
+ * @return The number of set bits.
+ */
+static inline uint_t
+bitflag_popcount64(ullong_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint_t)__builtin_popcountll(x);
+#elif defined(_MSC_VER) && defined(_M_X64) && defined(__AVX__)
+    return (uint_t)__popcnt64(x);
+#else
+    x -= (x >> 1) & 0x5555555555555555ull;
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (uint_t)((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/**
+ * @brief Rotates a 32-bit value to the left.
+ *
+ * @param x The value.
+ * @param n The number of positions, taken modulo 32.
+ * @return The rotated value.
+ */
+static inline uint_t
+bitflag_rotl32(uint_t x, uint_t n)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return _rotl(x, (int)(n & 31));
+#else
+    return x << (n & 31) | x >> (-n & 31);
+#endif
+}
+
+/**
+ * @brief Rotates a 32-bit value to the right.
+ * @see bitflag_rotl32
+ */
+static inline uint_t
+bitflag_rotr32(uint_t x, uint_t n)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return _rotr(x, (int)(n & 31));
+#else
+    return x >> (n & 31) | x << (-n & 31);
+#endif
+}
+
+/**
+ * @brief Rotates a 64-bit value to the left.
+ *
+ * @param x The value.
+ * @param n The number of positions, taken modulo 64.
+ * @return The rotated value.
+ */
+static inline ullong_t
+bitflag_rotl64(ullong_t x, uint_t n)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return _rotl64(x, (int)(n & 63));
+#else
+    return x << (n & 63) | x >> (-n & 63);
+#endif
+}
+
+/**
+ * @brief Rotates a 64-bit value to the right.
+ * @see bitflag_rotl64
+ */
+static inline ullong_t
+bitflag_rotr64(ullong_t x, uint_t n)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return _rotr64(x, (int)(n & 63));
+#else
+    return x >> (n & 63) | x << (-n & 63);
+#endif
+}
+
+/**
+ * @brief Reverses the bytes of a 16-bit value.
+ * @param x The value.
+ * @return The value with its bytes reversed.
+ */
+static inline ushort_t
+bitflag_bswap16(ushort_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap16(x);
+#elif defined(_MSC_VER)
+    return _byteswap_ushort(x);
+#else
+    return (ushort_t)(x << 8 | x >> 8);
+#endif
+}
+
+/**
+ * @brief Reverses the bytes of a 32-bit value.
+ * @param x The value.
+ * @return The value with its bytes reversed.
+ */
+static inline uint_t
+bitflag_bswap32(uint_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap32(x);
+#elif defined(_MSC_VER)
+    return (uint_t)_byteswap_ulong(x);
+#else
+    return x << 24 | (x & 0xFF00) << 8 | (x >> 8 & 0xFF00) | x >> 24;
+#endif
+}
+
+/**
+ * @brief Reverses the bytes of a 64-bit value.
+ * @param x The value.
+ * @return The value with its bytes reversed.
+ */
+static inline ullong_t
+bitflag_bswap64(ullong_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64(x);
+#elif defined(_MSC_VER)
+    return _byteswap_uint64(x);
+#else
+    return (ullong_t)bitflag_bswap32((uint_t)x) << 32
+           | bitflag_bswap32((uint_t)(x >> 32));
+#endif
+}
+
+/**
+ * @brief Deposits the low bits of a value at the set bits of a mask.
+ *
+ * The lowest bit of x goes to the lowest set bit of the mask, the next bit
+ * to the next set bit and so on. This is the PDEP instruction of BMI2, which
+ * is used when the target enables it.
+ *
+ * @param x The bits to deposit.
+ * @param mask The positions to deposit them at.
+ * @return The deposited bits.
+ */
+static inline ullong_t
+bitflag_pdep64(ullong_t x, ullong_t mask)
+{
+#if defined(BITFLAG_BMI2)
+    return _pdep_u64(x, mask);
+#else
+    ullong_t result = 0;
+    for (ullong_t bit = 1; mask; bit <<= 1)
+    {
+        if (x & bit)
+        {
+            result |= mask & -mask;
+        }
+        mask &= mask - 1;
+    }
+    return result;
+#endif
+}
+
+/**
+ * @brief Extracts the bits of a value at the set bits of a mask.
+ *
+ * The bit of x at the lowest set bit of the mask becomes the lowest bit of
+ * the result and so on. This is the PEXT instruction of BMI2, which is used
+ * when the target enables it.
+ *
+ * @param x The value to extract from.
+ * @param mask The positions to extract.
+ * @return The extracted bits packed at the bottom.
+ */
+static inline ullong_t
+bitflag_pext64(ullong_t x, ullong_t mask)
+{
+#if defined(BITFLAG_BMI2)
+    return _pext_u64(x, mask);
+#else
+    ullong_t result = 0;
+    for (ullong_t bit = 1; mask; bit <<= 1)
+    {
+        if (x & mask & -mask)
+        {
+            result |= bit;
+        }
+        mask &= mask - 1;
+    }
+    return result;
+#endif
+}
+
+/**
+ * @brief Rounds a 32-bit value up to the next power of two.
+ * @param x The value.
+ * @return The smallest power of two not below x, one for zero, and zero if
+ *         the result does not fit.
+ */
+static inline uint_t
+bitflag_next_pow2_32(uint_t x)
+{
+    return x <= 1 ? 1 : x > 0x80000000u ? 0 : 1u << (32 - bitflag_clz32(x - 1));
+}
+
+/**
+ * @brief Rounds a 64-bit value up to the next power of two.
+ * @see bitflag_next_pow2_32
+ */
+static inline ullong_t
+bitflag_next_pow2_64(ullong_t x)
+{
+    return x <= 1                       ? 1
+           : x > 0x8000000000000000ull ? 0
+                                       : 1ull << (64 - bitflag_clz64(x - 1));
+}
+
 #endif /* LIQUID_BITFLAG_H */
\ No newline at end of file
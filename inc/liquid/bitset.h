@@ -0,0 +1,345 @@
+/**
+ * @file bitset.h
+ * @brief Dynamic bitsets and compressed bitmaps.
+ *
+ * A bitset stores one bit per index in an array of 64-bit words. Counting,
+ * searching and combining bitsets work on whole words and use AVX2, SSE2 or
+ * NEON where the processor supports them, so filters over large columns run
+ * at memory speed.
+ *
+ * A roaring bitmap stores a set of 32-bit values compactly. The values are
+ * grouped by their upper 16 bits into containers that hold either a sorted
+ * array of the lower halves, while there are at most ROARING_ARRAY_MAX of
+ * them, or a bitmap of 65536 bits. Sparse sets thus cost about two bytes per
+ * value and dense ones about one bit.
+ */
+
+#ifndef LIQUID_BITSET_H
+#define LIQUID_BITSET_H
+
+#include "alloc.h"
+#include "bool.h"
+#include "limits.h"
+
+/**
+ * @def BITSET_WORD_BITS
+ * @brief The number of bits stored in a word of a bitset.
+ */
+#define BITSET_WORD_BITS 64
+
+/**
+ * @def BITSET_WORDS(size)
+ * @brief Computes the number of words needed for a number of bits.
+ * @param size The number of bits.
+ */
+#define BITSET_WORDS(size) (((size) + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS)
+
+/**
+ * @def BITSET_NONE
+ * @brief The index returned by searches that find no set bit.
+ */
+#define BITSET_NONE LIQUID_USIZE_MAX
+
+/**
+ * @def ROARING_ARRAY_MAX
+ * @brief The largest number of values a container stores as an array.
+ */
+#define ROARING_ARRAY_MAX 4096
+
+/**
+ * @def ROARING_BITMAP_WORDS
+ * @brief The number of words of a container stored as a bitmap.
+ */
+#define ROARING_BITMAP_WORDS 1024
+
+/**
+ * @def ROARING_END
+ * @brief The value returned by roaring_next once the values are exhausted.
+ */
+#define ROARING_END (1ULL << 32)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @struct bitset
+ * @brief A growable array of bits.
+ *
+ * The bits of the last word beyond the size of the bitset are always clear.
+ */
+typedef struct bitset
+{
+    ullong_t          *words;     ///< The words holding the bits.
+    usize_t            size;      ///< The number of bits.
+    usize_t            capacity;  ///< The number of allocated words.
+    const allocator_t *allocator; ///< The allocator of the words.
+} bitset_t;
+
+/**
+ * @struct roaring_container
+ * @brief The values of a roaring bitmap that share their upper 16 bits.
+ */
+typedef struct roaring_container
+{
+    void  *data;     ///< The sorted lower halves or the bitmap words.
+    uint_t key;      ///< The upper 16 bits of the values.
+    uint_t count;    ///< The number of values.
+    uint_t capacity; ///< The capacity of the array, zero for a bitmap.
+} roaring_container_t;
+
+/**
+ * @struct roaring
+ * @brief A compressed set of 32-bit values.
+ */
+typedef struct roaring
+{
+    roaring_container_t *containers; ///< The containers sorted by key.
+    usize_t              size;       ///< The number of containers.
+    usize_t              capacity;   ///< The capacity of the containers.
+    const allocator_t   *allocator;  ///< The allocator of the storage.
+} roaring_t;
+
+/**
+ * @brief Initializes an empty bitset.
+ *
+ * @param bitset The bitset to initialize.
+ * @param allocator The allocator to use, nullptr selects the system one.
+ */
+void
+bitset_init(bitset_t *bitset, const allocator_t *allocator);
+
+/**
+ * @brief Releases the words of a bitset.
+ * @param bitset The bitset to release.
+ */
+void
+bitset_free(bitset_t *bitset);
+
+/**
+ * @brief Changes the number of bits of a bitset.
+ *
+ * Bits added by growing the bitset are clear.
+ *
+ * @param bitset The bitset.
+ * @param size The new number of bits.
+ * @return True on success, false if the allocation failed.
+ */
+bool
+bitset_resize(bitset_t *bitset, usize_t size);
+
+/**
+ * @brief Sets a bit.
+ *
+ * @param bitset The bitset.
+ * @param index The index of the bit, less than the size.
+ */
+void
+bitset_set(bitset_t *bitset, usize_t index);
+
+/**
+ * @brief Clears a bit.
+ * @see bitset_set
+ */
+void
+bitset_unset(bitset_t *bitset, usize_t index);
+
+/**
+ * @brief Checks whether a bit is set.
+ *
+ * @param bitset The bitset.
+ * @param index The index of the bit, less than the size.
+ * @return True if the bit is set.
+ */
+bool
+bitset_test(const bitset_t *bitset, usize_t index);
+
+/**
+ * @brief Sets every bit of a bitset.
+ * @param bitset The bitset.
+ */
+void
+bitset_set_all(bitset_t *bitset);
+
+/**
+ * @brief Clears every bit of a bitset.
+ * @param bitset The bitset.
+ */
+void
+bitset_clear(bitset_t *bitset);
+
+/**
+ * @brief Counts the set bits of a bitset.
+ *
+ * @param bitset The bitset.
+ * @return The number of set bits.
+ */
+usize_t
+bitset_count(const bitset_t *bitset);
+
+/**
+ * @brief Finds the first set bit at or after an index.
+ *
+ * Iterating over the set bits with this function costs a word access per
+ * set bit plus one per 64 clear bits.
+ *
+ * @param bitset The bitset.
+ * @param from The index to start at.
+ * @return The index of the set bit or BITSET_NONE if there is none.
+ */
+usize_t
+bitset_next(const bitset_t *bitset, usize_t from);
+
+/**
+ * @brief Finds the last set bit at or before an index.
+ *
+ * @param bitset The bitset.
+ * @param from The index to start at, indices past the end select the end.
+ * @return The index of the set bit or BITSET_NONE if there is none.
+ */
+usize_t
+bitset_prev(const bitset_t *bitset, usize_t from);
+
+/**
+ * @brief Intersects a bitset with another one of the same size.
+ *
+ * @param dest The bitset to modify.
+ * @param src The bitset to intersect with.
+ */
+void
+bitset_and(bitset_t *dest, const bitset_t *src);
+
+/**
+ * @brief Unites a bitset with another one of the same size.
+ * @see bitset_and
+ */
+void
+bitset_or(bitset_t *dest, const bitset_t *src);
+
+/**
+ * @brief Toggles the bits of a bitset that are set in another one of the
+ *        same size.
+ * @see bitset_and
+ */
+void
+bitset_xor(bitset_t *dest, const bitset_t *src);
+
+/**
+ * @brief Clears the bits of a bitset that are set in another one of the
+ *        same size.
+ * @see bitset_and
+ */
+void
+bitset_andnot(bitset_t *dest, const bitset_t *src);
+
+/**
+ * @brief Initializes an empty roaring bitmap.
+ *
+ * @param roaring The bitmap to initialize.
+ * @param allocator The allocator to use, nullptr selects the system one.
+ */
+void
+roaring_init(roaring_t *roaring, const allocator_t *allocator);
+
+/**
+ * @brief Releases the storage of a roaring bitmap.
+ * @param roaring The bitmap to release.
+ */
+void
+roaring_free(roaring_t *roaring);
+
+/**
+ * @brief Adds a value to a roaring bitmap.
+ *
+ * @param roaring The bitmap.
+ * @param value The value.
+ * @return True on success, false if the allocation failed.
+ */
+bool
+roaring_add(roaring_t *roaring, uint_t value);
+
+/**
+ * @brief Removes a value from a roaring bitmap.
+ *
+ * @param roaring The bitmap.
+ * @param value The value.
+ * @return True if the value was present.
+ */
+bool
+roaring_remove(roaring_t *roaring, uint_t value);
+
+/**
+ * @brief Checks whether a roaring bitmap contains a value.
+ *
+ * @param roaring The bitmap.
+ * @param value The value.
+ * @return True if the value is present.
+ */
+bool
+roaring_contains(const roaring_t *roaring, uint_t value);
+
+/**
+ * @brief Counts the values of a roaring bitmap.
+ *
+ * @param roaring The bitmap.
+ * @return The number of values.
+ */
+ullong_t
+roaring_count(const roaring_t *roaring);
+
+/**
+ * @brief Finds the smallest value of a roaring bitmap not below a bound.
+ *
+ * @param roaring The bitmap.
+ * @param from The bound.
+ * @return The value or ROARING_END if there is none.
+ */
+ullong_t
+roaring_next(const roaring_t *roaring, ullong_t from);
+
+/**
+ * @brief Stores the values of a roaring bitmap in ascending order.
+ *
+ * @param roaring The bitmap.
+ * @param values The array receiving roaring_count values.
+ * @return The number of values stored.
+ */
+usize_t
+roaring_to_array(const roaring_t *roaring, uint_t *values);
+
+/**
+ * @brief Intersects a roaring bitmap with another one.
+ *
+ * The intersection is computed in place and needs no allocation.
+ *
+ * @param dest The bitmap to modify.
+ * @param src The bitmap to intersect with.
+ */
+void
+roaring_and(roaring_t *dest, const roaring_t *src);
+
+/**
+ * @brief Unites a roaring bitmap with another one.
+ *
+ * @param dest The bitmap to modify.
+ * @param src The bitmap to unite with.
+ * @return True on success, false if an allocation failed, in which case
+ *         dest holds a superset of its original values that is included in
+ *         the union.
+ */
+bool
+roaring_or(roaring_t *dest, const roaring_t *src);
+
+/**
+ * @brief Removes the values of a roaring bitmap present in another one.
+ * @see roaring_and
+ */
+void
+roaring_andnot(roaring_t *dest, const roaring_t *src);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // LIQUID_BITSET_H
@@ -0,0 +1,395 @@
+/**
+ * @file checked.h
+ * @brief Overflow-aware integer arithmetic.
+ *
+ * The checked functions store the wrapped result of an operation and return
+ * whether it is exact, so a size computation and its overflow check are a
+ * single call:
+ *
+ * @code
+ *     usize_t size;
+ *     if (!checked_mul_add_usize(count, item_size, header, &size))
+ *     {
+ *         return nullptr;
+ *     }
+ * @endcode
+ *
+ * The saturating functions clamp the result to the range of the type
+ * instead. All of them are inline and use the overflow builtins of GCC and
+ * Clang, which compile to the flags of the arithmetic instruction, or
+ * _umul128 on MSVC. Other compilers get portable code without divisions in
+ * the common cases.
+ */
+
+#ifndef LIQUID_CHECKED_H
+#define LIQUID_CHECKED_H
+
+#include "bool.h"
+#include "limits.h"
+#include "usize.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define CHECKED_BUILTINS
+#elif defined(_MSC_VER) && defined(_M_X64)
+    #include <intrin.h>
+#endif
+
+/**
+ * @brief Adds two unsigned integers.
+ *
+ * @param a The first summand.
+ * @param b The second summand.
+ * @param result Receives the sum modulo the range of the type.
+ * @return True if the sum fits, false if it wrapped.
+ */
+static inline bool
+checked_add_uint(uint_t a, uint_t b, uint_t *result)
+{
+    *result = a + b;
+    return *result >= a;
+}
+
+/**
+ * @brief Subtracts two unsigned integers.
+ *
+ * @param a The minuend.
+ * @param b The subtrahend.
+ * @param result Receives the difference modulo the range of the type.
+ * @return True if b is not greater than a.
+ */
+static inline bool
+checked_sub_uint(uint_t a, uint_t b, uint_t *result)
+{
+    *result = a - b;
+    return a >= b;
+}
+
+/**
+ * @brief Multiplies two unsigned integers.
+ *
+ * @param a The first factor.
+ * @param b The second factor.
+ * @param result Receives the product modulo the range of the type.
+ * @return True if the product fits, false if it wrapped.
+ */
+static inline bool
+checked_mul_uint(uint_t a, uint_t b, uint_t *result)
+{
+#if defined(CHECKED_BUILTINS)
+    return !__builtin_mul_overflow(a, b, result);
+#else
+    ullong_t product = (ullong_t)a * b;
+    *result = (uint_t)product;
+    return product <= LIQUID_UINT_MAX;
+#endif
+}
+
+/**
+ * @brief Adds two unsigned long long integers.
+ * @see checked_add_uint
+ */
+static inline bool
+checked_add_ullong(ullong_t a, ullong_t b, ullong_t *result)
+{
+    *result = a + b;
+    return *result >= a;
+}
+
+/**
+ * @brief Subtracts two unsigned long long integers.
+ * @see checked_sub_uint
+ */
+static inline bool
+checked_sub_ullong(ullong_t a, ullong_t b, ullong_t *result)
+{
+    *result = a - b;
+    return a >= b;
+}
+
+/**
+ * @brief Multiplies two unsigned long long integers.
+ * @see checked_mul_uint
+ */
+static inline bool
+checked_mul_ullong(ullong_t a, ullong_t b, ullong_t *result)
+{
+#if defined(CHECKED_BUILTINS)
+    return !__builtin_mul_overflow(a, b, result);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    ullong_t high;
+    *result = _umul128(a, b, &high);
+    return !high;
+#else
+    *result = a * b;
+    // Factors below 2^32 cannot overflow, which spares the division.
+    return !((a | b) >> 32) || !a || *result / a == b;
+#endif
+}
+
+/**
+ * @brief Adds two sizes.
+ * @see checked_add_uint
+ */
+static inline bool
+checked_add_usize(usize_t a, usize_t b, usize_t *result)
+{
+    *result = a + b;
+    return *result >= a;
+}
+
+/**
+ * @brief Subtracts two sizes.
+ * @see checked_sub_uint
+ */
+static inline bool
+checked_sub_usize(usize_t a, usize_t b, usize_t *result)
+{
+    *result = a - b;
+    return a >= b;
+}
+
+/**
+ * @brief Multiplies two sizes.
+ * @see checked_mul_uint
+ */
+static inline bool
+checked_mul_usize(usize_t a, usize_t b, usize_t *result)
+{
+#if LIQUID_TARGET_PLATFORM == 64
+    return checked_mul_ullong(a, b, result);
+#else
+    return checked_mul_uint(a, b, result);
+#endif
+}
+
+/**
+ * @brief Computes the size of an array of items following a header.
+ *
+ * @param count The number of items.
+ * @param size The size of an item.
+ * @param extra The size added to the product, e.g. of a header.
+ * @param result Receives count * size + extra modulo the range of usize_t.
+ * @return True if the result fits, false if it wrapped.
+ */
+static inline bool
+checked_mul_add_usize(usize_t count, usize_t size, usize_t extra,
+                      usize_t *result)
+{
+    usize_t product;
+    bool    exact = checked_mul_usize(count, size, &product);
+    return checked_add_usize(product, extra, result) & exact;
+}
+
+/**
+ * @brief Adds two signed integers.
+ *
+ * @param a The first summand.
+ * @param b The second summand.
+ * @param result Receives the sum wrapped in two's complement.
+ * @return True if the sum fits, false if it wrapped.
+ */
+static inline bool
+checked_add_sint(sint_t a, sint_t b, sint_t *result)
+{
+#if defined(CHECKED_BUILTINS)
+    return !__builtin_add_overflow(a, b, result);
+#else
+    *result = (sint_t)((uint_t)a + (uint_t)b);
+    // The sum overflowed if its sign differs from both summands.
+    return ((a ^ *result) & (b ^ *result)) >= 0;
+#endif
+}
+
+/**
+ * @brief Subtracts two signed integers.
+ * @see checked_add_sint
+ */
+static inline bool
+checked_sub_sint(sint_t a, sint_t b, sint_t *result)
+{
+#if defined(CHECKED_BUILTINS)
+    return !__builtin_sub_overflow(a, b, result);
+#else
+    *result = (sint_t)((uint_t)a - (uint_t)b);
+    return ((a ^ b) & (a ^ *result)) >= 0;
+#endif
+}
+
+/**
+ * @brief Multiplies two signed integers.
+ * @see checked_add_sint
+ */
+static inline bool
+checked_mul_sint(sint_t a, sint_t b, sint_t *result)
+{
+#if defined(CHECKED_BUILTINS)
+    return !__builtin_mul_overflow(a, b, result);
+#else
+    sllong_t product = (sllong_t)a * b;
+    *result = (sint_t)product;
+    return product >= LIQUID_SINT_MIN && product <= LIQUID_SINT_MAX;
+#endif
+}
+
+/**
+ * @brief Adds two signed long long integers.
+ * @see checked_add_sint
+ */
+static inline bool
+checked_add_sllong(sllong_t a, sllong_t b, sllong_t *result)
+{
+#if defined(CHECKED_BUILTINS)
+    return !__builtin_add_overflow(a, b, result);
+#else
+    *result = (sllong_t)((ullong_t)a + (ullong_t)b);
+    return ((a ^ *result) & (b ^ *result)) >= 0;
+#endif
+}
+
+/**
+ * @brief Subtracts two signed long long integers.
+ * @see checked_add_sint
+ */
+static inline bool
+checked_sub_sllong(sllong_t a, sllong_t b, sllong_t *result)
+{
+#if defined(CHECKED_BUILTINS)
+    return !__builtin_sub_overflow(a, b, result);
+#else
+    *result = (sllong_t)((ullong_t)a - (ullong_t)b);
+    return ((a ^ b) & (a ^ *result)) >= 0;
+#endif
+}
+
+/**
+ * @brief Multiplies two signed long long integers.
+ * @see checked_add_sint
+ */
+static inline bool
+checked_mul_sllong(sllong_t a, sllong_t b, sllong_t *result)
+{
+#if defined(CHECKED_BUILTINS)
+    return !__builtin_mul_overflow(a, b, result);
+#else
+    // Multiply the magnitudes and apply the sign afterwards.
+    ullong_t magnitude_a = a < 0 ? 0 - (ullong_t)a : (ullong_t)a;
+    ullong_t magnitude_b = b < 0 ? 0 - (ullong_t)b : (ullong_t)b;
+    ullong_t magnitude;
+    bool     exact = checked_mul_ullong(magnitude_a, magnitude_b, &magnitude);
+    uint_t   negative = (a < 0) != (b < 0);
+    *result = (sllong_t)(negative ? 0 - magnitude : magnitude);
+    return exact && magnitude <= (ullong_t)LIQUID_SLLONG_MAX + negative;
+#endif
+}
+
+/**
+ * @brief Adds two unsigned integers, clamping the sum to LIQUID_UINT_MAX.
+ *
+ * @param a The first summand.
+ * @param b The second summand.
+ * @return The clamped sum.
+ */
+static inline uint_t
+saturating_add_uint(uint_t a, uint_t b)
+{
+    uint_t sum;
+    return checked_add_uint(a, b, &sum) ? sum : LIQUID_UINT_MAX;
+}
+
+/**
+ * @brief Subtracts two unsigned integers, clamping the difference to zero.
+ *
+ * @param a The minuend.
+ * @param b The subtrahend.
+ * @return The clamped difference.
+ */
+static inline uint_t
+saturating_sub_uint(uint_t a, uint_t b)
+{
+    return a > b ? a - b : 0;
+}
+
+/**
+ * @brief Multiplies two unsigned integers, clamping the product to
+ *        LIQUID_UINT_MAX.
+ *
+ * @param a The first factor.
+ * @param b The second factor.
+ * @return The clamped product.
+ */
+static inline uint_t
+saturating_mul_uint(uint_t a, uint_t b)
+{
+    uint_t product;
+    return checked_mul_uint(a, b, &product) ? product : LIQUID_UINT_MAX;
+}
+
+/**
+ * @brief Adds two unsigned long long integers, clamping the sum.
+ * @see saturating_add_uint
+ */
+static inline ullong_t
+saturating_add_ullong(ullong_t a, ullong_t b)
+{
+    ullong_t sum;
+    return checked_add_ullong(a, b, &sum) ? sum : LIQUID_ULLONG_MAX;
+}
+
+/**
+ * @brief Subtracts two unsigned long long integers, clamping the difference.
+ * @see saturating_sub_uint
+ */
+static inline ullong_t
+saturating_sub_ullong(ullong_t a, ullong_t b)
+{
+    return a > b ? a - b : 0;
+}
+
+/**
+ * @brief Multiplies two unsigned long long integers, clamping the product.
+ * @see saturating_mul_uint
+ */
+static inline ullong_t
+saturating_mul_ullong(ullong_t a, ullong_t b)
+{
+    ullong_t product;
+    return checked_mul_ullong(a, b, &product) ? product : LIQUID_ULLONG_MAX;
+}
+
+/**
+ * @brief Adds two sizes, clamping the sum to LIQUID_USIZE_MAX.
+ *
+ * A clamped size never fits in memory, so passing it on to an allocator
+ * makes the allocation fail instead of returning a short block.
+ *
+ * @see saturating_add_uint
+ */
+static inline usize_t
+saturating_add_usize(usize_t a, usize_t b)
+{
+    usize_t sum;
+    return checked_add_usize(a, b, &sum) ? sum : LIQUID_USIZE_MAX;
+}
+
+/**
+ * @brief Subtracts two sizes, clamping the difference to zero.
+ * @see saturating_sub_uint
+ */
+static inline usize_t
+saturating_sub_usize(usize_t a, usize_t b)
+{
+    return a > b ? a - b : 0;
+}
+
+/**
+ * @brief Multiplies two sizes, clamping the product to LIQUID_USIZE_MAX.
+ * @see saturating_add_usize
+ */
+static inline usize_t
+saturating_mul_usize(usize_t a, usize_t b)
+{
+    usize_t product;
+    return checked_mul_usize(a, b, &product) ? product : LIQUID_USIZE_MAX;
+}
+
+#endif // LIQUID_CHECKED_H
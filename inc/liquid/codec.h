@@ -0,0 +1,207 @@
+/**
+ * @file codec.h
+ * @brief Compression codecs for arrays of integers.
+ *
+ * Bit packing stores blocks of CODEC_BLOCK_SIZE 32-bit values with a fixed
+ * number of bits each. The values are interleaved over four lanes: value i
+ * belongs to lane i % 4 and every 32-bit word of the output holds bits of
+ * one lane, so that a block packs and unpacks with four-lane SSE2 or NEON
+ * shifts. Portable code produces the same layout.
+ *
+ * Frame-of-reference coding subtracts the minimum of each block before
+ * packing it, and delta coding replaces sorted values by their differences,
+ * so that ids and timestamps pack to a few bits each. Delta-of-delta coding
+ * turns regularly spaced timestamps into runs of zeros.
+ */
+
+#ifndef LIQUID_CODEC_H
+#define LIQUID_CODEC_H
+
+#include "bool.h"
+#include "usize.h"
+
+/**
+ * @def CODEC_BLOCK_SIZE
+ * @brief The number of values of a packed block.
+ */
+#define CODEC_BLOCK_SIZE 128
+
+/**
+ * @def CODEC_FOR_HEADER
+ * @brief The number of words preceding the packed values of a
+ *        frame-of-reference block: the minimum and the bit width.
+ */
+#define CODEC_FOR_HEADER 2
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @brief Computes the number of bits needed for the largest value of a
+ *        block.
+ *
+ * @param values The CODEC_BLOCK_SIZE values.
+ * @return The bit width, between 0 and 32.
+ */
+uint_t
+codec_bits128(const uint_t *values);
+
+/**
+ * @brief Packs a block of values.
+ *
+ * @param dest The words receiving the packed values, 4 * bits of them.
+ * @param values The CODEC_BLOCK_SIZE values, each less than 2^bits.
+ * @param bits The bit width, between 0 and 32.
+ * @return Pointer past the last word written.
+ */
+uint_t *
+codec_pack128(uint_t *dest, const uint_t *values, uint_t bits);
+
+/**
+ * @brief Unpacks a block of values.
+ *
+ * @param values Receives the CODEC_BLOCK_SIZE values.
+ * @param src The packed words, 4 * bits of them.
+ * @param bits The bit width, between 0 and 32.
+ * @return Pointer past the last word read.
+ */
+const uint_t *
+codec_unpack128(uint_t *values, const uint_t *src, uint_t bits);
+
+/**
+ * @brief Computes the largest number of words codec_for_encode writes.
+ *
+ * @param count The number of values.
+ * @return The number of words.
+ */
+usize_t
+codec_for_bound(usize_t count);
+
+/**
+ * @brief Encodes values as frame-of-reference blocks.
+ *
+ * Every block starts with the minimum of its values and the bit width of
+ * the differences to the minimum, followed by the packed differences. The
+ * last block is padded if count is not a multiple of CODEC_BLOCK_SIZE.
+ *
+ * @param dest The words receiving the blocks, codec_for_bound of them.
+ * @param values The values.
+ * @param count The number of values.
+ * @return Pointer past the last word written.
+ */
+uint_t *
+codec_for_encode(uint_t *dest, const uint_t *values, usize_t count);
+
+/**
+ * @brief Decodes frame-of-reference blocks.
+ *
+ * @param values Receives the values.
+ * @param src The first word of the blocks.
+ * @param end The end of the words.
+ * @param count The number of values encoded.
+ * @return Pointer past the last block, or nullptr if the blocks are
+ *         truncated or malformed.
+ */
+const uint_t *
+codec_for_decode(uint_t *values, const uint_t *src, const uint_t *end,
+                 usize_t count);
+
+/**
+ * @brief Encodes sorted values as frame-of-reference blocks of their
+ *        differences.
+ *
+ * This is codec_delta_encode followed by codec_for_encode without the
+ * intermediate array.
+ *
+ * @param dest The words receiving the blocks, codec_for_bound of them.
+ * @param values The values.
+ * @param count The number of values.
+ * @param base The predecessor of the first value.
+ * @return Pointer past the last word written.
+ */
+uint_t *
+codec_for_delta_encode(uint_t *dest, const uint_t *values, usize_t count,
+                       uint_t base);
+
+/**
+ * @brief Decodes values encoded by codec_for_delta_encode.
+ *
+ * Each block is summed up right after it is unpacked, while it is still in
+ * the cache, so the values are written to memory once.
+ *
+ * @param values Receives the values.
+ * @param src The first word of the blocks.
+ * @param end The end of the words.
+ * @param count The number of values encoded.
+ * @param base The predecessor of the first value.
+ * @return Pointer past the last block, or nullptr if the blocks are
+ *         truncated or malformed.
+ */
+const uint_t *
+codec_for_delta_decode(uint_t *values, const uint_t *src, const uint_t *end,
+                       usize_t count, uint_t base);
+
+/**
+ * @brief Replaces values by their differences to their predecessors.
+ *
+ * The differences wrap around, so values need not be sorted for the
+ * encoding to be reversible, but only sorted values give small deltas.
+ *
+ * @param dest Receives the differences, may equal values.
+ * @param values The values.
+ * @param count The number of values.
+ * @param base The predecessor of the first value.
+ */
+void
+codec_delta_encode(uint_t *dest, const uint_t *values, usize_t count,
+                   uint_t base);
+
+/**
+ * @brief Restores values from their differences with a prefix sum.
+ *
+ * @param dest Receives the values, may equal deltas.
+ * @param deltas The differences.
+ * @param count The number of values.
+ * @param base The predecessor of the first value.
+ */
+void
+codec_delta_decode(uint_t *dest, const uint_t *deltas, usize_t count,
+                   uint_t base);
+
+/**
+ * @brief Encodes 64-bit values by the zigzag encoded changes of their
+ *        differences.
+ *
+ * The first difference is taken to base and the difference before it is
+ * taken as zero.
+ *
+ * @param dest Receives the encoded values.
+ * @param values The values.
+ * @param count The number of values.
+ * @param base The predecessor of the first value.
+ * @return True on success, false if a change of the difference does not fit
+ *         in 32 bits.
+ */
+bool
+codec_delta2_encode64(uint_t *dest, const ullong_t *values, usize_t count,
+                      ullong_t base);
+
+/**
+ * @brief Decodes values encoded by codec_delta2_encode64.
+ *
+ * @param dest Receives the values.
+ * @param src The encoded values.
+ * @param count The number of values.
+ * @param base The predecessor of the first value.
+ */
+void
+codec_delta2_decode64(ullong_t *dest, const uint_t *src, usize_t count,
+                      ullong_t base);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // LIQUID_CODEC_H
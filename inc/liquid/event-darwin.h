@@ -0,0 +1,24 @@
+#ifndef LIQUID_EVENT_DARWIN_H
+#define LIQUID_EVENT_DARWIN_H
+
+#include "event-posix.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @struct event_backend
+ * @brief The kqueue state of an event loop.
+ */
+typedef struct event_backend
+{
+    sint_t queue; ///< The kqueue, which also holds the wake-up filter.
+} event_backend_t;
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LIQUID_EVENT_DARWIN_H
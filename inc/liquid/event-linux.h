@@ -0,0 +1,25 @@
+#ifndef LIQUID_EVENT_LINUX_H
+#define LIQUID_EVENT_LINUX_H
+
+#include "event-posix.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @struct event_backend
+ * @brief The epoll state of an event loop.
+ */
+typedef struct event_backend
+{
+    sint_t poll; ///< The epoll instance.
+    sint_t wake; ///< The eventfd that wakes the loop.
+} event_backend_t;
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LIQUID_EVENT_LINUX_H
@@ -0,0 +1,27 @@
+#ifndef LIQUID_EVENT_POSIX_H
+#define LIQUID_EVENT_POSIX_H
+
+#include "os-posix.h"
+
+/**
+ * @def EVENT_INVALID_HANDLE
+ * @brief The value of a handle that refers to nothing.
+ */
+#define EVENT_INVALID_HANDLE (-1)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @typedef event_handle_t
+ * @brief Typedef for a handle watched by an event loop, a file descriptor.
+ */
+typedef sint_t event_handle_t;
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LIQUID_EVENT_POSIX_H
@@ -0,0 +1,38 @@
+#ifndef LIQUID_EVENT_WINDOWS_H
+#define LIQUID_EVENT_WINDOWS_H
+
+#include "os-windows.h"
+
+/**
+ * @def EVENT_INVALID_HANDLE
+ * @brief The value of a handle that refers to nothing, the value of
+ *        INVALID_HANDLE_VALUE.
+ */
+#define EVENT_INVALID_HANDLE ((event_handle_t)(-1))
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @typedef event_handle_t
+ * @brief Typedef for a handle watched by an event loop, a file or socket
+ *        opened for overlapped I/O.
+ */
+typedef handle_t event_handle_t;
+
+/**
+ * @struct event_backend
+ * @brief The I/O completion port state of an event loop.
+ */
+typedef struct event_backend
+{
+    handle_t port; ///< The completion port.
+} event_backend_t;
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // LIQUID_EVENT_WINDOWS_H
@@ -0,0 +1,328 @@
+/**
+ * @file event.h
+ * @brief Event loops over epoll, kqueue and I/O completion ports.
+ *
+ * A loop watches sources, each a handle with a callback, and runs timers
+ * from a hierarchical timing wheel in milliseconds. Every run harvests a
+ * batch of up to EVENT_BATCH events from the system with one call and
+ * dispatches them.
+ *
+ * On Linux and Darwin sources report readiness edge-triggered: a callback
+ * sees EVENT_READ or EVENT_WRITE once for every change of state and has to
+ * read or write until the handle would block before it is reported again.
+ * On Windows the handles are associated with the completion port and the
+ * callbacks are called with EVENT_COMPLETE for every overlapped operation
+ * that completes on them.
+ *
+ * A loop belongs to the thread that runs it. The only function other
+ * threads may call is event_loop_wake, which makes the loop call its wake
+ * callback, so that work can be handed to the loop through a queue of the
+ * caller's.
+ */
+
+#ifndef LIQUID_EVENT_H
+#define LIQUID_EVENT_H
+
+#if defined(LIQUID_TARGET_OS_WINDOWS)
+    #include "event-windows.h"
+#elif defined(LIQUID_TARGET_OS_LINUX)
+    #include "event-linux.h"
+#elif defined(LIQUID_TARGET_OS_DARWIN)
+    #include "event-darwin.h"
+#else
+    #error "Unsupported OS for event loops"
+#endif
+
+#include "bool.h"
+#include "wheel.h"
+
+/**
+ * @def EVENT_READ
+ * @brief The handle can be read, or the peer has closed it.
+ */
+#define EVENT_READ 0x01
+
+/**
+ * @def EVENT_WRITE
+ * @brief The handle can be written.
+ */
+#define EVENT_WRITE 0x02
+
+/**
+ * @def EVENT_HANGUP
+ * @brief The peer has closed the handle, reported with EVENT_READ.
+ */
+#define EVENT_HANGUP 0x04
+
+/**
+ * @def EVENT_ERROR
+ * @brief The handle or the completed operation has failed.
+ */
+#define EVENT_ERROR 0x08
+
+/**
+ * @def EVENT_COMPLETE
+ * @brief An overlapped operation has completed, on Windows only.
+ */
+#define EVENT_COMPLETE 0x10
+
+/**
+ * @def EVENT_BATCH
+ * @brief The largest number of events harvested by one system call.
+ */
+#define EVENT_BATCH 64
+
+/**
+ * @def EVENT_INFINITE
+ * @brief The timeout that waits until an event occurs.
+ */
+#define EVENT_INFINITE (-1)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+struct event_loop;
+struct event_source;
+struct event_timer;
+
+/**
+ * @struct event
+ * @brief An event dispatched to a source.
+ */
+typedef struct event
+{
+    uint_t  events;      ///< The EVENT_ flags that occurred.
+    void   *operation;   ///< The OVERLAPPED that completed, or nullptr.
+    usize_t transferred; ///< The bytes the completed operation transferred.
+} event_t;
+
+/**
+ * @typedef event_callback_t
+ * @brief The function called with the events of a source.
+ */
+typedef void (*event_callback_t)(struct event_loop   *loop,
+                                 struct event_source *source,
+                                 const event_t       *event);
+
+/**
+ * @typedef event_timer_callback_t
+ * @brief The function called when a timer expires.
+ */
+typedef void (*event_timer_callback_t)(struct event_loop  *loop,
+                                       struct event_timer *timer);
+
+/**
+ * @typedef event_wake_callback_t
+ * @brief The function called by a loop after it has been woken up.
+ */
+typedef void (*event_wake_callback_t)(struct event_loop *loop);
+
+/**
+ * @struct event_source
+ * @brief A handle watched by a loop, owned by the caller.
+ */
+typedef struct event_source
+{
+    event_callback_t callback; ///< The function called with the events.
+    void            *data;     ///< The data of the caller.
+    event_handle_t   handle;   ///< The handle.
+    uint_t           interest; ///< EVENT_READ and EVENT_WRITE as watched.
+} event_source_t;
+
+/**
+ * @struct event_timer
+ * @brief A one-shot timer, owned by the caller.
+ */
+typedef struct event_timer
+{
+    wheel_timer_t          node;     ///< The timer in the wheel.
+    event_timer_callback_t callback; ///< The function called on expiry.
+    void                  *data;     ///< The data of the caller.
+} event_timer_t;
+
+/**
+ * @struct event_loop
+ * @brief An event loop. It must not be moved while initialized.
+ */
+typedef struct event_loop
+{
+    event_backend_t       backend;      ///< The state of the system.
+    wheel_t               wheel;        ///< The timers.
+    void                 *batch;        ///< The events being dispatched.
+    uint_t                batch_next;   ///< The next event to dispatch.
+    uint_t                batch_size;   ///< The number of events harvested.
+    ullong_t              now;          ///< The time of the current run.
+    event_wake_callback_t on_wake;      ///< The wake callback, or nullptr.
+    void                 *data;         ///< The data of the caller.
+    uint_t                wake_pending; ///< Whether a wake-up is signaled.
+    uint_t                stopped;      ///< Whether event_loop_run stops.
+} event_loop_t;
+
+/**
+ * @brief Reads the monotonic clock.
+ * @return The time in milliseconds since an unspecified start.
+ */
+ullong_t
+event_now(void);
+
+/**
+ * @brief Initializes a loop.
+ *
+ * @param loop The loop to initialize.
+ * @param on_wake The function called after event_loop_wake, or nullptr.
+ * @return True on success, false if the system objects could not be
+ *         created.
+ */
+bool
+event_loop_init(event_loop_t *loop, event_wake_callback_t on_wake);
+
+/**
+ * @brief Releases the system objects of a loop.
+ *
+ * The sources are not closed and the timers are dropped.
+ *
+ * @param loop The loop.
+ */
+void
+event_loop_free(event_loop_t *loop);
+
+/**
+ * @brief Starts watching a source.
+ *
+ * @param loop The loop.
+ * @param source The source with its handle, callback and interest set,
+ *               which must stay valid until removed.
+ * @return True on success, false if the handle cannot be watched.
+ */
+bool
+event_loop_add(event_loop_t *loop, event_source_t *source);
+
+/**
+ * @brief Changes the events watched on a source.
+ *
+ * @param loop The loop.
+ * @param source The source.
+ * @param interest EVENT_READ and EVENT_WRITE.
+ * @return True on success, false on failure.
+ */
+bool
+event_loop_modify(event_loop_t *loop, event_source_t *source,
+                  uint_t interest);
+
+/**
+ * @brief Stops watching a source.
+ *
+ * Events of the source harvested but not dispatched yet are dropped, so a
+ * source can be removed and released from any callback. On Windows the
+ * handle stays associated with the port until it is closed, and its
+ * pending operations still complete to the source.
+ *
+ * @param loop The loop.
+ * @param source The source.
+ * @return True on success, false on failure.
+ */
+bool
+event_loop_remove(event_loop_t *loop, event_source_t *source);
+
+/**
+ * @brief Wakes a loop up from any thread.
+ *
+ * Wake-ups coalesce: the loop calls its wake callback at least once after
+ * every call, but only the first call until then signals the system.
+ *
+ * @param loop The loop.
+ * @return True on success, false if signaling failed.
+ */
+bool
+event_loop_wake(event_loop_t *loop);
+
+/**
+ * @brief Waits for events and dispatches one batch of them.
+ *
+ * @param loop The loop.
+ * @param timeout The longest wait in milliseconds, 0 to not wait or
+ *                EVENT_INFINITE.
+ * @return True on success, also when interrupted, false if waiting failed.
+ */
+bool
+event_loop_poll(event_loop_t *loop, sint_t timeout);
+
+/**
+ * @brief Dispatches one batch of events and the expired timers.
+ *
+ * The wait ends at the next timer at the latest.
+ *
+ * @param loop The loop.
+ * @param timeout The longest wait in milliseconds, 0 to not wait or
+ *                EVENT_INFINITE.
+ * @return True on success, false if waiting failed.
+ */
+bool
+event_loop_run_once(event_loop_t *loop, sint_t timeout);
+
+/**
+ * @brief Runs a loop until event_loop_stop is called.
+ *
+ * @param loop The loop.
+ * @return True when stopped, false if waiting failed.
+ */
+bool
+event_loop_run(event_loop_t *loop);
+
+/**
+ * @brief Makes event_loop_run return, from the thread of the loop.
+ * @param loop The loop.
+ */
+void
+event_loop_stop(event_loop_t *loop);
+
+/**
+ * @brief Initializes a timer.
+ *
+ * @param timer The timer.
+ * @param callback The function called on expiry.
+ * @param data The data of the caller.
+ */
+void
+event_timer_init(event_timer_t *timer, event_timer_callback_t callback,
+                 void *data);
+
+/**
+ * @brief Starts or restarts a timer.
+ *
+ * The callback is called once, by the first run of the loop at least
+ * timeout milliseconds after the time of the current run.
+ *
+ * @param loop The loop.
+ * @param timer The timer, which must stay valid until it expires or is
+ *              stopped.
+ * @param timeout The delay in milliseconds.
+ */
+void
+event_timer_start(event_loop_t *loop, event_timer_t *timer,
+                  ullong_t timeout);
+
+/**
+ * @brief Stops a timer if it is running.
+ *
+ * @param loop The loop.
+ * @param timer The timer.
+ */
+void
+event_timer_stop(event_loop_t *loop, event_timer_t *timer);
+
+/**
+ * @brief Checks whether a timer is running.
+ * @param timer The timer.
+ * @return True if the timer is running.
+ */
+bool
+event_timer_active(const event_timer_t *timer);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LIQUID_EVENT_H
@@ -1,6 +1,6 @@
 #ifndef LIQUID_FS_DARWIN_H
 #define LIQUID_FS_DARWIN_H
 
-#include "os-posix.h"
+#include "fs-posix.h"
 
 #endif // LIQUID_FS_DARWIN_H
@@ -1,6 +1,6 @@
 #ifndef FS_LINUX_H
 #define FS_LINUX_H
 
-#include "os-posix.h"
+#include "fs-posix.h"
 
 #endif // FS_LINUX_H
@@ -1,4 +1,27 @@
 #ifndef FS_POSIX_H
 #define FS_POSIX_H
 
+#include "os-posix.h"
+
+/**
+ * @def FS_INVALID_HANDLE
+ * @brief The value of a handle that refers to no file.
+ */
+#define FS_INVALID_HANDLE (-1)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @typedef fs_handle_t
+ * @brief Typedef for an open file, a file descriptor.
+ */
+typedef sint_t fs_handle_t;
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
 #endif //FS_POSIX_H
@@ -0,0 +1,186 @@
+/**
+ * @file fs-watch.h
+ * @brief Notifications of changes to files and directories.
+ *
+ * A watcher runs on an event loop and reports changes below the paths it
+ * watches in batches: the changes of a path are merged into one entry and
+ * a batch is delivered once no change came for the debounce time, or four
+ * times that after its first change at the latest, so that a burst of
+ * writes wakes the caller once.
+ *
+ * On Linux the watcher uses inotify, with a watch on every directory of a
+ * recursive tree that it adds and removes as directories come and go. On
+ * Darwin it uses an FSEvents stream per path, which covers a whole tree
+ * with one watch. On Windows it uses ReadDirectoryChangesW, completed to
+ * the port of the loop.
+ */
+
+#ifndef LIQUID_FS_WATCH_H
+#define LIQUID_FS_WATCH_H
+
+#include "array.h"
+#include "event.h"
+#include "fs.h"
+#include "map.h"
+
+/**
+ * @def FS_WATCH_CREATED
+ * @brief The path was created or moved in.
+ */
+#define FS_WATCH_CREATED 0x01
+
+/**
+ * @def FS_WATCH_DELETED
+ * @brief The path was deleted or moved out.
+ */
+#define FS_WATCH_DELETED 0x02
+
+/**
+ * @def FS_WATCH_MODIFIED
+ * @brief The content or the attributes of the path changed.
+ */
+#define FS_WATCH_MODIFIED 0x04
+
+/**
+ * @def FS_WATCH_OVERFLOW
+ * @brief Changes were lost, reported with an empty path: the watched
+ *        trees have to be scanned again. The watcher itself keeps watching
+ *        the directories that were created or removed meanwhile.
+ */
+#define FS_WATCH_OVERFLOW 0x08
+
+/**
+ * @def FS_WATCH_RECURSIVE
+ * @brief Watches the whole tree below a directory, not only its entries.
+ */
+#define FS_WATCH_RECURSIVE 0x1
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+struct fs_watch;
+
+/**
+ * @struct fs_watch_change
+ * @brief The changes of a path in a batch.
+ */
+typedef struct fs_watch_change
+{
+    const char_t *path;   ///< The path, ending with a zero.
+    usize_t       size;   ///< The length of the path.
+    uint_t        events; ///< The FS_WATCH_ flags of all its changes.
+} fs_watch_change_t;
+
+/**
+ * @typedef fs_watch_callback_t
+ * @brief The function called with a batch of changes, in the order their
+ *        paths first changed. The batch is valid until it returns.
+ */
+typedef void (*fs_watch_callback_t)(struct fs_watch         *watch,
+                                    const fs_watch_change_t *changes,
+                                    usize_t                  count);
+
+#if defined(LIQUID_TARGET_OS_LINUX)
+/**
+ * @struct fs_watch_backend
+ * @brief The inotify state of a watcher.
+ */
+typedef struct fs_watch_backend
+{
+    event_source_t source; ///< The inotify instance.
+    map_t          paths;  ///< The directory of each watch descriptor.
+    array_t        roots;  ///< The watched paths, scanned after overflows.
+} fs_watch_backend_t;
+#elif defined(LIQUID_TARGET_OS_DARWIN)
+/**
+ * @struct fs_watch_backend
+ * @brief The FSEvents state of a watcher.
+ */
+typedef struct fs_watch_backend
+{
+    event_source_t source;  ///< The end of the pipe the streams signal.
+    sint_t         signal;  ///< The other end of the pipe.
+    void          *queue;   ///< The dispatch queue of the streams.
+    array_t        streams; ///< The streams, one for each watched path.
+    void          *lock;    ///< Guards the changes from the streams.
+    array_t        records; ///< The changes from the streams, serialized.
+} fs_watch_backend_t;
+#elif defined(LIQUID_TARGET_OS_WINDOWS)
+/**
+ * @struct fs_watch_backend
+ * @brief The ReadDirectoryChangesW state of a watcher.
+ */
+typedef struct fs_watch_backend
+{
+    array_t directories; ///< The watched directories, each with its read.
+} fs_watch_backend_t;
+#endif
+
+/**
+ * @struct fs_watch
+ * @brief A watcher. It must not be moved while initialized.
+ */
+typedef struct fs_watch
+{
+    event_loop_t       *loop;     ///< The loop of the watcher.
+    fs_watch_callback_t callback; ///< The function called with batches.
+    void               *data;     ///< The data of the caller.
+    ullong_t            debounce; ///< The milliseconds without a change.
+    ullong_t            first;    ///< The time of the first pending change.
+    event_timer_t       timer;    ///< Delivers the pending batch.
+    array_t             pending;  ///< The pending changes, by first change.
+    array_t             names;    ///< The paths of the pending changes.
+    array_t             batch;    ///< The batch passed to the callback.
+    map_t               index;    ///< The pending change of a path hash.
+    fs_watch_backend_t  backend;  ///< The state of the system.
+} fs_watch_t;
+
+/**
+ * @brief Initializes a watcher on a loop.
+ *
+ * @param watch The watcher.
+ * @param loop The loop, which runs the callback.
+ * @param callback The function called with the batches.
+ * @param debounce The milliseconds without a change before a batch is
+ *                 delivered.
+ * @return True on success, false if the system objects could not be
+ *         created.
+ */
+bool
+fs_watch_init(fs_watch_t *watch, event_loop_t *loop,
+              fs_watch_callback_t callback, ullong_t debounce);
+
+/**
+ * @brief Starts watching a file or directory.
+ *
+ * A directory reports changes to its entries, and with FS_WATCH_RECURSIVE
+ * to everything below it, including directories created later.
+ *
+ * @param watch The watcher.
+ * @param path The path, reported as the prefix of the changed paths.
+ * @param flags Zero or FS_WATCH_RECURSIVE.
+ * @return True on success, false if the path cannot be watched, or on
+ *         Linux a directory below it in a recursive watch.
+ */
+bool
+fs_watch_add(fs_watch_t *watch, const char_t *path, uint_t flags);
+
+/**
+ * @brief Stops watching and releases a watcher, dropping pending changes.
+ *
+ * It must not be called from the callback of the watcher. On Windows the
+ * directories are released once their cancelled reads complete, by the
+ * next run of the loop.
+ *
+ * @param watch The watcher.
+ */
+void
+fs_watch_free(fs_watch_t *watch);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LIQUID_FS_WATCH_H
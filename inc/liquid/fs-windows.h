@@ -1,4 +1,28 @@
 #ifndef LIQUID_FS_WINDOWS_H
 #define LIQUID_FS_WINDOWS_H
 
+#include "os-windows.h"
+
+/**
+ * @def FS_INVALID_HANDLE
+ * @brief The value of a handle that refers to no file, the value of
+ *        INVALID_HANDLE_VALUE.
+ */
+#define FS_INVALID_HANDLE ((fs_handle_t)(-1))
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @typedef fs_handle_t
+ * @brief Typedef for an open file, a file handle.
+ */
+typedef handle_t fs_handle_t;
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
 #endif //LIQUID_FS_WINDOWS_H
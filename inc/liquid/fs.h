@@ -1,3 +1,14 @@
+/**
+ * @file fs.h
+ * @brief Files and buffered file streams.
+ *
+ * The file functions are thin wrappers of the system calls that report
+ * failures through last_error_code. Streams add a buffer on top of a file
+ * and, with FS_LZ4, transparently compress what is written into LZ4 frames
+ * and decompress what is read, so that callers see the plain content. The
+ * compressed files interoperate with the reference lz4 tool.
+ */
+
 #ifndef LIQUID_FS_H
 #define LIQUID_FS_H
 
@@ -11,11 +22,197 @@
     #error "Unsupported OS for file system"
 #endif
 
+#include "alloc.h"
+#include "bool.h"
+#include "lz4.h"
+
+/**
+ * @def FS_READ
+ * @brief Opens a file for reading.
+ */
+#define FS_READ 0x01
+
+/**
+ * @def FS_WRITE
+ * @brief Opens a file for writing.
+ */
+#define FS_WRITE 0x02
+
+/**
+ * @def FS_CREATE
+ * @brief Creates the file if it does not exist.
+ */
+#define FS_CREATE 0x04
+
+/**
+ * @def FS_TRUNCATE
+ * @brief Discards the content of an existing file.
+ */
+#define FS_TRUNCATE 0x08
+
+/**
+ * @def FS_APPEND
+ * @brief Writes at the end of the file.
+ */
+#define FS_APPEND 0x10
+
+/**
+ * @def FS_LZ4
+ * @brief Compresses what a stream writes and decompresses what it reads.
+ */
+#define FS_LZ4 0x20
+
+/**
+ * @def FS_STREAM_BUFFER_SIZE
+ * @brief The buffer size of streams without FS_LZ4.
+ */
+#define FS_STREAM_BUFFER_SIZE (64 * 1024)
+
 #ifdef __cplusplus
 extern "C"
 {
 #endif // __cplusplus
 
+/**
+ * @struct fs_stream
+ * @brief A buffered file stream.
+ */
+typedef struct fs_stream
+{
+    const allocator_t *allocator;    ///< The allocator of the buffers.
+    uchar_t           *buffer;       ///< The content, after history if any.
+    uchar_t           *packed;       ///< The compressed data.
+    usize_t            buffer_size;  ///< The size of the buffer.
+    usize_t            packed_size;  ///< The size of the compressed buffer.
+    usize_t            history;      ///< The decoded bytes kept for linking.
+    usize_t            begin;        ///< The next content byte to read.
+    usize_t            end;          ///< The end of the buffered content.
+    usize_t            packed_begin; ///< The next compressed byte to decode.
+    usize_t            packed_end;   ///< The end of the compressed data read.
+    lz4_state_t        lz4;          ///< The compressor of written frames.
+    lz4_frame_t        frame;        ///< The frame being read or written.
+    fs_handle_t        handle;       ///< The file.
+    uint_t             flags;        ///< The flags the stream was opened with.
+    uint_t             in_frame;     ///< Whether a frame is being read.
+    uint_t             eof;          ///< Whether the file has been read up.
+} fs_stream_t;
+
+/**
+ * @brief Opens a file.
+ *
+ * @param handle Receives the file.
+ * @param path The path of the file.
+ * @param flags FS_READ and FS_WRITE, optionally with FS_CREATE, FS_TRUNCATE
+ *              and FS_APPEND.
+ * @return True on success, false if the file could not be opened.
+ */
+bool
+fs_open(fs_handle_t *handle, const char_t *path, uint_t flags);
+
+/**
+ * @brief Closes a file.
+ * @param handle The file.
+ */
+void
+fs_close(fs_handle_t handle);
+
+/**
+ * @brief Reads from a file.
+ *
+ * @param handle The file.
+ * @param buffer The destination.
+ * @param size The size of the destination.
+ * @param read_size Receives the number of bytes read, zero at the end of
+ *                  the file.
+ * @return True on success, false if reading failed.
+ */
+bool
+fs_read(fs_handle_t handle, void *buffer, usize_t size, usize_t *read_size);
+
+/**
+ * @brief Writes to a file.
+ *
+ * Partial writes are continued until everything is written.
+ *
+ * @param handle The file.
+ * @param buffer The data.
+ * @param size The size of the data.
+ * @return True on success, false if writing failed.
+ */
+bool
+fs_write(fs_handle_t handle, const void *buffer, usize_t size);
+
+/**
+ * @brief Opens a stream.
+ *
+ * A stream is either read or written. Streams written with FS_LZ4 hold a
+ * single frame with independent blocks compressed at LZ4_LEVEL_FAST.
+ * Streams read with FS_LZ4 accept any number of concatenated frames.
+ *
+ * @param stream The stream to initialize.
+ * @param path The path of the file.
+ * @param flags The flags of fs_open with one of FS_READ and FS_WRITE,
+ *              optionally with FS_LZ4.
+ * @param allocator The allocator of the buffers, nullptr for the system
+ *                  one.
+ * @return True on success, false if the file could not be opened, the
+ *         buffers could not be allocated or the frame header could not be
+ *         written.
+ */
+bool
+fs_stream_open(fs_stream_t *stream, const char_t *path, uint_t flags,
+               const allocator_t *allocator);
+
+/**
+ * @brief Closes a stream, flushing it first.
+ *
+ * @param stream The stream.
+ * @return True on success, false if the buffered data could not be
+ *         written.
+ */
+bool
+fs_stream_close(fs_stream_t *stream);
+
+/**
+ * @brief Reads from a stream.
+ *
+ * The destination is filled completely unless the end of the content is
+ * reached.
+ *
+ * @param stream The stream.
+ * @param buffer The destination.
+ * @param size The size of the destination.
+ * @param read_size Receives the number of bytes read, less than size only
+ *                  at the end of the content.
+ * @return True on success, false if reading failed or the compressed data
+ *         is malformed or fails its checksums.
+ */
+bool
+fs_stream_read(fs_stream_t *stream, void *buffer, usize_t size,
+               usize_t *read_size);
+
+/**
+ * @brief Writes to a stream.
+ *
+ * @param stream The stream.
+ * @param buffer The data.
+ * @param size The size of the data.
+ * @return True on success, false if writing failed.
+ */
+bool
+fs_stream_write(fs_stream_t *stream, const void *buffer, usize_t size);
+
+/**
+ * @brief Writes the buffered data of a stream to its file.
+ *
+ * With FS_LZ4 the buffered content is written as a shorter block.
+ *
+ * @param stream The stream.
+ * @return True on success, false if writing failed.
+ */
+bool
+fs_stream_flush(fs_stream_t *stream);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -0,0 +1,209 @@
+/**
+ * @file hash.h
+ * @brief Fast non-cryptographic hashing and CRC32C checksums.
+ *
+ * The 64 and 128-bit hashes implement the XXH3 algorithm and produce the
+ * same values as XXH3_64bits_withSeed and XXH3_128bits_withSeed of the
+ * reference xxHash library on every platform, so they may be stored or used
+ * to shard data across machines. Inputs above 240 bytes are accumulated in
+ * 64-byte stripes with AVX2, SSE2 or NEON where the processor supports it.
+ *
+ * The 32-bit hash implements XXH32, which formats such as the LZ4 frame
+ * use as their checksum.
+ *
+ * The checksum is the CRC-32C of iSCSI and ext4. It uses the dedicated
+ * instructions of SSE4.2 and ARMv8 if available and eight-way table
+ * lookups otherwise.
+ *
+ * Hashes are not suitable for any purpose that must withstand an attacker
+ * choosing the input.
+ */
+
+#ifndef LIQUID_HASH_H
+#define LIQUID_HASH_H
+
+#include "int.h"
+#include "usize.h"
+
+/**
+ * @def HASH_SECRET_SIZE
+ * @brief The size of the key material derived from the seed.
+ */
+#define HASH_SECRET_SIZE 192
+
+/**
+ * @def HASH_BUFFER_SIZE
+ * @brief The number of bytes a hash state buffers between updates.
+ */
+#define HASH_BUFFER_SIZE 256
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @struct hash128
+ * @brief A 128-bit hash value.
+ */
+typedef struct hash128
+{
+    ullong_t low;  ///< The lower 64 bits.
+    ullong_t high; ///< The upper 64 bits.
+} hash128_t;
+
+/**
+ * @struct hash_state
+ * @brief The state of an incremental hash.
+ *
+ * The state is large and should be reused rather than copied around.
+ */
+typedef struct hash_state
+{
+    ullong_t acc[8];                   ///< The stripe accumulators.
+    ullong_t seed;                     ///< The seed of the hash.
+    ullong_t total;                    ///< The number of bytes hashed.
+    usize_t  buffered;                 ///< The number of buffered bytes.
+    usize_t  stripes;                  ///< The stripes of the current block.
+    uchar_t  secret[HASH_SECRET_SIZE]; ///< The key material of the seed.
+    uchar_t  buffer[HASH_BUFFER_SIZE]; ///< The input not accumulated yet.
+} hash_state_t;
+
+/**
+ * @struct hash32_state
+ * @brief The state of an incremental 32-bit hash.
+ */
+typedef struct hash32_state
+{
+    uint_t   acc[4];     ///< The lane accumulators.
+    uint_t   seed;       ///< The seed of the hash.
+    uint_t   buffered;   ///< The number of buffered bytes.
+    ullong_t total;      ///< The number of bytes hashed.
+    uchar_t  buffer[16]; ///< The input not accumulated yet.
+} hash32_state_t;
+
+/**
+ * @brief Computes the 64-bit hash of a range.
+ *
+ * @param begin Pointer to the first byte.
+ * @param end Pointer past the last byte.
+ * @param seed The seed, different seeds give unrelated hashes.
+ * @return The hash value.
+ */
+ullong_t
+hash64(const void *begin, const void *end, ullong_t seed);
+
+/**
+ * @brief Computes the 128-bit hash of a range.
+ *
+ * @param begin Pointer to the first byte.
+ * @param end Pointer past the last byte.
+ * @param seed The seed, different seeds give unrelated hashes.
+ * @return The hash value.
+ */
+hash128_t
+hash128(const void *begin, const void *end, ullong_t seed);
+
+/**
+ * @brief Starts an incremental hash.
+ *
+ * @param state The state to initialize.
+ * @param seed The seed, different seeds give unrelated hashes.
+ */
+void
+hash_init(hash_state_t *state, ullong_t seed);
+
+/**
+ * @brief Feeds a range to an incremental hash.
+ *
+ * Hashing a range in any number of pieces gives the same result as hashing
+ * it at once with hash64 or hash128.
+ *
+ * @param state The state of the hash.
+ * @param begin Pointer to the first byte.
+ * @param end Pointer past the last byte.
+ */
+void
+hash_update(hash_state_t *state, const void *begin, const void *end);
+
+/**
+ * @brief Computes the 64-bit hash of everything fed to a state so far.
+ *
+ * The state is not modified and may be updated further.
+ *
+ * @param state The state of the hash.
+ * @return The hash value.
+ */
+ullong_t
+hash64_final(const hash_state_t *state);
+
+/**
+ * @brief Computes the 128-bit hash of everything fed to a state so far.
+ * @see hash64_final
+ */
+hash128_t
+hash128_final(const hash_state_t *state);
+
+/**
+ * @brief Computes the 32-bit XXH32 hash of a range.
+ *
+ * @param begin Pointer to the first byte.
+ * @param end Pointer past the last byte.
+ * @param seed The seed, different seeds give unrelated hashes.
+ * @return The hash value.
+ */
+uint_t
+hash32(const void *begin, const void *end, uint_t seed);
+
+/**
+ * @brief Starts an incremental 32-bit hash.
+ *
+ * @param state The state to initialize.
+ * @param seed The seed, different seeds give unrelated hashes.
+ */
+void
+hash32_init(hash32_state_t *state, uint_t seed);
+
+/**
+ * @brief Feeds a range to an incremental 32-bit hash.
+ *
+ * Hashing a range in any number of pieces gives the same result as hashing
+ * it at once with hash32.
+ *
+ * @param state The state of the hash.
+ * @param begin Pointer to the first byte.
+ * @param end Pointer past the last byte.
+ */
+void
+hash32_update(hash32_state_t *state, const void *begin, const void *end);
+
+/**
+ * @brief Computes the 32-bit hash of everything fed to a state so far.
+ *
+ * The state is not modified and may be updated further.
+ *
+ * @param state The state of the hash.
+ * @return The hash value.
+ */
+uint_t
+hash32_final(const hash32_state_t *state);
+
+/**
+ * @brief Computes the CRC-32C checksum of a range.
+ *
+ * Checksums of consecutive ranges are chained by passing the checksum of
+ * the previous range, which gives the checksum of the concatenation.
+ *
+ * @param begin Pointer to the first byte.
+ * @param end Pointer past the last byte.
+ * @param crc The checksum of the preceding data, zero to start.
+ * @return The checksum.
+ */
+uint_t
+hash_crc32c(const void *begin, const void *end, uint_t crc);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // LIQUID_HASH_H
@@ -0,0 +1,183 @@
+/**
+ * @file interner.h
+ * @brief Thread-safe string interning with compact 32-bit ids.
+ *
+ * An interner stores one copy of every distinct string it is given and
+ * identifies it by a small integer, so repeated strings such as metric and
+ * label names can be stored and compared as ids. Ids are dense: they are
+ * handed out from zero upwards in the order the strings are first seen and
+ * can index arrays directly.
+ *
+ * Strings are spread over shards by their hash. Looking up a string that is
+ * already interned takes no lock, while inserting a new string locks its
+ * shard only. The bytes of the strings are kept in an arena per shard and
+ * the id of a string stays valid, and its text in place, until the interner
+ * is released.
+ */
+
+#ifndef LIQUID_INTERNER_H
+#define LIQUID_INTERNER_H
+
+#include "arena.h"
+#include "bool.h"
+#include "limits.h"
+#include "os.h"
+
+/**
+ * @def INTERNER_INVALID
+ * @brief The id returned when a string is not interned.
+ */
+#define INTERNER_INVALID LIQUID_UINT_MAX
+
+/**
+ * @def INTERNER_SHARD_COUNT
+ * @brief The number of independently locked shards, a power of two.
+ */
+#define INTERNER_SHARD_COUNT 64
+
+/**
+ * @def INTERNER_CHUNK_FIRST
+ * @brief The number of entries of the first chunk of the id table.
+ *
+ * Every further chunk is twice as large as the previous one, so the table
+ * grows without moving entries that other threads may be reading.
+ */
+#define INTERNER_CHUNK_FIRST 256
+
+/**
+ * @def INTERNER_CHUNK_COUNT
+ * @brief The number of chunks of the id table, enough for 32-bit ids.
+ */
+#define INTERNER_CHUNK_COUNT 24
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @struct interner_entry
+ * @brief The string behind an id.
+ */
+typedef struct interner_entry
+{
+    const char_t *volatile str;  ///< The string, nullptr until written.
+    usize_t                size; ///< The length of the string.
+    ullong_t               hash; ///< The hash of the string.
+} interner_entry_t;
+
+/**
+ * @struct interner_table
+ * @brief The header of the lookup table of a shard.
+ *
+ * The header is followed by the slots of the table. A slot holds the upper
+ * half of the hash of a string and its id plus one, or zero if it is empty.
+ */
+typedef struct interner_table
+{
+    struct interner_table *prev;     ///< The table this one replaced.
+    usize_t                capacity; ///< The number of slots.
+} interner_table_t;
+
+/**
+ * @struct interner_shard
+ * @brief The strings whose hash selects the same shard.
+ */
+typedef struct interner_shard
+{
+    interner_table_t *volatile table; ///< The current lookup table.
+    usize_t                    size;  ///< The number of strings.
+    arena_t                    arena; ///< The storage of the strings.
+    volatile uint_t            lock;  ///< The lock held by insertions.
+} interner_shard_t;
+
+/**
+ * @struct interner
+ * @brief A string interner.
+ */
+typedef struct interner
+{
+    interner_shard_t          *shards;    ///< The shards.
+    void                      *block;     ///< The block holding the shards.
+    const allocator_t         *allocator; ///< The allocator of the tables.
+    volatile uint_t            count;     ///< The number of ids handed out.
+    volatile uint_t            lock;      ///< The lock for adding chunks.
+    interner_entry_t *volatile chunks[INTERNER_CHUNK_COUNT]; ///< The ids.
+} interner_t;
+
+/**
+ * @brief Initializes an empty interner.
+ *
+ * @param interner The interner to initialize.
+ * @param allocator The allocator to use, nullptr selects the system one.
+ *                  It is called by concurrent insertions and must be safe
+ *                  to use from several threads.
+ * @return True on success, false if the allocation failed.
+ */
+bool
+interner_init(interner_t *interner, const allocator_t *allocator);
+
+/**
+ * @brief Releases an interner and every string it holds.
+ *
+ * No other thread may use the interner during or after the call.
+ *
+ * @param interner The interner to release.
+ */
+void
+interner_free(interner_t *interner);
+
+/**
+ * @brief Retrieves the id of a string, interning it if necessary.
+ *
+ * @param interner The interner.
+ * @param begin Pointer to the first character.
+ * @param end Pointer past the last character.
+ * @return The id of the string or INTERNER_INVALID if the allocation
+ *         failed or the ids are exhausted.
+ */
+uint_t
+interner_intern(interner_t *interner, const char_t *begin,
+                const char_t *end);
+
+/**
+ * @brief Retrieves the id of a string without interning it.
+ *
+ * @param interner The interner.
+ * @param begin Pointer to the first character.
+ * @param end Pointer past the last character.
+ * @return The id of the string or INTERNER_INVALID if it is not interned.
+ */
+uint_t
+interner_find(const interner_t *interner, const char_t *begin,
+              const char_t *end);
+
+/**
+ * @brief Retrieves the string behind an id.
+ *
+ * @param interner The interner.
+ * @param id An id returned by the interner.
+ * @param size Receives the length of the string, may be nullptr.
+ * @return The null-terminated string, or nullptr if the id is out of range
+ *         or its string is still being written by another thread.
+ */
+const char_t *
+interner_str(const interner_t *interner, uint_t id, usize_t *size);
+
+/**
+ * @brief Retrieves the number of interned strings.
+ *
+ * While other threads intern strings, the count may include ids that are
+ * being handed out and not returned yet.
+ *
+ * @param interner The interner.
+ * @return The number of ids handed out.
+ */
+uint_t
+interner_count(const interner_t *interner);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // LIQUID_INTERNER_H
@@ -0,0 +1,255 @@
+/**
+ * @file ipc.h
+ * @brief Named shared memory and message rings between processes.
+ *
+ * A region of shared memory is created under a name by one process and
+ * opened by name from others, with shm_open and mmap on POSIX systems and
+ * a file mapping on Windows.
+ *
+ * A ring puts a queue of variable-length messages into such a region. Any
+ * number of producers reserve space for a message, write it in place and
+ * commit it, a single consumer reads it in place and releases it: nothing
+ * is copied and no system call is made while neither side has to wait.
+ * A side that waits, for a message or for space, sleeps on a futex on
+ * Linux, on __ulock_wait on Darwin and on a named semaphore on Windows,
+ * where WaitOnAddress does not reach across processes, and is woken only
+ * when it sleeps.
+ */
+
+#ifndef LIQUID_IPC_H
+#define LIQUID_IPC_H
+
+#include "bool.h"
+#include "fs.h"
+#include "int.h"
+#include "usize.h"
+
+/**
+ * @def IPC_INFINITE
+ * @brief The timeout to wait without limit.
+ */
+#define IPC_INFINITE (-1)
+
+/**
+ * @def IPC_SINGLE_PRODUCER
+ * @brief Creates a ring for a single producer, which reserves without an
+ *        atomic read-modify-write.
+ */
+#define IPC_SINGLE_PRODUCER 0x1
+
+/**
+ * @def IPC_RING_ALIGN
+ * @brief The alignment of the messages and of the size of their headers.
+ */
+#define IPC_RING_ALIGN 8
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @struct ipc_shm
+ * @brief A mapped region of named shared memory.
+ */
+typedef struct ipc_shm
+{
+    void       *data;   ///< The region.
+    usize_t     size;   ///< The size of the region.
+    fs_handle_t handle; ///< The shared memory object.
+} ipc_shm_t;
+
+/**
+ * @struct ipc_ring_header
+ * @brief The state of a ring at the start of its region.
+ *
+ * The positions count bytes since the creation of the ring. Each of the
+ * sides has a line of its own so that they do not share it.
+ */
+typedef struct ipc_ring_header
+{
+    ullong_t magic;          ///< Identifies an initialized ring.
+    ullong_t capacity;       ///< The bytes of messages, a power of two.
+    ullong_t flags;          ///< The flags of the ring.
+    ullong_t padding0[5];    ///< Pads the line.
+    ullong_t head;           ///< The bytes reserved by the producers.
+    ullong_t padding1[7];    ///< Pads the line.
+    ullong_t tail;           ///< The bytes released by the consumer.
+    ullong_t padding2[7];    ///< Pads the line.
+    uint_t   data_seq;       ///< Bumped to wake the consumer.
+    uint_t   data_sleepers;  ///< Whether the consumer sleeps.
+    uint_t   space_seq;      ///< Bumped to wake the producers.
+    uint_t   space_sleepers; ///< The producers that sleep.
+    uint_t   padding3[12];   ///< Pads the line.
+} ipc_ring_header_t;
+
+/**
+ * @struct ipc_ring
+ * @brief A ring as opened by one process.
+ */
+typedef struct ipc_ring
+{
+    ipc_shm_t          shm;      ///< The region.
+    ipc_ring_header_t *header;   ///< The state, at the start of the region.
+    uchar_t           *data;     ///< The messages, after the state.
+    usize_t            capacity; ///< The bytes of messages.
+    void              *waits[2]; ///< The semaphores of the sides on Windows.
+} ipc_ring_t;
+
+/**
+ * @brief Creates a region of named shared memory, filled with zeros.
+ *
+ * @param shm The region.
+ * @param name The name of the region, without a path, up to 30 characters
+ *             for Darwin.
+ * @param size The size of the region.
+ * @return True on success, false if a region of that name exists or it
+ *         could not be created.
+ */
+bool
+ipc_shm_create(ipc_shm_t *shm, const char_t *name, usize_t size);
+
+/**
+ * @brief Opens a region of named shared memory created by another process.
+ *
+ * @param shm The region.
+ * @param name The name of the region.
+ * @return True on success, false if there is no such region.
+ */
+bool
+ipc_shm_open(ipc_shm_t *shm, const char_t *name);
+
+/**
+ * @brief Unmaps a region, which lives on as long as others have it open.
+ * @param shm The region.
+ */
+void
+ipc_shm_close(ipc_shm_t *shm);
+
+/**
+ * @brief Removes the name of a region, so that it cannot be opened any
+ *        more and goes away once closed everywhere.
+ *
+ * The name of a region on Windows goes away with its last handle, there
+ * this does nothing.
+ *
+ * @param name The name of the region.
+ * @return True on success, false if there is no such region.
+ */
+bool
+ipc_shm_remove(const char_t *name);
+
+/**
+ * @brief Creates a ring in a new region of named shared memory.
+ *
+ * @param ring The ring.
+ * @param name The name of the region.
+ * @param capacity The bytes of messages, rounded up to a power of two. A
+ *                 message with its header takes at most half of them.
+ * @param flags Zero or IPC_SINGLE_PRODUCER.
+ * @return True on success, false on failure.
+ */
+bool
+ipc_ring_create(ipc_ring_t *ring, const char_t *name, usize_t capacity,
+                uint_t flags);
+
+/**
+ * @brief Opens a ring created by another process.
+ *
+ * @param ring The ring.
+ * @param name The name of the region.
+ * @return True on success, false if there is no such ring.
+ */
+bool
+ipc_ring_open(ipc_ring_t *ring, const char_t *name);
+
+/**
+ * @brief Closes a ring in this process.
+ * @param ring The ring.
+ */
+void
+ipc_ring_close(ipc_ring_t *ring);
+
+/**
+ * @brief Reserves space for a message.
+ *
+ * The message is written in place and then passed to ipc_ring_commit,
+ * the consumer sees it only then. Messages are aligned to IPC_RING_ALIGN.
+ *
+ * @param ring The ring.
+ * @param size The size of the message.
+ * @param timeout The milliseconds to wait for space, 0 not to wait, or
+ *                IPC_INFINITE.
+ * @return The message, nullptr if there was no space in time.
+ */
+void *
+ipc_ring_reserve(ipc_ring_t *ring, usize_t size, sint_t timeout);
+
+/**
+ * @brief Hands a reserved message over to the consumer.
+ *
+ * @param ring The ring.
+ * @param message The message returned by ipc_ring_reserve.
+ */
+void
+ipc_ring_commit(ipc_ring_t *ring, void *message);
+
+/**
+ * @brief Waits for the oldest message, which stays in the ring until it
+ *        is released.
+ *
+ * Only one process and thread may consume a ring.
+ *
+ * @param ring The ring.
+ * @param size Receives the size of the message.
+ * @param timeout The milliseconds to wait for a message, 0 not to wait, or
+ *                IPC_INFINITE.
+ * @return The message, nullptr if none came in time or the record at the
+ *         tail runs past the end of the ring.
+ */
+const void *
+ipc_ring_peek(ipc_ring_t *ring, usize_t *size, sint_t timeout);
+
+/**
+ * @brief Releases the message returned by the last ipc_ring_peek, giving
+ *        its space back to the producers.
+ * @param ring The ring.
+ */
+void
+ipc_ring_release(ipc_ring_t *ring);
+
+/**
+ * @brief Copies a message into a ring.
+ *
+ * @param ring The ring.
+ * @param message The message.
+ * @param size The size of the message.
+ * @param timeout The milliseconds to wait for space, 0 not to wait, or
+ *                IPC_INFINITE.
+ * @return True on success, false if there was no space in time.
+ */
+bool
+ipc_ring_send(ipc_ring_t *ring, const void *message, usize_t size,
+              sint_t timeout);
+
+/**
+ * @brief Copies the oldest message out of a ring.
+ *
+ * @param ring The ring.
+ * @param buffer The destination.
+ * @param size The size of the destination.
+ * @param received Receives the size of the message.
+ * @param timeout The milliseconds to wait for a message, 0 not to wait, or
+ *                IPC_INFINITE.
+ * @return True on success, false if none came in time or it does not fit,
+ *         in which case it stays in the ring.
+ */
+bool
+ipc_ring_receive(ipc_ring_t *ring, void *buffer, usize_t size,
+                 usize_t *received, sint_t timeout);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LIQUID_IPC_H
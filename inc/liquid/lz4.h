@@ -0,0 +1,293 @@
+/**
+ * @file lz4.h
+ * @brief Fast LZ77 compression in the LZ4 block and frame formats.
+ *
+ * A block is a sequence of literal runs and back references of at least
+ * four bytes reaching up to 64 KiB back. The fast level finds references
+ * with a single probe of a small hash table and compresses hundreds of
+ * megabytes per second; higher levels walk hash chains of growing length
+ * and evaluate the next position before committing to a match, trading
+ * speed for ratio. All levels produce blocks any LZ4 decoder accepts, and
+ * decompression runs at the same speed regardless of the level.
+ *
+ * Frames wrap blocks with a header and an XXH32 checksum of the content,
+ * and interoperate with the reference lz4 tool: frames written here have
+ * independent 256 KiB blocks, and frames with linked blocks, block
+ * checksums, a content size or other block sizes can be read.
+ *
+ * All functions work on begin and end pointers and never write past the
+ * end given for the destination.
+ */
+
+#ifndef LIQUID_LZ4_H
+#define LIQUID_LZ4_H
+
+#include "alloc.h"
+#include "bool.h"
+#include "hash.h"
+#include "usize.h"
+
+/**
+ * @def LZ4_LEVEL_FAST
+ * @brief The fastest compression level.
+ */
+#define LZ4_LEVEL_FAST 1
+
+/**
+ * @def LZ4_LEVEL_MAX
+ * @brief The compression level with the best ratio.
+ */
+#define LZ4_LEVEL_MAX 9
+
+/**
+ * @def LZ4_DISTANCE_MAX
+ * @brief The longest distance of a back reference.
+ */
+#define LZ4_DISTANCE_MAX 65535
+
+/**
+ * @def LZ4_INPUT_MAX
+ * @brief The largest input of lz4_compress.
+ */
+#define LZ4_INPUT_MAX 0x7E000000
+
+/**
+ * @def LZ4_FRAME_HEADER_MAX
+ * @brief The largest size of a frame header.
+ */
+#define LZ4_FRAME_HEADER_MAX 19
+
+/**
+ * @def LZ4_FRAME_BLOCK_SIZE
+ * @brief The uncompressed size of the blocks of frames written here.
+ */
+#define LZ4_FRAME_BLOCK_SIZE (256 * 1024)
+
+/**
+ * @def LZ4_FRAME_BLOCK_BOUND
+ * @brief The largest encoded size of a block written by lz4_frame_block.
+ */
+#define LZ4_FRAME_BLOCK_BOUND (LZ4_FRAME_BLOCK_SIZE + 4)
+
+/**
+ * @def LZ4_FRAME_END_SIZE
+ * @brief The size of the end mark and the checksum closing a frame.
+ */
+#define LZ4_FRAME_END_SIZE 8
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @struct lz4_state
+ * @brief The match finder of a compressor.
+ *
+ * The state is reused across blocks so that its tables are allocated once.
+ */
+typedef struct lz4_state
+{
+    const allocator_t *allocator; ///< The allocator of the tables.
+    uint_t            *head;      ///< The latest position of each hash.
+    ushort_t          *chain;     ///< The distances to earlier positions.
+    uint_t             level;     ///< The compression level.
+} lz4_state_t;
+
+/**
+ * @struct lz4_frame
+ * @brief The decoding state of a frame.
+ */
+typedef struct lz4_frame
+{
+    hash32_state_t checksum;     ///< The hash of the content so far.
+    ullong_t       content_size; ///< The declared size, or ULLONG_MAX.
+    ullong_t       decoded;      ///< The number of bytes decoded so far.
+    usize_t        block_size;   ///< The largest decoded size of a block.
+    uint_t         flags;        ///< The flag byte of the header.
+} lz4_frame_t;
+
+/**
+ * @brief Initializes a compressor.
+ *
+ * @param state The state to initialize.
+ * @param level The level between LZ4_LEVEL_FAST and LZ4_LEVEL_MAX.
+ * @param allocator The allocator of the tables, nullptr for the system one.
+ * @return True on success, false if the tables could not be allocated.
+ */
+bool
+lz4_init(lz4_state_t *state, uint_t level, const allocator_t *allocator);
+
+/**
+ * @brief Releases the tables of a compressor.
+ * @param state The state to release.
+ */
+void
+lz4_free(lz4_state_t *state);
+
+/**
+ * @brief Computes the largest compressed size of a block.
+ *
+ * @param size The size of the input.
+ * @return The size a destination needs so that compression cannot fail.
+ */
+usize_t
+lz4_bound(usize_t size);
+
+/**
+ * @brief Compresses a range into a block.
+ *
+ * @param state The compressor.
+ * @param dest The first byte of the destination.
+ * @param dest_end The end of the destination.
+ * @param begin The first byte of the input.
+ * @param end The end of the input, at most LZ4_INPUT_MAX bytes after begin.
+ * @return Pointer past the block, or nullptr if the destination is too
+ *         small.
+ */
+uchar_t *
+lz4_compress(lz4_state_t *state, uchar_t *dest, uchar_t *dest_end,
+             const uchar_t *begin, const uchar_t *end);
+
+/**
+ * @brief Decompresses a block.
+ *
+ * Blocks of linked frames refer to the output of the preceding blocks,
+ * which has to lie right before dest, starting at history.
+ *
+ * @param history The earliest byte back references may reach, nullptr if
+ *                the block is independent.
+ * @param dest The first byte of the destination.
+ * @param dest_end The end of the destination.
+ * @param begin The first byte of the block.
+ * @param end The end of the block.
+ * @return Pointer past the decompressed data, or nullptr if the block is
+ *         malformed or the destination too small.
+ */
+uchar_t *
+lz4_decompress(const uchar_t *history, uchar_t *dest, uchar_t *dest_end,
+               const uchar_t *begin, const uchar_t *end);
+
+/**
+ * @brief Computes the largest size of a frame.
+ *
+ * @param size The size of the content.
+ * @return The size a destination needs for lz4_frame_compress.
+ */
+usize_t
+lz4_frame_bound(usize_t size);
+
+/**
+ * @brief Compresses a range into a frame.
+ *
+ * @param state The compressor.
+ * @param dest The first byte of the destination.
+ * @param dest_end The end of the destination.
+ * @param begin The first byte of the content.
+ * @param end The end of the content.
+ * @return Pointer past the frame, or nullptr if the destination is too
+ *         small.
+ */
+uchar_t *
+lz4_frame_compress(lz4_state_t *state, uchar_t *dest, uchar_t *dest_end,
+                   const uchar_t *begin, const uchar_t *end);
+
+/**
+ * @brief Decompresses a frame.
+ *
+ * @param dest The first byte of the destination.
+ * @param dest_end The end of the destination.
+ * @param begin The first byte of the frame.
+ * @param end The end of the input, which may hold more after the frame.
+ * @param next Receives the end of the frame, may be nullptr.
+ * @return Pointer past the content, or nullptr if the frame is malformed,
+ *         truncated or fails its checksums or the destination is too small.
+ */
+uchar_t *
+lz4_frame_decompress(uchar_t *dest, uchar_t *dest_end, const uchar_t *begin,
+                     const uchar_t *end, const uchar_t **next);
+
+/**
+ * @brief Writes the header of a frame.
+ *
+ * The content of the frame follows as lz4_frame_block calls and is closed
+ * by lz4_frame_end.
+ *
+ * @param dest The destination, with room for LZ4_FRAME_HEADER_MAX bytes.
+ * @return Pointer past the header.
+ */
+uchar_t *
+lz4_frame_begin(uchar_t *dest);
+
+/**
+ * @brief Writes a block of a frame.
+ *
+ * The block is stored uncompressed if compression does not shrink it.
+ *
+ * @param state The compressor.
+ * @param dest The destination, with room for LZ4_FRAME_BLOCK_BOUND bytes.
+ * @param begin The first byte of the content.
+ * @param end The end of the content, at most LZ4_FRAME_BLOCK_SIZE bytes
+ *            after begin.
+ * @return Pointer past the block.
+ */
+uchar_t *
+lz4_frame_block(lz4_state_t *state, uchar_t *dest, const uchar_t *begin,
+                const uchar_t *end);
+
+/**
+ * @brief Writes the end of a frame.
+ *
+ * @param dest The destination, with room for LZ4_FRAME_END_SIZE bytes.
+ * @param checksum The hash32 of the whole content with seed zero.
+ * @return Pointer past the end of the frame.
+ */
+uchar_t *
+lz4_frame_end(uchar_t *dest, uint_t checksum);
+
+/**
+ * @brief Parses the header of a frame.
+ *
+ * @param frame Receives the decoding state of the frame.
+ * @param begin The first byte of the header.
+ * @param end The end of the input.
+ * @return Pointer past the header, or nullptr if the header is truncated,
+ *         malformed or asks for a dictionary.
+ */
+const uchar_t *
+lz4_frame_header(lz4_frame_t *frame, const uchar_t *begin, const uchar_t *end);
+
+/**
+ * @brief Computes the encoded size of the next block of a frame.
+ *
+ * @param frame The decoding state of the frame.
+ * @param begin The first byte of the block, followed by at least four.
+ * @return The size of the block including its size and checksum fields,
+ *         which is LZ4_FRAME_END_SIZE or less at the end of the frame, or
+ *         zero if the block exceeds the block size of the frame.
+ */
+usize_t
+lz4_frame_block_input(const lz4_frame_t *frame, const uchar_t *begin);
+
+/**
+ * @brief Decodes the next block of a frame.
+ *
+ * @param frame The decoding state of the frame.
+ * @param history The earliest byte blocks of linked frames may refer to,
+ *                followed by the preceding output up to dest.
+ * @param dest The destination, with room for the block size of the frame.
+ * @param begin The first byte of the block, followed by the size given by
+ *              lz4_frame_block_input.
+ * @return Pointer past the decoded data, which equals dest at the end of
+ *         the frame, or nullptr if the block is malformed or a checksum
+ *         does not match.
+ */
+uchar_t *
+lz4_frame_decode(lz4_frame_t *frame, const uchar_t *history, uchar_t *dest,
+                 const uchar_t *begin);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // LIQUID_LZ4_H
@@ -0,0 +1,185 @@
+/**
+ * @file map.h
+ * @brief Open-addressing hash map with fixed-size byte keys.
+ *
+ * The map stores its entries in a single flat block taken from an
+ * allocator: one control byte per slot followed by the slots themselves.
+ * A control byte records whether its slot is empty, deleted or full, and
+ * for full slots seven bits of the hash of the key. Lookups compare sixteen
+ * control bytes at once, with SSE2 or NEON where available, and only look
+ * at keys whose seven hash bits match, so most probes touch a single cache
+ * line of control bytes and one slot.
+ *
+ * Keys and values are copied bytewise like the items of an array. Keys are
+ * hashed with hash64 and compared with array_raw_compare, so they must not
+ * contain padding with unspecified contents.
+ */
+
+#ifndef LIQUID_MAP_H
+#define LIQUID_MAP_H
+
+#include "alloc.h"
+#include "bool.h"
+
+/**
+ * @def MAP_GROUP_SIZE
+ * @brief The number of control bytes inspected by one probe.
+ */
+#define MAP_GROUP_SIZE 16
+
+/**
+ * @def MAP_INIT(map, key_type, value_type, allocator)
+ * @brief Initializes a map of keys and values of the given types.
+ * @param map Pointer to the map to initialize.
+ * @param key_type The type of the keys.
+ * @param value_type The type of the values.
+ * @param allocator The allocator to use, nullptr selects the system one.
+ */
+#define MAP_INIT(map, key_type, value_type, allocator)                         \
+    map_init(map, sizeof(key_type), sizeof(value_type), allocator)
+
+/**
+ * @def MAP_VALUE(map, key)
+ * @brief Retrieves the value stored next to a key returned by map_next.
+ * @param map Pointer to the map.
+ * @param key Pointer to the key inside the map.
+ * @return Pointer to the value.
+ */
+#define MAP_VALUE(map, key) ((void *)((uchar_t *)(key) + (map)->value_offset))
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @struct map
+ * @brief A hash map.
+ */
+typedef struct map
+{
+    uchar_t           *ctrl;         ///< The control bytes.
+    uchar_t           *slots;        ///< The key and value pairs.
+    usize_t            size;         ///< The number of entries.
+    usize_t            capacity;     ///< The number of slots.
+    usize_t            growth_left;  ///< Insertions left before a rehash.
+    usize_t            key_size;     ///< The size of a key in bytes.
+    usize_t            value_size;   ///< The size of a value in bytes.
+    usize_t            value_offset; ///< The offset of a value in its slot.
+    usize_t            slot_size;    ///< The size of a slot in bytes.
+    const allocator_t *allocator;    ///< The allocator of the block.
+} map_t;
+
+/**
+ * @brief Initializes an empty map.
+ *
+ * @param map The map to initialize.
+ * @param key_size The size of a key in bytes, not zero.
+ * @param value_size The size of a value in bytes, zero makes a set.
+ * @param allocator The allocator to use, nullptr selects the system one.
+ */
+void
+map_init(map_t *map, usize_t key_size, usize_t value_size,
+         const allocator_t *allocator);
+
+/**
+ * @brief Releases the entries of a map.
+ * @param map The map to release.
+ */
+void
+map_free(map_t *map);
+
+/**
+ * @brief Removes all entries from a map while keeping its storage.
+ * @param map The map.
+ */
+void
+map_clear(map_t *map);
+
+/**
+ * @brief Ensures that a map can hold the given number of entries
+ *        without rehashing.
+ *
+ * @param map The map.
+ * @param count The number of entries.
+ * @return True on success, false if the allocation failed.
+ */
+bool
+map_reserve(map_t *map, usize_t count);
+
+/**
+ * @brief Rebuilds the slots of a map for the given number of entries.
+ *
+ * Rehashing drops the markers left by deleted entries and may shrink the
+ * storage. It never shrinks below the current number of entries.
+ *
+ * @param map The map.
+ * @param count The number of entries to make room for.
+ * @return True on success, false if the allocation failed.
+ */
+bool
+map_rehash(map_t *map, usize_t count);
+
+/**
+ * @brief Looks up the value of a key.
+ *
+ * @param map The map.
+ * @param key The key.
+ * @return Pointer to the value or nullptr if the key is not present.
+ */
+void *
+map_find(const map_t *map, const void *key);
+
+/**
+ * @brief Looks up a key and inserts it if it is not present.
+ *
+ * @param map The map.
+ * @param key The key.
+ * @param inserted Receives one if the key was inserted and zero if it was
+ *                 already present, may be nullptr.
+ * @return Pointer to the value, which is left uninitialized for inserted
+ *         keys, or nullptr on failure.
+ */
+void *
+map_emplace(map_t *map, const void *key, uint_t *inserted);
+
+/**
+ * @brief Inserts a key or replaces its value.
+ *
+ * @param map The map.
+ * @param key The key.
+ * @param value The value to copy, nullptr leaves it unchanged.
+ * @return Pointer to the value or nullptr on failure.
+ */
+void *
+map_insert(map_t *map, const void *key, const void *value);
+
+/**
+ * @brief Removes a key from a map.
+ *
+ * Other entries stay in place, so erasing the entry just returned by
+ * map_next does not disturb the iteration.
+ *
+ * @param map The map.
+ * @param key The key.
+ * @return True if the key was present.
+ */
+bool
+map_erase(map_t *map, const void *key);
+
+/**
+ * @brief Iterates over the entries of a map in no particular order.
+ *
+ * @param map The map.
+ * @param iter The position of the iteration, set to zero to start.
+ * @return Pointer to the key of the next entry, or nullptr once all entries
+ *         have been visited. The value is retrieved with MAP_VALUE.
+ */
+void *
+map_next(const map_t *map, usize_t *iter);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // LIQUID_MAP_H
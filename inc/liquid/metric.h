@@ -0,0 +1,362 @@
+/**
+ * @file metric.h
+ * @brief Counters, latency histograms and timers for instrumentation.
+ *
+ * A counter is split into METRIC_SHARDS cells a cache line apart, and every
+ * thread adds to the cell of its own, so that threads counting the same
+ * event do not contend. Reading a counter sums the cells.
+ *
+ * A histogram counts values in log-linear buckets: the values below
+ * METRIC_HISTOGRAM_SUB have a bucket each, and every power of two above is
+ * split into METRIC_HISTOGRAM_SUB buckets, which bounds the relative error
+ * of a reported percentile by 1 / METRIC_HISTOGRAM_SUB. The buckets cover
+ * every 64-bit value in fixed memory, recording allocates nothing and only
+ * uses atomic additions, and histograms of the same values can be merged.
+ *
+ * Timers read the time stamp counter where it is invariant and the
+ * monotonic clock elsewhere, and record nanoseconds into a histogram.
+ *
+ * Counters and histograms registered under a name appear in the text and
+ * JSON exports. The library keeps counters of its own, on the copies of
+ * array_raw_copy, the raised exceptions and the file I/O, which count only
+ * when it is built with LIQUID_METRICS defined.
+ */
+
+#ifndef LIQUID_METRIC_H
+#define LIQUID_METRIC_H
+
+#include "bool.h"
+#include "str-builder.h"
+
+/**
+ * @def METRIC_SHARDS
+ * @brief The number of cells of a counter.
+ */
+#define METRIC_SHARDS 16
+
+/**
+ * @def METRIC_CACHE_LINE
+ * @brief The distance between the cells of a counter in bytes.
+ */
+#define METRIC_CACHE_LINE 64
+
+/**
+ * @def METRIC_HISTOGRAM_SUB_BITS
+ * @brief The bits of a value below its highest one that select its bucket.
+ */
+#define METRIC_HISTOGRAM_SUB_BITS 4
+
+/**
+ * @def METRIC_HISTOGRAM_SUB
+ * @brief The number of buckets per power of two.
+ */
+#define METRIC_HISTOGRAM_SUB (1 << METRIC_HISTOGRAM_SUB_BITS)
+
+/**
+ * @def METRIC_HISTOGRAM_BUCKETS
+ * @brief The number of buckets of a histogram, enough for 64-bit values.
+ */
+#define METRIC_HISTOGRAM_BUCKETS                                               \
+    ((64 - METRIC_HISTOGRAM_SUB_BITS + 1) * METRIC_HISTOGRAM_SUB)
+
+/**
+ * @def METRIC_COUNTER
+ * @brief The kind of a counter.
+ */
+#define METRIC_COUNTER 1
+
+/**
+ * @def METRIC_HISTOGRAM
+ * @brief The kind of a histogram.
+ */
+#define METRIC_HISTOGRAM 2
+
+/**
+ * @def METRIC_SCOPE(histogram)
+ * @brief Times the statement or block that follows into a histogram.
+ *
+ * Leaving the block with break, return or goto skips the recording.
+ *
+ * @param histogram Pointer to the histogram.
+ */
+#define METRIC_SCOPE(histogram)                                                \
+    for (metric_timer_t metric_scope_ = metric_timer_start(histogram);         \
+         metric_scope_.running; metric_timer_stop(&metric_scope_))
+
+#if defined(LIQUID_METRICS)
+    /**
+     * @def LIQUID_METRIC_COUNT(counter, value)
+     * @brief Adds to a counter of the library, if it is built with metrics.
+     * @param counter The counter.
+     * @param value The value to add.
+     */
+    #define LIQUID_METRIC_COUNT(counter, value)                                \
+        metric_counter_add(&(counter), value)
+
+    /**
+     * @def LIQUID_METRIC_SCOPE(histogram)
+     * @brief Times the block that follows into a histogram of the library,
+     *        if it is built with metrics.
+     * @param histogram The histogram.
+     */
+    #define LIQUID_METRIC_SCOPE(histogram) METRIC_SCOPE(&(histogram))
+#else
+    #define LIQUID_METRIC_COUNT(counter, value) ((void)0)
+    #define LIQUID_METRIC_SCOPE(histogram)
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @struct metric
+ * @brief The part of counters and histograms that names them.
+ */
+typedef struct metric
+{
+    struct metric *next; ///< The next registered metric.
+    const char    *name; ///< The name in the exports.
+    uint_t         kind; ///< METRIC_COUNTER or METRIC_HISTOGRAM.
+} metric_t;
+
+/**
+ * @struct metric_cell
+ * @brief A cell of a counter, alone on its cache line.
+ */
+typedef struct metric_cell
+{
+    ullong_t value;                          ///< The partial sum.
+    uchar_t  padding[METRIC_CACHE_LINE - 8]; ///< The rest of the line.
+} metric_cell_t;
+
+/**
+ * @struct metric_counter
+ * @brief A counter sharded by thread.
+ */
+typedef struct metric_counter
+{
+    metric_t      base;                 ///< The name and registration.
+    metric_cell_t cells[METRIC_SHARDS]; ///< The partial sums.
+} metric_counter_t;
+
+/**
+ * @struct metric_histogram
+ * @brief A log-linear histogram of 64-bit values. The smallest value is
+ *        kept as its complement, so that a zeroed histogram is empty.
+ */
+typedef struct metric_histogram
+{
+    metric_t base;                              ///< The name and registration.
+    ullong_t buckets[METRIC_HISTOGRAM_BUCKETS]; ///< The counts by bucket.
+    ullong_t sum;                               ///< The sum of the values.
+    ullong_t max;                               ///< The largest value.
+    ullong_t min_inverse;                       ///< The inverted minimum.
+} metric_histogram_t;
+
+/**
+ * @struct metric_summary
+ * @brief The statistics of a histogram.
+ */
+typedef struct metric_summary
+{
+    ullong_t count; ///< The number of values.
+    ullong_t sum;   ///< The sum of the values.
+    ullong_t min;   ///< The smallest value, 0 without values.
+    ullong_t max;   ///< The largest value.
+    ullong_t p50;   ///< The median.
+    ullong_t p90;   ///< The 90th percentile.
+    ullong_t p99;   ///< The 99th percentile.
+    ullong_t p999;  ///< The 99.9th percentile.
+} metric_summary_t;
+
+/**
+ * @struct metric_timer
+ * @brief A running measurement of a duration.
+ */
+typedef struct metric_timer
+{
+    metric_histogram_t *histogram; ///< The histogram of the durations.
+    ullong_t            start;     ///< The clock ticks at the start.
+    uint_t              running;   ///< Whether the timer has not stopped.
+} metric_timer_t;
+
+// The metrics of the library, registered from the start.
+extern metric_counter_t   metric_array_copy_bytes; ///< Bytes copied.
+extern metric_counter_t   metric_exceptions;       ///< Raised exceptions.
+extern metric_counter_t   metric_fs_reads;         ///< Calls of fs_read.
+extern metric_counter_t   metric_fs_read_bytes;    ///< Bytes read.
+extern metric_counter_t   metric_fs_writes;        ///< Calls of fs_write.
+extern metric_counter_t   metric_fs_write_bytes;   ///< Bytes written.
+extern metric_histogram_t metric_fs_read_ns;       ///< Durations of reads.
+extern metric_histogram_t metric_fs_write_ns;      ///< Durations of writes.
+
+/**
+ * @brief Initializes a counter to 0.
+ *
+ * @param counter The counter.
+ * @param name The name in the exports, which must outlive the counter.
+ */
+void
+metric_counter_init(metric_counter_t *counter, const char *name);
+
+/**
+ * @brief Adds to a counter.
+ *
+ * @param counter The counter.
+ * @param value The value to add.
+ */
+void
+metric_counter_add(metric_counter_t *counter, ullong_t value);
+
+/**
+ * @brief Reads a counter.
+ *
+ * Additions that run at the same time may or may not be included.
+ *
+ * @param counter The counter.
+ * @return The sum of the additions since the initialization.
+ */
+ullong_t
+metric_counter_read(const metric_counter_t *counter);
+
+/**
+ * @brief Resets a counter to 0.
+ * @param counter The counter.
+ */
+void
+metric_counter_reset(metric_counter_t *counter);
+
+/**
+ * @brief Initializes an empty histogram.
+ *
+ * @param histogram The histogram.
+ * @param name The name in the exports, which must outlive the histogram.
+ */
+void
+metric_histogram_init(metric_histogram_t *histogram, const char *name);
+
+/**
+ * @brief Records a value into a histogram.
+ *
+ * @param histogram The histogram.
+ * @param value The value.
+ */
+void
+metric_histogram_record(metric_histogram_t *histogram, ullong_t value);
+
+/**
+ * @brief Adds the values of a histogram to another one.
+ *
+ * @param into The histogram to add to.
+ * @param from The histogram to add.
+ */
+void
+metric_histogram_merge(metric_histogram_t       *into,
+                       const metric_histogram_t *from);
+
+/**
+ * @brief Computes a percentile of the values of a histogram.
+ *
+ * @param histogram The histogram.
+ * @param percent The percentile, from 0 to 100.
+ * @return The largest value of the bucket of the percentile, within the
+ *         smallest and largest values, 0 without values.
+ */
+ullong_t
+metric_histogram_percentile(const metric_histogram_t *histogram,
+                            double                    percent);
+
+/**
+ * @brief Computes the statistics of a histogram.
+ *
+ * @param histogram The histogram.
+ * @param summary The statistics.
+ */
+void
+metric_histogram_summarize(const metric_histogram_t *histogram,
+                           metric_summary_t         *summary);
+
+/**
+ * @brief Empties a histogram.
+ * @param histogram The histogram.
+ */
+void
+metric_histogram_reset(metric_histogram_t *histogram);
+
+/**
+ * @brief Reads the clock of the timers.
+ * @return The time in ticks since an unspecified start.
+ */
+ullong_t
+metric_clock_ticks(void);
+
+/**
+ * @brief Converts ticks of the clock of the timers to nanoseconds.
+ * @param ticks The ticks.
+ * @return The nanoseconds.
+ */
+ullong_t
+metric_clock_nanoseconds(ullong_t ticks);
+
+/**
+ * @brief Starts a timer.
+ * @param histogram The histogram that receives the duration.
+ * @return The timer.
+ */
+metric_timer_t
+metric_timer_start(metric_histogram_t *histogram);
+
+/**
+ * @brief Stops a timer and records its duration.
+ * @param timer The timer.
+ * @return The duration in nanoseconds.
+ */
+ullong_t
+metric_timer_stop(metric_timer_t *timer);
+
+/**
+ * @brief Adds a counter or histogram to the exports.
+ * @param metric The base of the counter or histogram, which must stay
+ *               valid until it is unregistered.
+ */
+void
+metric_register(metric_t *metric);
+
+/**
+ * @brief Removes a counter or histogram from the exports.
+ * @param metric The base of the counter or histogram.
+ */
+void
+metric_unregister(metric_t *metric);
+
+/**
+ * @brief Appends the registered metrics as text, a line per metric.
+ *
+ * A counter shows as its name and value, a histogram as its name and the
+ * fields of its summary as name=value pairs.
+ *
+ * @param builder The builder.
+ * @return True on success, false if the builder could not grow.
+ */
+bool
+metric_export_text(str_builder_t *builder);
+
+/**
+ * @brief Appends the registered metrics as a JSON object.
+ *
+ * A counter maps its name to its value, a histogram its name to an object
+ * of the fields of its summary.
+ *
+ * @param builder The builder.
+ * @return True on success, false if the builder could not grow.
+ */
+bool
+metric_export_json(str_builder_t *builder);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LIQUID_METRIC_H
@@ -11,11 +11,96 @@
     #error "Unsupported OS"
 #endif
 
+#include "bool.h"
+#include "int.h"
+
 #ifdef __cplusplus
 extern "C"
 {
 #endif // __cplusplus
 
+/**
+ * @struct os_usage
+ * @brief The resources used by the calling process.
+ *
+ * Counts a system does not keep are zero: Windows counts every page fault
+ * as minor and does not count context switches.
+ */
+typedef struct os_usage
+{
+    ullong_t rss;                  ///< The resident bytes.
+    ullong_t peak_rss;             ///< The most resident bytes so far.
+    ullong_t minor_faults;         ///< The faults served without I/O.
+    ullong_t major_faults;         ///< The faults that waited for I/O.
+    ullong_t voluntary_switches;   ///< The switches to wait for something.
+    ullong_t involuntary_switches; ///< The switches forced by preemption.
+    ullong_t user_ns;              ///< The CPU time in user space.
+    ullong_t system_ns;            ///< The CPU time in the kernel.
+} os_usage_t;
+
+/**
+ * @struct os_load
+ * @brief The load on the whole system.
+ *
+ * The pressures are the percentages of the last 10 seconds in which some
+ * tasks stalled waiting for the resource, as reported by the pressure
+ * stall information of Linux. They are valid only if pressure is non-zero.
+ */
+typedef struct os_load
+{
+    double   averages[3];      ///< The 1, 5 and 15 minute load averages.
+    ullong_t memory_total;     ///< The bytes of physical memory.
+    ullong_t memory_available; ///< The bytes available without swapping.
+    double   cpu_pressure;     ///< The percentage stalled on the CPU.
+    double   memory_pressure;  ///< The percentage stalled on memory.
+    double   io_pressure;      ///< The percentage stalled on I/O.
+    uint_t   pressure;         ///< Non-zero if the pressures are known.
+} os_load_t;
+
+/**
+ * @brief Reads the resources used by the calling process.
+ *
+ * Made to be polled often: on Linux it takes two system calls on a file
+ * kept open and allocates nothing.
+ *
+ * @param usage The usage.
+ * @return True on success, false on failure.
+ */
+bool
+os_usage_read(os_usage_t *usage);
+
+/**
+ * @brief Counts the files, sockets and other handles the calling process
+ *        has open.
+ *
+ * This takes time in proportion to the count, so it is best polled less
+ * often than os_usage_read. Windows counts all of its kernel handles.
+ *
+ * @param count The count.
+ * @return True on success, false on failure.
+ */
+bool
+os_open_files(usize_t *count);
+
+/**
+ * @brief Reads the CPU time used by the calling thread.
+ * @param nanoseconds The time in user space and in the kernel.
+ * @return True on success, false on failure.
+ */
+bool
+os_thread_cpu_time(ullong_t *nanoseconds);
+
+/**
+ * @brief Reads the load on the whole system.
+ *
+ * The load averages are zero on Windows, which does not keep them.
+ *
+ * @param load The load.
+ * @return True on success, false on failure.
+ */
+bool
+os_load_read(os_load_t *load);
+
 /**
  * @brief Get the last error message.
  * @details Retrieves the error message corresponding
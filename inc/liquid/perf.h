@@ -0,0 +1,154 @@
+/**
+ * @file perf.h
+ * @brief Hardware performance counters of the calling thread.
+ *
+ * On Linux a group of counters is opened with perf_event_open: cycles,
+ * instructions, cache misses, branch misses and data TLB misses, counting
+ * in user space only. Being a group they are scheduled onto the PMU
+ * together, so that ratios between them are taken over the same time.
+ * Where the kernel allows user-space reads of the counters, reading a
+ * group takes a few rdpmc instructions instead of a system call.
+ *
+ * Counters the hardware or the kernel does not offer are left out, and
+ * where none can be opened, as when access is denied by
+ * perf_event_paranoid, inside most virtual machines and on other systems,
+ * the group reads as zeros and everything else keeps working.
+ */
+
+#ifndef LIQUID_PERF_H
+#define LIQUID_PERF_H
+
+#include "bool.h"
+#include "int.h"
+#include "usize.h"
+
+/**
+ * @def PERF_CYCLES
+ * @brief The index of the CPU cycles.
+ */
+#define PERF_CYCLES 0
+
+/**
+ * @def PERF_INSTRUCTIONS
+ * @brief The index of the retired instructions.
+ */
+#define PERF_INSTRUCTIONS 1
+
+/**
+ * @def PERF_CACHE_MISSES
+ * @brief The index of the last level cache misses.
+ */
+#define PERF_CACHE_MISSES 2
+
+/**
+ * @def PERF_BRANCH_MISSES
+ * @brief The index of the mispredicted branches.
+ */
+#define PERF_BRANCH_MISSES 3
+
+/**
+ * @def PERF_DTLB_MISSES
+ * @brief The index of the data TLB read misses.
+ */
+#define PERF_DTLB_MISSES 4
+
+/**
+ * @def PERF_COUNTERS
+ * @brief The number of counters of a group.
+ */
+#define PERF_COUNTERS 5
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @struct perf_sample
+ * @brief The values of the counters of a group at one time, or the
+ *        difference between two such samples.
+ */
+typedef struct perf_sample
+{
+    ullong_t values[PERF_COUNTERS]; ///< The counts by PERF_ index.
+    uint_t   valid;                 ///< The bits of the counting indexes.
+} perf_sample_t;
+
+/**
+ * @struct perf
+ * @brief A group of counters of the thread that opened it.
+ */
+typedef struct perf
+{
+    sint_t handles[PERF_COUNTERS]; ///< The handles, -1 where not opened.
+    void  *pages[PERF_COUNTERS];   ///< The pages for user-space reads.
+    uint_t valid;                  ///< The bits of the opened counters.
+} perf_t;
+
+/**
+ * @brief Opens the counters for the calling thread and starts them.
+ *
+ * @param perf The group, which always has to be closed.
+ * @return True if at least one counter was opened, false if the group is
+ *         a no-op.
+ */
+bool
+perf_open(perf_t *perf);
+
+/**
+ * @brief Closes the counters of a group.
+ * @param perf The group.
+ */
+void
+perf_close(perf_t *perf);
+
+/**
+ * @brief Reads the counters of a group, from the thread that opened it.
+ *
+ * The counts are raw, whether read in user space or through the kernel.
+ * When the kernel shares the PMU between groups, they cover only the time
+ * the group was on it. The ratios between them stay right, as the group is
+ * scheduled as a whole.
+ *
+ * @param perf The group.
+ * @param sample The values, zero for the counters that are not open.
+ */
+void
+perf_read(perf_t *perf, perf_sample_t *sample);
+
+/**
+ * @brief Computes the counts between two samples.
+ *
+ * @param start The earlier sample.
+ * @param end The later sample.
+ * @param delta The difference, valid where both samples are.
+ */
+void
+perf_sample_delta(const perf_sample_t *start, const perf_sample_t *end,
+                  perf_sample_t *delta);
+
+/**
+ * @brief Computes the instructions per cycle of a sample.
+ * @param sample The sample, usually a difference.
+ * @return The ratio, 0 if the cycles or instructions did not count.
+ */
+double
+perf_ipc(const perf_sample_t *sample);
+
+/**
+ * @brief Computes a count of a sample per unit of work, such as the cache
+ *        misses per byte processed.
+ *
+ * @param sample The sample, usually a difference.
+ * @param index The PERF_ index of the count.
+ * @param units The units of work.
+ * @return The ratio, 0 if the count did not count or there is no work.
+ */
+double
+perf_per_unit(const perf_sample_t *sample, uint_t index, double units);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LIQUID_PERF_H
@@ -0,0 +1,98 @@
+/**
+ * @file pool.h
+ * @brief Fixed-size block allocator with a free list.
+ *
+ * The pool hands out blocks of a single size carved from chunks of a parent
+ * allocator. Released blocks are kept in an intrusive free list and reused
+ * in LIFO order, so allocation and release are both a couple of pointer
+ * moves. Requests larger than the block size are forwarded to the parent.
+ */
+
+#ifndef LIQUID_POOL_H
+#define LIQUID_POOL_H
+
+#include "alloc.h"
+
+/**
+ * @def LIQUID_POOL_CHUNK_ITEMS
+ * @brief The default number of blocks in a pool chunk.
+ */
+#define LIQUID_POOL_CHUNK_ITEMS 256
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @struct pool_chunk
+ * @brief A chunk of blocks owned by a pool.
+ */
+typedef struct pool_chunk
+{
+    struct pool_chunk *prev; ///< The previously allocated chunk.
+    usize_t            size; ///< The size of the chunk including the header.
+} pool_chunk_t;
+
+/**
+ * @struct pool
+ * @brief A fixed-size block allocator.
+ */
+typedef struct pool
+{
+    allocator_t        allocator;   ///< The allocator interface of the pool.
+    const allocator_t *parent;      ///< The allocator chunks are taken from.
+    pool_chunk_t      *chunk;       ///< The most recently allocated chunk.
+    void              *free_list;   ///< The released blocks.
+    usize_t            item_size;   ///< The size of a block.
+    usize_t            chunk_items; ///< The number of blocks in a chunk.
+} pool_t;
+
+/**
+ * @brief Initializes a pool.
+ *
+ * @param pool The pool to initialize.
+ * @param parent The allocator for the chunks, nullptr selects the system one.
+ * @param item_size The size of a block in bytes.
+ * @param chunk_items The number of blocks in a chunk,
+ *                    zero selects LIQUID_POOL_CHUNK_ITEMS.
+ */
+void
+pool_init(pool_t *pool, const allocator_t *parent, usize_t item_size,
+          usize_t chunk_items);
+
+/**
+ * @brief Releases every chunk owned by a pool.
+ * @param pool The pool to release.
+ */
+void
+pool_free(pool_t *pool);
+
+/**
+ * @brief Takes a block from a pool.
+ * @param pool The pool to allocate from.
+ * @return The allocated block or nullptr on failure.
+ */
+void *
+pool_alloc(pool_t *pool);
+
+/**
+ * @brief Returns a block to a pool.
+ * @param pool The pool the block was taken from.
+ * @param ptr The block to release.
+ */
+void
+pool_release(pool_t *pool, void *ptr);
+
+/**
+ * @brief The resize function of a pool, its context is the pool itself.
+ * @see alloc_fn
+ */
+void *
+pool_alloc_fn(void *ctx, void *ptr, usize_t old_size, usize_t new_size);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // LIQUID_POOL_H
@@ -0,0 +1,180 @@
+/**
+ * @file process.h
+ * @brief Spawning child processes with their standard streams redirected.
+ *
+ * On Linux a child is started with clone(CLONE_VM | CLONE_VFORK), which
+ * shares the memory of the parent until the child executes the program,
+ * so the cost of starting it does not grow with the memory of the parent
+ * as with fork. The child also comes with a pidfd, which an event loop
+ * can watch for the exit of the child. On Darwin a child is started with
+ * posix_spawn and on Windows with CreateProcess.
+ *
+ * Each of the standard streams of a child is inherited from the parent,
+ * connected to a pipe whose other end the parent keeps or connected to the
+ * null device. Only the handles of the parent that are not closed on exec
+ * are inherited besides, on Darwin and Windows none are.
+ */
+
+#ifndef LIQUID_PROCESS_H
+#define LIQUID_PROCESS_H
+
+#include "bool.h"
+#include "fs.h"
+#include "int.h"
+
+/**
+ * @def PROCESS_STDIN
+ * @brief The index of the standard input of a child.
+ */
+#define PROCESS_STDIN 0
+
+/**
+ * @def PROCESS_STDOUT
+ * @brief The index of the standard output of a child.
+ */
+#define PROCESS_STDOUT 1
+
+/**
+ * @def PROCESS_STDERR
+ * @brief The index of the standard error of a child.
+ */
+#define PROCESS_STDERR 2
+
+/**
+ * @def PROCESS_INHERIT
+ * @brief The stream of the child is that of the parent.
+ */
+#define PROCESS_INHERIT 0
+
+/**
+ * @def PROCESS_PIPE
+ * @brief The stream of the child is a pipe to the parent.
+ */
+#define PROCESS_PIPE 1
+
+/**
+ * @def PROCESS_NULL
+ * @brief The stream of the child is the null device.
+ */
+#define PROCESS_NULL 2
+
+/**
+ * @def PROCESS_ASYNC
+ * @brief The ends of the pipes of the parent are non-blocking on POSIX
+ *        systems and overlapped on Windows, to be watched by an event
+ *        loop.
+ */
+#define PROCESS_ASYNC 0x1
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @typedef process_id_t
+ * @brief The identifier of a process.
+ */
+#if defined(LIQUID_TARGET_OS_WINDOWS)
+typedef uint_t process_id_t;
+#else
+typedef sint_t process_id_t;
+#endif
+
+/**
+ * @struct process_options
+ * @brief What a child is spawned with.
+ */
+typedef struct process_options
+{
+    const char_t *const *argv;      ///< The program and its arguments.
+    const char_t *const *env;       ///< NAME=value, nullptr to inherit.
+    const char_t        *directory; ///< The directory, nullptr to inherit.
+    uint_t               stdio[3];  ///< PROCESS_INHERIT, _PIPE or _NULL.
+    uint_t               flags;     ///< Zero or PROCESS_ASYNC.
+} process_options_t;
+
+/**
+ * @struct process
+ * @brief A child process.
+ */
+typedef struct process
+{
+    process_id_t id;       ///< The identifier of the child.
+    fs_handle_t  handle;   ///< The pidfd or process handle of the child.
+    fs_handle_t  stdio[3]; ///< The ends of the pipes of the parent.
+    sint_t       status;   ///< The exit code, or minus the signal.
+    uint_t       exited;   ///< Non-zero if the child was waited for.
+} process_t;
+
+/**
+ * @brief Spawns a child process.
+ *
+ * The program is looked up in the PATH of the parent when its name has no
+ * separator. The argument vector and the environment end with nullptr.
+ * The ends of the pipes of the parent are in stdio, FS_INVALID_HANDLE for
+ * the streams that are not piped; they are closed by the parent, writing
+ * to the standard input of the child until it is closed, and reading from
+ * the others until they end.
+ *
+ * The handle is a pidfd on Linux 5.2 and later, which becomes readable when
+ * the child exits and so can be watched by an event loop for EVENT_READ,
+ * the process handle on Windows and FS_INVALID_HANDLE otherwise.
+ *
+ * @param process The child.
+ * @param options The program, its arguments and its streams.
+ * @return True on success, false if the program could not be executed.
+ */
+bool
+process_spawn(process_t *process, const process_options_t *options);
+
+/**
+ * @brief Waits for a child to exit and collects its status.
+ *
+ * A child that is never waited for stays a zombie on POSIX systems until
+ * the parent exits.
+ *
+ * @param process The child.
+ * @param timeout The milliseconds to wait, 0 not to wait, or -1.
+ * @return True once the child has exited, false if it still runs after
+ *         the timeout, with ETIMEDOUT or WAIT_TIMEOUT, or on failure.
+ */
+bool
+process_wait(process_t *process, sint_t timeout);
+
+/**
+ * @brief Asks a child to terminate, or kills it.
+ *
+ * On Windows both terminate the child at once, with the exit code 1.
+ *
+ * @param process The child.
+ * @param force Zero to send SIGTERM, non-zero to send SIGKILL.
+ * @return True on success, also when the child was waited for already,
+ *         false on failure.
+ */
+bool
+process_kill(process_t *process, uint_t force);
+
+/**
+ * @brief Closes the end of a pipe of the parent, which ends the standard
+ *        input of the child.
+ *
+ * @param process The child.
+ * @param stream PROCESS_STDIN, PROCESS_STDOUT or PROCESS_STDERR.
+ */
+void
+process_close_pipe(process_t *process, uint_t stream);
+
+/**
+ * @brief Closes the pipes and the handle of a child, which keeps running.
+ *
+ * @param process The child.
+ */
+void
+process_close(process_t *process);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LIQUID_PROCESS_H
@@ -0,0 +1,370 @@
+/**
+ * @file serial.h
+ * @brief Primitives for serializing integers into byte buffers.
+ *
+ * Fixed-width values are stored in little or big-endian byte order and are
+ * loaded and stored with single unaligned accesses plus a byte swap where
+ * the order differs from the host.
+ *
+ * Variable-width values use LEB128: seven bits per byte starting with the
+ * least significant group, with the high bit of every byte but the last
+ * set. Signed values are zigzag encoded first so that small magnitudes of
+ * either sign take few bytes. The array decoders process sixteen bytes at
+ * a time with SSE2 or NEON while the values fit in a byte, and otherwise
+ * read eight bytes at once and compact the seven-bit groups with PEXT or a
+ * few shifts, so that decoding costs a handful of instructions per value.
+ */
+
+#ifndef LIQUID_SERIAL_H
+#define LIQUID_SERIAL_H
+
+#include "bitflag.h"
+#include "usize.h"
+#include <string.h>
+
+/**
+ * @def SERIAL_VARINT_MAX32
+ * @brief The largest encoded size of a 32-bit varint.
+ */
+#define SERIAL_VARINT_MAX32 5
+
+/**
+ * @def SERIAL_VARINT_MAX64
+ * @brief The largest encoded size of a 64-bit varint.
+ */
+#define SERIAL_VARINT_MAX64 10
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__)
+    #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        #define SERIAL_HOST_LITTLE
+    #elif __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        #define SERIAL_HOST_BIG
+    #endif
+#elif defined(_MSC_VER)
+    #define SERIAL_HOST_LITTLE
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @brief Loads a little-endian 16-bit value.
+ * @param src Pointer to the first byte, not necessarily aligned.
+ * @return The loaded value.
+ */
+static inline ushort_t
+serial_load_le16(const uchar_t *src)
+{
+#if defined(SERIAL_HOST_LITTLE) || defined(SERIAL_HOST_BIG)
+    ushort_t value;
+    memcpy(&value, src, sizeof(value));
+    #if defined(SERIAL_HOST_BIG)
+    value = bitflag_bswap16(value);
+    #endif
+    return value;
+#else
+    return (ushort_t)(src[0] | src[1] << 8);
+#endif
+}
+
+/**
+ * @brief Loads a little-endian 32-bit value.
+ * @see serial_load_le16
+ */
+static inline uint_t
+serial_load_le32(const uchar_t *src)
+{
+#if defined(SERIAL_HOST_LITTLE) || defined(SERIAL_HOST_BIG)
+    uint_t value;
+    memcpy(&value, src, sizeof(value));
+    #if defined(SERIAL_HOST_BIG)
+    value = bitflag_bswap32(value);
+    #endif
+    return value;
+#else
+    return (uint_t)src[0] | (uint_t)src[1] << 8 | (uint_t)src[2] << 16
+           | (uint_t)src[3] << 24;
+#endif
+}
+
+/**
+ * @brief Loads a little-endian 64-bit value.
+ * @see serial_load_le16
+ */
+static inline ullong_t
+serial_load_le64(const uchar_t *src)
+{
+#if defined(SERIAL_HOST_LITTLE) || defined(SERIAL_HOST_BIG)
+    ullong_t value;
+    memcpy(&value, src, sizeof(value));
+    #if defined(SERIAL_HOST_BIG)
+    value = bitflag_bswap64(value);
+    #endif
+    return value;
+#else
+    return (ullong_t)serial_load_le32(src)
+           | (ullong_t)serial_load_le32(src + 4) << 32;
+#endif
+}
+
+/**
+ * @brief Loads a big-endian 16-bit value.
+ * @see serial_load_le16
+ */
+static inline ushort_t
+serial_load_be16(const uchar_t *src)
+{
+    return bitflag_bswap16(serial_load_le16(src));
+}
+
+/**
+ * @brief Loads a big-endian 32-bit value.
+ * @see serial_load_le16
+ */
+static inline uint_t
+serial_load_be32(const uchar_t *src)
+{
+    return bitflag_bswap32(serial_load_le32(src));
+}
+
+/**
+ * @brief Loads a big-endian 64-bit value.
+ * @see serial_load_le16
+ */
+static inline ullong_t
+serial_load_be64(const uchar_t *src)
+{
+    return bitflag_bswap64(serial_load_le64(src));
+}
+
+/**
+ * @brief Stores a little-endian 16-bit value.
+ * @param dest Pointer to the first byte, not necessarily aligned.
+ * @param value The value to store.
+ */
+static inline void
+serial_store_le16(uchar_t *dest, ushort_t value)
+{
+#if defined(SERIAL_HOST_LITTLE) || defined(SERIAL_HOST_BIG)
+    #if defined(SERIAL_HOST_BIG)
+    value = bitflag_bswap16(value);
+    #endif
+    memcpy(dest, &value, sizeof(value));
+#else
+    dest[0] = (uchar_t)value;
+    dest[1] = (uchar_t)(value >> 8);
+#endif
+}
+
+/**
+ * @brief Stores a little-endian 32-bit value.
+ * @see serial_store_le16
+ */
+static inline void
+serial_store_le32(uchar_t *dest, uint_t value)
+{
+#if defined(SERIAL_HOST_LITTLE) || defined(SERIAL_HOST_BIG)
+    #if defined(SERIAL_HOST_BIG)
+    value = bitflag_bswap32(value);
+    #endif
+    memcpy(dest, &value, sizeof(value));
+#else
+    for (uint_t i = 0; i < 4; ++i)
+    {
+        dest[i] = (uchar_t)(value >> (i * 8));
+    }
+#endif
+}
+
+/**
+ * @brief Stores a little-endian 64-bit value.
+ * @see serial_store_le16
+ */
+static inline void
+serial_store_le64(uchar_t *dest, ullong_t value)
+{
+#if defined(SERIAL_HOST_LITTLE) || defined(SERIAL_HOST_BIG)
+    #if defined(SERIAL_HOST_BIG)
+    value = bitflag_bswap64(value);
+    #endif
+    memcpy(dest, &value, sizeof(value));
+#else
+    serial_store_le32(dest, (uint_t)value);
+    serial_store_le32(dest + 4, (uint_t)(value >> 32));
+#endif
+}
+
+/**
+ * @brief Stores a big-endian 16-bit value.
+ * @see serial_store_le16
+ */
+static inline void
+serial_store_be16(uchar_t *dest, ushort_t value)
+{
+    serial_store_le16(dest, bitflag_bswap16(value));
+}
+
+/**
+ * @brief Stores a big-endian 32-bit value.
+ * @see serial_store_le16
+ */
+static inline void
+serial_store_be32(uchar_t *dest, uint_t value)
+{
+    serial_store_le32(dest, bitflag_bswap32(value));
+}
+
+/**
+ * @brief Stores a big-endian 64-bit value.
+ * @see serial_store_le16
+ */
+static inline void
+serial_store_be64(uchar_t *dest, ullong_t value)
+{
+    serial_store_le64(dest, bitflag_bswap64(value));
+}
+
+/**
+ * @brief Maps a signed 32-bit value to an unsigned one whose magnitude
+ *        grows with the magnitude of the value.
+ *
+ * Zero maps to zero, -1 to 1, 1 to 2, -2 to 3 and so on.
+ *
+ * @param value The signed value.
+ * @return The zigzag encoded value.
+ */
+static inline uint_t
+serial_zigzag32(sint_t value)
+{
+    return (uint_t)value << 1 ^ (0u - ((uint_t)value >> 31));
+}
+
+/**
+ * @brief Reverses serial_zigzag32.
+ * @param value The zigzag encoded value.
+ * @return The signed value.
+ */
+static inline sint_t
+serial_unzigzag32(uint_t value)
+{
+    return (sint_t)(value >> 1 ^ (0u - (value & 1)));
+}
+
+/**
+ * @brief Maps a signed 64-bit value to an unsigned one.
+ * @see serial_zigzag32
+ */
+static inline ullong_t
+serial_zigzag64(sllong_t value)
+{
+    return (ullong_t)value << 1 ^ (0ull - ((ullong_t)value >> 63));
+}
+
+/**
+ * @brief Reverses serial_zigzag64.
+ * @see serial_unzigzag32
+ */
+static inline sllong_t
+serial_unzigzag64(ullong_t value)
+{
+    return (sllong_t)(value >> 1 ^ (0ull - (value & 1)));
+}
+
+/**
+ * @brief Computes the encoded size of a varint.
+ *
+ * @param value The value.
+ * @return The number of bytes serial_varint_encode64 writes, between 1 and
+ *         SERIAL_VARINT_MAX64.
+ */
+static inline usize_t
+serial_varint_size64(ullong_t value)
+{
+    // Each byte holds seven bits: 9 / 64 is a close enough stand-in for
+    // 1 / 7 over the range of bit lengths.
+    return (usize_t)((64 - bitflag_clz64(value | 1)) * 9 + 64) / 64;
+}
+
+/**
+ * @brief Encodes a varint.
+ *
+ * @param dest The buffer, with room for SERIAL_VARINT_MAX64 bytes or for
+ *             serial_varint_size64 of the value.
+ * @param value The value.
+ * @return Pointer past the last byte written.
+ */
+uchar_t *
+serial_varint_encode64(uchar_t *dest, ullong_t value);
+
+/**
+ * @brief Decodes a varint.
+ *
+ * @param begin The first byte of the varint.
+ * @param end The end of the buffer.
+ * @param value Receives the value.
+ * @return Pointer past the varint, or nullptr if the buffer ends inside
+ *         the varint or the varint exceeds 64 bits.
+ */
+const uchar_t *
+serial_varint_decode64(const uchar_t *begin, const uchar_t *end,
+                       ullong_t *value);
+
+/**
+ * @brief Decodes a varint that has to fit in 32 bits.
+ * @see serial_varint_decode64
+ */
+const uchar_t *
+serial_varint_decode32(const uchar_t *begin, const uchar_t *end,
+                       uint_t *value);
+
+/**
+ * @brief Encodes an array of values as consecutive varints.
+ *
+ * @param dest The buffer, with room for SERIAL_VARINT_MAX64 bytes per value
+ *             or for the sum of their serial_varint_size64.
+ * @param values The values.
+ * @param count The number of values.
+ * @return Pointer past the last byte written.
+ */
+uchar_t *
+serial_varint_encode_array64(uchar_t *dest, const ullong_t *values,
+                             usize_t count);
+
+/**
+ * @brief Encodes an array of 32-bit values as consecutive varints.
+ * @see serial_varint_encode_array64
+ */
+uchar_t *
+serial_varint_encode_array32(uchar_t *dest, const uint_t *values,
+                             usize_t count);
+
+/**
+ * @brief Decodes consecutive varints into an array.
+ *
+ * @param begin The first byte of the varints.
+ * @param end The end of the buffer.
+ * @param values Receives the values.
+ * @param count The number of values to decode.
+ * @return Pointer past the last varint, or nullptr if the buffer holds
+ *         fewer varints or a malformed one. The content of values is
+ *         unspecified in that case.
+ */
+const uchar_t *
+serial_varint_decode_array64(const uchar_t *begin, const uchar_t *end,
+                             ullong_t *values, usize_t count);
+
+/**
+ * @brief Decodes consecutive varints that have to fit in 32 bits.
+ * @see serial_varint_decode_array64
+ */
+const uchar_t *
+serial_varint_decode_array32(const uchar_t *begin, const uchar_t *end,
+                             uint_t *values, usize_t count);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // LIQUID_SERIAL_H
@@ -0,0 +1,6 @@
+#ifndef LIQUID_SOCKET_DARWIN_H
+#define LIQUID_SOCKET_DARWIN_H
+
+#include "socket-posix.h"
+
+#endif // LIQUID_SOCKET_DARWIN_H
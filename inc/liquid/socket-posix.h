@@ -0,0 +1,38 @@
+#ifndef LIQUID_SOCKET_POSIX_H
+#define LIQUID_SOCKET_POSIX_H
+
+#include "os-posix.h"
+
+/**
+ * @def SOCKET_INVALID_HANDLE
+ * @brief The value of a handle that refers to no socket.
+ */
+#define SOCKET_INVALID_HANDLE (-1)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @typedef socket_handle_t
+ * @brief Typedef for a socket, a file descriptor that event loops watch
+ *        as it is.
+ */
+typedef sint_t socket_handle_t;
+
+/**
+ * @struct socket_buffer
+ * @brief A buffer of scatter-gather I/O, laid out as struct iovec.
+ */
+typedef struct socket_buffer
+{
+    void   *data; ///< The bytes.
+    usize_t size; ///< The number of bytes.
+} socket_buffer_t;
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LIQUID_SOCKET_POSIX_H
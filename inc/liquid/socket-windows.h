@@ -0,0 +1,39 @@
+#ifndef LIQUID_SOCKET_WINDOWS_H
+#define LIQUID_SOCKET_WINDOWS_H
+
+#include "os-windows.h"
+
+/**
+ * @def SOCKET_INVALID_HANDLE
+ * @brief The value of a handle that refers to no socket, the value of
+ *        INVALID_SOCKET.
+ */
+#define SOCKET_INVALID_HANDLE ((socket_handle_t)(-1))
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @typedef socket_handle_t
+ * @brief Typedef for a socket, a SOCKET. Event loops watch it cast to a
+ *        handle.
+ */
+typedef usize_t socket_handle_t;
+
+/**
+ * @struct socket_buffer
+ * @brief A buffer of scatter-gather I/O, laid out as WSABUF.
+ */
+typedef struct socket_buffer
+{
+    uint_t size; ///< The number of bytes.
+    void  *data; ///< The bytes.
+} socket_buffer_t;
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // LIQUID_SOCKET_WINDOWS_H
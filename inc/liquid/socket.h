@@ -0,0 +1,376 @@
+/**
+ * @file socket.h
+ * @brief Non-blocking TCP, UDP and Unix domain sockets.
+ *
+ * Every socket is opened non-blocking and close-on-exec, ready to be
+ * watched by an event loop. Operations that would block fail with an error
+ * that socket_would_block recognizes. Failures are reported through
+ * last_error_code.
+ *
+ * Messages gather or scatter their data over several buffers, and the
+ * batch functions send or receive many datagrams with one system call on
+ * Linux, with sendmmsg and recvmmsg. On the other systems they fall back
+ * to a call per message with the same results.
+ *
+ * On Linux, sockets with zero-copy enabled can send with SOCKET_ZEROCOPY:
+ * the system then reads the data straight from the buffers, which have to
+ * stay unchanged until socket_zerocopy_reap reports the send completed.
+ * Completions are queued as errors of the socket, so a loop reports them
+ * with EVENT_ERROR.
+ *
+ * On Windows the sockets are plain non-blocking ones. Loops dispatch only
+ * completions there, so sockets watched by them need overlapped I/O of
+ * the caller's.
+ */
+
+#ifndef LIQUID_SOCKET_H
+#define LIQUID_SOCKET_H
+
+#if defined(LIQUID_TARGET_OS_WINDOWS)
+    #include "socket-windows.h"
+#elif defined(LIQUID_TARGET_OS_LINUX)
+    #include "socket-linux.h"
+#elif defined(LIQUID_TARGET_OS_DARWIN)
+    #include "socket-darwin.h"
+#else
+    #error "Unsupported OS for sockets"
+#endif
+
+#include "bool.h"
+
+/**
+ * @def SOCKET_STREAM
+ * @brief A stream socket, TCP for IP addresses.
+ */
+#define SOCKET_STREAM 1
+
+/**
+ * @def SOCKET_DATAGRAM
+ * @brief A datagram socket, UDP for IP addresses.
+ */
+#define SOCKET_DATAGRAM 2
+
+/**
+ * @def SOCKET_REUSE_ADDRESS
+ * @brief Binds to an address still held by closed connections.
+ */
+#define SOCKET_REUSE_ADDRESS 0x01
+
+/**
+ * @def SOCKET_REUSE_PORT
+ * @brief Binds to an address bound by other sockets with this flag, so
+ *        that they share its traffic.
+ */
+#define SOCKET_REUSE_PORT 0x02
+
+/**
+ * @def SOCKET_ZEROCOPY
+ * @brief Sends without copying the data, see socket_zerocopy_enable.
+ */
+#define SOCKET_ZEROCOPY 0x01
+
+/**
+ * @def SOCKET_SHARD_BACKLOG
+ * @brief The backlog of the stream sockets opened by socket_shard_open.
+ */
+#define SOCKET_SHARD_BACKLOG 1024
+
+/**
+ * @def SOCKET_BATCH
+ * @brief The largest number of messages passed to one system call.
+ */
+#define SOCKET_BATCH 64
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @struct socket_address
+ * @brief An address of any family.
+ */
+typedef struct socket_address
+{
+    ullong_t storage[16]; ///< The system address, a sockaddr_storage.
+    uint_t   size;        ///< The size of the system address.
+} socket_address_t;
+
+/**
+ * @struct socket_message
+ * @brief A message sent or received, possibly over several buffers.
+ */
+typedef struct socket_message
+{
+    socket_buffer_t  *buffers;   ///< The buffers.
+    usize_t           count;     ///< The number of buffers.
+    socket_address_t *address;   ///< The peer, or nullptr if connected.
+    usize_t           size;      ///< Receives the bytes transferred.
+    uint_t            truncated; ///< Whether the datagram did not fit.
+} socket_message_t;
+
+/**
+ * @struct socket_completion
+ * @brief A range of zero-copy sends that have completed.
+ *
+ * Sends are numbered per socket from zero in the order they were made,
+ * one number per message, and the numbers wrap around at 32 bits.
+ */
+typedef struct socket_completion
+{
+    uint_t first;  ///< The number of the first completed send.
+    uint_t last;   ///< The number of the last completed send.
+    uint_t copied; ///< Whether the system has copied the data after all.
+} socket_completion_t;
+
+/**
+ * @brief Sets an IPv4 or IPv6 address.
+ *
+ * @param address The address.
+ * @param host The numeric host, such as "127.0.0.1" or "::1".
+ * @param port The port, 0 to bind to any free one.
+ * @return True on success, false if the host is not a numeric address.
+ */
+bool
+socket_address_ip(socket_address_t *address, const char *host,
+                  ushort_t port);
+
+/**
+ * @brief Sets a Unix domain address.
+ *
+ * @param address The address.
+ * @param path The path of the socket file.
+ * @return True on success, false if the path is too long.
+ */
+bool
+socket_address_unix(socket_address_t *address, const char *path);
+
+/**
+ * @brief Gets the port of an address.
+ * @param address The address.
+ * @return The port, 0 if the address is not an IP one.
+ */
+ushort_t
+socket_address_port(const socket_address_t *address);
+
+/**
+ * @brief Opens a non-blocking socket.
+ *
+ * @param handle Receives the socket.
+ * @param address An address of the family of the socket.
+ * @param type SOCKET_STREAM or SOCKET_DATAGRAM.
+ * @return True on success, false if the socket could not be opened.
+ */
+bool
+socket_open(socket_handle_t *handle, const socket_address_t *address,
+            uint_t type);
+
+/**
+ * @brief Closes a socket.
+ * @param handle The socket.
+ */
+void
+socket_close(socket_handle_t handle);
+
+/**
+ * @brief Binds a socket to a local address.
+ *
+ * @param handle The socket.
+ * @param address The address.
+ * @param flags SOCKET_REUSE_ADDRESS and SOCKET_REUSE_PORT.
+ * @return True on success, false on failure.
+ */
+bool
+socket_bind(socket_handle_t handle, const socket_address_t *address,
+            uint_t flags);
+
+/**
+ * @brief Gets the local address of a socket, with the port chosen when it
+ *        was bound to port 0.
+ *
+ * @param handle The socket.
+ * @param address Receives the address.
+ * @return True on success, false on failure.
+ */
+bool
+socket_local_address(socket_handle_t handle, socket_address_t *address);
+
+/**
+ * @brief Makes a bound stream socket accept connections.
+ *
+ * @param handle The socket.
+ * @param backlog The largest number of connections waiting to be accepted.
+ * @return True on success, false on failure.
+ */
+bool
+socket_listen(socket_handle_t handle, uint_t backlog);
+
+/**
+ * @brief Accepts a connection.
+ *
+ * @param handle The listening socket.
+ * @param accepted Receives the non-blocking socket of the connection.
+ * @param peer Receives the address of the peer, or nullptr.
+ * @return True on success, false on failure or if no connection waits.
+ */
+bool
+socket_accept(socket_handle_t handle, socket_handle_t *accepted,
+              socket_address_t *peer);
+
+/**
+ * @brief Starts connecting a socket.
+ *
+ * A stream socket becomes writable once the connection is established or
+ * has failed, which socket_connect_result then tells apart.
+ *
+ * @param handle The socket.
+ * @param address The address of the peer.
+ * @return True if connected or connecting, false on failure.
+ */
+bool
+socket_connect(socket_handle_t handle, const socket_address_t *address);
+
+/**
+ * @brief Gets the outcome of a connection started by socket_connect.
+ * @param handle The socket.
+ * @return True if connected, false with the error of the connection.
+ */
+bool
+socket_connect_result(socket_handle_t handle);
+
+/**
+ * @brief Enables or disables the delay of small stream writes.
+ *
+ * @param handle The TCP socket.
+ * @param enable Non-zero to send small writes at once, zero to delay
+ *               them.
+ * @return True on success, false on failure.
+ */
+bool
+socket_set_nodelay(socket_handle_t handle, uint_t enable);
+
+/**
+ * @brief Sets the sizes of the system buffers of a socket.
+ *
+ * High packet rates need large receive buffers to ride out the moments
+ * the receiver does not run.
+ *
+ * @param handle The socket.
+ * @param receive The size of the receive buffer, 0 to keep it.
+ * @param send The size of the send buffer, 0 to keep it.
+ * @return True on success, false on failure.
+ */
+bool
+socket_set_buffer_sizes(socket_handle_t handle, usize_t receive,
+                        usize_t send);
+
+/**
+ * @brief Checks whether the last failure was an operation that would
+ *        block.
+ * @return True if the operation has to wait for the socket to be ready.
+ */
+bool
+socket_would_block(void);
+
+/**
+ * @brief Sends a message.
+ *
+ * A stream socket may send only part of the message.
+ *
+ * @param handle The socket.
+ * @param message The message, its size receives the bytes sent.
+ * @param flags SOCKET_ZEROCOPY or 0.
+ * @return True on success, false on failure.
+ */
+bool
+socket_send(socket_handle_t handle, socket_message_t *message,
+            uint_t flags);
+
+/**
+ * @brief Receives a message.
+ *
+ * @param handle The socket.
+ * @param message The message, its size receives the bytes received, zero
+ *                at the end of a stream, and its address the sender.
+ * @return True on success, false on failure.
+ */
+bool
+socket_recv(socket_handle_t handle, socket_message_t *message);
+
+/**
+ * @brief Sends many messages.
+ *
+ * Sending stops at the first message that cannot be sent.
+ *
+ * @param handle The socket.
+ * @param messages The messages, their sizes receive the bytes sent.
+ * @param count The number of messages.
+ * @param flags SOCKET_ZEROCOPY or 0.
+ * @param sent Receives the number of messages sent.
+ * @return True if at least one message was sent, false on failure.
+ */
+bool
+socket_send_batch(socket_handle_t handle, socket_message_t *messages,
+                  usize_t count, uint_t flags, usize_t *sent);
+
+/**
+ * @brief Receives the messages that have arrived, up to a number.
+ *
+ * @param handle The socket.
+ * @param messages The messages, as for socket_recv.
+ * @param count The number of messages.
+ * @param received Receives the number of messages received.
+ * @return True if at least one message was received, false on failure.
+ */
+bool
+socket_recv_batch(socket_handle_t handle, socket_message_t *messages,
+                  usize_t count, usize_t *received);
+
+/**
+ * @brief Allows a socket to send with SOCKET_ZEROCOPY.
+ *
+ * Zero-copy pays off for sends of ten kilobytes and more. The system may
+ * still copy, over the loopback device for one, and tells so on
+ * completion.
+ *
+ * @param handle The TCP or UDP socket.
+ * @return True on success, false if the system does not support it.
+ */
+bool
+socket_zerocopy_enable(socket_handle_t handle);
+
+/**
+ * @brief Gets the next completion of zero-copy sends.
+ *
+ * @param handle The socket.
+ * @param completion Receives the completed range.
+ * @return True on success, false on failure or if no send has completed.
+ */
+bool
+socket_zerocopy_reap(socket_handle_t handle, socket_completion_t *completion);
+
+/**
+ * @brief Opens sockets that share an address, one per receiving thread.
+ *
+ * Several sockets are bound with SOCKET_REUSE_PORT, and stream ones listen
+ * with SOCKET_SHARD_BACKLOG. On Linux the datagrams and
+ * connections are spread by the CPU that handles them, so that with as
+ * many sockets as CPUs each thread receives what its CPU handled. Darwin
+ * spreads them by its own rules, and Windows cannot share ports at all.
+ *
+ * @param handles Receives the sockets.
+ * @param count The number of sockets.
+ * @param address The address, whose port receives the one bound when 0.
+ * @param type SOCKET_STREAM or SOCKET_DATAGRAM.
+ * @return True on success, false if any socket could not be opened or
+ *         bound, in which case none is left open.
+ */
+bool
+socket_shard_open(socket_handle_t *handles, usize_t count,
+                  socket_address_t *address, uint_t type);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LIQUID_SOCKET_H
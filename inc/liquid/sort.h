@@ -0,0 +1,214 @@
+/**
+ * @file sort.h
+ * @brief Sorting and searching kernels for arrays of primitive keys.
+ *
+ * The radix sorts take time linear in the number of keys and are the
+ * fastest way to sort large arrays. Given scratch space of the size of the
+ * input they sort from the least significant byte up and are stable,
+ * without it they permute the keys in place from the most significant byte
+ * down and are not. The comparison sorts are pattern-defeating quicksort,
+ * which partitions blocks of keys without branches and sorts presorted and
+ * repetitive input in linear time.
+ *
+ * Floats sort in the total order of their bits: -0.0 before 0.0 and NaNs
+ * at the ends according to their sign.
+ *
+ * The searches return the index of the first key not less than the given
+ * one, like std::lower_bound. A sorted array is searched with branchless
+ * halving. Arrays searched many times can be rearranged into the Eytzinger
+ * layout of a binary heap first, which keeps the next levels of the search
+ * in the same cache lines and so is faster on arrays larger than the cache.
+ */
+
+#ifndef LIQUID_SORT_H
+#define LIQUID_SORT_H
+
+#include "usize.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @brief Sorts unsigned integers with a radix sort.
+ *
+ * @param keys The keys.
+ * @param count The number of keys.
+ * @param scratch Space for count keys for the stable sort, nullptr to sort
+ *                in place.
+ */
+void
+sort_radix_uint(uint_t *keys, usize_t count, uint_t *scratch);
+
+/**
+ * @brief Sorts unsigned 64-bit integers with a radix sort.
+ *
+ * @param keys The keys.
+ * @param count The number of keys.
+ * @param scratch Space for count keys for the stable sort, nullptr to sort
+ *                in place.
+ */
+void
+sort_radix_ullong(ullong_t *keys, usize_t count, ullong_t *scratch);
+
+/**
+ * @brief Sorts floats with a radix sort.
+ *
+ * @param keys The keys.
+ * @param count The number of keys.
+ * @param scratch Space for count keys for the stable sort, nullptr to sort
+ *                in place.
+ */
+void
+sort_radix_float(float *keys, usize_t count, float *scratch);
+
+/**
+ * @brief Sorts unsigned integer keys and their values with a radix sort.
+ *
+ * @param keys The keys.
+ * @param values The values, moved along with their keys.
+ * @param count The number of keys.
+ * @param key_scratch Space for count keys for the stable sort, nullptr to
+ *                    sort in place.
+ * @param value_scratch Space for count values, nullptr if key_scratch is.
+ */
+void
+sort_radix_pairs_uint(uint_t *keys, uint_t *values, usize_t count,
+                      uint_t *key_scratch, uint_t *value_scratch);
+
+/**
+ * @brief Sorts unsigned 64-bit integer keys and their values with a radix
+ *        sort.
+ *
+ * @param keys The keys.
+ * @param values The values, moved along with their keys.
+ * @param count The number of keys.
+ * @param key_scratch Space for count keys for the stable sort, nullptr to
+ *                    sort in place.
+ * @param value_scratch Space for count values, nullptr if key_scratch is.
+ */
+void
+sort_radix_pairs_ullong(ullong_t *keys, ullong_t *values, usize_t count,
+                        ullong_t *key_scratch, ullong_t *value_scratch);
+
+/**
+ * @brief Sorts float keys and their values with a radix sort.
+ *
+ * @param keys The keys.
+ * @param values The values, moved along with their keys.
+ * @param count The number of keys.
+ * @param key_scratch Space for count keys for the stable sort, nullptr to
+ *                    sort in place.
+ * @param value_scratch Space for count values, nullptr if key_scratch is.
+ */
+void
+sort_radix_pairs_float(float *keys, uint_t *values, usize_t count,
+                       float *key_scratch, uint_t *value_scratch);
+
+/**
+ * @brief Sorts unsigned integers with pattern-defeating quicksort.
+ *
+ * @param keys The keys.
+ * @param count The number of keys.
+ */
+void
+sort_uint(uint_t *keys, usize_t count);
+
+/**
+ * @brief Sorts unsigned 64-bit integers with pattern-defeating quicksort.
+ *
+ * @param keys The keys.
+ * @param count The number of keys.
+ */
+void
+sort_ullong(ullong_t *keys, usize_t count);
+
+/**
+ * @brief Sorts floats with pattern-defeating quicksort.
+ *
+ * @param keys The keys.
+ * @param count The number of keys.
+ */
+void
+sort_float(float *keys, usize_t count);
+
+/**
+ * @brief Finds the first key of a sorted array not less than a key.
+ *
+ * @param keys The sorted keys.
+ * @param count The number of keys.
+ * @param key The key to search for.
+ * @return The index of the first key not less than key, count if there is
+ *         none.
+ */
+usize_t
+sort_lower_bound_uint(const uint_t *keys, usize_t count, uint_t key);
+
+/**
+ * @brief Finds the first key of a sorted array not less than a key.
+ *
+ * @param keys The sorted keys.
+ * @param count The number of keys.
+ * @param key The key to search for.
+ * @return The index of the first key not less than key, count if there is
+ *         none.
+ */
+usize_t
+sort_lower_bound_ullong(const ullong_t *keys, usize_t count, ullong_t key);
+
+/**
+ * @brief Rearranges a sorted array into the Eytzinger layout.
+ *
+ * The layout stores the root at index 0 and the children of the key at
+ * index i at 2i + 1 and 2i + 2.
+ *
+ * @param dest The layout, not overlapping sorted.
+ * @param sorted The sorted keys.
+ * @param count The number of keys.
+ */
+void
+sort_eytzinger_uint(uint_t *dest, const uint_t *sorted, usize_t count);
+
+/**
+ * @brief Rearranges a sorted array into the Eytzinger layout.
+ *
+ * @param dest The layout, not overlapping sorted.
+ * @param sorted The sorted keys.
+ * @param count The number of keys.
+ * @see sort_eytzinger_uint
+ */
+void
+sort_eytzinger_ullong(ullong_t *dest, const ullong_t *sorted, usize_t count);
+
+/**
+ * @brief Finds the first key not less than a key in an Eytzinger layout.
+ *
+ * @param layout The keys in Eytzinger layout.
+ * @param count The number of keys.
+ * @param key The key to search for.
+ * @return The index into the layout of the first key not less than key,
+ *         count if there is none.
+ */
+usize_t
+sort_eytzinger_lower_bound_uint(const uint_t *layout, usize_t count,
+                                uint_t key);
+
+/**
+ * @brief Finds the first key not less than a key in an Eytzinger layout.
+ *
+ * @param layout The keys in Eytzinger layout.
+ * @param count The number of keys.
+ * @param key The key to search for.
+ * @return The index into the layout of the first key not less than key,
+ *         count if there is none.
+ */
+usize_t
+sort_eytzinger_lower_bound_ullong(const ullong_t *layout, usize_t count,
+                                  ullong_t key);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LIQUID_SORT_H
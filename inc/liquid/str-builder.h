@@ -0,0 +1,269 @@
+/**
+ * @file str-builder.h
+ * @brief Growable strings with inline small-buffer storage.
+ *
+ * A builder keeps short strings in a buffer embedded into the builder
+ * itself and only moves them to the heap once they outgrow it. Appending
+ * formats directly into the storage of the builder, the result is always
+ * null-terminated. Both raw and wide character strings are supported.
+ */
+
+#ifndef LIQUID_STR_BUILDER_H
+#define LIQUID_STR_BUILDER_H
+
+#include "alloc.h"
+#include "str.h"
+
+/**
+ * @def STR_BUILDER_INLINE
+ * @brief The number of characters, including the null terminator,
+ *        a builder stores without touching the allocator.
+ */
+#define STR_BUILDER_INLINE 24
+
+/**
+ * @def STR_BUILDER_DATA(builder)
+ * @brief Retrieves the null-terminated contents of a builder.
+ * @param builder Pointer to a raw or wide builder.
+ * @return Pointer to the first character.
+ */
+#define STR_BUILDER_DATA(builder)                                              \
+    ((builder)->heap ? (builder)->heap : (builder)->local)
+
+/**
+ * @def STR_BUILDER_APPEND(builder, src)
+ * @brief Appends a string literal to a builder.
+ * @param builder Pointer to the builder.
+ * @param src The string literal to append.
+ */
+#define STR_BUILDER_APPEND(builder, src)                                       \
+    str_builder_append(builder, src, STR_RAW_SIZE(src))
+
+/**
+ * @def WSTR_BUILDER_APPEND(builder, src)
+ * @brief Appends a wide string literal to a wide builder.
+ * @param builder Pointer to the wide builder.
+ * @param src The wide string literal to append.
+ */
+#define WSTR_BUILDER_APPEND(builder, src)                                      \
+    wstr_builder_append(builder, src, STR_RAW_SIZE(src))
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @struct str_builder
+ * @brief A growable raw string.
+ */
+typedef struct str_builder
+{
+    char              *heap;     ///< The heap storage, nullptr while inline.
+    usize_t            size;     ///< The length without the null terminator.
+    usize_t            capacity; ///< The capacity including the terminator.
+    const allocator_t *allocator;                 ///< The heap allocator.
+    char               local[STR_BUILDER_INLINE]; ///< The inline storage.
+} str_builder_t;
+
+/**
+ * @struct wstr_builder
+ * @brief A growable wide string.
+ */
+typedef struct wstr_builder
+{
+    wchar_t           *heap;     ///< The heap storage, nullptr while inline.
+    usize_t            size;     ///< The length without the null terminator.
+    usize_t            capacity; ///< The capacity including the terminator.
+    const allocator_t *allocator;                 ///< The heap allocator.
+    wchar_t            local[STR_BUILDER_INLINE]; ///< The inline storage.
+} wstr_builder_t;
+
+/**
+ * @brief Initializes an empty builder.
+ *
+ * @param builder The builder to initialize.
+ * @param allocator The allocator used once the string leaves the inline
+ *                  storage, nullptr selects the system one.
+ */
+void
+str_builder_init(str_builder_t *builder, const allocator_t *allocator);
+
+/**
+ * @brief Releases the heap storage of a builder.
+ * @param builder The builder to release.
+ */
+void
+str_builder_free(str_builder_t *builder);
+
+/**
+ * @brief Empties a builder while keeping its storage.
+ * @param builder The builder.
+ */
+void
+str_builder_clear(str_builder_t *builder);
+
+/**
+ * @brief Ensures that a builder can hold a string of the given length.
+ *
+ * @param builder The builder.
+ * @param len The length without the null terminator.
+ * @return Pointer to the contents or nullptr on failure.
+ */
+char *
+str_builder_reserve(str_builder_t *builder, usize_t len);
+
+/**
+ * @brief Appends characters to a builder.
+ *
+ * @param builder The builder.
+ * @param src The characters to append, which may be part of the builder.
+ * @param len The number of characters, zero appends up to the null
+ *            terminator of the source as str_cpy does.
+ * @return Pointer to the null terminator or nullptr on failure.
+ */
+char *
+str_builder_append(str_builder_t *builder, const char *src, usize_t len);
+
+/**
+ * @brief Appends a single character to a builder.
+ *
+ * @param builder The builder.
+ * @param c The character to append.
+ * @return Pointer to the null terminator or nullptr on failure.
+ */
+char *
+str_builder_append_char(str_builder_t *builder, char c);
+
+/**
+ * @brief Appends the decimal representation of a signed integer.
+ *
+ * @param builder The builder.
+ * @param value The value to append.
+ * @return Pointer to the null terminator or nullptr on failure.
+ */
+char *
+str_builder_append_int(str_builder_t *builder, sllong_t value);
+
+/**
+ * @brief Appends the decimal representation of an unsigned integer.
+ *
+ * @param builder The builder.
+ * @param value The value to append.
+ * @return Pointer to the null terminator or nullptr on failure.
+ */
+char *
+str_builder_append_uint(str_builder_t *builder, ullong_t value);
+
+/**
+ * @brief Appends the shortest round-trip representation of a double.
+ *
+ * @param builder The builder.
+ * @param value The value to append.
+ * @return Pointer to the null terminator or nullptr on failure.
+ * @see str_from_double
+ */
+char *
+str_builder_append_double(str_builder_t *builder, double value);
+
+/**
+ * @brief Appends a string as a quoted JSON string.
+ *
+ * Quotes, backslashes and control characters are escaped, other bytes are
+ * copied as they are.
+ *
+ * @param builder The builder.
+ * @param src The null-terminated string to append.
+ * @return Pointer to the null terminator or nullptr on failure.
+ */
+char *
+str_builder_append_json(str_builder_t *builder, const char *src);
+
+/**
+ * @brief Appends formatted output to a builder.
+ *
+ * The output is formatted straight into the free space of the builder,
+ * which is grown and formatted again only if the output does not fit.
+ *
+ * @param builder The builder.
+ * @param format The printf format string.
+ * @return Pointer to the null terminator or nullptr on failure.
+ */
+char *
+str_builder_appendf(str_builder_t *builder, const char *format, ...);
+
+/**
+ * @brief Initializes an empty wide builder.
+ * @see str_builder_init
+ */
+void
+wstr_builder_init(wstr_builder_t *builder, const allocator_t *allocator);
+
+/**
+ * @brief Releases the heap storage of a wide builder.
+ * @see str_builder_free
+ */
+void
+wstr_builder_free(wstr_builder_t *builder);
+
+/**
+ * @brief Empties a wide builder while keeping its storage.
+ * @see str_builder_clear
+ */
+void
+wstr_builder_clear(wstr_builder_t *builder);
+
+/**
+ * @brief Ensures that a wide builder can hold a string of the given length.
+ * @see str_builder_reserve
+ */
+wchar_t *
+wstr_builder_reserve(wstr_builder_t *builder, usize_t len);
+
+/**
+ * @brief Appends wide characters to a wide builder.
+ * @see str_builder_append
+ */
+wchar_t *
+wstr_builder_append(wstr_builder_t *builder, const wchar_t *src, usize_t len);
+
+/**
+ * @brief Appends a single wide character to a wide builder.
+ * @see str_builder_append_char
+ */
+wchar_t *
+wstr_builder_append_char(wstr_builder_t *builder, wchar_t c);
+
+/**
+ * @brief Appends the decimal representation of a signed integer.
+ * @see str_builder_append_int
+ */
+wchar_t *
+wstr_builder_append_int(wstr_builder_t *builder, sllong_t value);
+
+/**
+ * @brief Appends the decimal representation of an unsigned integer.
+ * @see str_builder_append_uint
+ */
+wchar_t *
+wstr_builder_append_uint(wstr_builder_t *builder, ullong_t value);
+
+/**
+ * @brief Appends the shortest round-trip representation of a double.
+ * @see str_builder_append_double
+ */
+wchar_t *
+wstr_builder_append_double(wstr_builder_t *builder, double value);
+
+/**
+ * @brief Appends formatted output to a wide builder.
+ * @see str_builder_appendf
+ */
+wchar_t *
+wstr_builder_appendf(wstr_builder_t *builder, const wchar_t *format, ...);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // LIQUID_STR_BUILDER_H
@@ -0,0 +1,222 @@
+/**
+ * @file str-num.h
+ * @brief Conversion between numbers and strings.
+ *
+ * The functions work on caller-provided buffers and never depend on the
+ * current locale. Integers are formatted two digits at a time from a lookup
+ * table after the length of the output has been computed up front; doubles
+ * are formatted with the shortest digit sequence that parses back to the
+ * same value (the Ryu algorithm).
+ *
+ * Parsing takes the same [begin, end) ranges as array_raw_pos and, like it,
+ * returns a pointer into the range or nullptr. Decimal digits are consumed
+ * eight at a time with SIMD-within-a-register arithmetic, doubles are
+ * rounded with the Eisel-Lemire algorithm, which only leaves a handful of
+ * ambiguous inputs to a slower exact path.
+ */
+
+#ifndef LIQUID_STR_NUM_H
+#define LIQUID_STR_NUM_H
+
+#include "usize.h"
+
+/**
+ * @def STR_NUM_U64_SIZE
+ * @brief Buffer size that fits any unsigned 64-bit decimal
+ *        including the null terminator.
+ */
+#define STR_NUM_U64_SIZE 21
+
+/**
+ * @def STR_NUM_I64_SIZE
+ * @brief Buffer size that fits any signed 64-bit decimal
+ *        including the sign and the null terminator.
+ */
+#define STR_NUM_I64_SIZE 21
+
+/**
+ * @def STR_NUM_BASE_SIZE
+ * @brief Buffer size that fits any unsigned 64-bit integer in any base
+ *        including the null terminator.
+ */
+#define STR_NUM_BASE_SIZE 65
+
+/**
+ * @def STR_NUM_DOUBLE_SIZE
+ * @brief Buffer size that fits the output of str_from_double
+ *        including the null terminator.
+ */
+#define STR_NUM_DOUBLE_SIZE 26
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @enum str_num_error
+ * @brief Reasons for which parsing a number can fail.
+ */
+typedef enum str_num_error
+{
+    STR_NUM_OK,           ///< The number was parsed.
+    STR_NUM_ERROR_SYNTAX, ///< The range does not start with a number.
+    STR_NUM_ERROR_RANGE,  ///< The number does not fit the result type.
+} str_num_error_t;
+
+/**
+ * @brief Counts the decimal digits of an unsigned integer.
+ *
+ * The count is derived from the bit length of the value and a single
+ * comparison against a power of ten instead of a division loop.
+ *
+ * @param value The integer.
+ * @return The number of digits, at least one.
+ */
+usize_t
+str_u64_digits(ullong_t value);
+
+/**
+ * @brief Formats an unsigned integer in decimal.
+ *
+ * @param dest Destination buffer.
+ * @param dest_size Size of the destination buffer.
+ * @param value The value to format.
+ * @return Pointer to the null terminator written after the digits,
+ *         or nullptr if the buffer is too small.
+ */
+char *
+str_from_u64(char *dest, usize_t dest_size, ullong_t value);
+
+/**
+ * @brief Formats a signed integer in decimal.
+ *
+ * @param dest Destination buffer.
+ * @param dest_size Size of the destination buffer.
+ * @param value The value to format.
+ * @return Pointer to the null terminator written after the digits,
+ *         or nullptr if the buffer is too small.
+ */
+char *
+str_from_i64(char *dest, usize_t dest_size, sllong_t value);
+
+/**
+ * @brief Formats an unsigned integer in lowercase hexadecimal
+ *        without a prefix.
+ *
+ * @param dest Destination buffer.
+ * @param dest_size Size of the destination buffer.
+ * @param value The value to format.
+ * @return Pointer to the null terminator written after the digits,
+ *         or nullptr if the buffer is too small.
+ */
+char *
+str_from_u64_hex(char *dest, usize_t dest_size, ullong_t value);
+
+/**
+ * @brief Formats an unsigned integer in the given base.
+ *
+ * @param dest Destination buffer.
+ * @param dest_size Size of the destination buffer.
+ * @param value The value to format.
+ * @param base The base, from 2 to 36; digits above nine are lowercase.
+ * @return Pointer to the null terminator written after the digits,
+ *         or nullptr if the buffer is too small or the base is invalid.
+ */
+char *
+str_from_u64_base(char *dest, usize_t dest_size, ullong_t value, uint_t base);
+
+/**
+ * @brief Formats a double with the shortest round-trip representation.
+ *
+ * Magnitudes from 1e-6 up to 1e21 are written in positional notation
+ * ("0.001", "1234.5"), other values in scientific notation ("1e+21",
+ * "5e-324"). Infinities and NaN are written as "inf", "-inf"
+ * and "nan".
+ *
+ * @param dest Destination buffer.
+ * @param dest_size Size of the destination buffer.
+ * @param value The value to format.
+ * @return Pointer to the null terminator written after the output,
+ *         or nullptr if the buffer is too small.
+ */
+char *
+str_from_double(char *dest, usize_t dest_size, double value);
+
+/**
+ * @brief Parses an unsigned decimal integer.
+ *
+ * The number consists of decimal digits only, neither whitespace nor a sign
+ * is accepted. Parsing stops at the first character that is not a digit.
+ *
+ * @param begin Pointer to the first character.
+ * @param end Pointer past the last character.
+ * @param value Receives the number, or LIQUID_ULLONG_MAX if it is too large.
+ * @param error Receives the error code, may be nullptr.
+ * @return Pointer past the last digit, or nullptr if there is no number
+ *         at the beginning of the range.
+ */
+const char *
+str_to_u64(const char *begin, const char *end, ullong_t *value,
+           str_num_error_t *error);
+
+/**
+ * @brief Parses a signed decimal integer.
+ *
+ * The digits may be preceded by a single plus or minus sign.
+ *
+ * @param begin Pointer to the first character.
+ * @param end Pointer past the last character.
+ * @param value Receives the number, or the limit of its sign if it does not
+ *              fit a signed 64-bit integer.
+ * @param error Receives the error code, may be nullptr.
+ * @return Pointer past the last digit, or nullptr if there is no number
+ *         at the beginning of the range.
+ * @see str_to_u64
+ */
+const char *
+str_to_i64(const char *begin, const char *end, sllong_t *value,
+           str_num_error_t *error);
+
+/**
+ * @brief Parses an unsigned hexadecimal integer.
+ *
+ * The digits may be preceded by a "0x" or "0X" prefix and are accepted in
+ * both cases.
+ *
+ * @param begin Pointer to the first character.
+ * @param end Pointer past the last character.
+ * @param value Receives the number, or LIQUID_ULLONG_MAX if it is too large.
+ * @param error Receives the error code, may be nullptr.
+ * @return Pointer past the last digit, or nullptr if there is no number
+ *         at the beginning of the range.
+ */
+const char *
+str_to_u64_hex(const char *begin, const char *end, ullong_t *value,
+               str_num_error_t *error);
+
+/**
+ * @brief Parses a decimal floating point number.
+ *
+ * Accepts an optional sign, digits with an optional decimal point and an
+ * optional exponent ("-12.5e3", ".5", "7."), as well as "inf", "infinity"
+ * and "nan" in any case. The decimal point is always '.', regardless of
+ * the locale. The result is correctly rounded to the nearest double.
+ *
+ * @param begin Pointer to the first character.
+ * @param end Pointer past the last character.
+ * @param value Receives the number; infinity or zero if its magnitude is
+ *              out of range.
+ * @param error Receives the error code, may be nullptr.
+ * @return Pointer past the last character of the number, or nullptr if
+ *         there is no number at the beginning of the range.
+ */
+const char *
+str_to_double(const char *begin, const char *end, double *value,
+              str_num_error_t *error);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // LIQUID_STR_NUM_H
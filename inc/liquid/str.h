@@ -80,6 +80,14 @@ extern "C"
 {
 #endif // __cplusplus
 
+/**
+ * @brief Calculate the length of a null-terminated string.
+ * @param dest The null-terminated string.
+ * @return Number of characters before the null terminator.
+ */
+usize_t
+str_len(const char *dest);
+
 /**
  * @brief Copy raw string data.
  * @details Copies raw string data from source to destination with specified
@@ -0,0 +1,210 @@
+/**
+ * @file trace.h
+ * @brief Scoped tracing into per-thread buffers, written out as Chrome
+ *        trace events.
+ *
+ * A span records its name, start and duration into a ring buffer of the
+ * thread it ran on, without locks or system calls. The rings are drained
+ * by trace_file_flush, from whichever thread owns the file, into a file in
+ * the JSON array format of Chrome traces that Perfetto opens as well. The
+ * format tolerates a missing closing bracket, so a trace cut short by a
+ * crash still opens.
+ *
+ * Tracing is switched on and off at run time. While it is off a span costs
+ * two predictable branches and no clock read: one on a global flag when it
+ * starts and one on its start time when it ends. Spans can therefore stay
+ * in the I/O and event loop paths of the library, which are traced under
+ * the names liquid.fs.* and liquid.event.*.
+ */
+
+#ifndef LIQUID_TRACE_H
+#define LIQUID_TRACE_H
+
+#include "bool.h"
+#include "fs.h"
+#include "int.h"
+#include "metric.h"
+#include "str-builder.h"
+
+/**
+ * @def TRACE_BUFFER_EVENTS
+ * @brief The events a thread keeps until they are flushed, a power of two.
+ *
+ * Events recorded while the buffer of a thread is full are dropped and
+ * counted.
+ */
+#define TRACE_BUFFER_EVENTS 4096
+
+/**
+ * @def TRACE_SCOPE(name)
+ * @brief Traces the statement or block that follows as a span.
+ *
+ * The scope is a loop run once: break and continue inside it leave the
+ * scope, not a loop around it, so they cannot be used to leave such a
+ * loop. With GCC and Clang the span ends when it goes out of scope and is
+ * recorded however the block is left. With other compilers leaving the
+ * block with break, return or goto skips the recording.
+ *
+ * @param name The name of the span, which has to outlive the trace, such
+ *             as a string literal.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+    #define TRACE_SCOPE(name)                                                  \
+        for (trace_span_t trace_scope_                                         \
+             __attribute__((cleanup(trace_span_end))) =                        \
+                 trace_span_begin(name);                                       \
+             trace_scope_.running; trace_scope_.running = 0)
+#else
+    #define TRACE_SCOPE(name)                                                  \
+        for (trace_span_t trace_scope_ = trace_span_begin(name);               \
+             trace_scope_.running; trace_span_end(&trace_scope_))
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @struct trace_span
+ * @brief A running span.
+ */
+typedef struct trace_span
+{
+    const char *name;    ///< The name of the span.
+    ullong_t    start;   ///< The clock ticks at the start, 0 if not traced.
+    uint_t      running; ///< Whether the span has not ended.
+} trace_span_t;
+
+/**
+ * @struct trace_file
+ * @brief A file the spans are written to.
+ */
+typedef struct trace_file
+{
+    fs_stream_t   stream;  ///< The file.
+    str_builder_t builder; ///< The events being formatted.
+    ullong_t      events;  ///< The events written so far.
+} trace_file_t;
+
+/**
+ * @brief Whether spans are recorded, only changed by trace_start and
+ *        trace_stop.
+ */
+extern volatile uint_t trace_active;
+
+/**
+ * @brief Starts recording spans.
+ */
+void
+trace_start(void);
+
+/**
+ * @brief Stops recording spans, those running still end up recorded.
+ */
+void
+trace_stop(void);
+
+/**
+ * @brief Records a span into the buffer of the calling thread.
+ *
+ * @param name The name of the span.
+ * @param start The clock ticks at the start, from metric_clock_ticks.
+ * @param end The clock ticks at the end.
+ */
+void
+trace_record(const char *name, ullong_t start, ullong_t end);
+
+/**
+ * @brief Releases the buffer of the calling thread before the thread
+ *        exits.
+ *
+ * A buffer still holding events is released by the flush that writes
+ * them. Threads release their buffer the same way when they exit, this
+ * only does it earlier. A span recorded by the thread afterwards takes a
+ * new buffer.
+ */
+void
+trace_thread_exit(void);
+
+/**
+ * @brief Counts the events dropped because the buffer of their thread was
+ *        full.
+ * @return The count since the start of the process.
+ */
+ullong_t
+trace_dropped(void);
+
+/**
+ * @brief Creates a trace file.
+ *
+ * Only one file should be open at a time, as each flush takes the events
+ * of every thread.
+ *
+ * @param file The file.
+ * @param path The path of the file, which is truncated.
+ * @return True on success, false if the file could not be created.
+ */
+bool
+trace_file_open(trace_file_t *file, const char_t *path);
+
+/**
+ * @brief Writes the events recorded so far to a file.
+ *
+ * This is to be called periodically, such as from a timer of an event
+ * loop, often enough that the buffers do not fill up.
+ *
+ * @param file The file.
+ * @return True on success, false if the file could not be written.
+ */
+bool
+trace_file_flush(trace_file_t *file);
+
+/**
+ * @brief Writes the remaining events to a file and closes it.
+ *
+ * @param file The file.
+ * @return True on success, false if the file could not be written.
+ */
+bool
+trace_file_close(trace_file_t *file);
+
+/**
+ * @brief Starts a span.
+ * @param name The name of the span.
+ * @return The span, with a zero start if tracing is not active.
+ */
+static inline trace_span_t
+trace_span_begin(const char *name)
+{
+    trace_span_t span = {name, 0, 1};
+    if (trace_active)
+    {
+        span.start = metric_clock_ticks();
+    }
+    return span;
+}
+
+/**
+ * @brief Ends a span and records it if it was started while tracing.
+ *
+ * The span decides on its start time rather than on the global flag, so a
+ * span that straddles a switch is neither recorded with no start nor lost.
+ *
+ * @param span The span.
+ */
+static inline void
+trace_span_end(trace_span_t *span)
+{
+    if (span->start)
+    {
+        trace_record(span->name, span->start, metric_clock_ticks());
+    }
+    span->running = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LIQUID_TRACE_H
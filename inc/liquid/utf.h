@@ -0,0 +1,177 @@
+/**
+ * @file utf.h
+ * @brief Validation and transcoding of UTF-8, UTF-16 and UTF-32 text.
+ *
+ * UTF-8 is held in char ranges, UTF-16 in ushort_t and UTF-32 in uint_t
+ * ranges; the wstr_ variants pick UTF-16 or UTF-32 to match the width of
+ * wchar_t. All ranges are [begin, end) pairs as used by array_raw_pos.
+ *
+ * Validation checks sixteen bytes at a time with table lookups in vector
+ * registers where the processor supports it, and runs of ASCII are skipped
+ * eight bytes at a time everywhere else. Lengths can be computed up front
+ * so that converted text is written into an exactly sized buffer.
+ *
+ * The conversions are strict: overlong forms, surrogates encoded in UTF-8,
+ * unpaired UTF-16 surrogates and values above U+10FFFF are rejected.
+ */
+
+#ifndef LIQUID_UTF_H
+#define LIQUID_UTF_H
+
+#include "bool.h"
+#include "usize.h"
+
+#ifndef __cplusplus
+    #include <wchar.h>
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/**
+ * @brief Finds the first malformed sequence in UTF-8 text.
+ *
+ * @param begin Pointer to the first byte.
+ * @param end Pointer past the last byte.
+ * @return Pointer to the first byte of the first malformed or truncated
+ *         sequence, or nullptr if the whole range is valid.
+ */
+const char *
+utf8_invalid_pos(const char *begin, const char *end);
+
+/**
+ * @brief Checks whether a range holds valid UTF-8 text.
+ *
+ * @param begin Pointer to the first byte.
+ * @param end Pointer past the last byte.
+ * @return True if the range is valid.
+ * @see utf8_invalid_pos
+ */
+bool
+utf8_is_valid(const char *begin, const char *end);
+
+/**
+ * @brief Counts the UTF-16 units needed for valid UTF-8 text.
+ *
+ * @param begin Pointer to the first byte.
+ * @param end Pointer past the last byte.
+ * @return The number of units utf8_to_utf16 writes.
+ */
+usize_t
+utf8_utf16_len(const char *begin, const char *end);
+
+/**
+ * @brief Counts the code points of valid UTF-8 text.
+ *
+ * @param begin Pointer to the first byte.
+ * @param end Pointer past the last byte.
+ * @return The number of units utf8_to_utf32 writes.
+ */
+usize_t
+utf8_utf32_len(const char *begin, const char *end);
+
+/**
+ * @brief Counts the UTF-8 bytes needed for valid UTF-16 text.
+ *
+ * @param begin Pointer to the first unit.
+ * @param end Pointer past the last unit.
+ * @return The number of bytes utf16_to_utf8 writes.
+ */
+usize_t
+utf16_utf8_len(const ushort_t *begin, const ushort_t *end);
+
+/**
+ * @brief Counts the UTF-8 bytes needed for valid UTF-32 text.
+ *
+ * @param begin Pointer to the first unit.
+ * @param end Pointer past the last unit.
+ * @return The number of bytes utf32_to_utf8 writes.
+ */
+usize_t
+utf32_utf8_len(const uint_t *begin, const uint_t *end);
+
+/**
+ * @brief Converts UTF-8 text to UTF-16.
+ *
+ * The output is not null-terminated.
+ *
+ * @param dest Destination buffer.
+ * @param dest_size Size of the destination buffer in units.
+ * @param begin Pointer to the first byte.
+ * @param end Pointer past the last byte.
+ * @return Pointer past the last unit written, or nullptr if the text is
+ *         malformed or the buffer is too small.
+ */
+ushort_t *
+utf8_to_utf16(ushort_t *dest, usize_t dest_size, const char *begin,
+              const char *end);
+
+/**
+ * @brief Converts UTF-8 text to UTF-32.
+ * @see utf8_to_utf16
+ */
+uint_t *
+utf8_to_utf32(uint_t *dest, usize_t dest_size, const char *begin,
+              const char *end);
+
+/**
+ * @brief Converts UTF-16 text to UTF-8.
+ *
+ * The output is not null-terminated.
+ *
+ * @param dest Destination buffer.
+ * @param dest_size Size of the destination buffer in bytes.
+ * @param begin Pointer to the first unit.
+ * @param end Pointer past the last unit.
+ * @return Pointer past the last byte written, or nullptr if the text is
+ *         malformed or the buffer is too small.
+ */
+char *
+utf16_to_utf8(char *dest, usize_t dest_size, const ushort_t *begin,
+              const ushort_t *end);
+
+/**
+ * @brief Converts UTF-32 text to UTF-8.
+ * @see utf16_to_utf8
+ */
+char *
+utf32_to_utf8(char *dest, usize_t dest_size, const uint_t *begin,
+              const uint_t *end);
+
+/**
+ * @brief Counts the wide characters needed for valid UTF-8 text.
+ * @see utf8_utf16_len
+ */
+usize_t
+utf8_wstr_len(const char *begin, const char *end);
+
+/**
+ * @brief Counts the UTF-8 bytes needed for a valid wide string.
+ * @see utf16_utf8_len
+ */
+usize_t
+wstr_utf8_len(const wchar_t *begin, const wchar_t *end);
+
+/**
+ * @brief Converts UTF-8 text to a wide string.
+ * @see utf8_to_utf16
+ */
+wchar_t *
+utf8_to_wstr(wchar_t *dest, usize_t dest_size, const char *begin,
+             const char *end);
+
+/**
+ * @brief Converts a wide string to UTF-8 text.
+ * @see utf16_to_utf8
+ */
+char *
+wstr_to_utf8(char *dest, usize_t dest_size, const wchar_t *begin,
+             const wchar_t *end);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // LIQUID_UTF_H
@@ -0,0 +1,254 @@
+/**
+ * @file wheel.h
+ * @brief Hierarchical hashed timing wheels.
+ *
+ * A wheel holds timers on WHEEL_LEVELS levels of WHEEL_SLOTS slots, each
+ * level a slot per WHEEL_SLOTS ticks of the one below. A timer lands on
+ * the level of the highest digit in which its expiry differs from the
+ * current tick, so starting, restarting and stopping a timer are a few
+ * pointer moves whatever the number of timers. Advancing the wheel visits
+ * only the slots that are due, found through a bitmap per level: the
+ * timers of a slot on a higher level move down as their time approaches,
+ * at most once per level, and the timers of a slot on the lowest level
+ * expire together.
+ *
+ * Ticks have no unit of their own. A wheel can be advanced by a count of
+ * periodic events, or by the time read from a tick source, which uses the
+ * monotonic clock of the system where there is one.
+ */
+
+#ifndef LIQUID_WHEEL_H
+#define LIQUID_WHEEL_H
+
+#include "bool.h"
+#include "pool.h"
+
+/**
+ * @def WHEEL_BITS
+ * @brief The bits of a tick that select the slot on a level.
+ */
+#define WHEEL_BITS 6
+
+/**
+ * @def WHEEL_SLOTS
+ * @brief The number of slots of a level.
+ */
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+
+/**
+ * @def WHEEL_LEVELS
+ * @brief The number of levels, enough for every 64-bit expiry.
+ */
+#define WHEEL_LEVELS ((64 + WHEEL_BITS - 1) / WHEEL_BITS)
+
+/**
+ * @def WHEEL_NEVER
+ * @brief The delay of the next expiry of a wheel without timers.
+ */
+#define WHEEL_NEVER (~0ull)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+struct wheel;
+struct wheel_timer;
+
+/**
+ * @typedef wheel_callback_t
+ * @brief The function called when a timer expires, after it has been
+ *        stopped, so that it may start the timer again or release it.
+ */
+typedef void (*wheel_callback_t)(struct wheel       *wheel,
+                                 struct wheel_timer *timer);
+
+/**
+ * @struct wheel_link
+ * @brief A link of a circular list of timers.
+ */
+typedef struct wheel_link
+{
+    struct wheel_link *next; ///< The next link, nullptr if not in a list.
+    struct wheel_link *prev; ///< The previous link.
+} wheel_link_t;
+
+/**
+ * @struct wheel_timer
+ * @brief A one-shot timer.
+ */
+typedef struct wheel_timer
+{
+    wheel_link_t     link;     ///< The link in its slot.
+    wheel_callback_t callback; ///< The function called on expiry.
+    void            *data;     ///< The data of the caller.
+    ullong_t         expiry;   ///< The tick the timer expires at.
+    uint_t           slot;     ///< The index of its slot over all levels.
+} wheel_timer_t;
+
+/**
+ * @struct wheel
+ * @brief A hierarchical timing wheel. It must not be moved while
+ *        initialized.
+ */
+typedef struct wheel
+{
+    wheel_link_t slots[WHEEL_LEVELS][WHEEL_SLOTS]; ///< The timers by slot.
+    ullong_t     occupied[WHEEL_LEVELS];           ///< The used slots.
+    pool_t       pool;                             ///< The pooled timers.
+    ullong_t     now;                              ///< The current tick.
+    ullong_t     tick;                             ///< The tick advanced to.
+    usize_t      count;                            ///< The running timers.
+    void        *data;                             ///< The data of the caller.
+} wheel_t;
+
+/**
+ * @struct wheel_clock
+ * @brief A tick source over the monotonic clock, or over the real-time
+ *        clock kept from going back where there is no monotonic one.
+ */
+typedef struct wheel_clock
+{
+    ullong_t resolution; ///< The nanoseconds per tick.
+    ullong_t origin;     ///< The time of tick 0 in nanoseconds.
+    ullong_t last;       ///< The last time read in nanoseconds.
+} wheel_clock_t;
+
+/**
+ * @brief Initializes a wheel.
+ *
+ * @param wheel The wheel to initialize.
+ * @param allocator The allocator of the chunks of pooled timers, nullptr
+ *                  for the system one.
+ * @param now The current tick.
+ */
+void
+wheel_init(wheel_t *wheel, const allocator_t *allocator, ullong_t now);
+
+/**
+ * @brief Releases the pooled timers of a wheel. The running timers are
+ *        dropped.
+ * @param wheel The wheel.
+ */
+void
+wheel_free(wheel_t *wheel);
+
+/**
+ * @brief Initializes a timer owned by the caller.
+ *
+ * @param timer The timer.
+ * @param callback The function called on expiry.
+ * @param data The data of the caller.
+ */
+void
+wheel_timer_init(wheel_timer_t *timer, wheel_callback_t callback,
+                 void *data);
+
+/**
+ * @brief Allocates and initializes a timer from the pool of a wheel.
+ *
+ * @param wheel The wheel.
+ * @param callback The function called on expiry.
+ * @param data The data of the caller.
+ * @return The timer, or nullptr if it could not be allocated.
+ */
+wheel_timer_t *
+wheel_timer_new(wheel_t *wheel, wheel_callback_t callback, void *data);
+
+/**
+ * @brief Stops a timer of the pool of a wheel and returns it to the pool.
+ *
+ * @param wheel The wheel.
+ * @param timer The timer, or nullptr.
+ */
+void
+wheel_timer_delete(wheel_t *wheel, wheel_timer_t *timer);
+
+/**
+ * @brief Starts or restarts a timer.
+ *
+ * The timer expires at the first advance to the current tick plus the
+ * timeout or later. A timeout of 0 expires at the next advance, never at
+ * the one running. An expiry past the last tick, WHEEL_NEVER, is
+ * saturated to it. A timer started once the wheel is at the last tick
+ * stays active but never expires, as the wheel cannot advance further.
+ *
+ * @param wheel The wheel.
+ * @param timer The timer, which must stay valid until it expires or is
+ *              stopped.
+ * @param timeout The delay in ticks.
+ */
+void
+wheel_timer_start(wheel_t *wheel, wheel_timer_t *timer, ullong_t timeout);
+
+/**
+ * @brief Stops a timer if it is running.
+ *
+ * @param wheel The wheel.
+ * @param timer The timer.
+ */
+void
+wheel_timer_stop(wheel_t *wheel, wheel_timer_t *timer);
+
+/**
+ * @brief Checks whether a timer is running.
+ * @param timer The timer.
+ * @return True if the timer is running.
+ */
+bool
+wheel_timer_active(const wheel_timer_t *timer);
+
+/**
+ * @brief Advances a wheel and calls the timers that expire.
+ *
+ * The timers expire in the order of their expiry ticks, in batches of the
+ * timers of the same tick.
+ *
+ * @param wheel The wheel.
+ * @param now The current tick, ignored if before the last one.
+ * @return The number of timers that expired.
+ */
+usize_t
+wheel_advance(wheel_t *wheel, ullong_t now);
+
+/**
+ * @brief Computes the ticks until a wheel has to be advanced next.
+ *
+ * The result is the delay until the next expiry or until timers move down
+ * a level, whichever comes first.
+ *
+ * @param wheel The wheel.
+ * @return The ticks from the current tick, WHEEL_NEVER without timers.
+ */
+ullong_t
+wheel_next(const wheel_t *wheel);
+
+/**
+ * @brief Initializes a tick source that starts at tick 0.
+ *
+ * @param clock The tick source.
+ * @param resolution The nanoseconds per tick, 1000000 for milliseconds.
+ */
+void
+wheel_clock_init(wheel_clock_t *clock, ullong_t resolution);
+
+/**
+ * @brief Reads the current tick of a tick source.
+ * @param clock The tick source.
+ * @return The tick, never less than the one read before.
+ */
+ullong_t
+wheel_clock_read(wheel_clock_t *clock);
+
+/**
+ * @brief Reads the clock behind the tick sources.
+ * @return The time in nanoseconds since an unspecified start.
+ */
+ullong_t
+wheel_clock_nanoseconds(void);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // LIQUID_WHEEL_H
@@ -0,0 +1,9 @@
+#include <liquid/alloc.h>
+
+void *
+alloc_system_fn(void *ctx, void *ptr, usize_t old_size, usize_t new_size)
+{
+    // The Darwin allocator already maps large blocks on its own
+    // and grows them with vm_copy, there is nothing to gain here.
+    return alloc_heap_fn(ctx, ptr, old_size, new_size);
+}
@@ -0,0 +1,90 @@
+#ifndef _GNU_SOURCE
+    #define _GNU_SOURCE
+#endif
+
+#include <liquid/alloc.h>
+#include <liquid/array-raw.h>
+#include <liquid/bool.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * @brief Rounds a size up to the page size of the system.
+ * @param size The size to round up.
+ * @return The rounded size.
+ */
+static usize_t
+alloc_page_round(usize_t size)
+{
+    static usize_t page_size = 0;
+    if (!page_size)
+    {
+        page_size = (usize_t)sysconf(_SC_PAGESIZE);
+    }
+    return (size + page_size - 1) & ~(page_size - 1);
+}
+
+/**
+ * @brief Maps a new anonymous block of memory.
+ * @param size The size of the block.
+ * @return The mapped block or nullptr on failure.
+ */
+static void *
+alloc_map(usize_t size)
+{
+    void *ptr = mmap(nullptr, alloc_page_round(size), PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+}
+
+void *
+alloc_system_fn(void *ctx, void *ptr, usize_t old_size, usize_t new_size)
+{
+    const usize_t threshold = LIQUID_ALLOC_MAP_THRESHOLD;
+
+    // Blocks are mapped or taken from the heap depending on their size only,
+    // so the old size tells where the block currently lives.
+    const bool was_mapped = ptr && old_size >= threshold;
+    const bool map = new_size >= threshold;
+
+    if (!was_mapped && !map)
+    {
+        return alloc_heap_fn(ctx, ptr, old_size, new_size);
+    }
+
+    if (was_mapped && map)
+    {
+        // The kernel moves the page table entries instead of the data.
+        void *block = mremap(ptr, alloc_page_round(old_size),
+                             alloc_page_round(new_size), MREMAP_MAYMOVE);
+        return block == MAP_FAILED ? nullptr : block;
+    }
+
+    if (was_mapped && !new_size)
+    {
+        munmap(ptr, alloc_page_round(old_size));
+        return nullptr;
+    }
+
+    // The block crosses the threshold and has to change its backing store.
+    void *block = map ? alloc_map(new_size)
+                      : alloc_heap_fn(ctx, nullptr, 0, new_size);
+    if (!block)
+    {
+        return nullptr;
+    }
+
+    if (ptr)
+    {
+        array_raw_copy(block, ptr, old_size < new_size ? old_size : new_size);
+        if (was_mapped)
+        {
+            munmap(ptr, alloc_page_round(old_size));
+        }
+        else
+        {
+            alloc_heap_fn(ctx, ptr, old_size, 0);
+        }
+    }
+    return block;
+}
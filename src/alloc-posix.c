@@ -0,0 +1,16 @@
+#include <liquid/alloc.h>
+#include <stdlib.h>
+
+void *
+alloc_heap_fn(void *ctx, void *ptr, usize_t old_size, usize_t new_size)
+{
+    (void)ctx;
+    (void)old_size;
+
+    if (!new_size)
+    {
+        free(ptr);
+        return nullptr;
+    }
+    return realloc(ptr, new_size);
+}
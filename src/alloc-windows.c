@@ -0,0 +1,29 @@
+#include <liquid/alloc.h>
+#include <windows.h>
+
+void *
+alloc_heap_fn(void *ctx, void *ptr, usize_t old_size, usize_t new_size)
+{
+    (void)ctx;
+    (void)old_size;
+
+    if (!new_size)
+    {
+        if (ptr)
+        {
+            HeapFree(GetProcessHeap(), 0, ptr);
+        }
+        return nullptr;
+    }
+
+    return ptr ? HeapReAlloc(GetProcessHeap(), 0, ptr, new_size)
+               : HeapAlloc(GetProcessHeap(), 0, new_size);
+}
+
+void *
+alloc_system_fn(void *ctx, void *ptr, usize_t old_size, usize_t new_size)
+{
+    // The process heap already reserves large blocks with VirtualAlloc
+    // and may extend them in place on reallocation.
+    return alloc_heap_fn(ctx, ptr, old_size, new_size);
+}
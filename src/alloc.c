@@ -0,0 +1,40 @@
+#include <liquid/alloc.h>
+#include <liquid/exception.h>
+
+static const allocator_t m_system = {alloc_system_fn, nullptr};
+
+const allocator_t *
+alloc_system()
+{
+    return &m_system;
+}
+
+void *
+alloc_new(const allocator_t *allocator, usize_t size)
+{
+    return alloc_resize(allocator, nullptr, 0, size);
+}
+
+void *
+alloc_resize(const allocator_t *allocator, void *ptr, usize_t old_size,
+             usize_t new_size)
+{
+    if (!allocator)
+    {
+        allocator = &m_system;
+    }
+
+    void *block = allocator->fn(allocator->ctx, ptr, old_size, new_size);
+    LIQUID_EXCEPTION_RAISE_IF(!block && new_size, nullptr,
+                              "unable to allocate memory block")
+    return block;
+}
+
+void
+alloc_delete(const allocator_t *allocator, void *ptr, usize_t size)
+{
+    if (ptr)
+    {
+        alloc_resize(allocator, ptr, size, 0);
+    }
+}
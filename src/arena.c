@@ -0,0 +1,128 @@
+#include <liquid/arena.h>
+#include <liquid/array-raw.h>
+#include <liquid/exception.h>
+
+/**
+ * @def ARENA_CHUNK_HEADER
+ * @brief The aligned size of the chunk header preceding the chunk data.
+ */
+#define ARENA_CHUNK_HEADER LIQUID_ALLOC_ALIGN(sizeof(arena_chunk_t))
+
+/**
+ * @def ARENA_CHUNK_DATA(chunk)
+ * @brief Retrieves the first usable byte of a chunk.
+ */
+#define ARENA_CHUNK_DATA(chunk) ((uchar_t *)(chunk) + ARENA_CHUNK_HEADER)
+
+void
+arena_init(arena_t *arena, const allocator_t *parent, usize_t chunk_size)
+{
+    arena->allocator.fn = arena_alloc_fn;
+    arena->allocator.ctx = arena;
+    arena->parent = parent;
+    arena->chunk = nullptr;
+    arena->last = nullptr;
+    arena->chunk_size = chunk_size ? chunk_size : LIQUID_ARENA_CHUNK_SIZE;
+}
+
+void
+arena_free(arena_t *arena)
+{
+    while (arena->chunk)
+    {
+        arena_chunk_t *prev = arena->chunk->prev;
+        alloc_delete(arena->parent, arena->chunk,
+                     ARENA_CHUNK_HEADER + arena->chunk->size);
+        arena->chunk = prev;
+    }
+    arena->last = nullptr;
+}
+
+void
+arena_reset(arena_t *arena)
+{
+    arena_chunk_t *chunk = arena->chunk;
+    if (chunk)
+    {
+        // Keep the newest chunk, it is the largest one in most cases.
+        arena->chunk = chunk->prev;
+        arena_free(arena);
+        chunk->prev = nullptr;
+        chunk->used = 0;
+        arena->chunk = chunk;
+    }
+    arena->last = nullptr;
+}
+
+void *
+arena_alloc(arena_t *arena, usize_t size)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(arena, nullptr, "invalid arena pointer")
+
+    size = LIQUID_ALLOC_ALIGN(size);
+
+    arena_chunk_t *chunk = arena->chunk;
+    if (!chunk || chunk->size - chunk->used < size)
+    {
+        usize_t chunk_size =
+            size > arena->chunk_size ? size : arena->chunk_size;
+        chunk = alloc_new(arena->parent, ARENA_CHUNK_HEADER + chunk_size);
+        if (!chunk)
+        {
+            return nullptr;
+        }
+
+        chunk->prev = arena->chunk;
+        chunk->size = chunk_size;
+        chunk->used = 0;
+        arena->chunk = chunk;
+    }
+
+    void *ptr = ARENA_CHUNK_DATA(chunk) + chunk->used;
+    chunk->used += size;
+    arena->last = ptr;
+    return ptr;
+}
+
+void *
+arena_alloc_fn(void *ctx, void *ptr, usize_t old_size, usize_t new_size)
+{
+    arena_t *arena = (arena_t *)ctx;
+
+    if (!ptr)
+    {
+        return new_size ? arena_alloc(arena, new_size) : nullptr;
+    }
+
+    old_size = LIQUID_ALLOC_ALIGN(old_size);
+
+    // Only the most recent allocation can be resized or released in place.
+    if (ptr == arena->last)
+    {
+        arena_chunk_t *chunk = arena->chunk;
+        usize_t        offset = chunk->used - old_size;
+
+        if (chunk->size - offset >= LIQUID_ALLOC_ALIGN(new_size))
+        {
+            chunk->used = offset + LIQUID_ALLOC_ALIGN(new_size);
+            if (!new_size)
+            {
+                arena->last = nullptr;
+                return nullptr;
+            }
+            return ptr;
+        }
+    }
+
+    if (!new_size)
+    {
+        return nullptr;
+    }
+
+    void *block = arena_alloc(arena, new_size);
+    if (block)
+    {
+        array_raw_copy(block, ptr, old_size < new_size ? old_size : new_size);
+    }
+    return block;
+}
@@ -1,5 +1,17 @@
 #include <liquid/array-raw.h>
+#include <liquid/bool.h>
 #include <liquid/exception.h>
+#include <liquid/metric.h>
+
+#if defined(__GNUC__)
+/**
+ * @typedef array_raw_word_t
+ * @brief Machine word that is allowed to alias any other type.
+ */
+typedef uptr_t __attribute__((__may_alias__)) array_raw_word_t;
+#else
+typedef uptr_t array_raw_word_t;
+#endif
 
 void *
 array_raw_copy(void *dest, const void *src, usize_t len)
@@ -11,6 +23,8 @@ array_raw_copy(void *dest, const void *src, usize_t len)
                               "function does not support self-copying, "
                               "this is only allowed when using memmove")
 
+    LIQUID_METRIC_COUNT(metric_array_copy_bytes, len);
+
     const uchar_t *l_src = (const uchar_t *)src;
     uchar_t       *l_dest = (uchar_t *)dest;
 
@@ -22,6 +36,71 @@ array_raw_copy(void *dest, const void *src, usize_t len)
     return l_dest;
 }
 
+void *
+array_raw_move(void *dest, const void *src, usize_t len)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && src, nullptr,
+                                  "invalid destination or source pointer")
+
+    const uchar_t *l_src = (const uchar_t *)src;
+    uchar_t       *l_dest = (uchar_t *)dest;
+    uchar_t       *l_end = l_dest + len;
+
+    // Word moves are only possible when both pointers share the alignment.
+    const bool aligned =
+        (((uptr_t)l_src ^ (uptr_t)l_dest) & (sizeof(uptr_t) - 1)) == 0;
+
+    if (l_dest < l_src)
+    {
+        if (aligned)
+        {
+            while (len && ((uptr_t)l_dest & (sizeof(uptr_t) - 1)))
+            {
+                *l_dest++ = *l_src++;
+                --len;
+            }
+            for (; len >= sizeof(uptr_t); len -= sizeof(uptr_t))
+            {
+                *(array_raw_word_t *)l_dest =
+                    *(const array_raw_word_t *)l_src;
+                l_dest += sizeof(uptr_t);
+                l_src += sizeof(uptr_t);
+            }
+        }
+        while (len-- > 0)
+        {
+            *l_dest++ = *l_src++;
+        }
+    }
+    else if (l_dest > l_src)
+    {
+        // Copy backwards so the overlapping tail is read before it is written.
+        l_dest = l_end;
+        l_src += len;
+
+        if (aligned)
+        {
+            while (len && ((uptr_t)l_dest & (sizeof(uptr_t) - 1)))
+            {
+                *--l_dest = *--l_src;
+                --len;
+            }
+            for (; len >= sizeof(uptr_t); len -= sizeof(uptr_t))
+            {
+                l_dest -= sizeof(uptr_t);
+                l_src -= sizeof(uptr_t);
+                *(array_raw_word_t *)l_dest =
+                    *(const array_raw_word_t *)l_src;
+            }
+        }
+        while (len-- > 0)
+        {
+            *--l_dest = *--l_src;
+        }
+    }
+    return l_end;
+}
+
 const void *
 array_raw_pos(const void *begin, const void *end, uchar_t value)
 {
@@ -0,0 +1,218 @@
+#include <liquid/array-raw.h>
+#include <liquid/array.h>
+#include <liquid/checked.h>
+#include <liquid/exception.h>
+
+/**
+ * @def ARRAY_ITEM(array, index)
+ * @brief Retrieves the address of an item by its index.
+ */
+#define ARRAY_ITEM(array, index)                                               \
+    ((uchar_t *)(array)->data + (index) * (array)->item_size)
+
+void
+array_init(array_t *array, usize_t item_size, const allocator_t *allocator)
+{
+    array->data = nullptr;
+    array->size = 0;
+    array->capacity = 0;
+    array->item_size = item_size;
+    array->growth = ARRAY_GROWTH_DEFAULT;
+    array->allocator = allocator;
+}
+
+void
+array_free(array_t *array)
+{
+    alloc_delete(array->allocator, array->data,
+                 array->capacity * array->item_size);
+    array->data = nullptr;
+    array->size = 0;
+    array->capacity = 0;
+}
+
+void
+array_set_growth(array_t *array, uint_t growth)
+{
+    LIQUID_EXCEPTION_RAISE_IF(growth <= 100, ,
+                              "growth factor must be greater than 100 percent")
+    array->growth = growth;
+}
+
+/**
+ * @brief Reallocates the storage of an array to the exact capacity.
+ *
+ * @param array The array.
+ * @param capacity The new capacity, not less than the size.
+ * @return Pointer to the items or nullptr on failure.
+ */
+static void *
+array_realloc(array_t *array, usize_t capacity)
+{
+    usize_t size;
+    LIQUID_EXCEPTION_RAISE_IF_NOT(
+        checked_mul_usize(capacity, array->item_size, &size), nullptr,
+        "array capacity is too large")
+
+    void *data = alloc_resize(array->allocator, array->data,
+                              array->capacity * array->item_size, size);
+    if (data || !capacity)
+    {
+        array->data = data;
+        array->capacity = capacity;
+    }
+    return data;
+}
+
+/**
+ * @brief Grows the storage of an array geometrically
+ *        so that it fits the given number of items.
+ *
+ * @param array The array.
+ * @param required The number of items the array has to fit.
+ * @return Pointer to the items or nullptr on failure.
+ */
+static void *
+array_grow(array_t *array, usize_t required)
+{
+    if (required <= array->capacity)
+    {
+        return array->data;
+    }
+
+    usize_t capacity = array->capacity / 100 * array->growth
+                     + array->capacity % 100 * array->growth / 100;
+    if (capacity < required)
+    {
+        capacity = required;
+    }
+    if (capacity < ARRAY_CAPACITY_MIN)
+    {
+        capacity = ARRAY_CAPACITY_MIN;
+    }
+    return array_realloc(array, capacity);
+}
+
+void *
+array_reserve(array_t *array, usize_t capacity)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(array, nullptr, "invalid array pointer")
+
+    if (capacity <= array->capacity)
+    {
+        return array->data;
+    }
+    return array_realloc(array, capacity);
+}
+
+void *
+array_shrink(array_t *array)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(array, nullptr, "invalid array pointer")
+
+    if (array->size == array->capacity)
+    {
+        return array->data;
+    }
+    return array_realloc(array, array->size);
+}
+
+void
+array_clear(array_t *array)
+{
+    array->size = 0;
+}
+
+void *
+array_at(const array_t *array, usize_t index)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(array, nullptr, "invalid array pointer")
+    LIQUID_EXCEPTION_RAISE_IF(index >= array->size, nullptr,
+                              "array index is out of range")
+    return ARRAY_ITEM(array, index);
+}
+
+void *
+array_push(array_t *array, const void *item)
+{
+    return array_insert(array, array ? array->size : 0, item, 1);
+}
+
+void *
+array_pop(array_t *array)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(array, nullptr, "invalid array pointer")
+
+    if (!array->size)
+    {
+        return nullptr;
+    }
+    return ARRAY_ITEM(array, --array->size);
+}
+
+void *
+array_insert(array_t *array, usize_t index, const void *items, usize_t count)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(array, nullptr, "invalid array pointer")
+    LIQUID_EXCEPTION_RAISE_IF(index > array->size, nullptr,
+                              "array index is out of range")
+    LIQUID_EXCEPTION_RAISE_IF(count > LIQUID_USIZE_MAX - array->size, nullptr,
+                              "array size is too large")
+
+    // Items taken from the array itself are found again by their offset,
+    // as growing may move the storage and inserting shifts the tail.
+    usize_t bytes = count * array->item_size;
+    uptr_t  begin = (uptr_t)array->data;
+    uptr_t  offset = (uptr_t)items - begin;
+    bool    inside =
+        items && array->data && offset < array->size * array->item_size;
+    if (!array_grow(array, array->size + count))
+    {
+        return nullptr;
+    }
+
+    uchar_t *slot = ARRAY_ITEM(array, index);
+    if (index < array->size)
+    {
+        array_raw_move(slot + bytes, slot,
+                       (array->size - index) * array->item_size);
+    }
+    if (inside && count)
+    {
+        // The items before the position stay, those after it moved up.
+        usize_t at = index * array->item_size;
+        usize_t before = offset < at ? at - (usize_t)offset : 0;
+        before = before < bytes ? before : bytes;
+        const uchar_t *data = array->data;
+        array_raw_copy(slot, data + offset, before);
+        array_raw_copy(slot + before, data + offset + before + bytes,
+                       bytes - before);
+    }
+    else if (items && count)
+    {
+        array_raw_copy(slot, items, bytes);
+    }
+
+    array->size += count;
+    return slot;
+}
+
+void *
+array_erase(array_t *array, usize_t index, usize_t count)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(array, nullptr, "invalid array pointer")
+    LIQUID_EXCEPTION_RAISE_IF(index > array->size
+                                  || count > array->size - index,
+                              nullptr, "array range is out of bounds")
+
+    uchar_t *slot = ARRAY_ITEM(array, index);
+    usize_t  tail = array->size - index - count;
+    if (count && tail)
+    {
+        array_raw_move(slot, slot + count * array->item_size,
+                       tail * array->item_size);
+    }
+
+    array->size -= count;
+    return slot;
+}
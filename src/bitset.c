@@ -0,0 +1,1405 @@
+#include <liquid/array-raw.h>
+#include <liquid/bitflag.h>
+#include <liquid/bitset.h>
+#include <liquid/exception.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+    #include <immintrin.h>
+    #define BITSET_SIMD_SSE2
+    #define BITSET_SIMD_AVX2
+    #define BITSET_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+    #define BITSET_HAS_AVX2() __builtin_cpu_supports("avx2")
+    #define BITSET_POPCNT
+    #define BITSET_TARGET_POPCNT __attribute__((target("popcnt")))
+    #define BITSET_HAS_POPCNT() __builtin_cpu_supports("popcnt")
+#elif defined(_MSC_VER) && defined(_M_X64)
+    #include <immintrin.h>
+    #include <intrin.h>
+    #define BITSET_SIMD_SSE2
+    #if defined(__AVX2__)
+        #define BITSET_SIMD_AVX2
+        #define BITSET_TARGET_AVX2
+        #define BITSET_HAS_AVX2() 1
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define BITSET_SIMD_NEON
+#endif
+
+/**
+ * @def ROARING_ARRAY_MIN
+ * @brief The capacity of the array of a new container.
+ */
+#define ROARING_ARRAY_MIN 4
+
+/**
+ * @def ROARING_IS_BITMAP(container)
+ * @brief Checks whether a container stores its values as a bitmap.
+ */
+#define ROARING_IS_BITMAP(container) ((container)->capacity == 0)
+
+/**
+ * @def ROARING_BITMAP_SIZE
+ * @brief The size of the bitmap of a container in bytes.
+ */
+#define ROARING_BITMAP_SIZE (ROARING_BITMAP_WORDS * sizeof(ullong_t))
+
+/**
+ * @brief The operations combining two ranges of words.
+ */
+enum
+{
+    BITSET_OP_AND,
+    BITSET_OP_OR,
+    BITSET_OP_XOR,
+    BITSET_OP_ANDNOT
+};
+
+/**
+ * @brief Combines two ranges of words one word at a time.
+ *
+ * @param dest The words to modify.
+ * @param src The words to combine them with.
+ * @param count The number of words.
+ * @param op The operation.
+ */
+static void
+bitset_apply_scalar(ullong_t *dest, const ullong_t *src, usize_t count,
+                    uint_t op)
+{
+    switch (op)
+    {
+    case BITSET_OP_AND:
+        for (usize_t i = 0; i < count; ++i)
+        {
+            dest[i] &= src[i];
+        }
+        break;
+    case BITSET_OP_OR:
+        for (usize_t i = 0; i < count; ++i)
+        {
+            dest[i] |= src[i];
+        }
+        break;
+    case BITSET_OP_XOR:
+        for (usize_t i = 0; i < count; ++i)
+        {
+            dest[i] ^= src[i];
+        }
+        break;
+    default:
+        for (usize_t i = 0; i < count; ++i)
+        {
+            dest[i] &= ~src[i];
+        }
+        break;
+    }
+}
+
+/**
+ * @brief Counts the set bits of a range of words one word at a time.
+ *
+ * @param words The words.
+ * @param count The number of words.
+ * @return The number of set bits.
+ */
+static usize_t
+bitset_count_scalar(const ullong_t *words, usize_t count)
+{
+    usize_t total = 0;
+    for (usize_t i = 0; i < count; ++i)
+    {
+        total += bitflag_popcount64(words[i]);
+    }
+    return total;
+}
+
+#if defined(BITSET_POPCNT)
+/**
+ * @brief Counts the set bits of a range of words with POPCNT.
+ * @see bitset_count_scalar
+ */
+BITSET_TARGET_POPCNT static usize_t
+bitset_count_popcnt(const ullong_t *words, usize_t count)
+{
+    usize_t total = 0;
+    for (usize_t i = 0; i < count; ++i)
+    {
+        total += (usize_t)__builtin_popcountll(words[i]);
+    }
+    return total;
+}
+#endif
+
+#if defined(BITSET_SIMD_SSE2)
+/**
+ * @def BITSET_SSE2_LOOP(expr)
+ * @brief Combines the words two at a time, expr computes the result from
+ *        the vectors a of dest and b of src.
+ */
+    #define BITSET_SSE2_LOOP(expr)                                             \
+        for (; i + 2 <= count; i += 2)                                         \
+        {                                                                      \
+            __m128i a = _mm_loadu_si128((const __m128i *)(dest + i));          \
+            __m128i b = _mm_loadu_si128((const __m128i *)(src + i));           \
+            _mm_storeu_si128((__m128i *)(dest + i), expr);                     \
+        }
+
+/**
+ * @brief Combines two ranges of words with SSE2.
+ * @see bitset_apply_scalar
+ */
+static void
+bitset_apply_sse2(ullong_t *dest, const ullong_t *src, usize_t count,
+                  uint_t op)
+{
+    usize_t i = 0;
+    switch (op)
+    {
+    case BITSET_OP_AND:
+        BITSET_SSE2_LOOP(_mm_and_si128(a, b))
+        break;
+    case BITSET_OP_OR:
+        BITSET_SSE2_LOOP(_mm_or_si128(a, b))
+        break;
+    case BITSET_OP_XOR:
+        BITSET_SSE2_LOOP(_mm_xor_si128(a, b))
+        break;
+    default:
+        BITSET_SSE2_LOOP(_mm_andnot_si128(b, a))
+        break;
+    }
+    bitset_apply_scalar(dest + i, src + i, count - i, op);
+}
+#endif
+
+#if defined(BITSET_SIMD_AVX2)
+/**
+ * @def BITSET_AVX2_LOOP(expr)
+ * @brief Combines the words four at a time, expr computes the result from
+ *        the vectors a of dest and b of src.
+ */
+    #define BITSET_AVX2_LOOP(expr)                                             \
+        for (; i + 4 <= count; i += 4)                                         \
+        {                                                                      \
+            __m256i a = _mm256_loadu_si256((const __m256i *)(dest + i));       \
+            __m256i b = _mm256_loadu_si256((const __m256i *)(src + i));        \
+            _mm256_storeu_si256((__m256i *)(dest + i), expr);                  \
+        }
+
+/**
+ * @brief Combines two ranges of words with AVX2.
+ * @see bitset_apply_scalar
+ */
+BITSET_TARGET_AVX2 static void
+bitset_apply_avx2(ullong_t *dest, const ullong_t *src, usize_t count,
+                  uint_t op)
+{
+    usize_t i = 0;
+    switch (op)
+    {
+    case BITSET_OP_AND:
+        BITSET_AVX2_LOOP(_mm256_and_si256(a, b))
+        break;
+    case BITSET_OP_OR:
+        BITSET_AVX2_LOOP(_mm256_or_si256(a, b))
+        break;
+    case BITSET_OP_XOR:
+        BITSET_AVX2_LOOP(_mm256_xor_si256(a, b))
+        break;
+    default:
+        BITSET_AVX2_LOOP(_mm256_andnot_si256(b, a))
+        break;
+    }
+    bitset_apply_scalar(dest + i, src + i, count - i, op);
+}
+
+/**
+ * @brief Counts the set bits of a range of words with AVX2.
+ *
+ * Every nibble is counted by a table lookup with a byte shuffle and the
+ * byte counts are summed with SAD, which outpaces POPCNT on one word at
+ * a time.
+ *
+ * @see bitset_count_scalar
+ */
+BITSET_TARGET_AVX2 static usize_t
+bitset_count_avx2(const ullong_t *words, usize_t count)
+{
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3,
+                                           2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3,
+                                           1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i       total = _mm256_setzero_si256();
+
+    usize_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(words + i));
+        __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(v, nibble));
+        __m256i high = _mm256_shuffle_epi8(
+            table, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+        total = _mm256_add_epi64(
+            total, _mm256_sad_epu8(_mm256_add_epi8(low, high),
+                                   _mm256_setzero_si256()));
+    }
+
+    usize_t sum = (usize_t)_mm256_extract_epi64(total, 0)
+                  + (usize_t)_mm256_extract_epi64(total, 1)
+                  + (usize_t)_mm256_extract_epi64(total, 2)
+                  + (usize_t)_mm256_extract_epi64(total, 3);
+    return sum + bitset_count_scalar(words + i, count - i);
+}
+#endif
+
+#if defined(BITSET_SIMD_NEON)
+/**
+ * @brief Combines two ranges of words with NEON.
+ * @see bitset_apply_scalar
+ */
+static void
+bitset_apply_neon(ullong_t *dest, const ullong_t *src, usize_t count,
+                  uint_t op)
+{
+    usize_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        uint64x2_t a = vld1q_u64(dest + i);
+        uint64x2_t b = vld1q_u64(src + i);
+        switch (op)
+        {
+        case BITSET_OP_AND:
+            a = vandq_u64(a, b);
+            break;
+        case BITSET_OP_OR:
+            a = vorrq_u64(a, b);
+            break;
+        case BITSET_OP_XOR:
+            a = veorq_u64(a, b);
+            break;
+        default:
+            a = vbicq_u64(a, b);
+            break;
+        }
+        vst1q_u64(dest + i, a);
+    }
+    bitset_apply_scalar(dest + i, src + i, count - i, op);
+}
+
+/**
+ * @brief Counts the set bits of a range of words with NEON.
+ * @see bitset_count_scalar
+ */
+static usize_t
+bitset_count_neon(const ullong_t *words, usize_t count)
+{
+    usize_t total = 0;
+    usize_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        uint8x16_t bytes = vreinterpretq_u8_u64(vld1q_u64(words + i));
+        total += vaddvq_u8(vcntq_u8(bytes));
+    }
+    return total + bitset_count_scalar(words + i, count - i);
+}
+#endif
+
+/**
+ * @brief Combines two ranges of words with the fastest available code.
+ * @see bitset_apply_scalar
+ */
+static void
+bitset_apply(ullong_t *dest, const ullong_t *src, usize_t count, uint_t op)
+{
+#if defined(BITSET_SIMD_AVX2)
+    if (BITSET_HAS_AVX2())
+    {
+        bitset_apply_avx2(dest, src, count, op);
+        return;
+    }
+#endif
+#if defined(BITSET_SIMD_SSE2)
+    bitset_apply_sse2(dest, src, count, op);
+#elif defined(BITSET_SIMD_NEON)
+    bitset_apply_neon(dest, src, count, op);
+#else
+    bitset_apply_scalar(dest, src, count, op);
+#endif
+}
+
+/**
+ * @brief Counts the set bits of a range of words with the fastest
+ *        available code.
+ * @see bitset_count_scalar
+ */
+static usize_t
+bitset_count_words(const ullong_t *words, usize_t count)
+{
+#if defined(BITSET_SIMD_AVX2)
+    if (BITSET_HAS_AVX2())
+    {
+        return bitset_count_avx2(words, count);
+    }
+#endif
+#if defined(BITSET_POPCNT)
+    if (BITSET_HAS_POPCNT())
+    {
+        return bitset_count_popcnt(words, count);
+    }
+#endif
+#if defined(BITSET_SIMD_NEON)
+    return bitset_count_neon(words, count);
+#else
+    return bitset_count_scalar(words, count);
+#endif
+}
+
+/**
+ * @brief Clears the bits of the last word beyond the size of a bitset.
+ * @param bitset The bitset.
+ */
+static void
+bitset_clear_tail(bitset_t *bitset)
+{
+    usize_t used = bitset->size % BITSET_WORD_BITS;
+    if (used)
+    {
+        bitset->words[bitset->size / BITSET_WORD_BITS] &= (1ULL << used) - 1;
+    }
+}
+
+void
+bitset_init(bitset_t *bitset, const allocator_t *allocator)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(bitset, , "invalid bitset pointer")
+
+    bitset->words = nullptr;
+    bitset->size = 0;
+    bitset->capacity = 0;
+    bitset->allocator = allocator;
+}
+
+void
+bitset_free(bitset_t *bitset)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(bitset, , "invalid bitset pointer")
+
+    alloc_delete(bitset->allocator, bitset->words,
+                 bitset->capacity * sizeof(ullong_t));
+    bitset->words = nullptr;
+    bitset->size = 0;
+    bitset->capacity = 0;
+}
+
+bool
+bitset_resize(bitset_t *bitset, usize_t size)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(bitset, false, "invalid bitset pointer")
+
+    usize_t words = BITSET_WORDS(size);
+    usize_t used = BITSET_WORDS(bitset->size);
+
+    if (words > bitset->capacity)
+    {
+        usize_t capacity = bitset->capacity * 2;
+        if (capacity < words)
+        {
+            capacity = words;
+        }
+
+        ullong_t *block = alloc_resize(bitset->allocator, bitset->words,
+                                       bitset->capacity * sizeof(ullong_t),
+                                       capacity * sizeof(ullong_t));
+        if (!block)
+        {
+            return false;
+        }
+        bitset->words = block;
+        bitset->capacity = capacity;
+    }
+
+    // Bits past the old size are clear within its last word, the words
+    // after it may hold stale bits from before a shrink.
+    for (usize_t i = used; i < words; ++i)
+    {
+        bitset->words[i] = 0;
+    }
+
+    bitset->size = size;
+    bitset_clear_tail(bitset);
+    return true;
+}
+
+void
+bitset_set(bitset_t *bitset, usize_t index)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(bitset, , "invalid bitset pointer")
+    LIQUID_EXCEPTION_RAISE_IF(index >= bitset->size, , "index out of range")
+
+    bitset->words[index / BITSET_WORD_BITS] |= 1ULL
+                                               << (index % BITSET_WORD_BITS);
+}
+
+void
+bitset_unset(bitset_t *bitset, usize_t index)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(bitset, , "invalid bitset pointer")
+    LIQUID_EXCEPTION_RAISE_IF(index >= bitset->size, , "index out of range")
+
+    bitset->words[index / BITSET_WORD_BITS] &=
+        ~(1ULL << (index % BITSET_WORD_BITS));
+}
+
+bool
+bitset_test(const bitset_t *bitset, usize_t index)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(bitset, false, "invalid bitset pointer")
+    LIQUID_EXCEPTION_RAISE_IF(index >= bitset->size, false,
+                              "index out of range")
+
+    return (bitset->words[index / BITSET_WORD_BITS]
+            >> (index % BITSET_WORD_BITS))
+           & 1;
+}
+
+void
+bitset_set_all(bitset_t *bitset)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(bitset, , "invalid bitset pointer")
+
+    usize_t words = BITSET_WORDS(bitset->size);
+    for (usize_t i = 0; i < words; ++i)
+    {
+        bitset->words[i] = ~0ULL;
+    }
+    bitset_clear_tail(bitset);
+}
+
+void
+bitset_clear(bitset_t *bitset)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(bitset, , "invalid bitset pointer")
+
+    usize_t words = BITSET_WORDS(bitset->size);
+    for (usize_t i = 0; i < words; ++i)
+    {
+        bitset->words[i] = 0;
+    }
+}
+
+usize_t
+bitset_count(const bitset_t *bitset)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(bitset, 0, "invalid bitset pointer")
+
+    return bitset_count_words(bitset->words, BITSET_WORDS(bitset->size));
+}
+
+usize_t
+bitset_next(const bitset_t *bitset, usize_t from)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(bitset, BITSET_NONE,
+                                  "invalid bitset pointer")
+
+    if (from >= bitset->size)
+    {
+        return BITSET_NONE;
+    }
+
+    usize_t  words = BITSET_WORDS(bitset->size);
+    usize_t  index = from / BITSET_WORD_BITS;
+    ullong_t word = bitset->words[index] & (~0ULL << (from % BITSET_WORD_BITS));
+    while (!word)
+    {
+        if (++index == words)
+        {
+            return BITSET_NONE;
+        }
+        word = bitset->words[index];
+    }
+    return index * BITSET_WORD_BITS + bitflag_ctz64(word);
+}
+
+usize_t
+bitset_prev(const bitset_t *bitset, usize_t from)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(bitset, BITSET_NONE,
+                                  "invalid bitset pointer")
+
+    if (!bitset->size)
+    {
+        return BITSET_NONE;
+    }
+    if (from >= bitset->size)
+    {
+        from = bitset->size - 1;
+    }
+
+    usize_t  index = from / BITSET_WORD_BITS;
+    uint_t   unused = BITSET_WORD_BITS - 1 - (uint_t)(from % BITSET_WORD_BITS);
+    ullong_t word = bitset->words[index] & (~0ULL >> unused);
+    while (!word)
+    {
+        if (!index)
+        {
+            return BITSET_NONE;
+        }
+        word = bitset->words[--index];
+    }
+    return index * BITSET_WORD_BITS + BITSET_WORD_BITS - 1
+           - bitflag_clz64(word);
+}
+
+/**
+ * @brief Combines a bitset with another one of the same size.
+ *
+ * @param dest The bitset to modify.
+ * @param src The bitset to combine it with.
+ * @param op The operation.
+ */
+static void
+bitset_combine(bitset_t *dest, const bitset_t *src, uint_t op)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && src, , "invalid bitset pointer")
+    LIQUID_EXCEPTION_RAISE_IF(dest->size != src->size, ,
+                              "bitset sizes differ")
+
+    bitset_apply(dest->words, src->words, BITSET_WORDS(dest->size), op);
+}
+
+void
+bitset_and(bitset_t *dest, const bitset_t *src)
+{
+    bitset_combine(dest, src, BITSET_OP_AND);
+}
+
+void
+bitset_or(bitset_t *dest, const bitset_t *src)
+{
+    bitset_combine(dest, src, BITSET_OP_OR);
+}
+
+void
+bitset_xor(bitset_t *dest, const bitset_t *src)
+{
+    bitset_combine(dest, src, BITSET_OP_XOR);
+}
+
+void
+bitset_andnot(bitset_t *dest, const bitset_t *src)
+{
+    bitset_combine(dest, src, BITSET_OP_ANDNOT);
+}
+
+/**
+ * @brief Computes the size of the storage of a container.
+ * @param container The container.
+ * @return The size in bytes.
+ */
+static usize_t
+roaring_data_size(const roaring_container_t *container)
+{
+    return ROARING_IS_BITMAP(container)
+               ? ROARING_BITMAP_SIZE
+               : container->capacity * sizeof(ushort_t);
+}
+
+/**
+ * @brief Finds the first value of a sorted array not below a bound.
+ *
+ * @param values The sorted values.
+ * @param count The number of values.
+ * @param value The bound.
+ * @return The index of the value or count if there is none.
+ */
+static uint_t
+roaring_lower_bound(const ushort_t *values, uint_t count, uint_t value)
+{
+    uint_t low = 0;
+    while (count)
+    {
+        uint_t half = count / 2;
+        if (values[low + half] < value)
+        {
+            low += half + 1;
+            count -= half + 1;
+        }
+        else
+        {
+            count = half;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Finds the first container whose key is not below a bound.
+ *
+ * @param roaring The bitmap.
+ * @param key The bound.
+ * @return The index of the container or the number of containers.
+ */
+static usize_t
+roaring_find(const roaring_t *roaring, uint_t key)
+{
+    usize_t low = 0;
+    usize_t count = roaring->size;
+    while (count)
+    {
+        usize_t half = count / 2;
+        if (roaring->containers[low + half].key < key)
+        {
+            low += half + 1;
+            count -= half + 1;
+        }
+        else
+        {
+            count = half;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Inserts an empty array container.
+ *
+ * @param roaring The bitmap.
+ * @param pos The index of the new container.
+ * @param key The key of the new container.
+ * @return True on success, false if an allocation failed.
+ */
+static bool
+roaring_insert(roaring_t *roaring, usize_t pos, uint_t key)
+{
+    if (roaring->size == roaring->capacity)
+    {
+        usize_t capacity = roaring->capacity ? roaring->capacity * 2 : 4;
+        roaring_container_t *block = alloc_resize(
+            roaring->allocator, roaring->containers,
+            roaring->capacity * sizeof(roaring_container_t),
+            capacity * sizeof(roaring_container_t));
+        if (!block)
+        {
+            return false;
+        }
+        roaring->containers = block;
+        roaring->capacity = capacity;
+    }
+
+    void *data =
+        alloc_new(roaring->allocator, ROARING_ARRAY_MIN * sizeof(ushort_t));
+    if (!data)
+    {
+        return false;
+    }
+
+    roaring_container_t *container = roaring->containers + pos;
+    array_raw_move(container + 1, container,
+                   (roaring->size - pos) * sizeof(roaring_container_t));
+    container->data = data;
+    container->key = key;
+    container->count = 0;
+    container->capacity = ROARING_ARRAY_MIN;
+    ++roaring->size;
+    return true;
+}
+
+/**
+ * @brief Removes a container and releases its storage.
+ *
+ * @param roaring The bitmap.
+ * @param pos The index of the container.
+ */
+static void
+roaring_erase(roaring_t *roaring, usize_t pos)
+{
+    roaring_container_t *container = roaring->containers + pos;
+    alloc_delete(roaring->allocator, container->data,
+                 roaring_data_size(container));
+    array_raw_move(container, container + 1,
+                   (roaring->size - pos - 1) * sizeof(roaring_container_t));
+    --roaring->size;
+}
+
+/**
+ * @brief Converts an array container into a bitmap container.
+ *
+ * @param roaring The bitmap.
+ * @param container The container.
+ * @return True on success, false if the allocation failed.
+ */
+static bool
+roaring_to_bitmap(roaring_t *roaring, roaring_container_t *container)
+{
+    ullong_t *words = alloc_new(roaring->allocator, ROARING_BITMAP_SIZE);
+    if (!words)
+    {
+        return false;
+    }
+
+    for (uint_t i = 0; i < ROARING_BITMAP_WORDS; ++i)
+    {
+        words[i] = 0;
+    }
+    const ushort_t *values = container->data;
+    for (uint_t i = 0; i < container->count; ++i)
+    {
+        words[values[i] / 64] |= 1ULL << (values[i] % 64);
+    }
+
+    alloc_delete(roaring->allocator, container->data,
+                 roaring_data_size(container));
+    container->data = words;
+    container->capacity = 0;
+    return true;
+}
+
+/**
+ * @brief Converts a bitmap container that became sparse into an array
+ *        container.
+ *
+ * The container is left unchanged if it is dense or the allocation fails,
+ * both representations are valid for any number of values.
+ *
+ * @param roaring The bitmap.
+ * @param container The container.
+ */
+static void
+roaring_shrink(roaring_t *roaring, roaring_container_t *container)
+{
+    if (!ROARING_IS_BITMAP(container) || !container->count
+        || container->count > ROARING_ARRAY_MAX)
+    {
+        return;
+    }
+
+    ushort_t *values =
+        alloc_new(roaring->allocator, container->count * sizeof(ushort_t));
+    if (!values)
+    {
+        return;
+    }
+
+    const ullong_t *words = container->data;
+    uint_t          count = 0;
+    for (uint_t i = 0; i < ROARING_BITMAP_WORDS; ++i)
+    {
+        for (ullong_t word = words[i]; word; word &= word - 1)
+        {
+            values[count++] = (ushort_t)(i * 64 + bitflag_ctz64(word));
+        }
+    }
+
+    alloc_delete(roaring->allocator, container->data, ROARING_BITMAP_SIZE);
+    container->data = values;
+    container->capacity = container->count;
+}
+
+void
+roaring_init(roaring_t *roaring, const allocator_t *allocator)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(roaring, , "invalid roaring pointer")
+
+    roaring->containers = nullptr;
+    roaring->size = 0;
+    roaring->capacity = 0;
+    roaring->allocator = allocator;
+}
+
+void
+roaring_free(roaring_t *roaring)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(roaring, , "invalid roaring pointer")
+
+    for (usize_t i = 0; i < roaring->size; ++i)
+    {
+        alloc_delete(roaring->allocator, roaring->containers[i].data,
+                     roaring_data_size(roaring->containers + i));
+    }
+    alloc_delete(roaring->allocator, roaring->containers,
+                 roaring->capacity * sizeof(roaring_container_t));
+    roaring->containers = nullptr;
+    roaring->size = 0;
+    roaring->capacity = 0;
+}
+
+bool
+roaring_add(roaring_t *roaring, uint_t value)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(roaring, false, "invalid roaring pointer")
+
+    uint_t  key = value >> 16;
+    uint_t  low = value & 0xFFFF;
+    usize_t pos = roaring_find(roaring, key);
+    if (pos == roaring->size || roaring->containers[pos].key != key)
+    {
+        if (!roaring_insert(roaring, pos, key))
+        {
+            return false;
+        }
+    }
+
+    roaring_container_t *container = roaring->containers + pos;
+    if (!ROARING_IS_BITMAP(container))
+    {
+        ushort_t *values = container->data;
+        uint_t    index = roaring_lower_bound(values, container->count, low);
+        if (index < container->count && values[index] == low)
+        {
+            return true;
+        }
+
+        if (container->count < ROARING_ARRAY_MAX)
+        {
+            if (container->count == container->capacity)
+            {
+                uint_t capacity = container->capacity * 2;
+                if (capacity > ROARING_ARRAY_MAX)
+                {
+                    capacity = ROARING_ARRAY_MAX;
+                }
+                values = alloc_resize(roaring->allocator, values,
+                                      container->capacity * sizeof(ushort_t),
+                                      capacity * sizeof(ushort_t));
+                if (!values)
+                {
+                    return false;
+                }
+                container->data = values;
+                container->capacity = capacity;
+            }
+
+            array_raw_move(values + index + 1, values + index,
+                           (container->count - index) * sizeof(ushort_t));
+            values[index] = (ushort_t)low;
+            ++container->count;
+            return true;
+        }
+
+        if (!roaring_to_bitmap(roaring, container))
+        {
+            return false;
+        }
+    }
+
+    ullong_t *word = (ullong_t *)container->data + low / 64;
+    ullong_t  bit = 1ULL << (low % 64);
+    if (!(*word & bit))
+    {
+        *word |= bit;
+        ++container->count;
+    }
+    return true;
+}
+
+bool
+roaring_remove(roaring_t *roaring, uint_t value)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(roaring, false, "invalid roaring pointer")
+
+    uint_t  key = value >> 16;
+    uint_t  low = value & 0xFFFF;
+    usize_t pos = roaring_find(roaring, key);
+    if (pos == roaring->size || roaring->containers[pos].key != key)
+    {
+        return false;
+    }
+
+    roaring_container_t *container = roaring->containers + pos;
+    if (ROARING_IS_BITMAP(container))
+    {
+        ullong_t *word = (ullong_t *)container->data + low / 64;
+        ullong_t  bit = 1ULL << (low % 64);
+        if (!(*word & bit))
+        {
+            return false;
+        }
+        *word &= ~bit;
+        --container->count;
+        roaring_shrink(roaring, container);
+    }
+    else
+    {
+        ushort_t *values = container->data;
+        uint_t    index = roaring_lower_bound(values, container->count, low);
+        if (index == container->count || values[index] != low)
+        {
+            return false;
+        }
+        --container->count;
+        array_raw_move(values + index, values + index + 1,
+                       (container->count - index) * sizeof(ushort_t));
+    }
+
+    if (!container->count)
+    {
+        roaring_erase(roaring, pos);
+    }
+    return true;
+}
+
+bool
+roaring_contains(const roaring_t *roaring, uint_t value)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(roaring, false, "invalid roaring pointer")
+
+    uint_t  key = value >> 16;
+    uint_t  low = value & 0xFFFF;
+    usize_t pos = roaring_find(roaring, key);
+    if (pos == roaring->size || roaring->containers[pos].key != key)
+    {
+        return false;
+    }
+
+    const roaring_container_t *container = roaring->containers + pos;
+    if (ROARING_IS_BITMAP(container))
+    {
+        return (((const ullong_t *)container->data)[low / 64] >> (low % 64))
+               & 1;
+    }
+
+    const ushort_t *values = container->data;
+    uint_t          index = roaring_lower_bound(values, container->count, low);
+    return index < container->count && values[index] == low;
+}
+
+ullong_t
+roaring_count(const roaring_t *roaring)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(roaring, 0, "invalid roaring pointer")
+
+    ullong_t count = 0;
+    for (usize_t i = 0; i < roaring->size; ++i)
+    {
+        count += roaring->containers[i].count;
+    }
+    return count;
+}
+
+ullong_t
+roaring_next(const roaring_t *roaring, ullong_t from)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(roaring, ROARING_END,
+                                  "invalid roaring pointer")
+
+    if (from >= ROARING_END)
+    {
+        return ROARING_END;
+    }
+
+    uint_t key = (uint_t)(from >> 16);
+    uint_t low = (uint_t)from & 0xFFFF;
+    for (usize_t pos = roaring_find(roaring, key); pos < roaring->size; ++pos)
+    {
+        const roaring_container_t *container = roaring->containers + pos;
+        ullong_t                   base = (ullong_t)container->key << 16;
+        if (container->key != key)
+        {
+            low = 0;
+        }
+
+        if (ROARING_IS_BITMAP(container))
+        {
+            const ullong_t *words = container->data;
+            uint_t          index = low / 64;
+            ullong_t        word = words[index] & (~0ULL << (low % 64));
+            while (!word && ++index < ROARING_BITMAP_WORDS)
+            {
+                word = words[index];
+            }
+            if (word)
+            {
+                return base | (index * 64 + bitflag_ctz64(word));
+            }
+        }
+        else
+        {
+            const ushort_t *values = container->data;
+            uint_t index = roaring_lower_bound(values, container->count, low);
+            if (index < container->count)
+            {
+                return base | values[index];
+            }
+        }
+    }
+    return ROARING_END;
+}
+
+usize_t
+roaring_to_array(const roaring_t *roaring, uint_t *values)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(roaring && values, 0, "invalid pointer")
+
+    usize_t count = 0;
+    for (usize_t pos = 0; pos < roaring->size; ++pos)
+    {
+        const roaring_container_t *container = roaring->containers + pos;
+        uint_t                     base = container->key << 16;
+        if (ROARING_IS_BITMAP(container))
+        {
+            const ullong_t *words = container->data;
+            for (uint_t i = 0; i < ROARING_BITMAP_WORDS; ++i)
+            {
+                for (ullong_t word = words[i]; word; word &= word - 1)
+                {
+                    values[count++] = base | (i * 64 + bitflag_ctz64(word));
+                }
+            }
+        }
+        else
+        {
+            const ushort_t *lows = container->data;
+            for (uint_t i = 0; i < container->count; ++i)
+            {
+                values[count++] = base | lows[i];
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Intersects or subtracts two containers with the same key.
+ *
+ * The result replaces the values of dest in place.
+ *
+ * @param roaring The bitmap owning dest.
+ * @param dest The container to modify.
+ * @param src The container to combine it with.
+ * @param keep_common True to keep the common values, false to keep the
+ *                    values of dest missing from src.
+ */
+static void
+roaring_filter(roaring_t *roaring, roaring_container_t *dest,
+               const roaring_container_t *src, bool keep_common)
+{
+    if (ROARING_IS_BITMAP(dest) && ROARING_IS_BITMAP(src))
+    {
+        bitset_apply(dest->data, src->data, ROARING_BITMAP_WORDS,
+                     keep_common ? BITSET_OP_AND : BITSET_OP_ANDNOT);
+        dest->count =
+            (uint_t)bitset_count_words(dest->data, ROARING_BITMAP_WORDS);
+    }
+    else if (ROARING_IS_BITMAP(dest))
+    {
+        // Build the mask of every word from the values of src in order.
+        ullong_t       *words = dest->data;
+        const ushort_t *values = src->data;
+        uint_t          next = 0;
+        for (uint_t i = 0; i < ROARING_BITMAP_WORDS; ++i)
+        {
+            ullong_t mask = 0;
+            for (; next < src->count && values[next] / 64 == i; ++next)
+            {
+                mask |= 1ULL << (values[next] % 64);
+            }
+            words[i] &= keep_common ? mask : ~mask;
+        }
+        dest->count = (uint_t)bitset_count_words(words, ROARING_BITMAP_WORDS);
+    }
+    else if (ROARING_IS_BITMAP(src))
+    {
+        ushort_t       *values = dest->data;
+        const ullong_t *words = src->data;
+        uint_t          count = 0;
+        for (uint_t i = 0; i < dest->count; ++i)
+        {
+            uint_t present = (words[values[i] / 64] >> (values[i] % 64)) & 1;
+            if (present == (uint_t)keep_common)
+            {
+                values[count++] = values[i];
+            }
+        }
+        dest->count = count;
+    }
+    else
+    {
+        ushort_t       *values = dest->data;
+        const ushort_t *other = src->data;
+        uint_t          count = 0;
+        uint_t          next = 0;
+        for (uint_t i = 0; i < dest->count; ++i)
+        {
+            // Skip ahead by binary search, which pays off when src is
+            // much larger than dest.
+            next += roaring_lower_bound(other + next, src->count - next,
+                                        values[i]);
+            uint_t present = next < src->count && other[next] == values[i];
+            if (present == (uint_t)keep_common)
+            {
+                values[count++] = values[i];
+            }
+        }
+        dest->count = count;
+    }
+
+    roaring_shrink(roaring, dest);
+}
+
+/**
+ * @brief Intersects or subtracts a roaring bitmap with another one.
+ * @see roaring_filter
+ */
+static void
+roaring_filter_all(roaring_t *dest, const roaring_t *src, bool keep_common)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && src, , "invalid roaring pointer")
+
+    usize_t count = 0;
+    usize_t next = 0;
+    for (usize_t i = 0; i < dest->size; ++i)
+    {
+        roaring_container_t container = dest->containers[i];
+        while (next < src->size && src->containers[next].key < container.key)
+        {
+            ++next;
+        }
+
+        if (next < src->size && src->containers[next].key == container.key)
+        {
+            roaring_filter(dest, &container, src->containers + next,
+                           keep_common);
+        }
+        else if (keep_common)
+        {
+            container.count = 0;
+        }
+
+        if (container.count)
+        {
+            dest->containers[count++] = container;
+        }
+        else
+        {
+            alloc_delete(dest->allocator, container.data,
+                         roaring_data_size(&container));
+        }
+    }
+    dest->size = count;
+}
+
+void
+roaring_and(roaring_t *dest, const roaring_t *src)
+{
+    roaring_filter_all(dest, src, true);
+}
+
+void
+roaring_andnot(roaring_t *dest, const roaring_t *src)
+{
+    roaring_filter_all(dest, src, false);
+}
+
+/**
+ * @brief Copies a container.
+ *
+ * @param roaring The bitmap receiving the copy.
+ * @param dest The container receiving the copy.
+ * @param src The container to copy.
+ * @return True on success, false if the allocation failed.
+ */
+static bool
+roaring_copy(roaring_t *roaring, roaring_container_t *dest,
+             const roaring_container_t *src)
+{
+    *dest = *src;
+    if (!ROARING_IS_BITMAP(src))
+    {
+        dest->capacity = src->count;
+    }
+
+    usize_t size = roaring_data_size(dest);
+    dest->data = alloc_new(roaring->allocator, size);
+    if (!dest->data)
+    {
+        return false;
+    }
+    array_raw_move(dest->data, src->data, ROARING_IS_BITMAP(src)
+                                              ? ROARING_BITMAP_SIZE
+                                              : src->count * sizeof(ushort_t));
+    return true;
+}
+
+/**
+ * @brief Unites two containers with the same key.
+ *
+ * @param roaring The bitmap owning dest.
+ * @param dest The container to modify, unchanged on failure.
+ * @param src The container to unite it with.
+ * @return True on success, false if an allocation failed.
+ */
+static bool
+roaring_unite(roaring_t *roaring, roaring_container_t *dest,
+              const roaring_container_t *src)
+{
+    if (ROARING_IS_BITMAP(dest))
+    {
+        ullong_t *words = dest->data;
+        if (ROARING_IS_BITMAP(src))
+        {
+            bitset_apply(words, src->data, ROARING_BITMAP_WORDS,
+                         BITSET_OP_OR);
+            dest->count =
+                (uint_t)bitset_count_words(words, ROARING_BITMAP_WORDS);
+            return true;
+        }
+
+        const ushort_t *values = src->data;
+        for (uint_t i = 0; i < src->count; ++i)
+        {
+            ullong_t bit = 1ULL << (values[i] % 64);
+            dest->count += !(words[values[i] / 64] & bit);
+            words[values[i] / 64] |= bit;
+        }
+        return true;
+    }
+
+    const ushort_t *values = dest->data;
+    if (!ROARING_IS_BITMAP(src)
+        && dest->count + src->count <= ROARING_ARRAY_MAX)
+    {
+        uint_t    capacity = dest->count + src->count;
+        ushort_t *merged =
+            alloc_new(roaring->allocator, capacity * sizeof(ushort_t));
+        if (!merged)
+        {
+            return false;
+        }
+
+        const ushort_t *other = src->data;
+        uint_t          i = 0;
+        uint_t          j = 0;
+        uint_t          count = 0;
+        while (i < dest->count && j < src->count)
+        {
+            ushort_t a = values[i];
+            ushort_t b = other[j];
+            merged[count++] = a < b ? a : b;
+            i += a <= b;
+            j += b <= a;
+        }
+        while (i < dest->count)
+        {
+            merged[count++] = values[i++];
+        }
+        while (j < src->count)
+        {
+            merged[count++] = other[j++];
+        }
+
+        alloc_delete(roaring->allocator, dest->data, roaring_data_size(dest));
+        dest->data = merged;
+        dest->count = count;
+        dest->capacity = capacity;
+        return true;
+    }
+
+    // The union may exceed an array, so build it as a bitmap.
+    roaring_container_t united;
+    if (ROARING_IS_BITMAP(src))
+    {
+        if (!roaring_copy(roaring, &united, src))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        united = *dest;
+        united.capacity = 0;
+        united.data = alloc_new(roaring->allocator, ROARING_BITMAP_SIZE);
+        if (!united.data)
+        {
+            return false;
+        }
+        ullong_t *words = united.data;
+        for (uint_t i = 0; i < ROARING_BITMAP_WORDS; ++i)
+        {
+            words[i] = 0;
+        }
+        const ushort_t *other = src->data;
+        for (uint_t i = 0; i < src->count; ++i)
+        {
+            words[other[i] / 64] |= 1ULL << (other[i] % 64);
+        }
+    }
+
+    ullong_t *words = united.data;
+    for (uint_t i = 0; i < dest->count; ++i)
+    {
+        words[values[i] / 64] |= 1ULL << (values[i] % 64);
+    }
+    united.key = dest->key;
+    united.count = (uint_t)bitset_count_words(words, ROARING_BITMAP_WORDS);
+
+    alloc_delete(roaring->allocator, dest->data, roaring_data_size(dest));
+    *dest = united;
+    roaring_shrink(roaring, dest);
+    return true;
+}
+
+bool
+roaring_or(roaring_t *dest, const roaring_t *src)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && src, false,
+                                  "invalid roaring pointer")
+
+    if (!src->size)
+    {
+        return true;
+    }
+
+    usize_t              capacity = dest->size + src->size;
+    roaring_container_t *merged = alloc_new(
+        dest->allocator, capacity * sizeof(roaring_container_t));
+    if (!merged)
+    {
+        return false;
+    }
+
+    // After a failure the remaining containers of dest are still moved
+    // over, so dest keeps every value it had.
+    bool    success = true;
+    usize_t count = 0;
+    usize_t i = 0;
+    usize_t j = 0;
+    while (i < dest->size || j < src->size)
+    {
+        if (j == src->size
+            || (i < dest->size
+                && dest->containers[i].key < src->containers[j].key))
+        {
+            merged[count++] = dest->containers[i++];
+            continue;
+        }
+
+        const roaring_container_t *other = src->containers + j++;
+        if (i < dest->size && dest->containers[i].key == other->key)
+        {
+            roaring_container_t container = dest->containers[i++];
+            if (success && !roaring_unite(dest, &container, other))
+            {
+                success = false;
+            }
+            merged[count++] = container;
+        }
+        else if (success)
+        {
+            if (roaring_copy(dest, merged + count, other))
+            {
+                ++count;
+            }
+            else
+            {
+                success = false;
+            }
+        }
+    }
+
+    alloc_delete(dest->allocator, dest->containers,
+                 dest->capacity * sizeof(roaring_container_t));
+    dest->containers = merged;
+    dest->size = count;
+    dest->capacity = capacity;
+    return success;
+}
@@ -0,0 +1,575 @@
+#include <liquid/array-raw.h>
+#include <liquid/bitflag.h>
+#include <liquid/codec.h>
+#include <liquid/exception.h>
+#include <liquid/serial.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define CODEC_SIMD_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define CODEC_SIMD_NEON
+#endif
+
+/**
+ * @def CODEC_LANES
+ * @brief The number of lanes the values of a block are interleaved over.
+ */
+#define CODEC_LANES 4
+
+/**
+ * @def CODEC_ROWS
+ * @brief The number of values of a block in each lane.
+ */
+#define CODEC_ROWS (CODEC_BLOCK_SIZE / CODEC_LANES)
+
+/**
+ * @brief Computes the mask of the low bits of a value.
+ * @param bits The number of bits, between 0 and 32.
+ * @return The mask.
+ */
+static uint_t
+codec_mask(uint_t bits)
+{
+    return bits < 32 ? (1u << bits) - 1 : LIQUID_UINT_MAX;
+}
+
+#if defined(CODEC_SIMD_SSE2)
+/**
+ * @brief Packs a block with a bit width between 1 and 31.
+ *
+ * @param dest The words receiving the packed values.
+ * @param values The values.
+ * @param bits The bit width.
+ */
+static void
+codec_pack_block(uint_t *dest, const uint_t *values, uint_t bits)
+{
+    const __m128i *in = (const __m128i *)values;
+    __m128i       *out = (__m128i *)dest;
+    __m128i        mask = _mm_set1_epi32((int)codec_mask(bits));
+    __m128i        acc = _mm_setzero_si128();
+    uint_t         shift = 0;
+
+    for (uint_t row = 0; row < CODEC_ROWS; ++row)
+    {
+        __m128i value = _mm_and_si128(_mm_loadu_si128(in + row), mask);
+        acc = _mm_or_si128(acc,
+                           _mm_sll_epi32(value, _mm_cvtsi32_si128((int)shift)));
+        shift += bits;
+        if (shift >= 32)
+        {
+            // Carry the bits that did not fit over to the next word.
+            _mm_storeu_si128(out++, acc);
+            shift -= 32;
+            acc = _mm_srl_epi32(value, _mm_cvtsi32_si128((int)(bits - shift)));
+        }
+    }
+}
+
+/**
+ * @brief Unpacks a block with a bit width between 1 and 31 and adds a
+ *        base to the values.
+ *
+ * @param values Receives the values.
+ * @param src The packed words.
+ * @param bits The bit width.
+ * @param base The value added to every value.
+ */
+static void
+codec_unpack_block(uint_t *values, const uint_t *src, uint_t bits, uint_t base)
+{
+    const __m128i *in = (const __m128i *)src;
+    __m128i       *out = (__m128i *)values;
+    __m128i        mask = _mm_set1_epi32((int)codec_mask(bits));
+    __m128i        offset = _mm_set1_epi32((int)base);
+    __m128i        word = _mm_loadu_si128(in);
+    uint_t         shift = 0;
+
+    for (uint_t row = 0; row < CODEC_ROWS; ++row)
+    {
+        __m128i value = _mm_srl_epi32(word, _mm_cvtsi32_si128((int)shift));
+        shift += bits;
+        if (shift >= 32 && row < CODEC_ROWS - 1)
+        {
+            shift -= 32;
+            word = _mm_loadu_si128(++in);
+            value = _mm_or_si128(
+                value,
+                _mm_sll_epi32(word, _mm_cvtsi32_si128((int)(bits - shift))));
+        }
+        _mm_storeu_si128(out + row,
+                         _mm_add_epi32(_mm_and_si128(value, mask), offset));
+    }
+}
+#elif defined(CODEC_SIMD_NEON)
+/**
+ * @brief Packs a block with a bit width between 1 and 31.
+ *
+ * @param dest The words receiving the packed values.
+ * @param values The values.
+ * @param bits The bit width.
+ */
+static void
+codec_pack_block(uint_t *dest, const uint_t *values, uint_t bits)
+{
+    uint32x4_t mask = vdupq_n_u32(codec_mask(bits));
+    uint32x4_t acc = vdupq_n_u32(0);
+    uint_t     shift = 0;
+
+    for (uint_t row = 0; row < CODEC_ROWS; ++row)
+    {
+        uint32x4_t value = vandq_u32(vld1q_u32(values + row * 4), mask);
+        acc = vorrq_u32(acc, vshlq_u32(value, vdupq_n_s32((int)shift)));
+        shift += bits;
+        if (shift >= 32)
+        {
+            // Carry the bits that did not fit over to the next word.
+            vst1q_u32(dest, acc);
+            dest += CODEC_LANES;
+            shift -= 32;
+            acc = vshlq_u32(value, vdupq_n_s32(-(int)(bits - shift)));
+        }
+    }
+}
+
+/**
+ * @brief Unpacks a block with a bit width between 1 and 31 and adds a
+ *        base to the values.
+ *
+ * @param values Receives the values.
+ * @param src The packed words.
+ * @param bits The bit width.
+ * @param base The value added to every value.
+ */
+static void
+codec_unpack_block(uint_t *values, const uint_t *src, uint_t bits, uint_t base)
+{
+    uint32x4_t mask = vdupq_n_u32(codec_mask(bits));
+    uint32x4_t offset = vdupq_n_u32(base);
+    uint32x4_t word = vld1q_u32(src);
+    uint_t     shift = 0;
+
+    for (uint_t row = 0; row < CODEC_ROWS; ++row)
+    {
+        uint32x4_t value = vshlq_u32(word, vdupq_n_s32(-(int)shift));
+        shift += bits;
+        if (shift >= 32 && row < CODEC_ROWS - 1)
+        {
+            shift -= 32;
+            src += CODEC_LANES;
+            word = vld1q_u32(src);
+            value = vorrq_u32(
+                value, vshlq_u32(word, vdupq_n_s32((int)(bits - shift))));
+        }
+        vst1q_u32(values + row * 4,
+                  vaddq_u32(vandq_u32(value, mask), offset));
+    }
+}
+#else
+/**
+ * @brief Packs a block with a bit width between 1 and 31.
+ *
+ * @param dest The words receiving the packed values.
+ * @param values The values.
+ * @param bits The bit width.
+ */
+static void
+codec_pack_block(uint_t *dest, const uint_t *values, uint_t bits)
+{
+    uint_t mask = codec_mask(bits);
+    for (uint_t lane = 0; lane < CODEC_LANES; ++lane)
+    {
+        uint_t *out = dest + lane;
+        uint_t  acc = 0;
+        uint_t  shift = 0;
+        for (uint_t row = 0; row < CODEC_ROWS; ++row)
+        {
+            uint_t value = values[row * CODEC_LANES + lane] & mask;
+            acc |= value << shift;
+            shift += bits;
+            if (shift >= 32)
+            {
+                *out = acc;
+                out += CODEC_LANES;
+                shift -= 32;
+                acc = shift ? value >> (bits - shift) : 0;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Unpacks a block with a bit width between 1 and 31 and adds a
+ *        base to the values.
+ *
+ * @param values Receives the values.
+ * @param src The packed words.
+ * @param bits The bit width.
+ * @param base The value added to every value.
+ */
+static void
+codec_unpack_block(uint_t *values, const uint_t *src, uint_t bits, uint_t base)
+{
+    uint_t mask = codec_mask(bits);
+    for (uint_t lane = 0; lane < CODEC_LANES; ++lane)
+    {
+        const uint_t *in = src + lane;
+        uint_t        word = *in;
+        uint_t        shift = 0;
+        for (uint_t row = 0; row < CODEC_ROWS; ++row)
+        {
+            uint_t value = word >> shift;
+            shift += bits;
+            if (shift >= 32 && row < CODEC_ROWS - 1)
+            {
+                shift -= 32;
+                in += CODEC_LANES;
+                word = *in;
+                value |= word << (bits - shift);
+            }
+            values[row * CODEC_LANES + lane] = (value & mask) + base;
+        }
+    }
+}
+#endif
+
+/**
+ * @brief Unpacks a block of any bit width and adds a base to the values.
+ * @see codec_unpack_block
+ */
+static void
+codec_unpack(uint_t *values, const uint_t *src, uint_t bits, uint_t base)
+{
+    if (!bits)
+    {
+        for (uint_t i = 0; i < CODEC_BLOCK_SIZE; ++i)
+        {
+            values[i] = base;
+        }
+    }
+    else if (bits == 32)
+    {
+        // The packed layout of full words is the identity.
+        for (uint_t i = 0; i < CODEC_BLOCK_SIZE; ++i)
+        {
+            values[i] = src[i] + base;
+        }
+    }
+    else
+    {
+        codec_unpack_block(values, src, bits, base);
+    }
+}
+
+/**
+ * @brief Encodes a frame-of-reference block.
+ *
+ * @param dest The words receiving the block.
+ * @param values The CODEC_BLOCK_SIZE values.
+ * @return Pointer past the block.
+ */
+static uint_t *
+codec_for_block(uint_t *dest, const uint_t *values)
+{
+    uint_t min = values[0];
+    uint_t max = values[0];
+    for (uint_t i = 1; i < CODEC_BLOCK_SIZE; ++i)
+    {
+        min = values[i] < min ? values[i] : min;
+        max = values[i] > max ? values[i] : max;
+    }
+
+    uint_t offsets[CODEC_BLOCK_SIZE];
+    for (uint_t i = 0; i < CODEC_BLOCK_SIZE; ++i)
+    {
+        offsets[i] = values[i] - min;
+    }
+
+    uint_t bits = 32 - bitflag_clz32(max - min);
+    dest[0] = min;
+    dest[1] = bits;
+    return codec_pack128(dest + CODEC_FOR_HEADER, offsets, bits);
+}
+
+/**
+ * @brief Encodes values as frame-of-reference blocks.
+ *
+ * @param dest The words receiving the blocks.
+ * @param values The values.
+ * @param count The number of values.
+ * @param delta Whether to encode the differences of the values.
+ * @param base The predecessor of the first value if delta is set.
+ * @return Pointer past the last word written.
+ */
+static uint_t *
+codec_for_encode_blocks(uint_t *dest, const uint_t *values, usize_t count,
+                        bool delta, uint_t base)
+{
+    uint_t block[CODEC_BLOCK_SIZE];
+    for (usize_t i = 0; i < count; i += CODEC_BLOCK_SIZE)
+    {
+        usize_t size = count - i < CODEC_BLOCK_SIZE ? count - i
+                                                     : CODEC_BLOCK_SIZE;
+        if (delta)
+        {
+            codec_delta_encode(block, values + i, size, base);
+            base = values[i + size - 1];
+        }
+        else
+        {
+            array_raw_copy(block, values + i, size * sizeof(uint_t));
+        }
+
+        // Pad the last block with its first value so the padding costs no
+        // bits beyond those of the values.
+        for (usize_t j = size; j < CODEC_BLOCK_SIZE; ++j)
+        {
+            block[j] = block[0];
+        }
+        dest = codec_for_block(dest, block);
+    }
+    return dest;
+}
+
+/**
+ * @brief Decodes frame-of-reference blocks.
+ *
+ * Differences are summed up block by block while the block is in the
+ * cache.
+ *
+ * @param values Receives the values.
+ * @param src The first word of the blocks.
+ * @param end The end of the words.
+ * @param count The number of values encoded.
+ * @param delta Whether the blocks hold the differences of the values.
+ * @param base The predecessor of the first value if delta is set.
+ * @return Pointer past the last block or nullptr if the blocks are
+ *         malformed.
+ */
+static const uint_t *
+codec_for_decode_blocks(uint_t *values, const uint_t *src, const uint_t *end,
+                        usize_t count, bool delta, uint_t base)
+{
+    uint_t block[CODEC_BLOCK_SIZE];
+    for (usize_t i = 0; i < count; i += CODEC_BLOCK_SIZE)
+    {
+        if (end - src < CODEC_FOR_HEADER)
+        {
+            return nullptr;
+        }
+
+        uint_t min = src[0];
+        uint_t bits = src[1];
+        src += CODEC_FOR_HEADER;
+        if (bits > 32 || (usize_t)(end - src) < CODEC_LANES * bits)
+        {
+            return nullptr;
+        }
+
+        usize_t size = count - i < CODEC_BLOCK_SIZE ? count - i
+                                                     : CODEC_BLOCK_SIZE;
+        uint_t *out = size == CODEC_BLOCK_SIZE ? values + i : block;
+        codec_unpack(out, src, bits, min);
+        src += CODEC_LANES * bits;
+
+        if (delta)
+        {
+            codec_delta_decode(out, out, size, base);
+            base = out[size - 1];
+        }
+        if (out == block)
+        {
+            array_raw_copy(values + i, block, size * sizeof(uint_t));
+        }
+    }
+    return src;
+}
+
+uint_t
+codec_bits128(const uint_t *values)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(values, 0, "invalid values pointer")
+
+    uint_t any = 0;
+    for (uint_t i = 0; i < CODEC_BLOCK_SIZE; ++i)
+    {
+        any |= values[i];
+    }
+    return 32 - bitflag_clz32(any);
+}
+
+uint_t *
+codec_pack128(uint_t *dest, const uint_t *values, uint_t bits)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && values, nullptr,
+                                  "invalid destination or values pointer")
+    LIQUID_EXCEPTION_RAISE_IF(bits > 32, nullptr, "bit width exceeds 32")
+
+    if (bits == 32)
+    {
+        array_raw_copy(dest, values, CODEC_BLOCK_SIZE * sizeof(uint_t));
+    }
+    else if (bits)
+    {
+        codec_pack_block(dest, values, bits);
+    }
+    return dest + CODEC_LANES * bits;
+}
+
+const uint_t *
+codec_unpack128(uint_t *values, const uint_t *src, uint_t bits)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(values && src, nullptr,
+                                  "invalid values or source pointer")
+    LIQUID_EXCEPTION_RAISE_IF(bits > 32, nullptr, "bit width exceeds 32")
+
+    codec_unpack(values, src, bits, 0);
+    return src + CODEC_LANES * bits;
+}
+
+usize_t
+codec_for_bound(usize_t count)
+{
+    usize_t blocks = count / CODEC_BLOCK_SIZE + (count % CODEC_BLOCK_SIZE != 0);
+    return blocks * (CODEC_FOR_HEADER + CODEC_BLOCK_SIZE);
+}
+
+uint_t *
+codec_for_encode(uint_t *dest, const uint_t *values, usize_t count)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && (values || !count), nullptr,
+                                  "invalid destination or values pointer")
+
+    return codec_for_encode_blocks(dest, values, count, false, 0);
+}
+
+const uint_t *
+codec_for_decode(uint_t *values, const uint_t *src, const uint_t *end,
+                 usize_t count)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(src && end && (values || !count), nullptr,
+                                  "invalid range or values pointer")
+
+    return codec_for_decode_blocks(values, src, end, count, false, 0);
+}
+
+uint_t *
+codec_for_delta_encode(uint_t *dest, const uint_t *values, usize_t count,
+                       uint_t base)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && (values || !count), nullptr,
+                                  "invalid destination or values pointer")
+
+    return codec_for_encode_blocks(dest, values, count, true, base);
+}
+
+const uint_t *
+codec_for_delta_decode(uint_t *values, const uint_t *src, const uint_t *end,
+                       usize_t count, uint_t base)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(src && end && (values || !count), nullptr,
+                                  "invalid range or values pointer")
+
+    return codec_for_decode_blocks(values, src, end, count, true, base);
+}
+
+void
+codec_delta_encode(uint_t *dest, const uint_t *values, usize_t count,
+                   uint_t base)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && (values || !count), ,
+                                  "invalid destination or values pointer")
+
+    // Walk backwards so that dest may equal values.
+    for (usize_t i = count; i-- > 1;)
+    {
+        dest[i] = values[i] - values[i - 1];
+    }
+    if (count)
+    {
+        dest[0] = values[0] - base;
+    }
+}
+
+void
+codec_delta_decode(uint_t *dest, const uint_t *deltas, usize_t count,
+                   uint_t base)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && (deltas || !count), ,
+                                  "invalid destination or deltas pointer")
+
+    usize_t i = 0;
+#if defined(CODEC_SIMD_SSE2)
+    __m128i prev = _mm_set1_epi32((int)base);
+    for (; i + 4 <= count; i += 4)
+    {
+        // Prefix sum within the vector in two steps, then add the carry.
+        __m128i sum = _mm_loadu_si128((const __m128i *)(deltas + i));
+        sum = _mm_add_epi32(sum, _mm_slli_si128(sum, 4));
+        sum = _mm_add_epi32(sum, _mm_slli_si128(sum, 8));
+        sum = _mm_add_epi32(sum, prev);
+        _mm_storeu_si128((__m128i *)(dest + i), sum);
+        prev = _mm_shuffle_epi32(sum, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    base = (uint_t)_mm_cvtsi128_si32(prev);
+#elif defined(CODEC_SIMD_NEON)
+    uint32x4_t prev = vdupq_n_u32(base);
+    uint32x4_t zero = vdupq_n_u32(0);
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32x4_t sum = vld1q_u32(deltas + i);
+        sum = vaddq_u32(sum, vextq_u32(zero, sum, 3));
+        sum = vaddq_u32(sum, vextq_u32(zero, sum, 2));
+        sum = vaddq_u32(sum, prev);
+        vst1q_u32(dest + i, sum);
+        prev = vdupq_laneq_u32(sum, 3);
+    }
+    base = vgetq_lane_u32(prev, 0);
+#endif
+    for (; i < count; ++i)
+    {
+        base += deltas[i];
+        dest[i] = base;
+    }
+}
+
+bool
+codec_delta2_encode64(uint_t *dest, const ullong_t *values, usize_t count,
+                      ullong_t base)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && (values || !count), false,
+                                  "invalid destination or values pointer")
+
+    ullong_t prev_delta = 0;
+    for (usize_t i = 0; i < count; ++i)
+    {
+        ullong_t delta = values[i] - base;
+        sllong_t change = (sllong_t)(delta - prev_delta);
+        if (change < LIQUID_SINT_MIN || change > LIQUID_SINT_MAX)
+        {
+            return false;
+        }
+        dest[i] = serial_zigzag32((sint_t)change);
+        base = values[i];
+        prev_delta = delta;
+    }
+    return true;
+}
+
+void
+codec_delta2_decode64(ullong_t *dest, const uint_t *src, usize_t count,
+                      ullong_t base)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && (src || !count), ,
+                                  "invalid destination or source pointer")
+
+    ullong_t delta = 0;
+    for (usize_t i = 0; i < count; ++i)
+    {
+        delta += (ullong_t)(sllong_t)serial_unzigzag32(src[i]);
+        base += delta;
+        dest[i] = base;
+    }
+}
@@ -0,0 +1,46 @@
+/**
+ * @file event-backend.h
+ * @brief The functions of the system backend of the event loops.
+ *
+ * event.c implements what all systems share, the timers and the wake-up
+ * protocol, on top of these functions and the ones of event.h that the
+ * backend in event-linux.c, event-darwin.c or event-windows.c implements.
+ */
+
+#ifndef LIQUID_EVENT_BACKEND_H
+#define LIQUID_EVENT_BACKEND_H
+
+#include <liquid/event.h>
+
+/**
+ * @brief Creates the system objects of a loop.
+ * @param loop The loop.
+ * @return True on success, false on failure.
+ */
+bool
+event_backend_init(event_loop_t *loop);
+
+/**
+ * @brief Releases the system objects of a loop.
+ * @param loop The loop.
+ */
+void
+event_backend_free(event_loop_t *loop);
+
+/**
+ * @brief Signals the wake-up of a loop to the system.
+ * @param loop The loop.
+ * @return True on success, false on failure.
+ */
+bool
+event_backend_signal(event_loop_t *loop);
+
+/**
+ * @brief Handles a harvested wake-up: clears the signal and calls the wake
+ *        callback.
+ * @param loop The loop.
+ */
+void
+event_backend_woken(event_loop_t *loop);
+
+#endif // LIQUID_EVENT_BACKEND_H
@@ -0,0 +1,193 @@
+#include "event-backend.h"
+#include <errno.h>
+#include <liquid/exception.h>
+#include <sys/event.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @def EVENT_WAKE_IDENT
+ * @brief The identifier of the user filter that wakes a loop.
+ */
+#define EVENT_WAKE_IDENT 0
+
+/**
+ * @brief Applies the filters of a source to the kqueue.
+ *
+ * @param loop The loop.
+ * @param source The source.
+ * @param interest EVENT_READ and EVENT_WRITE.
+ * @param flags EV_ADD to register the filters, 0 to change them.
+ * @return True on success, false on failure.
+ */
+static bool
+event_kqueue_apply(event_loop_t *loop, event_source_t *source,
+                   uint_t interest, ushort_t flags)
+{
+    // Both filters are always registered, edge-triggered through EV_CLEAR,
+    // and enabled according to the interest.
+    struct kevent changes[2];
+    EV_SET(&changes[0], source->handle, EVFILT_READ,
+           flags | EV_CLEAR | (interest & EVENT_READ ? EV_ENABLE : EV_DISABLE),
+           0, 0, source);
+    EV_SET(&changes[1], source->handle, EVFILT_WRITE,
+           flags | EV_CLEAR
+               | (interest & EVENT_WRITE ? EV_ENABLE : EV_DISABLE),
+           0, 0, source);
+    return !kevent(loop->backend.queue, changes, 2, nullptr, 0, nullptr);
+}
+
+ullong_t
+event_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (ullong_t)now.tv_sec * 1000 + (ullong_t)now.tv_nsec / 1000000;
+}
+
+bool
+event_backend_init(event_loop_t *loop)
+{
+    loop->backend.queue = kqueue();
+    if (loop->backend.queue < 0)
+    {
+        return false;
+    }
+
+    struct kevent change;
+    EV_SET(&change, EVENT_WAKE_IDENT, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0,
+           nullptr);
+    if (kevent(loop->backend.queue, &change, 1, nullptr, 0, nullptr))
+    {
+        event_backend_free(loop);
+        return false;
+    }
+    return true;
+}
+
+void
+event_backend_free(event_loop_t *loop)
+{
+    if (loop->backend.queue >= 0)
+    {
+        close(loop->backend.queue);
+    }
+    loop->backend.queue = -1;
+}
+
+bool
+event_backend_signal(event_loop_t *loop)
+{
+    struct kevent change;
+    EV_SET(&change, EVENT_WAKE_IDENT, EVFILT_USER, 0, NOTE_TRIGGER, 0,
+           nullptr);
+    return !kevent(loop->backend.queue, &change, 1, nullptr, 0, nullptr);
+}
+
+bool
+event_loop_add(event_loop_t *loop, event_source_t *source)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop && source && source->callback, false,
+                                  "invalid loop, source or callback pointer")
+
+    return event_kqueue_apply(loop, source, source->interest, EV_ADD);
+}
+
+bool
+event_loop_modify(event_loop_t *loop, event_source_t *source,
+                  uint_t interest)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop && source, false,
+                                  "invalid loop or source pointer")
+
+    if (!event_kqueue_apply(loop, source, interest, 0))
+    {
+        return false;
+    }
+    source->interest = interest;
+    return true;
+}
+
+bool
+event_loop_remove(event_loop_t *loop, event_source_t *source)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop && source, false,
+                                  "invalid loop or source pointer")
+
+    // Events of the source that are still to be dispatched point to the
+    // backend instead, which the dispatch skips.
+    struct kevent *batch = loop->batch;
+    for (uint_t i = loop->batch_next; i < loop->batch_size; ++i)
+    {
+        if (batch[i].udata == source)
+        {
+            batch[i].udata = &loop->backend;
+        }
+    }
+
+    struct kevent changes[2];
+    EV_SET(&changes[0], source->handle, EVFILT_READ, EV_DELETE, 0, 0,
+           nullptr);
+    EV_SET(&changes[1], source->handle, EVFILT_WRITE, EV_DELETE, 0, 0,
+           nullptr);
+    return !kevent(loop->backend.queue, changes, 2, nullptr, 0, nullptr);
+}
+
+bool
+event_loop_poll(event_loop_t *loop, sint_t timeout)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop, false, "invalid loop pointer")
+
+    struct timespec wait;
+    wait.tv_sec = timeout / 1000;
+    wait.tv_nsec = (long)(timeout % 1000) * 1000000;
+
+    struct kevent batch[EVENT_BATCH];
+    sint_t        count = kevent(loop->backend.queue, nullptr, 0, batch,
+                                 EVENT_BATCH, timeout < 0 ? nullptr : &wait);
+    if (count < 0)
+    {
+        return errno == EINTR;
+    }
+
+    loop->batch = batch;
+    loop->batch_size = (uint_t)count;
+    for (loop->batch_next = 0; loop->batch_next < loop->batch_size;)
+    {
+        struct kevent  *harvested = &batch[loop->batch_next++];
+        event_source_t *source = harvested->udata;
+        if (harvested->filter == EVFILT_USER)
+        {
+            event_backend_woken(loop);
+            continue;
+        }
+        if (!source || (void *)source == &loop->backend)
+        {
+            continue;
+        }
+
+        // A closed peer reads as the end of the data.
+        event_t event = {0, nullptr, 0};
+        if (harvested->flags & EV_ERROR)
+        {
+            event.events |= EVENT_ERROR;
+        }
+        else if (harvested->filter == EVFILT_READ)
+        {
+            event.events |= EVENT_READ;
+        }
+        else if (harvested->filter == EVFILT_WRITE)
+        {
+            event.events |= EVENT_WRITE;
+        }
+        if (harvested->flags & EV_EOF)
+        {
+            event.events |= EVENT_HANGUP;
+        }
+        source->callback(loop, source, &event);
+    }
+    loop->batch = nullptr;
+    loop->batch_next = 0;
+    loop->batch_size = 0;
+    return true;
+}
@@ -0,0 +1,194 @@
+#include "event-backend.h"
+#include <errno.h>
+#include <liquid/exception.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Translates the interest of a source to epoll events.
+ * @param interest EVENT_READ and EVENT_WRITE.
+ * @return The edge-triggered epoll events.
+ */
+static uint_t
+event_epoll_events(uint_t interest)
+{
+    uint_t events = EPOLLET | EPOLLRDHUP;
+    if (interest & EVENT_READ)
+    {
+        events |= EPOLLIN;
+    }
+    if (interest & EVENT_WRITE)
+    {
+        events |= EPOLLOUT;
+    }
+    return events;
+}
+
+ullong_t
+event_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (ullong_t)now.tv_sec * 1000 + (ullong_t)now.tv_nsec / 1000000;
+}
+
+bool
+event_backend_init(event_loop_t *loop)
+{
+    loop->backend.poll = epoll_create1(EPOLL_CLOEXEC);
+    loop->backend.wake = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    // The eventfd is the only source registered without a pointer.
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLET;
+    event.data.ptr = nullptr;
+    if (loop->backend.poll < 0 || loop->backend.wake < 0
+        || epoll_ctl(loop->backend.poll, EPOLL_CTL_ADD, loop->backend.wake,
+                     &event))
+    {
+        event_backend_free(loop);
+        return false;
+    }
+    return true;
+}
+
+void
+event_backend_free(event_loop_t *loop)
+{
+    if (loop->backend.poll >= 0)
+    {
+        close(loop->backend.poll);
+    }
+    if (loop->backend.wake >= 0)
+    {
+        close(loop->backend.wake);
+    }
+    loop->backend.poll = -1;
+    loop->backend.wake = -1;
+}
+
+bool
+event_backend_signal(event_loop_t *loop)
+{
+    ullong_t one = 1;
+    ssize_t  count;
+    do
+    {
+        count = write(loop->backend.wake, &one, sizeof(one));
+    } while (count < 0 && errno == EINTR);
+
+    // A full counter already wakes the loop.
+    return count == sizeof(one) || errno == EAGAIN;
+}
+
+bool
+event_loop_add(event_loop_t *loop, event_source_t *source)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop && source && source->callback, false,
+                                  "invalid loop, source or callback pointer")
+
+    struct epoll_event event;
+    event.events = event_epoll_events(source->interest);
+    event.data.ptr = source;
+    return !epoll_ctl(loop->backend.poll, EPOLL_CTL_ADD, source->handle,
+                      &event);
+}
+
+bool
+event_loop_modify(event_loop_t *loop, event_source_t *source,
+                  uint_t interest)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop && source, false,
+                                  "invalid loop or source pointer")
+
+    struct epoll_event event;
+    event.events = event_epoll_events(interest);
+    event.data.ptr = source;
+    if (epoll_ctl(loop->backend.poll, EPOLL_CTL_MOD, source->handle, &event))
+    {
+        return false;
+    }
+    source->interest = interest;
+    return true;
+}
+
+bool
+event_loop_remove(event_loop_t *loop, event_source_t *source)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop && source, false,
+                                  "invalid loop or source pointer")
+
+    // Events of the source that are still to be dispatched point to the
+    // backend instead, which the dispatch skips.
+    struct epoll_event *batch = loop->batch;
+    for (uint_t i = loop->batch_next; i < loop->batch_size; ++i)
+    {
+        if (batch[i].data.ptr == source)
+        {
+            batch[i].data.ptr = &loop->backend;
+        }
+    }
+    return !epoll_ctl(loop->backend.poll, EPOLL_CTL_DEL, source->handle,
+                      nullptr);
+}
+
+bool
+event_loop_poll(event_loop_t *loop, sint_t timeout)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop, false, "invalid loop pointer")
+
+    struct epoll_event batch[EVENT_BATCH];
+    sint_t count = epoll_wait(loop->backend.poll, batch, EVENT_BATCH, timeout);
+    if (count < 0)
+    {
+        return errno == EINTR;
+    }
+
+    loop->batch = batch;
+    loop->batch_size = (uint_t)count;
+    for (loop->batch_next = 0; loop->batch_next < loop->batch_size;)
+    {
+        struct epoll_event *harvested = &batch[loop->batch_next++];
+        event_source_t     *source = harvested->data.ptr;
+        if (!source)
+        {
+            ullong_t value;
+            while (read(loop->backend.wake, &value, sizeof(value)) < 0
+                   && errno == EINTR)
+            {
+            }
+            event_backend_woken(loop);
+            continue;
+        }
+        if ((void *)source == &loop->backend)
+        {
+            continue;
+        }
+
+        // A closed peer reads as the end of the data.
+        event_t event = {0, nullptr, 0};
+        if (harvested->events & (EPOLLIN | EPOLLHUP | EPOLLRDHUP))
+        {
+            event.events |= EVENT_READ;
+        }
+        if (harvested->events & EPOLLOUT)
+        {
+            event.events |= EVENT_WRITE;
+        }
+        if (harvested->events & (EPOLLHUP | EPOLLRDHUP))
+        {
+            event.events |= EVENT_HANGUP;
+        }
+        if (harvested->events & EPOLLERR)
+        {
+            event.events |= EVENT_ERROR;
+        }
+        source->callback(loop, source, &event);
+    }
+    loop->batch = nullptr;
+    loop->batch_next = 0;
+    loop->batch_size = 0;
+    return true;
+}
@@ -0,0 +1,134 @@
+#include "event-backend.h"
+#include <liquid/exception.h>
+#include <windows.h>
+
+ullong_t
+event_now(void)
+{
+    return GetTickCount64();
+}
+
+bool
+event_backend_init(event_loop_t *loop)
+{
+    // The port is only ever waited on by the thread of the loop.
+    loop->backend.port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr,
+                                                0, 1);
+    return loop->backend.port != nullptr;
+}
+
+void
+event_backend_free(event_loop_t *loop)
+{
+    if (loop->backend.port)
+    {
+        CloseHandle(loop->backend.port);
+    }
+    loop->backend.port = nullptr;
+}
+
+bool
+event_backend_signal(event_loop_t *loop)
+{
+    // The wake-up is the only completion posted without a key.
+    return PostQueuedCompletionStatus(loop->backend.port, 0, 0, nullptr);
+}
+
+bool
+event_loop_add(event_loop_t *loop, event_source_t *source)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop && source && source->callback, false,
+                                  "invalid loop, source or callback pointer")
+
+    if (!CreateIoCompletionPort(source->handle, loop->backend.port,
+                                (ULONG_PTR)source, 0))
+    {
+        return false;
+    }
+
+    // Operations that complete at once are still queued to the port, but
+    // no event has to be signaled for them.
+    SetFileCompletionNotificationModes(source->handle,
+                                       FILE_SKIP_SET_EVENT_ON_HANDLE);
+    return true;
+}
+
+bool
+event_loop_modify(event_loop_t *loop, event_source_t *source,
+                  uint_t interest)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop && source, false,
+                                  "invalid loop or source pointer")
+
+    // Completions are reported regardless of the interest.
+    source->interest = interest;
+    return true;
+}
+
+bool
+event_loop_remove(event_loop_t *loop, event_source_t *source)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop && source, false,
+                                  "invalid loop or source pointer")
+
+    // A handle cannot leave its port, only the completions of the source
+    // that are still to be dispatched are dropped.
+    OVERLAPPED_ENTRY *batch = loop->batch;
+    for (uint_t i = loop->batch_next; i < loop->batch_size; ++i)
+    {
+        if (batch[i].lpCompletionKey == (ULONG_PTR)source)
+        {
+            batch[i].lpCompletionKey = (ULONG_PTR)&loop->backend;
+        }
+    }
+    return true;
+}
+
+bool
+event_loop_poll(event_loop_t *loop, sint_t timeout)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop, false, "invalid loop pointer")
+
+    OVERLAPPED_ENTRY batch[EVENT_BATCH];
+    ULONG            count = 0;
+    if (!GetQueuedCompletionStatusEx(loop->backend.port, batch, EVENT_BATCH,
+                                     &count,
+                                     timeout < 0 ? INFINITE : (DWORD)timeout,
+                                     FALSE))
+    {
+        return GetLastError() == WAIT_TIMEOUT;
+    }
+
+    loop->batch = batch;
+    loop->batch_size = (uint_t)count;
+    for (loop->batch_next = 0; loop->batch_next < loop->batch_size;)
+    {
+        OVERLAPPED_ENTRY *harvested = &batch[loop->batch_next++];
+        event_source_t   *source = (event_source_t *)
+                                     harvested->lpCompletionKey;
+        if (!source)
+        {
+            event_backend_woken(loop);
+            continue;
+        }
+        if ((void *)source == &loop->backend)
+        {
+            continue;
+        }
+
+        // The status of the operation is kept in its OVERLAPPED.
+        event_t event;
+        event.events = EVENT_COMPLETE;
+        event.operation = harvested->lpOverlapped;
+        event.transferred = harvested->dwNumberOfBytesTransferred;
+        if (harvested->lpOverlapped && harvested->lpOverlapped->Internal)
+        {
+            event.events |= EVENT_ERROR;
+        }
+        source->callback(loop, source, &event);
+    }
+    loop->batch = nullptr;
+    loop->batch_next = 0;
+    loop->batch_size = 0;
+    return true;
+}
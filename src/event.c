@@ -0,0 +1,192 @@
+#include "event-backend.h"
+#include <liquid/exception.h>
+#include <liquid/trace.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define EVENT_SWAP(ptr, value)                                             \
+        __atomic_exchange_n(ptr, value, __ATOMIC_ACQ_REL)
+#elif defined(_MSC_VER)
+    #include <intrin.h>
+    #define EVENT_SWAP(ptr, value)                                             \
+        ((uint_t)_InterlockedExchange((volatile long *)(ptr), (long)(value)))
+#else
+    #error "Unsupported compiler"
+#endif
+
+/**
+ * @brief Calls the callback of an expired timer of a loop.
+ *
+ * @param wheel The wheel of the loop.
+ * @param node The timer in the wheel.
+ */
+static void
+event_timer_expire(wheel_t *wheel, wheel_timer_t *node)
+{
+    event_timer_t *timer = (event_timer_t *)node;
+    timer->callback((event_loop_t *)wheel->data, timer);
+}
+
+/**
+ * @brief Computes how long a run may wait for events.
+ *
+ * @param loop The loop.
+ * @param timeout The longest wait requested.
+ * @return The wait until the wheel is due, at most timeout.
+ */
+static sint_t
+event_wheel_timeout(const event_loop_t *loop, sint_t timeout)
+{
+    if (!loop->wheel.count || !timeout)
+    {
+        return timeout;
+    }
+
+    ullong_t wait = wheel_next(&loop->wheel);
+    if (timeout != EVENT_INFINITE && (ullong_t)timeout < wait)
+    {
+        return timeout;
+    }
+    return wait < 0x7FFFFFFF ? (sint_t)wait : 0x7FFFFFFF;
+}
+
+bool
+event_loop_init(event_loop_t *loop, event_wake_callback_t on_wake)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop, false, "invalid loop pointer")
+
+    loop->batch = nullptr;
+    loop->batch_next = 0;
+    loop->batch_size = 0;
+    loop->now = event_now();
+    wheel_init(&loop->wheel, nullptr, loop->now);
+    loop->wheel.data = loop;
+    loop->on_wake = on_wake;
+    loop->data = nullptr;
+    loop->wake_pending = 0;
+    loop->stopped = 0;
+    return event_backend_init(loop);
+}
+
+void
+event_loop_free(event_loop_t *loop)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop, , "invalid loop pointer")
+
+    event_backend_free(loop);
+    wheel_free(&loop->wheel);
+}
+
+bool
+event_loop_wake(event_loop_t *loop)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop, false, "invalid loop pointer")
+
+    // Only the first wake-up until the loop handles it reaches the system.
+    if (EVENT_SWAP(&loop->wake_pending, 1))
+    {
+        return true;
+    }
+    if (!event_backend_signal(loop))
+    {
+        EVENT_SWAP(&loop->wake_pending, 0);
+        return false;
+    }
+    return true;
+}
+
+void
+event_backend_woken(event_loop_t *loop)
+{
+    // Clearing the flag before the callback runs lets wake-ups that race
+    // with it signal again, and the exchange makes what their callers
+    // published before visible to the callback.
+    EVENT_SWAP(&loop->wake_pending, 0);
+    if (loop->on_wake)
+    {
+        loop->on_wake(loop);
+    }
+}
+
+bool
+event_loop_run_once(event_loop_t *loop, sint_t timeout)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop, false, "invalid loop pointer")
+
+    bool ok = true;
+    loop->now = event_now();
+    TRACE_SCOPE("liquid.event.timers")
+    {
+        wheel_advance(&loop->wheel, loop->now);
+    }
+    TRACE_SCOPE("liquid.event.poll")
+    {
+        ok = event_loop_poll(loop, event_wheel_timeout(loop, timeout));
+    }
+    loop->now = event_now();
+    TRACE_SCOPE("liquid.event.timers")
+    {
+        wheel_advance(&loop->wheel, loop->now);
+    }
+    return ok;
+}
+
+bool
+event_loop_run(event_loop_t *loop)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop, false, "invalid loop pointer")
+
+    bool ok = true;
+    while (ok && !loop->stopped)
+    {
+        ok = event_loop_run_once(loop, EVENT_INFINITE);
+    }
+    loop->stopped = 0;
+    return ok;
+}
+
+void
+event_loop_stop(event_loop_t *loop)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop, , "invalid loop pointer")
+
+    loop->stopped = 1;
+}
+
+void
+event_timer_init(event_timer_t *timer, event_timer_callback_t callback,
+                 void *data)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(timer && callback, ,
+                                  "invalid timer or callback pointer")
+
+    wheel_timer_init(&timer->node, event_timer_expire, nullptr);
+    timer->callback = callback;
+    timer->data = data;
+}
+
+void
+event_timer_start(event_loop_t *loop, event_timer_t *timer,
+                  ullong_t timeout)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop && timer, ,
+                                  "invalid loop or timer pointer")
+
+    wheel_timer_start(&loop->wheel, &timer->node, timeout);
+}
+
+void
+event_timer_stop(event_loop_t *loop, event_timer_t *timer)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(loop && timer, ,
+                                  "invalid loop or timer pointer")
+
+    wheel_timer_stop(&loop->wheel, &timer->node);
+}
+
+bool
+event_timer_active(const event_timer_t *timer)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(timer, false, "invalid timer pointer")
+
+    return wheel_timer_active(&timer->node);
+}
@@ -1,10 +1,12 @@
 #include <liquid/exception.h>
+#include <liquid/metric.h>
 
 exception_handler_fn *m_handler = nullptr;
 
 usize_t
 exception_raise(const errmsg_t message, usize_t len)
 {
+    LIQUID_METRIC_COUNT(metric_exceptions, 1);
     return m_handler ? m_handler(message, len) : 0;
 }
 
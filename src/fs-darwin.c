@@ -1 +1,443 @@
-#include <liquid/fs-darwin.h>
\ No newline at end of file
+#include "fs-watch-backend.h"
+#include <liquid/alloc.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <CoreServices/CoreServices.h>
+#include <dispatch/dispatch.h>
+
+// The system headers bring stdbool.h, the bool of the library is kept.
+#undef bool
+#undef true
+#undef false
+
+/**
+ * @def FS_WATCH_MODIFIED_FLAGS
+ * @brief The FSEvents flags reported as FS_WATCH_MODIFIED.
+ */
+#define FS_WATCH_MODIFIED_FLAGS                                                \
+    (kFSEventStreamEventFlagItemModified                                       \
+     | kFSEventStreamEventFlagItemInodeMetaMod                                 \
+     | kFSEventStreamEventFlagItemChangeOwner                                  \
+     | kFSEventStreamEventFlagItemXattrMod                                     \
+     | kFSEventStreamEventFlagItemFinderInfoMod)
+
+/**
+ * @def FS_WATCH_OVERFLOW_FLAGS
+ * @brief The FSEvents flags of changes that were lost.
+ */
+#define FS_WATCH_OVERFLOW_FLAGS                                                \
+    (kFSEventStreamEventFlagMustScanSubDirs                                    \
+     | kFSEventStreamEventFlagUserDropped                                      \
+     | kFSEventStreamEventFlagKernelDropped)
+
+/**
+ * @struct fs_watch_stream
+ * @brief A stream of a watched path, the context of its callback.
+ */
+typedef struct fs_watch_stream
+{
+    fs_watch_t      *watch;  ///< The watcher.
+    FSEventStreamRef stream; ///< The stream.
+    uint_t           flags;  ///< FS_WATCH_RECURSIVE if the tree is watched.
+    bool             file;   ///< Whether only the root itself is watched.
+    usize_t          size;   ///< The length of the path.
+    usize_t          length; ///< The length of the root.
+    char_t          *path;   ///< The path as given, reported to the caller.
+    char_t          *root;   ///< The path as FSEvents reports it.
+} fs_watch_stream_t;
+
+/**
+ * @struct fs_watch_record
+ * @brief The header of a change passed from the queue to the loop, which
+ *        its path follows.
+ */
+typedef struct fs_watch_record
+{
+    usize_t size;   ///< The length of the path.
+    uint_t  events; ///< The FS_WATCH_ flags of the change.
+} fs_watch_record_t;
+
+/**
+ * @brief Releases a stream and its paths.
+ * @param stream The stream.
+ */
+static void
+fs_watch_stream_free(fs_watch_stream_t *stream)
+{
+    if (stream->stream)
+    {
+        FSEventStreamStop(stream->stream);
+        FSEventStreamInvalidate(stream->stream);
+        FSEventStreamRelease(stream->stream);
+    }
+    alloc_delete(nullptr, stream->path, stream->size + 1);
+    alloc_delete(nullptr, stream->root, stream->length + 1);
+    alloc_delete(nullptr, stream, sizeof(fs_watch_stream_t));
+}
+
+/**
+ * @brief Appends a change to the records of a watcher, with the lock held.
+ *
+ * @param records The records.
+ * @param stream The stream, whose path is the prefix of the change.
+ * @param rest The rest of the path after the root and its separator.
+ * @param size The length of the rest.
+ * @param events The FS_WATCH_ flags of the change.
+ */
+static void
+fs_watch_record(array_t *records, const fs_watch_stream_t *stream,
+                const char_t *rest, usize_t size, uint_t events)
+{
+    // The separator is added unless the path is the root, which ends with
+    // one.
+    bool              separator = size && stream->path[stream->size - 1] != '/';
+    fs_watch_record_t record = {stream->size + separator + size, events};
+    usize_t           at = records->size;
+    if (events & FS_WATCH_OVERFLOW)
+    {
+        record.size = 0;
+    }
+    if (array_insert(records, at, &record, sizeof(record))
+        && (!record.size
+            || (array_insert(records, records->size, stream->path,
+                             stream->size)
+                && (!separator || array_push(records, &(char_t){'/'}))
+                && array_insert(records, records->size, rest, size))))
+    {
+        return;
+    }
+
+    // The memory of the records is kept, the caller has to scan.
+    array_clear(records);
+    record.size = 0;
+    record.events = FS_WATCH_OVERFLOW;
+    array_insert(records, 0, &record, sizeof(record));
+}
+
+/**
+ * @brief Passes the events of a stream to its loop, on the dispatch queue.
+ *
+ * @param reference The stream.
+ * @param info The stream of the watcher.
+ * @param count The number of events.
+ * @param paths The paths of the events.
+ * @param flags The flags of the events.
+ * @param ids The identifiers of the events.
+ */
+static void
+fs_watch_events(ConstFSEventStreamRef reference, void *info, size_t count,
+                void *paths, const FSEventStreamEventFlags flags[],
+                const FSEventStreamEventId ids[])
+{
+    fs_watch_stream_t  *stream = info;
+    fs_watch_backend_t *backend = &stream->watch->backend;
+    char              **names = paths;
+    (void)reference;
+    (void)ids;
+
+    pthread_mutex_lock(backend->lock);
+    bool signal = !backend->records.size;
+    for (usize_t i = 0; i < count; ++i)
+    {
+        if (flags[i] & FS_WATCH_OVERFLOW_FLAGS)
+        {
+            fs_watch_record(&backend->records, stream, "", 0,
+                            FS_WATCH_OVERFLOW);
+            continue;
+        }
+
+        // Only the changes below the root are reported, with the path of
+        // the caller in place of the root. The root / ends with the
+        // separator of its entries.
+        const char_t *name = names[i];
+        usize_t       size = strlen(name);
+        bool          slash = stream->root[stream->length - 1] == '/';
+        while (size > stream->length && name[size - 1] == '/')
+        {
+            --size;
+        }
+        if (size < stream->length
+            || memcmp(name, stream->root, stream->length)
+            || (size > stream->length && !slash
+                && name[stream->length] != '/'))
+        {
+            continue;
+        }
+        const char_t *rest = name + stream->length;
+        usize_t       length = size - stream->length;
+        if (length && !slash)
+        {
+            ++rest;
+            --length;
+        }
+        if (length
+            && (stream->file
+                || (!(stream->flags & FS_WATCH_RECURSIVE)
+                    && memchr(rest, '/', length))))
+        {
+            continue;
+        }
+
+        uint_t events = 0;
+        if (flags[i] & kFSEventStreamEventFlagItemCreated)
+        {
+            events |= FS_WATCH_CREATED;
+        }
+        if (flags[i] & kFSEventStreamEventFlagItemRemoved)
+        {
+            events |= FS_WATCH_DELETED;
+        }
+        if (flags[i] & kFSEventStreamEventFlagItemRenamed)
+        {
+            // A rename is reported on both paths, the one that exists now
+            // is the new one.
+            struct stat status;
+            events |= lstat(name, &status) ? FS_WATCH_DELETED
+                                           : FS_WATCH_CREATED;
+        }
+        if (flags[i] & FS_WATCH_MODIFIED_FLAGS)
+        {
+            events |= FS_WATCH_MODIFIED;
+        }
+        if (events)
+        {
+            fs_watch_record(&backend->records, stream, rest, length, events);
+        }
+    }
+    signal = signal && backend->records.size;
+    pthread_mutex_unlock(backend->lock);
+
+    // One byte stands for all the records until the loop takes them.
+    if (signal)
+    {
+        uchar_t byte = 0;
+        write(backend->signal, &byte, 1);
+    }
+}
+
+/**
+ * @brief Reports the records that the streams passed to the loop.
+ *
+ * @param loop The loop.
+ * @param source The source of the pipe.
+ * @param event The events.
+ */
+static void
+fs_watch_drain(event_loop_t *loop, event_source_t *source,
+               const event_t *event)
+{
+    fs_watch_t *watch = source->data;
+    uchar_t     bytes[64];
+    (void)loop;
+    (void)event;
+    while (read(source->handle, bytes, sizeof(bytes)) > 0)
+    {
+    }
+
+    array_t records;
+    pthread_mutex_lock(watch->backend.lock);
+    records = watch->backend.records;
+    ARRAY_INIT(&watch->backend.records, uchar_t, nullptr);
+    pthread_mutex_unlock(watch->backend.lock);
+
+    const uchar_t *data = records.data;
+    for (usize_t at = 0; at < records.size;)
+    {
+        fs_watch_record_t record;
+        memcpy(&record, data + at, sizeof(record));
+        at += sizeof(record);
+        fs_watch_report(watch, (const char_t *)(data + at), record.size,
+                        record.events);
+        at += record.size;
+    }
+    array_free(&records);
+}
+
+bool
+fs_watch_backend_init(fs_watch_t *watch)
+{
+    fs_watch_backend_t *backend = &watch->backend;
+    sint_t              ends[2];
+    if (pipe(ends))
+    {
+        return false;
+    }
+    for (uint_t i = 0; i < 2; ++i)
+    {
+        fcntl(ends[i], F_SETFD, FD_CLOEXEC);
+        fcntl(ends[i], F_SETFL, fcntl(ends[i], F_GETFL) | O_NONBLOCK);
+    }
+
+    backend->source.callback = fs_watch_drain;
+    backend->source.data = watch;
+    backend->source.handle = ends[0];
+    backend->source.interest = EVENT_READ;
+    backend->signal = ends[1];
+    backend->queue = dispatch_queue_create("liquid.fs.watch",
+                                           DISPATCH_QUEUE_SERIAL);
+    backend->lock = alloc_new(nullptr, sizeof(pthread_mutex_t));
+    ARRAY_INIT(&backend->streams, fs_watch_stream_t *, nullptr);
+    ARRAY_INIT(&backend->records, uchar_t, nullptr);
+    if (!backend->queue || !backend->lock
+        || pthread_mutex_init(backend->lock, nullptr))
+    {
+        alloc_delete(nullptr, backend->lock, sizeof(pthread_mutex_t));
+        backend->lock = nullptr;
+        fs_watch_backend_free(watch);
+        errno = ENOMEM;
+        return false;
+    }
+    if (!event_loop_add(watch->loop, &backend->source))
+    {
+        sint_t error = errno;
+        fs_watch_backend_free(watch);
+        errno = error;
+        return false;
+    }
+    return true;
+}
+
+bool
+fs_watch_backend_add(fs_watch_t *watch, const char_t *path, usize_t size,
+                     uint_t flags)
+{
+    // FSEvents reports the real paths, so symbolic links in the path have
+    // to be resolved to recognize them.
+    char_t copy[PATH_MAX];
+    char_t root[PATH_MAX];
+    if (size >= PATH_MAX)
+    {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    memcpy(copy, path, size);
+    copy[size] = 0;
+    struct stat status;
+    if (!realpath(copy, root) || stat(root, &status))
+    {
+        return false;
+    }
+
+    fs_watch_stream_t *stream = alloc_new(nullptr, sizeof(fs_watch_stream_t));
+    if (!stream)
+    {
+        errno = ENOMEM;
+        return false;
+    }
+    stream->watch = watch;
+    stream->stream = nullptr;
+    stream->flags = flags;
+    stream->file = !S_ISDIR(status.st_mode);
+    stream->size = size;
+    stream->length = strlen(root);
+    stream->path = alloc_new(nullptr, size + 1);
+    stream->root = alloc_new(nullptr, stream->length + 1);
+    if (!stream->path || !stream->root
+        || !array_push(&watch->backend.streams, &stream))
+    {
+        fs_watch_stream_free(stream);
+        errno = ENOMEM;
+        return false;
+    }
+    memcpy(stream->path, copy, size + 1);
+    memcpy(stream->root, root, stream->length + 1);
+
+    // A file is watched through its directory, a root of its own reports
+    // its changes.
+    if (stream->file)
+    {
+        *strrchr(root, '/') = 0;
+    }
+    FSEventStreamContext context = {0, stream, nullptr, nullptr, nullptr};
+    CFStringRef          name = CFStringCreateWithFileSystemRepresentation(
+        kCFAllocatorDefault, *root ? root : "/");
+    CFArrayRef paths = name ? CFArrayCreate(kCFAllocatorDefault,
+                                            (const void **)&name, 1,
+                                            &kCFTypeArrayCallBacks)
+                            : nullptr;
+    if (paths)
+    {
+        stream->stream = FSEventStreamCreate(
+            kCFAllocatorDefault, fs_watch_events, &context, paths,
+            kFSEventStreamEventIdSinceNow, 0.0,
+            kFSEventStreamCreateFlagFileEvents
+                | kFSEventStreamCreateFlagNoDefer);
+        CFRelease(paths);
+    }
+    if (name)
+    {
+        CFRelease(name);
+    }
+    if (!stream->stream)
+    {
+        array_pop(&watch->backend.streams);
+        fs_watch_stream_free(stream);
+        errno = ENOMEM;
+        return false;
+    }
+    FSEventStreamSetDispatchQueue(stream->stream, watch->backend.queue);
+    if (!FSEventStreamStart(stream->stream))
+    {
+        array_pop(&watch->backend.streams);
+        fs_watch_stream_free(stream);
+        errno = EIO;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Does nothing, run on the queue once its callbacks are done.
+ * @param data Unused.
+ */
+static void
+fs_watch_barrier(void *data)
+{
+    (void)data;
+}
+
+void
+fs_watch_backend_free(fs_watch_t *watch)
+{
+    fs_watch_backend_t *backend = &watch->backend;
+    for (usize_t i = 0; i < backend->streams.size; ++i)
+    {
+        fs_watch_stream_t *stream = ARRAY_AT(&backend->streams,
+                                             fs_watch_stream_t *, i);
+        FSEventStreamStop(stream->stream);
+        FSEventStreamInvalidate(stream->stream);
+    }
+
+    // A callback may still run on the queue until the barrier behind it.
+    if (backend->queue)
+    {
+        dispatch_sync_f(backend->queue, nullptr, fs_watch_barrier);
+        dispatch_release(backend->queue);
+    }
+    for (usize_t i = 0; i < backend->streams.size; ++i)
+    {
+        fs_watch_stream_t *stream = ARRAY_AT(&backend->streams,
+                                             fs_watch_stream_t *, i);
+        FSEventStreamRelease(stream->stream);
+        stream->stream = nullptr;
+        fs_watch_stream_free(stream);
+    }
+    array_free(&backend->streams);
+    array_free(&backend->records);
+    if (backend->lock)
+    {
+        pthread_mutex_destroy(backend->lock);
+        alloc_delete(nullptr, backend->lock, sizeof(pthread_mutex_t));
+    }
+
+    event_loop_remove(watch->loop, &backend->source);
+    close(backend->source.handle);
+    close(backend->signal);
+}
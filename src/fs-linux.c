@@ -1 +1,479 @@
-#include <liquid/fs-linux.h>
\ No newline at end of file
+#ifndef _GNU_SOURCE
+    #define _GNU_SOURCE
+#endif
+
+#include "fs-watch-backend.h"
+#include <liquid/alloc.h>
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @def FS_WATCH_MASK
+ * @brief The inotify events of every watch.
+ */
+#define FS_WATCH_MASK                                                          \
+    (IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_MOVED_FROM             \
+     | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_EXCL_UNLINK)
+
+/**
+ * @def FS_WATCH_BUFFER_SIZE
+ * @brief The size of the buffer the events are read into.
+ */
+#define FS_WATCH_BUFFER_SIZE (16 * 1024)
+
+/**
+ * @struct fs_watch_directory
+ * @brief The watched path of a watch descriptor.
+ */
+typedef struct fs_watch_directory
+{
+    char_t *path;  ///< The path, ending with a zero.
+    usize_t size;  ///< The length of the path.
+    uint_t  flags; ///< FS_WATCH_RECURSIVE if the tree is watched.
+    bool    seen;  ///< Whether the last scan of the roots reached it.
+} fs_watch_directory_t;
+
+/**
+ * @struct fs_watch_root
+ * @brief A path given to fs_watch_add, scanned again after an overflow.
+ */
+typedef struct fs_watch_root
+{
+    char_t *path;  ///< The path, ending with a zero.
+    usize_t size;  ///< The length of the path.
+    uint_t  flags; ///< Zero or FS_WATCH_RECURSIVE.
+} fs_watch_root_t;
+
+/**
+ * @brief Stops watching a descriptor and forgets its path.
+ *
+ * @param watch The watcher.
+ * @param descriptor The watch descriptor.
+ */
+static void
+fs_watch_forget(fs_watch_t *watch, sint_t descriptor)
+{
+    fs_watch_directory_t *directory = map_find(&watch->backend.paths,
+                                               &descriptor);
+    if (directory)
+    {
+        inotify_rm_watch(watch->backend.source.handle, descriptor);
+        alloc_delete(nullptr, directory->path, directory->size + 1);
+        map_erase(&watch->backend.paths, &descriptor);
+    }
+}
+
+/**
+ * @brief Stops watching a directory that moved and the directories below
+ *        it, whose paths are stale.
+ *
+ * @param watch The watcher.
+ * @param path The old path of the directory.
+ * @param size The length of the path.
+ */
+static void
+fs_watch_forget_tree(fs_watch_t *watch, const char_t *path, usize_t size)
+{
+    usize_t iter = 0;
+    sint_t *descriptor;
+    while ((descriptor = map_next(&watch->backend.paths, &iter)))
+    {
+        const fs_watch_directory_t *directory =
+            MAP_VALUE(&watch->backend.paths, descriptor);
+        if (directory->size >= size && !memcmp(directory->path, path, size)
+            && (directory->size == size || path[size - 1] == '/'
+                || directory->path[size] == '/'))
+        {
+            fs_watch_forget(watch, *descriptor);
+        }
+    }
+}
+
+/**
+ * @brief Watches a path and, for a recursive watch of a directory, every
+ *        directory below it.
+ *
+ * @param watch The watcher.
+ * @param path The path, ending with a zero that is counted in its size.
+ *             Names are appended to it during the scan.
+ * @param flags Zero or FS_WATCH_RECURSIVE.
+ * @param mask Extra inotify flags of the watch.
+ * @param report Whether the entries found by the scan are reported as
+ *               created, for directories that appeared after the watch.
+ * @return True on success, false if the path or a directory below it
+ *         cannot be watched.
+ */
+static bool
+fs_watch_tree(fs_watch_t *watch, array_t *path, uint_t flags, uint_t mask,
+              bool report)
+{
+    sint_t descriptor = inotify_add_watch(watch->backend.source.handle,
+                                          path->data, FS_WATCH_MASK | mask);
+    if (descriptor < 0)
+    {
+        return false;
+    }
+
+    // A directory watched twice has one descriptor, with the flags of both.
+    uint_t                inserted = 0;
+    fs_watch_directory_t *directory = map_emplace(&watch->backend.paths,
+                                                  &descriptor, &inserted);
+    if (!directory)
+    {
+        inotify_rm_watch(watch->backend.source.handle, descriptor);
+        errno = ENOMEM;
+        return false;
+    }
+    if (inserted)
+    {
+        directory->size = path->size - 1;
+        directory->path = alloc_new(nullptr, path->size);
+        if (!directory->path)
+        {
+            map_erase(&watch->backend.paths, &descriptor);
+            inotify_rm_watch(watch->backend.source.handle, descriptor);
+            errno = ENOMEM;
+            return false;
+        }
+        memcpy(directory->path, path->data, path->size);
+        directory->flags = 0;
+    }
+    directory->flags |= flags;
+    directory->seen = true;
+    if (!(flags & FS_WATCH_RECURSIVE))
+    {
+        return true;
+    }
+
+    DIR *stream = opendir(path->data);
+    if (!stream)
+    {
+        // The path of a file is watched on its own.
+        return errno == ENOTDIR;
+    }
+
+    // The names are appended in place of the zero and removed again, after
+    // a separator unless the path is the root.
+    bool           ok = true;
+    usize_t        size = path->size - 1;
+    char_t         separator = '/';
+    bool           root = ((const char_t *)path->data)[size - 1] == '/';
+    struct dirent *entry;
+    while (ok && (entry = readdir(stream)))
+    {
+        const char_t *name = entry->d_name;
+        if (name[0] == '.' && (!name[1] || (name[1] == '.' && !name[2])))
+        {
+            continue;
+        }
+        usize_t length = strlen(name);
+        array_erase(path, size, path->size - size);
+        if ((!root && !array_push(path, &separator))
+            || !array_insert(path, path->size, name, length + 1))
+        {
+            errno = ENOMEM;
+            ok = false;
+            break;
+        }
+        if (report)
+        {
+            fs_watch_report(watch, path->data, path->size - 1,
+                            FS_WATCH_CREATED);
+        }
+
+        // Links to directories are not followed, they could form a cycle.
+        bool is_directory = entry->d_type == DT_DIR;
+        if (entry->d_type == DT_UNKNOWN)
+        {
+            struct stat status;
+            is_directory = !lstat(path->data, &status)
+                           && S_ISDIR(status.st_mode);
+        }
+
+        // A directory that is gone or unreadable by now is skipped.
+        if (is_directory
+            && !fs_watch_tree(watch, path, FS_WATCH_RECURSIVE,
+                              IN_ONLYDIR | IN_DONT_FOLLOW, report))
+        {
+            ok = errno == ENOENT || errno == ENOTDIR || errno == EACCES;
+        }
+    }
+    sint_t error = errno;
+    closedir(stream);
+    array_erase(path, size, path->size - size);
+    array_push(path, &(char_t){0});
+    errno = error;
+    return ok;
+}
+
+/**
+ * @brief Watches the roots again after an overflow, which may have lost
+ *        the creation of directories that need a watch and the removal of
+ *        watched ones.
+ *
+ * The directories that the scan does not reach are gone or were replaced,
+ * their watches are dropped. A scan that fails keeps them and forces
+ * another scan by the caller.
+ *
+ * @param watch The watcher.
+ */
+static void
+fs_watch_rescan(fs_watch_t *watch)
+{
+    usize_t iter = 0;
+    sint_t *descriptor;
+    while ((descriptor = map_next(&watch->backend.paths, &iter)))
+    {
+        fs_watch_directory_t *directory = MAP_VALUE(&watch->backend.paths,
+                                                    descriptor);
+        directory->seen = false;
+    }
+
+    bool    ok = true;
+    array_t tree;
+    ARRAY_INIT(&tree, char_t, nullptr);
+    for (usize_t i = 0; ok && i < watch->backend.roots.size; ++i)
+    {
+        const fs_watch_root_t *root = &ARRAY_AT(&watch->backend.roots,
+                                                fs_watch_root_t, i);
+        array_clear(&tree);
+        ok = array_insert(&tree, 0, root->path, root->size + 1)
+             && (fs_watch_tree(watch, &tree, root->flags, 0, false)
+                 || errno == ENOENT || errno == ENOTDIR || errno == EACCES);
+    }
+    array_free(&tree);
+    if (!ok)
+    {
+        fs_watch_report(watch, "", 0, FS_WATCH_OVERFLOW);
+        return;
+    }
+
+    iter = 0;
+    while ((descriptor = map_next(&watch->backend.paths, &iter)))
+    {
+        const fs_watch_directory_t *directory =
+            MAP_VALUE(&watch->backend.paths, descriptor);
+        if (!directory->seen)
+        {
+            fs_watch_forget(watch, *descriptor);
+        }
+    }
+}
+
+/**
+ * @brief Reads the events of the inotify instance and reports them.
+ *
+ * @param loop The loop.
+ * @param source The source of the instance.
+ * @param event The events.
+ */
+static void
+fs_watch_read(event_loop_t *loop, event_source_t *source,
+              const event_t *event)
+{
+    fs_watch_t *watch = source->data;
+    (void)loop;
+    (void)event;
+
+    union
+    {
+        struct inotify_event event;
+        char_t               bytes[FS_WATCH_BUFFER_SIZE];
+    } buffer;
+    char_t  path[PATH_MAX + NAME_MAX + 2];
+    array_t tree;
+    ARRAY_INIT(&tree, char_t, nullptr);
+    bool overflow = false;
+
+    ssize_t count;
+    while ((count = read(source->handle, &buffer, sizeof(buffer))) > 0)
+    {
+        const char_t *end = buffer.bytes + count;
+        for (const char_t *at = buffer.bytes; at < end;)
+        {
+            const struct inotify_event *change = (const void *)at;
+            at += sizeof(struct inotify_event) + change->len;
+            if (change->mask & IN_Q_OVERFLOW)
+            {
+                fs_watch_report(watch, "", 0, FS_WATCH_OVERFLOW);
+                overflow = true;
+                continue;
+            }
+
+            const fs_watch_directory_t *directory =
+                map_find(&watch->backend.paths, &change->wd);
+            if (!directory)
+            {
+                continue;
+            }
+            if (change->mask & IN_IGNORED)
+            {
+                alloc_delete(nullptr, directory->path, directory->size + 1);
+                map_erase(&watch->backend.paths, &change->wd);
+                continue;
+            }
+
+            // The directory is copied, adding a watch may move it.
+            usize_t size = directory->size;
+            uint_t  flags = directory->flags;
+            memcpy(path, directory->path, size);
+            if (change->len && change->name[0])
+            {
+                usize_t length = strlen(change->name);
+                if (path[size - 1] != '/')
+                {
+                    path[size++] = '/';
+                }
+                memcpy(path + size, change->name, length);
+                size += length;
+            }
+            path[size] = 0;
+
+            uint_t events = 0;
+            if (change->mask & (IN_CREATE | IN_MOVED_TO))
+            {
+                events |= FS_WATCH_CREATED;
+            }
+            if (change->mask
+                & (IN_DELETE | IN_MOVED_FROM | IN_DELETE_SELF | IN_MOVE_SELF))
+            {
+                events |= FS_WATCH_DELETED;
+            }
+            if (change->mask & (IN_MODIFY | IN_ATTRIB))
+            {
+                events |= FS_WATCH_MODIFIED;
+            }
+            fs_watch_report(watch, path, size, events);
+
+            // A directory that moves keeps its descriptors under the old
+            // paths, they are dropped and watched again where it arrives.
+            if (change->mask & IN_MOVE_SELF)
+            {
+                fs_watch_forget_tree(watch, path, size);
+            }
+            else if (change->mask & IN_ISDIR && flags & FS_WATCH_RECURSIVE)
+            {
+                if (change->mask & IN_MOVED_FROM)
+                {
+                    fs_watch_forget_tree(watch, path, size);
+                }
+                else if (change->mask & (IN_CREATE | IN_MOVED_TO))
+                {
+                    // Entries made before the watch existed are reported by
+                    // the scan, a directory that cannot be watched forces a
+                    // scan by the caller.
+                    array_clear(&tree);
+                    if (!array_insert(&tree, 0, path, size + 1)
+                        || (!fs_watch_tree(watch, &tree, FS_WATCH_RECURSIVE,
+                                           IN_ONLYDIR | IN_DONT_FOLLOW, true)
+                            && errno != ENOENT && errno != ENOTDIR))
+                    {
+                        fs_watch_report(watch, "", 0, FS_WATCH_OVERFLOW);
+                    }
+                }
+            }
+        }
+    }
+    array_free(&tree);
+
+    // The caller scans for the lost changes, the watches are repaired here.
+    if (overflow)
+    {
+        fs_watch_rescan(watch);
+    }
+}
+
+bool
+fs_watch_backend_init(fs_watch_t *watch)
+{
+    sint_t handle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (handle < 0)
+    {
+        return false;
+    }
+
+    watch->backend.source.callback = fs_watch_read;
+    watch->backend.source.data = watch;
+    watch->backend.source.handle = handle;
+    watch->backend.source.interest = EVENT_READ;
+    MAP_INIT(&watch->backend.paths, sint_t, fs_watch_directory_t, nullptr);
+    ARRAY_INIT(&watch->backend.roots, fs_watch_root_t, nullptr);
+    if (!event_loop_add(watch->loop, &watch->backend.source))
+    {
+        sint_t error = errno;
+        close(handle);
+        map_free(&watch->backend.paths);
+        array_free(&watch->backend.roots);
+        errno = error;
+        return false;
+    }
+    return true;
+}
+
+bool
+fs_watch_backend_add(fs_watch_t *watch, const char_t *path, usize_t size,
+                     uint_t flags)
+{
+    array_t tree;
+    ARRAY_INIT(&tree, char_t, nullptr);
+    bool ok = array_insert(&tree, 0, path, size)
+              && array_push(&tree, &(char_t){0});
+    if (!ok)
+    {
+        errno = ENOMEM;
+    }
+    ok = ok && fs_watch_tree(watch, &tree, flags, 0, false);
+    sint_t error = errno;
+    array_free(&tree);
+    if (!ok)
+    {
+        errno = error;
+        return false;
+    }
+
+    fs_watch_root_t root = {alloc_new(nullptr, size + 1), size, flags};
+    if (!root.path)
+    {
+        errno = ENOMEM;
+        return false;
+    }
+    memcpy(root.path, path, size);
+    root.path[size] = 0;
+    if (!array_push(&watch->backend.roots, &root))
+    {
+        alloc_delete(nullptr, root.path, size + 1);
+        errno = ENOMEM;
+        return false;
+    }
+    return true;
+}
+
+void
+fs_watch_backend_free(fs_watch_t *watch)
+{
+    event_loop_remove(watch->loop, &watch->backend.source);
+    close(watch->backend.source.handle);
+
+    usize_t iter = 0;
+    sint_t *descriptor;
+    while ((descriptor = map_next(&watch->backend.paths, &iter)))
+    {
+        fs_watch_directory_t *directory = MAP_VALUE(&watch->backend.paths,
+                                                    descriptor);
+        alloc_delete(nullptr, directory->path, directory->size + 1);
+    }
+    map_free(&watch->backend.paths);
+
+    for (usize_t i = 0; i < watch->backend.roots.size; ++i)
+    {
+        fs_watch_root_t *root = &ARRAY_AT(&watch->backend.roots,
+                                          fs_watch_root_t, i);
+        alloc_delete(nullptr, root->path, root->size + 1);
+    }
+    array_free(&watch->backend.roots);
+}
@@ -1 +1,122 @@
-#include <liquid/fs-posix.h>
\ No newline at end of file
+#include <errno.h>
+#include <fcntl.h>
+#include <liquid/exception.h>
+#include <liquid/fs.h>
+#include <liquid/metric.h>
+#include <liquid/trace.h>
+#include <unistd.h>
+
+/**
+ * @def FS_IO_MAX
+ * @brief The largest size passed to a single read or write call, below
+ *        SSIZE_MAX on every target.
+ */
+#define FS_IO_MAX 0x40000000
+
+bool
+fs_open(fs_handle_t *handle, const char_t *path, uint_t flags)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(handle && path, false,
+                                  "invalid handle or path pointer")
+    LIQUID_EXCEPTION_RAISE_IF_NOT(flags & (FS_READ | FS_WRITE), false,
+                                  "neither FS_READ nor FS_WRITE given")
+
+    sint_t mode = O_RDONLY;
+    if (flags & FS_WRITE)
+    {
+        mode = flags & FS_READ ? O_RDWR : O_WRONLY;
+    }
+    if (flags & FS_CREATE)
+    {
+        mode |= O_CREAT;
+    }
+    if (flags & FS_TRUNCATE)
+    {
+        mode |= O_TRUNC;
+    }
+    if (flags & FS_APPEND)
+    {
+        mode |= O_APPEND;
+    }
+
+    sint_t fd;
+    do
+    {
+        fd = open(path, mode | O_CLOEXEC, 0666);
+    } while (fd < 0 && errno == EINTR);
+
+    *handle = fd;
+    return fd >= 0;
+}
+
+void
+fs_close(fs_handle_t handle)
+{
+    if (handle != FS_INVALID_HANDLE)
+    {
+        close(handle);
+    }
+}
+
+bool
+fs_read(fs_handle_t handle, void *buffer, usize_t size, usize_t *read_size)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(buffer && read_size, false,
+                                  "invalid buffer or size pointer")
+
+    ssize_t count = -1;
+    TRACE_SCOPE("liquid.fs.read")
+    {
+        LIQUID_METRIC_SCOPE(metric_fs_read_ns)
+        {
+            do
+            {
+                count = read(handle, buffer,
+                             size < FS_IO_MAX ? size : FS_IO_MAX);
+            } while (count < 0 && errno == EINTR);
+        }
+    }
+
+    *read_size = count > 0 ? (usize_t)count : 0;
+    LIQUID_METRIC_COUNT(metric_fs_reads, 1);
+    LIQUID_METRIC_COUNT(metric_fs_read_bytes, *read_size);
+    return count >= 0;
+}
+
+bool
+fs_write(fs_handle_t handle, const void *buffer, usize_t size)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(buffer || !size, false,
+                                  "invalid buffer pointer")
+
+    const uchar_t *src = buffer;
+    bool           ok = true;
+    LIQUID_METRIC_COUNT(metric_fs_writes, 1);
+    TRACE_SCOPE("liquid.fs.write")
+    {
+        LIQUID_METRIC_SCOPE(metric_fs_write_ns)
+        {
+            while (ok && size)
+            {
+                ssize_t count =
+                    write(handle, src, size < FS_IO_MAX ? size : FS_IO_MAX);
+                if (count < 0)
+                {
+                    ok = errno == EINTR;
+                    continue;
+                }
+                if (!count)
+                {
+                    // A write that makes no progress would never end.
+                    set_last_error_code(EIO);
+                    ok = false;
+                    continue;
+                }
+                src += count;
+                size -= (usize_t)count;
+                LIQUID_METRIC_COUNT(metric_fs_write_bytes, (usize_t)count);
+            }
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file fs-watch-backend.h
+ * @brief The functions of the system backend of the watchers.
+ *
+ * fs-watch.c merges and delivers the changes that these functions report.
+ * They are implemented in fs-linux.c, fs-darwin.c and fs-windows.c.
+ */
+
+#ifndef LIQUID_FS_WATCH_BACKEND_H
+#define LIQUID_FS_WATCH_BACKEND_H
+
+#include <liquid/fs-watch.h>
+
+/**
+ * @brief Creates the system objects of a watcher and adds them to its
+ *        loop.
+ * @param watch The watcher.
+ * @return True on success, false on failure.
+ */
+bool
+fs_watch_backend_init(fs_watch_t *watch);
+
+/**
+ * @brief Starts watching a path.
+ *
+ * @param watch The watcher.
+ * @param path The path, without a trailing separator unless it is a
+ *             root.
+ * @param size The length of the path.
+ * @param flags Zero or FS_WATCH_RECURSIVE.
+ * @return True on success, false if the path cannot be watched.
+ */
+bool
+fs_watch_backend_add(fs_watch_t *watch, const char_t *path, usize_t size,
+                     uint_t flags);
+
+/**
+ * @brief Removes the system objects of a watcher from its loop and
+ *        releases them.
+ * @param watch The watcher.
+ */
+void
+fs_watch_backend_free(fs_watch_t *watch);
+
+/**
+ * @brief Merges a change into the pending batch of a watcher and arms the
+ *        timer that delivers it.
+ *
+ * @param watch The watcher.
+ * @param path The changed path.
+ * @param size The length of the path.
+ * @param events The FS_WATCH_ flags of the change.
+ */
+void
+fs_watch_report(fs_watch_t *watch, const char_t *path, usize_t size,
+                uint_t events);
+
+#endif // LIQUID_FS_WATCH_BACKEND_H
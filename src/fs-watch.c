@@ -0,0 +1,191 @@
+#include "fs-watch-backend.h"
+#include <liquid/exception.h>
+#include <liquid/hash.h>
+#include <string.h>
+
+/**
+ * @def FS_WATCH_LATENCY
+ * @brief The longest delay of a batch after its first change, in units of
+ *        the debounce time, so that a steady stream of changes is still
+ *        delivered.
+ */
+#define FS_WATCH_LATENCY 4
+
+/**
+ * @brief The empty path of an overflow, and the zero after every path.
+ */
+static const char_t m_overflow[1] = {0};
+
+/**
+ * @struct fs_watch_pending
+ * @brief A pending change, its path in the names of the watcher.
+ */
+typedef struct fs_watch_pending
+{
+    usize_t offset; ///< The offset of the path in the names.
+    usize_t size;   ///< The length of the path.
+    uint_t  events; ///< The FS_WATCH_ flags of the changes.
+} fs_watch_pending_t;
+
+/**
+ * @brief Delivers the pending batch of a watcher.
+ * @param loop The loop.
+ * @param timer The timer of the watcher.
+ */
+static void
+fs_watch_flush(event_loop_t *loop, event_timer_t *timer)
+{
+    fs_watch_t *watch = timer->data;
+    (void)loop;
+
+    // The names do not move any more, the paths can point into them.
+    const char_t *names = watch->names.data;
+    array_clear(&watch->batch);
+    if (array_reserve(&watch->batch, watch->pending.size))
+    {
+        for (usize_t i = 0; i < watch->pending.size; ++i)
+        {
+            const fs_watch_pending_t *pending =
+                &ARRAY_AT(&watch->pending, fs_watch_pending_t, i);
+            fs_watch_change_t change = {names + pending->offset,
+                                        pending->size, pending->events};
+            array_push(&watch->batch, &change);
+        }
+    }
+    else
+    {
+        // Without the memory for the batch, the caller has to rescan.
+        fs_watch_change_t overflow = {m_overflow, 0, FS_WATCH_OVERFLOW};
+        array_push(&watch->batch, &overflow);
+    }
+
+    array_clear(&watch->pending);
+    map_clear(&watch->index);
+    watch->callback(watch, watch->batch.data, watch->batch.size);
+    array_clear(&watch->names);
+}
+
+bool
+fs_watch_init(fs_watch_t *watch, event_loop_t *loop,
+              fs_watch_callback_t callback, ullong_t debounce)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(watch && loop && callback, false,
+                                  "invalid watch, loop or callback pointer")
+
+    watch->loop = loop;
+    watch->callback = callback;
+    watch->data = nullptr;
+    watch->debounce = debounce;
+    watch->first = 0;
+    event_timer_init(&watch->timer, fs_watch_flush, watch);
+    ARRAY_INIT(&watch->pending, fs_watch_pending_t, nullptr);
+    ARRAY_INIT(&watch->names, char_t, nullptr);
+    ARRAY_INIT(&watch->batch, fs_watch_change_t, nullptr);
+    MAP_INIT(&watch->index, ullong_t, usize_t, nullptr);
+    if (!fs_watch_backend_init(watch))
+    {
+        array_free(&watch->pending);
+        array_free(&watch->names);
+        array_free(&watch->batch);
+        map_free(&watch->index);
+        return false;
+    }
+    return true;
+}
+
+bool
+fs_watch_add(fs_watch_t *watch, const char_t *path, uint_t flags)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(watch && path && *path, false,
+                                  "invalid watch or path pointer")
+
+    // Changed paths are joined to the watched one with a separator, which
+    // a root such as / or C:\ already ends with.
+    usize_t size = 0;
+    while (path[size])
+    {
+        ++size;
+    }
+    while (size > 1 && (path[size - 1] == '/' || path[size - 1] == '\\'))
+    {
+#if defined(LIQUID_TARGET_OS_WINDOWS)
+        if (size == 3 && path[1] == ':')
+        {
+            break;
+        }
+#endif
+        --size;
+    }
+    return fs_watch_backend_add(watch, path, size, flags);
+}
+
+void
+fs_watch_free(fs_watch_t *watch)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(watch, , "invalid watch pointer")
+
+    fs_watch_backend_free(watch);
+    event_timer_stop(watch->loop, &watch->timer);
+    array_free(&watch->pending);
+    array_free(&watch->names);
+    array_free(&watch->batch);
+    map_free(&watch->index);
+}
+
+void
+fs_watch_report(fs_watch_t *watch, const char_t *path, usize_t size,
+                uint_t events)
+{
+    // A path that changed already in the batch gets the new flags, unless
+    // its hash collides with another path, which then has two entries.
+    ullong_t hash = hash64(path, path + size, 0);
+    uint_t   inserted = 0;
+    usize_t *index = map_emplace(&watch->index, &hash, &inserted);
+    if (index && !inserted)
+    {
+        fs_watch_pending_t *pending =
+            &ARRAY_AT(&watch->pending, fs_watch_pending_t, *index);
+        const char_t *name = (const char_t *)watch->names.data
+                             + pending->offset;
+        if (pending->size == size
+            && !memcmp(name, path, size * sizeof(char_t)))
+        {
+            pending->events |= events;
+            return;
+        }
+    }
+
+    fs_watch_pending_t pending = {watch->names.size, size, events};
+    if (!array_insert(&watch->names, watch->names.size, path, size)
+        || !array_push(&watch->names, m_overflow)
+        || !array_push(&watch->pending, &pending))
+    {
+        // A change that cannot be kept is lost like one of the system.
+        if (index && inserted)
+        {
+            map_erase(&watch->index, &hash);
+        }
+        if (!(events & FS_WATCH_OVERFLOW))
+        {
+            fs_watch_report(watch, m_overflow, 0, FS_WATCH_OVERFLOW);
+        }
+        return;
+    }
+    if (index && inserted)
+    {
+        *index = watch->pending.size - 1;
+    }
+
+    // The timer restarts with every change, up to the latency of the
+    // first one.
+    ullong_t now = watch->loop->now;
+    if (watch->pending.size == 1)
+    {
+        watch->first = now;
+    }
+    ullong_t deadline = watch->first + watch->debounce * FS_WATCH_LATENCY;
+    ullong_t timeout = now + watch->debounce < deadline
+                           ? watch->debounce
+                           : (deadline > now ? deadline - now : 0);
+    event_timer_start(watch->loop, &watch->timer, timeout);
+}
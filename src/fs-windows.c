@@ -1 +1,464 @@
-#include <liquid/fs-windows.h>
\ No newline at end of file
+#include "fs-watch-backend.h"
+#include <liquid/alloc.h>
+#include <liquid/exception.h>
+#include <liquid/fs.h>
+#include <liquid/metric.h>
+#include <liquid/trace.h>
+#include <windows.h>
+
+/**
+ * @def FS_IO_MAX
+ * @brief The largest size passed to a single ReadFile or WriteFile call,
+ *        which take 32-bit sizes.
+ */
+#define FS_IO_MAX 0x40000000
+
+/**
+ * @def FS_WATCH_BUFFER_SIZE
+ * @brief The size of the buffer of a directory read, the most that is
+ *        allowed for directories on network shares.
+ */
+#define FS_WATCH_BUFFER_SIZE (64 * 1024)
+
+/**
+ * @def FS_WATCH_FILTER
+ * @brief The changes that complete a directory read.
+ */
+#define FS_WATCH_FILTER                                                        \
+    (FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME                \
+     | FILE_NOTIFY_CHANGE_ATTRIBUTES | FILE_NOTIFY_CHANGE_SIZE                 \
+     | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_CREATION             \
+     | FILE_NOTIFY_CHANGE_SECURITY)
+
+/**
+ * @struct fs_watch_directory
+ * @brief A watched directory with its read. It outlives the watcher until
+ *        its cancelled read completes.
+ */
+typedef struct fs_watch_directory
+{
+    event_source_t source;     ///< The directory on the port of the loop.
+    OVERLAPPED     overlapped; ///< The read.
+    fs_watch_t    *watch;      ///< The watcher, nullptr once it is freed.
+    bool           pending;    ///< Whether the read is in progress.
+    uint_t         flags;      ///< FS_WATCH_RECURSIVE if the tree is watched.
+    usize_t        size;       ///< The length of the path.
+    char_t        *path;       ///< The path as given, the prefix of changes.
+    usize_t        length;     ///< The length of the name of a file.
+    WCHAR         *name;       ///< The watched file, nullptr for directories.
+    DWORD          buffer[FS_WATCH_BUFFER_SIZE / sizeof(DWORD)]; ///< Changes.
+} fs_watch_directory_t;
+
+bool
+fs_open(fs_handle_t *handle, const char_t *path, uint_t flags)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(handle && path, false,
+                                  "invalid handle or path pointer")
+    LIQUID_EXCEPTION_RAISE_IF_NOT(flags & (FS_READ | FS_WRITE), false,
+                                  "neither FS_READ nor FS_WRITE given")
+
+    DWORD access = flags & FS_READ ? GENERIC_READ : 0;
+    if (flags & FS_WRITE)
+    {
+        // Appending writes go to the end of the file atomically.
+        access |= flags & FS_APPEND ? FILE_APPEND_DATA : GENERIC_WRITE;
+    }
+
+    DWORD disposition = OPEN_EXISTING;
+    if (flags & FS_CREATE)
+    {
+        disposition = flags & FS_TRUNCATE ? CREATE_ALWAYS : OPEN_ALWAYS;
+    }
+    else if (flags & FS_TRUNCATE)
+    {
+        disposition = TRUNCATE_EXISTING;
+    }
+
+    *handle = CreateFile(path, access,
+                         FILE_SHARE_READ | FILE_SHARE_WRITE
+                             | FILE_SHARE_DELETE,
+                         nullptr, disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+    return *handle != INVALID_HANDLE_VALUE;
+}
+
+void
+fs_close(fs_handle_t handle)
+{
+    if (handle != FS_INVALID_HANDLE)
+    {
+        CloseHandle(handle);
+    }
+}
+
+bool
+fs_read(fs_handle_t handle, void *buffer, usize_t size, usize_t *read_size)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(buffer && read_size, false,
+                                  "invalid buffer or size pointer")
+
+    DWORD count = 0;
+    BOOL  ok;
+    TRACE_SCOPE("liquid.fs.read")
+    {
+        LIQUID_METRIC_SCOPE(metric_fs_read_ns)
+        {
+            ok = ReadFile(handle, buffer,
+                          (DWORD)(size < FS_IO_MAX ? size : FS_IO_MAX), &count,
+                          nullptr);
+        }
+    }
+    *read_size = count;
+    LIQUID_METRIC_COUNT(metric_fs_reads, 1);
+    LIQUID_METRIC_COUNT(metric_fs_read_bytes, count);
+    return ok != FALSE;
+}
+
+bool
+fs_write(fs_handle_t handle, const void *buffer, usize_t size)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(buffer || !size, false,
+                                  "invalid buffer pointer")
+
+    const uchar_t *src = buffer;
+    bool           ok = true;
+    LIQUID_METRIC_COUNT(metric_fs_writes, 1);
+    TRACE_SCOPE("liquid.fs.write")
+    {
+        LIQUID_METRIC_SCOPE(metric_fs_write_ns)
+        {
+            while (ok && size)
+            {
+                DWORD count;
+                ok = WriteFile(handle, src,
+                               (DWORD)(size < FS_IO_MAX ? size : FS_IO_MAX),
+                               &count, nullptr)
+                     != FALSE;
+                if (ok && !count)
+                {
+                    // A write that makes no progress would never end.
+                    set_last_error_code(ERROR_WRITE_FAULT);
+                    ok = false;
+                }
+                if (ok)
+                {
+                    src += count;
+                    size -= count;
+                    LIQUID_METRIC_COUNT(metric_fs_write_bytes, count);
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Closes and releases a watched directory.
+ * @param directory The directory.
+ */
+static void
+fs_watch_directory_free(fs_watch_directory_t *directory)
+{
+    fs_close(directory->source.handle);
+    alloc_delete(nullptr, directory->path,
+                 (directory->size + 1) * sizeof(char_t));
+    alloc_delete(nullptr, directory->name,
+                 (directory->length + 1) * sizeof(WCHAR));
+    alloc_delete(nullptr, directory, sizeof(fs_watch_directory_t));
+}
+
+/**
+ * @brief Starts the next read of a watched directory.
+ * @param directory The directory.
+ * @return True if the read is in progress.
+ */
+static bool
+fs_watch_directory_read(fs_watch_directory_t *directory)
+{
+    ZeroMemory(&directory->overlapped, sizeof(OVERLAPPED));
+    directory->pending =
+        ReadDirectoryChangesW(directory->source.handle, directory->buffer,
+                              sizeof(directory->buffer),
+                              directory->flags & FS_WATCH_RECURSIVE,
+                              FS_WATCH_FILTER, nullptr,
+                              &directory->overlapped, nullptr)
+        != FALSE;
+    return directory->pending;
+}
+
+/**
+ * @brief Reports a change that a directory read returned.
+ *
+ * @param directory The directory.
+ * @param change The change.
+ * @param path The path of the change, reused between changes.
+ * @return False if the memory for the path is missing.
+ */
+static bool
+fs_watch_directory_report(fs_watch_directory_t          *directory,
+                          const FILE_NOTIFY_INFORMATION *change,
+                          array_t                       *path)
+{
+    const WCHAR *name = change->FileName;
+    sint_t       length = (sint_t)(change->FileNameLength / sizeof(WCHAR));
+    if (directory->name
+        && CompareStringOrdinal(name, length, directory->name,
+                                (sint_t)directory->length, TRUE)
+               != CSTR_EQUAL)
+    {
+        return true;
+    }
+
+    uint_t events = 0;
+    switch (change->Action)
+    {
+    case FILE_ACTION_ADDED:
+    case FILE_ACTION_RENAMED_NEW_NAME:
+        events = FS_WATCH_CREATED;
+        break;
+    case FILE_ACTION_REMOVED:
+    case FILE_ACTION_RENAMED_OLD_NAME:
+        events = FS_WATCH_DELETED;
+        break;
+    default:
+        events = FS_WATCH_MODIFIED;
+        break;
+    }
+
+    // A watched file is reported with its own path, the entries of a
+    // directory below it.
+    array_clear(path);
+    if (!array_insert(path, 0, directory->path, directory->size))
+    {
+        return false;
+    }
+    if (!directory->name)
+    {
+        // A root such as C:\ ends with the separator of its entries.
+        char_t separator = '\\';
+        char_t last = directory->path[directory->size - 1];
+        bool   root = last == '\\' || last == '/';
+#if defined(UNICODE)
+        if ((!root && !array_push(path, &separator))
+            || !array_insert(path, path->size, name, (usize_t)length))
+        {
+            return false;
+        }
+#else
+        sint_t size = WideCharToMultiByte(CP_ACP, 0, name, length, nullptr, 0,
+                                          nullptr, nullptr);
+        usize_t at = path->size + !root;
+        if ((!root && !array_push(path, &separator))
+            || !array_reserve(path, at + (usize_t)size))
+        {
+            return false;
+        }
+        WideCharToMultiByte(CP_ACP, 0, name, length, (char_t *)path->data + at,
+                            size, nullptr, nullptr);
+        path->size = at + (usize_t)size;
+#endif
+    }
+    if (!array_push(path, &(char_t){0}))
+    {
+        return false;
+    }
+    fs_watch_report(directory->watch, path->data, path->size - 1, events);
+    return true;
+}
+
+/**
+ * @brief Reports the changes of a completed directory read and starts the
+ *        next one.
+ *
+ * @param loop The loop.
+ * @param source The source of the directory.
+ * @param event The completion.
+ */
+static void
+fs_watch_directory_complete(event_loop_t *loop, event_source_t *source,
+                            const event_t *event)
+{
+    fs_watch_directory_t *directory = source->data;
+    fs_watch_t           *watch = directory->watch;
+    (void)loop;
+    (void)event;
+
+    directory->pending = false;
+    if (!watch)
+    {
+        fs_watch_directory_free(directory);
+        return;
+    }
+
+    // A read that finds the buffer too small returns nothing, the changes
+    // are lost.
+    DWORD size = 0;
+    if (!GetOverlappedResult(source->handle, &directory->overlapped, &size,
+                             FALSE))
+    {
+        if (GetLastError() != ERROR_NOTIFY_ENUM_DIR)
+        {
+            // The directory is gone, or can no longer be read.
+            fs_watch_report(watch, directory->path, directory->size,
+                            FS_WATCH_DELETED);
+            return;
+        }
+        size = 0;
+    }
+
+    array_t path;
+    ARRAY_INIT(&path, char_t, nullptr);
+    bool           ok = size != 0;
+    const uchar_t *at = (const uchar_t *)directory->buffer;
+    while (ok)
+    {
+        const FILE_NOTIFY_INFORMATION *change = (const void *)at;
+        ok = fs_watch_directory_report(directory, change, &path);
+        if (!change->NextEntryOffset)
+        {
+            break;
+        }
+        at += change->NextEntryOffset;
+    }
+    array_free(&path);
+    if (!ok)
+    {
+        fs_watch_report(watch, directory->path, 0, FS_WATCH_OVERFLOW);
+    }
+
+    if (!fs_watch_directory_read(directory))
+    {
+        fs_watch_report(watch, directory->path, directory->size,
+                        FS_WATCH_DELETED);
+    }
+}
+
+bool
+fs_watch_backend_init(fs_watch_t *watch)
+{
+    ARRAY_INIT(&watch->backend.directories, fs_watch_directory_t *, nullptr);
+    return true;
+}
+
+bool
+fs_watch_backend_add(fs_watch_t *watch, const char_t *path, usize_t size,
+                     uint_t flags)
+{
+    fs_watch_directory_t *directory = alloc_new(nullptr,
+                                                sizeof(fs_watch_directory_t));
+    if (!directory)
+    {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return false;
+    }
+    ZeroMemory(directory, sizeof(fs_watch_directory_t));
+    directory->source.callback = fs_watch_directory_complete;
+    directory->source.data = directory;
+    directory->source.handle = FS_INVALID_HANDLE;
+    directory->watch = watch;
+    directory->flags = flags;
+    directory->size = size;
+    directory->path = alloc_new(nullptr, (size + 1) * sizeof(char_t));
+    if (!directory->path)
+    {
+        fs_watch_directory_free(directory);
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return false;
+    }
+    CopyMemory(directory->path, path, size * sizeof(char_t));
+    directory->path[size] = 0;
+
+    DWORD attributes = GetFileAttributes(directory->path);
+    if (attributes == INVALID_FILE_ATTRIBUTES)
+    {
+        fs_watch_directory_free(directory);
+        return false;
+    }
+
+    // A file is watched through its directory, whose path is cut short for
+    // the call and restored after it.
+    usize_t split = size;
+    char_t  cut = 0;
+    if (!(attributes & FILE_ATTRIBUTE_DIRECTORY))
+    {
+        while (split && directory->path[split - 1] != '\\'
+               && directory->path[split - 1] != '/')
+        {
+            --split;
+        }
+        const char_t *file = directory->path + split;
+#if defined(UNICODE)
+        sint_t length = (sint_t)(size - split);
+#else
+        sint_t length = MultiByteToWideChar(CP_ACP, 0, file,
+                                            (sint_t)(size - split), nullptr, 0);
+#endif
+        directory->name = alloc_new(nullptr, (usize_t)(length + 1)
+                                                 * sizeof(WCHAR));
+        if (!directory->name)
+        {
+            fs_watch_directory_free(directory);
+            SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+            return false;
+        }
+        directory->length = (usize_t)length;
+#if defined(UNICODE)
+        CopyMemory(directory->name, file, (usize_t)length * sizeof(WCHAR));
+#else
+        MultiByteToWideChar(CP_ACP, 0, file, (sint_t)(size - split),
+                            directory->name, length);
+#endif
+        directory->name[length] = 0;
+        cut = directory->path[split];
+        directory->path[split] = 0;
+    }
+
+    directory->source.handle = CreateFile(
+        split ? directory->path : TEXT("."), FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+        OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+        nullptr);
+    directory->path[split] = cut;
+    if (directory->source.handle == INVALID_HANDLE_VALUE)
+    {
+        fs_watch_directory_free(directory);
+        return false;
+    }
+    if (!array_push(&watch->backend.directories, &directory))
+    {
+        fs_watch_directory_free(directory);
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return false;
+    }
+    if (!event_loop_add(watch->loop, &directory->source)
+        || !fs_watch_directory_read(directory))
+    {
+        DWORD error = GetLastError();
+        array_pop(&watch->backend.directories);
+        fs_watch_directory_free(directory);
+        SetLastError(error);
+        return false;
+    }
+    return true;
+}
+
+void
+fs_watch_backend_free(fs_watch_t *watch)
+{
+    // The reads are cancelled, the directories are released when their
+    // completions arrive on the port.
+    for (usize_t i = 0; i < watch->backend.directories.size; ++i)
+    {
+        fs_watch_directory_t *directory = ARRAY_AT(
+            &watch->backend.directories, fs_watch_directory_t *, i);
+        directory->watch = nullptr;
+        if (directory->pending)
+        {
+            CancelIoEx(directory->source.handle, &directory->overlapped);
+        }
+        else
+        {
+            fs_watch_directory_free(directory);
+        }
+    }
+    array_free(&watch->backend.directories);
+}
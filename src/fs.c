@@ -1 +1,399 @@
-#include <liquid/fs.h>
\ No newline at end of file
+#include <liquid/exception.h>
+#include <liquid/fs.h>
+#include <string.h>
+
+/**
+ * @def FS_STREAM_HISTORY
+ * @brief The decoded bytes kept before each block read from a frame with
+ *        linked blocks, as far as back references reach.
+ */
+#define FS_STREAM_HISTORY (LZ4_DISTANCE_MAX + 1)
+
+/**
+ * @brief Releases the buffers and the file of a stream.
+ * @param stream The stream.
+ */
+static void
+fs_stream_release(fs_stream_t *stream)
+{
+    alloc_delete(stream->allocator, stream->buffer, stream->buffer_size);
+    alloc_delete(stream->allocator, stream->packed, stream->packed_size);
+    if (stream->lz4.head)
+    {
+        lz4_free(&stream->lz4);
+    }
+    fs_close(stream->handle);
+
+    stream->buffer = nullptr;
+    stream->packed = nullptr;
+    stream->buffer_size = 0;
+    stream->packed_size = 0;
+    stream->handle = FS_INVALID_HANDLE;
+}
+
+/**
+ * @brief Grows the buffers of a compressed stream for the blocks of a frame.
+ *
+ * @param stream The stream.
+ * @param block_size The largest decoded size of a block.
+ * @return True on success, false if the buffers could not be allocated.
+ */
+static bool
+fs_stream_reserve(fs_stream_t *stream, usize_t block_size)
+{
+    // A block is preceded by its size and may be followed by its checksum.
+    usize_t buffer_size = FS_STREAM_HISTORY + block_size;
+    usize_t packed_size = block_size + 8;
+
+    if (stream->buffer_size < buffer_size)
+    {
+        uchar_t *buffer = alloc_resize(stream->allocator, stream->buffer,
+                                       stream->buffer_size, buffer_size);
+        if (!buffer)
+        {
+            return false;
+        }
+        stream->buffer = buffer;
+        stream->buffer_size = buffer_size;
+    }
+    if (stream->packed_size < packed_size)
+    {
+        uchar_t *packed = alloc_resize(stream->allocator, stream->packed,
+                                       stream->packed_size, packed_size);
+        if (!packed)
+        {
+            return false;
+        }
+        stream->packed = packed;
+        stream->packed_size = packed_size;
+    }
+    return true;
+}
+
+/**
+ * @brief Reads compressed data until enough of it is buffered.
+ *
+ * @param stream The stream.
+ * @param need The number of bytes needed, at most the size of the
+ *             compressed buffer.
+ * @return True on success, also if the file ends before, false if reading
+ *         failed.
+ */
+static bool
+fs_stream_fill(fs_stream_t *stream, usize_t need)
+{
+    usize_t have = stream->packed_end - stream->packed_begin;
+    if (have >= need)
+    {
+        return true;
+    }
+    if (stream->packed_size - stream->packed_begin < need)
+    {
+        memmove(stream->packed, stream->packed + stream->packed_begin, have);
+        stream->packed_begin = 0;
+        stream->packed_end = have;
+    }
+
+    while (!stream->eof && stream->packed_end - stream->packed_begin < need)
+    {
+        usize_t count;
+        if (!fs_read(stream->handle, stream->packed + stream->packed_end,
+                     stream->packed_size - stream->packed_end, &count))
+        {
+            return false;
+        }
+        stream->packed_end += count;
+        stream->eof = !count;
+    }
+    return true;
+}
+
+/**
+ * @brief Decodes the next block of a compressed stream into its buffer.
+ *
+ * @param stream The stream.
+ * @return True on success, leaving the buffer empty at the end of the file,
+ *         false if reading failed or the data is malformed or truncated.
+ */
+static bool
+fs_stream_decode(fs_stream_t *stream)
+{
+    uchar_t *dest = stream->buffer + FS_STREAM_HISTORY;
+    for (;;)
+    {
+        if (!stream->in_frame)
+        {
+            if (!fs_stream_fill(stream, LZ4_FRAME_HEADER_MAX))
+            {
+                return false;
+            }
+            if (stream->packed_begin == stream->packed_end)
+            {
+                return true;
+            }
+
+            const uchar_t *src = stream->packed + stream->packed_begin;
+            const uchar_t *next = lz4_frame_header(
+                &stream->frame, src, stream->packed + stream->packed_end);
+            if (!next || !fs_stream_reserve(stream, stream->frame.block_size))
+            {
+                return false;
+            }
+            dest = stream->buffer + FS_STREAM_HISTORY;
+            stream->packed_begin += (usize_t)(next - src);
+            stream->history = 0;
+            stream->in_frame = 1;
+        }
+        else
+        {
+            // Keep the end of the output for the back references of the
+            // next block.
+            usize_t keep = stream->history + stream->end - FS_STREAM_HISTORY;
+            if (keep > FS_STREAM_HISTORY)
+            {
+                keep = FS_STREAM_HISTORY;
+            }
+            memmove(dest - keep, stream->buffer + stream->end - keep, keep);
+            stream->history = keep;
+        }
+        stream->begin = FS_STREAM_HISTORY;
+        stream->end = FS_STREAM_HISTORY;
+
+        if (!fs_stream_fill(stream, 4))
+        {
+            return false;
+        }
+        usize_t have = stream->packed_end - stream->packed_begin;
+        usize_t size = have >= 4 ? lz4_frame_block_input(
+                                       &stream->frame,
+                                       stream->packed + stream->packed_begin)
+                                 : 0;
+        if (!size || !fs_stream_fill(stream, size)
+            || stream->packed_end - stream->packed_begin < size)
+        {
+            return false;
+        }
+
+        uchar_t *out = lz4_frame_decode(&stream->frame, dest - stream->history,
+                                        dest,
+                                        stream->packed + stream->packed_begin);
+        if (!out)
+        {
+            return false;
+        }
+        stream->packed_begin += size;
+        if (out == dest)
+        {
+            stream->in_frame = 0;
+            continue;
+        }
+        stream->end += (usize_t)(out - dest);
+        return true;
+    }
+}
+
+bool
+fs_stream_open(fs_stream_t *stream, const char_t *path, uint_t flags,
+               const allocator_t *allocator)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(stream, false, "invalid stream pointer")
+    LIQUID_EXCEPTION_RAISE_IF(!(flags & FS_READ) == !(flags & FS_WRITE),
+                              false, "streams are either read or written")
+
+    stream->allocator = allocator;
+    stream->buffer = nullptr;
+    stream->packed = nullptr;
+    stream->buffer_size = 0;
+    stream->packed_size = 0;
+    stream->history = 0;
+    stream->begin = 0;
+    stream->end = 0;
+    stream->packed_begin = 0;
+    stream->packed_end = 0;
+    stream->lz4.head = nullptr;
+    stream->flags = flags;
+    stream->in_frame = 0;
+    stream->eof = 0;
+
+    if (!fs_open(&stream->handle, path, flags & ~FS_LZ4))
+    {
+        stream->handle = FS_INVALID_HANDLE;
+        return false;
+    }
+
+    bool ok;
+    if (!(flags & FS_LZ4))
+    {
+        stream->buffer = alloc_new(allocator, FS_STREAM_BUFFER_SIZE);
+        stream->buffer_size = FS_STREAM_BUFFER_SIZE;
+        ok = stream->buffer != nullptr;
+    }
+    else if (flags & FS_READ)
+    {
+        ok = fs_stream_reserve(stream, LZ4_FRAME_BLOCK_SIZE);
+        stream->begin = FS_STREAM_HISTORY;
+        stream->end = FS_STREAM_HISTORY;
+    }
+    else
+    {
+        stream->buffer = alloc_new(allocator, LZ4_FRAME_BLOCK_SIZE);
+        stream->buffer_size = LZ4_FRAME_BLOCK_SIZE;
+        stream->packed = alloc_new(allocator, LZ4_FRAME_BLOCK_BOUND);
+        stream->packed_size = LZ4_FRAME_BLOCK_BOUND;
+        ok = stream->buffer && stream->packed
+             && lz4_init(&stream->lz4, LZ4_LEVEL_FAST, allocator);
+        if (ok)
+        {
+            uchar_t  header[LZ4_FRAME_HEADER_MAX];
+            uchar_t *header_end = lz4_frame_begin(header);
+            hash32_init(&stream->frame.checksum, 0);
+            ok = fs_write(stream->handle, header,
+                          (usize_t)(header_end - header));
+        }
+    }
+
+    if (!ok)
+    {
+        fs_stream_release(stream);
+    }
+    return ok;
+}
+
+bool
+fs_stream_close(fs_stream_t *stream)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(stream, false, "invalid stream pointer")
+
+    bool ok = fs_stream_flush(stream);
+    if (ok && stream->flags & FS_WRITE && stream->flags & FS_LZ4)
+    {
+        uchar_t end[LZ4_FRAME_END_SIZE];
+        lz4_frame_end(end, hash32_final(&stream->frame.checksum));
+        ok = fs_write(stream->handle, end, LZ4_FRAME_END_SIZE);
+    }
+    fs_stream_release(stream);
+    return ok;
+}
+
+bool
+fs_stream_read(fs_stream_t *stream, void *buffer, usize_t size,
+               usize_t *read_size)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(stream && stream->buffer, false,
+                                  "invalid stream pointer")
+    LIQUID_EXCEPTION_RAISE_IF_NOT((buffer || !size) && read_size, false,
+                                  "invalid buffer or size pointer")
+    LIQUID_EXCEPTION_RAISE_IF_NOT(stream->flags & FS_READ, false,
+                                  "stream not opened for reading")
+
+    uchar_t *dest = buffer;
+    usize_t  done = 0;
+    bool     ok = true;
+    while (done < size)
+    {
+        if (stream->begin == stream->end)
+        {
+            usize_t count = 0;
+            if (stream->flags & FS_LZ4)
+            {
+                ok = fs_stream_decode(stream);
+            }
+            else if (size - done >= stream->buffer_size)
+            {
+                // Large reads bypass the buffer.
+                ok = fs_read(stream->handle, dest + done, size - done, &count);
+                done += count;
+            }
+            else
+            {
+                ok = fs_read(stream->handle, stream->buffer,
+                             stream->buffer_size, &count);
+                stream->begin = 0;
+                stream->end = count;
+            }
+            if (!ok || (stream->begin == stream->end && !count))
+            {
+                break;
+            }
+            continue;
+        }
+
+        usize_t count = stream->end - stream->begin;
+        if (count > size - done)
+        {
+            count = size - done;
+        }
+        memcpy(dest + done, stream->buffer + stream->begin, count);
+        stream->begin += count;
+        done += count;
+    }
+
+    *read_size = done;
+    return ok;
+}
+
+bool
+fs_stream_write(fs_stream_t *stream, const void *buffer, usize_t size)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(stream && stream->buffer, false,
+                                  "invalid stream pointer")
+    LIQUID_EXCEPTION_RAISE_IF_NOT(buffer || !size, false,
+                                  "invalid buffer pointer")
+    LIQUID_EXCEPTION_RAISE_IF_NOT(stream->flags & FS_WRITE, false,
+                                  "stream not opened for writing")
+
+    const uchar_t *src = buffer;
+    while (size)
+    {
+        // Large writes bypass the buffer unless they need compression.
+        if (!stream->end && size >= stream->buffer_size
+            && !(stream->flags & FS_LZ4))
+        {
+            return fs_write(stream->handle, src, size);
+        }
+
+        usize_t count = stream->buffer_size - stream->end;
+        if (count > size)
+        {
+            count = size;
+        }
+        memcpy(stream->buffer + stream->end, src, count);
+        stream->end += count;
+        src += count;
+        size -= count;
+
+        if (stream->end == stream->buffer_size && !fs_stream_flush(stream))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+fs_stream_flush(fs_stream_t *stream)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(stream, false, "invalid stream pointer")
+
+    if (!(stream->flags & FS_WRITE) || !stream->end)
+    {
+        return true;
+    }
+
+    bool ok;
+    if (stream->flags & FS_LZ4)
+    {
+        const uchar_t *end = stream->buffer + stream->end;
+        hash32_update(&stream->frame.checksum, stream->buffer, end);
+        uchar_t *out = lz4_frame_block(&stream->lz4, stream->packed,
+                                       stream->buffer, end);
+        ok = fs_write(stream->handle, stream->packed,
+                      (usize_t)(out - stream->packed));
+    }
+    else
+    {
+        ok = fs_write(stream->handle, stream->buffer, stream->end);
+    }
+    stream->end = 0;
+    return ok;
+}
@@ -0,0 +1,1354 @@
+#include "hash-table.h"
+#include <liquid/array-raw.h>
+#include <liquid/bitflag.h>
+#include <liquid/exception.h>
+#include <liquid/hash.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+    #include <immintrin.h>
+    #define HASH_SIMD_SSE2
+    #define HASH_SIMD_AVX2
+    #define HASH_TARGET_AVX2 __attribute__((target("avx2")))
+    #define HASH_HAS_AVX2() __builtin_cpu_supports("avx2")
+    #define HASH_CRC_SSE42
+    #define HASH_TARGET_SSE42 __attribute__((target("sse4.2")))
+    #define HASH_HAS_SSE42() __builtin_cpu_supports("sse4.2")
+#elif defined(_MSC_VER) && defined(_M_X64)
+    #include <immintrin.h>
+    #define HASH_SIMD_SSE2
+    #if defined(__AVX2__)
+        #define HASH_SIMD_AVX2
+        #define HASH_TARGET_AVX2
+        #define HASH_HAS_AVX2() 1
+    #endif
+    #if defined(__AVX__)
+        #define HASH_CRC_SSE42
+        #define HASH_TARGET_SSE42
+        #define HASH_HAS_SSE42() 1
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define HASH_SIMD_NEON
+    #if defined(__ARM_FEATURE_CRC32)
+        #include <arm_acle.h>
+        #define HASH_CRC_ARM
+    #endif
+#endif
+
+#define HASH_PRIME32_1 0x9E3779B1u
+#define HASH_PRIME32_2 0x85EBCA77u
+#define HASH_PRIME32_3 0xC2B2AE3Du
+#define HASH_PRIME32_4 0x27D4EB2Fu
+#define HASH_PRIME32_5 0x165667B1u
+#define HASH_PRIME64_1 0x9E3779B185EBCA87ull
+#define HASH_PRIME64_2 0xC2B2AE3D27D4EB4Full
+#define HASH_PRIME64_3 0x165667B19E3779F9ull
+#define HASH_PRIME64_4 0x85EBCA77C2B2AE63ull
+#define HASH_PRIME64_5 0x27D4EB2F165667C5ull
+#define HASH_PRIME_MX1 0x165667919E3779F9ull
+#define HASH_PRIME_MX2 0x9FB21C651E98DF25ull
+
+/**
+ * @def HASH_STRIPE_SIZE
+ * @brief The number of bytes accumulated at once by long inputs.
+ */
+#define HASH_STRIPE_SIZE 64
+
+/**
+ * @def HASH_SECRET_STEP
+ * @brief The offset into the secret between consecutive stripes.
+ */
+#define HASH_SECRET_STEP 8
+
+/**
+ * @def HASH_BLOCK_STRIPES
+ * @brief The number of stripes between two scrambles of the accumulators.
+ */
+#define HASH_BLOCK_STRIPES                                                     \
+    ((HASH_SECRET_SIZE - HASH_STRIPE_SIZE) / HASH_SECRET_STEP)
+
+/**
+ * @def HASH_MIDSIZE_MAX
+ * @brief The longest input hashed without accumulators.
+ */
+#define HASH_MIDSIZE_MAX 240
+
+// Offsets into the secret, fixed by the algorithm.
+#define HASH_SECRET_SIZE_MIN 136
+#define HASH_MIDSIZE_START 3
+#define HASH_MIDSIZE_LAST 17
+#define HASH_LAST_STRIPE_START 7
+#define HASH_MERGE_START 11
+
+/**
+ * @brief The secret used by the seed zero, the seed is mixed into a copy.
+ */
+static const uchar_t HASH_DEFAULT_SECRET[HASH_SECRET_SIZE] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c,
+    0xf7, 0x21, 0xad, 0x1c, 0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb,
+    0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f, 0xcb, 0x79, 0xe6, 0x4e,
+    0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6,
+    0x81, 0x3a, 0x26, 0x4c, 0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb,
+    0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3, 0x71, 0x64, 0x48, 0x97,
+    0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7,
+    0xc7, 0x0b, 0x4f, 0x1d, 0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31,
+    0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64, 0xea, 0xc5, 0xac, 0x83,
+    0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26,
+    0x29, 0xd4, 0x68, 0x9e, 0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc,
+    0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce, 0x45, 0xcb, 0x3a, 0x8f,
+    0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+/**
+ * @brief The initial values of the stripe accumulators.
+ */
+static const ullong_t HASH_INIT_ACC[8] = {
+    HASH_PRIME32_3, HASH_PRIME64_1, HASH_PRIME64_2, HASH_PRIME64_3,
+    HASH_PRIME64_4, HASH_PRIME32_2, HASH_PRIME64_5, HASH_PRIME32_1,
+};
+
+/**
+ * @brief Loads a little-endian 32-bit value.
+ * @param src Pointer to the first byte.
+ * @return The loaded value.
+ */
+static uint_t
+hash_read32(const uchar_t *src)
+{
+    return (uint_t)src[0] | (uint_t)src[1] << 8 | (uint_t)src[2] << 16
+           | (uint_t)src[3] << 24;
+}
+
+/**
+ * @brief Loads a little-endian 64-bit value.
+ * @param src Pointer to the first byte.
+ * @return The loaded value.
+ */
+static ullong_t
+hash_read64(const uchar_t *src)
+{
+    return (ullong_t)hash_read32(src) | (ullong_t)hash_read32(src + 4) << 32;
+}
+
+/**
+ * @brief Stores a little-endian 64-bit value.
+ * @param dest Pointer to the first byte.
+ * @param value The value to store.
+ */
+static void
+hash_write64(uchar_t *dest, ullong_t value)
+{
+    for (uint_t i = 0; i < 8; ++i)
+    {
+        dest[i] = (uchar_t)(value >> (i * 8));
+    }
+}
+
+/**
+ * @brief Multiplies two 64-bit integers into a 128-bit product.
+ *
+ * @param a The first factor.
+ * @param b The second factor.
+ * @return The product.
+ */
+static hash128_t
+hash_mul128(ullong_t a, ullong_t b)
+{
+    hash128_t product;
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 full = (unsigned __int128)a * b;
+    product.low = (ullong_t)full;
+    product.high = (ullong_t)(full >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    product.low = _umul128(a, b, &product.high);
+#else
+    ullong_t lo_lo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+    ullong_t hi_lo = (a >> 32) * (b & 0xFFFFFFFF);
+    ullong_t lo_hi = (a & 0xFFFFFFFF) * (b >> 32);
+    ullong_t hi_hi = (a >> 32) * (b >> 32);
+
+    ullong_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    product.high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    product.low = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+#endif
+    return product;
+}
+
+/**
+ * @brief Multiplies two 64-bit integers and folds the halves of the
+ *        product together.
+ *
+ * @param a The first factor.
+ * @param b The second factor.
+ * @return The upper and lower half of the product combined by xor.
+ */
+static ullong_t
+hash_fold64(ullong_t a, ullong_t b)
+{
+    hash128_t product = hash_mul128(a, b);
+    return product.low ^ product.high;
+}
+
+/**
+ * @brief Mixes the bits of a value that has few bits of entropy.
+ * @param value The value.
+ * @return The mixed value.
+ */
+static ullong_t
+hash_avalanche64(ullong_t value)
+{
+    value ^= value >> 33;
+    value *= HASH_PRIME64_2;
+    value ^= value >> 29;
+    value *= HASH_PRIME64_3;
+    return value ^ (value >> 32);
+}
+
+/**
+ * @brief Mixes the bits of an accumulated value.
+ * @param value The value.
+ * @return The mixed value.
+ */
+static ullong_t
+hash_avalanche(ullong_t value)
+{
+    value ^= value >> 37;
+    value *= HASH_PRIME_MX1;
+    return value ^ (value >> 32);
+}
+
+/**
+ * @brief Mixes the bits of a value with a stronger avalanche.
+ *
+ * @param value The value.
+ * @param len The length of the input.
+ * @return The mixed value.
+ */
+static ullong_t
+hash_rrmxmx(ullong_t value, ullong_t len)
+{
+    value ^= bitflag_rotl64(value, 49) ^ bitflag_rotl64(value, 24);
+    value *= HASH_PRIME_MX2;
+    value ^= (value >> 35) + len;
+    value *= HASH_PRIME_MX2;
+    return value ^ (value >> 28);
+}
+
+/**
+ * @brief Mixes sixteen bytes of input with sixteen bytes of secret.
+ *
+ * @param input Pointer to the input.
+ * @param secret Pointer to the secret.
+ * @param seed The seed.
+ * @return The mixed value.
+ */
+static ullong_t
+hash_mix16(const uchar_t *input, const uchar_t *secret, ullong_t seed)
+{
+    return hash_fold64(hash_read64(input) ^ (hash_read64(secret) + seed),
+                       hash_read64(input + 8)
+                           ^ (hash_read64(secret + 8) - seed));
+}
+
+/**
+ * @brief Mixes two times sixteen bytes into a 128-bit accumulator.
+ *
+ * @param acc The accumulator.
+ * @param first Pointer to the first sixteen bytes.
+ * @param second Pointer to the second sixteen bytes.
+ * @param secret Pointer to thirty-two bytes of secret.
+ * @param seed The seed.
+ * @return The updated accumulator.
+ */
+static hash128_t
+hash_mix32(hash128_t acc, const uchar_t *first, const uchar_t *second,
+           const uchar_t *secret, ullong_t seed)
+{
+    acc.low += hash_mix16(first, secret, seed);
+    acc.low ^= hash_read64(second) + hash_read64(second + 8);
+    acc.high += hash_mix16(second, secret + 16, seed);
+    acc.high ^= hash_read64(first) + hash_read64(first + 8);
+    return acc;
+}
+
+/**
+ * @brief Computes the 64-bit hash of up to sixteen bytes.
+ *
+ * @param input Pointer to the input.
+ * @param len The length of the input.
+ * @param seed The seed.
+ * @return The hash value.
+ */
+static ullong_t
+hash64_short(const uchar_t *input, usize_t len, ullong_t seed)
+{
+    const uchar_t *secret = HASH_DEFAULT_SECRET;
+
+    if (len > 8)
+    {
+        ullong_t low = hash_read64(input)
+                       ^ ((hash_read64(secret + 24) ^ hash_read64(secret + 32))
+                          + seed);
+        ullong_t high = hash_read64(input + len - 8)
+                        ^ ((hash_read64(secret + 40) ^ hash_read64(secret + 48))
+                           - seed);
+        return hash_avalanche(len + bitflag_bswap64(low) + high
+                              + hash_fold64(low, high));
+    }
+
+    if (len >= 4)
+    {
+        seed ^= (ullong_t)bitflag_bswap32((uint_t)seed) << 32;
+        ullong_t value = hash_read32(input + len - 4)
+                         + ((ullong_t)hash_read32(input) << 32);
+        ullong_t bitflip =
+            (hash_read64(secret + 8) ^ hash_read64(secret + 16)) - seed;
+        return hash_rrmxmx(value ^ bitflip, len);
+    }
+
+    if (len)
+    {
+        uint_t combined = (uint_t)input[0] << 16 | (uint_t)input[len >> 1] << 24
+                          | (uint_t)input[len - 1] | (uint_t)len << 8;
+        ullong_t bitflip =
+            (hash_read32(secret) ^ hash_read32(secret + 4)) + seed;
+        return hash_avalanche64(combined ^ bitflip);
+    }
+
+    return hash_avalanche64(
+        seed ^ (hash_read64(secret + 56) ^ hash_read64(secret + 64)));
+}
+
+/**
+ * @brief Computes the 64-bit hash of 17 to 240 bytes.
+ *
+ * @param input Pointer to the input.
+ * @param len The length of the input.
+ * @param seed The seed.
+ * @return The hash value.
+ */
+static ullong_t
+hash64_mid(const uchar_t *input, usize_t len, ullong_t seed)
+{
+    const uchar_t *secret = HASH_DEFAULT_SECRET;
+    ullong_t       acc = len * HASH_PRIME64_1;
+
+    if (len <= 128)
+    {
+        // Pairs of blocks from both ends meet in the middle.
+        usize_t pairs = (len - 1) / 32;
+        for (usize_t i = 0; i <= pairs; ++i)
+        {
+            acc += hash_mix16(input + 16 * i, secret + 32 * i, seed);
+            acc += hash_mix16(input + len - 16 * (i + 1), secret + 32 * i + 16,
+                              seed);
+        }
+        return hash_avalanche(acc);
+    }
+
+    usize_t rounds = len / 16;
+    for (usize_t i = 0; i < 8; ++i)
+    {
+        acc += hash_mix16(input + 16 * i, secret + 16 * i, seed);
+    }
+    acc = hash_avalanche(acc);
+
+    ullong_t acc_end =
+        hash_mix16(input + len - 16,
+                   secret + HASH_SECRET_SIZE_MIN - HASH_MIDSIZE_LAST, seed);
+    for (usize_t i = 8; i < rounds; ++i)
+    {
+        acc_end += hash_mix16(input + 16 * i,
+                              secret + 16 * (i - 8) + HASH_MIDSIZE_START, seed);
+    }
+    return hash_avalanche(acc + acc_end);
+}
+
+/**
+ * @brief Computes the 128-bit hash of up to sixteen bytes.
+ * @see hash64_short
+ */
+static hash128_t
+hash128_short(const uchar_t *input, usize_t len, ullong_t seed)
+{
+    const uchar_t *secret = HASH_DEFAULT_SECRET;
+    hash128_t      result;
+
+    if (len > 8)
+    {
+        ullong_t bitflip_low =
+            (hash_read64(secret + 32) ^ hash_read64(secret + 40)) - seed;
+        ullong_t bitflip_high =
+            (hash_read64(secret + 48) ^ hash_read64(secret + 56)) + seed;
+        ullong_t low = hash_read64(input);
+        ullong_t high = hash_read64(input + len - 8);
+
+        hash128_t m = hash_mul128(low ^ high ^ bitflip_low, HASH_PRIME64_1);
+        m.low += (ullong_t)(len - 1) << 54;
+        high ^= bitflip_high;
+        m.high += high + (high & 0xFFFFFFFF) * (HASH_PRIME32_2 - 1);
+        m.low ^= bitflag_bswap64(m.high);
+
+        result = hash_mul128(m.low, HASH_PRIME64_2);
+        result.high += m.high * HASH_PRIME64_2;
+        result.low = hash_avalanche(result.low);
+        result.high = hash_avalanche(result.high);
+        return result;
+    }
+
+    if (len >= 4)
+    {
+        seed ^= (ullong_t)bitflag_bswap32((uint_t)seed) << 32;
+        ullong_t value = hash_read32(input)
+                         + ((ullong_t)hash_read32(input + len - 4) << 32);
+        ullong_t bitflip =
+            (hash_read64(secret + 16) ^ hash_read64(secret + 24)) + seed;
+
+        result = hash_mul128(value ^ bitflip, HASH_PRIME64_1 + (len << 2));
+        result.high += result.low << 1;
+        result.low ^= result.high >> 3;
+        result.low ^= result.low >> 35;
+        result.low *= HASH_PRIME_MX2;
+        result.low ^= result.low >> 28;
+        result.high = hash_avalanche(result.high);
+        return result;
+    }
+
+    if (len)
+    {
+        uint_t combined = (uint_t)input[0] << 16 | (uint_t)input[len >> 1] << 24
+                          | (uint_t)input[len - 1] | (uint_t)len << 8;
+        uint_t swapped = bitflag_bswap32(combined);
+        uint_t combined_high = swapped << 13 | swapped >> 19;
+
+        ullong_t bitflip_low =
+            (hash_read32(secret) ^ hash_read32(secret + 4)) + seed;
+        ullong_t bitflip_high =
+            (hash_read32(secret + 8) ^ hash_read32(secret + 12)) - seed;
+        result.low = hash_avalanche64(combined ^ bitflip_low);
+        result.high = hash_avalanche64(combined_high ^ bitflip_high);
+        return result;
+    }
+
+    result.low = hash_avalanche64(
+        seed ^ hash_read64(secret + 64) ^ hash_read64(secret + 72));
+    result.high = hash_avalanche64(
+        seed ^ hash_read64(secret + 80) ^ hash_read64(secret + 88));
+    return result;
+}
+
+/**
+ * @brief Combines both halves of a 128-bit accumulator into the hash.
+ *
+ * @param acc The accumulator.
+ * @param len The length of the input.
+ * @param seed The seed.
+ * @return The hash value.
+ */
+static hash128_t
+hash128_mid_final(hash128_t acc, usize_t len, ullong_t seed)
+{
+    hash128_t result;
+    result.low = hash_avalanche(acc.low + acc.high);
+    result.high = 0
+                  - hash_avalanche(acc.low * HASH_PRIME64_1
+                                   + acc.high * HASH_PRIME64_4
+                                   + (len - seed) * HASH_PRIME64_2);
+    return result;
+}
+
+/**
+ * @brief Computes the 128-bit hash of 17 to 240 bytes.
+ * @see hash64_mid
+ */
+static hash128_t
+hash128_mid(const uchar_t *input, usize_t len, ullong_t seed)
+{
+    const uchar_t *secret = HASH_DEFAULT_SECRET;
+    hash128_t      acc;
+
+    acc.low = len * HASH_PRIME64_1;
+    acc.high = 0;
+
+    if (len <= 128)
+    {
+        usize_t pairs = (len - 1) / 32;
+        for (usize_t i = pairs + 1; i-- > 0;)
+        {
+            acc = hash_mix32(acc, input + 16 * i, input + len - 16 * (i + 1),
+                             secret + 32 * i, seed);
+        }
+        return hash128_mid_final(acc, len, seed);
+    }
+
+    for (usize_t i = 32; i < 160; i += 32)
+    {
+        acc = hash_mix32(acc, input + i - 32, input + i - 16, secret + i - 32,
+                         seed);
+    }
+    acc.low = hash_avalanche(acc.low);
+    acc.high = hash_avalanche(acc.high);
+
+    for (usize_t i = 160; i <= len; i += 32)
+    {
+        acc = hash_mix32(acc, input + i - 32, input + i - 16,
+                         secret + HASH_MIDSIZE_START + i - 160, seed);
+    }
+    acc = hash_mix32(acc, input + len - 16, input + len - 32,
+                     secret + HASH_SECRET_SIZE_MIN - HASH_MIDSIZE_LAST - 16,
+                     0 - seed);
+    return hash128_mid_final(acc, len, seed);
+}
+
+/**
+ * @brief Accumulates stripes of input without vector instructions.
+ *
+ * Each accumulator adds the product of the low and high half of an input
+ * word keyed with the secret, plus the unkeyed neighbouring word.
+ *
+ * @param acc The eight accumulators.
+ * @param input Pointer to the first stripe.
+ * @param secret Pointer to the secret of the first stripe.
+ * @param stripes The number of stripes.
+ */
+static void
+hash_accumulate_scalar(ullong_t *acc, const uchar_t *input,
+                       const uchar_t *secret, usize_t stripes)
+{
+    for (; stripes; --stripes)
+    {
+        for (uint_t lane = 0; lane < 8; ++lane)
+        {
+            ullong_t data = hash_read64(input + lane * 8);
+            ullong_t key = data ^ hash_read64(secret + lane * 8);
+            acc[lane ^ 1] += data;
+            acc[lane] += (key & 0xFFFFFFFF) * (key >> 32);
+        }
+        input += HASH_STRIPE_SIZE;
+        secret += HASH_SECRET_STEP;
+    }
+}
+
+/**
+ * @brief Scrambles the accumulators without vector instructions.
+ *
+ * @param acc The eight accumulators.
+ * @param secret Pointer to the secret used for scrambling.
+ */
+static void
+hash_scramble_scalar(ullong_t *acc, const uchar_t *secret)
+{
+    for (uint_t lane = 0; lane < 8; ++lane)
+    {
+        ullong_t value = acc[lane];
+        value ^= value >> 47;
+        value ^= hash_read64(secret + lane * 8);
+        acc[lane] = value * HASH_PRIME32_1;
+    }
+}
+
+#if defined(HASH_SIMD_SSE2)
+/**
+ * @brief Accumulates stripes of input with SSE2.
+ * @see hash_accumulate_scalar
+ */
+static void
+hash_accumulate_sse2(ullong_t *acc, const uchar_t *input,
+                     const uchar_t *secret, usize_t stripes)
+{
+    __m128i lanes[4];
+    for (uint_t i = 0; i < 4; ++i)
+    {
+        lanes[i] = _mm_loadu_si128((const __m128i *)acc + i);
+    }
+
+    for (; stripes; --stripes)
+    {
+        for (uint_t i = 0; i < 4; ++i)
+        {
+            __m128i data = _mm_loadu_si128((const __m128i *)input + i);
+            __m128i key = _mm_xor_si128(
+                data, _mm_loadu_si128((const __m128i *)secret + i));
+            __m128i product = _mm_mul_epu32(
+                key, _mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)));
+            __m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+            lanes[i] = _mm_add_epi64(lanes[i], _mm_add_epi64(product, swapped));
+        }
+        input += HASH_STRIPE_SIZE;
+        secret += HASH_SECRET_STEP;
+    }
+
+    for (uint_t i = 0; i < 4; ++i)
+    {
+        _mm_storeu_si128((__m128i *)acc + i, lanes[i]);
+    }
+}
+
+/**
+ * @brief Scrambles the accumulators with SSE2.
+ * @see hash_scramble_scalar
+ */
+static void
+hash_scramble_sse2(ullong_t *acc, const uchar_t *secret)
+{
+    const __m128i prime = _mm_set1_epi32((int)HASH_PRIME32_1);
+    for (uint_t i = 0; i < 4; ++i)
+    {
+        __m128i value = _mm_loadu_si128((const __m128i *)acc + i);
+        value = _mm_xor_si128(value, _mm_srli_epi64(value, 47));
+        value = _mm_xor_si128(value,
+                              _mm_loadu_si128((const __m128i *)secret + i));
+
+        // A 64-bit product from two 32-bit multiplications.
+        __m128i low = _mm_mul_epu32(value, prime);
+        __m128i high = _mm_mul_epu32(_mm_srli_epi64(value, 32), prime);
+        value = _mm_add_epi64(low, _mm_slli_epi64(high, 32));
+        _mm_storeu_si128((__m128i *)acc + i, value);
+    }
+}
+#endif
+
+#if defined(HASH_SIMD_AVX2)
+/**
+ * @brief Accumulates stripes of input with AVX2.
+ * @see hash_accumulate_scalar
+ */
+HASH_TARGET_AVX2 static void
+hash_accumulate_avx2(ullong_t *acc, const uchar_t *input,
+                     const uchar_t *secret, usize_t stripes)
+{
+    __m256i lanes[2];
+    for (uint_t i = 0; i < 2; ++i)
+    {
+        lanes[i] = _mm256_loadu_si256((const __m256i *)acc + i);
+    }
+
+    for (; stripes; --stripes)
+    {
+        for (uint_t i = 0; i < 2; ++i)
+        {
+            __m256i data = _mm256_loadu_si256((const __m256i *)input + i);
+            __m256i key = _mm256_xor_si256(
+                data, _mm256_loadu_si256((const __m256i *)secret + i));
+            __m256i product = _mm256_mul_epu32(key, _mm256_srli_epi64(key, 32));
+            __m256i swapped =
+                _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+            lanes[i] = _mm256_add_epi64(lanes[i],
+                                        _mm256_add_epi64(product, swapped));
+        }
+        input += HASH_STRIPE_SIZE;
+        secret += HASH_SECRET_STEP;
+    }
+
+    for (uint_t i = 0; i < 2; ++i)
+    {
+        _mm256_storeu_si256((__m256i *)acc + i, lanes[i]);
+    }
+}
+
+/**
+ * @brief Scrambles the accumulators with AVX2.
+ * @see hash_scramble_scalar
+ */
+HASH_TARGET_AVX2 static void
+hash_scramble_avx2(ullong_t *acc, const uchar_t *secret)
+{
+    const __m256i prime = _mm256_set1_epi32((int)HASH_PRIME32_1);
+    for (uint_t i = 0; i < 2; ++i)
+    {
+        __m256i value = _mm256_loadu_si256((const __m256i *)acc + i);
+        value = _mm256_xor_si256(value, _mm256_srli_epi64(value, 47));
+        value = _mm256_xor_si256(
+            value, _mm256_loadu_si256((const __m256i *)secret + i));
+
+        __m256i low = _mm256_mul_epu32(value, prime);
+        __m256i high = _mm256_mul_epu32(_mm256_srli_epi64(value, 32), prime);
+        value = _mm256_add_epi64(low, _mm256_slli_epi64(high, 32));
+        _mm256_storeu_si256((__m256i *)acc + i, value);
+    }
+}
+#endif
+
+#if defined(HASH_SIMD_NEON)
+/**
+ * @brief Accumulates stripes of input with NEON.
+ * @see hash_accumulate_scalar
+ */
+static void
+hash_accumulate_neon(ullong_t *acc, const uchar_t *input,
+                     const uchar_t *secret, usize_t stripes)
+{
+    uint64x2_t lanes[4];
+    for (uint_t i = 0; i < 4; ++i)
+    {
+        lanes[i] = vld1q_u64(acc + 2 * i);
+    }
+
+    for (; stripes; --stripes)
+    {
+        for (uint_t i = 0; i < 4; ++i)
+        {
+            uint64x2_t data = vreinterpretq_u64_u8(vld1q_u8(input + 16 * i));
+            uint64x2_t key = veorq_u64(
+                data, vreinterpretq_u64_u8(vld1q_u8(secret + 16 * i)));
+            lanes[i] = vaddq_u64(lanes[i], vextq_u64(data, data, 1));
+            lanes[i] =
+                vmlal_u32(lanes[i], vmovn_u64(key), vshrn_n_u64(key, 32));
+        }
+        input += HASH_STRIPE_SIZE;
+        secret += HASH_SECRET_STEP;
+    }
+
+    for (uint_t i = 0; i < 4; ++i)
+    {
+        vst1q_u64(acc + 2 * i, lanes[i]);
+    }
+}
+
+/**
+ * @brief Scrambles the accumulators with NEON.
+ * @see hash_scramble_scalar
+ */
+static void
+hash_scramble_neon(ullong_t *acc, const uchar_t *secret)
+{
+    const uint32x2_t prime = vdup_n_u32(HASH_PRIME32_1);
+    for (uint_t i = 0; i < 4; ++i)
+    {
+        uint64x2_t value = vld1q_u64(acc + 2 * i);
+        value = veorq_u64(value, vshrq_n_u64(value, 47));
+        value = veorq_u64(value,
+                          vreinterpretq_u64_u8(vld1q_u8(secret + 16 * i)));
+
+        uint64x2_t high = vmull_u32(vshrn_n_u64(value, 32), prime);
+        value = vmlal_u32(vshlq_n_u64(high, 32), vmovn_u64(value), prime);
+        vst1q_u64(acc + 2 * i, value);
+    }
+}
+#endif
+
+/**
+ * @brief Accumulates stripes of input with the fastest available unit.
+ *
+ * All variants produce identical results.
+ *
+ * @param acc The eight accumulators.
+ * @param input Pointer to the first stripe.
+ * @param secret Pointer to the secret of the first stripe.
+ * @param stripes The number of stripes.
+ */
+static void
+hash_accumulate(ullong_t *acc, const uchar_t *input, const uchar_t *secret,
+                usize_t stripes)
+{
+#if defined(HASH_SIMD_AVX2)
+    if (HASH_HAS_AVX2())
+    {
+        hash_accumulate_avx2(acc, input, secret, stripes);
+        return;
+    }
+#endif
+#if defined(HASH_SIMD_SSE2)
+    hash_accumulate_sse2(acc, input, secret, stripes);
+    return;
+#elif defined(HASH_SIMD_NEON)
+    hash_accumulate_neon(acc, input, secret, stripes);
+    return;
+#endif
+    hash_accumulate_scalar(acc, input, secret, stripes);
+}
+
+/**
+ * @brief Scrambles the accumulators with the fastest available unit.
+ *
+ * @param acc The eight accumulators.
+ * @param secret Pointer to the secret used for scrambling.
+ */
+static void
+hash_scramble(ullong_t *acc, const uchar_t *secret)
+{
+#if defined(HASH_SIMD_AVX2)
+    if (HASH_HAS_AVX2())
+    {
+        hash_scramble_avx2(acc, secret);
+        return;
+    }
+#endif
+#if defined(HASH_SIMD_SSE2)
+    hash_scramble_sse2(acc, secret);
+    return;
+#elif defined(HASH_SIMD_NEON)
+    hash_scramble_neon(acc, secret);
+    return;
+#endif
+    hash_scramble_scalar(acc, secret);
+}
+
+/**
+ * @brief Derives the secret of a seed.
+ *
+ * @param secret Receives HASH_SECRET_SIZE bytes of secret.
+ * @param seed The seed.
+ */
+static void
+hash_init_secret(uchar_t *secret, ullong_t seed)
+{
+    for (uint_t i = 0; i < HASH_SECRET_SIZE; i += 16)
+    {
+        hash_write64(secret + i, hash_read64(HASH_DEFAULT_SECRET + i) + seed);
+        hash_write64(secret + i + 8,
+                     hash_read64(HASH_DEFAULT_SECRET + i + 8) - seed);
+    }
+}
+
+/**
+ * @brief Accumulates stripes that may cross the boundaries of blocks.
+ *
+ * @param acc The eight accumulators.
+ * @param block_stripes The stripes accumulated in the current block, updated
+ *                      on return.
+ * @param input Pointer to the first stripe.
+ * @param stripes The number of stripes.
+ * @param secret The secret of the hash.
+ * @return Pointer past the last stripe.
+ */
+static const uchar_t *
+hash_consume(ullong_t *acc, usize_t *block_stripes, const uchar_t *input,
+             usize_t stripes, const uchar_t *secret)
+{
+    usize_t chunk = HASH_BLOCK_STRIPES - *block_stripes;
+    while (stripes >= chunk)
+    {
+        hash_accumulate(acc, input, secret + *block_stripes * HASH_SECRET_STEP,
+                        chunk);
+        hash_scramble(acc, secret + HASH_SECRET_SIZE - HASH_STRIPE_SIZE);
+        input += chunk * HASH_STRIPE_SIZE;
+        stripes -= chunk;
+        *block_stripes = 0;
+        chunk = HASH_BLOCK_STRIPES;
+    }
+
+    if (stripes)
+    {
+        hash_accumulate(acc, input, secret + *block_stripes * HASH_SECRET_STEP,
+                        stripes);
+        input += stripes * HASH_STRIPE_SIZE;
+        *block_stripes += stripes;
+    }
+    return input;
+}
+
+/**
+ * @brief Accumulates an input longer than HASH_MIDSIZE_MAX.
+ *
+ * @param acc Receives the eight accumulators.
+ * @param input Pointer to the input.
+ * @param len The length of the input.
+ * @param secret The secret of the hash.
+ */
+static void
+hash_long(ullong_t *acc, const uchar_t *input, usize_t len,
+          const uchar_t *secret)
+{
+    array_raw_move(acc, HASH_INIT_ACC, sizeof(HASH_INIT_ACC));
+
+    // The last stripe is always accumulated separately, even if the input
+    // ends on a stripe boundary.
+    usize_t block_stripes = 0;
+    hash_consume(acc, &block_stripes, input, (len - 1) / HASH_STRIPE_SIZE,
+                 secret);
+    hash_accumulate(acc, input + len - HASH_STRIPE_SIZE,
+                    secret + HASH_SECRET_SIZE - HASH_STRIPE_SIZE
+                        - HASH_LAST_STRIPE_START,
+                    1);
+}
+
+/**
+ * @brief Merges the accumulators into a 64-bit value.
+ *
+ * @param acc The eight accumulators.
+ * @param secret Pointer to 64 bytes of secret.
+ * @param start The initial value.
+ * @return The merged value.
+ */
+static ullong_t
+hash_merge(const ullong_t *acc, const uchar_t *secret, ullong_t start)
+{
+    for (uint_t i = 0; i < 4; ++i)
+    {
+        start += hash_fold64(acc[2 * i] ^ hash_read64(secret + 16 * i),
+                             acc[2 * i + 1] ^ hash_read64(secret + 16 * i + 8));
+    }
+    return hash_avalanche(start);
+}
+
+/**
+ * @brief Merges the accumulators into a 128-bit hash.
+ *
+ * @param acc The eight accumulators.
+ * @param secret The secret of the hash.
+ * @param len The length of the input.
+ * @return The hash value.
+ */
+static hash128_t
+hash128_merge(const ullong_t *acc, const uchar_t *secret, ullong_t len)
+{
+    hash128_t result;
+    result.low =
+        hash_merge(acc, secret + HASH_MERGE_START, len * HASH_PRIME64_1);
+    result.high = hash_merge(acc,
+                             secret + HASH_SECRET_SIZE - 8 * sizeof(ullong_t)
+                                 - HASH_MERGE_START,
+                             ~(len * HASH_PRIME64_2));
+    return result;
+}
+
+ullong_t
+hash64(const void *begin, const void *end, ullong_t seed)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT((begin && end) || begin == end, 0,
+                                  "invalid range")
+
+    const uchar_t *input = (const uchar_t *)begin;
+    usize_t        len = LIQUID_PTR_DIFF(input, (const uchar_t *)end);
+
+    if (len <= 16)
+    {
+        return hash64_short(input, len, seed);
+    }
+    if (len <= HASH_MIDSIZE_MAX)
+    {
+        return hash64_mid(input, len, seed);
+    }
+
+    ullong_t       acc[8];
+    uchar_t        secret[HASH_SECRET_SIZE];
+    const uchar_t *key = HASH_DEFAULT_SECRET;
+    if (seed)
+    {
+        hash_init_secret(secret, seed);
+        key = secret;
+    }
+
+    hash_long(acc, input, len, key);
+    return hash_merge(acc, key + HASH_MERGE_START, len * HASH_PRIME64_1);
+}
+
+hash128_t
+hash128(const void *begin, const void *end, ullong_t seed)
+{
+    hash128_t result = {0, 0};
+    LIQUID_EXCEPTION_RAISE_IF_NOT((begin && end) || begin == end, result,
+                                  "invalid range")
+
+    const uchar_t *input = (const uchar_t *)begin;
+    usize_t        len = LIQUID_PTR_DIFF(input, (const uchar_t *)end);
+
+    if (len <= 16)
+    {
+        return hash128_short(input, len, seed);
+    }
+    if (len <= HASH_MIDSIZE_MAX)
+    {
+        return hash128_mid(input, len, seed);
+    }
+
+    ullong_t       acc[8];
+    uchar_t        secret[HASH_SECRET_SIZE];
+    const uchar_t *key = HASH_DEFAULT_SECRET;
+    if (seed)
+    {
+        hash_init_secret(secret, seed);
+        key = secret;
+    }
+
+    hash_long(acc, input, len, key);
+    return hash128_merge(acc, key, len);
+}
+
+void
+hash_init(hash_state_t *state, ullong_t seed)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(state, , "invalid state pointer")
+
+    array_raw_move(state->acc, HASH_INIT_ACC, sizeof(HASH_INIT_ACC));
+    state->seed = seed;
+    state->total = 0;
+    state->buffered = 0;
+    state->stripes = 0;
+    hash_init_secret(state->secret, seed);
+}
+
+void
+hash_update(hash_state_t *state, const void *begin, const void *end)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(state, , "invalid state pointer")
+    LIQUID_EXCEPTION_RAISE_IF_NOT((begin && end) || begin == end, ,
+                                  "invalid range")
+
+    const uchar_t *input = (const uchar_t *)begin;
+    const uchar_t *last = (const uchar_t *)end;
+    usize_t        len = LIQUID_PTR_DIFF(input, last);
+    if (!len)
+    {
+        return;
+    }
+
+    state->total += len;
+    if (len <= HASH_BUFFER_SIZE - state->buffered)
+    {
+        array_raw_move(state->buffer + state->buffered, input, len);
+        state->buffered += len;
+        return;
+    }
+
+    if (state->buffered)
+    {
+        usize_t fill = HASH_BUFFER_SIZE - state->buffered;
+        array_raw_move(state->buffer + state->buffered, input, fill);
+        input += fill;
+        hash_consume(state->acc, &state->stripes, state->buffer,
+                     HASH_BUFFER_SIZE / HASH_STRIPE_SIZE, state->secret);
+    }
+
+    // At least one byte always stays buffered so that the final stripe can
+    // be handled like that of a one-shot hash. The stripe before it is kept
+    // at the end of the buffer in case fewer than a stripe remain.
+    if (LIQUID_PTR_DIFF(input, last) > HASH_BUFFER_SIZE)
+    {
+        usize_t stripes =
+            (usize_t)(LIQUID_PTR_DIFF(input, last) - 1) / HASH_STRIPE_SIZE;
+        input = hash_consume(state->acc, &state->stripes, input, stripes,
+                             state->secret);
+        array_raw_move(state->buffer + HASH_BUFFER_SIZE - HASH_STRIPE_SIZE,
+                       input - HASH_STRIPE_SIZE, HASH_STRIPE_SIZE);
+    }
+
+    state->buffered = LIQUID_PTR_DIFF(input, last);
+    array_raw_move(state->buffer, input, state->buffered);
+}
+
+/**
+ * @brief Accumulates the buffered input of a long incremental hash.
+ *
+ * @param state The state of the hash.
+ * @param acc Receives the eight accumulators.
+ */
+static void
+hash_final_long(const hash_state_t *state, ullong_t *acc)
+{
+    array_raw_move(acc, state->acc, sizeof(state->acc));
+
+    const uchar_t *last_stripe;
+    uchar_t        stripe[HASH_STRIPE_SIZE];
+    if (state->buffered >= HASH_STRIPE_SIZE)
+    {
+        usize_t block_stripes = state->stripes;
+        hash_consume(acc, &block_stripes, state->buffer,
+                     (state->buffered - 1) / HASH_STRIPE_SIZE, state->secret);
+        last_stripe = state->buffer + state->buffered - HASH_STRIPE_SIZE;
+    }
+    else
+    {
+        // Complete the last stripe with the tail of the previous buffer.
+        usize_t catchup = HASH_STRIPE_SIZE - state->buffered;
+        array_raw_move(stripe, state->buffer + HASH_BUFFER_SIZE - catchup,
+                       catchup);
+        array_raw_move(stripe + catchup, state->buffer, state->buffered);
+        last_stripe = stripe;
+    }
+
+    hash_accumulate(acc, last_stripe,
+                    state->secret + HASH_SECRET_SIZE - HASH_STRIPE_SIZE
+                        - HASH_LAST_STRIPE_START,
+                    1);
+}
+
+ullong_t
+hash64_final(const hash_state_t *state)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(state, 0, "invalid state pointer")
+
+    if (state->total <= HASH_MIDSIZE_MAX)
+    {
+        return hash64(state->buffer, state->buffer + state->total,
+                      state->seed);
+    }
+
+    ullong_t acc[8];
+    hash_final_long(state, acc);
+    return hash_merge(acc, state->secret + HASH_MERGE_START,
+                      state->total * HASH_PRIME64_1);
+}
+
+hash128_t
+hash128_final(const hash_state_t *state)
+{
+    hash128_t result = {0, 0};
+    LIQUID_EXCEPTION_RAISE_IF_NOT(state, result, "invalid state pointer")
+
+    if (state->total <= HASH_MIDSIZE_MAX)
+    {
+        return hash128(state->buffer, state->buffer + state->total,
+                       state->seed);
+    }
+
+    ullong_t acc[8];
+    hash_final_long(state, acc);
+    return hash128_merge(acc, state->secret, state->total);
+}
+
+/**
+ * @brief Mixes four bytes of input into an XXH32 lane.
+ *
+ * @param acc The lane accumulator.
+ * @param input The little-endian input word.
+ * @return The updated accumulator.
+ */
+static uint_t
+hash32_round(uint_t acc, uint_t input)
+{
+    acc = bitflag_rotl32(acc + input * HASH_PRIME32_2, 13) * HASH_PRIME32_1;
+#if defined(__GNUC__) || defined(__clang__)
+    // Keeps the four lanes in scalar registers: vectorized, the rotation
+    // and the multiplication cost several SSE2 instructions each and the
+    // hash runs at half the speed.
+    __asm__("" : "+r"(acc));
+#endif
+    return acc;
+}
+
+/**
+ * @brief Consumes the 16-byte stripes of an XXH32 input.
+ *
+ * @param acc The four lane accumulators.
+ * @param input Pointer to the first stripe.
+ * @param stripes The number of stripes.
+ * @return Pointer past the last stripe.
+ */
+static const uchar_t *
+hash32_consume(uint_t *acc, const uchar_t *input, usize_t stripes)
+{
+    uint_t v1 = acc[0];
+    uint_t v2 = acc[1];
+    uint_t v3 = acc[2];
+    uint_t v4 = acc[3];
+    for (usize_t i = 0; i < stripes; ++i, input += 16)
+    {
+        v1 = hash32_round(v1, hash_read32(input));
+        v2 = hash32_round(v2, hash_read32(input + 4));
+        v3 = hash32_round(v3, hash_read32(input + 8));
+        v4 = hash32_round(v4, hash_read32(input + 12));
+    }
+    acc[0] = v1;
+    acc[1] = v2;
+    acc[2] = v3;
+    acc[3] = v4;
+    return input;
+}
+
+/**
+ * @brief Completes an XXH32 hash.
+ *
+ * @param acc The four lane accumulators.
+ * @param seed The seed of the hash.
+ * @param total The number of bytes hashed.
+ * @param tail The bytes after the last stripe.
+ * @param len The number of bytes after the last stripe, less than 16.
+ * @return The hash value.
+ */
+static uint_t
+hash32_finish(const uint_t *acc, uint_t seed, ullong_t total,
+              const uchar_t *tail, usize_t len)
+{
+    uint_t hash = total >= 16
+                      ? bitflag_rotl32(acc[0], 1) + bitflag_rotl32(acc[1], 7)
+                            + bitflag_rotl32(acc[2], 12)
+                            + bitflag_rotl32(acc[3], 18)
+                      : seed + HASH_PRIME32_5;
+    hash += (uint_t)total;
+
+    for (; len >= 4; len -= 4, tail += 4)
+    {
+        hash += hash_read32(tail) * HASH_PRIME32_3;
+        hash = bitflag_rotl32(hash, 17) * HASH_PRIME32_4;
+    }
+    for (; len; --len, ++tail)
+    {
+        hash += *tail * HASH_PRIME32_5;
+        hash = bitflag_rotl32(hash, 11) * HASH_PRIME32_1;
+    }
+
+    hash ^= hash >> 15;
+    hash *= HASH_PRIME32_2;
+    hash ^= hash >> 13;
+    hash *= HASH_PRIME32_3;
+    return hash ^ hash >> 16;
+}
+
+uint_t
+hash32(const void *begin, const void *end, uint_t seed)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT((begin && end) || begin == end, 0,
+                                  "invalid range")
+
+    hash32_state_t state;
+    hash32_init(&state, seed);
+
+    const uchar_t *input = (const uchar_t *)begin;
+    usize_t        len = LIQUID_PTR_DIFF(input, (const uchar_t *)end);
+    input = hash32_consume(state.acc, input, len / 16);
+    return hash32_finish(state.acc, seed, len, input, len % 16);
+}
+
+void
+hash32_init(hash32_state_t *state, uint_t seed)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(state, , "invalid state pointer")
+
+    state->acc[0] = seed + HASH_PRIME32_1 + HASH_PRIME32_2;
+    state->acc[1] = seed + HASH_PRIME32_2;
+    state->acc[2] = seed;
+    state->acc[3] = seed - HASH_PRIME32_1;
+    state->seed = seed;
+    state->buffered = 0;
+    state->total = 0;
+}
+
+void
+hash32_update(hash32_state_t *state, const void *begin, const void *end)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(state, , "invalid state pointer")
+    LIQUID_EXCEPTION_RAISE_IF_NOT((begin && end) || begin == end, ,
+                                  "invalid range")
+
+    const uchar_t *input = (const uchar_t *)begin;
+    const uchar_t *last = (const uchar_t *)end;
+    usize_t        len = LIQUID_PTR_DIFF(input, last);
+    state->total += len;
+
+    if (state->buffered)
+    {
+        usize_t fill = 16 - state->buffered;
+        fill = fill < len ? fill : len;
+        array_raw_copy(state->buffer + state->buffered, input, fill);
+        state->buffered += (uint_t)fill;
+        input += fill;
+        if (state->buffered < 16)
+        {
+            return;
+        }
+        hash32_consume(state->acc, state->buffer, 1);
+        state->buffered = 0;
+    }
+
+    len = LIQUID_PTR_DIFF(input, last);
+    input = hash32_consume(state->acc, input, len / 16);
+    state->buffered = (uint_t)LIQUID_PTR_DIFF(input, last);
+    array_raw_copy(state->buffer, input, state->buffered);
+}
+
+uint_t
+hash32_final(const hash32_state_t *state)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(state, 0, "invalid state pointer")
+
+    return hash32_finish(state->acc, state->seed, state->total, state->buffer,
+                         state->buffered);
+}
+
+/**
+ * @brief Updates a CRC-32C eight bytes at a time with table lookups.
+ *
+ * @param crc The inverted checksum so far.
+ * @param ptr Pointer to the first byte.
+ * @param end Pointer past the last byte.
+ * @return The updated inverted checksum.
+ */
+static uint_t
+hash_crc32c_table(uint_t crc, const uchar_t *ptr, const uchar_t *end)
+{
+    for (; LIQUID_PTR_DIFF(ptr, end) >= 8; ptr += 8)
+    {
+        ullong_t word = hash_read64(ptr) ^ crc;
+        crc = HASH_CRC32C_TABLE[7][word & 0xFF]
+              ^ HASH_CRC32C_TABLE[6][(word >> 8) & 0xFF]
+              ^ HASH_CRC32C_TABLE[5][(word >> 16) & 0xFF]
+              ^ HASH_CRC32C_TABLE[4][(word >> 24) & 0xFF]
+              ^ HASH_CRC32C_TABLE[3][(word >> 32) & 0xFF]
+              ^ HASH_CRC32C_TABLE[2][(word >> 40) & 0xFF]
+              ^ HASH_CRC32C_TABLE[1][(word >> 48) & 0xFF]
+              ^ HASH_CRC32C_TABLE[0][word >> 56];
+    }
+
+    while (ptr != end)
+    {
+        crc = HASH_CRC32C_TABLE[0][(crc ^ *ptr++) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(HASH_CRC_SSE42)
+/**
+ * @brief Updates a CRC-32C with the SSE4.2 instructions.
+ * @see hash_crc32c_table
+ */
+HASH_TARGET_SSE42 static uint_t
+hash_crc32c_sse42(uint_t crc, const uchar_t *ptr, const uchar_t *end)
+{
+    ullong_t value = crc;
+    for (; LIQUID_PTR_DIFF(ptr, end) >= 8; ptr += 8)
+    {
+        value = _mm_crc32_u64(value, hash_read64(ptr));
+    }
+
+    crc = (uint_t)value;
+    while (ptr != end)
+    {
+        crc = _mm_crc32_u8(crc, *ptr++);
+    }
+    return crc;
+}
+#elif defined(HASH_CRC_ARM)
+/**
+ * @brief Updates a CRC-32C with the ARMv8 instructions.
+ * @see hash_crc32c_table
+ */
+static uint_t
+hash_crc32c_arm(uint_t crc, const uchar_t *ptr, const uchar_t *end)
+{
+    for (; LIQUID_PTR_DIFF(ptr, end) >= 8; ptr += 8)
+    {
+        crc = __crc32cd(crc, hash_read64(ptr));
+    }
+
+    while (ptr != end)
+    {
+        crc = __crc32cb(crc, *ptr++);
+    }
+    return crc;
+}
+#endif
+
+uint_t
+hash_crc32c(const void *begin, const void *end, uint_t crc)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT((begin && end) || begin == end, crc,
+                                  "invalid range")
+
+    const uchar_t *ptr = (const uchar_t *)begin;
+    const uchar_t *last = (const uchar_t *)end;
+
+#if defined(HASH_CRC_SSE42)
+    if (HASH_HAS_SSE42())
+    {
+        return ~hash_crc32c_sse42(~crc, ptr, last);
+    }
+#elif defined(HASH_CRC_ARM)
+    return ~hash_crc32c_arm(~crc, ptr, last);
+#endif
+    return ~hash_crc32c_table(~crc, ptr, last);
+}
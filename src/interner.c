@@ -0,0 +1,592 @@
+#include <liquid/array-raw.h>
+#include <liquid/bitflag.h>
+#include <liquid/exception.h>
+#include <liquid/hash.h>
+#include <liquid/interner.h>
+
+#if defined(LIQUID_TARGET_OS_WINDOWS)
+    #include <windows.h>
+#elif defined(LIQUID_TARGET_OS_POSIX_LIKE)
+    #include <sched.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)                \
+    || defined(_M_IX86)
+    #include <immintrin.h>
+    #define INTERNER_PAUSE() _mm_pause()
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    #include <intrin.h>
+    #define INTERNER_PAUSE() __yield()
+#elif defined(__aarch64__) || defined(__arm__)
+    #define INTERNER_PAUSE() __asm__ __volatile__("yield")
+#else
+    #define INTERNER_PAUSE() ((void)0)
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define INTERNER_LOAD(ptr) __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+    #define INTERNER_STORE(ptr, value)                                         \
+        __atomic_store_n(ptr, value, __ATOMIC_RELEASE)
+    #define INTERNER_SWAP(ptr, value)                                          \
+        __atomic_exchange_n(ptr, value, __ATOMIC_ACQUIRE)
+    #define INTERNER_CAS(ptr, expected, desired)                               \
+        __sync_bool_compare_and_swap(ptr, expected, desired)
+#elif defined(_MSC_VER)
+    #include <intrin.h>
+    // With /volatile:ms, the default except on ARM, volatile loads acquire
+    // and volatile stores release.
+    #define INTERNER_LOAD(ptr) (*(ptr))
+    #define INTERNER_STORE(ptr, value) (*(ptr) = (value))
+    #define INTERNER_SWAP(ptr, value)                                          \
+        ((uint_t)_InterlockedExchange((volatile long *)(ptr), (long)(value)))
+    #define INTERNER_CAS(ptr, expected, desired)                               \
+        ((uint_t)_InterlockedCompareExchange((volatile long *)(ptr),           \
+                                             (long)(desired),                  \
+                                             (long)(expected))                 \
+         == (expected))
+#else
+    #error "Unsupported compiler"
+#endif
+
+/**
+ * @def INTERNER_CACHE_LINE
+ * @brief The distance kept between shards so they never share a cache line.
+ */
+#define INTERNER_CACHE_LINE 64
+
+/**
+ * @def INTERNER_SHARD_STRIDE
+ * @brief The distance between two consecutive shards.
+ */
+#define INTERNER_SHARD_STRIDE                                                  \
+    ((sizeof(interner_shard_t) + INTERNER_CACHE_LINE - 1)                      \
+     & ~(usize_t)(INTERNER_CACHE_LINE - 1))
+
+/**
+ * @def INTERNER_SHARD(interner, index)
+ * @brief Retrieves a shard by its index.
+ */
+#define INTERNER_SHARD(interner, index)                                        \
+    ((interner_shard_t *)((uchar_t *)(interner)->shards                        \
+                          + (index) * INTERNER_SHARD_STRIDE))
+
+/**
+ * @def INTERNER_BLOCK_SIZE
+ * @brief The size of the block holding the shards, including the slack
+ *        needed to align them to a cache line.
+ */
+#define INTERNER_BLOCK_SIZE                                                    \
+    (INTERNER_SHARD_COUNT * INTERNER_SHARD_STRIDE + INTERNER_CACHE_LINE)
+
+/**
+ * @def INTERNER_ARENA_CHUNK_SIZE
+ * @brief The size of the arena chunks of a shard.
+ *
+ * Strings are spread over all shards, so small chunks keep an interner of
+ * a few strings small.
+ */
+#define INTERNER_ARENA_CHUNK_SIZE 4096
+
+/**
+ * @def INTERNER_CHUNK_SHIFT
+ * @brief The binary logarithm of INTERNER_CHUNK_FIRST.
+ */
+#define INTERNER_CHUNK_SHIFT 8
+
+/**
+ * @def INTERNER_ID_LIMIT
+ * @brief The number of ids the chunks of the id table can hold.
+ */
+#define INTERNER_ID_LIMIT                                                      \
+    ((uint_t)INTERNER_CHUNK_FIRST * ((1u << INTERNER_CHUNK_COUNT) - 1))
+
+/**
+ * @def INTERNER_TABLE_HEADER
+ * @brief The aligned size of the header preceding the slots of a table.
+ */
+#define INTERNER_TABLE_HEADER LIQUID_ALLOC_ALIGN(sizeof(interner_table_t))
+
+/**
+ * @def INTERNER_TABLE_MIN
+ * @brief The number of slots of the first table of a shard.
+ */
+#define INTERNER_TABLE_MIN 16
+
+/**
+ * @def INTERNER_SLOTS(table)
+ * @brief Retrieves the slots following the header of a table.
+ */
+#define INTERNER_SLOTS(table)                                                  \
+    ((volatile ullong_t *)((uchar_t *)(table) + INTERNER_TABLE_HEADER))
+
+/**
+ * @def INTERNER_SPIN_LIMIT
+ * @brief The number of times a waiting thread spins before it yields.
+ */
+#define INTERNER_SPIN_LIMIT 128
+
+/**
+ * @brief Gives up the remainder of the time slice of the calling thread.
+ */
+static void
+interner_yield(void)
+{
+#if defined(LIQUID_TARGET_OS_WINDOWS)
+    SwitchToThread();
+#elif defined(LIQUID_TARGET_OS_POSIX_LIKE)
+    sched_yield();
+#endif
+}
+
+/**
+ * @brief Acquires a spin lock.
+ * @param lock The lock.
+ */
+static void
+interner_lock(volatile uint_t *lock)
+{
+    uint_t spins = 0;
+    while (INTERNER_SWAP(lock, 1u))
+    {
+        // Wait until the lock looks free, so that waiting threads do not
+        // keep taking its cache line away from the owner.
+        while (INTERNER_LOAD(lock))
+        {
+            if (++spins < INTERNER_SPIN_LIMIT)
+            {
+                INTERNER_PAUSE();
+            }
+            else
+            {
+                interner_yield();
+                spins = 0;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Releases a spin lock.
+ * @param lock The lock.
+ */
+static void
+interner_unlock(volatile uint_t *lock)
+{
+    INTERNER_STORE(lock, 0u);
+}
+
+/**
+ * @brief Finds the chunk of the id table that holds an id.
+ * @param id The id.
+ * @return The index of the chunk.
+ */
+static uint_t
+interner_chunk_of(uint_t id)
+{
+    return 31 - INTERNER_CHUNK_SHIFT
+           - bitflag_clz32(id + INTERNER_CHUNK_FIRST);
+}
+
+/**
+ * @brief Computes the size of a chunk of the id table in bytes.
+ * @param chunk The index of the chunk.
+ * @return The size or zero if it does not fit into a usize_t.
+ */
+static usize_t
+interner_chunk_size(uint_t chunk)
+{
+    usize_t count = (usize_t)INTERNER_CHUNK_FIRST << chunk;
+    if (count > LIQUID_USIZE_MAX / sizeof(interner_entry_t))
+    {
+        return 0;
+    }
+    return count * sizeof(interner_entry_t);
+}
+
+/**
+ * @brief Retrieves the entry of an id whose chunk exists.
+ *
+ * @param interner The interner.
+ * @param id The id.
+ * @return Pointer to the entry.
+ */
+static interner_entry_t *
+interner_entry(const interner_t *interner, uint_t id)
+{
+    uint_t            chunk = interner_chunk_of(id);
+    interner_entry_t *entries = INTERNER_LOAD(&interner->chunks[chunk]);
+    uint_t            first = INTERNER_CHUNK_FIRST * ((1u << chunk) - 1);
+    return entries + (id - first);
+}
+
+/**
+ * @brief Hands out the next id, adding a chunk to the id table if needed.
+ *
+ * The chunk is added before the id is taken, so every id handed out has
+ * an entry even if an allocation fails.
+ *
+ * @param interner The interner.
+ * @return The id or INTERNER_INVALID on failure.
+ */
+static uint_t
+interner_next_id(interner_t *interner)
+{
+    for (;;)
+    {
+        uint_t id = INTERNER_LOAD(&interner->count);
+        if (id >= INTERNER_ID_LIMIT)
+        {
+            return INTERNER_INVALID;
+        }
+
+        uint_t chunk = interner_chunk_of(id);
+        if (!INTERNER_LOAD(&interner->chunks[chunk]))
+        {
+            interner_lock(&interner->lock);
+            if (!interner->chunks[chunk])
+            {
+                usize_t           size = interner_chunk_size(chunk);
+                interner_entry_t *entries =
+                    size ? alloc_new(interner->allocator, size) : nullptr;
+                if (!entries)
+                {
+                    interner_unlock(&interner->lock);
+                    return INTERNER_INVALID;
+                }
+                // An id is counted before its entry is written, the string
+                // is stored last to mark the entry as ready.
+                usize_t count = size / sizeof(interner_entry_t);
+                for (usize_t i = 0; i < count; ++i)
+                {
+                    entries[i].str = nullptr;
+                }
+                INTERNER_STORE(&interner->chunks[chunk], entries);
+            }
+            interner_unlock(&interner->lock);
+        }
+
+        if (INTERNER_CAS(&interner->count, id, id + 1))
+        {
+            return id;
+        }
+    }
+}
+
+/**
+ * @brief Looks up a string in a table.
+ *
+ * The lookup takes no lock. Slots only ever change from empty to full and
+ * the entry of an id is written before its slot, so a concurrent insertion
+ * can at worst make the lookup miss a string that is being inserted.
+ *
+ * @param interner The interner.
+ * @param table The table, may be nullptr.
+ * @param hash The hash of the string.
+ * @param begin Pointer to the first character.
+ * @param size The length of the string.
+ * @return The id of the string or INTERNER_INVALID if it is not present.
+ */
+static uint_t
+interner_probe(const interner_t *interner, const interner_table_t *table,
+               ullong_t hash, const char_t *begin, usize_t size)
+{
+    if (!table)
+    {
+        return INTERNER_INVALID;
+    }
+
+    const volatile ullong_t *slots = INTERNER_SLOTS(table);
+    usize_t                  mask = table->capacity - 1;
+    uint_t                   tag = (uint_t)(hash >> 32);
+
+    for (usize_t index = (usize_t)(hash >> 6) & mask;;
+         index = (index + 1) & mask)
+    {
+        ullong_t slot = INTERNER_LOAD(&slots[index]);
+        if (!slot)
+        {
+            return INTERNER_INVALID;
+        }
+        if ((uint_t)(slot >> 32) == tag)
+        {
+            uint_t                  id = (uint_t)slot - 1;
+            const interner_entry_t *entry = interner_entry(interner, id);
+            if (entry->hash == hash && entry->size == size
+                && !array_raw_compare(entry->str, entry->str + size, begin,
+                                      begin + size))
+            {
+                return id;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Stores a slot in the first free position of its probe sequence.
+ *
+ * @param table The table.
+ * @param hash The hash of the string.
+ * @param slot The slot.
+ */
+static void
+interner_place(interner_table_t *table, ullong_t hash, ullong_t slot)
+{
+    volatile ullong_t *slots = INTERNER_SLOTS(table);
+    usize_t            mask = table->capacity - 1;
+    usize_t            index = (usize_t)(hash >> 6) & mask;
+
+    while (slots[index])
+    {
+        index = (index + 1) & mask;
+    }
+    INTERNER_STORE(&slots[index], slot);
+}
+
+/**
+ * @brief Replaces the table of a shard by one twice as large.
+ *
+ * The replaced table stays allocated until the interner is released,
+ * because lookups running concurrently may still be reading it.
+ *
+ * @param interner The interner.
+ * @param shard The locked shard.
+ * @return The new table or nullptr if the allocation failed.
+ */
+static interner_table_t *
+interner_grow(interner_t *interner, interner_shard_t *shard)
+{
+    interner_table_t *old = shard->table;
+    usize_t           capacity = old ? old->capacity * 2 : INTERNER_TABLE_MIN;
+
+    interner_table_t *table = alloc_new(
+        interner->allocator,
+        INTERNER_TABLE_HEADER + capacity * sizeof(ullong_t));
+    if (!table)
+    {
+        return nullptr;
+    }
+
+    table->prev = old;
+    table->capacity = capacity;
+    volatile ullong_t *slots = INTERNER_SLOTS(table);
+    for (usize_t i = 0; i < capacity; ++i)
+    {
+        slots[i] = 0;
+    }
+
+    if (old)
+    {
+        const volatile ullong_t *old_slots = INTERNER_SLOTS(old);
+        for (usize_t i = 0; i < old->capacity; ++i)
+        {
+            ullong_t slot = old_slots[i];
+            if (slot)
+            {
+                uint_t id = (uint_t)slot - 1;
+                interner_place(table, interner_entry(interner, id)->hash,
+                               slot);
+            }
+        }
+    }
+
+    INTERNER_STORE(&shard->table, table);
+    return table;
+}
+
+/**
+ * @brief Inserts a string that is not present into a shard.
+ *
+ * @param interner The interner.
+ * @param shard The locked shard.
+ * @param hash The hash of the string.
+ * @param begin Pointer to the first character.
+ * @param size The length of the string.
+ * @return The id of the string or INTERNER_INVALID on failure.
+ */
+static uint_t
+interner_insert(interner_t *interner, interner_shard_t *shard, ullong_t hash,
+                const char_t *begin, usize_t size)
+{
+    // Keep the load factor at 3/4, linear probing degrades beyond it.
+    interner_table_t *table = shard->table;
+    if (!table || (shard->size + 1) * 4 > table->capacity * 3)
+    {
+        table = interner_grow(interner, shard);
+        if (!table)
+        {
+            return INTERNER_INVALID;
+        }
+    }
+
+    char_t *str = arena_alloc(&shard->arena, (size + 1) * sizeof(char_t));
+    if (!str)
+    {
+        return INTERNER_INVALID;
+    }
+    array_raw_move(str, begin, size * sizeof(char_t));
+    str[size] = '\0';
+
+    uint_t id = interner_next_id(interner);
+    if (id == INTERNER_INVALID)
+    {
+        return INTERNER_INVALID;
+    }
+
+    interner_entry_t *entry = interner_entry(interner, id);
+    entry->size = size;
+    entry->hash = hash;
+    INTERNER_STORE(&entry->str, str);
+
+    interner_place(table, hash, hash >> 32 << 32 | (ullong_t)(id + 1u));
+    ++shard->size;
+    return id;
+}
+
+bool
+interner_init(interner_t *interner, const allocator_t *allocator)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(interner, false, "invalid interner pointer")
+
+    interner->block = alloc_new(allocator, INTERNER_BLOCK_SIZE);
+    if (!interner->block)
+    {
+        return false;
+    }
+
+    uptr_t address = (uptr_t)interner->block + INTERNER_CACHE_LINE - 1;
+    interner->shards =
+        (interner_shard_t *)(address & ~(uptr_t)(INTERNER_CACHE_LINE - 1));
+    interner->allocator = allocator;
+    interner->count = 0;
+    interner->lock = 0;
+
+    for (uint_t i = 0; i < INTERNER_SHARD_COUNT; ++i)
+    {
+        interner_shard_t *shard = INTERNER_SHARD(interner, i);
+        shard->table = nullptr;
+        shard->size = 0;
+        shard->lock = 0;
+        arena_init(&shard->arena, allocator, INTERNER_ARENA_CHUNK_SIZE);
+    }
+
+    for (uint_t i = 0; i < INTERNER_CHUNK_COUNT; ++i)
+    {
+        interner->chunks[i] = nullptr;
+    }
+    return true;
+}
+
+void
+interner_free(interner_t *interner)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(interner, , "invalid interner pointer")
+
+    if (!interner->block)
+    {
+        return;
+    }
+
+    for (uint_t i = 0; i < INTERNER_SHARD_COUNT; ++i)
+    {
+        interner_shard_t *shard = INTERNER_SHARD(interner, i);
+        interner_table_t *table = shard->table;
+        while (table)
+        {
+            interner_table_t *prev = table->prev;
+            alloc_delete(interner->allocator, table,
+                         INTERNER_TABLE_HEADER
+                             + table->capacity * sizeof(ullong_t));
+            table = prev;
+        }
+        arena_free(&shard->arena);
+    }
+
+    for (uint_t i = 0; i < INTERNER_CHUNK_COUNT; ++i)
+    {
+        if (interner->chunks[i])
+        {
+            alloc_delete(interner->allocator, interner->chunks[i],
+                         interner_chunk_size(i));
+            interner->chunks[i] = nullptr;
+        }
+    }
+
+    alloc_delete(interner->allocator, interner->block, INTERNER_BLOCK_SIZE);
+    interner->block = nullptr;
+    interner->shards = nullptr;
+    interner->count = 0;
+}
+
+uint_t
+interner_intern(interner_t *interner, const char_t *begin, const char_t *end)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(interner && interner->block,
+                                  INTERNER_INVALID, "invalid interner pointer")
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end && begin <= end,
+                                  INTERNER_INVALID, "invalid string range")
+
+    usize_t           size = (usize_t)(end - begin);
+    ullong_t          hash = hash64(begin, end, 0);
+    interner_shard_t *shard =
+        INTERNER_SHARD(interner, hash & (INTERNER_SHARD_COUNT - 1));
+
+    uint_t id = interner_probe(interner, INTERNER_LOAD(&shard->table), hash,
+                               begin, size);
+    if (id != INTERNER_INVALID)
+    {
+        return id;
+    }
+
+    interner_lock(&shard->lock);
+    // Another thread may have inserted the string since the lookup.
+    id = interner_probe(interner, shard->table, hash, begin, size);
+    if (id == INTERNER_INVALID)
+    {
+        id = interner_insert(interner, shard, hash, begin, size);
+    }
+    interner_unlock(&shard->lock);
+    return id;
+}
+
+uint_t
+interner_find(const interner_t *interner, const char_t *begin,
+              const char_t *end)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(interner && interner->block,
+                                  INTERNER_INVALID, "invalid interner pointer")
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end && begin <= end,
+                                  INTERNER_INVALID, "invalid string range")
+
+    ullong_t                hash = hash64(begin, end, 0);
+    const interner_shard_t *shard =
+        INTERNER_SHARD(interner, hash & (INTERNER_SHARD_COUNT - 1));
+    return interner_probe(interner, INTERNER_LOAD(&shard->table), hash, begin,
+                          (usize_t)(end - begin));
+}
+
+const char_t *
+interner_str(const interner_t *interner, uint_t id, usize_t *size)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(interner, nullptr, "invalid interner pointer")
+
+    if (id >= INTERNER_LOAD(&interner->count))
+    {
+        return nullptr;
+    }
+
+    const interner_entry_t *entry = interner_entry(interner, id);
+    const char_t           *str = INTERNER_LOAD(&entry->str);
+    if (str && size)
+    {
+        *size = entry->size;
+    }
+    return str;
+}
+
+uint_t
+interner_count(const interner_t *interner)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(interner, 0, "invalid interner pointer")
+
+    return INTERNER_LOAD(&interner->count);
+}
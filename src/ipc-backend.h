@@ -0,0 +1,71 @@
+/**
+ * @file ipc-backend.h
+ * @brief The functions of the system backend of the rings.
+ *
+ * ipc.c implements the rings on top of these functions, which put a side
+ * to sleep until another bumps a sequence in the shared region. They are
+ * implemented in ipc-linux.c, ipc-darwin.c and ipc-windows.c.
+ */
+
+#ifndef LIQUID_IPC_BACKEND_H
+#define LIQUID_IPC_BACKEND_H
+
+#include <liquid/ipc.h>
+
+/**
+ * @def IPC_DATA
+ * @brief The side of the consumer, which waits for data.
+ */
+#define IPC_DATA 0
+
+/**
+ * @def IPC_SPACE
+ * @brief The side of the producers, which wait for space.
+ */
+#define IPC_SPACE 1
+
+/**
+ * @brief Creates or opens the system objects of a ring.
+ *
+ * @param ring The ring.
+ * @param name The name of the region of the ring.
+ * @return True on success, false on failure.
+ */
+bool
+ipc_backend_open(ipc_ring_t *ring, const char_t *name);
+
+/**
+ * @brief Closes the system objects of a ring.
+ * @param ring The ring.
+ */
+void
+ipc_backend_close(ipc_ring_t *ring);
+
+/**
+ * @brief Sleeps until a sequence moves on from a value, the timeout
+ *        expires or a spurious wake-up.
+ *
+ * @param ring The ring.
+ * @param side IPC_DATA or IPC_SPACE.
+ * @param seq The sequence of the side.
+ * @param key The value the sequence had before the caller checked the
+ *            ring, it returns at once if the sequence moved on since.
+ * @param timeout The milliseconds to sleep at most, or IPC_INFINITE.
+ */
+void
+ipc_backend_wait(ipc_ring_t *ring, uint_t side, uint_t *seq, uint_t key,
+                 sint_t timeout);
+
+/**
+ * @brief Wakes the sleepers of a side after its sequence was bumped.
+ *
+ * @param ring The ring.
+ * @param side IPC_DATA or IPC_SPACE.
+ * @param seq The sequence of the side.
+ * @param sleepers The number of sleepers.
+ */
+void
+ipc_backend_wake(ipc_ring_t *ring, uint_t side, uint_t *seq,
+                 uint_t sleepers);
+
+#endif // LIQUID_IPC_BACKEND_H
@@ -0,0 +1,64 @@
+#include "ipc-backend.h"
+#include <stdint.h>
+
+/**
+ * @def IPC_ULOCK_SHARED
+ * @brief UL_COMPARE_AND_WAIT_SHARED, waiting on a word of shared memory.
+ */
+#define IPC_ULOCK_SHARED 3
+
+/**
+ * @def IPC_ULOCK_WAKE_ALL
+ * @brief ULF_WAKE_ALL, waking every waiter of a word.
+ */
+#define IPC_ULOCK_WAKE_ALL 0x100
+
+// The futexes of Darwin, which its C++ runtime relies on as well.
+extern int
+__ulock_wait(uint32_t operation, void *address, uint64_t value,
+             uint32_t timeout);
+extern int
+__ulock_wake(uint32_t operation, void *address, uint64_t value);
+
+bool
+ipc_backend_open(ipc_ring_t *ring, const char_t *name)
+{
+    (void)ring;
+    (void)name;
+    return true;
+}
+
+void
+ipc_backend_close(ipc_ring_t *ring)
+{
+    (void)ring;
+}
+
+void
+ipc_backend_wait(ipc_ring_t *ring, uint_t side, uint_t *seq, uint_t key,
+                 sint_t timeout)
+{
+    // A timeout of zero microseconds waits without limit. Longer timeouts
+    // than 32 bits of microseconds wait as long as they can, the caller
+    // waits again until its deadline.
+    (void)ring;
+    (void)side;
+    uint32_t micros = 0;
+    if (timeout >= 0)
+    {
+        micros = (uint_t)timeout > UINT32_MAX / 1000
+                     ? UINT32_MAX
+                     : (uint32_t)timeout * 1000;
+    }
+    __ulock_wait(IPC_ULOCK_SHARED, seq, key, micros);
+}
+
+void
+ipc_backend_wake(ipc_ring_t *ring, uint_t side, uint_t *seq,
+                 uint_t sleepers)
+{
+    (void)ring;
+    (void)side;
+    (void)sleepers;
+    __ulock_wake(IPC_ULOCK_SHARED | IPC_ULOCK_WAKE_ALL, seq, 0);
+}
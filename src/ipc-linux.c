@@ -0,0 +1,43 @@
+#include "ipc-backend.h"
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// The futexes are shared between processes, so they are not private.
+
+bool
+ipc_backend_open(ipc_ring_t *ring, const char_t *name)
+{
+    (void)ring;
+    (void)name;
+    return true;
+}
+
+void
+ipc_backend_close(ipc_ring_t *ring)
+{
+    (void)ring;
+}
+
+void
+ipc_backend_wait(ipc_ring_t *ring, uint_t side, uint_t *seq, uint_t key,
+                 sint_t timeout)
+{
+    (void)ring;
+    (void)side;
+    struct timespec time = {timeout / 1000, timeout % 1000 * 1000000L};
+    syscall(SYS_futex, seq, FUTEX_WAIT, key, timeout < 0 ? nullptr : &time,
+            nullptr, 0);
+}
+
+void
+ipc_backend_wake(ipc_ring_t *ring, uint_t side, uint_t *seq,
+                 uint_t sleepers)
+{
+    (void)ring;
+    (void)side;
+    (void)sleepers;
+    syscall(SYS_futex, seq, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
@@ -0,0 +1,146 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <liquid/exception.h>
+#include <liquid/ipc.h>
+#include <liquid/str.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @def IPC_PATH_MAX
+ * @brief The size of the path of a region, with its slash.
+ */
+#define IPC_PATH_MAX 256
+
+/**
+ * @brief Makes the path of a region, its name after a slash.
+ *
+ * @param path The path.
+ * @param name The name of the region.
+ * @return True on success, false if the name is too long.
+ */
+static bool
+ipc_shm_path(char path[IPC_PATH_MAX], const char_t *name)
+{
+    usize_t size = str_len(name);
+    if (size + 2 > IPC_PATH_MAX)
+    {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    path[0] = '/';
+    str_cpy(path + 1, IPC_PATH_MAX - 1, name, 0);
+    return true;
+}
+
+/**
+ * @brief Maps a region.
+ *
+ * @param shm The region, with its handle and size.
+ * @return True on success, false on failure.
+ */
+static bool
+ipc_shm_map(ipc_shm_t *shm)
+{
+    void *data = mmap(nullptr, shm->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      shm->handle, 0);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    shm->data = data;
+    return true;
+}
+
+bool
+ipc_shm_create(ipc_shm_t *shm, const char_t *name, usize_t size)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(shm && name, false,
+                                  "invalid shm or name pointer")
+
+    char path[IPC_PATH_MAX];
+    if (!ipc_shm_path(path, name))
+    {
+        return false;
+    }
+    shm->data = nullptr;
+    shm->size = size;
+    shm->handle = shm_open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (shm->handle < 0)
+    {
+        return false;
+    }
+    if (ftruncate(shm->handle, (off_t)size) != 0 || !ipc_shm_map(shm))
+    {
+        sint_t error = errno;
+        close(shm->handle);
+        shm_unlink(path);
+        errno = error;
+        return false;
+    }
+    return true;
+}
+
+bool
+ipc_shm_open(ipc_shm_t *shm, const char_t *name)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(shm && name, false,
+                                  "invalid shm or name pointer")
+
+    char path[IPC_PATH_MAX];
+    if (!ipc_shm_path(path, name))
+    {
+        return false;
+    }
+    shm->data = nullptr;
+    shm->handle = shm_open(path, O_RDWR, 0);
+    if (shm->handle < 0)
+    {
+        return false;
+    }
+
+    // A region being created has no size until its creator sets it.
+    struct stat status;
+    bool        ok = fstat(shm->handle, &status) == 0;
+    if (ok && !status.st_size)
+    {
+        errno = EAGAIN;
+        ok = false;
+    }
+    shm->size = ok ? (usize_t)status.st_size : 0;
+    if (!ok || !ipc_shm_map(shm))
+    {
+        sint_t error = errno;
+        close(shm->handle);
+        errno = error;
+        return false;
+    }
+    return true;
+}
+
+void
+ipc_shm_close(ipc_shm_t *shm)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(shm, , "invalid shm pointer")
+
+    if (shm->data)
+    {
+        munmap(shm->data, shm->size);
+        shm->data = nullptr;
+    }
+    if (shm->handle >= 0)
+    {
+        close(shm->handle);
+        shm->handle = -1;
+    }
+}
+
+bool
+ipc_shm_remove(const char_t *name)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(name, false, "invalid name pointer")
+
+    char path[IPC_PATH_MAX];
+    return ipc_shm_path(path, name) && shm_unlink(path) == 0;
+}
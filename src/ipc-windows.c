@@ -0,0 +1,198 @@
+#include "ipc-backend.h"
+#include <liquid/exception.h>
+#include <windows.h>
+
+/**
+ * @def IPC_NAME_MAX
+ * @brief The size of the names of the objects of a region.
+ */
+#define IPC_NAME_MAX 256
+
+/**
+ * @brief Makes the name of an object of a region in the namespace of the
+ *        session.
+ *
+ * @param object The name of the object.
+ * @param name The name of the region.
+ * @param suffix What tells the objects of the region apart.
+ * @return True on success, false if the name is too long.
+ */
+static bool
+ipc_object_name(char_t object[IPC_NAME_MAX], const char_t *name,
+                const char_t *suffix)
+{
+    static const char_t prefix[] = TEXT("Local\\");
+
+    const char_t *parts[] = {prefix, name, suffix};
+    usize_t       size = 0;
+    for (uint_t i = 0; i < 3; ++i)
+    {
+        for (const char_t *c = parts[i]; *c; ++c)
+        {
+            if (size + 1 >= IPC_NAME_MAX)
+            {
+                SetLastError(ERROR_FILENAME_EXCED_RANGE);
+                return false;
+            }
+            object[size++] = *c;
+        }
+    }
+    object[size] = 0;
+    return true;
+}
+
+bool
+ipc_shm_create(ipc_shm_t *shm, const char_t *name, usize_t size)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(shm && name, false,
+                                  "invalid shm or name pointer")
+
+    char_t object[IPC_NAME_MAX];
+    if (!ipc_object_name(object, name, TEXT("")))
+    {
+        return false;
+    }
+    shm->data = nullptr;
+    shm->size = size;
+    shm->handle = CreateFileMapping(
+        INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+        (DWORD)((ullong_t)size >> 32), (DWORD)size, object);
+    if (!shm->handle)
+    {
+        return false;
+    }
+    if (GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        CloseHandle(shm->handle);
+        SetLastError(ERROR_ALREADY_EXISTS);
+        return false;
+    }
+
+    shm->data = MapViewOfFile(shm->handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!shm->data)
+    {
+        DWORD error = GetLastError();
+        CloseHandle(shm->handle);
+        SetLastError(error);
+        return false;
+    }
+    return true;
+}
+
+bool
+ipc_shm_open(ipc_shm_t *shm, const char_t *name)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(shm && name, false,
+                                  "invalid shm or name pointer")
+
+    char_t object[IPC_NAME_MAX];
+    if (!ipc_object_name(object, name, TEXT("")))
+    {
+        return false;
+    }
+    shm->data = nullptr;
+    shm->handle = OpenFileMapping(FILE_MAP_ALL_ACCESS, FALSE, object);
+    if (!shm->handle)
+    {
+        return false;
+    }
+
+    // The size of the view is that of the mapping, rounded up to pages.
+    MEMORY_BASIC_INFORMATION info;
+    shm->data = MapViewOfFile(shm->handle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (!shm->data || !VirtualQuery(shm->data, &info, sizeof(info)))
+    {
+        DWORD error = GetLastError();
+        if (shm->data)
+        {
+            UnmapViewOfFile(shm->data);
+        }
+        CloseHandle(shm->handle);
+        SetLastError(error);
+        return false;
+    }
+    shm->size = info.RegionSize;
+    return true;
+}
+
+void
+ipc_shm_close(ipc_shm_t *shm)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(shm, , "invalid shm pointer")
+
+    if (shm->data)
+    {
+        UnmapViewOfFile(shm->data);
+        shm->data = nullptr;
+    }
+    if (shm->handle)
+    {
+        CloseHandle(shm->handle);
+        shm->handle = nullptr;
+    }
+}
+
+bool
+ipc_shm_remove(const char_t *name)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(name, false, "invalid name pointer")
+
+    return true;
+}
+
+bool
+ipc_backend_open(ipc_ring_t *ring, const char_t *name)
+{
+    // WaitOnAddress only reaches the threads of a process, the sides of a
+    // ring sleep on named semaphores instead.
+    static const char_t *suffixes[] = {TEXT(".data"), TEXT(".space")};
+
+    for (uint_t side = IPC_DATA; side <= IPC_SPACE; ++side)
+    {
+        char_t object[IPC_NAME_MAX];
+        ring->waits[side] = nullptr;
+        if (ipc_object_name(object, name, suffixes[side]))
+        {
+            ring->waits[side] = CreateSemaphore(nullptr, 0, LONG_MAX, object);
+        }
+        if (!ring->waits[side])
+        {
+            ipc_backend_close(ring);
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+ipc_backend_close(ipc_ring_t *ring)
+{
+    for (uint_t side = IPC_DATA; side <= IPC_SPACE; ++side)
+    {
+        if (ring->waits[side])
+        {
+            CloseHandle(ring->waits[side]);
+            ring->waits[side] = nullptr;
+        }
+    }
+}
+
+void
+ipc_backend_wait(ipc_ring_t *ring, uint_t side, uint_t *seq, uint_t key,
+                 sint_t timeout)
+{
+    // A wake between the check and the wait leaves the semaphore released.
+    if (*(volatile uint_t *)seq == key)
+    {
+        WaitForSingleObject(ring->waits[side],
+                            timeout < 0 ? INFINITE : (DWORD)timeout);
+    }
+}
+
+void
+ipc_backend_wake(ipc_ring_t *ring, uint_t side, uint_t *seq,
+                 uint_t sleepers)
+{
+    (void)seq;
+    ReleaseSemaphore(ring->waits[side], (LONG)sleepers, nullptr);
+}
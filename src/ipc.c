@@ -0,0 +1,466 @@
+#include "ipc-backend.h"
+#include <liquid/bitflag.h>
+#include <liquid/exception.h>
+#include <liquid/wheel.h>
+#include <string.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define IPC_LOAD32(ptr) __atomic_load_n(ptr, __ATOMIC_SEQ_CST)
+    #define IPC_LOAD64(ptr) __atomic_load_n(ptr, __ATOMIC_SEQ_CST)
+    #define IPC_STORE64(ptr, value)                                            \
+        __atomic_store_n(ptr, value, __ATOMIC_RELEASE)
+    #define IPC_SWAP64(ptr, value)                                             \
+        __atomic_exchange_n(ptr, value, __ATOMIC_SEQ_CST)
+    #define IPC_CAS64(ptr, expected, desired)                                  \
+        __sync_bool_compare_and_swap(ptr, expected, desired)
+    #define IPC_ADD32(ptr, value)                                              \
+        __atomic_fetch_add(ptr, value, __ATOMIC_SEQ_CST)
+    #if defined(__x86_64__) || defined(__i386__)
+        #define IPC_PAUSE() __builtin_ia32_pause()
+    #else
+        #define IPC_PAUSE() ((void)0)
+    #endif
+#elif defined(_MSC_VER)
+    #include <intrin.h>
+    #define IPC_LOAD32(ptr) (*(volatile const uint_t *)(ptr))
+    #define IPC_LOAD64(ptr) (*(volatile const ullong_t *)(ptr))
+    #define IPC_STORE64(ptr, value) (*(volatile ullong_t *)(ptr) = (value))
+    #define IPC_SWAP64(ptr, value)                                             \
+        _InterlockedExchange64((volatile __int64 *)(ptr), (__int64)(value))
+    #define IPC_CAS64(ptr, expected, desired)                                  \
+        (_InterlockedCompareExchange64((volatile __int64 *)(ptr),              \
+                                       (__int64)(desired),                     \
+                                       (__int64)(expected))                    \
+         == (__int64)(expected))
+    #define IPC_ADD32(ptr, value)                                              \
+        _InterlockedExchangeAdd((volatile long *)(ptr), (long)(value))
+    #define IPC_PAUSE() _mm_pause()
+#else
+    #error "Unsupported compiler"
+#endif
+
+/**
+ * @def IPC_RING_MAGIC
+ * @brief The magic of an initialized ring, "LQIPCRNG".
+ */
+#define IPC_RING_MAGIC 0x474E52435049514Cull
+
+/**
+ * @def IPC_RING_MIN
+ * @brief The smallest capacity of a ring.
+ */
+#define IPC_RING_MIN 4096
+
+/**
+ * @def IPC_RECORD_MESSAGE
+ * @brief The type of the header of a committed message.
+ */
+#define IPC_RECORD_MESSAGE 1
+
+/**
+ * @def IPC_RECORD_PADDING
+ * @brief The type of the header of the space skipped at the end of the
+ *        ring by a message that did not fit there.
+ */
+#define IPC_RECORD_PADDING 2
+
+/**
+ * @def IPC_RECORD_TYPE
+ * @brief The bits of the type of a header, the size takes the high half.
+ */
+#define IPC_RECORD_TYPE 3
+
+/**
+ * @def IPC_SPINS
+ * @brief The checks of a side before it goes to sleep, which saves both
+ *        sides the system calls when the other one is about to catch up.
+ */
+#define IPC_SPINS 256
+
+/**
+ * @brief Computes the space of a message with its header.
+ * @param size The size of the message.
+ * @return The space.
+ */
+static usize_t
+ipc_record_size(usize_t size)
+{
+    return IPC_RING_ALIGN
+           + ((size + IPC_RING_ALIGN - 1) & ~(usize_t)(IPC_RING_ALIGN - 1));
+}
+
+/**
+ * @brief Checks the size in the header of a record, which another process
+ *        wrote, before the record is used.
+ *
+ * A message takes at most half of the ring and a padding the rest of its
+ * end, neither runs past the end.
+ *
+ * @param ring The ring.
+ * @param position The position of the record.
+ * @param value The header of the record.
+ * @return True if the record lies within the ring.
+ */
+static bool
+ipc_record_valid(const ipc_ring_t *ring, ullong_t position, ullong_t value)
+{
+    usize_t  left = ring->capacity
+                    - (usize_t)(position & (ring->capacity - 1));
+    ullong_t size = value >> 32;
+    if ((value & IPC_RECORD_TYPE) == IPC_RECORD_PADDING)
+    {
+        return size == left;
+    }
+    return size <= ring->capacity / 2
+           && ipc_record_size((usize_t)size) <= left;
+}
+
+/**
+ * @brief Finds the header of a record in a ring.
+ *
+ * @param ring The ring.
+ * @param position The position of the record.
+ * @return The header.
+ */
+static ullong_t *
+ipc_record(const ipc_ring_t *ring, ullong_t position)
+{
+    return (ullong_t *)(ring->data + (position & (ring->capacity - 1)));
+}
+
+/**
+ * @brief Computes the deadline of a timeout.
+ * @param timeout The milliseconds, or IPC_INFINITE.
+ * @return The deadline on the clock of the wheels.
+ */
+static ullong_t
+ipc_deadline(sint_t timeout)
+{
+    return timeout < 0
+               ? 0
+               : wheel_clock_nanoseconds() + (ullong_t)timeout * 1000000;
+}
+
+/**
+ * @brief Computes the time left until a deadline.
+ *
+ * @param timeout The timeout the deadline was computed from.
+ * @param deadline The deadline.
+ * @return The milliseconds, rounded up, 0 once it passed, or IPC_INFINITE.
+ */
+static sint_t
+ipc_remaining(sint_t timeout, ullong_t deadline)
+{
+    if (timeout < 0)
+    {
+        return IPC_INFINITE;
+    }
+    ullong_t now = wheel_clock_nanoseconds();
+    return now >= deadline ? 0
+                           : (sint_t)((deadline - now + 999999) / 1000000);
+}
+
+/**
+ * @brief Wakes the sleepers of a side if there are any.
+ *
+ * The caller published what they wait for with a sequentially consistent
+ * operation before, so that either they see it or they are seen here.
+ *
+ * @param ring The ring.
+ * @param side IPC_DATA or IPC_SPACE.
+ * @param seq The sequence of the side.
+ * @param sleepers The sleepers of the side.
+ */
+static void
+ipc_notify(ipc_ring_t *ring, uint_t side, uint_t *seq, uint_t *sleepers)
+{
+    uint_t count = IPC_LOAD32(sleepers);
+    if (count)
+    {
+        IPC_ADD32(seq, 1);
+        ipc_backend_wake(ring, side, seq, count);
+    }
+}
+
+/**
+ * @brief Points a ring at its mapped region and checks it.
+ * @param ring The ring.
+ * @return True if the region holds a ring, false otherwise.
+ */
+static bool
+ipc_ring_map(ipc_ring_t *ring)
+{
+    ring->header = ring->shm.data;
+    ring->data = (uchar_t *)ring->shm.data + sizeof(ipc_ring_header_t);
+    ring->capacity = 0;
+    ring->waits[IPC_DATA] = nullptr;
+    ring->waits[IPC_SPACE] = nullptr;
+    if (ring->shm.size < sizeof(ipc_ring_header_t) + IPC_RING_MIN
+        || IPC_LOAD64(&ring->header->magic) != IPC_RING_MAGIC)
+    {
+        return false;
+    }
+
+    ullong_t capacity = ring->header->capacity;
+    if (capacity < IPC_RING_MIN || capacity & (capacity - 1)
+        || capacity > ring->shm.size - sizeof(ipc_ring_header_t))
+    {
+        return false;
+    }
+    ring->capacity = (usize_t)capacity;
+    return true;
+}
+
+bool
+ipc_ring_create(ipc_ring_t *ring, const char_t *name, usize_t capacity,
+                uint_t flags)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(ring && name, false,
+                                  "invalid ring or name pointer")
+
+    capacity = capacity < IPC_RING_MIN
+                   ? IPC_RING_MIN
+                   : (usize_t)bitflag_next_pow2_64(capacity);
+    if (!ipc_shm_create(&ring->shm, name,
+                        sizeof(ipc_ring_header_t) + capacity))
+    {
+        return false;
+    }
+
+    // The region is zeroed, the magic tells openers it is ready.
+    ipc_ring_header_t *header = ring->shm.data;
+    header->capacity = capacity;
+    header->flags = flags;
+    IPC_STORE64(&header->magic, IPC_RING_MAGIC);
+    if (!ipc_ring_map(ring) || !ipc_backend_open(ring, name))
+    {
+        ipc_shm_close(&ring->shm);
+        ipc_shm_remove(name);
+        return false;
+    }
+    return true;
+}
+
+bool
+ipc_ring_open(ipc_ring_t *ring, const char_t *name)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(ring && name, false,
+                                  "invalid ring or name pointer")
+
+    if (!ipc_shm_open(&ring->shm, name))
+    {
+        return false;
+    }
+    if (!ipc_ring_map(ring) || !ipc_backend_open(ring, name))
+    {
+        ipc_shm_close(&ring->shm);
+        return false;
+    }
+    return true;
+}
+
+void
+ipc_ring_close(ipc_ring_t *ring)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(ring, , "invalid ring pointer")
+
+    ipc_backend_close(ring);
+    ipc_shm_close(&ring->shm);
+    ring->header = nullptr;
+    ring->data = nullptr;
+}
+
+void *
+ipc_ring_reserve(ipc_ring_t *ring, usize_t size, sint_t timeout)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(ring, nullptr, "invalid ring pointer")
+    LIQUID_EXCEPTION_RAISE_IF(ipc_record_size(size) > ring->capacity / 2,
+                              nullptr, "message too large for the ring")
+
+    ipc_ring_header_t *header = ring->header;
+    usize_t            record = ipc_record_size(size);
+    ullong_t           deadline = ipc_deadline(timeout);
+    for (uint_t spins = 0;; ++spins)
+    {
+        // A message that does not fit before the end of the ring starts
+        // over at its beginning, the rest of the end is skipped.
+        ullong_t head = IPC_LOAD64(&header->head);
+        usize_t  offset = (usize_t)(head & (ring->capacity - 1));
+        usize_t  padding =
+            offset + record > ring->capacity ? ring->capacity - offset : 0;
+        ullong_t end = head + padding + record;
+        if (end - IPC_LOAD64(&header->tail) <= ring->capacity)
+        {
+            if (header->flags & IPC_SINGLE_PRODUCER)
+            {
+                IPC_STORE64(&header->head, end);
+            }
+            else if (!IPC_CAS64(&header->head, head, end))
+            {
+                continue;
+            }
+            if (padding)
+            {
+                IPC_STORE64(ipc_record(ring, head),
+                            (ullong_t)padding << 32 | IPC_RECORD_PADDING);
+            }
+
+            // The size goes into the header already, without a type the
+            // consumer does not take it yet.
+            ullong_t *message = ipc_record(ring, head + padding);
+            IPC_STORE64(message, (ullong_t)size << 32);
+            return message + 1;
+        }
+
+        sint_t remaining = ipc_remaining(timeout, deadline);
+        if (!remaining)
+        {
+            return nullptr;
+        }
+        if (spins < IPC_SPINS)
+        {
+            IPC_PAUSE();
+            continue;
+        }
+        uint_t key = IPC_LOAD32(&header->space_seq);
+        IPC_ADD32(&header->space_sleepers, 1);
+        if (end - IPC_LOAD64(&header->tail) > ring->capacity)
+        {
+            ipc_backend_wait(ring, IPC_SPACE, &header->space_seq, key,
+                             remaining);
+        }
+        IPC_ADD32(&header->space_sleepers, (uint_t)-1);
+    }
+}
+
+void
+ipc_ring_commit(ipc_ring_t *ring, void *message)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(ring && message, ,
+                                  "invalid ring or message pointer")
+
+    ullong_t *header = (ullong_t *)message - 1;
+    IPC_SWAP64(header, *header | IPC_RECORD_MESSAGE);
+    ipc_notify(ring, IPC_DATA, &ring->header->data_seq,
+               &ring->header->data_sleepers);
+}
+
+/**
+ * @brief Gives the space of the record at the tail back to the producers,
+ *        zeroed so that no header is mistaken in it later.
+ *
+ * @param ring The ring.
+ * @param header The header of the record.
+ * @param written The bytes of the record that are not zero.
+ * @param size The space of the record.
+ */
+static void
+ipc_ring_advance(ipc_ring_t *ring, ullong_t *header, usize_t written,
+                 usize_t size)
+{
+    memset(header, 0, written);
+    IPC_SWAP64(&ring->header->tail, ring->header->tail + size);
+    ipc_notify(ring, IPC_SPACE, &ring->header->space_seq,
+               &ring->header->space_sleepers);
+}
+
+const void *
+ipc_ring_peek(ipc_ring_t *ring, usize_t *size, sint_t timeout)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(ring && size, nullptr,
+                                  "invalid ring or size pointer")
+
+    ipc_ring_header_t *header = ring->header;
+    ullong_t           deadline = ipc_deadline(timeout);
+    for (uint_t spins = 0;; ++spins)
+    {
+        ullong_t  tail = header->tail;
+        ullong_t *record = ipc_record(ring, tail);
+        ullong_t  value = IPC_LOAD64(record);
+        LIQUID_EXCEPTION_RAISE_IF((value & IPC_RECORD_TYPE)
+                                      && !ipc_record_valid(ring, tail, value),
+                                  nullptr, "corrupt record in the ring")
+        if ((value & IPC_RECORD_TYPE) == IPC_RECORD_PADDING)
+        {
+            // The padding was free space, only its header is not zero.
+            ipc_ring_advance(ring, record, sizeof(*record),
+                             (usize_t)(value >> 32));
+            continue;
+        }
+        if ((value & IPC_RECORD_TYPE) == IPC_RECORD_MESSAGE)
+        {
+            *size = (usize_t)(value >> 32);
+            return record + 1;
+        }
+
+        sint_t remaining = ipc_remaining(timeout, deadline);
+        if (!remaining)
+        {
+            return nullptr;
+        }
+        if (spins < IPC_SPINS)
+        {
+            IPC_PAUSE();
+            continue;
+        }
+        uint_t key = IPC_LOAD32(&header->data_seq);
+        IPC_ADD32(&header->data_sleepers, 1);
+        if (!(IPC_LOAD64(record) & IPC_RECORD_TYPE))
+        {
+            ipc_backend_wait(ring, IPC_DATA, &header->data_seq, key,
+                             remaining);
+        }
+        IPC_ADD32(&header->data_sleepers, (uint_t)-1);
+    }
+}
+
+void
+ipc_ring_release(ipc_ring_t *ring)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(ring, , "invalid ring pointer")
+
+    ullong_t  tail = ring->header->tail;
+    ullong_t *record = ipc_record(ring, tail);
+    ullong_t  value = *record;
+    LIQUID_EXCEPTION_RAISE_IF((value & IPC_RECORD_TYPE) != IPC_RECORD_MESSAGE,
+                              , "no message to release")
+    LIQUID_EXCEPTION_RAISE_IF_NOT(ipc_record_valid(ring, tail, value), ,
+                                  "corrupt record in the ring")
+
+    usize_t size = ipc_record_size((usize_t)(value >> 32));
+    ipc_ring_advance(ring, record, size, size);
+}
+
+bool
+ipc_ring_send(ipc_ring_t *ring, const void *message, usize_t size,
+              sint_t timeout)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(message || !size, false,
+                                  "invalid message pointer")
+
+    void *space = ipc_ring_reserve(ring, size, timeout);
+    if (!space)
+    {
+        return false;
+    }
+    memcpy(space, message, size);
+    ipc_ring_commit(ring, space);
+    return true;
+}
+
+bool
+ipc_ring_receive(ipc_ring_t *ring, void *buffer, usize_t size,
+                 usize_t *received, sint_t timeout)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT((buffer || !size) && received, false,
+                                  "invalid buffer or size pointer")
+
+    const void *message = ipc_ring_peek(ring, received, timeout);
+    if (!message || *received > size)
+    {
+        return false;
+    }
+    memcpy(buffer, message, *received);
+    ipc_ring_release(ring);
+    return true;
+}
@@ -0,0 +1,994 @@
+#include <liquid/bitflag.h>
+#include <liquid/checked.h>
+#include <liquid/exception.h>
+#include <liquid/lz4.h>
+#include <liquid/serial.h>
+#include <string.h>
+
+/**
+ * @def LZ4_MIN_MATCH
+ * @brief The length of the shortest back reference.
+ */
+#define LZ4_MIN_MATCH 4
+
+/**
+ * @def LZ4_LAST_LITERALS
+ * @brief The number of bytes at the end of a block that are always
+ *        literals.
+ */
+#define LZ4_LAST_LITERALS 5
+
+/**
+ * @def LZ4_MATCH_LIMIT
+ * @brief The distance from the end of a block the last back reference has
+ *        to start at.
+ */
+#define LZ4_MATCH_LIMIT 12
+
+/**
+ * @def LZ4_FAST_HASH_BITS
+ * @brief The size of the hash table of the fast level in bits, small
+ *        enough to stay in the L1 cache.
+ */
+#define LZ4_FAST_HASH_BITS 12
+
+/**
+ * @def LZ4_CHAIN_HASH_BITS
+ * @brief The size of the hash table of the chained levels in bits.
+ */
+#define LZ4_CHAIN_HASH_BITS 15
+
+/**
+ * @def LZ4_CHAIN_SIZE
+ * @brief The number of chain links, one per position of the window.
+ */
+#define LZ4_CHAIN_SIZE (LZ4_DISTANCE_MAX + 1)
+
+/**
+ * @def LZ4_SKIP_TRIGGER
+ * @brief The base-two logarithm of the number of failed probes after which
+ *        the fast level advances by one more byte per probe.
+ */
+#define LZ4_SKIP_TRIGGER 6
+
+/**
+ * @def LZ4_FRAME_MAGIC
+ * @brief The first four bytes of a frame.
+ */
+#define LZ4_FRAME_MAGIC 0x184D2204u
+
+/**
+ * @def LZ4_FRAME_BLOCK_ID
+ * @brief The block size code of LZ4_FRAME_BLOCK_SIZE.
+ */
+#define LZ4_FRAME_BLOCK_ID 5
+
+/**
+ * @def LZ4_FRAME_UNCOMPRESSED
+ * @brief The bit of the block size marking a block stored as is.
+ */
+#define LZ4_FRAME_UNCOMPRESSED 0x80000000u
+
+/**
+ * @def LZ4_FRAME_VERSION
+ * @brief The version bits of the frame flags.
+ */
+#define LZ4_FRAME_VERSION 0x40
+
+/**
+ * @def LZ4_FRAME_INDEPENDENT
+ * @brief The frame flag of blocks that do not refer to earlier blocks.
+ */
+#define LZ4_FRAME_INDEPENDENT 0x20
+
+/**
+ * @def LZ4_FRAME_BLOCK_CHECKSUM
+ * @brief The frame flag of blocks followed by their hash32.
+ */
+#define LZ4_FRAME_BLOCK_CHECKSUM 0x10
+
+/**
+ * @def LZ4_FRAME_CONTENT_SIZE
+ * @brief The frame flag of headers holding the size of the content.
+ */
+#define LZ4_FRAME_CONTENT_SIZE 0x08
+
+/**
+ * @def LZ4_FRAME_CONTENT_CHECKSUM
+ * @brief The frame flag of frames ending with the hash32 of the content.
+ */
+#define LZ4_FRAME_CONTENT_CHECKSUM 0x04
+
+/**
+ * @def LZ4_FRAME_DICTIONARY
+ * @brief The frame flag of headers naming a dictionary.
+ */
+#define LZ4_FRAME_DICTIONARY 0x01
+
+/**
+ * @brief Hashes the four bytes at a position.
+ *
+ * @param src The position.
+ * @param bits The size of the hash table in bits.
+ * @return The index into the hash table.
+ */
+static inline uint_t
+lz4_hash(const uchar_t *src, uint_t bits)
+{
+    return (serial_load_le32(src) * 2654435761u) >> (32 - bits);
+}
+
+/**
+ * @brief Hashes the bytes at a position for the fast level.
+ *
+ * On 64-bit targets five bytes are hashed, which costs the same as four
+ * and turns up fewer candidates that fail to match.
+ *
+ * @param src The position, followed by at least eight bytes.
+ * @return The index into the hash table.
+ */
+static inline uint_t
+lz4_hash_fast(const uchar_t *src)
+{
+#if LIQUID_TARGET_PLATFORM == 64
+    return (uint_t)(((serial_load_le64(src) << 24) * 889523592379ull)
+                    >> (64 - LZ4_FAST_HASH_BITS));
+#else
+    return lz4_hash(src, LZ4_FAST_HASH_BITS);
+#endif
+}
+
+/**
+ * @brief Counts the bytes two positions have in common.
+ *
+ * @param src The later position.
+ * @param match The earlier position.
+ * @param limit The end of the bytes that may be compared at src.
+ * @return The number of equal bytes.
+ */
+static inline usize_t
+lz4_count(const uchar_t *src, const uchar_t *match, const uchar_t *limit)
+{
+    const uchar_t *start = src;
+    while (limit - src >= 8)
+    {
+        ullong_t diff = serial_load_le64(src) ^ serial_load_le64(match);
+        if (diff)
+        {
+            return (usize_t)(src - start) + bitflag_ctz64(diff) / 8;
+        }
+        src += 8;
+        match += 8;
+    }
+    while (src < limit && *src == *match)
+    {
+        ++src;
+        ++match;
+    }
+    return (usize_t)(src - start);
+}
+
+/**
+ * @brief Writes the continuation bytes of a length.
+ *
+ * @param dest The destination.
+ * @param len The length minus the 15 held by the token.
+ * @return Pointer past the written bytes.
+ */
+static uchar_t *
+lz4_write_length(uchar_t *dest, usize_t len)
+{
+    for (; len >= 255; len -= 255)
+    {
+        *dest++ = 255;
+    }
+    *dest++ = (uchar_t)len;
+    return dest;
+}
+
+/**
+ * @brief Writes a sequence of literals followed by a back reference.
+ *
+ * @param dest The destination.
+ * @param dest_end The end of the destination.
+ * @param literals The first literal.
+ * @param literal_len The number of literals.
+ * @param distance The distance of the back reference.
+ * @param match_len The length of the back reference, zero for the literals
+ *                  that end a block.
+ * @return Pointer past the sequence, or nullptr if it does not fit.
+ */
+static inline uchar_t *
+lz4_emit(uchar_t *dest, uchar_t *dest_end, const uchar_t *literals,
+         usize_t literal_len, usize_t distance, usize_t match_len)
+{
+    usize_t size = 2 + literal_len + literal_len / 255;
+    if (match_len)
+    {
+        size += 3 + (match_len - LZ4_MIN_MATCH) / 255;
+    }
+    if ((usize_t)(dest_end - dest) < size)
+    {
+        return nullptr;
+    }
+
+    uchar_t *token = dest++;
+    *token = (uchar_t)((literal_len < 15 ? literal_len : 15) << 4);
+    if (literal_len >= 15)
+    {
+        dest = lz4_write_length(dest, literal_len - 15);
+    }
+    memcpy(dest, literals, literal_len);
+    dest += literal_len;
+    if (!match_len)
+    {
+        return dest;
+    }
+
+    serial_store_le16(dest, (ushort_t)distance);
+    dest += 2;
+    usize_t code = match_len - LZ4_MIN_MATCH;
+    *token |= (uchar_t)(code < 15 ? code : 15);
+    return code >= 15 ? lz4_write_length(dest, code - 15) : dest;
+}
+
+/**
+ * @brief Compresses a block with single hash table probes.
+ * @see lz4_compress
+ */
+static uchar_t *
+lz4_compress_fast(lz4_state_t *state, uchar_t *dest, uchar_t *dest_end,
+                  const uchar_t *begin, const uchar_t *end)
+{
+    uint_t        *table = state->head;
+    const uchar_t *anchor = begin;
+
+    if (end - begin > LZ4_MATCH_LIMIT)
+    {
+        const uchar_t *match_limit = end - LZ4_MATCH_LIMIT;
+        const uchar_t *match_end = end - LZ4_LAST_LITERALS;
+        const uchar_t *src = begin + 1;
+        memset(table, 0, sizeof(uint_t) << LZ4_FAST_HASH_BITS);
+
+        while (src <= match_limit)
+        {
+            // Probe with growing steps while no match turns up, so that
+            // incompressible data is skipped over quickly.
+            const uchar_t *match = nullptr;
+            uint_t         attempts = 1u << LZ4_SKIP_TRIGGER;
+            while (src <= match_limit)
+            {
+                uint_t hash = lz4_hash_fast(src);
+                match = begin + table[hash];
+                table[hash] = (uint_t)(src - begin);
+                if (src - match <= LZ4_DISTANCE_MAX
+                    && serial_load_le32(match) == serial_load_le32(src))
+                {
+                    break;
+                }
+                src += attempts++ >> LZ4_SKIP_TRIGGER;
+            }
+            if (src > match_limit)
+            {
+                break;
+            }
+
+            while (src > anchor && match > begin && src[-1] == match[-1])
+            {
+                --src;
+                --match;
+            }
+
+            usize_t len = LZ4_MIN_MATCH
+                          + lz4_count(src + LZ4_MIN_MATCH,
+                                      match + LZ4_MIN_MATCH, match_end);
+            dest = lz4_emit(dest, dest_end, anchor, (usize_t)(src - anchor),
+                            (usize_t)(src - match), len);
+            if (!dest)
+            {
+                return nullptr;
+            }
+            src += len;
+            anchor = src;
+
+            // Index a position inside the match, repeats often start there.
+            if (src <= match_limit)
+            {
+                table[lz4_hash_fast(src - 2)] = (uint_t)(src - 2 - begin);
+            }
+        }
+    }
+    return lz4_emit(dest, dest_end, anchor, (usize_t)(end - anchor), 0, 0);
+}
+
+/**
+ * @brief Adds the positions up to a position to the hash chains.
+ *
+ * @param state The compressor.
+ * @param begin The first byte of the block.
+ * @param next The first position not added yet, updated.
+ * @param pos The position to stop at.
+ */
+static void
+lz4_insert(lz4_state_t *state, const uchar_t *begin, uint_t *next, uint_t pos)
+{
+    for (; *next < pos; ++*next)
+    {
+        uint_t hash = lz4_hash(begin + *next, LZ4_CHAIN_HASH_BITS);
+        uint_t delta = *next - state->head[hash];
+        state->chain[*next % LZ4_CHAIN_SIZE] =
+            (ushort_t)(delta < LZ4_DISTANCE_MAX ? delta : LZ4_DISTANCE_MAX);
+        state->head[hash] = *next;
+    }
+}
+
+/**
+ * @brief Finds the longest back reference at a position along its chain.
+ *
+ * @param state The compressor.
+ * @param begin The first byte of the block.
+ * @param src The position, whose predecessors are in the chains.
+ * @param match_end The end of the bytes a reference may cover.
+ * @param match Receives the start of the reference.
+ * @return The length of the reference, zero if there is none.
+ */
+static usize_t
+lz4_find(const lz4_state_t *state, const uchar_t *begin, const uchar_t *src,
+         const uchar_t *match_end, const uchar_t **match)
+{
+    uint_t  pos = (uint_t)(src - begin);
+    uint_t  candidate = state->head[lz4_hash(src, LZ4_CHAIN_HASH_BITS)];
+    uint_t  attempts = 1u << (state->level - 1);
+    usize_t best = 0;
+
+    while (attempts-- && candidate < pos && pos - candidate <= LZ4_DISTANCE_MAX)
+    {
+        const uchar_t *other = begin + candidate;
+        if (other[best] == src[best]
+            && serial_load_le32(other) == serial_load_le32(src))
+        {
+            usize_t len = LZ4_MIN_MATCH
+                          + lz4_count(src + LZ4_MIN_MATCH,
+                                      other + LZ4_MIN_MATCH, match_end);
+            if (len > best)
+            {
+                best = len;
+                *match = other;
+            }
+        }
+
+        uint_t delta = state->chain[candidate % LZ4_CHAIN_SIZE];
+        if (!delta || delta > candidate)
+        {
+            break;
+        }
+        candidate -= delta;
+    }
+    return best;
+}
+
+/**
+ * @brief Compresses a block with hash chains.
+ *
+ * From level 3 on, a match is only taken if the next position does not
+ * start a longer one.
+ *
+ * @see lz4_compress
+ */
+static uchar_t *
+lz4_compress_chain(lz4_state_t *state, uchar_t *dest, uchar_t *dest_end,
+                   const uchar_t *begin, const uchar_t *end)
+{
+    const uchar_t *anchor = begin;
+
+    if (end - begin > LZ4_MATCH_LIMIT)
+    {
+        const uchar_t *match_limit = end - LZ4_MATCH_LIMIT;
+        const uchar_t *match_end = end - LZ4_LAST_LITERALS;
+        const uchar_t *src = begin;
+        uint_t         next = 0;
+        memset(state->head, 0, sizeof(uint_t) << LZ4_CHAIN_HASH_BITS);
+
+        while (src <= match_limit)
+        {
+            const uchar_t *match = nullptr;
+            lz4_insert(state, begin, &next, (uint_t)(src - begin));
+            usize_t len = lz4_find(state, begin, src, match_end, &match);
+            if (!len)
+            {
+                ++src;
+                continue;
+            }
+
+            while (state->level >= 3 && src < match_limit)
+            {
+                const uchar_t *later = nullptr;
+                lz4_insert(state, begin, &next, (uint_t)(src + 1 - begin));
+                usize_t later_len =
+                    lz4_find(state, begin, src + 1, match_end, &later);
+                if (later_len <= len)
+                {
+                    break;
+                }
+                ++src;
+                len = later_len;
+                match = later;
+            }
+
+            while (src > anchor && match > begin && src[-1] == match[-1])
+            {
+                --src;
+                --match;
+                ++len;
+            }
+
+            dest = lz4_emit(dest, dest_end, anchor, (usize_t)(src - anchor),
+                            (usize_t)(src - match), len);
+            if (!dest)
+            {
+                return nullptr;
+            }
+            src += len;
+            anchor = src;
+        }
+    }
+    return lz4_emit(dest, dest_end, anchor, (usize_t)(end - anchor), 0, 0);
+}
+
+/**
+ * @brief Reads the continuation bytes of a length.
+ *
+ * @param src The first continuation byte.
+ * @param end The end of the block.
+ * @param len The length, to which the bytes are added.
+ * @return Pointer past the length, or nullptr if the block ends inside it.
+ */
+static const uchar_t *
+lz4_read_length(const uchar_t *src, const uchar_t *end, usize_t *len)
+{
+    uint_t byte;
+    do
+    {
+        // A length beyond the input size is rejected later on, the check
+        // only keeps the sum from wrapping.
+        if (src == end || *len > LIQUID_USIZE_MAX / 2)
+        {
+            return nullptr;
+        }
+        byte = *src++;
+        *len += byte;
+    } while (byte == 255);
+    return src;
+}
+
+/**
+ * @brief Computes the size of the head table of a level.
+ * @param level The compression level.
+ * @return The size in bytes.
+ */
+static usize_t
+lz4_head_size(uint_t level)
+{
+    return sizeof(uint_t)
+           << (level == LZ4_LEVEL_FAST ? LZ4_FAST_HASH_BITS
+                                       : LZ4_CHAIN_HASH_BITS);
+}
+
+bool
+lz4_init(lz4_state_t *state, uint_t level, const allocator_t *allocator)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(state, false, "invalid state pointer")
+    LIQUID_EXCEPTION_RAISE_IF(level < LZ4_LEVEL_FAST || level > LZ4_LEVEL_MAX,
+                              false, "invalid compression level")
+
+    state->allocator = allocator;
+    state->level = level;
+    state->chain = nullptr;
+    state->head = (uint_t *)alloc_new(allocator, lz4_head_size(level));
+    if (!state->head)
+    {
+        return false;
+    }
+
+    if (level > LZ4_LEVEL_FAST)
+    {
+        state->chain = (ushort_t *)alloc_new(
+            allocator, LZ4_CHAIN_SIZE * sizeof(ushort_t));
+        if (!state->chain)
+        {
+            alloc_delete(allocator, state->head, lz4_head_size(level));
+            state->head = nullptr;
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+lz4_free(lz4_state_t *state)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(state, , "invalid state pointer")
+
+    if (state->head)
+    {
+        alloc_delete(state->allocator, state->head,
+                     lz4_head_size(state->level));
+    }
+    if (state->chain)
+    {
+        alloc_delete(state->allocator, state->chain,
+                     LZ4_CHAIN_SIZE * sizeof(ushort_t));
+    }
+    state->head = nullptr;
+    state->chain = nullptr;
+}
+
+usize_t
+lz4_bound(usize_t size)
+{
+    return saturating_add_usize(size, size / 255 + 16);
+}
+
+uchar_t *
+lz4_compress(lz4_state_t *state, uchar_t *dest, uchar_t *dest_end,
+             const uchar_t *begin, const uchar_t *end)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(state && state->head, nullptr,
+                                  "invalid state pointer")
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && dest_end >= dest, nullptr,
+                                  "invalid destination range")
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end >= begin, nullptr,
+                                  "invalid input range")
+    LIQUID_EXCEPTION_RAISE_IF((usize_t)(end - begin) > LZ4_INPUT_MAX, nullptr,
+                              "input exceeds LZ4_INPUT_MAX")
+
+    return state->level == LZ4_LEVEL_FAST
+               ? lz4_compress_fast(state, dest, dest_end, begin, end)
+               : lz4_compress_chain(state, dest, dest_end, begin, end);
+}
+
+uchar_t *
+lz4_decompress(const uchar_t *history, uchar_t *dest, uchar_t *dest_end,
+               const uchar_t *begin, const uchar_t *end)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && dest_end >= dest, nullptr,
+                                  "invalid destination range")
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end >= begin, nullptr,
+                                  "invalid input range")
+
+    const uchar_t *low = history ? history : dest;
+    const uchar_t *src = begin;
+    while (src < end)
+    {
+        uint_t  token = *src++;
+        usize_t len = token >> 4;
+        if (len < 15 && end - src >= 18 && dest_end - dest >= 48)
+        {
+            // A short run with room to spare on both sides, which cannot
+            // end the block, is copied sixteen bytes at once.
+            memcpy(dest, src, 16);
+        }
+        else
+        {
+            if (len == 15)
+            {
+                src = lz4_read_length(src, end, &len);
+                if (!src)
+                {
+                    return nullptr;
+                }
+            }
+            if (len > (usize_t)(end - src) || len > (usize_t)(dest_end - dest))
+            {
+                return nullptr;
+            }
+            memcpy(dest, src, len);
+            if (len == (usize_t)(end - src))
+            {
+                return dest + len;
+            }
+            if (end - src - len < 2)
+            {
+                return nullptr;
+            }
+        }
+        dest += len;
+        src += len;
+
+        usize_t distance = serial_load_le16(src);
+        src += 2;
+        if (!distance || distance > (usize_t)(dest - low))
+        {
+            return nullptr;
+        }
+
+        const uchar_t *match = dest - distance;
+        len = token & 15;
+        if (len < 15 && distance >= 8 && dest_end - dest >= 32)
+        {
+            // A match of at most eighteen bytes is copied in three chunks,
+            // each of which reads only bytes already written.
+            memcpy(dest, match, 8);
+            memcpy(dest + 8, match + 8, 8);
+            memcpy(dest + 16, match + 16, 8);
+            dest += len + LZ4_MIN_MATCH;
+            continue;
+        }
+        if (len == 15)
+        {
+            src = lz4_read_length(src, end, &len);
+            if (!src)
+            {
+                return nullptr;
+            }
+        }
+        len += LZ4_MIN_MATCH;
+        usize_t room = (usize_t)(dest_end - dest);
+        if (len > room)
+        {
+            return nullptr;
+        }
+
+        if (distance >= 16 && room - len >= 16)
+        {
+            for (usize_t i = 0; i < len; i += 16)
+            {
+                memcpy(dest + i, match + i, 16);
+            }
+        }
+        else if (room - len >= 16)
+        {
+            // Repeat a short pattern until it spans eight bytes, then copy
+            // in chunks that cannot overlap their source.
+            usize_t period = distance;
+            usize_t i = 0;
+            if (period < 8)
+            {
+                while (period < 8)
+                {
+                    period *= 2;
+                }
+                for (; i < period; ++i)
+                {
+                    dest[i] = match[i];
+                }
+            }
+            for (; i < len; i += 8)
+            {
+                memcpy(dest + i, dest + i - period, 8);
+            }
+        }
+        else
+        {
+            for (usize_t i = 0; i < len; ++i)
+            {
+                dest[i] = match[i];
+            }
+        }
+        dest += len;
+    }
+
+    // Blocks end with literals, even if there are none.
+    return nullptr;
+}
+
+usize_t
+lz4_frame_bound(usize_t size)
+{
+    usize_t blocks = size / LZ4_FRAME_BLOCK_SIZE
+                     + (size % LZ4_FRAME_BLOCK_SIZE != 0);
+    return saturating_add_usize(size, blocks * 4 + 7 + LZ4_FRAME_END_SIZE);
+}
+
+/**
+ * @brief Writes a block of a frame into a bounded destination.
+ *
+ * @param state The compressor.
+ * @param dest The destination.
+ * @param dest_end The end of the destination.
+ * @param begin The first byte of the content.
+ * @param end The end of the content.
+ * @return Pointer past the block, or nullptr if it does not fit.
+ */
+static uchar_t *
+lz4_frame_put(lz4_state_t *state, uchar_t *dest, uchar_t *dest_end,
+              const uchar_t *begin, const uchar_t *end)
+{
+    usize_t size = (usize_t)(end - begin);
+    if (!size)
+    {
+        return dest;
+    }
+    if (dest_end - dest < 4)
+    {
+        return nullptr;
+    }
+
+    // The compressed block is kept only if it is smaller than the content.
+    uchar_t *data = dest + 4;
+    usize_t  room = (usize_t)(dest_end - data);
+    uchar_t *limit = data + (room < size ? room : size - 1);
+    uchar_t *out = lz4_compress(state, data, limit, begin, end);
+    if (out)
+    {
+        serial_store_le32(dest, (uint_t)(out - data));
+        return out;
+    }
+    if (room < size)
+    {
+        return nullptr;
+    }
+    serial_store_le32(dest, (uint_t)size | LZ4_FRAME_UNCOMPRESSED);
+    memcpy(data, begin, size);
+    return data + size;
+}
+
+uchar_t *
+lz4_frame_compress(lz4_state_t *state, uchar_t *dest, uchar_t *dest_end,
+                   const uchar_t *begin, const uchar_t *end)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(state && state->head, nullptr,
+                                  "invalid state pointer")
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && dest_end >= dest, nullptr,
+                                  "invalid destination range")
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end >= begin, nullptr,
+                                  "invalid input range")
+
+    if (dest_end - dest < 7)
+    {
+        return nullptr;
+    }
+    dest = lz4_frame_begin(dest);
+
+    for (const uchar_t *src = begin; src < end;)
+    {
+        const uchar_t *next = end - src > LZ4_FRAME_BLOCK_SIZE
+                                  ? src + LZ4_FRAME_BLOCK_SIZE
+                                  : end;
+        dest = lz4_frame_put(state, dest, dest_end, src, next);
+        if (!dest)
+        {
+            return nullptr;
+        }
+        src = next;
+    }
+
+    if (dest_end - dest < LZ4_FRAME_END_SIZE)
+    {
+        return nullptr;
+    }
+    return lz4_frame_end(dest, hash32(begin, end, 0));
+}
+
+/**
+ * @brief Decodes the next block of a frame into a bounded destination.
+ *
+ * @param frame The decoding state of the frame.
+ * @param history The earliest byte blocks of linked frames may refer to.
+ * @param dest The destination.
+ * @param dest_end The end of the destination.
+ * @param begin The first byte of the block.
+ * @return Pointer past the decoded data, dest at the end of the frame, or
+ *         nullptr on errors.
+ * @see lz4_frame_decode
+ */
+static uchar_t *
+lz4_frame_decode_into(lz4_frame_t *frame, const uchar_t *history,
+                      uchar_t *dest, uchar_t *dest_end, const uchar_t *begin)
+{
+    uint_t         word = serial_load_le32(begin);
+    const uchar_t *data = begin + 4;
+    if (!word)
+    {
+        if (frame->flags & LZ4_FRAME_CONTENT_CHECKSUM
+            && serial_load_le32(data) != hash32_final(&frame->checksum))
+        {
+            return nullptr;
+        }
+        if (frame->content_size != LIQUID_ULLONG_MAX
+            && frame->content_size != frame->decoded)
+        {
+            return nullptr;
+        }
+        return dest;
+    }
+
+    usize_t size = word & ~LZ4_FRAME_UNCOMPRESSED;
+    if (frame->flags & LZ4_FRAME_BLOCK_CHECKSUM
+        && hash32(data, data + size, 0) != serial_load_le32(data + size))
+    {
+        return nullptr;
+    }
+
+    if ((usize_t)(dest_end - dest) > frame->block_size)
+    {
+        dest_end = dest + frame->block_size;
+    }
+
+    uchar_t *out;
+    if (word & LZ4_FRAME_UNCOMPRESSED)
+    {
+        if (size > (usize_t)(dest_end - dest))
+        {
+            return nullptr;
+        }
+        memcpy(dest, data, size);
+        out = dest + size;
+    }
+    else
+    {
+        out = lz4_decompress(frame->flags & LZ4_FRAME_INDEPENDENT ? nullptr
+                                                                  : history,
+                             dest, dest_end, data, data + size);
+        // An empty block would read as the end of the frame.
+        if (!out || out == dest)
+        {
+            return nullptr;
+        }
+    }
+
+    if (frame->flags & LZ4_FRAME_CONTENT_CHECKSUM)
+    {
+        hash32_update(&frame->checksum, dest, out);
+    }
+    frame->decoded += (ullong_t)(out - dest);
+    return out;
+}
+
+uchar_t *
+lz4_frame_decompress(uchar_t *dest, uchar_t *dest_end, const uchar_t *begin,
+                     const uchar_t *end, const uchar_t **next)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && dest_end >= dest, nullptr,
+                                  "invalid destination range")
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end >= begin, nullptr,
+                                  "invalid input range")
+
+    lz4_frame_t    frame;
+    const uchar_t *src = lz4_frame_header(&frame, begin, end);
+    if (!src)
+    {
+        return nullptr;
+    }
+
+    uchar_t *history = dest;
+    for (;;)
+    {
+        usize_t size = end - src >= 4 ? lz4_frame_block_input(&frame, src) : 0;
+        if (!size || size > (usize_t)(end - src))
+        {
+            return nullptr;
+        }
+
+        uchar_t *out = lz4_frame_decode_into(&frame, history, dest, dest_end,
+                                             src);
+        if (!out)
+        {
+            return nullptr;
+        }
+        src += size;
+        if (out == dest)
+        {
+            break;
+        }
+        dest = out;
+    }
+
+    if (next)
+    {
+        *next = src;
+    }
+    return dest;
+}
+
+uchar_t *
+lz4_frame_begin(uchar_t *dest)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest, nullptr, "invalid destination pointer")
+
+    serial_store_le32(dest, LZ4_FRAME_MAGIC);
+    dest[4] = LZ4_FRAME_VERSION | LZ4_FRAME_INDEPENDENT
+              | LZ4_FRAME_CONTENT_CHECKSUM;
+    dest[5] = LZ4_FRAME_BLOCK_ID << 4;
+    dest[6] = (uchar_t)(hash32(dest + 4, dest + 6, 0) >> 8);
+    return dest + 7;
+}
+
+uchar_t *
+lz4_frame_block(lz4_state_t *state, uchar_t *dest, const uchar_t *begin,
+                const uchar_t *end)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(state && state->head, nullptr,
+                                  "invalid state pointer")
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest, nullptr, "invalid destination pointer")
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end >= begin, nullptr,
+                                  "invalid input range")
+    LIQUID_EXCEPTION_RAISE_IF(end - begin > LZ4_FRAME_BLOCK_SIZE, nullptr,
+                              "block exceeds LZ4_FRAME_BLOCK_SIZE")
+
+    return lz4_frame_put(state, dest, dest + LZ4_FRAME_BLOCK_BOUND, begin, end);
+}
+
+uchar_t *
+lz4_frame_end(uchar_t *dest, uint_t checksum)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest, nullptr, "invalid destination pointer")
+
+    serial_store_le32(dest, 0);
+    serial_store_le32(dest + 4, checksum);
+    return dest + LZ4_FRAME_END_SIZE;
+}
+
+const uchar_t *
+lz4_frame_header(lz4_frame_t *frame, const uchar_t *begin, const uchar_t *end)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(frame, nullptr, "invalid frame pointer")
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end >= begin, nullptr,
+                                  "invalid input range")
+
+    if (end - begin < 7 || serial_load_le32(begin) != LZ4_FRAME_MAGIC)
+    {
+        return nullptr;
+    }
+
+    uint_t flags = begin[4];
+    uint_t descriptor = begin[5];
+    if ((flags & 0xC2) != LZ4_FRAME_VERSION || flags & LZ4_FRAME_DICTIONARY
+        || descriptor & 0x8F || descriptor >> 4 < 4)
+    {
+        return nullptr;
+    }
+
+    const uchar_t *src = begin + 6;
+    frame->content_size = LIQUID_ULLONG_MAX;
+    if (flags & LZ4_FRAME_CONTENT_SIZE)
+    {
+        if (end - src < 9)
+        {
+            return nullptr;
+        }
+        frame->content_size = serial_load_le64(src);
+        src += 8;
+    }
+    if (*src != (uchar_t)(hash32(begin + 4, src, 0) >> 8))
+    {
+        return nullptr;
+    }
+
+    frame->flags = flags;
+    frame->block_size = (usize_t)1 << (2 * (descriptor >> 4) + 8);
+    frame->decoded = 0;
+    hash32_init(&frame->checksum, 0);
+    return src + 1;
+}
+
+usize_t
+lz4_frame_block_input(const lz4_frame_t *frame, const uchar_t *begin)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(frame && begin, 0,
+                                  "invalid frame or input pointer")
+
+    uint_t word = serial_load_le32(begin);
+    if (!word)
+    {
+        return frame->flags & LZ4_FRAME_CONTENT_CHECKSUM ? 8 : 4;
+    }
+
+    usize_t size = word & ~LZ4_FRAME_UNCOMPRESSED;
+    if (!size || size > frame->block_size)
+    {
+        return 0;
+    }
+    return 4 + size + (frame->flags & LZ4_FRAME_BLOCK_CHECKSUM ? 4 : 0);
+}
+
+uchar_t *
+lz4_frame_decode(lz4_frame_t *frame, const uchar_t *history, uchar_t *dest,
+                 const uchar_t *begin)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(frame && dest && begin, nullptr,
+                                  "invalid frame, destination or input pointer")
+
+    return lz4_frame_decode_into(frame, history, dest,
+                                 dest + frame->block_size, begin);
+}
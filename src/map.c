@@ -0,0 +1,614 @@
+#include <liquid/array-raw.h>
+#include <liquid/bitflag.h>
+#include <liquid/checked.h>
+#include <liquid/exception.h>
+#include <liquid/hash.h>
+#include <liquid/map.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define MAP_SIMD_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define MAP_SIMD_NEON
+#endif
+
+/**
+ * @def MAP_EMPTY
+ * @brief The control byte of a slot that never held an entry.
+ */
+#define MAP_EMPTY 0x80
+
+/**
+ * @def MAP_DELETED
+ * @brief The control byte of a slot whose entry was erased.
+ *
+ * Lookups have to probe past deleted slots, whereas an empty slot ends
+ * the probe sequence.
+ */
+#define MAP_DELETED 0xFE
+
+/**
+ * @def MAP_IS_FULL(ctrl)
+ * @brief Checks whether a control byte belongs to a slot with an entry.
+ */
+#define MAP_IS_FULL(ctrl) ((ctrl) < 0x80)
+
+/**
+ * @def MAP_SLOT(map, index)
+ * @brief Retrieves the address of a slot by its index.
+ */
+#define MAP_SLOT(map, index) ((map)->slots + (index) * (map)->slot_size)
+
+/**
+ * @brief Computes the number of entries a capacity holds before rehashing.
+ *
+ * The maximum load factor is 7/8, which keeps probe sequences short.
+ *
+ * @param capacity The number of slots.
+ * @return The number of entries.
+ */
+static usize_t
+map_capacity_to_growth(usize_t capacity)
+{
+    return capacity - capacity / 8;
+}
+
+#if defined(MAP_SIMD_SSE2)
+/**
+ * @brief Finds the control bytes of a group equal to a value.
+ *
+ * @param ctrl Pointer to the first control byte of the group.
+ * @param value The value to look for.
+ * @return A mask with bit i set if byte i matches.
+ */
+static uint_t
+map_group_match(const uchar_t *ctrl, uchar_t value)
+{
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return (uint_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(group, _mm_set1_epi8((char)value)));
+}
+
+/**
+ * @brief Finds the control bytes of a group that are empty or deleted.
+ *
+ * @param ctrl Pointer to the first control byte of the group.
+ * @return A mask with bit i set if slot i holds no entry.
+ */
+static uint_t
+map_group_match_free(const uchar_t *ctrl)
+{
+    return (uint_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)ctrl));
+}
+#elif defined(MAP_SIMD_NEON)
+/**
+ * @brief Gathers the highest bit of every byte of a vector into a mask.
+ * @param bytes The vector, every byte either all ones or all zeros.
+ * @return A mask with bit i set if byte i is set.
+ */
+static uint_t
+map_neon_movemask(uint8x16_t bytes)
+{
+    static const uchar_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                        1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t weighted = vandq_u8(bytes, vld1q_u8(weights));
+    return (uint_t)vaddv_u8(vget_low_u8(weighted))
+           | (uint_t)vaddv_u8(vget_high_u8(weighted)) << 8;
+}
+
+/**
+ * @brief Finds the control bytes of a group equal to a value.
+ * @see map_group_match (SSE2)
+ */
+static uint_t
+map_group_match(const uchar_t *ctrl, uchar_t value)
+{
+    return map_neon_movemask(vceqq_u8(vld1q_u8(ctrl), vdupq_n_u8(value)));
+}
+
+/**
+ * @brief Finds the control bytes of a group that are empty or deleted.
+ * @see map_group_match_free (SSE2)
+ */
+static uint_t
+map_group_match_free(const uchar_t *ctrl)
+{
+    return map_neon_movemask(vcltzq_s8(vreinterpretq_s8_u8(vld1q_u8(ctrl))));
+}
+#else
+/**
+ * @brief Finds the control bytes of a group equal to a value.
+ *
+ * @param ctrl Pointer to the first control byte of the group.
+ * @param value The value to look for.
+ * @return A mask with bit i set if byte i matches.
+ */
+static uint_t
+map_group_match(const uchar_t *ctrl, uchar_t value)
+{
+    uint_t mask = 0;
+    for (uint_t i = 0; i < MAP_GROUP_SIZE; ++i)
+    {
+        mask |= (uint_t)(ctrl[i] == value) << i;
+    }
+    return mask;
+}
+
+/**
+ * @brief Finds the control bytes of a group that are empty or deleted.
+ *
+ * @param ctrl Pointer to the first control byte of the group.
+ * @return A mask with bit i set if slot i holds no entry.
+ */
+static uint_t
+map_group_match_free(const uchar_t *ctrl)
+{
+    uint_t mask = 0;
+    for (uint_t i = 0; i < MAP_GROUP_SIZE; ++i)
+    {
+        mask |= (uint_t)(ctrl[i] >> 7) << i;
+    }
+    return mask;
+}
+#endif
+
+/**
+ * @brief Hashes a key.
+ *
+ * The upper bits select where probing starts, the lowest seven bits are
+ * stored in the control byte.
+ *
+ * @param map The map.
+ * @param key The key.
+ * @return The hash of the key.
+ */
+static ullong_t
+map_hash(const map_t *map, const void *key)
+{
+    return hash64(key, (const uchar_t *)key + map->key_size, 0);
+}
+
+/**
+ * @brief Writes the control byte of a slot.
+ *
+ * The first group is mirrored past the end of the control bytes so that
+ * a group can be loaded at any position without wrapping around.
+ *
+ * @param map The map.
+ * @param index The index of the slot.
+ * @param value The control byte.
+ */
+static void
+map_set_ctrl(map_t *map, usize_t index, uchar_t value)
+{
+    map->ctrl[index] = value;
+    if (index < MAP_GROUP_SIZE - 1)
+    {
+        map->ctrl[map->capacity + index] = value;
+    }
+}
+
+/**
+ * @brief Finds the slot of a key.
+ *
+ * @param map The map, with a non-zero capacity.
+ * @param key The key.
+ * @param hash The hash of the key.
+ * @return The index of the slot or the capacity if the key is not present.
+ */
+static usize_t
+map_find_index(const map_t *map, const void *key, ullong_t hash)
+{
+    const uchar_t *key_end = (const uchar_t *)key + map->key_size;
+    usize_t        mask = map->capacity - 1;
+    usize_t        pos = (usize_t)(hash >> 7) & mask;
+    uchar_t        h2 = (uchar_t)(hash & 0x7F);
+
+    // Triangular steps visit every group once on power-of-two capacities.
+    for (usize_t step = MAP_GROUP_SIZE;; step += MAP_GROUP_SIZE)
+    {
+        for (uint_t match = map_group_match(map->ctrl + pos, h2); match;
+             match &= match - 1)
+        {
+            usize_t        index = (pos + bitflag_ctz32(match)) & mask;
+            const uchar_t *slot = MAP_SLOT(map, index);
+            if (!array_raw_compare(slot, slot + map->key_size, key, key_end))
+            {
+                return index;
+            }
+        }
+
+        if (map_group_match(map->ctrl + pos, MAP_EMPTY))
+        {
+            return map->capacity;
+        }
+        pos = (pos + step) & mask;
+    }
+}
+
+/**
+ * @brief Finds the first slot without an entry on the probe sequence of
+ *        a hash.
+ *
+ * @param map The map, with at least one free slot.
+ * @param hash The hash of the key.
+ * @return The index of the slot.
+ */
+static usize_t
+map_find_free(const map_t *map, ullong_t hash)
+{
+    usize_t mask = map->capacity - 1;
+    usize_t pos = (usize_t)(hash >> 7) & mask;
+
+    for (usize_t step = MAP_GROUP_SIZE;; step += MAP_GROUP_SIZE)
+    {
+        uint_t match = map_group_match_free(map->ctrl + pos);
+        if (match)
+        {
+            return (pos + bitflag_ctz32(match)) & mask;
+        }
+        pos = (pos + step) & mask;
+    }
+}
+
+/**
+ * @brief Computes the size of the block of a capacity.
+ *
+ * @param map The map.
+ * @param capacity The number of slots.
+ * @param slots_offset Receives the offset of the slots in the block.
+ * @return The size of the block in bytes, zero if it does not fit in the
+ *         address space.
+ */
+static usize_t
+map_block_size(const map_t *map, usize_t capacity, usize_t *slots_offset)
+{
+    usize_t size;
+    *slots_offset = LIQUID_ALLOC_ALIGN(capacity + MAP_GROUP_SIZE - 1);
+    if (!checked_mul_add_usize(capacity, map->slot_size, *slots_offset, &size))
+    {
+        return 0;
+    }
+    return size;
+}
+
+/**
+ * @brief Moves the entries of a map into a block of a new capacity.
+ *
+ * @param map The map.
+ * @param capacity The new number of slots, a power of two of at least
+ *                 MAP_GROUP_SIZE that fits all entries.
+ * @return True on success, false if the allocation failed.
+ */
+static bool
+map_resize(map_t *map, usize_t capacity)
+{
+    usize_t slots_offset;
+    usize_t block_size = map_block_size(map, capacity, &slots_offset);
+    LIQUID_EXCEPTION_RAISE_IF(!block_size, false, "map capacity is too large")
+
+    uchar_t *block = (uchar_t *)alloc_new(map->allocator, block_size);
+    if (!block)
+    {
+        return false;
+    }
+
+    map_t old = *map;
+    map->ctrl = block;
+    map->slots = block + slots_offset;
+    map->capacity = capacity;
+    map->growth_left = map_capacity_to_growth(capacity) - map->size;
+    for (usize_t i = 0; i < capacity + MAP_GROUP_SIZE - 1; ++i)
+    {
+        map->ctrl[i] = MAP_EMPTY;
+    }
+
+    for (usize_t i = 0; i < old.capacity; ++i)
+    {
+        if (MAP_IS_FULL(old.ctrl[i]))
+        {
+            const uchar_t *slot = MAP_SLOT(&old, i);
+            ullong_t       hash = map_hash(map, slot);
+            usize_t        index = map_find_free(map, hash);
+
+            map_set_ctrl(map, index, (uchar_t)(hash & 0x7F));
+            array_raw_move(MAP_SLOT(map, index), slot, map->slot_size);
+        }
+    }
+
+    if (old.capacity)
+    {
+        alloc_delete(map->allocator, old.ctrl,
+                     map_block_size(&old, old.capacity, &slots_offset));
+    }
+    return true;
+}
+
+/**
+ * @brief Computes the smallest capacity that holds a number of entries.
+ *
+ * @param count The number of entries.
+ * @return The capacity, zero if it does not fit in the address space.
+ */
+static usize_t
+map_capacity_for(usize_t count)
+{
+    usize_t capacity = MAP_GROUP_SIZE;
+    while (map_capacity_to_growth(capacity) < count)
+    {
+        if (capacity > LIQUID_USIZE_MAX / 2)
+        {
+            return 0;
+        }
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+/**
+ * @brief Computes the alignment a field of the given size needs.
+ * @param size The size of the field in bytes.
+ * @return The largest power of two dividing the size, at most
+ *         LIQUID_ALLOC_ALIGNMENT.
+ */
+static usize_t
+map_alignment(usize_t size)
+{
+    usize_t alignment = size & (0 - size);
+    if (!alignment || alignment > LIQUID_ALLOC_ALIGNMENT)
+    {
+        alignment = LIQUID_ALLOC_ALIGNMENT;
+    }
+    return alignment;
+}
+
+void
+map_init(map_t *map, usize_t key_size, usize_t value_size,
+         const allocator_t *allocator)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(map && key_size, , "invalid map or key size")
+
+    usize_t key_align = map_alignment(key_size);
+    usize_t value_align = value_size ? map_alignment(value_size) : 1;
+    usize_t slot_align = key_align > value_align ? key_align : value_align;
+
+    map->ctrl = nullptr;
+    map->slots = nullptr;
+    map->size = 0;
+    map->capacity = 0;
+    map->growth_left = 0;
+    map->key_size = key_size;
+    map->value_size = value_size;
+    map->value_offset = (key_size + value_align - 1) & ~(value_align - 1);
+    map->slot_size = (map->value_offset + value_size + slot_align - 1)
+                     & ~(slot_align - 1);
+    map->allocator = allocator;
+}
+
+void
+map_free(map_t *map)
+{
+    if (map->capacity)
+    {
+        usize_t slots_offset;
+        alloc_delete(map->allocator, map->ctrl,
+                     map_block_size(map, map->capacity, &slots_offset));
+    }
+
+    map->ctrl = nullptr;
+    map->slots = nullptr;
+    map->size = 0;
+    map->capacity = 0;
+    map->growth_left = 0;
+}
+
+void
+map_clear(map_t *map)
+{
+    if (!map->capacity)
+    {
+        return;
+    }
+
+    for (usize_t i = 0; i < map->capacity + MAP_GROUP_SIZE - 1; ++i)
+    {
+        map->ctrl[i] = MAP_EMPTY;
+    }
+    map->size = 0;
+    map->growth_left = map_capacity_to_growth(map->capacity);
+}
+
+bool
+map_reserve(map_t *map, usize_t count)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(map, false, "invalid map pointer")
+
+    if (count <= map->size + map->growth_left)
+    {
+        return true;
+    }
+    return map_rehash(map, count);
+}
+
+bool
+map_rehash(map_t *map, usize_t count)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(map, false, "invalid map pointer")
+
+    if (count < map->size)
+    {
+        count = map->size;
+    }
+    if (!count)
+    {
+        map_free(map);
+        return true;
+    }
+
+    usize_t capacity = map_capacity_for(count);
+    LIQUID_EXCEPTION_RAISE_IF(!capacity, false, "map capacity is too large")
+    return map_resize(map, capacity);
+}
+
+void *
+map_find(const map_t *map, const void *key)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(map && key, nullptr,
+                                  "invalid map or key pointer")
+
+    if (!map->size)
+    {
+        return nullptr;
+    }
+
+    usize_t index = map_find_index(map, key, map_hash(map, key));
+    if (index == map->capacity)
+    {
+        return nullptr;
+    }
+    return MAP_SLOT(map, index) + map->value_offset;
+}
+
+void *
+map_emplace(map_t *map, const void *key, uint_t *inserted)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(map && key, nullptr,
+                                  "invalid map or key pointer")
+
+    ullong_t hash = map_hash(map, key);
+    if (map->size)
+    {
+        usize_t index = map_find_index(map, key, hash);
+        if (index != map->capacity)
+        {
+            if (inserted)
+            {
+                *inserted = 0;
+            }
+            return MAP_SLOT(map, index) + map->value_offset;
+        }
+    }
+
+    usize_t index = map->capacity ? map_find_free(map, hash) : 0;
+    if (!map->growth_left
+        && (!map->capacity || map->ctrl[index] != MAP_DELETED))
+    {
+        // Reuse the capacity if deleted slots use up much of it, grow
+        // otherwise so that rehashing stays amortized constant time.
+        usize_t capacity = map->capacity * 2;
+        if (!map->capacity)
+        {
+            capacity = MAP_GROUP_SIZE;
+        }
+        else if (map->size * 32 <= map->capacity * 25)
+        {
+            capacity = map->capacity;
+        }
+        LIQUID_EXCEPTION_RAISE_IF(!capacity, nullptr,
+                                  "map capacity is too large")
+
+        if (!map_resize(map, capacity))
+        {
+            return nullptr;
+        }
+        index = map_find_free(map, hash);
+    }
+
+    if (map->ctrl[index] == MAP_EMPTY)
+    {
+        --map->growth_left;
+    }
+    map_set_ctrl(map, index, (uchar_t)(hash & 0x7F));
+    ++map->size;
+
+    uchar_t *slot = MAP_SLOT(map, index);
+    array_raw_move(slot, key, map->key_size);
+    if (inserted)
+    {
+        *inserted = 1;
+    }
+    return slot + map->value_offset;
+}
+
+void *
+map_insert(map_t *map, const void *key, const void *value)
+{
+    uchar_t *slot_value = (uchar_t *)map_emplace(map, key, nullptr);
+    if (slot_value && value && map->value_size)
+    {
+        array_raw_move(slot_value, value, map->value_size);
+    }
+    return slot_value;
+}
+
+bool
+map_erase(map_t *map, const void *key)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(map && key, false,
+                                  "invalid map or key pointer")
+
+    if (!map->size)
+    {
+        return false;
+    }
+
+    usize_t index = map_find_index(map, key, map_hash(map, key));
+    if (index == map->capacity)
+    {
+        return false;
+    }
+
+    // A probe only continues past a group without empty slots. If no run
+    // of a full group of occupied slots covers this one, no probe ever
+    // went past it and the slot can become empty again instead of being
+    // marked as deleted.
+    usize_t mask = map->capacity - 1;
+    uint_t  empty_before =
+        map_group_match(map->ctrl + ((index - MAP_GROUP_SIZE) & mask),
+                        MAP_EMPTY);
+    uint_t empty_after = map_group_match(map->ctrl + index, MAP_EMPTY);
+    bool   never_full =
+        empty_before && empty_after
+        && bitflag_ctz32(empty_after)
+                   + bitflag_clz32(empty_before << (32 - MAP_GROUP_SIZE))
+               < MAP_GROUP_SIZE;
+
+    map_set_ctrl(map, index, never_full ? MAP_EMPTY : MAP_DELETED);
+    if (never_full)
+    {
+        ++map->growth_left;
+    }
+    --map->size;
+    return true;
+}
+
+void *
+map_next(const map_t *map, usize_t *iter)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(map && iter, nullptr,
+                                  "invalid map or iterator pointer")
+
+    usize_t index = *iter;
+    while (index < map->capacity)
+    {
+        // Skip a group at a time, the mirrored bytes past the end are
+        // masked off below.
+        uint_t full = ~map_group_match_free(map->ctrl + index)
+                      & ((1u << MAP_GROUP_SIZE) - 1);
+        if (full)
+        {
+            index += bitflag_ctz32(full);
+            break;
+        }
+        index += MAP_GROUP_SIZE;
+    }
+
+    if (index >= map->capacity)
+    {
+        *iter = map->capacity;
+        return nullptr;
+    }
+    *iter = index + 1;
+    return MAP_SLOT(map, index);
+}
@@ -0,0 +1,578 @@
+#include <liquid/bitflag.h>
+#include <liquid/exception.h>
+#include <liquid/metric.h>
+#include <liquid/wheel.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define METRIC_THREAD_LOCAL __thread
+    #define METRIC_ADD(ptr, value)                                             \
+        __atomic_fetch_add(ptr, value, __ATOMIC_RELAXED)
+    #define METRIC_LOAD(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+    #define METRIC_STORE(ptr, value)                                           \
+        __atomic_store_n(ptr, value, __ATOMIC_RELAXED)
+    #define METRIC_CAS(ptr, expected, desired)                                 \
+        __sync_val_compare_and_swap(ptr, expected, desired)
+    #define METRIC_ACQUIRE(ptr) __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+    #define METRIC_RELEASE(ptr, value)                                         \
+        __atomic_store_n(ptr, value, __ATOMIC_RELEASE)
+    #define METRIC_PAUSE() ((void)0)
+#elif defined(_MSC_VER)
+    #include <intrin.h>
+    #define METRIC_THREAD_LOCAL __declspec(thread)
+    #define METRIC_ADD(ptr, value)                                             \
+        _InterlockedExchangeAdd64((volatile __int64 *)(ptr), (__int64)(value))
+    #define METRIC_LOAD(ptr) (*(volatile const ullong_t *)(ptr))
+    #define METRIC_STORE(ptr, value) (*(volatile ullong_t *)(ptr) = (value))
+    #define METRIC_CAS(ptr, expected, desired)                                 \
+        ((ullong_t)_InterlockedCompareExchange64(                              \
+            (volatile __int64 *)(ptr), (__int64)(desired),                     \
+            (__int64)(expected)))
+    #define METRIC_ACQUIRE(ptr) (*(volatile const uint_t *)(ptr))
+    #define METRIC_RELEASE(ptr, value) (*(volatile uint_t *)(ptr) = (value))
+    #define METRIC_PAUSE() _mm_pause()
+#else
+    #error "Unsupported compiler"
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+    #include <cpuid.h>
+    #include <x86intrin.h>
+    #define METRIC_TSC
+#elif defined(_MSC_VER) && defined(_M_X64)
+    #define METRIC_TSC
+#endif
+
+/**
+ * @def METRIC_CALIBRATION
+ * @brief The nanoseconds over which the time stamp counter is calibrated.
+ */
+#define METRIC_CALIBRATION 2000000
+
+/**
+ * @def METRIC_CLOCK_READY
+ * @brief The state of the clock once it is calibrated.
+ */
+#define METRIC_CLOCK_READY 2
+
+metric_counter_t metric_array_copy_bytes = {
+    .base = {&metric_exceptions.base, "liquid.array.copy_bytes",
+             METRIC_COUNTER}};
+metric_counter_t metric_exceptions = {
+    .base = {&metric_fs_reads.base, "liquid.exceptions", METRIC_COUNTER}};
+metric_counter_t metric_fs_reads = {
+    .base = {&metric_fs_read_bytes.base, "liquid.fs.reads", METRIC_COUNTER}};
+metric_counter_t metric_fs_read_bytes = {
+    .base = {&metric_fs_writes.base, "liquid.fs.read_bytes", METRIC_COUNTER}};
+metric_counter_t metric_fs_writes = {
+    .base = {&metric_fs_write_bytes.base, "liquid.fs.writes", METRIC_COUNTER}};
+metric_counter_t metric_fs_write_bytes = {
+    .base = {&metric_fs_read_ns.base, "liquid.fs.write_bytes", METRIC_COUNTER}};
+metric_histogram_t metric_fs_read_ns = {
+    .base = {&metric_fs_write_ns.base, "liquid.fs.read_ns", METRIC_HISTOGRAM}};
+metric_histogram_t metric_fs_write_ns = {
+    .base = {nullptr, "liquid.fs.write_ns", METRIC_HISTOGRAM}};
+
+static metric_t *m_metrics = &metric_array_copy_bytes.base;
+static uint_t    m_metrics_lock = 0;
+
+static METRIC_THREAD_LOCAL uint_t m_thread_cell = 0;
+static ullong_t                   m_next_cell = 0;
+
+static uint_t m_clock_state = 0;
+static uint_t m_clock_tsc = 0;
+static double m_clock_scale = 1.0;
+
+/**
+ * @brief Finds the cell of the calling thread.
+ * @return The index of the cell.
+ */
+static uint_t
+metric_cell(void)
+{
+    // Threads get the cells in turn, 0 stands for none yet.
+    uint_t cell = m_thread_cell;
+    if (!cell)
+    {
+        cell = (uint_t)METRIC_ADD(&m_next_cell, 1) % METRIC_SHARDS + 1;
+        m_thread_cell = cell;
+    }
+    return cell - 1;
+}
+
+/**
+ * @brief Raises a value to at least another one.
+ *
+ * @param ptr The value, updated atomically.
+ * @param value The other value.
+ */
+static void
+metric_raise(ullong_t *ptr, ullong_t value)
+{
+    ullong_t seen = METRIC_LOAD(ptr);
+    while (value > seen)
+    {
+        ullong_t previous = METRIC_CAS(ptr, seen, value);
+        if (previous == seen)
+        {
+            break;
+        }
+        seen = previous;
+    }
+}
+
+/**
+ * @brief Maps a value to its bucket.
+ * @param value The value.
+ * @return The index of the bucket.
+ */
+static uint_t
+metric_bucket(ullong_t value)
+{
+    if (value < METRIC_HISTOGRAM_SUB)
+    {
+        return (uint_t)value;
+    }
+
+    // The highest bit and the bits below it select the bucket.
+    uint_t shift = 63 - bitflag_clz64(value) - METRIC_HISTOGRAM_SUB_BITS;
+    return shift * METRIC_HISTOGRAM_SUB + (uint_t)(value >> shift);
+}
+
+/**
+ * @brief Computes the largest value of a bucket.
+ * @param bucket The index of the bucket.
+ * @return The value.
+ */
+static ullong_t
+metric_bucket_max(uint_t bucket)
+{
+    if (bucket < 2 * METRIC_HISTOGRAM_SUB)
+    {
+        return bucket;
+    }
+
+    // The top bucket wraps around to the largest value.
+    uint_t   shift = bucket / METRIC_HISTOGRAM_SUB - 1;
+    ullong_t top = bucket - shift * METRIC_HISTOGRAM_SUB + 1;
+    return (top << shift) - 1;
+}
+
+/**
+ * @brief Takes the lock of the registered metrics.
+ */
+static void
+metric_lock(void)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    while (__atomic_exchange_n(&m_metrics_lock, 1, __ATOMIC_ACQUIRE))
+#else
+    while (_InterlockedExchange((volatile long *)&m_metrics_lock, 1))
+#endif
+    {
+        METRIC_PAUSE();
+    }
+}
+
+/**
+ * @brief Releases the lock of the registered metrics.
+ */
+static void
+metric_unlock(void)
+{
+    METRIC_RELEASE(&m_metrics_lock, 0);
+}
+
+/**
+ * @brief Calibrates the clock of the timers once.
+ *
+ * The time stamp counter is used where it runs at a constant rate in every
+ * power state, its rate is measured against the monotonic clock.
+ */
+static void
+metric_clock_setup(void)
+{
+    if (METRIC_ACQUIRE(&m_clock_state) == METRIC_CLOCK_READY)
+    {
+        return;
+    }
+
+#if defined(__GNUC__) || defined(__clang__)
+    uint_t idle = 0;
+    bool   first = __atomic_compare_exchange_n(&m_clock_state, &idle, 1, false,
+                                               __ATOMIC_ACQUIRE,
+                                               __ATOMIC_ACQUIRE);
+#else
+    bool first = _InterlockedCompareExchange((volatile long *)&m_clock_state,
+                                             1, 0)
+                 == 0;
+#endif
+    if (!first)
+    {
+        while (METRIC_ACQUIRE(&m_clock_state) != METRIC_CLOCK_READY)
+        {
+            METRIC_PAUSE();
+        }
+        return;
+    }
+
+#if defined(METRIC_TSC)
+    #if defined(_MSC_VER)
+    sint_t regs[4];
+    __cpuid(regs, 0x80000000);
+    bool invariant = (uint_t)regs[0] >= 0x80000007;
+    if (invariant)
+    {
+        __cpuid(regs, 0x80000007);
+        invariant = (regs[3] >> 8) & 1;
+    }
+    #else
+    uint_t eax, ebx, ecx, edx;
+    bool   invariant = __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)
+                     && (edx >> 8) & 1;
+    #endif
+    if (invariant)
+    {
+        ullong_t start = wheel_clock_nanoseconds();
+        ullong_t ticks = __rdtsc();
+        ullong_t end;
+        do
+        {
+            end = wheel_clock_nanoseconds();
+        } while (end - start < METRIC_CALIBRATION);
+        ticks = __rdtsc() - ticks;
+        if (ticks)
+        {
+            m_clock_scale = (double)(end - start) / (double)ticks;
+            m_clock_tsc = 1;
+        }
+    }
+#endif
+    METRIC_RELEASE(&m_clock_state, METRIC_CLOCK_READY);
+}
+
+void
+metric_counter_init(metric_counter_t *counter, const char *name)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(counter && name, ,
+                                  "invalid counter or name pointer")
+
+    counter->base.next = nullptr;
+    counter->base.name = name;
+    counter->base.kind = METRIC_COUNTER;
+    for (uint_t i = 0; i < METRIC_SHARDS; ++i)
+    {
+        counter->cells[i].value = 0;
+    }
+}
+
+void
+metric_counter_add(metric_counter_t *counter, ullong_t value)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(counter, , "invalid counter pointer")
+
+    METRIC_ADD(&counter->cells[metric_cell()].value, value);
+}
+
+ullong_t
+metric_counter_read(const metric_counter_t *counter)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(counter, 0, "invalid counter pointer")
+
+    ullong_t sum = 0;
+    for (uint_t i = 0; i < METRIC_SHARDS; ++i)
+    {
+        sum += METRIC_LOAD(&counter->cells[i].value);
+    }
+    return sum;
+}
+
+void
+metric_counter_reset(metric_counter_t *counter)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(counter, , "invalid counter pointer")
+
+    for (uint_t i = 0; i < METRIC_SHARDS; ++i)
+    {
+        METRIC_STORE(&counter->cells[i].value, 0);
+    }
+}
+
+void
+metric_histogram_init(metric_histogram_t *histogram, const char *name)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(histogram && name, ,
+                                  "invalid histogram or name pointer")
+
+    histogram->base.next = nullptr;
+    histogram->base.name = name;
+    histogram->base.kind = METRIC_HISTOGRAM;
+    for (uint_t i = 0; i < METRIC_HISTOGRAM_BUCKETS; ++i)
+    {
+        histogram->buckets[i] = 0;
+    }
+    histogram->sum = 0;
+    histogram->max = 0;
+    histogram->min_inverse = 0;
+}
+
+void
+metric_histogram_record(metric_histogram_t *histogram, ullong_t value)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(histogram, , "invalid histogram pointer")
+
+    METRIC_ADD(&histogram->buckets[metric_bucket(value)], 1);
+    METRIC_ADD(&histogram->sum, value);
+    metric_raise(&histogram->max, value);
+    metric_raise(&histogram->min_inverse, ~value);
+}
+
+void
+metric_histogram_merge(metric_histogram_t       *into,
+                       const metric_histogram_t *from)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(into && from, ,
+                                  "invalid histogram pointers")
+
+    for (uint_t i = 0; i < METRIC_HISTOGRAM_BUCKETS; ++i)
+    {
+        ullong_t count = METRIC_LOAD(&from->buckets[i]);
+        if (count)
+        {
+            METRIC_ADD(&into->buckets[i], count);
+        }
+    }
+    METRIC_ADD(&into->sum, METRIC_LOAD(&from->sum));
+    metric_raise(&into->max, METRIC_LOAD(&from->max));
+    metric_raise(&into->min_inverse, METRIC_LOAD(&from->min_inverse));
+}
+
+ullong_t
+metric_histogram_percentile(const metric_histogram_t *histogram,
+                            double                    percent)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(histogram, 0, "invalid histogram pointer")
+
+    ullong_t count = 0;
+    for (uint_t i = 0; i < METRIC_HISTOGRAM_BUCKETS; ++i)
+    {
+        count += METRIC_LOAD(&histogram->buckets[i]);
+    }
+    if (!count)
+    {
+        return 0;
+    }
+
+    // The rank of the percentile counts from 1, rounded up.
+    double   exact = percent / 100.0 * (double)count;
+    ullong_t rank = exact < 1.0 ? 1 : (ullong_t)exact;
+    rank += rank < exact;
+    rank = rank < count ? rank : count;
+
+    uint_t   bucket = 0;
+    ullong_t seen = METRIC_LOAD(&histogram->buckets[0]);
+    while (seen < rank && bucket + 1 < METRIC_HISTOGRAM_BUCKETS)
+    {
+        seen += METRIC_LOAD(&histogram->buckets[++bucket]);
+    }
+
+    ullong_t value = metric_bucket_max(bucket);
+    ullong_t max = METRIC_LOAD(&histogram->max);
+    ullong_t min = ~METRIC_LOAD(&histogram->min_inverse);
+    value = value < max ? value : max;
+    return value > min ? value : min;
+}
+
+void
+metric_histogram_summarize(const metric_histogram_t *histogram,
+                           metric_summary_t         *summary)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(histogram && summary, ,
+                                  "invalid histogram or summary pointer")
+
+    summary->count = 0;
+    for (uint_t i = 0; i < METRIC_HISTOGRAM_BUCKETS; ++i)
+    {
+        summary->count += METRIC_LOAD(&histogram->buckets[i]);
+    }
+    summary->sum = METRIC_LOAD(&histogram->sum);
+    summary->min = summary->count ? ~METRIC_LOAD(&histogram->min_inverse) : 0;
+    summary->max = METRIC_LOAD(&histogram->max);
+    summary->p50 = metric_histogram_percentile(histogram, 50.0);
+    summary->p90 = metric_histogram_percentile(histogram, 90.0);
+    summary->p99 = metric_histogram_percentile(histogram, 99.0);
+    summary->p999 = metric_histogram_percentile(histogram, 99.9);
+}
+
+void
+metric_histogram_reset(metric_histogram_t *histogram)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(histogram, , "invalid histogram pointer")
+
+    for (uint_t i = 0; i < METRIC_HISTOGRAM_BUCKETS; ++i)
+    {
+        METRIC_STORE(&histogram->buckets[i], 0);
+    }
+    METRIC_STORE(&histogram->sum, 0);
+    METRIC_STORE(&histogram->max, 0);
+    METRIC_STORE(&histogram->min_inverse, 0);
+}
+
+ullong_t
+metric_clock_ticks(void)
+{
+    metric_clock_setup();
+#if defined(METRIC_TSC)
+    if (m_clock_tsc)
+    {
+        return __rdtsc();
+    }
+#endif
+    return wheel_clock_nanoseconds();
+}
+
+ullong_t
+metric_clock_nanoseconds(ullong_t ticks)
+{
+    metric_clock_setup();
+    return m_clock_tsc ? (ullong_t)((double)ticks * m_clock_scale) : ticks;
+}
+
+metric_timer_t
+metric_timer_start(metric_histogram_t *histogram)
+{
+    metric_timer_t timer = {histogram, 0, 1};
+    LIQUID_EXCEPTION_RAISE_IF_NOT(histogram, timer, "invalid histogram pointer")
+
+    timer.start = metric_clock_ticks();
+    return timer;
+}
+
+ullong_t
+metric_timer_stop(metric_timer_t *timer)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(timer, 0, "invalid timer pointer")
+
+    ullong_t elapsed = metric_clock_ticks() - timer->start;
+    timer->running = 0;
+    if (!timer->histogram)
+    {
+        return 0;
+    }
+
+    ullong_t nanoseconds = metric_clock_nanoseconds(elapsed);
+    metric_histogram_record(timer->histogram, nanoseconds);
+    return nanoseconds;
+}
+
+void
+metric_register(metric_t *metric)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(metric, , "invalid metric pointer")
+
+    // The exports list the metrics in the order they were registered.
+    metric_lock();
+    metric_t **link = &m_metrics;
+    while (*link && *link != metric)
+    {
+        link = &(*link)->next;
+    }
+    if (!*link)
+    {
+        metric->next = nullptr;
+        *link = metric;
+    }
+    metric_unlock();
+}
+
+void
+metric_unregister(metric_t *metric)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(metric, , "invalid metric pointer")
+
+    metric_lock();
+    for (metric_t **link = &m_metrics; *link; link = &(*link)->next)
+    {
+        if (*link == metric)
+        {
+            *link = metric->next;
+            metric->next = nullptr;
+            break;
+        }
+    }
+    metric_unlock();
+}
+
+bool
+metric_export_text(str_builder_t *builder)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(builder, false, "invalid builder pointer")
+
+    bool ok = true;
+    metric_lock();
+    for (const metric_t *metric = m_metrics; ok && metric;
+         metric = metric->next)
+    {
+        if (metric->kind == METRIC_COUNTER)
+        {
+            ok = str_builder_appendf(
+                     builder, "%s %llu\n", metric->name,
+                     metric_counter_read((const metric_counter_t *)metric))
+                 != nullptr;
+        }
+        else
+        {
+            metric_summary_t summary;
+            metric_histogram_summarize((const metric_histogram_t *)metric,
+                                       &summary);
+            ok = str_builder_appendf(builder,
+                                     "%s count=%llu sum=%llu min=%llu "
+                                     "max=%llu p50=%llu p90=%llu p99=%llu "
+                                     "p999=%llu\n",
+                                     metric->name, summary.count, summary.sum,
+                                     summary.min, summary.max, summary.p50,
+                                     summary.p90, summary.p99, summary.p999)
+                 != nullptr;
+        }
+    }
+    metric_unlock();
+    return ok;
+}
+
+bool
+metric_export_json(str_builder_t *builder)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(builder, false, "invalid builder pointer")
+
+    bool ok = str_builder_append_char(builder, '{') != nullptr;
+    metric_lock();
+    for (const metric_t *metric = m_metrics; ok && metric;
+         metric = metric->next)
+    {
+        ok = (metric == m_metrics || str_builder_append_char(builder, ','))
+             && str_builder_append_json(builder, metric->name);
+        if (ok && metric->kind == METRIC_COUNTER)
+        {
+            ok = str_builder_appendf(
+                     builder, ":%llu",
+                     metric_counter_read((const metric_counter_t *)metric))
+                 != nullptr;
+        }
+        else if (ok)
+        {
+            metric_summary_t summary;
+            metric_histogram_summarize((const metric_histogram_t *)metric,
+                                       &summary);
+            ok = str_builder_appendf(builder,
+                                     ":{\"count\":%llu,\"sum\":%llu,"
+                                     "\"min\":%llu,\"max\":%llu,"
+                                     "\"p50\":%llu,\"p90\":%llu,"
+                                     "\"p99\":%llu,\"p999\":%llu}",
+                                     summary.count, summary.sum, summary.min,
+                                     summary.max, summary.p50, summary.p90,
+                                     summary.p99, summary.p999)
+                 != nullptr;
+        }
+    }
+    metric_unlock();
+    return ok && str_builder_append_char(builder, '}');
+}
@@ -1 +1,115 @@
-#include <liquid/os-darwin.h>
\ No newline at end of file
+#include <errno.h>
+#include <libproc.h>
+#include <liquid/alloc.h>
+#include <liquid/exception.h>
+#include <liquid/os.h>
+#include <mach/mach.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/sysctl.h>
+#include <unistd.h>
+
+// Every call of mach_host_self adds a reference to the port, so it is
+// taken once.
+static mach_port_t m_host = MACH_PORT_NULL;
+
+bool
+os_usage_read(os_usage_t *usage)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(usage, false, "invalid usage pointer")
+
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t      count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info,
+                  &count)
+        != KERN_SUCCESS)
+    {
+        errno = EIO;
+        return false;
+    }
+
+    struct rusage resources;
+    if (getrusage(RUSAGE_SELF, &resources) != 0)
+    {
+        return false;
+    }
+    usage->rss = (ullong_t)info.resident_size;
+    usage->peak_rss = (ullong_t)info.resident_size_max;
+    usage->minor_faults = (ullong_t)resources.ru_minflt;
+    usage->major_faults = (ullong_t)resources.ru_majflt;
+    usage->voluntary_switches = (ullong_t)resources.ru_nvcsw;
+    usage->involuntary_switches = (ullong_t)resources.ru_nivcsw;
+    usage->user_ns = (ullong_t)resources.ru_utime.tv_sec * 1000000000
+                     + (ullong_t)resources.ru_utime.tv_usec * 1000;
+    usage->system_ns = (ullong_t)resources.ru_stime.tv_sec * 1000000000
+                       + (ullong_t)resources.ru_stime.tv_usec * 1000;
+    return true;
+}
+
+bool
+os_open_files(usize_t *count)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(count, false, "invalid count pointer")
+
+    // Without a buffer the size that fits every descriptor is returned.
+    pid_t pid = getpid();
+    int   size = proc_pidinfo(pid, PROC_PIDLISTFDS, 0, nullptr, 0);
+    if (size <= 0)
+    {
+        return false;
+    }
+    struct proc_fdinfo *fds = alloc_new(nullptr, (usize_t)size);
+    if (!fds)
+    {
+        errno = ENOMEM;
+        return false;
+    }
+    int used = proc_pidinfo(pid, PROC_PIDLISTFDS, 0, fds, size);
+    alloc_delete(nullptr, fds, (usize_t)size);
+    if (used <= 0)
+    {
+        return false;
+    }
+    *count = (usize_t)used / sizeof(struct proc_fdinfo);
+    return true;
+}
+
+bool
+os_load_read(os_load_t *load)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(load, false, "invalid load pointer")
+
+    ullong_t memory;
+    size_t   size = sizeof(memory);
+    if (getloadavg(load->averages, 3) != 3
+        || sysctlbyname("hw.memsize", &memory, &size, nullptr, 0) != 0)
+    {
+        return false;
+    }
+    load->memory_total = memory;
+
+    if (m_host == MACH_PORT_NULL)
+    {
+        m_host = mach_host_self();
+    }
+    vm_statistics64_data_t statistics;
+    mach_msg_type_number_t count = HOST_VM_INFO64_COUNT;
+    if (host_statistics64(m_host, HOST_VM_INFO64,
+                          (host_info64_t)&statistics, &count)
+        != KERN_SUCCESS)
+    {
+        errno = EIO;
+        return false;
+    }
+
+    // Inactive and purgeable pages are reclaimed without swapping.
+    load->memory_available =
+        ((ullong_t)statistics.free_count + statistics.inactive_count
+         + statistics.purgeable_count)
+        * vm_kernel_page_size;
+    load->cpu_pressure = 0;
+    load->memory_pressure = 0;
+    load->io_pressure = 0;
+    load->pressure = 0;
+    return true;
+}
@@ -1 +1,273 @@
-#include <liquid/os-linux.h>
\ No newline at end of file
+#include <errno.h>
+#include <fcntl.h>
+#include <liquid/exception.h>
+#include <liquid/os.h>
+#include <liquid/str-num.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/sysinfo.h>
+#include <unistd.h>
+
+/**
+ * @def OS_PROC_CLOSED
+ * @brief The handle of a file of /proc that is not opened yet.
+ */
+#define OS_PROC_CLOSED -1
+
+/**
+ * @def OS_PROC_MISSING
+ * @brief The handle of a file of /proc the kernel does not offer.
+ */
+#define OS_PROC_MISSING -2
+
+// The files of /proc stay open so that reading one takes a single pread.
+static sint_t m_statm = OS_PROC_CLOSED;
+static sint_t m_meminfo = OS_PROC_CLOSED;
+static sint_t m_pressure_cpu = OS_PROC_CLOSED;
+static sint_t m_pressure_memory = OS_PROC_CLOSED;
+static sint_t m_pressure_io = OS_PROC_CLOSED;
+static bool   m_atfork = false;
+
+/**
+ * @brief Closes the files of the parent in a child process, which would
+ *        otherwise go on reading the usage of its parent.
+ */
+static void
+os_proc_atfork_child(void)
+{
+    sint_t handle = __atomic_exchange_n(&m_statm, OS_PROC_CLOSED,
+                                        __ATOMIC_ACQ_REL);
+    if (handle >= 0)
+    {
+        close(handle);
+    }
+}
+
+/**
+ * @brief Reads the start of a file of /proc, opening it on first use.
+ *
+ * @param cache The handle of the file.
+ * @param path The path of the file.
+ * @param buffer The buffer, null-terminated after the read.
+ * @param size The size of the buffer.
+ * @return The bytes read, -1 on failure.
+ */
+static ssize_t
+os_proc_read(sint_t *cache, const char *path, char *buffer, usize_t size)
+{
+    sint_t handle = __atomic_load_n(cache, __ATOMIC_ACQUIRE);
+    if (handle == OS_PROC_MISSING)
+    {
+        errno = ENOENT;
+        return -1;
+    }
+    if (handle == OS_PROC_CLOSED)
+    {
+        handle = open(path, O_RDONLY | O_CLOEXEC);
+        sint_t desired = handle < 0 ? OS_PROC_MISSING : handle;
+        sint_t expected = OS_PROC_CLOSED;
+        if (!__atomic_compare_exchange_n(cache, &expected, desired, false,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            // Another thread opened it first.
+            if (handle >= 0)
+            {
+                close(handle);
+            }
+            handle = expected;
+        }
+        if (handle < 0)
+        {
+            errno = ENOENT;
+            return -1;
+        }
+    }
+
+    ssize_t count;
+    do
+    {
+        count = pread(handle, buffer, size - 1, 0);
+    } while (count < 0 && errno == EINTR);
+    buffer[count < 0 ? 0 : count] = '\0';
+    return count;
+}
+
+/**
+ * @brief Finds a field in the text of a file of /proc.
+ *
+ * @param text The null-terminated text.
+ * @param field The name of the field, with its separator.
+ * @return The character after the name, nullptr if it is not there.
+ */
+static const char *
+os_proc_field(const char *text, const char *field)
+{
+    const char *found = strstr(text, field);
+    return found ? found + strlen(field) : nullptr;
+}
+
+/**
+ * @brief Reads the share of time in which some tasks stalled on a resource
+ *        over the last 10 seconds.
+ *
+ * @param cache The handle of the file of the resource.
+ * @param path The path of the file of the resource.
+ * @param percentage The percentage.
+ * @return True on success, false if the kernel does not track it.
+ */
+static bool
+os_pressure_read(sint_t *cache, const char *path, double *percentage)
+{
+    char    buffer[256];
+    ssize_t count = os_proc_read(cache, path, buffer, sizeof(buffer));
+    if (count <= 0)
+    {
+        return false;
+    }
+    const char *value = os_proc_field(buffer, "some avg10=");
+    return value
+           && str_to_double(value, buffer + count, percentage, nullptr);
+}
+
+bool
+os_usage_read(os_usage_t *usage)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(usage, false, "invalid usage pointer")
+
+    if (!__atomic_load_n(&m_atfork, __ATOMIC_ACQUIRE))
+    {
+        // Registering twice is harmless, the handler closes once.
+        pthread_atfork(nullptr, nullptr, os_proc_atfork_child);
+        __atomic_store_n(&m_atfork, true, __ATOMIC_RELEASE);
+    }
+
+    // The size of the address space comes first, then the resident pages.
+    char        buffer[128];
+    ullong_t    pages;
+    const char *next;
+    ssize_t     count = os_proc_read(&m_statm, "/proc/self/statm", buffer,
+                                     sizeof(buffer));
+    if (count <= 0
+        || !(next = str_to_u64(buffer, buffer + count, &pages, nullptr))
+        || next >= buffer + count
+        || !str_to_u64(next + 1, buffer + count, &pages, nullptr))
+    {
+        return false;
+    }
+
+    struct rusage resources;
+    if (getrusage(RUSAGE_SELF, &resources) != 0)
+    {
+        return false;
+    }
+    // The kernel updates the peak lazily, it may lag behind the resident
+    // pages that have just been counted.
+    usage->rss = pages * (ullong_t)sysconf(_SC_PAGESIZE);
+    usage->peak_rss = (ullong_t)resources.ru_maxrss * 1024;
+    usage->peak_rss = usage->peak_rss < usage->rss ? usage->rss
+                                                   : usage->peak_rss;
+    usage->minor_faults = (ullong_t)resources.ru_minflt;
+    usage->major_faults = (ullong_t)resources.ru_majflt;
+    usage->voluntary_switches = (ullong_t)resources.ru_nvcsw;
+    usage->involuntary_switches = (ullong_t)resources.ru_nivcsw;
+    usage->user_ns = (ullong_t)resources.ru_utime.tv_sec * 1000000000
+                     + (ullong_t)resources.ru_utime.tv_usec * 1000;
+    usage->system_ns = (ullong_t)resources.ru_stime.tv_sec * 1000000000
+                       + (ullong_t)resources.ru_stime.tv_usec * 1000;
+    return true;
+}
+
+bool
+os_open_files(usize_t *count)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(count, false, "invalid count pointer")
+
+    sint_t handle = open("/proc/self/fd", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (handle < 0)
+    {
+        return false;
+    }
+
+    // The entries are read in place, the directory itself is one of them.
+    ullong_t buffer[512];
+    usize_t  entries = 0;
+    long     size;
+    while ((size = syscall(SYS_getdents64, handle, buffer, sizeof(buffer)))
+           > 0)
+    {
+        const char *entry = (const char *)buffer;
+        for (long offset = 0; offset < size;)
+        {
+            // An entry is an inode, an offset, its size, a type and a name.
+            ushort_t reclen;
+            memcpy(&reclen, entry + offset + 16, sizeof(reclen));
+            entries += entry[offset + 19] != '.';
+            offset += reclen;
+        }
+    }
+    close(handle);
+    if (size < 0)
+    {
+        return false;
+    }
+    *count = entries - 1;
+    return true;
+}
+
+bool
+os_load_read(os_load_t *load)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(load, false, "invalid load pointer")
+
+    struct sysinfo info;
+    if (sysinfo(&info) != 0)
+    {
+        return false;
+    }
+    for (uint_t i = 0; i < 3; ++i)
+    {
+        load->averages[i] = (double)info.loads[i] / (1 << SI_LOAD_SHIFT);
+    }
+    load->memory_total = (ullong_t)info.totalram * info.mem_unit;
+
+    // Older kernels lack the estimate, which counts the page cache too.
+    char        buffer[256];
+    ullong_t    available;
+    const char *value = nullptr;
+    ssize_t     count = os_proc_read(&m_meminfo, "/proc/meminfo", buffer,
+                                     sizeof(buffer));
+    if (count > 0)
+    {
+        value = os_proc_field(buffer, "MemAvailable:");
+    }
+    while (value && *value == ' ')
+    {
+        ++value;
+    }
+    if (value && str_to_u64(value, buffer + count, &available, nullptr))
+    {
+        load->memory_available = available * 1024;
+    }
+    else
+    {
+        load->memory_available =
+            ((ullong_t)info.freeram + info.bufferram) * info.mem_unit;
+    }
+
+    load->pressure =
+        os_pressure_read(&m_pressure_cpu, "/proc/pressure/cpu",
+                         &load->cpu_pressure)
+        && os_pressure_read(&m_pressure_memory, "/proc/pressure/memory",
+                            &load->memory_pressure)
+        && os_pressure_read(&m_pressure_io, "/proc/pressure/io",
+                            &load->io_pressure);
+    if (!load->pressure)
+    {
+        load->cpu_pressure = 0;
+        load->memory_pressure = 0;
+        load->io_pressure = 0;
+    }
+    return true;
+}
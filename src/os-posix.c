@@ -1,8 +1,10 @@
 #include <errno.h>
+#include <liquid/exception.h>
 #include <liquid/nullptr.h>
-#include <liquid/os-posix.h>
+#include <liquid/os.h>
 #include <liquid/str.h>
 #include <string.h>
+#include <time.h>
 
 errcode_t
 last_error_code()
@@ -21,4 +23,25 @@ void
 set_last_error_code(errcode_t code)
 {
     errno = code;
+}
+
+bool
+os_thread_cpu_time(ullong_t *nanoseconds)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(nanoseconds, false,
+                                  "invalid nanoseconds pointer")
+
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec time;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0)
+    {
+        return false;
+    }
+    *nanoseconds =
+        (ullong_t)time.tv_sec * 1000000000 + (ullong_t)time.tv_nsec;
+    return true;
+#else
+    errno = ENOSYS;
+    return false;
+#endif
 }
\ No newline at end of file
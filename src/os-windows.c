@@ -1,7 +1,23 @@
+#include <liquid/exception.h>
 #include <liquid/nullptr.h>
-#include <liquid/os-windows.h>
+#include <liquid/os.h>
 #include <windows.h>
 
+#include <psapi.h>
+
+/**
+ * @brief Converts a time of Windows, in units of 100 nanoseconds, to
+ *        nanoseconds.
+ *
+ * @param time The time.
+ * @return The nanoseconds.
+ */
+static ullong_t
+os_filetime_nanoseconds(const FILETIME *time)
+{
+    return ((ullong_t)time->dwHighDateTime << 32 | time->dwLowDateTime) * 100;
+}
+
 errcode_t
 last_error_code()
 {
@@ -27,4 +43,81 @@ handle_t
 cur_proc()
 {
     return GetCurrentProcess();
+}
+
+bool
+os_usage_read(os_usage_t *usage)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(usage, false, "invalid usage pointer")
+
+    PROCESS_MEMORY_COUNTERS memory;
+    FILETIME                creation, exit, kernel, user;
+    if (!GetProcessMemoryInfo(cur_proc(), &memory, sizeof(memory))
+        || !GetProcessTimes(cur_proc(), &creation, &exit, &kernel, &user))
+    {
+        return false;
+    }
+    usage->rss = memory.WorkingSetSize;
+    usage->peak_rss = memory.PeakWorkingSetSize;
+    usage->minor_faults = memory.PageFaultCount;
+    usage->major_faults = 0;
+    usage->voluntary_switches = 0;
+    usage->involuntary_switches = 0;
+    usage->user_ns = os_filetime_nanoseconds(&user);
+    usage->system_ns = os_filetime_nanoseconds(&kernel);
+    return true;
+}
+
+bool
+os_open_files(usize_t *count)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(count, false, "invalid count pointer")
+
+    DWORD handles;
+    if (!GetProcessHandleCount(cur_proc(), &handles))
+    {
+        return false;
+    }
+    *count = handles;
+    return true;
+}
+
+bool
+os_thread_cpu_time(ullong_t *nanoseconds)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(nanoseconds, false,
+                                  "invalid nanoseconds pointer")
+
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+    {
+        return false;
+    }
+    *nanoseconds =
+        os_filetime_nanoseconds(&user) + os_filetime_nanoseconds(&kernel);
+    return true;
+}
+
+bool
+os_load_read(os_load_t *load)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(load, false, "invalid load pointer")
+
+    MEMORYSTATUSEX memory;
+    memory.dwLength = sizeof(memory);
+    if (!GlobalMemoryStatusEx(&memory))
+    {
+        return false;
+    }
+    for (uint_t i = 0; i < 3; ++i)
+    {
+        load->averages[i] = 0;
+    }
+    load->memory_total = memory.ullTotalPhys;
+    load->memory_available = memory.ullAvailPhys;
+    load->cpu_pressure = 0;
+    load->memory_pressure = 0;
+    load->io_pressure = 0;
+    load->pressure = 0;
+    return true;
 }
\ No newline at end of file
@@ -0,0 +1,213 @@
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <liquid/bitflag.h>
+#include <liquid/exception.h>
+#include <liquid/perf.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if (defined(__GNUC__) || defined(__clang__))                                 \
+    && (defined(__x86_64__) || defined(__i386__))
+    #define PERF_RDPMC
+#endif
+
+/**
+ * @struct perf_event
+ * @brief The kind of event of a counter.
+ */
+typedef struct perf_event
+{
+    uint_t   type;   ///< The PERF_TYPE_ of the event.
+    ullong_t config; ///< The event of the type.
+} perf_event_t;
+
+static const perf_event_t m_events[PERF_COUNTERS] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB
+                             | PERF_COUNT_HW_CACHE_OP_READ << 8
+                             | PERF_COUNT_HW_CACHE_RESULT_MISS << 16},
+};
+
+/**
+ * @brief Opens a counter of the calling thread.
+ *
+ * @param event The kind of event.
+ * @param leader The first counter of the group, -1 to start a group.
+ * @return The handle, -1 on failure.
+ */
+static sint_t
+perf_event_open(const perf_event_t *event, sint_t leader)
+{
+    struct perf_event_attr attr = {0};
+    attr.type = event->type;
+    attr.size = sizeof(attr);
+    attr.config = event->config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.disabled = leader < 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (sint_t)syscall(SYS_perf_event_open, &attr, 0, -1, leader,
+                           PERF_FLAG_FD_CLOEXEC);
+}
+
+#if defined(PERF_RDPMC)
+/**
+ * @brief Reads a counter from user space.
+ *
+ * @param page The page of the counter.
+ * @param value The count.
+ * @return True on success, false if the counter is not on the PMU or may
+ *         not be read from user space.
+ */
+static bool
+perf_rdpmc(const volatile struct perf_event_mmap_page *page, ullong_t *value)
+{
+    // The kernel bumps the lock around updates of the page.
+    uint_t   seq;
+    ullong_t count;
+    do
+    {
+        seq = page->lock;
+        __atomic_signal_fence(__ATOMIC_SEQ_CST);
+        uint_t index = page->index;
+        if (!page->cap_user_rdpmc || !index)
+        {
+            return false;
+        }
+        count = (ullong_t)page->offset;
+
+        uint_t low, high;
+        __asm__ volatile("rdpmc" : "=a"(low), "=d"(high) : "c"(index - 1));
+        // The counter is sign-extended from its width, shifted as unsigned.
+        uint_t   width = page->pmc_width;
+        sllong_t pmc = (sllong_t)(((ullong_t)high << 32 | low)
+                                  << (64 - width));
+        count += (ullong_t)(pmc >> (64 - width));
+        __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    } while (page->lock != seq);
+
+    *value = count;
+    return true;
+}
+#endif
+
+bool
+perf_open(perf_t *perf)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(perf, false, "invalid perf pointer")
+
+    long   page_size = sysconf(_SC_PAGESIZE);
+    sint_t leader = -1;
+    perf->valid = 0;
+    for (uint_t i = 0; i < PERF_COUNTERS; ++i)
+    {
+        perf->pages[i] = nullptr;
+        perf->handles[i] = perf_event_open(&m_events[i], leader);
+        if (perf->handles[i] < 0)
+        {
+            continue;
+        }
+        perf->valid |= 1u << i;
+        leader = leader < 0 ? perf->handles[i] : leader;
+
+        void *page = mmap(nullptr, (usize_t)page_size, PROT_READ, MAP_SHARED,
+                          perf->handles[i], 0);
+        perf->pages[i] = page == MAP_FAILED ? nullptr : page;
+    }
+    if (leader < 0)
+    {
+        return false;
+    }
+
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+void
+perf_close(perf_t *perf)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(perf, , "invalid perf pointer")
+
+    // The leader goes last, so that no counter is left without its group.
+    long page_size = sysconf(_SC_PAGESIZE);
+    for (uint_t i = PERF_COUNTERS; i-- > 0;)
+    {
+        if (perf->pages[i])
+        {
+            munmap(perf->pages[i], (usize_t)page_size);
+            perf->pages[i] = nullptr;
+        }
+        if (perf->handles[i] >= 0)
+        {
+            close(perf->handles[i]);
+            perf->handles[i] = -1;
+        }
+    }
+    perf->valid = 0;
+}
+
+void
+perf_read(perf_t *perf, perf_sample_t *sample)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(perf && sample, ,
+                                  "invalid perf or sample pointer")
+
+    for (uint_t i = 0; i < PERF_COUNTERS; ++i)
+    {
+        sample->values[i] = 0;
+    }
+    sample->valid = 0;
+    if (!perf->valid)
+    {
+        return;
+    }
+
+#if defined(PERF_RDPMC)
+    // Counters that are on the PMU right now are read without the kernel.
+    bool user = true;
+    for (uint_t i = 0; user && i < PERF_COUNTERS; ++i)
+    {
+        if (perf->valid & (1u << i))
+        {
+            user = perf->pages[i]
+                   && perf_rdpmc(perf->pages[i], &sample->values[i]);
+        }
+    }
+    if (user)
+    {
+        sample->valid = perf->valid;
+        return;
+    }
+#endif
+
+    // The group reads as its count and the values in the order the counters
+    // were opened, raw like those of rdpmc, so that the samples of a
+    // difference agree wherever they were read.
+    ullong_t buffer[1 + PERF_COUNTERS];
+    sint_t   leader = perf->handles[bitflag_ctz32(perf->valid)];
+    ssize_t  size;
+    do
+    {
+        size = read(leader, buffer, sizeof(buffer));
+    } while (size < 0 && errno == EINTR);
+    if (size < (ssize_t)sizeof(ullong_t))
+    {
+        return;
+    }
+
+    uint_t next = 1;
+    for (uint_t i = 0; i < PERF_COUNTERS && next < 1 + buffer[0]; ++i)
+    {
+        if (perf->valid & (1u << i))
+        {
+            sample->values[i] = buffer[next++];
+        }
+    }
+    sample->valid = perf->valid;
+}
@@ -0,0 +1,85 @@
+#include <liquid/exception.h>
+#include <liquid/perf.h>
+
+#if !defined(LIQUID_TARGET_OS_LINUX)
+bool
+perf_open(perf_t *perf)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(perf, false, "invalid perf pointer")
+
+    // Only Linux lets a thread count its own events, elsewhere the group
+    // stays empty.
+    for (uint_t i = 0; i < PERF_COUNTERS; ++i)
+    {
+        perf->handles[i] = -1;
+        perf->pages[i] = nullptr;
+    }
+    perf->valid = 0;
+    return false;
+}
+
+void
+perf_close(perf_t *perf)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(perf, , "invalid perf pointer")
+}
+
+void
+perf_read(perf_t *perf, perf_sample_t *sample)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(perf && sample, ,
+                                  "invalid perf or sample pointer")
+
+    for (uint_t i = 0; i < PERF_COUNTERS; ++i)
+    {
+        sample->values[i] = 0;
+    }
+    sample->valid = 0;
+}
+#endif
+
+void
+perf_sample_delta(const perf_sample_t *start, const perf_sample_t *end,
+                  perf_sample_t *delta)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(start && end && delta, ,
+                                  "invalid sample pointers")
+
+    delta->valid = start->valid & end->valid;
+    for (uint_t i = 0; i < PERF_COUNTERS; ++i)
+    {
+        // A later sample that reads lower, as from another group, counts
+        // nothing.
+        bool counted = (delta->valid >> i) & 1
+                       && end->values[i] > start->values[i];
+        delta->values[i] = counted ? end->values[i] - start->values[i] : 0;
+    }
+}
+
+double
+perf_ipc(const perf_sample_t *sample)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(sample, 0.0, "invalid sample pointer")
+
+    if (!(sample->valid & (1u << PERF_CYCLES))
+        || !(sample->valid & (1u << PERF_INSTRUCTIONS))
+        || !sample->values[PERF_CYCLES])
+    {
+        return 0.0;
+    }
+    return (double)sample->values[PERF_INSTRUCTIONS]
+           / (double)sample->values[PERF_CYCLES];
+}
+
+double
+perf_per_unit(const perf_sample_t *sample, uint_t index, double units)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(sample && index < PERF_COUNTERS, 0.0,
+                                  "invalid sample pointer or index")
+
+    if (!(sample->valid & (1u << index)) || units <= 0.0)
+    {
+        return 0.0;
+    }
+    return (double)sample->values[index] / units;
+}
@@ -0,0 +1,148 @@
+#include <liquid/array-raw.h>
+#include <liquid/bool.h>
+#include <liquid/checked.h>
+#include <liquid/exception.h>
+#include <liquid/pool.h>
+
+/**
+ * @def POOL_CHUNK_HEADER
+ * @brief The aligned size of the chunk header preceding the blocks.
+ */
+#define POOL_CHUNK_HEADER LIQUID_ALLOC_ALIGN(sizeof(pool_chunk_t))
+
+void
+pool_init(pool_t *pool, const allocator_t *parent, usize_t item_size,
+          usize_t chunk_items)
+{
+    // A released block stores the next pointer of the free list.
+    if (item_size < sizeof(void *))
+    {
+        item_size = sizeof(void *);
+    }
+
+    pool->allocator.fn = pool_alloc_fn;
+    pool->allocator.ctx = pool;
+    pool->parent = parent;
+    pool->chunk = nullptr;
+    pool->free_list = nullptr;
+    pool->item_size = LIQUID_ALLOC_ALIGN(item_size);
+    pool->chunk_items = chunk_items ? chunk_items : LIQUID_POOL_CHUNK_ITEMS;
+}
+
+void
+pool_free(pool_t *pool)
+{
+    while (pool->chunk)
+    {
+        pool_chunk_t *prev = pool->chunk->prev;
+        alloc_delete(pool->parent, pool->chunk, pool->chunk->size);
+        pool->chunk = prev;
+    }
+    pool->free_list = nullptr;
+}
+
+/**
+ * @brief Allocates a new chunk and threads its blocks into the free list.
+ * @param pool The pool to grow.
+ * @return True on success.
+ */
+static bool
+pool_grow(pool_t *pool)
+{
+    usize_t size;
+    if (!checked_mul_add_usize(pool->item_size, pool->chunk_items,
+                               POOL_CHUNK_HEADER, &size))
+    {
+        return false;
+    }
+
+    pool_chunk_t *chunk = alloc_new(pool->parent, size);
+    if (!chunk)
+    {
+        return false;
+    }
+
+    chunk->prev = pool->chunk;
+    chunk->size = size;
+    pool->chunk = chunk;
+
+    // Thread the blocks backwards so they are handed out in address order.
+    uchar_t *item = (uchar_t *)chunk + size;
+    for (usize_t i = 0; i < pool->chunk_items; ++i)
+    {
+        item -= pool->item_size;
+        *(void **)item = pool->free_list;
+        pool->free_list = item;
+    }
+    return true;
+}
+
+void *
+pool_alloc(pool_t *pool)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(pool, nullptr, "invalid pool pointer")
+
+    if (!pool->free_list && !pool_grow(pool))
+    {
+        return nullptr;
+    }
+
+    void *item = pool->free_list;
+    pool->free_list = *(void **)item;
+    return item;
+}
+
+void
+pool_release(pool_t *pool, void *ptr)
+{
+    if (ptr)
+    {
+        *(void **)ptr = pool->free_list;
+        pool->free_list = ptr;
+    }
+}
+
+void *
+pool_alloc_fn(void *ctx, void *ptr, usize_t old_size, usize_t new_size)
+{
+    pool_t *pool = (pool_t *)ctx;
+
+    // Blocks larger than an item never come from the chunks.
+    const bool was_pooled = ptr && old_size <= pool->item_size;
+    const bool pooled = new_size && new_size <= pool->item_size;
+
+    if (ptr && !was_pooled && !pooled)
+    {
+        return alloc_resize(pool->parent, ptr, old_size, new_size);
+    }
+
+    if (was_pooled && pooled)
+    {
+        return ptr;
+    }
+
+    void *block = nullptr;
+    if (new_size)
+    {
+        block = pooled ? pool_alloc(pool) : alloc_new(pool->parent, new_size);
+        if (!block)
+        {
+            return nullptr;
+        }
+        if (ptr)
+        {
+            array_raw_copy(block, ptr,
+                           old_size < new_size ? old_size : new_size);
+        }
+    }
+
+    if (was_pooled)
+    {
+        pool_release(pool, ptr);
+    }
+    else if (ptr)
+    {
+        alloc_delete(pool->parent, ptr, old_size);
+    }
+    return block;
+}
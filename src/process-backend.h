@@ -0,0 +1,60 @@
+/**
+ * @file process-backend.h
+ * @brief The functions of the system backend of the processes on POSIX
+ *        systems.
+ *
+ * process-posix.c implements the processes on top of these functions,
+ * which start a child and wait for it the fastest way a system has. They
+ * are implemented in process-linux.c and process-darwin.c.
+ */
+
+#ifndef LIQUID_PROCESS_BACKEND_H
+#define LIQUID_PROCESS_BACKEND_H
+
+#include <liquid/process.h>
+
+/**
+ * @brief Creates a pipe whose ends are closed on exec.
+ * @param ends The end to read from, then the end to write to.
+ * @return True on success, false on failure.
+ */
+bool
+process_backend_pipe(fs_handle_t ends[2]);
+
+/**
+ * @brief Starts a child, setting its identifier and handle.
+ *
+ * @param process The child.
+ * @param options The program, its arguments and its directory.
+ * @param stdio The handles the streams of the child are duplicated from,
+ *              all above the standard streams, or FS_INVALID_HANDLE for
+ *              those inherited.
+ * @return True on success, false if the program could not be executed,
+ *         when there is no child left behind.
+ */
+bool
+process_backend_start(process_t *process, const process_options_t *options,
+                      const fs_handle_t stdio[3]);
+
+/**
+ * @brief Waits for a child to exit without collecting its status.
+ *
+ * @param process The child.
+ * @param timeout The milliseconds to wait, more than 0.
+ * @return True once the child has exited, false if it still runs after
+ *         the timeout, with ETIMEDOUT, or on failure.
+ */
+bool
+process_backend_wait(process_t *process, sint_t timeout);
+
+/**
+ * @brief Sends a signal to a child that was not waited for.
+ *
+ * @param process The child.
+ * @param signal The signal.
+ * @return True on success, false on failure.
+ */
+bool
+process_backend_signal(process_t *process, sint_t signal);
+
+#endif // LIQUID_PROCESS_BACKEND_H
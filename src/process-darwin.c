@@ -0,0 +1,145 @@
+#include "process-backend.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/event.h>
+#include <time.h>
+#include <unistd.h>
+
+extern char **environ;
+
+bool
+process_backend_pipe(fs_handle_t ends[2])
+{
+    // Without pipe2 the flags follow, POSIX_SPAWN_CLOEXEC_DEFAULT keeps the
+    // ends from the children spawned here in between.
+    if (pipe(ends))
+    {
+        return false;
+    }
+    if (fcntl(ends[0], F_SETFD, FD_CLOEXEC)
+        || fcntl(ends[1], F_SETFD, FD_CLOEXEC))
+    {
+        sint_t error = errno;
+        close(ends[0]);
+        close(ends[1]);
+        errno = error;
+        return false;
+    }
+    return true;
+}
+
+bool
+process_backend_start(process_t *process, const process_options_t *options,
+                      const fs_handle_t stdio[3])
+{
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t          attributes;
+    sint_t                     error = posix_spawn_file_actions_init(&actions);
+    if (error)
+    {
+        errno = error;
+        return false;
+    }
+    error = posix_spawnattr_init(&attributes);
+    if (error)
+    {
+        posix_spawn_file_actions_destroy(&actions);
+        errno = error;
+        return false;
+    }
+
+    // Every other handle is closed in the child, also those of the parent
+    // that are not closed on exec.
+    for (uint_t stream = PROCESS_STDIN; !error && stream <= PROCESS_STDERR;
+         ++stream)
+    {
+        error = stdio[stream] < 0
+                    ? posix_spawn_file_actions_addinherit_np(&actions,
+                                                             (sint_t)stream)
+                    : posix_spawn_file_actions_adddup2(&actions, stdio[stream],
+                                                       (sint_t)stream);
+    }
+    if (!error && options->directory)
+    {
+        error = posix_spawn_file_actions_addchdir_np(&actions,
+                                                     options->directory);
+    }
+
+    // The handlers of the parent are reset, what it ignores stays ignored.
+    sigset_t handled;
+    sigemptyset(&handled);
+    for (sint_t signal = 1; signal < NSIG; ++signal)
+    {
+        struct sigaction action;
+        if (!sigaction(signal, nullptr, &action)
+            && action.sa_handler != SIG_IGN && action.sa_handler != SIG_DFL)
+        {
+            sigaddset(&handled, signal);
+        }
+    }
+    if (!error)
+    {
+        error = posix_spawnattr_setsigdefault(&attributes, &handled);
+    }
+    if (!error)
+    {
+        error = posix_spawnattr_setflags(
+            &attributes, POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_CLOEXEC_DEFAULT);
+    }
+
+    pid_t id = 0;
+    if (!error)
+    {
+        error = posix_spawnp(
+            &id, options->argv[0], &actions, &attributes,
+            (char *const *)options->argv,
+            options->env ? (char *const *)options->env : environ);
+    }
+    posix_spawnattr_destroy(&attributes);
+    posix_spawn_file_actions_destroy(&actions);
+    if (error)
+    {
+        errno = error;
+        return false;
+    }
+    process->id = id;
+    return true;
+}
+
+bool
+process_backend_wait(process_t *process, sint_t timeout)
+{
+    sint_t queue = kqueue();
+    if (queue < 0)
+    {
+        return false;
+    }
+
+    struct kevent   change, event;
+    struct timespec time = {timeout / 1000, timeout % 1000 * 1000000L};
+    EV_SET(&change, process->id, EVFILT_PROC, EV_ADD | EV_ONESHOT, NOTE_EXIT,
+           0, nullptr);
+    sint_t count = kevent(queue, &change, 1, &event, 1, &time);
+    sint_t error = errno;
+    close(queue);
+    if (count > 0 && event.flags & EV_ERROR)
+    {
+        // A child that exited already cannot be registered any more.
+        if (event.data == ESRCH)
+        {
+            return true;
+        }
+        error = (sint_t)event.data;
+        count = -1;
+    }
+    errno = count ? error : ETIMEDOUT;
+    return count > 0;
+}
+
+bool
+process_backend_signal(process_t *process, sint_t signal)
+{
+    return !kill(process->id, signal);
+}
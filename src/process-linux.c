@@ -0,0 +1,276 @@
+#ifndef _GNU_SOURCE
+    #define _GNU_SOURCE
+#endif
+
+#include "process-backend.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef CLONE_PIDFD
+    #define CLONE_PIDFD 0x00001000
+#endif
+
+/**
+ * @def PROCESS_STACK_SIZE
+ * @brief The size of the stack the child runs on until it executes the
+ *        program, which holds a path of PATH_MAX.
+ */
+#define PROCESS_STACK_SIZE (64 * 1024)
+
+/**
+ * @struct process_child
+ * @brief What the child needs, on the stack of the parent, which waits.
+ */
+typedef struct process_child
+{
+    const process_options_t *options; ///< The program and its arguments.
+    char *const             *env;     ///< The environment of the program.
+    const char              *path;    ///< The PATH of the parent.
+    const fs_handle_t       *stdio;   ///< The streams of the child.
+    sigset_t                 mask;    ///< The signal mask of the parent.
+    volatile sint_t          error;   ///< Why the child did not execute.
+} process_child_t;
+
+/**
+ * @brief Executes the program of a child, looking it up in the PATH when
+ *        its name has no slash.
+ *
+ * @param child The child.
+ */
+static void
+process_child_exec(process_child_t *child)
+{
+    const char  *program = child->options->argv[0];
+    char *const *argv = (char *const *)child->options->argv;
+    if (strchr(program, '/') || !child->path)
+    {
+        execve(program, argv, child->env);
+        return;
+    }
+
+    // Like execvp, the lookup goes on past directories that do not have
+    // the program or deny it, and fails with EACCES if any denied it.
+    char    path[PATH_MAX];
+    usize_t length = strlen(program);
+    sint_t  error = ENOENT;
+    for (const char *directory = child->path;;)
+    {
+        const char *end = strchrnul(directory, ':');
+        usize_t     size = (usize_t)(end - directory);
+        if (size + length + 2 <= sizeof(path))
+        {
+            // An empty entry is the current directory.
+            memcpy(path, directory, size);
+            if (size)
+            {
+                path[size++] = '/';
+            }
+            memcpy(path + size, program, length + 1);
+            execve(path, argv, child->env);
+            if (errno == EACCES)
+            {
+                error = EACCES;
+            }
+            else if (errno != ENOENT && errno != ENOTDIR)
+            {
+                return;
+            }
+        }
+        if (!*end)
+        {
+            break;
+        }
+        directory = end + 1;
+    }
+    errno = error;
+}
+
+/**
+ * @brief Runs in the child, on the memory of the parent, until it
+ *        executes the program.
+ *
+ * Only system calls are made, the parent does not run until the program
+ * is executed or the child exits.
+ *
+ * @param data The child.
+ * @return Nothing, the child executes the program or exits.
+ */
+static int
+process_child_main(void *data)
+{
+    process_child_t *child = data;
+
+    // The handlers of the parent must not run in its memory, what the
+    // parent ignores stays ignored for the program.
+    for (sint_t signal = 1; signal < NSIG; ++signal)
+    {
+        struct sigaction action;
+        if (!sigaction(signal, nullptr, &action)
+            && action.sa_handler != SIG_IGN && action.sa_handler != SIG_DFL)
+        {
+            action.sa_handler = SIG_DFL;
+            action.sa_flags = 0;
+            sigemptyset(&action.sa_mask);
+            sigaction(signal, &action, nullptr);
+        }
+    }
+
+    // The handles are above the standard streams, so dup2 clears their
+    // close-on-exec flag and overwrites none of the others.
+    bool ok = true;
+    for (uint_t stream = PROCESS_STDIN; ok && stream <= PROCESS_STDERR;
+         ++stream)
+    {
+        ok = child->stdio[stream] < 0
+             || dup2(child->stdio[stream], (sint_t)stream) >= 0;
+    }
+    if (ok && child->options->directory)
+    {
+        ok = !chdir(child->options->directory);
+    }
+    if (ok)
+    {
+        sigprocmask(SIG_SETMASK, &child->mask, nullptr);
+        process_child_exec(child);
+    }
+    child->error = errno;
+    _exit(127);
+}
+
+bool
+process_backend_pipe(fs_handle_t ends[2])
+{
+    return !pipe2(ends, O_CLOEXEC);
+}
+
+bool
+process_backend_start(process_t *process, const process_options_t *options,
+                      const fs_handle_t stdio[3])
+{
+    process_child_t child;
+    child.options = options;
+    child.env = options->env ? (char *const *)options->env : environ;
+    child.path = getenv("PATH");
+    child.stdio = stdio;
+    child.error = 0;
+
+    void *stack = mmap(nullptr, PROCESS_STACK_SIZE, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (stack == MAP_FAILED)
+    {
+        return false;
+    }
+
+    // No signal is handled in the child before it resets the handlers.
+    sigset_t all;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &child.mask);
+
+    // CLONE_VFORK suspends the parent until the child executes the program
+    // or exits, so the stack and the child are free afterwards.
+    void  *top = (uchar_t *)stack + PROCESS_STACK_SIZE;
+    sint_t flags = CLONE_VM | CLONE_VFORK | SIGCHLD;
+    sint_t pidfd = -1;
+    pid_t  id = clone(process_child_main, top, flags | CLONE_PIDFD, &child,
+                      &pidfd);
+    if (id < 0 && errno == EINVAL)
+    {
+        // Kernels before 5.2 have no CLONE_PIDFD.
+        pidfd = -1;
+        id = clone(process_child_main, top, flags, &child);
+    }
+    sint_t error = errno;
+    pthread_sigmask(SIG_SETMASK, &child.mask, nullptr);
+    munmap(stack, PROCESS_STACK_SIZE);
+    if (id < 0)
+    {
+        errno = error;
+        return false;
+    }
+
+    if (child.error)
+    {
+        // The child exited at once, it is collected so that no zombie is
+        // left behind.
+        while (waitpid(id, nullptr, 0) < 0 && errno == EINTR)
+        {
+        }
+        if (pidfd >= 0)
+        {
+            close(pidfd);
+        }
+        errno = child.error;
+        return false;
+    }
+    process->id = id;
+    process->handle = pidfd;
+    return true;
+}
+
+bool
+process_backend_wait(process_t *process, sint_t timeout)
+{
+    if (process->handle >= 0)
+    {
+        struct pollfd ready = {process->handle, POLLIN, 0};
+        sint_t        count;
+        do
+        {
+            count = poll(&ready, 1, timeout);
+        } while (count < 0 && errno == EINTR);
+        if (!count)
+        {
+            errno = ETIMEDOUT;
+        }
+        return count > 0;
+    }
+
+    // Without a pidfd the child is checked every millisecond.
+    for (sint_t waited = 0;; ++waited)
+    {
+        siginfo_t info;
+        info.si_pid = 0;
+        if (waitid(P_PID, (id_t)process->id, &info,
+                   WEXITED | WNOHANG | WNOWAIT)
+            && errno != EINTR)
+        {
+            return false;
+        }
+        if (info.si_pid)
+        {
+            return true;
+        }
+        if (waited >= timeout)
+        {
+            errno = ETIMEDOUT;
+            return false;
+        }
+        struct timespec pause = {0, 1000000};
+        nanosleep(&pause, nullptr);
+    }
+}
+
+bool
+process_backend_signal(process_t *process, sint_t signal)
+{
+#if defined(SYS_pidfd_send_signal)
+    // The pidfd cannot refer to another process that reused the identifier.
+    if (process->handle >= 0)
+    {
+        return !syscall(SYS_pidfd_send_signal, process->handle, signal,
+                        nullptr, 0);
+    }
+#endif
+    return !kill(process->id, signal);
+}
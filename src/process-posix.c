@@ -0,0 +1,168 @@
+#include "process-backend.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <liquid/exception.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * @brief Moves a handle of the child above the standard streams, so that
+ *        duplicating it onto one of them cannot overwrite another.
+ *
+ * @param handle The handle, replaced by the moved one.
+ * @return True on success, false on failure.
+ */
+static bool
+process_lift(fs_handle_t *handle)
+{
+    if (*handle > PROCESS_STDERR)
+    {
+        return true;
+    }
+    fs_handle_t lifted = fcntl(*handle, F_DUPFD_CLOEXEC, PROCESS_STDERR + 1);
+    if (lifted < 0)
+    {
+        return false;
+    }
+    close(*handle);
+    *handle = lifted;
+    return true;
+}
+
+/**
+ * @brief Opens the handles of the streams of a child.
+ *
+ * @param options The streams of the child.
+ * @param parent Receives the ends of the pipes of the parent.
+ * @param child Receives the handles of the child.
+ * @return True on success, false on failure, when all are closed.
+ */
+static bool
+process_open_stdio(const process_options_t *options,
+                   fs_handle_t parent[3], fs_handle_t child[3])
+{
+    for (uint_t stream = PROCESS_STDIN; stream <= PROCESS_STDERR; ++stream)
+    {
+        parent[stream] = FS_INVALID_HANDLE;
+        child[stream] = FS_INVALID_HANDLE;
+    }
+
+    for (uint_t stream = PROCESS_STDIN; stream <= PROCESS_STDERR; ++stream)
+    {
+        bool ok = true;
+        if (options->stdio[stream] == PROCESS_PIPE)
+        {
+            // The child reads its input and writes the rest.
+            fs_handle_t ends[2];
+            uint_t      own = stream == PROCESS_STDIN;
+            ok = process_backend_pipe(ends);
+            if (ok)
+            {
+                parent[stream] = ends[own];
+                child[stream] = ends[!own];
+            }
+            if (ok && options->flags & PROCESS_ASYNC)
+            {
+                sint_t flags = fcntl(parent[stream], F_GETFL);
+                ok = flags >= 0
+                     && fcntl(parent[stream], F_SETFL, flags | O_NONBLOCK)
+                            == 0;
+            }
+        }
+        else if (options->stdio[stream] == PROCESS_NULL)
+        {
+            child[stream] = open("/dev/null", O_RDWR | O_CLOEXEC);
+            ok = child[stream] >= 0;
+        }
+        if (!ok || (child[stream] >= 0 && !process_lift(&child[stream])))
+        {
+            sint_t error = errno;
+            for (uint_t i = PROCESS_STDIN; i <= stream; ++i)
+            {
+                fs_close(parent[i]);
+                fs_close(child[i]);
+            }
+            errno = error;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+process_spawn(process_t *process, const process_options_t *options)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(process && options && options->argv
+                                      && options->argv[0],
+                                  false, "invalid process or options")
+
+    fs_handle_t child[3];
+    process->id = 0;
+    process->handle = FS_INVALID_HANDLE;
+    process->status = 0;
+    process->exited = 0;
+    if (!process_open_stdio(options, process->stdio, child))
+    {
+        return false;
+    }
+
+    bool   ok = process_backend_start(process, options, child);
+    sint_t error = errno;
+    for (uint_t stream = PROCESS_STDIN; stream <= PROCESS_STDERR; ++stream)
+    {
+        fs_close(child[stream]);
+        if (!ok)
+        {
+            process_close_pipe(process, stream);
+        }
+    }
+    errno = error;
+    return ok;
+}
+
+bool
+process_wait(process_t *process, sint_t timeout)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(process, false, "invalid process pointer")
+
+    if (process->exited)
+    {
+        return true;
+    }
+    if (timeout > 0 && !process_backend_wait(process, timeout))
+    {
+        return false;
+    }
+
+    // After a timeout the child has exited, so waitpid does not block.
+    sint_t status;
+    pid_t  waited;
+    do
+    {
+        waited = waitpid(process->id, &status, timeout ? 0 : WNOHANG);
+    } while (waited < 0 && errno == EINTR);
+    if (waited <= 0)
+    {
+        if (!waited)
+        {
+            errno = ETIMEDOUT;
+        }
+        return false;
+    }
+
+    process->status =
+        WIFSIGNALED(status) ? -WTERMSIG(status) : WEXITSTATUS(status);
+    process->exited = 1;
+    return true;
+}
+
+bool
+process_kill(process_t *process, uint_t force)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(process, false, "invalid process pointer")
+
+    // The identifier of a child that was waited for may be reused already.
+    return process->exited
+           || process_backend_signal(process, force ? SIGKILL : SIGTERM);
+}
@@ -0,0 +1,472 @@
+#include <liquid/alloc.h>
+#include <liquid/exception.h>
+#include <liquid/os.h>
+#include <liquid/process.h>
+#include <windows.h>
+
+/**
+ * @def PROCESS_PIPE_SIZE
+ * @brief The size of the buffers of a pipe.
+ */
+#define PROCESS_PIPE_SIZE (64 * 1024)
+
+/**
+ * @def PROCESS_PIPE_NAME
+ * @brief The size of the name of an overlapped pipe.
+ */
+#define PROCESS_PIPE_NAME 64
+
+/**
+ * @brief The number of the next overlapped pipe of the process.
+ */
+static volatile LONG m_pipes;
+
+/**
+ * @brief Makes a handle of the child inheritable, for the child only as it
+ *        is passed in the handle list of the child.
+ *
+ * @param handle The handle, replaced by the inheritable one.
+ * @param owned Whether the handle was opened for the child, which closes
+ *              it, rather than being a handle of the parent.
+ * @return True on success, false on failure, when an owned handle is
+ *         closed.
+ */
+static bool
+process_inheritable(HANDLE *handle, bool owned)
+{
+    HANDLE inheritable = nullptr;
+    if (!DuplicateHandle(cur_proc(), *handle, cur_proc(), &inheritable, 0,
+                         TRUE,
+                         DUPLICATE_SAME_ACCESS
+                             | (owned ? DUPLICATE_CLOSE_SOURCE : 0)))
+    {
+        *handle = nullptr;
+        return false;
+    }
+    *handle = inheritable;
+    return true;
+}
+
+/**
+ * @brief Creates an overlapped pipe, which anonymous pipes cannot be.
+ *
+ * @param parent Receives the end of the parent.
+ * @param child Receives the end of the child.
+ * @param input Whether the child reads from the pipe.
+ * @return True on success, false on failure.
+ */
+static bool
+process_pipe_overlapped(HANDLE *parent, HANDLE *child, bool input)
+{
+    // The name is unique to the process and the pipe.
+    static const char_t prefix[] = TEXT("\\\\.\\pipe\\liquid.");
+    static const char_t digits[] = TEXT("0123456789abcdef");
+
+    char_t   name[PROCESS_PIPE_NAME];
+    usize_t  size = 0;
+    ullong_t unique = (ullong_t)GetCurrentProcessId() << 32
+                      | (ULONG)InterlockedIncrement(&m_pipes);
+    for (const char_t *c = prefix; *c; ++c)
+    {
+        name[size++] = *c;
+    }
+    for (sint_t shift = 60; shift >= 0; shift -= 4)
+    {
+        name[size++] = digits[unique >> shift & 0xf];
+    }
+    name[size] = 0;
+
+    *parent = CreateNamedPipe(
+        name,
+        (input ? PIPE_ACCESS_OUTBOUND : PIPE_ACCESS_INBOUND)
+            | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+        PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT
+            | PIPE_REJECT_REMOTE_CLIENTS,
+        1, PROCESS_PIPE_SIZE, PROCESS_PIPE_SIZE, 0, nullptr);
+    if (*parent == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    *child = CreateFile(
+        name, input ? GENERIC_READ | FILE_WRITE_ATTRIBUTES : GENERIC_WRITE, 0,
+        nullptr, OPEN_EXISTING, 0, nullptr);
+    if (*child == INVALID_HANDLE_VALUE)
+    {
+        DWORD error = GetLastError();
+        CloseHandle(*parent);
+        *parent = INVALID_HANDLE_VALUE;
+        *child = nullptr;
+        SetLastError(error);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Opens the handles of the streams of a child.
+ *
+ * @param options The streams of the child.
+ * @param parent Receives the ends of the pipes of the parent.
+ * @param child Receives the inheritable handles of the child, nullptr for
+ *              none.
+ * @return True on success, false on failure, when all are closed.
+ */
+static bool
+process_open_stdio(const process_options_t *options, HANDLE parent[3],
+                   HANDLE child[3])
+{
+    static const DWORD standard[] = {STD_INPUT_HANDLE, STD_OUTPUT_HANDLE,
+                                     STD_ERROR_HANDLE};
+
+    for (uint_t stream = PROCESS_STDIN; stream <= PROCESS_STDERR; ++stream)
+    {
+        parent[stream] = FS_INVALID_HANDLE;
+        child[stream] = nullptr;
+    }
+
+    for (uint_t stream = PROCESS_STDIN; stream <= PROCESS_STDERR; ++stream)
+    {
+        bool input = stream == PROCESS_STDIN;
+        bool ok = true;
+        if (options->stdio[stream] == PROCESS_PIPE)
+        {
+            if (options->flags & PROCESS_ASYNC)
+            {
+                ok = process_pipe_overlapped(&parent[stream], &child[stream],
+                                             input);
+            }
+            else
+            {
+                HANDLE read, write;
+                ok = CreatePipe(&read, &write, nullptr, PROCESS_PIPE_SIZE)
+                     != FALSE;
+                if (ok)
+                {
+                    parent[stream] = input ? write : read;
+                    child[stream] = input ? read : write;
+                }
+            }
+            ok = ok && process_inheritable(&child[stream], true);
+        }
+        else if (options->stdio[stream] == PROCESS_NULL)
+        {
+            child[stream] = CreateFile(TEXT("NUL"),
+                                       GENERIC_READ | GENERIC_WRITE,
+                                       FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                       nullptr, OPEN_EXISTING, 0, nullptr);
+            ok = child[stream] != INVALID_HANDLE_VALUE
+                 && process_inheritable(&child[stream], true);
+        }
+        else
+        {
+            // A parent without a console has no standard handles to pass.
+            HANDLE inherited = GetStdHandle(standard[stream]);
+            if (inherited && inherited != INVALID_HANDLE_VALUE)
+            {
+                child[stream] = inherited;
+                ok = process_inheritable(&child[stream], false);
+            }
+        }
+
+        if (!ok)
+        {
+            DWORD error = GetLastError();
+            if (child[stream] == INVALID_HANDLE_VALUE)
+            {
+                child[stream] = nullptr;
+            }
+            for (uint_t i = PROCESS_STDIN; i <= stream; ++i)
+            {
+                fs_close(parent[i]);
+                if (child[i])
+                {
+                    CloseHandle(child[i]);
+                }
+            }
+            SetLastError(error);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Appends an argument to a command line, quoted the way
+ *        CommandLineToArgvW and the C runtime split it.
+ *
+ * @param line The end of the command line, with room for twice the
+ *             argument and its quotes.
+ * @param argument The argument.
+ * @return The new end of the command line.
+ */
+static char_t *
+process_quote(char_t *line, const char_t *argument)
+{
+    bool plain = *argument != 0;
+    for (const char_t *c = argument; plain && *c; ++c)
+    {
+        plain = *c != ' ' && *c != '\t' && *c != '\n' && *c != '\v'
+                && *c != '"';
+    }
+    if (plain)
+    {
+        while (*argument)
+        {
+            *line++ = *argument++;
+        }
+        return line;
+    }
+
+    // Backslashes are literal unless they come before a quote, their own
+    // or the closing one, when they are doubled.
+    *line++ = '"';
+    for (;;)
+    {
+        usize_t slashes = 0;
+        while (*argument == '\\')
+        {
+            ++slashes;
+            ++argument;
+        }
+        if (!*argument || *argument == '"')
+        {
+            slashes = slashes * 2 + (*argument == '"');
+        }
+        for (; slashes; --slashes)
+        {
+            *line++ = '\\';
+        }
+        if (!*argument)
+        {
+            break;
+        }
+        *line++ = *argument++;
+    }
+    *line++ = '"';
+    return line;
+}
+
+/**
+ * @brief Builds the command line of a child from its arguments.
+ * @param argv The arguments, ending with nullptr.
+ * @param size Receives the size of the allocation.
+ * @return The command line, nullptr if it could not be allocated.
+ */
+static char_t *
+process_command_line(const char_t *const *argv, usize_t *size)
+{
+    *size = 1;
+    for (const char_t *const *argument = argv; *argument; ++argument)
+    {
+        *size += (usize_t)lstrlen(*argument) * 2 + 3;
+    }
+    *size *= sizeof(char_t);
+
+    char_t *line = alloc_new(alloc_system(), *size);
+    if (!line)
+    {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return nullptr;
+    }
+    char_t *end = line;
+    for (const char_t *const *argument = argv; *argument; ++argument)
+    {
+        if (end != line)
+        {
+            *end++ = ' ';
+        }
+        end = process_quote(end, *argument);
+    }
+    *end = 0;
+    return line;
+}
+
+/**
+ * @brief Builds the environment block of a child, its variables each
+ *        ending with a zero and the block with another one.
+ *
+ * @param env The variables, ending with nullptr.
+ * @param size Receives the size of the allocation.
+ * @return The block, nullptr if it could not be allocated.
+ */
+static char_t *
+process_environment(const char_t *const *env, usize_t *size)
+{
+    *size = 2;
+    for (const char_t *const *variable = env; *variable; ++variable)
+    {
+        *size += (usize_t)lstrlen(*variable) + 1;
+    }
+    *size *= sizeof(char_t);
+
+    char_t *block = alloc_new(alloc_system(), *size);
+    if (!block)
+    {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return nullptr;
+    }
+    char_t *end = block;
+    for (const char_t *const *variable = env; *variable; ++variable)
+    {
+        for (const char_t *c = *variable; *c; ++c)
+        {
+            *end++ = *c;
+        }
+        *end++ = 0;
+    }
+    end[0] = 0;
+    end[1] = 0;
+    return block;
+}
+
+bool
+process_spawn(process_t *process, const process_options_t *options)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(process && options && options->argv
+                                      && options->argv[0],
+                                  false, "invalid process or options")
+
+    HANDLE child[3];
+    process->id = 0;
+    process->handle = FS_INVALID_HANDLE;
+    process->status = 0;
+    process->exited = 0;
+    if (!process_open_stdio(options, process->stdio, child))
+    {
+        return false;
+    }
+
+    // Only the handles in the list are inherited, not every inheritable
+    // handle of the parent, such as those of children spawned meanwhile.
+    HANDLE  handles[3];
+    DWORD   count = 0;
+    usize_t line_size = 0, env_size = 0;
+    SIZE_T  list_size = 0;
+    LPPROC_THREAD_ATTRIBUTE_LIST list = nullptr;
+    for (uint_t stream = PROCESS_STDIN; stream <= PROCESS_STDERR; ++stream)
+    {
+        if (child[stream])
+        {
+            handles[count++] = child[stream];
+        }
+    }
+    InitializeProcThreadAttributeList(nullptr, 1, 0, &list_size);
+
+    char_t *line = process_command_line(options->argv, &line_size);
+    char_t *env = line && options->env
+                      ? process_environment(options->env, &env_size)
+                      : nullptr;
+    bool    ok = line && (env || !options->env);
+    if (ok && count)
+    {
+        list = alloc_new(alloc_system(), list_size);
+        if (list && !InitializeProcThreadAttributeList(list, 1, 0, &list_size))
+        {
+            alloc_delete(alloc_system(), list, list_size);
+            list = nullptr;
+        }
+        ok = list
+             && UpdateProcThreadAttribute(
+                 list, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST, handles,
+                 count * sizeof(HANDLE), nullptr, nullptr);
+    }
+
+    PROCESS_INFORMATION information;
+    if (ok)
+    {
+        STARTUPINFOEX startup;
+        ZeroMemory(&startup, sizeof(startup));
+        startup.StartupInfo.cb = sizeof(startup);
+        startup.StartupInfo.dwFlags = STARTF_USESTDHANDLES;
+        startup.StartupInfo.hStdInput = child[PROCESS_STDIN];
+        startup.StartupInfo.hStdOutput = child[PROCESS_STDOUT];
+        startup.StartupInfo.hStdError = child[PROCESS_STDERR];
+        startup.lpAttributeList = list;
+
+        DWORD flags = list ? EXTENDED_STARTUPINFO_PRESENT : 0;
+#if defined(UNICODE)
+        flags |= CREATE_UNICODE_ENVIRONMENT;
+#endif
+        ok = CreateProcess(nullptr, line, nullptr, nullptr, list != nullptr,
+                           flags, env, options->directory,
+                           &startup.StartupInfo, &information)
+             != FALSE;
+    }
+
+    DWORD error = GetLastError();
+    if (list)
+    {
+        DeleteProcThreadAttributeList(list);
+        alloc_delete(alloc_system(), list, list_size);
+    }
+    if (env)
+    {
+        alloc_delete(alloc_system(), env, env_size);
+    }
+    if (line)
+    {
+        alloc_delete(alloc_system(), line, line_size);
+    }
+    for (uint_t stream = PROCESS_STDIN; stream <= PROCESS_STDERR; ++stream)
+    {
+        if (child[stream])
+        {
+            CloseHandle(child[stream]);
+        }
+        if (!ok)
+        {
+            process_close_pipe(process, stream);
+        }
+    }
+    if (!ok)
+    {
+        SetLastError(error);
+        return false;
+    }
+
+    CloseHandle(information.hThread);
+    process->id = information.dwProcessId;
+    process->handle = information.hProcess;
+    return true;
+}
+
+bool
+process_wait(process_t *process, sint_t timeout)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(process, false, "invalid process pointer")
+
+    if (process->exited)
+    {
+        return true;
+    }
+    DWORD result = WaitForSingleObject(process->handle,
+                                       timeout < 0 ? INFINITE : (DWORD)timeout);
+    if (result != WAIT_OBJECT_0)
+    {
+        if (result == WAIT_TIMEOUT)
+        {
+            SetLastError(WAIT_TIMEOUT);
+        }
+        return false;
+    }
+
+    DWORD code;
+    if (!GetExitCodeProcess(process->handle, &code))
+    {
+        return false;
+    }
+    process->status = (sint_t)code;
+    process->exited = 1;
+    return true;
+}
+
+bool
+process_kill(process_t *process, uint_t force)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(process, false, "invalid process pointer")
+
+    // A child that exited already cannot be terminated any more.
+    (void)force;
+    return process->exited || TerminateProcess(process->handle, 1)
+           || WaitForSingleObject(process->handle, 0) == WAIT_OBJECT_0;
+}
@@ -0,0 +1,31 @@
+#include <liquid/exception.h>
+#include <liquid/process.h>
+
+void
+process_close_pipe(process_t *process, uint_t stream)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(process && stream <= PROCESS_STDERR, ,
+                                  "invalid process pointer or stream")
+
+    if (process->stdio[stream] != FS_INVALID_HANDLE)
+    {
+        fs_close(process->stdio[stream]);
+        process->stdio[stream] = FS_INVALID_HANDLE;
+    }
+}
+
+void
+process_close(process_t *process)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(process, , "invalid process pointer")
+
+    for (uint_t stream = PROCESS_STDIN; stream <= PROCESS_STDERR; ++stream)
+    {
+        process_close_pipe(process, stream);
+    }
+    if (process->handle != FS_INVALID_HANDLE)
+    {
+        fs_close(process->handle);
+        process->handle = FS_INVALID_HANDLE;
+    }
+}
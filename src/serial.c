@@ -0,0 +1,434 @@
+#include <liquid/exception.h>
+#include <liquid/serial.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define SERIAL_SIMD_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define SERIAL_SIMD_NEON
+#endif
+
+/**
+ * @def SERIAL_STOP_BITS
+ * @brief The continuation bits of eight bytes loaded as a word.
+ */
+#define SERIAL_STOP_BITS 0x8080808080808080ull
+
+/**
+ * @brief Decodes a varint one byte at a time.
+ *
+ * @param src The first byte of the varint.
+ * @param end The end of the buffer.
+ * @param value Receives the value.
+ * @return Pointer past the varint or nullptr if it is truncated or exceeds
+ *         64 bits.
+ */
+static const uchar_t *
+serial_varint_decode_bytes(const uchar_t *src, const uchar_t *end,
+                           ullong_t *value)
+{
+    ullong_t result = 0;
+    for (uint_t shift = 0; shift < 64; shift += 7)
+    {
+        if (src == end)
+        {
+            return nullptr;
+        }
+
+        uchar_t byte = *src++;
+        result |= (ullong_t)(byte & 0x7F) << shift;
+        if (byte < 0x80)
+        {
+            // The tenth byte only contributes the most significant bit.
+            if (shift == 63 && byte > 1)
+            {
+                return nullptr;
+            }
+            *value = result;
+            return src;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Packs the seven-bit groups of up to eight bytes into a value.
+ * @param word The bytes loaded in little-endian order.
+ * @return The value the groups encode, without the continuation bits.
+ */
+static ullong_t
+serial_varint_compact(ullong_t word)
+{
+#if defined(__BMI2__)
+    return bitflag_pext64(word, ~SERIAL_STOP_BITS);
+#else
+    // Merge neighbouring groups into groups of 14, 28 and 56 bits.
+    word = (word & 0x007F007F007F007Full)
+           | (word & 0x7F007F007F007F00ull) >> 1;
+    word = (word & 0x00003FFF00003FFFull)
+           | (word & 0x3FFF00003FFF0000ull) >> 2;
+    return (word & 0x000000000FFFFFFFull)
+           | (word & 0x0FFFFFFF00000000ull) >> 4;
+#endif
+}
+
+/**
+ * @brief Decodes a varint from a buffer with at least eight bytes left.
+ *
+ * @param src The first byte of the varint.
+ * @param end The end of the buffer.
+ * @param value Receives the value.
+ * @return Pointer past the varint or nullptr if it is malformed.
+ */
+static const uchar_t *
+serial_varint_decode_word(const uchar_t *src, const uchar_t *end,
+                          ullong_t *value)
+{
+    ullong_t word = serial_load_le64(src);
+    ullong_t stops = ~word & SERIAL_STOP_BITS;
+    if (!stops)
+    {
+        // Only values above 56 bits need a ninth or tenth byte.
+        return serial_varint_decode_bytes(src, end, value);
+    }
+
+    uint_t last = bitflag_ctz64(stops);
+    *value = serial_varint_compact(word & (LIQUID_ULLONG_MAX >> (63 - last)));
+    return src + (last + 1) / 8;
+}
+
+/**
+ * @brief Decodes a varint at any position of a buffer.
+ * @see serial_varint_decode_word
+ */
+static const uchar_t *
+serial_varint_decode_next(const uchar_t *src, const uchar_t *end,
+                          ullong_t *value)
+{
+    if (end - src >= 8)
+    {
+        return serial_varint_decode_word(src, end, value);
+    }
+    return serial_varint_decode_bytes(src, end, value);
+}
+
+/**
+ * @brief Encodes a varint.
+ * @see serial_varint_encode64
+ */
+static uchar_t *
+serial_varint_put(uchar_t *dest, ullong_t value)
+{
+    while (value >= 0x80)
+    {
+        *dest++ = (uchar_t)(value | 0x80);
+        value >>= 7;
+    }
+    *dest++ = (uchar_t)value;
+    return dest;
+}
+
+#if defined(SERIAL_SIMD_SSE2)
+/**
+ * @brief Checks which of sixteen bytes continue a varint.
+ *
+ * @param src The bytes.
+ * @param bytes Receives the loaded bytes.
+ * @return A mask with bit i set if byte i has its continuation bit set.
+ */
+static uint_t
+serial_varint_block(const uchar_t *src, __m128i *bytes)
+{
+    *bytes = _mm_loadu_si128((const __m128i *)src);
+    return (uint_t)_mm_movemask_epi8(*bytes);
+}
+
+/**
+ * @brief Stores sixteen single-byte varints as 64-bit values.
+ * @param values The values to write.
+ * @param bytes The varints.
+ */
+static void
+serial_varint_widen64(ullong_t *values, __m128i bytes)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i halves[2] = {_mm_unpacklo_epi8(bytes, zero),
+                         _mm_unpackhi_epi8(bytes, zero)};
+    for (uint_t i = 0; i < 2; ++i)
+    {
+        __m128i low = _mm_unpacklo_epi16(halves[i], zero);
+        __m128i high = _mm_unpackhi_epi16(halves[i], zero);
+        __m128i *dest = (__m128i *)(values + i * 8);
+        _mm_storeu_si128(dest, _mm_unpacklo_epi32(low, zero));
+        _mm_storeu_si128(dest + 1, _mm_unpackhi_epi32(low, zero));
+        _mm_storeu_si128(dest + 2, _mm_unpacklo_epi32(high, zero));
+        _mm_storeu_si128(dest + 3, _mm_unpackhi_epi32(high, zero));
+    }
+}
+
+/**
+ * @brief Stores sixteen single-byte varints as 32-bit values.
+ * @see serial_varint_widen64
+ */
+static void
+serial_varint_widen32(uint_t *values, __m128i bytes)
+{
+    __m128i  zero = _mm_setzero_si128();
+    __m128i  low = _mm_unpacklo_epi8(bytes, zero);
+    __m128i  high = _mm_unpackhi_epi8(bytes, zero);
+    __m128i *dest = (__m128i *)values;
+    _mm_storeu_si128(dest, _mm_unpacklo_epi16(low, zero));
+    _mm_storeu_si128(dest + 1, _mm_unpackhi_epi16(low, zero));
+    _mm_storeu_si128(dest + 2, _mm_unpacklo_epi16(high, zero));
+    _mm_storeu_si128(dest + 3, _mm_unpackhi_epi16(high, zero));
+}
+#elif defined(SERIAL_SIMD_NEON)
+/**
+ * @brief Checks which of sixteen bytes continue a varint.
+ *
+ * @param src The bytes.
+ * @param bytes Receives the loaded bytes.
+ * @return A mask with bit i set if byte i has its continuation bit set.
+ */
+static uint_t
+serial_varint_block(const uchar_t *src, uint8x16_t *bytes)
+{
+    static const uchar_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                        1, 2, 4, 8, 16, 32, 64, 128};
+
+    *bytes = vld1q_u8(src);
+    if (vmaxvq_u8(*bytes) < 0x80)
+    {
+        return 0;
+    }
+
+    uint8x16_t bits =
+        vandq_u8(vcgeq_u8(*bytes, vdupq_n_u8(0x80)), vld1q_u8(weights));
+    return (uint_t)vaddv_u8(vget_low_u8(bits))
+           | (uint_t)vaddv_u8(vget_high_u8(bits)) << 8;
+}
+
+/**
+ * @brief Stores sixteen single-byte varints as 64-bit values.
+ * @param values The values to write.
+ * @param bytes The varints.
+ */
+static void
+serial_varint_widen64(ullong_t *values, uint8x16_t bytes)
+{
+    uint16x8_t halves[2] = {vmovl_u8(vget_low_u8(bytes)),
+                            vmovl_u8(vget_high_u8(bytes))};
+    for (uint_t i = 0; i < 2; ++i)
+    {
+        uint32x4_t low = vmovl_u16(vget_low_u16(halves[i]));
+        uint32x4_t high = vmovl_u16(vget_high_u16(halves[i]));
+        ullong_t  *dest = values + i * 8;
+        vst1q_u64((uint64_t *)dest, vmovl_u32(vget_low_u32(low)));
+        vst1q_u64((uint64_t *)(dest + 2), vmovl_u32(vget_high_u32(low)));
+        vst1q_u64((uint64_t *)(dest + 4), vmovl_u32(vget_low_u32(high)));
+        vst1q_u64((uint64_t *)(dest + 6), vmovl_u32(vget_high_u32(high)));
+    }
+}
+
+/**
+ * @brief Stores sixteen single-byte varints as 32-bit values.
+ * @see serial_varint_widen64
+ */
+static void
+serial_varint_widen32(uint_t *values, uint8x16_t bytes)
+{
+    uint16x8_t low = vmovl_u8(vget_low_u8(bytes));
+    uint16x8_t high = vmovl_u8(vget_high_u8(bytes));
+    vst1q_u32(values, vmovl_u16(vget_low_u16(low)));
+    vst1q_u32(values + 4, vmovl_u16(vget_high_u16(low)));
+    vst1q_u32(values + 8, vmovl_u16(vget_low_u16(high)));
+    vst1q_u32(values + 12, vmovl_u16(vget_high_u16(high)));
+}
+#endif
+
+#if defined(SERIAL_SIMD_SSE2) || defined(SERIAL_SIMD_NEON)
+/**
+ * @def SERIAL_DECODE_BLOCK(T, LIMIT, WIDEN)
+ * @brief Decodes the varints at src sixteen bytes at a time.
+ *
+ * A block of sixteen single-byte varints is widened with vector
+ * instructions. Otherwise the varints ending inside the block are located
+ * through the mask of terminating bytes and decoded by the word decoder
+ * without branching on their lengths. The loop stops at a varint longer
+ * than eight bytes, including a block without a terminating byte, or when
+ * fewer than sixteen values or 24 bytes remain, and leaves the rest to the
+ * decoders of single varints, which reject overlong varints.
+ *
+ * @param T The type of the values.
+ * @param LIMIT The largest value that fits in T.
+ * @param WIDEN The function storing sixteen values.
+ */
+    #define SERIAL_DECODE_BLOCK(T, LIMIT, WIDEN)                               \
+        while (count >= 16 && end - src >= 24)                                 \
+        {                                                                      \
+            SERIAL_VECTOR_T bytes;                                             \
+            uint_t          stops = serial_varint_block(src, &bytes);          \
+            if (!stops)                                                        \
+            {                                                                  \
+                WIDEN(values, bytes);                                          \
+                src += 16;                                                     \
+                values += 16;                                                  \
+                count -= 16;                                                   \
+                continue;                                                      \
+            }                                                                  \
+                                                                               \
+            uint_t ends = ~stops & 0xFFFF;                                     \
+            uint_t start = 0;                                                  \
+            for (; ends; ends &= ends - 1)                                     \
+            {                                                                  \
+                uint_t last = bitflag_ctz32(ends);                             \
+                if (last - start >= 8)                                         \
+                {                                                              \
+                    break;                                                     \
+                }                                                              \
+                                                                               \
+                ullong_t word = serial_load_le64(src + start);                 \
+                ullong_t value = serial_varint_compact(                        \
+                    word & LIQUID_ULLONG_MAX >> (56 - 8 * (last - start)));    \
+                if (value > (LIMIT))                                           \
+                {                                                              \
+                    return nullptr;                                            \
+                }                                                              \
+                *values++ = (T)value;                                          \
+                --count;                                                       \
+                start = last + 1;                                              \
+            }                                                                  \
+            src += start;                                                      \
+            if (ends || !start)                                                \
+            {                                                                  \
+                break;                                                         \
+            }                                                                  \
+        }
+    #if defined(SERIAL_SIMD_SSE2)
+        #define SERIAL_VECTOR_T __m128i
+    #else
+        #define SERIAL_VECTOR_T uint8x16_t
+    #endif
+#else
+    #define SERIAL_DECODE_BLOCK(T, LIMIT, WIDEN)
+#endif
+
+uchar_t *
+serial_varint_encode64(uchar_t *dest, ullong_t value)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest, nullptr, "invalid destination pointer")
+
+    return serial_varint_put(dest, value);
+}
+
+const uchar_t *
+serial_varint_decode64(const uchar_t *begin, const uchar_t *end,
+                       ullong_t *value)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end && value, nullptr,
+                                  "invalid range or value pointer")
+
+    return serial_varint_decode_next(begin, end, value);
+}
+
+const uchar_t *
+serial_varint_decode32(const uchar_t *begin, const uchar_t *end,
+                       uint_t *value)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end && value, nullptr,
+                                  "invalid range or value pointer")
+
+    ullong_t       wide;
+    const uchar_t *next = serial_varint_decode_next(begin, end, &wide);
+    if (!next || wide > LIQUID_UINT_MAX)
+    {
+        return nullptr;
+    }
+    *value = (uint_t)wide;
+    return next;
+}
+
+uchar_t *
+serial_varint_encode_array64(uchar_t *dest, const ullong_t *values,
+                             usize_t count)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && (values || !count), nullptr,
+                                  "invalid destination or values pointer")
+
+    for (usize_t i = 0; i < count; ++i)
+    {
+        dest = serial_varint_put(dest, values[i]);
+    }
+    return dest;
+}
+
+uchar_t *
+serial_varint_encode_array32(uchar_t *dest, const uint_t *values,
+                             usize_t count)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && (values || !count), nullptr,
+                                  "invalid destination or values pointer")
+
+    for (usize_t i = 0; i < count; ++i)
+    {
+        dest = serial_varint_put(dest, values[i]);
+    }
+    return dest;
+}
+
+const uchar_t *
+serial_varint_decode_array64(const uchar_t *begin, const uchar_t *end,
+                             ullong_t *values, usize_t count)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end && (values || !count), nullptr,
+                                  "invalid range or values pointer")
+
+    const uchar_t *src = begin;
+    while (count)
+    {
+        SERIAL_DECODE_BLOCK(ullong_t, LIQUID_ULLONG_MAX,
+                            serial_varint_widen64)
+        if (!count)
+        {
+            break;
+        }
+
+        src = serial_varint_decode_next(src, end, values);
+        if (!src)
+        {
+            return nullptr;
+        }
+        ++values;
+        --count;
+    }
+    return src;
+}
+
+const uchar_t *
+serial_varint_decode_array32(const uchar_t *begin, const uchar_t *end,
+                             uint_t *values, usize_t count)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end && (values || !count), nullptr,
+                                  "invalid range or values pointer")
+
+    const uchar_t *src = begin;
+    while (count)
+    {
+        SERIAL_DECODE_BLOCK(uint_t, LIQUID_UINT_MAX, serial_varint_widen32)
+        if (!count)
+        {
+            break;
+        }
+
+        ullong_t value;
+        src = serial_varint_decode_next(src, end, &value);
+        if (!src || value > LIQUID_UINT_MAX)
+        {
+            return nullptr;
+        }
+        *values++ = (uint_t)value;
+        --count;
+    }
+    return src;
+}
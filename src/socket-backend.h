@@ -0,0 +1,65 @@
+/**
+ * @file socket-backend.h
+ * @brief The functions shared by the system backends of the sockets.
+ *
+ * socket.c implements the sharding on top of socket_backend_steer, which
+ * every backend implements. On POSIX systems socket-posix.c implements
+ * what the systems share, including the translation of messages that the
+ * batch functions of socket-linux.c reuse.
+ */
+
+#ifndef LIQUID_SOCKET_BACKEND_H
+#define LIQUID_SOCKET_BACKEND_H
+
+#include <liquid/socket.h>
+
+#if !defined(LIQUID_TARGET_OS_WINDOWS)
+    #include <sys/socket.h>
+
+/**
+ * @brief Describes a message to sendmsg or recvmsg.
+ *
+ * @param header The system message.
+ * @param message The message.
+ * @param receiving Whether the message is received, so that the address
+ *                  offers its whole storage.
+ */
+void
+socket_backend_header(struct msghdr *header, socket_message_t *message,
+                      bool receiving);
+
+/**
+ * @brief Stores the outcome of receiving a message.
+ *
+ * @param message The message.
+ * @param header The system message it was received with.
+ * @param size The bytes received.
+ */
+void
+socket_backend_received(socket_message_t *message,
+                        const struct msghdr *header, usize_t size);
+
+/**
+ * @brief Translates the flags of a send.
+ *
+ * @param flags SOCKET_ZEROCOPY or 0.
+ * @param system Receives the flags of sendmsg.
+ * @return True on success, false if the system does not support them.
+ */
+bool
+socket_backend_send_flags(uint_t flags, sint_t *system);
+#endif
+
+/**
+ * @brief Spreads the traffic of the sockets bound to an address with
+ *        SOCKET_REUSE_PORT over them by CPU.
+ *
+ * @param handles The sockets, in the order they were bound.
+ * @param count The number of sockets.
+ * @return True on success or if the system spreads by its own rules,
+ *         false on failure.
+ */
+bool
+socket_backend_steer(const socket_handle_t *handles, usize_t count);
+
+#endif // LIQUID_SOCKET_BACKEND_H
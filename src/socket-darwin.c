@@ -0,0 +1,134 @@
+#include "socket-backend.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <liquid/exception.h>
+#include <unistd.h>
+
+/**
+ * @brief Prepares a new socket: non-blocking, close-on-exec and without
+ *        SIGPIPE, closing it on failure.
+ *
+ * @param handle The socket.
+ * @return True on success, false on failure.
+ */
+static bool
+socket_prepare(socket_handle_t handle)
+{
+    sint_t on = 1;
+    if (fcntl(handle, F_SETFD, FD_CLOEXEC)
+        || fcntl(handle, F_SETFL, fcntl(handle, F_GETFL) | O_NONBLOCK)
+        || setsockopt(handle, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on)))
+    {
+        errcode_t code = errno;
+        close(handle);
+        errno = code;
+        return false;
+    }
+    return true;
+}
+
+bool
+socket_open(socket_handle_t *handle, const socket_address_t *address,
+            uint_t type)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(handle && address, false,
+                                  "invalid handle or address pointer")
+
+    const struct sockaddr *system = (const struct sockaddr *)address->storage;
+    *handle = socket(system->sa_family,
+                     type == SOCKET_STREAM ? SOCK_STREAM : SOCK_DGRAM, 0);
+    if (*handle < 0 || !socket_prepare(*handle))
+    {
+        *handle = SOCKET_INVALID_HANDLE;
+        return false;
+    }
+    return true;
+}
+
+bool
+socket_accept(socket_handle_t handle, socket_handle_t *accepted,
+              socket_address_t *peer)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(accepted, false, "invalid handle pointer")
+
+    socklen_t size = peer ? sizeof(peer->storage) : 0;
+    do
+    {
+        *accepted = accept(handle,
+                           peer ? (struct sockaddr *)peer->storage : nullptr,
+                           peer ? &size : nullptr);
+    } while (*accepted < 0 && errno == EINTR);
+
+    if (*accepted < 0 || !socket_prepare(*accepted))
+    {
+        *accepted = SOCKET_INVALID_HANDLE;
+        return false;
+    }
+    if (peer)
+    {
+        peer->size = size;
+    }
+    return true;
+}
+
+bool
+socket_send_batch(socket_handle_t handle, socket_message_t *messages,
+                  usize_t count, uint_t flags, usize_t *sent)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT((messages || !count) && sent, false,
+                                  "invalid messages or count pointer")
+
+    // There is no public call for batches, a message is sent at a time.
+    for (*sent = 0; *sent < count; ++*sent)
+    {
+        if (!socket_send(handle, &messages[*sent], flags))
+        {
+            return *sent > 0;
+        }
+    }
+    return true;
+}
+
+bool
+socket_recv_batch(socket_handle_t handle, socket_message_t *messages,
+                  usize_t count, usize_t *received)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT((messages || !count) && received, false,
+                                  "invalid messages or count pointer")
+
+    for (*received = 0; *received < count; ++*received)
+    {
+        if (!socket_recv(handle, &messages[*received]))
+        {
+            return *received > 0;
+        }
+    }
+    return true;
+}
+
+bool
+socket_zerocopy_enable(socket_handle_t handle)
+{
+    (void)handle;
+    errno = EOPNOTSUPP;
+    return false;
+}
+
+bool
+socket_zerocopy_reap(socket_handle_t handle, socket_completion_t *completion)
+{
+    (void)handle;
+    (void)completion;
+    errno = EOPNOTSUPP;
+    return false;
+}
+
+bool
+socket_backend_steer(const socket_handle_t *handles, usize_t count)
+{
+    // The system spreads connections by itself and hands datagrams to the
+    // socket bound last.
+    (void)handles;
+    (void)count;
+    return true;
+}
@@ -0,0 +1,230 @@
+#ifndef _GNU_SOURCE
+    #define _GNU_SOURCE
+#endif
+
+#include "socket-backend.h"
+#include <errno.h>
+#include <linux/errqueue.h>
+#include <linux/filter.h>
+#include <liquid/exception.h>
+#include <netinet/in.h>
+#include <string.h>
+
+/**
+ * @def SOCKET_CONTROL_SIZE
+ * @brief The size of the control buffer that receives a completion of
+ *        zero-copy sends.
+ */
+#define SOCKET_CONTROL_SIZE 128
+
+bool
+socket_open(socket_handle_t *handle, const socket_address_t *address,
+            uint_t type)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(handle && address, false,
+                                  "invalid handle or address pointer")
+
+    const struct sockaddr *system = (const struct sockaddr *)address->storage;
+    *handle = socket(system->sa_family,
+                     (type == SOCKET_STREAM ? SOCK_STREAM : SOCK_DGRAM)
+                         | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                     0);
+    return *handle >= 0;
+}
+
+bool
+socket_accept(socket_handle_t handle, socket_handle_t *accepted,
+              socket_address_t *peer)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(accepted, false, "invalid handle pointer")
+
+    socklen_t size = peer ? sizeof(peer->storage) : 0;
+    do
+    {
+        *accepted = accept4(handle,
+                            peer ? (struct sockaddr *)peer->storage : nullptr,
+                            peer ? &size : nullptr,
+                            SOCK_NONBLOCK | SOCK_CLOEXEC);
+    } while (*accepted < 0 && errno == EINTR);
+
+    if (*accepted < 0)
+    {
+        return false;
+    }
+    if (peer)
+    {
+        peer->size = size;
+    }
+    return true;
+}
+
+bool
+socket_send_batch(socket_handle_t handle, socket_message_t *messages,
+                  usize_t count, uint_t flags, usize_t *sent)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT((messages || !count) && sent, false,
+                                  "invalid messages or count pointer")
+
+    sint_t system;
+    *sent = 0;
+    if (!socket_backend_send_flags(flags, &system))
+    {
+        return false;
+    }
+
+    struct mmsghdr headers[SOCKET_BATCH];
+    while (*sent < count)
+    {
+        socket_message_t *batch = messages + *sent;
+        uint_t            size = (uint_t)(count - *sent < SOCKET_BATCH
+                                              ? count - *sent
+                                              : SOCKET_BATCH);
+        for (uint_t i = 0; i < size; ++i)
+        {
+            socket_backend_header(&headers[i].msg_hdr, &batch[i], false);
+        }
+
+        sint_t done;
+        do
+        {
+            done = sendmmsg(handle, headers, size, system);
+        } while (done < 0 && errno == EINTR);
+        if (done < 0)
+        {
+            return *sent > 0;
+        }
+
+        for (sint_t i = 0; i < done; ++i)
+        {
+            batch[i].size = headers[i].msg_len;
+        }
+        *sent += (usize_t)done;
+        if ((uint_t)done < size)
+        {
+            break;
+        }
+    }
+    return true;
+}
+
+bool
+socket_recv_batch(socket_handle_t handle, socket_message_t *messages,
+                  usize_t count, usize_t *received)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT((messages || !count) && received, false,
+                                  "invalid messages or count pointer")
+
+    *received = 0;
+    struct mmsghdr headers[SOCKET_BATCH];
+    while (*received < count)
+    {
+        socket_message_t *batch = messages + *received;
+        uint_t            size = (uint_t)(count - *received < SOCKET_BATCH
+                                              ? count - *received
+                                              : SOCKET_BATCH);
+        for (uint_t i = 0; i < size; ++i)
+        {
+            socket_backend_header(&headers[i].msg_hdr, &batch[i], true);
+        }
+
+        // Without MSG_WAITFORONE on a non-blocking socket the call takes
+        // what has arrived and returns.
+        sint_t done;
+        do
+        {
+            done = recvmmsg(handle, headers, size, 0, nullptr);
+        } while (done < 0 && errno == EINTR);
+        if (done < 0)
+        {
+            return *received > 0;
+        }
+
+        for (sint_t i = 0; i < done; ++i)
+        {
+            socket_backend_received(&batch[i], &headers[i].msg_hdr,
+                                    headers[i].msg_len);
+        }
+        *received += (usize_t)done;
+        if ((uint_t)done < size)
+        {
+            break;
+        }
+    }
+    return true;
+}
+
+bool
+socket_zerocopy_enable(socket_handle_t handle)
+{
+    sint_t on = 1;
+    return !setsockopt(handle, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on));
+}
+
+bool
+socket_zerocopy_reap(socket_handle_t handle, socket_completion_t *completion)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(completion, false,
+                                  "invalid completion pointer")
+
+    ullong_t      control[SOCKET_CONTROL_SIZE / sizeof(ullong_t)];
+    struct msghdr header;
+    memset(&header, 0, sizeof(header));
+    header.msg_control = control;
+    header.msg_controllen = sizeof(control);
+
+    ssize_t count;
+    do
+    {
+        count = recvmsg(handle, &header, MSG_ERRQUEUE);
+    } while (count < 0 && errno == EINTR);
+    if (count < 0)
+    {
+        return false;
+    }
+
+    // The queue also holds errors of the socket, which are reported as
+    // failures.
+    for (struct cmsghdr *message = CMSG_FIRSTHDR(&header); message;
+         message = CMSG_NXTHDR(&header, message))
+    {
+        if (!(message->cmsg_level == SOL_IP && message->cmsg_type == IP_RECVERR)
+            && !(message->cmsg_level == SOL_IPV6
+                 && message->cmsg_type == IPV6_RECVERR))
+        {
+            continue;
+        }
+
+        struct sock_extended_err error;
+        memcpy(&error, CMSG_DATA(message), sizeof(error));
+        if (error.ee_origin != SO_EE_ORIGIN_ZEROCOPY || error.ee_errno)
+        {
+            errno = error.ee_errno ? (sint_t)error.ee_errno : EIO;
+            return false;
+        }
+        completion->first = error.ee_info;
+        completion->last = error.ee_data;
+        completion->copied = (error.ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+                             != 0;
+        return true;
+    }
+
+    errno = EIO;
+    return false;
+}
+
+bool
+socket_backend_steer(const socket_handle_t *handles, usize_t count)
+{
+    // The program picks the socket with the index of the receiving CPU
+    // modulo the number of sockets.
+    struct sock_filter code[] = {
+        {BPF_LD | BPF_W | BPF_ABS, 0, 0, (uint_t)(SKF_AD_OFF + SKF_AD_CPU)},
+        {BPF_ALU | BPF_MOD | BPF_K, 0, 0, (uint_t)count},
+        {BPF_RET | BPF_A,          0, 0, 0                                 },
+    };
+    struct sock_fprog program = {sizeof(code) / sizeof(code[0]), code};
+
+    return count < 2
+           || !setsockopt(handles[0], SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF,
+                          &program, sizeof(program));
+}
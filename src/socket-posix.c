@@ -0,0 +1,287 @@
+#include "socket-backend.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <liquid/exception.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#if defined(MSG_NOSIGNAL)
+    #define SOCKET_SEND_FLAGS MSG_NOSIGNAL
+#else
+    // Darwin suppresses SIGPIPE with SO_NOSIGPIPE when opening instead.
+    #define SOCKET_SEND_FLAGS 0
+#endif
+
+void
+socket_backend_header(struct msghdr *header, socket_message_t *message,
+                      bool receiving)
+{
+    memset(header, 0, sizeof(*header));
+    if (message->address)
+    {
+        header->msg_name = message->address->storage;
+        header->msg_namelen = receiving ? sizeof(message->address->storage)
+                                        : message->address->size;
+    }
+
+    // The buffers are laid out as iovec.
+    header->msg_iov = (struct iovec *)message->buffers;
+    header->msg_iovlen = message->count;
+}
+
+void
+socket_backend_received(socket_message_t *message,
+                        const struct msghdr *header, usize_t size)
+{
+    message->size = size;
+    message->truncated = (header->msg_flags & MSG_TRUNC) != 0;
+    if (message->address)
+    {
+        message->address->size = header->msg_namelen;
+    }
+}
+
+bool
+socket_backend_send_flags(uint_t flags, sint_t *system)
+{
+    *system = SOCKET_SEND_FLAGS;
+    if (flags & SOCKET_ZEROCOPY)
+    {
+#if defined(MSG_ZEROCOPY)
+        *system |= MSG_ZEROCOPY;
+#else
+        errno = EOPNOTSUPP;
+        return false;
+#endif
+    }
+    return true;
+}
+
+bool
+socket_address_ip(socket_address_t *address, const char *host,
+                  ushort_t port)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(address && host, false,
+                                  "invalid address or host pointer")
+
+    memset(address->storage, 0, sizeof(address->storage));
+    struct sockaddr_in *ipv4 = (struct sockaddr_in *)address->storage;
+    if (inet_pton(AF_INET, host, &ipv4->sin_addr) == 1)
+    {
+        ipv4->sin_family = AF_INET;
+        ipv4->sin_port = htons(port);
+        address->size = sizeof(*ipv4);
+        return true;
+    }
+
+    struct sockaddr_in6 *ipv6 = (struct sockaddr_in6 *)address->storage;
+    if (inet_pton(AF_INET6, host, &ipv6->sin6_addr) == 1)
+    {
+        ipv6->sin6_family = AF_INET6;
+        ipv6->sin6_port = htons(port);
+        address->size = sizeof(*ipv6);
+        return true;
+    }
+
+    errno = EINVAL;
+    return false;
+}
+
+bool
+socket_address_unix(socket_address_t *address, const char *path)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(address && path, false,
+                                  "invalid address or path pointer")
+
+    struct sockaddr_un *local = (struct sockaddr_un *)address->storage;
+    usize_t             length = strlen(path);
+    if (length >= sizeof(local->sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+
+    memset(address->storage, 0, sizeof(address->storage));
+    local->sun_family = AF_UNIX;
+    memcpy(local->sun_path, path, length);
+    address->size = (uint_t)(offsetof(struct sockaddr_un, sun_path) + length
+                             + 1);
+    return true;
+}
+
+ushort_t
+socket_address_port(const socket_address_t *address)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(address, 0, "invalid address pointer")
+
+    const struct sockaddr *system = (const struct sockaddr *)address->storage;
+    if (system->sa_family == AF_INET)
+    {
+        return ntohs(((const struct sockaddr_in *)system)->sin_port);
+    }
+    if (system->sa_family == AF_INET6)
+    {
+        return ntohs(((const struct sockaddr_in6 *)system)->sin6_port);
+    }
+    return 0;
+}
+
+void
+socket_close(socket_handle_t handle)
+{
+    if (handle != SOCKET_INVALID_HANDLE)
+    {
+        close(handle);
+    }
+}
+
+bool
+socket_bind(socket_handle_t handle, const socket_address_t *address,
+            uint_t flags)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(address, false, "invalid address pointer")
+
+    sint_t on = 1;
+    if ((flags & SOCKET_REUSE_ADDRESS)
+        && setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)))
+    {
+        return false;
+    }
+    if ((flags & SOCKET_REUSE_PORT)
+        && setsockopt(handle, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)))
+    {
+        return false;
+    }
+    return !bind(handle, (const struct sockaddr *)address->storage,
+                 address->size);
+}
+
+bool
+socket_local_address(socket_handle_t handle, socket_address_t *address)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(address, false, "invalid address pointer")
+
+    socklen_t size = sizeof(address->storage);
+    if (getsockname(handle, (struct sockaddr *)address->storage, &size))
+    {
+        return false;
+    }
+    address->size = size;
+    return true;
+}
+
+bool
+socket_listen(socket_handle_t handle, uint_t backlog)
+{
+    return !listen(handle, (sint_t)backlog);
+}
+
+bool
+socket_connect(socket_handle_t handle, const socket_address_t *address)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(address, false, "invalid address pointer")
+
+    // An interrupted connection goes on in the background like one that
+    // is in progress.
+    if (connect(handle, (const struct sockaddr *)address->storage,
+                address->size))
+    {
+        return errno == EINPROGRESS || errno == EINTR;
+    }
+    return true;
+}
+
+bool
+socket_connect_result(socket_handle_t handle)
+{
+    sint_t    code = 0;
+    socklen_t size = sizeof(code);
+    if (getsockopt(handle, SOL_SOCKET, SO_ERROR, &code, &size))
+    {
+        return false;
+    }
+    if (code)
+    {
+        errno = code;
+        return false;
+    }
+    return true;
+}
+
+bool
+socket_set_nodelay(socket_handle_t handle, uint_t enable)
+{
+    sint_t on = enable ? 1 : 0;
+    return !setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+}
+
+bool
+socket_set_buffer_sizes(socket_handle_t handle, usize_t receive,
+                        usize_t send)
+{
+    sint_t size = (sint_t)receive;
+    if (receive
+        && setsockopt(handle, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)))
+    {
+        return false;
+    }
+    size = (sint_t)send;
+    return !send
+           || !setsockopt(handle, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+}
+
+bool
+socket_would_block(void)
+{
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+bool
+socket_send(socket_handle_t handle, socket_message_t *message,
+            uint_t flags)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(message, false, "invalid message pointer")
+
+    sint_t system;
+    if (!socket_backend_send_flags(flags, &system))
+    {
+        return false;
+    }
+
+    struct msghdr header;
+    socket_backend_header(&header, message, false);
+    ssize_t count;
+    do
+    {
+        count = sendmsg(handle, &header, system);
+    } while (count < 0 && errno == EINTR);
+
+    message->size = count > 0 ? (usize_t)count : 0;
+    return count >= 0;
+}
+
+bool
+socket_recv(socket_handle_t handle, socket_message_t *message)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(message, false, "invalid message pointer")
+
+    struct msghdr header;
+    socket_backend_header(&header, message, true);
+    ssize_t count;
+    do
+    {
+        count = recvmsg(handle, &header, 0);
+    } while (count < 0 && errno == EINTR);
+
+    if (count < 0)
+    {
+        message->size = 0;
+        return false;
+    }
+    socket_backend_received(message, &header, (usize_t)count);
+    return true;
+}
@@ -0,0 +1,384 @@
+#include "socket-backend.h"
+#include <liquid/exception.h>
+#include <string.h>
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <afunix.h>
+#include <windows.h>
+
+/**
+ * @brief The one-time initialization of Winsock.
+ */
+static INIT_ONCE socket_startup_once = INIT_ONCE_STATIC_INIT;
+
+/**
+ * @brief Starts Winsock for the process, for its whole lifetime.
+ *
+ * @param once The one-time initialization.
+ * @param parameter Unused.
+ * @param context Unused.
+ * @return TRUE on success, FALSE on failure.
+ */
+static BOOL CALLBACK
+socket_startup(PINIT_ONCE once, PVOID parameter, PVOID *context)
+{
+    (void)once;
+    (void)parameter;
+    (void)context;
+
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+}
+
+bool
+socket_address_ip(socket_address_t *address, const char *host,
+                  ushort_t port)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(address && host, false,
+                                  "invalid address or host pointer")
+
+    memset(address->storage, 0, sizeof(address->storage));
+    struct sockaddr_in *ipv4 = (struct sockaddr_in *)address->storage;
+    if (inet_pton(AF_INET, host, &ipv4->sin_addr) == 1)
+    {
+        ipv4->sin_family = AF_INET;
+        ipv4->sin_port = htons(port);
+        address->size = sizeof(*ipv4);
+        return true;
+    }
+
+    struct sockaddr_in6 *ipv6 = (struct sockaddr_in6 *)address->storage;
+    if (inet_pton(AF_INET6, host, &ipv6->sin6_addr) == 1)
+    {
+        ipv6->sin6_family = AF_INET6;
+        ipv6->sin6_port = htons(port);
+        address->size = sizeof(*ipv6);
+        return true;
+    }
+
+    WSASetLastError(WSAEINVAL);
+    return false;
+}
+
+bool
+socket_address_unix(socket_address_t *address, const char *path)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(address && path, false,
+                                  "invalid address or path pointer")
+
+    SOCKADDR_UN *local = (SOCKADDR_UN *)address->storage;
+    usize_t      length = strlen(path);
+    if (length >= sizeof(local->sun_path))
+    {
+        WSASetLastError(WSAENAMETOOLONG);
+        return false;
+    }
+
+    memset(address->storage, 0, sizeof(address->storage));
+    local->sun_family = AF_UNIX;
+    memcpy(local->sun_path, path, length);
+    address->size = sizeof(*local);
+    return true;
+}
+
+ushort_t
+socket_address_port(const socket_address_t *address)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(address, 0, "invalid address pointer")
+
+    const struct sockaddr *system = (const struct sockaddr *)address->storage;
+    if (system->sa_family == AF_INET)
+    {
+        return ntohs(((const struct sockaddr_in *)system)->sin_port);
+    }
+    if (system->sa_family == AF_INET6)
+    {
+        return ntohs(((const struct sockaddr_in6 *)system)->sin6_port);
+    }
+    return 0;
+}
+
+bool
+socket_open(socket_handle_t *handle, const socket_address_t *address,
+            uint_t type)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(handle && address, false,
+                                  "invalid handle or address pointer")
+
+    *handle = SOCKET_INVALID_HANDLE;
+    if (!InitOnceExecuteOnce(&socket_startup_once, socket_startup, nullptr,
+                             nullptr))
+    {
+        return false;
+    }
+
+    // Overlapped sockets can also be associated with a completion port.
+    const struct sockaddr *system = (const struct sockaddr *)address->storage;
+    SOCKET                 opened = WSASocketW(
+        system->sa_family, type == SOCKET_STREAM ? SOCK_STREAM : SOCK_DGRAM,
+        0, nullptr, 0, WSA_FLAG_OVERLAPPED | WSA_FLAG_NO_HANDLE_INHERIT);
+    if (opened == INVALID_SOCKET)
+    {
+        return false;
+    }
+
+    u_long on = 1;
+    if (ioctlsocket(opened, FIONBIO, &on))
+    {
+        DWORD code = GetLastError();
+        closesocket(opened);
+        SetLastError(code);
+        return false;
+    }
+    *handle = (socket_handle_t)opened;
+    return true;
+}
+
+void
+socket_close(socket_handle_t handle)
+{
+    if (handle != SOCKET_INVALID_HANDLE)
+    {
+        closesocket((SOCKET)handle);
+    }
+}
+
+bool
+socket_bind(socket_handle_t handle, const socket_address_t *address,
+            uint_t flags)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(address, false, "invalid address pointer")
+
+    // Addresses of closed connections can always be bound again, while
+    // SO_REUSEADDR would let other sockets take over an address in use.
+    if (flags & SOCKET_REUSE_PORT)
+    {
+        WSASetLastError(WSAEOPNOTSUPP);
+        return false;
+    }
+    return !bind((SOCKET)handle, (const struct sockaddr *)address->storage,
+                 (int)address->size);
+}
+
+bool
+socket_local_address(socket_handle_t handle, socket_address_t *address)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(address, false, "invalid address pointer")
+
+    int size = sizeof(address->storage);
+    if (getsockname((SOCKET)handle, (struct sockaddr *)address->storage,
+                    &size))
+    {
+        return false;
+    }
+    address->size = (uint_t)size;
+    return true;
+}
+
+bool
+socket_listen(socket_handle_t handle, uint_t backlog)
+{
+    return !listen((SOCKET)handle, (int)backlog);
+}
+
+bool
+socket_accept(socket_handle_t handle, socket_handle_t *accepted,
+              socket_address_t *peer)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(accepted, false, "invalid handle pointer")
+
+    // The accepted socket inherits the non-blocking mode of the listener.
+    int    size = peer ? sizeof(peer->storage) : 0;
+    SOCKET opened = accept((SOCKET)handle,
+                           peer ? (struct sockaddr *)peer->storage : nullptr,
+                           peer ? &size : nullptr);
+    if (opened == INVALID_SOCKET)
+    {
+        *accepted = SOCKET_INVALID_HANDLE;
+        return false;
+    }
+    *accepted = (socket_handle_t)opened;
+    if (peer)
+    {
+        peer->size = (uint_t)size;
+    }
+    return true;
+}
+
+bool
+socket_connect(socket_handle_t handle, const socket_address_t *address)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(address, false, "invalid address pointer")
+
+    if (connect((SOCKET)handle, (const struct sockaddr *)address->storage,
+                (int)address->size))
+    {
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+    }
+    return true;
+}
+
+bool
+socket_connect_result(socket_handle_t handle)
+{
+    int code = 0;
+    int size = sizeof(code);
+    if (getsockopt((SOCKET)handle, SOL_SOCKET, SO_ERROR, (char *)&code,
+                   &size))
+    {
+        return false;
+    }
+    if (code)
+    {
+        WSASetLastError(code);
+        return false;
+    }
+    return true;
+}
+
+bool
+socket_set_nodelay(socket_handle_t handle, uint_t enable)
+{
+    BOOL on = enable ? TRUE : FALSE;
+    return !setsockopt((SOCKET)handle, IPPROTO_TCP, TCP_NODELAY,
+                       (const char *)&on, sizeof(on));
+}
+
+bool
+socket_set_buffer_sizes(socket_handle_t handle, usize_t receive,
+                        usize_t send)
+{
+    int size = (int)receive;
+    if (receive
+        && setsockopt((SOCKET)handle, SOL_SOCKET, SO_RCVBUF,
+                      (const char *)&size, sizeof(size)))
+    {
+        return false;
+    }
+    size = (int)send;
+    return !send
+           || !setsockopt((SOCKET)handle, SOL_SOCKET, SO_SNDBUF,
+                          (const char *)&size, sizeof(size));
+}
+
+bool
+socket_would_block(void)
+{
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+
+bool
+socket_send(socket_handle_t handle, socket_message_t *message,
+            uint_t flags)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(message, false, "invalid message pointer")
+
+    message->size = 0;
+    if (flags & SOCKET_ZEROCOPY)
+    {
+        WSASetLastError(WSAEOPNOTSUPP);
+        return false;
+    }
+
+    // The buffers are laid out as WSABUF.
+    DWORD sent = 0;
+    bool  ok = !WSASendTo(
+        (SOCKET)handle, (LPWSABUF)message->buffers, (DWORD)message->count,
+        &sent, 0,
+        message->address ? (const struct sockaddr *)message->address->storage
+                         : nullptr,
+        message->address ? (int)message->address->size : 0, nullptr, nullptr);
+    message->size = sent;
+    return ok;
+}
+
+bool
+socket_recv(socket_handle_t handle, socket_message_t *message)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(message, false, "invalid message pointer")
+
+    // A truncated datagram fails but is received nonetheless.
+    DWORD received = 0;
+    DWORD flags = 0;
+    INT   size = message->address ? sizeof(message->address->storage) : 0;
+    bool  ok = !WSARecvFrom((SOCKET)handle, (LPWSABUF)message->buffers,
+                            (DWORD)message->count, &received, &flags,
+                            message->address
+                                ? (struct sockaddr *)message->address->storage
+                                : nullptr,
+                            message->address ? &size : nullptr, nullptr,
+                            nullptr);
+
+    message->truncated = !ok && WSAGetLastError() == WSAEMSGSIZE;
+    message->size = received;
+    if (!ok && !message->truncated)
+    {
+        return false;
+    }
+    if (message->address)
+    {
+        message->address->size = (uint_t)size;
+    }
+    return true;
+}
+
+bool
+socket_send_batch(socket_handle_t handle, socket_message_t *messages,
+                  usize_t count, uint_t flags, usize_t *sent)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT((messages || !count) && sent, false,
+                                  "invalid messages or count pointer")
+
+    // There is no call for batches, a message is sent at a time.
+    for (*sent = 0; *sent < count; ++*sent)
+    {
+        if (!socket_send(handle, &messages[*sent], flags))
+        {
+            return *sent > 0;
+        }
+    }
+    return true;
+}
+
+bool
+socket_recv_batch(socket_handle_t handle, socket_message_t *messages,
+                  usize_t count, usize_t *received)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT((messages || !count) && received, false,
+                                  "invalid messages or count pointer")
+
+    for (*received = 0; *received < count; ++*received)
+    {
+        if (!socket_recv(handle, &messages[*received]))
+        {
+            return *received > 0;
+        }
+    }
+    return true;
+}
+
+bool
+socket_zerocopy_enable(socket_handle_t handle)
+{
+    (void)handle;
+    WSASetLastError(WSAEOPNOTSUPP);
+    return false;
+}
+
+bool
+socket_zerocopy_reap(socket_handle_t handle, socket_completion_t *completion)
+{
+    (void)handle;
+    (void)completion;
+    WSASetLastError(WSAEOPNOTSUPP);
+    return false;
+}
+
+bool
+socket_backend_steer(const socket_handle_t *handles, usize_t count)
+{
+    // Ports cannot be shared, so there is never more than one socket.
+    (void)handles;
+    (void)count;
+    return true;
+}
@@ -0,0 +1,48 @@
+#include "socket-backend.h"
+#include <liquid/exception.h>
+
+bool
+socket_shard_open(socket_handle_t *handles, usize_t count,
+                  socket_address_t *address, uint_t type)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(handles && address, false,
+                                  "invalid handles or address pointer")
+    LIQUID_EXCEPTION_RAISE_IF_NOT(count, false, "no sockets requested")
+
+    // The first socket picks the port when none is given, the others
+    // bind to the same one.
+    usize_t opened = 0;
+    bool    ok = true;
+    while (ok && opened < count)
+    {
+        ok = socket_open(&handles[opened], address, type);
+        if (ok)
+        {
+            ++opened;
+            ok = socket_bind(handles[opened - 1], address,
+                             count > 1 ? SOCKET_REUSE_PORT : 0)
+                 && (opened > 1 || socket_address_port(address)
+                     || socket_local_address(handles[0], address));
+        }
+    }
+
+    // Listening joins the group of the port, so it has to happen in order
+    // and after the steering is attached.
+    ok = ok && socket_backend_steer(handles, count);
+    for (usize_t i = 0; ok && type == SOCKET_STREAM && i < count; ++i)
+    {
+        ok = socket_listen(handles[i], SOCKET_SHARD_BACKLOG);
+    }
+
+    if (!ok)
+    {
+        errcode_t code = last_error_code();
+        for (usize_t i = 0; i < opened; ++i)
+        {
+            socket_close(handles[i]);
+            handles[i] = SOCKET_INVALID_HANDLE;
+        }
+        set_last_error_code(code);
+    }
+    return ok;
+}
@@ -0,0 +1,947 @@
+/**
+ * @file sort-template.h
+ * @brief The sorting and searching kernels of one key type.
+ *
+ * Included by sort.c once per key type with SORT_KEY naming the type,
+ * SORT_KEY_BITS its width and SORT_NAME(name) appending the type suffix to
+ * a name, so that the kernels compare keys with the < operator instead of
+ * calling a comparator. There is no include guard on purpose.
+ */
+
+/**
+ * @brief Sorts a short range by insertion.
+ *
+ * @param begin The first key.
+ * @param end The end of the keys.
+ */
+static void
+SORT_NAME(sort_insertion)(SORT_KEY *begin, SORT_KEY *end)
+{
+    if (end - begin < 2)
+    {
+        return;
+    }
+    for (SORT_KEY *cur = begin + 1; cur < end; ++cur)
+    {
+        SORT_KEY  key = *cur;
+        SORT_KEY *sift = cur;
+        while (sift > begin && key < sift[-1])
+        {
+            *sift = sift[-1];
+            --sift;
+        }
+        *sift = key;
+    }
+}
+
+/**
+ * @brief Sorts a short range by insertion without checking for its start.
+ *
+ * @param begin The first key, preceded by a key not greater than any of
+ *              the range.
+ * @param end The end of the keys.
+ */
+static void
+SORT_NAME(sort_insertion_unguarded)(SORT_KEY *begin, SORT_KEY *end)
+{
+    if (end - begin < 2)
+    {
+        return;
+    }
+    for (SORT_KEY *cur = begin + 1; cur < end; ++cur)
+    {
+        SORT_KEY  key = *cur;
+        SORT_KEY *sift = cur;
+        while (key < sift[-1])
+        {
+            *sift = sift[-1];
+            --sift;
+        }
+        *sift = key;
+    }
+}
+
+/**
+ * @brief Sorts a short range of keys and their values by insertion.
+ *
+ * @param keys The keys.
+ * @param values The values, moved along with the keys.
+ * @param count The number of keys.
+ */
+static void
+SORT_NAME(sort_insertion_pairs)(SORT_KEY *keys, SORT_KEY *values,
+                                usize_t count)
+{
+    for (usize_t i = 1; i < count; ++i)
+    {
+        SORT_KEY key = keys[i];
+        SORT_KEY value = values[i];
+        usize_t  j = i;
+        for (; j && key < keys[j - 1]; --j)
+        {
+            keys[j] = keys[j - 1];
+            values[j] = values[j - 1];
+        }
+        keys[j] = key;
+        values[j] = value;
+    }
+}
+
+/**
+ * @brief Sorts a range by insertion unless it takes too many moves.
+ *
+ * @param begin The first key.
+ * @param end The end of the keys.
+ * @return True if the range is sorted, false if sorting was given up.
+ */
+static bool
+SORT_NAME(sort_insertion_partial)(SORT_KEY *begin, SORT_KEY *end)
+{
+    if (end - begin < 2)
+    {
+        return true;
+    }
+
+    usize_t moved = 0;
+    for (SORT_KEY *cur = begin + 1; cur < end; ++cur)
+    {
+        SORT_KEY  key = *cur;
+        SORT_KEY *sift = cur;
+        while (sift > begin && key < sift[-1])
+        {
+            *sift = sift[-1];
+            --sift;
+        }
+        *sift = key;
+
+        moved += (usize_t)(cur - sift);
+        if (moved > SORT_PARTIAL_INSERTION_LIMIT)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Orders two keys without branches.
+ *
+ * @param a The key that receives the smaller one.
+ * @param b The key that receives the larger one.
+ */
+static void
+SORT_NAME(sort_order2)(SORT_KEY *a, SORT_KEY *b)
+{
+    SORT_KEY x = *a;
+    SORT_KEY y = *b;
+    *a = y < x ? y : x;
+    *b = y < x ? x : y;
+}
+
+/**
+ * @brief Orders three keys.
+ *
+ * @param a The key that receives the smallest one.
+ * @param b The key that receives the median.
+ * @param c The key that receives the largest one.
+ */
+static void
+SORT_NAME(sort_order3)(SORT_KEY *a, SORT_KEY *b, SORT_KEY *c)
+{
+    SORT_NAME(sort_order2)(a, b);
+    SORT_NAME(sort_order2)(b, c);
+    SORT_NAME(sort_order2)(a, b);
+}
+
+/**
+ * @brief Swaps two keys.
+ *
+ * @param a The first key.
+ * @param b The second key.
+ */
+static void
+SORT_NAME(sort_swap)(SORT_KEY *a, SORT_KEY *b)
+{
+    SORT_KEY tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+/**
+ * @brief Restores the heap property below a node of a max-heap.
+ *
+ * @param heap The heap.
+ * @param node The index of the node.
+ * @param count The number of keys of the heap.
+ */
+static void
+SORT_NAME(sort_sift_down)(SORT_KEY *heap, usize_t node, usize_t count)
+{
+    SORT_KEY key = heap[node];
+    for (;;)
+    {
+        usize_t child = 2 * node + 1;
+        if (child >= count)
+        {
+            break;
+        }
+        if (child + 1 < count && heap[child] < heap[child + 1])
+        {
+            ++child;
+        }
+        if (!(key < heap[child]))
+        {
+            break;
+        }
+        heap[node] = heap[child];
+        node = child;
+    }
+    heap[node] = key;
+}
+
+/**
+ * @brief Sorts a range with heapsort, the fallback of pdqsort that bounds
+ *        its worst case.
+ *
+ * @param begin The first key.
+ * @param end The end of the keys.
+ */
+static void
+SORT_NAME(sort_heap)(SORT_KEY *begin, SORT_KEY *end)
+{
+    usize_t count = (usize_t)(end - begin);
+    for (usize_t i = count / 2; i-- > 0;)
+    {
+        SORT_NAME(sort_sift_down)(begin, i, count);
+    }
+    for (usize_t i = count; i-- > 1;)
+    {
+        SORT_NAME(sort_swap)(begin, begin + i);
+        SORT_NAME(sort_sift_down)(begin, 0, i);
+    }
+}
+
+/**
+ * @brief Partitions a range around its first key, moving keys equal to
+ *        the pivot to the left.
+ *
+ * The branches comparing keys to the pivot are replaced by writing the
+ * offsets of misplaced keys for a block of SORT_BLOCK keys at a time,
+ * after Edelkamp and Weiss' BlockQuicksort, so that the comparisons never
+ * mispredict and vectorize.
+ *
+ * @param begin The first key, the pivot, followed by at least two keys of
+ *              which one is not less and one not greater than it.
+ * @param end The end of the keys.
+ * @param partitioned Receives whether the range was partitioned already.
+ * @return The final position of the pivot.
+ */
+static SORT_KEY *
+SORT_NAME(sort_partition_right)(SORT_KEY *begin, SORT_KEY *end,
+                                bool *partitioned)
+{
+    SORT_KEY  pivot = *begin;
+    SORT_KEY *first = begin;
+    SORT_KEY *last = end;
+
+    // The median of three guarantees a key not less than the pivot, but
+    // the search for a smaller one needs a bound if none precedes first.
+    while (*++first < pivot)
+    {
+    }
+    if (first - 1 == begin)
+    {
+        while (first < last && !(*--last < pivot))
+        {
+        }
+    }
+    else
+    {
+        while (!(*--last < pivot))
+        {
+        }
+    }
+
+    *partitioned = first >= last;
+    if (!*partitioned)
+    {
+        SORT_NAME(sort_swap)(first, last);
+        ++first;
+
+        uchar_t   offsets_left[SORT_BLOCK];
+        uchar_t   offsets_right[SORT_BLOCK];
+        SORT_KEY *base_left = first;
+        SORT_KEY *base_right = last;
+        usize_t   count_left = 0;
+        usize_t   count_right = 0;
+        usize_t   start_left = 0;
+        usize_t   start_right = 0;
+
+        while (first < last)
+        {
+            // Refill the offset blocks that have been used up, splitting
+            // the unknown keys between them near the end.
+            usize_t unknown = (usize_t)(last - first);
+            usize_t split_left = 0;
+            usize_t split_right = 0;
+            if (!count_left)
+            {
+                split_left = count_right ? unknown : unknown / 2;
+            }
+            if (!count_right)
+            {
+                split_right = unknown - split_left;
+            }
+            split_left = split_left < SORT_BLOCK ? split_left : SORT_BLOCK;
+            split_right = split_right < SORT_BLOCK ? split_right : SORT_BLOCK;
+
+            for (usize_t i = 0; i < split_left; ++i)
+            {
+                offsets_left[count_left] = (uchar_t)i;
+                count_left += !(first[i] < pivot);
+            }
+            first += split_left;
+            for (usize_t i = 1; i <= split_right; ++i)
+            {
+                offsets_right[count_right] = (uchar_t)i;
+                count_right += *(last - i) < pivot;
+            }
+            last -= split_right;
+
+            // Swap the misplaced keys pairwise. Without an exact pairing a
+            // cyclic permutation saves a move per pair.
+            usize_t        count = count_left < count_right ? count_left
+                                                            : count_right;
+            const uchar_t *left = offsets_left + start_left;
+            const uchar_t *right = offsets_right + start_right;
+            if (count_left == count_right)
+            {
+                for (usize_t i = 0; i < count; ++i)
+                {
+                    SORT_NAME(sort_swap)(base_left + left[i],
+                                         base_right - right[i]);
+                }
+            }
+            else if (count)
+            {
+                SORT_KEY *l = base_left + left[0];
+                SORT_KEY *r = base_right - right[0];
+                SORT_KEY  tmp = *l;
+                *l = *r;
+                for (usize_t i = 1; i < count; ++i)
+                {
+                    l = base_left + left[i];
+                    *r = *l;
+                    r = base_right - right[i];
+                    *l = *r;
+                }
+                *r = tmp;
+            }
+
+            count_left -= count;
+            count_right -= count;
+            start_left += count;
+            start_right += count;
+            if (!count_left)
+            {
+                start_left = 0;
+                base_left = first;
+            }
+            if (!count_right)
+            {
+                start_right = 0;
+                base_right = last;
+            }
+        }
+
+        // Move the keys left over in one of the blocks to the boundary.
+        if (count_left)
+        {
+            const uchar_t *left = offsets_left + start_left;
+            while (count_left--)
+            {
+                SORT_NAME(sort_swap)(base_left + left[count_left], --last);
+            }
+            first = last;
+        }
+        if (count_right)
+        {
+            const uchar_t *right = offsets_right + start_right;
+            while (count_right--)
+            {
+                SORT_NAME(sort_swap)(base_right - right[count_right], first);
+                ++first;
+            }
+        }
+    }
+
+    SORT_KEY *pivot_pos = first - 1;
+    *begin = *pivot_pos;
+    *pivot_pos = pivot;
+    return pivot_pos;
+}
+
+/**
+ * @brief Partitions a range around its first key, moving keys equal to
+ *        the pivot to the right.
+ *
+ * Used when the pivot equals the key before the range, so that a run of
+ * equal keys is split off in one pass and never partitioned again.
+ *
+ * @param begin The first key, the pivot.
+ * @param end The end of the keys.
+ * @return The final position of the pivot.
+ */
+static SORT_KEY *
+SORT_NAME(sort_partition_left)(SORT_KEY *begin, SORT_KEY *end)
+{
+    SORT_KEY  pivot = *begin;
+    SORT_KEY *first = begin;
+    SORT_KEY *last = end;
+
+    while (pivot < *--last)
+    {
+    }
+    if (last + 1 == end)
+    {
+        while (first < last && !(pivot < *++first))
+        {
+        }
+    }
+    else
+    {
+        while (!(pivot < *++first))
+        {
+        }
+    }
+
+    while (first < last)
+    {
+        SORT_NAME(sort_swap)(first, last);
+        while (pivot < *--last)
+        {
+        }
+        while (!(pivot < *++first))
+        {
+        }
+    }
+
+    *begin = *last;
+    *last = pivot;
+    return last;
+}
+
+/**
+ * @brief Sorts a range with pattern-defeating quicksort.
+ *
+ * @param begin The first key.
+ * @param end The end of the keys.
+ * @param bad_allowed The number of unbalanced partitions left before
+ *                    falling back to heapsort.
+ * @param leftmost Whether no key precedes the range.
+ */
+static void
+SORT_NAME(sort_pdq)(SORT_KEY *begin, SORT_KEY *end, uint_t bad_allowed,
+                    bool leftmost)
+{
+    for (;;)
+    {
+        usize_t size = (usize_t)(end - begin);
+        if (size < SORT_INSERTION_MAX)
+        {
+            if (leftmost)
+            {
+                SORT_NAME(sort_insertion)(begin, end);
+            }
+            else
+            {
+                SORT_NAME(sort_insertion_unguarded)(begin, end);
+            }
+            return;
+        }
+
+        // Move the median of three, or of three medians for large ranges,
+        // to the front as the pivot.
+        usize_t half = size / 2;
+        if (size > SORT_NINTHER_MIN)
+        {
+            SORT_NAME(sort_order3)(begin, begin + half, end - 1);
+            SORT_NAME(sort_order3)(begin + 1, begin + half - 1, end - 2);
+            SORT_NAME(sort_order3)(begin + 2, begin + half + 1, end - 3);
+            SORT_NAME(sort_order3)(begin + half - 1, begin + half,
+                                   begin + half + 1);
+            SORT_NAME(sort_swap)(begin, begin + half);
+        }
+        else
+        {
+            SORT_NAME(sort_order3)(begin + half, begin, end - 1);
+        }
+
+        if (!leftmost && !(begin[-1] < *begin))
+        {
+            begin = SORT_NAME(sort_partition_left)(begin, end) + 1;
+            continue;
+        }
+
+        bool      partitioned;
+        SORT_KEY *pivot = SORT_NAME(sort_partition_right)(begin, end,
+                                                          &partitioned);
+        usize_t   left = (usize_t)(pivot - begin);
+        usize_t   right = (usize_t)(end - pivot - 1);
+
+        if (left < size / 8 || right < size / 8)
+        {
+            if (!--bad_allowed)
+            {
+                SORT_NAME(sort_heap)(begin, end);
+                return;
+            }
+
+            // Shuffle some keys to break the pattern that caused the bad
+            // partition.
+            if (left >= SORT_INSERTION_MAX)
+            {
+                SORT_NAME(sort_swap)(begin, begin + left / 4);
+                SORT_NAME(sort_swap)(pivot - 1, pivot - left / 4);
+                if (left > SORT_NINTHER_MIN)
+                {
+                    SORT_NAME(sort_swap)(begin + 1, begin + left / 4 + 1);
+                    SORT_NAME(sort_swap)(begin + 2, begin + left / 4 + 2);
+                    SORT_NAME(sort_swap)(pivot - 2, pivot - left / 4 - 1);
+                    SORT_NAME(sort_swap)(pivot - 3, pivot - left / 4 - 2);
+                }
+            }
+            if (right >= SORT_INSERTION_MAX)
+            {
+                SORT_NAME(sort_swap)(pivot + 1, pivot + 1 + right / 4);
+                SORT_NAME(sort_swap)(end - 1, end - right / 4);
+                if (right > SORT_NINTHER_MIN)
+                {
+                    SORT_NAME(sort_swap)(pivot + 2, pivot + 2 + right / 4);
+                    SORT_NAME(sort_swap)(pivot + 3, pivot + 3 + right / 4);
+                    SORT_NAME(sort_swap)(end - 2, end - 1 - right / 4);
+                    SORT_NAME(sort_swap)(end - 3, end - 2 - right / 4);
+                }
+            }
+        }
+        else if (partitioned
+                 && SORT_NAME(sort_insertion_partial)(begin, pivot)
+                 && SORT_NAME(sort_insertion_partial)(pivot + 1, end))
+        {
+            // Both sides were nearly sorted already.
+            return;
+        }
+
+        SORT_NAME(sort_pdq)(begin, pivot, bad_allowed, leftmost);
+        begin = pivot + 1;
+        leftmost = false;
+    }
+}
+
+/**
+ * @brief Sorts keys and optionally their values by their low digits with a
+ *        least significant digit radix sort.
+ *
+ * The histograms of all digits are taken in one pass and digits that all
+ * keys share are skipped. The keys move between the two arrays with every
+ * digit and are left wherever the last digit put them.
+ *
+ * @param keys The keys.
+ * @param values The values moved along with the keys, or nullptr.
+ * @param count The number of keys, not zero.
+ * @param key_scratch Space for count keys.
+ * @param value_scratch Space for count values, if there are values.
+ * @param digits The number of low bytes to sort by.
+ * @return Either keys or key_scratch, holding the sorted keys, with the
+ *         values in the matching array.
+ */
+static SORT_KEY *
+SORT_NAME(sort_lsd)(SORT_KEY *keys, SORT_KEY *values, usize_t count,
+                    SORT_KEY *key_scratch, SORT_KEY *value_scratch,
+                    uint_t digits)
+{
+    usize_t counts[SORT_KEY_BITS / 8][256];
+    memset(counts, 0, digits * sizeof(counts[0]));
+    for (usize_t i = 0; i < count; ++i)
+    {
+        SORT_KEY key = keys[i];
+        for (uint_t digit = 0; digit < digits; ++digit)
+        {
+            ++counts[digit][(key >> (8 * digit)) & 255];
+        }
+    }
+
+    SORT_KEY *src = keys;
+    SORT_KEY *dest = key_scratch;
+    SORT_KEY *src_values = values;
+    SORT_KEY *dest_values = value_scratch;
+    for (uint_t digit = 0; digit < digits; ++digit)
+    {
+        uint_t   shift = 8 * digit;
+        usize_t *offsets = counts[digit];
+        if (offsets[(src[0] >> shift) & 255] == count)
+        {
+            continue;
+        }
+
+        usize_t sum = 0;
+        for (uint_t bucket = 0; bucket < 256; ++bucket)
+        {
+            usize_t size = offsets[bucket];
+            offsets[bucket] = sum;
+            sum += size;
+        }
+
+        if (values)
+        {
+            for (usize_t i = 0; i < count; ++i)
+            {
+                usize_t pos = offsets[(src[i] >> shift) & 255]++;
+                dest[pos] = src[i];
+                dest_values[pos] = src_values[i];
+            }
+        }
+        else
+        {
+            for (usize_t i = 0; i < count; ++i)
+            {
+                dest[offsets[(src[i] >> shift) & 255]++] = src[i];
+            }
+        }
+
+        SORT_KEY *tmp = src;
+        src = dest;
+        dest = tmp;
+        tmp = src_values;
+        src_values = dest_values;
+        dest_values = tmp;
+    }
+    return src;
+}
+
+/**
+ * @brief Sorts keys and optionally their values with a stable radix sort.
+ *
+ * Small arrays are sorted from the least significant digit up. Large ones
+ * are first split by their highest byte that is not the same for all keys
+ * and the buckets are then sorted by the lower bytes, so that the passes
+ * over each bucket stay in the cache instead of scattering over the whole
+ * array for every digit.
+ *
+ * @param keys The keys.
+ * @param values The values moved along with the keys, or nullptr.
+ * @param count The number of keys, not zero.
+ * @param key_scratch Space for count keys.
+ * @param value_scratch Space for count values, if there are values.
+ */
+static void
+SORT_NAME(sort_stable)(SORT_KEY *keys, SORT_KEY *values, usize_t count,
+                       SORT_KEY *key_scratch, SORT_KEY *value_scratch)
+{
+    usize_t size = count * sizeof(SORT_KEY);
+    if (count <= SORT_LSD_MAX)
+    {
+        if (SORT_NAME(sort_lsd)(keys, values, count, key_scratch,
+                                value_scratch, SORT_KEY_BITS / 8)
+            != keys)
+        {
+            memcpy(keys, key_scratch, size);
+            if (values)
+            {
+                memcpy(values, value_scratch, size);
+            }
+        }
+        return;
+    }
+
+    SORT_KEY all = keys[0];
+    SORT_KEY any = keys[0];
+    for (usize_t i = 1; i < count; ++i)
+    {
+        all &= keys[i];
+        any |= keys[i];
+    }
+    if (all == any)
+    {
+        return;
+    }
+    uint_t digit = (63 - bitflag_clz64((ullong_t)(all ^ any))) / 8;
+    uint_t shift = 8 * digit;
+
+    usize_t offsets[256];
+    usize_t ends[256];
+    memset(ends, 0, sizeof(ends));
+    for (usize_t i = 0; i < count; ++i)
+    {
+        ++ends[(keys[i] >> shift) & 255];
+    }
+    usize_t sum = 0;
+    for (uint_t bucket = 0; bucket < 256; ++bucket)
+    {
+        offsets[bucket] = sum;
+        sum += ends[bucket];
+        ends[bucket] = sum;
+    }
+    for (usize_t i = 0; i < count; ++i)
+    {
+        usize_t pos = offsets[(keys[i] >> shift) & 255]++;
+        key_scratch[pos] = keys[i];
+        if (values)
+        {
+            value_scratch[pos] = values[i];
+        }
+    }
+
+    usize_t start = 0;
+    for (uint_t bucket = 0; bucket < 256; start = ends[bucket++])
+    {
+        usize_t length = ends[bucket] - start;
+        if (!length)
+        {
+            continue;
+        }
+
+        SORT_KEY *bucket_keys = key_scratch + start;
+        SORT_KEY *bucket_values = values ? value_scratch + start : nullptr;
+        if (SORT_NAME(sort_lsd)(bucket_keys, bucket_values, length,
+                                keys + start, values ? values + start : nullptr,
+                                digit)
+            == bucket_keys)
+        {
+            memcpy(keys + start, bucket_keys, length * sizeof(SORT_KEY));
+            if (values)
+            {
+                memcpy(values + start, bucket_values,
+                       length * sizeof(SORT_KEY));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Sorts keys and optionally their values in place with a most
+ *        significant digit radix sort.
+ *
+ * Each digit permutes the keys into their buckets by following cycles, as
+ * in McIlroy's American flag sort, and the buckets are sorted by the next
+ * digit. Short buckets are left to a comparison sort.
+ *
+ * @param keys The keys.
+ * @param values The values moved along with the keys, or nullptr.
+ * @param count The number of keys.
+ * @param shift The position of the digit to sort by.
+ */
+static void
+SORT_NAME(sort_msd)(SORT_KEY *keys, SORT_KEY *values, usize_t count,
+                    uint_t shift)
+{
+    usize_t counts[256];
+    for (;;)
+    {
+        if (count <= SORT_INSERTION_MAX && values)
+        {
+            SORT_NAME(sort_insertion_pairs)(keys, values, count);
+            return;
+        }
+        if (count < SORT_RADIX_MIN && !values)
+        {
+            SORT_NAME(sort_pdq)(keys, keys + count, sort_log2(count), true);
+            return;
+        }
+
+        memset(counts, 0, sizeof(counts));
+        for (usize_t i = 0; i < count; ++i)
+        {
+            ++counts[(keys[i] >> shift) & 255];
+        }
+        if (counts[(keys[0] >> shift) & 255] < count)
+        {
+            break;
+        }
+        if (!shift)
+        {
+            return;
+        }
+        shift -= 8;
+    }
+
+    usize_t heads[256];
+    usize_t ends[256];
+    usize_t sum = 0;
+    for (uint_t bucket = 0; bucket < 256; ++bucket)
+    {
+        heads[bucket] = sum;
+        sum += counts[bucket];
+        ends[bucket] = sum;
+    }
+
+    for (uint_t bucket = 0; bucket < 256; ++bucket)
+    {
+        while (heads[bucket] < ends[bucket])
+        {
+            // Carry the key to the head of its bucket and pick up the key
+            // found there until one belongs to this bucket.
+            SORT_KEY key = keys[heads[bucket]];
+            SORT_KEY value = values ? values[heads[bucket]] : 0;
+            uint_t   digit = (uint_t)(key >> shift) & 255;
+            while (digit != bucket)
+            {
+                usize_t  pos = heads[digit]++;
+                SORT_KEY tmp = keys[pos];
+                keys[pos] = key;
+                key = tmp;
+                if (values)
+                {
+                    tmp = values[pos];
+                    values[pos] = value;
+                    value = tmp;
+                }
+                digit = (uint_t)(key >> shift) & 255;
+            }
+            keys[heads[bucket]] = key;
+            if (values)
+            {
+                values[heads[bucket]] = value;
+            }
+            ++heads[bucket];
+        }
+    }
+
+    if (!shift)
+    {
+        return;
+    }
+    for (uint_t bucket = 0; bucket < 256; ++bucket)
+    {
+        if (counts[bucket] > 1)
+        {
+            usize_t start = ends[bucket] - counts[bucket];
+            SORT_NAME(sort_msd)(keys + start, values ? values + start : nullptr,
+                                counts[bucket], shift - 8);
+        }
+    }
+}
+
+/**
+ * @brief Counts the keys of a short sorted range less than a key.
+ *
+ * @param keys The keys.
+ * @param count The number of keys.
+ * @param key The key to compare to.
+ * @return The number of keys less than key.
+ */
+static usize_t
+SORT_NAME(sort_count_less)(const SORT_KEY *keys, usize_t count, SORT_KEY key)
+{
+    usize_t less = 0;
+    usize_t i = 0;
+#if SORT_KEY_BITS == 32 && defined(SORT_SIMD_SSE2)
+    // SSE2 compares signed lanes only, flipping the sign bits orders
+    // unsigned keys the same way.
+    __m128i bias = _mm_set1_epi32((int)0x80000000u);
+    __m128i needle = _mm_xor_si128(_mm_set1_epi32((int)key), bias);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i lanes = _mm_loadu_si128((const __m128i *)(keys + i));
+        __m128i lt = _mm_cmplt_epi32(_mm_xor_si128(lanes, bias), needle);
+        less += bitflag_popcount32(
+            (uint_t)_mm_movemask_ps(_mm_castsi128_ps(lt)));
+    }
+#elif SORT_KEY_BITS == 32 && defined(SORT_SIMD_NEON)
+    uint32x4_t needle = vdupq_n_u32(key);
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32x4_t lt = vcltq_u32(vld1q_u32(keys + i), needle);
+        less += vaddvq_u32(vshrq_n_u32(lt, 31));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        less += keys[i] < key;
+    }
+    return less;
+}
+
+/**
+ * @brief Finds the first key of a sorted range not less than a key.
+ *
+ * The range is halved with a conditional move instead of a branch, so
+ * that the search costs the same for every key and the processor never
+ * mispredicts it, and the last SORT_SEARCH_LINEAR keys are counted with
+ * SIMD compares.
+ *
+ * @param keys The sorted keys.
+ * @param count The number of keys.
+ * @param key The key to search for.
+ * @return The index of the first key not less than key, count if there is
+ *         none.
+ */
+static usize_t
+SORT_NAME(sort_search)(const SORT_KEY *keys, usize_t count, SORT_KEY key)
+{
+    const SORT_KEY *base = keys;
+    while (count > SORT_SEARCH_LINEAR)
+    {
+        usize_t half = count / 2;
+        SORT_PREFETCH(base + half / 2);
+        SORT_PREFETCH(base + half + half / 2);
+        base = base[half - 1] < key ? base + half : base;
+        count -= half;
+    }
+    return (usize_t)(base - keys)
+           + SORT_NAME(sort_count_less)(base, count, key);
+}
+
+/**
+ * @brief Fills a subtree of the Eytzinger layout by an in-order walk.
+ *
+ * @param dest The layout.
+ * @param sorted The sorted keys.
+ * @param count The number of keys.
+ * @param next The index of the next sorted key to place.
+ * @param node The node of the subtree root, counted from one.
+ * @return The index of the next sorted key after the subtree.
+ */
+static usize_t
+SORT_NAME(sort_eytzinger_fill)(SORT_KEY *dest, const SORT_KEY *sorted,
+                               usize_t count, usize_t next, usize_t node)
+{
+    if (node <= count)
+    {
+        next = SORT_NAME(sort_eytzinger_fill)(dest, sorted, count, next,
+                                              2 * node);
+        dest[node - 1] = sorted[next++];
+        next = SORT_NAME(sort_eytzinger_fill)(dest, sorted, count, next,
+                                              2 * node + 1);
+    }
+    return next;
+}
+
+/**
+ * @brief Finds the first key not less than a key in an Eytzinger layout.
+ *
+ * The descent is branchless and prefetches the cache line holding the
+ * nodes four levels further down, which the layout keeps contiguous.
+ *
+ * @param layout The keys in Eytzinger layout.
+ * @param count The number of keys.
+ * @param key The key to search for.
+ * @return The index into the layout of the first key not less than key,
+ *         count if there is none.
+ */
+static usize_t
+SORT_NAME(sort_eytzinger_search)(const SORT_KEY *layout, usize_t count,
+                                 SORT_KEY key)
+{
+    usize_t node = 1;
+    while (node <= count)
+    {
+        SORT_PREFETCH(layout + SORT_LINE_KEYS * node - 1);
+        node = 2 * node + (layout[node - 1] < key);
+    }
+
+    // The answer is the last node the descent left to the left: drop the
+    // right turns taken since and that left turn itself.
+    node >>= bitflag_ctz64(~(ullong_t)node) + 1;
+    return node ? node - 1 : count;
+}
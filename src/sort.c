@@ -0,0 +1,324 @@
+#include <liquid/bitflag.h>
+#include <liquid/bool.h>
+#include <liquid/exception.h>
+#include <liquid/sort.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define SORT_SIMD_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define SORT_SIMD_NEON
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define SORT_PREFETCH(ptr) __builtin_prefetch(ptr)
+#else
+    #define SORT_PREFETCH(ptr) ((void)(ptr))
+#endif
+
+/**
+ * @def SORT_INSERTION_MAX
+ * @brief The size below which ranges are sorted by insertion.
+ */
+#define SORT_INSERTION_MAX 24
+
+/**
+ * @def SORT_NINTHER_MIN
+ * @brief The size above which pivots are the median of three medians.
+ */
+#define SORT_NINTHER_MIN 128
+
+/**
+ * @def SORT_PARTIAL_INSERTION_LIMIT
+ * @brief The number of moves after which sorting a range that looks
+ *        presorted by insertion is given up.
+ */
+#define SORT_PARTIAL_INSERTION_LIMIT 8
+
+/**
+ * @def SORT_BLOCK
+ * @brief The number of keys compared at once by the branchless partition.
+ */
+#define SORT_BLOCK 64
+
+/**
+ * @def SORT_RADIX_MIN
+ * @brief The size below which radix sorts fall back to comparison sorting,
+ *        as the histograms cost more than they save.
+ */
+#define SORT_RADIX_MIN 256
+
+/**
+ * @def SORT_LSD_MAX
+ * @brief The size above which the stable radix sort splits the keys by
+ *        their highest byte before sorting the buckets by the lower ones.
+ */
+#define SORT_LSD_MAX 65536
+
+/**
+ * @def SORT_SEARCH_LINEAR
+ * @brief The size below which a search compares all remaining keys.
+ */
+#define SORT_SEARCH_LINEAR 16
+
+/**
+ * @def SORT_LINE_KEYS
+ * @brief The number of keys of a cache line.
+ */
+#define SORT_LINE_KEYS (64 / sizeof(SORT_KEY))
+
+/**
+ * @brief Computes the binary logarithm of a size, rounded down.
+ * @param count The size, not zero.
+ * @return The logarithm.
+ */
+static uint_t
+sort_log2(usize_t count)
+{
+    return 63 - bitflag_clz64(count);
+}
+
+#define SORT_KEY        uint_t
+#define SORT_KEY_BITS   32
+#define SORT_NAME(name) name##_uint
+#include "sort-template.h"
+#undef SORT_NAME
+#undef SORT_KEY_BITS
+#undef SORT_KEY
+
+#define SORT_KEY        ullong_t
+#define SORT_KEY_BITS   64
+#define SORT_NAME(name) name##_ullong
+#include "sort-template.h"
+#undef SORT_NAME
+#undef SORT_KEY_BITS
+#undef SORT_KEY
+
+/**
+ * @brief Maps floats to unsigned integers of the same order.
+ *
+ * Positive floats get their sign bit set and negative ones have all bits
+ * flipped, so that larger magnitudes order first.
+ *
+ * @param keys The floats, overwritten with the integers.
+ * @param count The number of floats.
+ */
+static void
+sort_float_to_key(float *keys, usize_t count)
+{
+    for (usize_t i = 0; i < count; ++i)
+    {
+        uint_t bits;
+        memcpy(&bits, keys + i, sizeof(bits));
+        bits ^= (0u - (bits >> 31)) | 0x80000000u;
+        memcpy(keys + i, &bits, sizeof(bits));
+    }
+}
+
+/**
+ * @brief Maps the integers of sort_float_to_key back to floats.
+ *
+ * @param keys The integers, overwritten with the floats.
+ * @param count The number of integers.
+ */
+static void
+sort_key_to_float(float *keys, usize_t count)
+{
+    for (usize_t i = 0; i < count; ++i)
+    {
+        uint_t bits;
+        memcpy(&bits, keys + i, sizeof(bits));
+        bits ^= ((bits >> 31) - 1) | 0x80000000u;
+        memcpy(keys + i, &bits, sizeof(bits));
+    }
+}
+
+void
+sort_radix_uint(uint_t *keys, usize_t count, uint_t *scratch)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(keys || !count, , "invalid keys pointer")
+
+    if (count < SORT_RADIX_MIN)
+    {
+        sort_uint(keys, count);
+    }
+    else if (scratch)
+    {
+        sort_stable_uint(keys, nullptr, count, scratch, nullptr);
+    }
+    else
+    {
+        sort_msd_uint(keys, nullptr, count, 24);
+    }
+}
+
+void
+sort_radix_ullong(ullong_t *keys, usize_t count, ullong_t *scratch)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(keys || !count, , "invalid keys pointer")
+
+    if (count < SORT_RADIX_MIN)
+    {
+        sort_ullong(keys, count);
+    }
+    else if (scratch)
+    {
+        sort_stable_ullong(keys, nullptr, count, scratch, nullptr);
+    }
+    else
+    {
+        sort_msd_ullong(keys, nullptr, count, 56);
+    }
+}
+
+void
+sort_radix_float(float *keys, usize_t count, float *scratch)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(keys || !count, , "invalid keys pointer")
+
+    sort_float_to_key(keys, count);
+    sort_radix_uint((uint_t *)keys, count, (uint_t *)scratch);
+    sort_key_to_float(keys, count);
+}
+
+void
+sort_radix_pairs_uint(uint_t *keys, uint_t *values, usize_t count,
+                      uint_t *key_scratch, uint_t *value_scratch)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT((keys && values) || !count, ,
+                                  "invalid keys or values pointer")
+    LIQUID_EXCEPTION_RAISE_IF(!key_scratch != !value_scratch, ,
+                              "scratch needed for both keys and values")
+
+    if (key_scratch && count)
+    {
+        sort_stable_uint(keys, values, count, key_scratch, value_scratch);
+    }
+    else if (count > 1)
+    {
+        sort_msd_uint(keys, values, count, 24);
+    }
+}
+
+void
+sort_radix_pairs_ullong(ullong_t *keys, ullong_t *values, usize_t count,
+                        ullong_t *key_scratch, ullong_t *value_scratch)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT((keys && values) || !count, ,
+                                  "invalid keys or values pointer")
+    LIQUID_EXCEPTION_RAISE_IF(!key_scratch != !value_scratch, ,
+                              "scratch needed for both keys and values")
+
+    if (key_scratch && count)
+    {
+        sort_stable_ullong(keys, values, count, key_scratch,
+                           value_scratch);
+    }
+    else if (count > 1)
+    {
+        sort_msd_ullong(keys, values, count, 56);
+    }
+}
+
+void
+sort_radix_pairs_float(float *keys, uint_t *values, usize_t count,
+                       float *key_scratch, uint_t *value_scratch)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT((keys && values) || !count, ,
+                                  "invalid keys or values pointer")
+    LIQUID_EXCEPTION_RAISE_IF(!key_scratch != !value_scratch, ,
+                              "scratch needed for both keys and values")
+
+    sort_float_to_key(keys, count);
+    sort_radix_pairs_uint((uint_t *)keys, values, count,
+                          (uint_t *)key_scratch, value_scratch);
+    sort_key_to_float(keys, count);
+}
+
+void
+sort_uint(uint_t *keys, usize_t count)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(keys || !count, , "invalid keys pointer")
+
+    if (count > 1)
+    {
+        sort_pdq_uint(keys, keys + count, sort_log2(count), true);
+    }
+}
+
+void
+sort_ullong(ullong_t *keys, usize_t count)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(keys || !count, , "invalid keys pointer")
+
+    if (count > 1)
+    {
+        sort_pdq_ullong(keys, keys + count, sort_log2(count), true);
+    }
+}
+
+void
+sort_float(float *keys, usize_t count)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(keys || !count, , "invalid keys pointer")
+
+    sort_float_to_key(keys, count);
+    sort_uint((uint_t *)keys, count);
+    sort_key_to_float(keys, count);
+}
+
+usize_t
+sort_lower_bound_uint(const uint_t *keys, usize_t count, uint_t key)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(keys || !count, 0, "invalid keys pointer")
+
+    return sort_search_uint(keys, count, key);
+}
+
+usize_t
+sort_lower_bound_ullong(const ullong_t *keys, usize_t count, ullong_t key)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(keys || !count, 0, "invalid keys pointer")
+
+    return sort_search_ullong(keys, count, key);
+}
+
+void
+sort_eytzinger_uint(uint_t *dest, const uint_t *sorted, usize_t count)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT((dest && sorted) || !count, ,
+                                  "invalid destination or keys pointer")
+
+    sort_eytzinger_fill_uint(dest, sorted, count, 0, 1);
+}
+
+void
+sort_eytzinger_ullong(ullong_t *dest, const ullong_t *sorted, usize_t count)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT((dest && sorted) || !count, ,
+                                  "invalid destination or keys pointer")
+
+    sort_eytzinger_fill_ullong(dest, sorted, count, 0, 1);
+}
+
+usize_t
+sort_eytzinger_lower_bound_uint(const uint_t *layout, usize_t count,
+                                uint_t key)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(layout || !count, 0,
+                                  "invalid layout pointer")
+
+    return sort_eytzinger_search_uint(layout, count, key);
+}
+
+usize_t
+sort_eytzinger_lower_bound_ullong(const ullong_t *layout, usize_t count,
+                                  ullong_t key)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(layout || !count, 0,
+                                  "invalid layout pointer")
+
+    return sort_eytzinger_search_ullong(layout, count, key);
+}
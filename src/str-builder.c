@@ -0,0 +1,468 @@
+#include <liquid/array-raw.h>
+#include <liquid/bool.h>
+#include <liquid/checked.h>
+#include <liquid/exception.h>
+#include <liquid/str-builder.h>
+#include <liquid/str-num.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <wchar.h>
+
+/**
+ * @def STR_BUILDER_WFORMAT_MAX
+ * @brief The capacity after which formatting a wide string is abandoned.
+ *
+ * vswprintf does not report the length of truncated output, so the wide
+ * builder doubles its storage until the output fits or this limit is hit.
+ */
+#define STR_BUILDER_WFORMAT_MAX (16 * 1024 * 1024)
+
+/**
+ * @brief Grows the storage of a builder of any character width.
+ *
+ * @param heap The heap storage of the builder, nullptr while inline.
+ * @param local The inline storage of the builder.
+ * @param capacity The capacity of the builder in characters.
+ * @param size The length of the contents without the null terminator.
+ * @param char_size The size of a character in bytes.
+ * @param allocator The allocator of the heap storage.
+ * @param required The number of characters including the null terminator.
+ * @return True if the storage fits the required number of characters.
+ */
+static bool
+str_builder_grow(void **heap, const void *local, usize_t *capacity,
+                 usize_t size, usize_t char_size, const allocator_t *allocator,
+                 usize_t required)
+{
+    if (required <= *capacity)
+    {
+        return true;
+    }
+
+    // Doubling keeps appending amortized constant time.
+    usize_t new_capacity = *capacity * 2;
+    if (new_capacity < required)
+    {
+        new_capacity = required;
+    }
+    usize_t new_size;
+    LIQUID_EXCEPTION_RAISE_IF_NOT(
+        checked_mul_usize(new_capacity, char_size, &new_size), false,
+        "string is too large")
+
+    void *block;
+    if (*heap)
+    {
+        block = alloc_resize(allocator, *heap, *capacity * char_size,
+                             new_size);
+    }
+    else
+    {
+        block = alloc_new(allocator, new_size);
+        if (block)
+        {
+            array_raw_copy(block, local, (size + 1) * char_size);
+        }
+    }
+
+    if (!block)
+    {
+        return false;
+    }
+
+    *heap = block;
+    *capacity = new_capacity;
+    return true;
+}
+
+/**
+ * @brief Appends ASCII characters to a wide builder, widening them.
+ *
+ * @param builder The wide builder.
+ * @param begin The first character to append.
+ * @param end Pointer past the last character, nullptr appends nothing.
+ * @return Pointer to the null terminator or nullptr on failure.
+ */
+static wchar_t *
+wstr_builder_widen(wstr_builder_t *builder, const char *begin,
+                   const char *end)
+{
+    if (!end)
+    {
+        return nullptr;
+    }
+
+    usize_t  len = LIQUID_PTR_DIFF(begin, end);
+    wchar_t *data = wstr_builder_reserve(builder, builder->size + len);
+    if (!data)
+    {
+        return nullptr;
+    }
+
+    wchar_t *ptr = data + builder->size;
+    while (begin != end)
+    {
+        *ptr++ = (wchar_t)*begin++;
+    }
+    *ptr = L'\0';
+
+    builder->size += len;
+    return ptr;
+}
+
+void
+str_builder_init(str_builder_t *builder, const allocator_t *allocator)
+{
+    builder->heap = nullptr;
+    builder->size = 0;
+    builder->capacity = STR_BUILDER_INLINE;
+    builder->allocator = allocator;
+    builder->local[0] = '\0';
+}
+
+void
+str_builder_free(str_builder_t *builder)
+{
+    alloc_delete(builder->allocator, builder->heap, builder->capacity);
+    str_builder_init(builder, builder->allocator);
+}
+
+void
+str_builder_clear(str_builder_t *builder)
+{
+    builder->size = 0;
+    STR_BUILDER_DATA(builder)[0] = '\0';
+}
+
+char *
+str_builder_reserve(str_builder_t *builder, usize_t len)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(builder, nullptr, "invalid builder pointer")
+    LIQUID_EXCEPTION_RAISE_IF(len >= LIQUID_USIZE_MAX, nullptr,
+                              "string is too large")
+
+    if (!str_builder_grow((void **)&builder->heap, builder->local,
+                          &builder->capacity, builder->size, sizeof(char),
+                          builder->allocator, len + 1))
+    {
+        return nullptr;
+    }
+    return STR_BUILDER_DATA(builder);
+}
+
+char *
+str_builder_append(str_builder_t *builder, const char *src, usize_t len)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(src, nullptr, "invalid source pointer")
+
+    if (!len)
+    {
+        len = str_len(src);
+    }
+    LIQUID_EXCEPTION_RAISE_IF(len > LIQUID_USIZE_MAX - 1 - builder->size,
+                              nullptr, "string is too large")
+
+    // Characters taken from the builder itself are found again by their
+    // offset, as growing may move the storage.
+    uptr_t offset = (uptr_t)src - (uptr_t)STR_BUILDER_DATA(builder);
+    bool   inside = offset < builder->size;
+    char  *data = str_builder_reserve(builder, builder->size + len);
+    if (!data)
+    {
+        return nullptr;
+    }
+
+    char *end = data + builder->size;
+    if (len)
+    {
+        end = array_raw_move(end, inside ? data + offset : src, len);
+    }
+    *end = '\0';
+
+    builder->size += len;
+    return end;
+}
+
+char *
+str_builder_append_char(str_builder_t *builder, char c)
+{
+    char *data = str_builder_reserve(builder, builder->size + 1);
+    if (!data)
+    {
+        return nullptr;
+    }
+
+    data[builder->size++] = c;
+    data[builder->size] = '\0';
+    return data + builder->size;
+}
+
+char *
+str_builder_append_uint(str_builder_t *builder, ullong_t value)
+{
+    // The exact length is known up front, so the digits are formatted
+    // straight into their final position.
+    usize_t digits = str_u64_digits(value);
+    char   *data = str_builder_reserve(builder, builder->size + digits);
+    if (!data)
+    {
+        return nullptr;
+    }
+
+    char *end = str_from_u64(data + builder->size, digits + 1, value);
+    builder->size += digits;
+    return end;
+}
+
+char *
+str_builder_append_int(str_builder_t *builder, sllong_t value)
+{
+    if (value >= 0)
+    {
+        return str_builder_append_uint(builder, (ullong_t)value);
+    }
+
+    if (!str_builder_append_char(builder, '-'))
+    {
+        return nullptr;
+    }
+    // Negating in unsigned arithmetic keeps LIQUID_SLLONG_MIN representable.
+    return str_builder_append_uint(builder, 0 - (ullong_t)value);
+}
+
+char *
+str_builder_append_double(str_builder_t *builder, double value)
+{
+    char *data =
+        str_builder_reserve(builder, builder->size + STR_NUM_DOUBLE_SIZE - 1);
+    if (!data)
+    {
+        return nullptr;
+    }
+
+    char *end = str_from_double(data + builder->size, STR_NUM_DOUBLE_SIZE,
+                                value);
+    builder->size = LIQUID_PTR_DIFF(data, end);
+    return end;
+}
+
+char *
+str_builder_append_json(str_builder_t *builder, const char *src)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(builder && src, nullptr,
+                                  "invalid builder or source pointer")
+
+    static const char digits[] = "0123456789abcdef";
+
+    char *end = str_builder_append_char(builder, '"');
+    for (const char *c = src; end && *c; ++c)
+    {
+        uchar_t code = (uchar_t)*c;
+        if (code < 0x20)
+        {
+            char escape[] = {'\\', 'u', '0', '0', digits[code >> 4],
+                             digits[code & 15]};
+            end = str_builder_append(builder, escape, sizeof(escape));
+        }
+        else if (code == '"' || code == '\\')
+        {
+            end = str_builder_append_char(builder, '\\')
+                      ? str_builder_append_char(builder, (char)code)
+                      : nullptr;
+        }
+        else
+        {
+            end = str_builder_append_char(builder, (char)code);
+        }
+    }
+    return end ? str_builder_append_char(builder, '"') : nullptr;
+}
+
+char *
+str_builder_appendf(str_builder_t *builder, const char *format, ...)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(builder && format, nullptr,
+                                  "invalid builder or format pointer")
+
+    va_list args;
+    usize_t avail = builder->capacity - builder->size;
+
+    va_start(args, format);
+    int len = vsnprintf(STR_BUILDER_DATA(builder) + builder->size, avail,
+                        format, args);
+    va_end(args);
+
+    if (len >= 0 && (usize_t)len >= avail)
+    {
+        // The output was truncated, grow once to the exact size and retry.
+        if (!str_builder_reserve(builder, builder->size + len))
+        {
+            STR_BUILDER_DATA(builder)[builder->size] = '\0';
+            return nullptr;
+        }
+
+        va_start(args, format);
+        len = vsnprintf(STR_BUILDER_DATA(builder) + builder->size, len + 1,
+                        format, args);
+        va_end(args);
+    }
+
+    if (len < 0)
+    {
+        STR_BUILDER_DATA(builder)[builder->size] = '\0';
+        LIQUID_EXCEPTION_RAISE("unable to format string");
+        return nullptr;
+    }
+
+    builder->size += len;
+    return STR_BUILDER_DATA(builder) + builder->size;
+}
+
+void
+wstr_builder_init(wstr_builder_t *builder, const allocator_t *allocator)
+{
+    builder->heap = nullptr;
+    builder->size = 0;
+    builder->capacity = STR_BUILDER_INLINE;
+    builder->allocator = allocator;
+    builder->local[0] = L'\0';
+}
+
+void
+wstr_builder_free(wstr_builder_t *builder)
+{
+    alloc_delete(builder->allocator, builder->heap,
+                 builder->capacity * sizeof(wchar_t));
+    wstr_builder_init(builder, builder->allocator);
+}
+
+void
+wstr_builder_clear(wstr_builder_t *builder)
+{
+    builder->size = 0;
+    STR_BUILDER_DATA(builder)[0] = L'\0';
+}
+
+wchar_t *
+wstr_builder_reserve(wstr_builder_t *builder, usize_t len)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(builder, nullptr, "invalid builder pointer")
+    LIQUID_EXCEPTION_RAISE_IF(len >= LIQUID_USIZE_MAX, nullptr,
+                              "string is too large")
+
+    if (!str_builder_grow((void **)&builder->heap, builder->local,
+                          &builder->capacity, builder->size, sizeof(wchar_t),
+                          builder->allocator, len + 1))
+    {
+        return nullptr;
+    }
+    return STR_BUILDER_DATA(builder);
+}
+
+wchar_t *
+wstr_builder_append(wstr_builder_t *builder, const wchar_t *src, usize_t len)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(src, nullptr, "invalid source pointer")
+
+    if (!len)
+    {
+        len = wcslen(src);
+    }
+    LIQUID_EXCEPTION_RAISE_IF(len > LIQUID_USIZE_MAX - 1 - builder->size,
+                              nullptr, "string is too large")
+
+    // Characters taken from the builder itself are found again by their
+    // offset, as growing may move the storage.
+    uptr_t   offset = (uptr_t)src - (uptr_t)STR_BUILDER_DATA(builder);
+    bool     inside = offset < builder->size * sizeof(wchar_t);
+    wchar_t *data = wstr_builder_reserve(builder, builder->size + len);
+    if (!data)
+    {
+        return nullptr;
+    }
+
+    wchar_t *end = data + builder->size;
+    if (len)
+    {
+        const wchar_t *from =
+            inside ? (const wchar_t *)((const uchar_t *)data + offset) : src;
+        end = array_raw_move(end, from, len * sizeof(wchar_t));
+    }
+    *end = L'\0';
+
+    builder->size += len;
+    return end;
+}
+
+wchar_t *
+wstr_builder_append_char(wstr_builder_t *builder, wchar_t c)
+{
+    wchar_t *data = wstr_builder_reserve(builder, builder->size + 1);
+    if (!data)
+    {
+        return nullptr;
+    }
+
+    data[builder->size++] = c;
+    data[builder->size] = L'\0';
+    return data + builder->size;
+}
+
+wchar_t *
+wstr_builder_append_uint(wstr_builder_t *builder, ullong_t value)
+{
+    char buffer[STR_NUM_U64_SIZE];
+    return wstr_builder_widen(builder, buffer,
+                              str_from_u64(buffer, sizeof(buffer), value));
+}
+
+wchar_t *
+wstr_builder_append_int(wstr_builder_t *builder, sllong_t value)
+{
+    char buffer[STR_NUM_I64_SIZE];
+    return wstr_builder_widen(builder, buffer,
+                              str_from_i64(buffer, sizeof(buffer), value));
+}
+
+wchar_t *
+wstr_builder_append_double(wstr_builder_t *builder, double value)
+{
+    char buffer[STR_NUM_DOUBLE_SIZE];
+    return wstr_builder_widen(builder, buffer,
+                              str_from_double(buffer, sizeof(buffer), value));
+}
+
+wchar_t *
+wstr_builder_appendf(wstr_builder_t *builder, const wchar_t *format, ...)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(builder && format, nullptr,
+                                  "invalid builder or format pointer")
+
+    for (;;)
+    {
+        va_list args;
+        usize_t avail = builder->capacity - builder->size;
+
+        va_start(args, format);
+        int len = vswprintf(STR_BUILDER_DATA(builder) + builder->size, avail,
+                            format, args);
+        va_end(args);
+
+        if (len >= 0)
+        {
+            builder->size += len;
+            return STR_BUILDER_DATA(builder) + builder->size;
+        }
+
+        // Truncated and malformed output look the same, so give up
+        // once the builder grows past a sane limit.
+        STR_BUILDER_DATA(builder)[builder->size] = L'\0';
+        LIQUID_EXCEPTION_RAISE_IF(builder->capacity >= STR_BUILDER_WFORMAT_MAX,
+                                  nullptr, "unable to format wide string")
+
+        if (!wstr_builder_reserve(builder, builder->capacity * 2))
+        {
+            return nullptr;
+        }
+    }
+}
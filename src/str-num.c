@@ -0,0 +1,1259 @@
+#include "str-num-table.h"
+#include <liquid/array-raw.h>
+#include <liquid/bitflag.h>
+#include <liquid/bool.h>
+#include <liquid/exception.h>
+#include <liquid/str-num.h>
+#include <liquid/str.h>
+#include <float.h>
+#include <stdlib.h>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+/**
+ * @def STR_NUM_DOUBLE_MANTISSA_BITS
+ * @brief The number of explicitly stored mantissa bits of a double.
+ */
+#define STR_NUM_DOUBLE_MANTISSA_BITS 52
+
+/**
+ * @def STR_NUM_DOUBLE_EXPONENT_BITS
+ * @brief The number of exponent bits of a double.
+ */
+#define STR_NUM_DOUBLE_EXPONENT_BITS 11
+
+/**
+ * @def STR_NUM_DOUBLE_BIAS
+ * @brief The exponent bias of a double.
+ */
+#define STR_NUM_DOUBLE_BIAS 1023
+
+/**
+ * @brief Pairs of decimal digits from "00" to "99".
+ */
+static const char STR_NUM_DIGIT_PAIRS[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/**
+ * @brief Digits of the bases up to 36.
+ */
+static const char STR_NUM_DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+/**
+ * @brief Powers of ten that fit into an unsigned 64-bit integer.
+ */
+static const ullong_t STR_NUM_POW10[20] = {1ull,
+                                           10ull,
+                                           100ull,
+                                           1000ull,
+                                           10000ull,
+                                           100000ull,
+                                           1000000ull,
+                                           10000000ull,
+                                           100000000ull,
+                                           1000000000ull,
+                                           10000000000ull,
+                                           100000000000ull,
+                                           1000000000000ull,
+                                           10000000000000ull,
+                                           100000000000000ull,
+                                           1000000000000000ull,
+                                           10000000000000000ull,
+                                           100000000000000000ull,
+                                           1000000000000000000ull,
+                                           10000000000000000000ull};
+
+/**
+ * @struct str_num_decimal
+ * @brief A decimal floating point number, mantissa * 10^exponent.
+ */
+typedef struct str_num_decimal
+{
+    ullong_t mantissa; ///< The decimal digits.
+    sint_t   exponent; ///< The power of ten.
+} str_num_decimal_t;
+
+/**
+ * @brief Multiplies two 64-bit integers into a 128-bit product.
+ *
+ * @param a The first factor.
+ * @param b The second factor.
+ * @param high Receives the upper half of the product.
+ * @return The lower half of the product.
+ */
+static ullong_t
+str_num_mul128(ullong_t a, ullong_t b, ullong_t *high)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = (unsigned __int128)a * b;
+    *high = (ullong_t)(product >> 64);
+    return (ullong_t)product;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return _umul128(a, b, high);
+#else
+    ullong_t a_lo = (uint_t)a, a_hi = a >> 32;
+    ullong_t b_lo = (uint_t)b, b_hi = b >> 32;
+
+    ullong_t lo_lo = a_lo * b_lo;
+    ullong_t hi_lo = a_hi * b_lo;
+    ullong_t lo_hi = a_lo * b_hi;
+    ullong_t hi_hi = a_hi * b_hi;
+
+    ullong_t cross = (lo_lo >> 32) + (uint_t)hi_lo + lo_hi;
+    *high = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    return (cross << 32) | (uint_t)lo_lo;
+#endif
+}
+
+/**
+ * @brief Writes the decimal digits of a value backwards, two at a time.
+ *
+ * @param end Pointer past the position of the last digit.
+ * @param value The value to write.
+ */
+static void
+str_num_write_digits(char *end, ullong_t value)
+{
+    while (value >= 100)
+    {
+        uint_t pair = (uint_t)(value % 100) * 2;
+        value /= 100;
+        end -= 2;
+        end[0] = STR_NUM_DIGIT_PAIRS[pair];
+        end[1] = STR_NUM_DIGIT_PAIRS[pair + 1];
+    }
+
+    if (value >= 10)
+    {
+        uint_t pair = (uint_t)value * 2;
+        end[-2] = STR_NUM_DIGIT_PAIRS[pair];
+        end[-1] = STR_NUM_DIGIT_PAIRS[pair + 1];
+    }
+    else
+    {
+        end[-1] = (char)('0' + value);
+    }
+}
+
+usize_t
+str_u64_digits(ullong_t value)
+{
+    // 1233 / 4096 approximates log10(2), which gives either the exact
+    // number of digits or one too many; a single comparison fixes it up.
+    // Setting the lowest bit never changes the count but maps zero to one.
+    value |= 1;
+    uint_t approx = ((64 - bitflag_clz64(value)) * 1233) >> 12;
+    return approx + 1 - (value < STR_NUM_POW10[approx]);
+}
+
+char *
+str_from_u64(char *dest, usize_t dest_size, ullong_t value)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest, nullptr, "invalid destination pointer")
+
+    usize_t digits = str_u64_digits(value);
+    LIQUID_EXCEPTION_RAISE_IF(dest_size <= digits, nullptr,
+                              "destination buffer is too small")
+
+    char *end = dest + digits;
+    str_num_write_digits(end, value);
+    *end = '\0';
+    return end;
+}
+
+char *
+str_from_i64(char *dest, usize_t dest_size, sllong_t value)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest, nullptr, "invalid destination pointer")
+
+    if (value >= 0)
+    {
+        return str_from_u64(dest, dest_size, (ullong_t)value);
+    }
+
+    LIQUID_EXCEPTION_RAISE_IF(dest_size < 2, nullptr,
+                              "destination buffer is too small")
+
+    *dest = '-';
+    // Negating in unsigned arithmetic keeps LIQUID_SLLONG_MIN representable.
+    return str_from_u64(dest + 1, dest_size - 1, 0 - (ullong_t)value);
+}
+
+char *
+str_from_u64_hex(char *dest, usize_t dest_size, ullong_t value)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest, nullptr, "invalid destination pointer")
+
+    usize_t digits = (64 - bitflag_clz64(value | 1) + 3) / 4;
+    LIQUID_EXCEPTION_RAISE_IF(dest_size <= digits, nullptr,
+                              "destination buffer is too small")
+
+    char *end = dest + digits;
+    char *ptr = end;
+
+    *end = '\0';
+    do
+    {
+        *--ptr = STR_NUM_DIGITS[value & 0xF];
+        value >>= 4;
+    } while (value);
+
+    return end;
+}
+
+char *
+str_from_u64_base(char *dest, usize_t dest_size, ullong_t value, uint_t base)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest, nullptr, "invalid destination pointer")
+    LIQUID_EXCEPTION_RAISE_IF(base < 2 || base > 36, nullptr,
+                              "base must be between 2 and 36")
+
+    if (base == 10)
+    {
+        return str_from_u64(dest, dest_size, value);
+    }
+    if (base == 16)
+    {
+        return str_from_u64_hex(dest, dest_size, value);
+    }
+
+    usize_t digits = 1;
+    for (ullong_t rest = value / base; rest; rest /= base)
+    {
+        ++digits;
+    }
+    LIQUID_EXCEPTION_RAISE_IF(dest_size <= digits, nullptr,
+                              "destination buffer is too small")
+
+    char *end = dest + digits;
+    char *ptr = end;
+
+    *end = '\0';
+    do
+    {
+        *--ptr = STR_NUM_DIGITS[value % base];
+        value /= base;
+    } while (value);
+
+    return end;
+}
+
+/**
+ * @brief Calculates ceil(log2(5^e)), or 1 for e == 0.
+ */
+static sint_t
+str_num_pow5_bits(sint_t e)
+{
+    return (sint_t)(((uint_t)e * 1217359) >> 19) + 1;
+}
+
+/**
+ * @brief Calculates floor(log10(2^e)) for e in [0, 1650].
+ */
+static uint_t
+str_num_log10_pow2(sint_t e)
+{
+    return ((uint_t)e * 78913) >> 18;
+}
+
+/**
+ * @brief Calculates floor(log10(5^e)) for e in [0, 2620].
+ */
+static uint_t
+str_num_log10_pow5(sint_t e)
+{
+    return ((uint_t)e * 732923) >> 20;
+}
+
+/**
+ * @brief Checks whether a value is divisible by 5^p.
+ */
+static bool
+str_num_multiple_of_pow5(ullong_t value, uint_t p)
+{
+    uint_t count = 0;
+    while (value % 5 == 0)
+    {
+        value /= 5;
+        ++count;
+    }
+    return count >= p;
+}
+
+/**
+ * @brief Checks whether a value is divisible by 2^p.
+ */
+static bool
+str_num_multiple_of_pow2(ullong_t value, uint_t p)
+{
+    return (value & ((1ull << p) - 1)) == 0;
+}
+
+/**
+ * @brief Multiplies a value by a 128-bit factor and shifts the product
+ *        right by j bits, j being at least 64.
+ */
+static ullong_t
+str_num_mul_shift(ullong_t m, const ullong_t *mul, sint_t j)
+{
+    ullong_t high0, high1;
+    str_num_mul128(m, mul[0], &high0);
+    ullong_t low1 = str_num_mul128(m, mul[1], &high1);
+
+    ullong_t sum = high0 + low1;
+    if (sum < high0)
+    {
+        ++high1;
+    }
+
+    uint_t dist = (uint_t)(j - 64);
+    return (high1 << (64 - dist)) | (sum >> dist);
+}
+
+/**
+ * @brief Converts a finite non-zero double to the shortest decimal that
+ *        rounds back to it (Ryu, Ulf Adams 2018).
+ *
+ * @param ieee_mantissa The stored mantissa bits.
+ * @param ieee_exponent The stored exponent bits.
+ * @return The decimal representation.
+ */
+static str_num_decimal_t
+str_num_d2d(ullong_t ieee_mantissa, uint_t ieee_exponent)
+{
+    sint_t   e2;
+    ullong_t m2;
+
+    if (ieee_exponent == 0)
+    {
+        e2 = 1 - STR_NUM_DOUBLE_BIAS - STR_NUM_DOUBLE_MANTISSA_BITS - 2;
+        m2 = ieee_mantissa;
+    }
+    else
+    {
+        e2 = (sint_t)ieee_exponent - STR_NUM_DOUBLE_BIAS
+           - STR_NUM_DOUBLE_MANTISSA_BITS - 2;
+        m2 = (1ull << STR_NUM_DOUBLE_MANTISSA_BITS) | ieee_mantissa;
+    }
+
+    const bool accept_bounds = (m2 & 1) == 0;
+
+    // The interval of valid representations is [mm, mp] around mv,
+    // scaled by four to keep the half-way points integral.
+    const ullong_t mv = 4 * m2;
+    const uint_t   mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+    ullong_t vr, vp, vm;
+    sint_t   e10;
+    bool     vm_trailing_zeros = false;
+    bool     vr_trailing_zeros = false;
+
+    if (e2 >= 0)
+    {
+        const uint_t q = str_num_log10_pow2(e2) - (e2 > 3);
+        const sint_t k =
+            STR_NUM_POW5_INV_BITCOUNT + str_num_pow5_bits((sint_t)q) - 1;
+        const sint_t i = -e2 + (sint_t)q + k;
+
+        e10 = (sint_t)q;
+        vr = str_num_mul_shift(mv, STR_NUM_POW5_INV_SPLIT[q], i);
+        vp = str_num_mul_shift(mv + 2, STR_NUM_POW5_INV_SPLIT[q], i);
+        vm = str_num_mul_shift(mv - 1 - mm_shift, STR_NUM_POW5_INV_SPLIT[q], i);
+
+        if (q <= 21)
+        {
+            // Only one of mp, mv and mm can be a multiple of 5, if any.
+            if (mv % 5 == 0)
+            {
+                vr_trailing_zeros = str_num_multiple_of_pow5(mv, q);
+            }
+            else if (accept_bounds)
+            {
+                vm_trailing_zeros =
+                    str_num_multiple_of_pow5(mv - 1 - mm_shift, q);
+            }
+            else
+            {
+                vp -= str_num_multiple_of_pow5(mv + 2, q);
+            }
+        }
+    }
+    else
+    {
+        const uint_t q = str_num_log10_pow5(-e2) - (-e2 > 1);
+        const sint_t i = -e2 - (sint_t)q;
+        const sint_t k = str_num_pow5_bits(i) - STR_NUM_POW5_BITCOUNT;
+        const sint_t j = (sint_t)q - k;
+
+        e10 = (sint_t)q + e2;
+        vr = str_num_mul_shift(mv, STR_NUM_POW5_SPLIT[i], j);
+        vp = str_num_mul_shift(mv + 2, STR_NUM_POW5_SPLIT[i], j);
+        vm = str_num_mul_shift(mv - 1 - mm_shift, STR_NUM_POW5_SPLIT[i], j);
+
+        if (q <= 1)
+        {
+            // mv = 4 * m2 always has at least two trailing zero bits.
+            vr_trailing_zeros = true;
+            if (accept_bounds)
+            {
+                vm_trailing_zeros = mm_shift == 1;
+            }
+            else
+            {
+                --vp;
+            }
+        }
+        else if (q < 63)
+        {
+            vr_trailing_zeros = str_num_multiple_of_pow2(mv, q);
+        }
+    }
+
+    // Remove digits while the bounds still differ.
+    sint_t   removed = 0;
+    uint_t   last_removed = 0;
+    ullong_t output;
+
+    if (vm_trailing_zeros || vr_trailing_zeros)
+    {
+        // The general case, taken for less than one percent of the inputs.
+        while (vp / 10 > vm / 10)
+        {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed == 0;
+            last_removed = (uint_t)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+
+        if (vm_trailing_zeros)
+        {
+            while (vm % 10 == 0)
+            {
+                vr_trailing_zeros &= last_removed == 0;
+                last_removed = (uint_t)(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                ++removed;
+            }
+        }
+
+        if (vr_trailing_zeros && last_removed == 5 && vr % 2 == 0)
+        {
+            // Round half to even if the exact value is ...50..0.
+            last_removed = 4;
+        }
+
+        output = vr
+               + ((vr == vm && (!accept_bounds || !vm_trailing_zeros))
+                  || last_removed >= 5);
+    }
+    else
+    {
+        bool round_up = false;
+
+        // Removing two digits at once covers most of the inputs.
+        if (vp / 100 > vm / 100)
+        {
+            round_up = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+
+        while (vp / 10 > vm / 10)
+        {
+            round_up = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+
+        output = vr + (vr == vm || round_up);
+    }
+
+    str_num_decimal_t decimal;
+    decimal.mantissa = output;
+    decimal.exponent = e10 + removed;
+    return decimal;
+}
+
+char *
+str_from_double(char *dest, usize_t dest_size, double value)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest, nullptr, "invalid destination pointer")
+
+    ullong_t bits;
+    array_raw_copy(&bits, &value, sizeof(bits));
+
+    const bool     sign = (bits >> 63) != 0;
+    const ullong_t ieee_mantissa =
+        bits & ((1ull << STR_NUM_DOUBLE_MANTISSA_BITS) - 1);
+    const uint_t ieee_exponent =
+        (uint_t)(bits >> STR_NUM_DOUBLE_MANTISSA_BITS)
+        & ((1u << STR_NUM_DOUBLE_EXPONENT_BITS) - 1);
+
+    // Digits of the output and the position of the decimal point in them.
+    char   digits[STR_NUM_U64_SIZE];
+    sint_t olength;
+    sint_t point;
+
+    if (ieee_exponent == (1u << STR_NUM_DOUBLE_EXPONENT_BITS) - 1)
+    {
+        const char *special = ieee_mantissa ? "nan" : sign ? "-inf" : "inf";
+        usize_t     len = ieee_mantissa ? 3 : sign ? 4 : 3;
+
+        LIQUID_EXCEPTION_RAISE_IF(dest_size <= len, nullptr,
+                                  "destination buffer is too small")
+        char *end = array_raw_copy(dest, special, len);
+        *end = '\0';
+        return end;
+    }
+
+    if (!ieee_exponent && !ieee_mantissa)
+    {
+        digits[0] = '0';
+        olength = 1;
+        point = 1;
+    }
+    else
+    {
+        str_num_decimal_t decimal = str_num_d2d(ieee_mantissa, ieee_exponent);
+        olength = (sint_t)str_u64_digits(decimal.mantissa);
+        point = olength + decimal.exponent;
+        str_num_write_digits(digits + olength, decimal.mantissa);
+    }
+
+    // Same layout rules as the number to string conversion of ECMAScript.
+    usize_t len = sign;
+    if (olength <= point && point <= 21)
+    {
+        len += point;
+    }
+    else if (0 < point && point <= 21)
+    {
+        len += olength + 1;
+    }
+    else if (-6 < point && point <= 0)
+    {
+        len += 2 - point + olength;
+    }
+    else
+    {
+        sint_t  exp = point - 1 < 0 ? 1 - point : point - 1;
+        usize_t exp_digits = exp >= 100 ? 3 : exp >= 10 ? 2 : 1;
+        len += olength + (olength > 1) + 2 + exp_digits;
+    }
+
+    LIQUID_EXCEPTION_RAISE_IF(dest_size <= len, nullptr,
+                              "destination buffer is too small")
+
+    char *ptr = dest;
+    if (sign)
+    {
+        *ptr++ = '-';
+    }
+
+    if (olength <= point && point <= 21)
+    {
+        ptr = array_raw_copy(ptr, digits, olength);
+        for (sint_t i = olength; i < point; ++i)
+        {
+            *ptr++ = '0';
+        }
+    }
+    else if (0 < point && point <= 21)
+    {
+        ptr = array_raw_copy(ptr, digits, point);
+        *ptr++ = '.';
+        ptr = array_raw_copy(ptr, digits + point, olength - point);
+    }
+    else if (-6 < point && point <= 0)
+    {
+        *ptr++ = '0';
+        *ptr++ = '.';
+        for (sint_t i = point; i < 0; ++i)
+        {
+            *ptr++ = '0';
+        }
+        ptr = array_raw_copy(ptr, digits, olength);
+    }
+    else
+    {
+        sint_t exp = point - 1;
+
+        *ptr++ = digits[0];
+        if (olength > 1)
+        {
+            *ptr++ = '.';
+            ptr = array_raw_copy(ptr, digits + 1, olength - 1);
+        }
+        *ptr++ = 'e';
+        *ptr++ = exp < 0 ? '-' : '+';
+
+        ullong_t magnitude = (ullong_t)(exp < 0 ? -exp : exp);
+        ptr += str_u64_digits(magnitude);
+        str_num_write_digits(ptr, magnitude);
+    }
+
+    *ptr = '\0';
+    return ptr;
+}
+
+/**
+ * @brief Stores an error code if the caller asked for it.
+ *
+ * @param ptr The pointer to return.
+ * @param code The error code.
+ * @param error Receives the error code, may be nullptr.
+ * @return The pointer passed in.
+ */
+static const char *
+str_num_result(const char *ptr, str_num_error_t code, str_num_error_t *error)
+{
+    if (error)
+    {
+        *error = code;
+    }
+    return ptr;
+}
+
+/**
+ * @brief Checks whether a character is a decimal digit.
+ * @param c The character.
+ * @return True for '0' to '9'.
+ */
+static bool
+str_num_is_digit(char c)
+{
+    return (uchar_t)(c - '0') < 10;
+}
+
+/**
+ * @brief Loads eight characters into a word, the first one lowest.
+ *
+ * Compilers turn the shifts into a single unaligned load on little-endian
+ * targets, the order of the characters is the same on every target.
+ *
+ * @param src Pointer to the characters.
+ * @return The characters packed into a word.
+ */
+static ullong_t
+str_num_load8(const char *src)
+{
+    const uchar_t *bytes = (const uchar_t *)src;
+    return (ullong_t)bytes[0] | (ullong_t)bytes[1] << 8
+           | (ullong_t)bytes[2] << 16 | (ullong_t)bytes[3] << 24
+           | (ullong_t)bytes[4] << 32 | (ullong_t)bytes[5] << 40
+           | (ullong_t)bytes[6] << 48 | (ullong_t)bytes[7] << 56;
+}
+
+/**
+ * @brief Checks whether all eight characters in a word are decimal digits.
+ * @param chunk The characters loaded by str_num_load8.
+ * @return True if every byte lies between '0' and '9'.
+ */
+static bool
+str_num_is_eight_digits(ullong_t chunk)
+{
+    // Digits have 0x3 in the high nibble and keep it when six is added.
+    return ((chunk & 0xF0F0F0F0F0F0F0F0ull)
+            | (((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4))
+           == 0x3333333333333333ull;
+}
+
+/**
+ * @brief Converts eight decimal digits in a word into their value.
+ *
+ * Neighbouring digits are combined into pairs, the pairs into quadruples
+ * and the quadruples into the result with three multiplications in total.
+ *
+ * @param chunk The digits loaded by str_num_load8.
+ * @return The value of the digits, the first digit being most significant.
+ */
+static uint_t
+str_num_parse_eight(ullong_t chunk)
+{
+    const ullong_t mask = 0x000000FF000000FFull;
+    const ullong_t mul1 = 100 + (1000000ull << 32);
+    const ullong_t mul2 = 1 + (10000ull << 32);
+
+    chunk -= 0x3030303030303030ull;
+    chunk = chunk * 10 + (chunk >> 8);
+    chunk = ((chunk & mask) * mul1 + ((chunk >> 16) & mask) * mul2) >> 32;
+    return (uint_t)chunk;
+}
+
+/**
+ * @brief Accumulates decimal digits into a value, wrapping on overflow.
+ *
+ * @param begin Pointer to the first character.
+ * @param end Pointer past the last character.
+ * @param value The value to continue, receives the result.
+ * @return Pointer past the last digit.
+ */
+static const char *
+str_num_parse_digits(const char *begin, const char *end, ullong_t *value)
+{
+    ullong_t result = *value;
+
+    while (LIQUID_PTR_DIFF(begin, end) >= 8)
+    {
+        ullong_t chunk = str_num_load8(begin);
+        if (!str_num_is_eight_digits(chunk))
+        {
+            break;
+        }
+        result = result * 100000000 + str_num_parse_eight(chunk);
+        begin += 8;
+    }
+
+    while (begin != end && str_num_is_digit(*begin))
+    {
+        result = result * 10 + (uint_t)(*begin - '0');
+        ++begin;
+    }
+
+    *value = result;
+    return begin;
+}
+
+const char *
+str_to_u64(const char *begin, const char *end, ullong_t *value,
+           str_num_error_t *error)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end && value, nullptr,
+                                  "invalid range or value pointer")
+
+    const char *ptr = begin;
+    while (ptr != end && *ptr == '0')
+    {
+        ++ptr;
+    }
+
+    const char *digits = ptr;
+    ullong_t    result = 0;
+    ptr = str_num_parse_digits(ptr, end, &result);
+    if (ptr == begin)
+    {
+        *value = 0;
+        return str_num_result(nullptr, STR_NUM_ERROR_SYNTAX, error);
+    }
+
+    // Up to 19 significant digits always fit, 20 digits fit depending on
+    // their value and the accumulated result has wrapped for more.
+    usize_t count = LIQUID_PTR_DIFF(digits, ptr);
+    if (count >= 20)
+    {
+        if (count == 20)
+        {
+            uint_t last = (uint_t)(digits[19] - '0');
+
+            result = 0;
+            str_num_parse_digits(digits, digits + 19, &result);
+            if (result <= (LIQUID_ULLONG_MAX - last) / 10)
+            {
+                *value = result * 10 + last;
+                return str_num_result(ptr, STR_NUM_OK, error);
+            }
+        }
+
+        *value = LIQUID_ULLONG_MAX;
+        return str_num_result(ptr, STR_NUM_ERROR_RANGE, error);
+    }
+
+    *value = result;
+    return str_num_result(ptr, STR_NUM_OK, error);
+}
+
+const char *
+str_to_i64(const char *begin, const char *end, sllong_t *value,
+           str_num_error_t *error)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end && value, nullptr,
+                                  "invalid range or value pointer")
+
+    const char *ptr = begin;
+    bool        negative = false;
+    if (ptr != end && (*ptr == '-' || *ptr == '+'))
+    {
+        negative = *ptr == '-';
+        ++ptr;
+    }
+
+    ullong_t        magnitude;
+    str_num_error_t code;
+    ptr = str_to_u64(ptr, end, &magnitude, &code);
+    if (!ptr)
+    {
+        *value = 0;
+        return str_num_result(nullptr, STR_NUM_ERROR_SYNTAX, error);
+    }
+
+    // The negative range reaches one further than the positive one.
+    if (code != STR_NUM_OK
+        || magnitude > (ullong_t)LIQUID_SLLONG_MAX + negative)
+    {
+        *value = negative ? LIQUID_SLLONG_MIN : LIQUID_SLLONG_MAX;
+        return str_num_result(ptr, STR_NUM_ERROR_RANGE, error);
+    }
+
+    *value = negative ? (sllong_t)(0 - magnitude) : (sllong_t)magnitude;
+    return str_num_result(ptr, STR_NUM_OK, error);
+}
+
+/**
+ * @brief Converts a hexadecimal digit into its value.
+ * @param c The character.
+ * @return The value of the digit, or 16 if it is not a digit.
+ */
+static uint_t
+str_num_hex_digit(char c)
+{
+    uint_t digit = (uint_t)(uchar_t)c - '0';
+    if (digit < 10)
+    {
+        return digit;
+    }
+
+    digit = (uint_t)((uchar_t)c | 0x20) - 'a';
+    return digit < 6 ? digit + 10 : 16;
+}
+
+const char *
+str_to_u64_hex(const char *begin, const char *end, ullong_t *value,
+               str_num_error_t *error)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end && value, nullptr,
+                                  "invalid range or value pointer")
+
+    // A prefix without digits after it leaves just the zero to parse.
+    const char *ptr = begin;
+    if (LIQUID_PTR_DIFF(ptr, end) >= 3 && ptr[0] == '0'
+        && (ptr[1] | 0x20) == 'x' && str_num_hex_digit(ptr[2]) < 16)
+    {
+        ptr += 2;
+    }
+
+    const char *digits = ptr;
+    ullong_t    result = 0;
+    bool        overflow = false;
+    uint_t      digit;
+    while (ptr != end && (digit = str_num_hex_digit(*ptr)) < 16)
+    {
+        overflow |= (result >> 60) != 0;
+        result = (result << 4) | digit;
+        ++ptr;
+    }
+
+    if (ptr == digits)
+    {
+        *value = 0;
+        return str_num_result(nullptr, STR_NUM_ERROR_SYNTAX, error);
+    }
+    if (overflow)
+    {
+        *value = LIQUID_ULLONG_MAX;
+        return str_num_result(ptr, STR_NUM_ERROR_RANGE, error);
+    }
+
+    *value = result;
+    return str_num_result(ptr, STR_NUM_OK, error);
+}
+
+/**
+ * @def STR_NUM_SLOW_DIGITS
+ * @brief The number of significant digits that decide the rounding of
+ *        any decimal to a double; further digits only matter as a whole.
+ */
+#define STR_NUM_SLOW_DIGITS 768
+
+/**
+ * @brief Powers of ten that are exactly representable as doubles.
+ */
+static const double STR_NUM_POW10_DOUBLE[23] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/**
+ * @brief Reinterprets the bits of a double.
+ * @param bits The IEEE 754 representation.
+ * @return The double.
+ */
+static double
+str_num_double_from_bits(ullong_t bits)
+{
+    union
+    {
+        ullong_t bits;
+        double   value;
+    } pun;
+
+    pun.bits = bits;
+    return pun.value;
+}
+
+/**
+ * @brief Converts mantissa * 10^exponent with a single rounding.
+ *
+ * Both the mantissa and the power of ten are exact doubles in this case,
+ * so one multiplication or division rounds correctly. This requires that
+ * the compiler does not evaluate doubles in a wider format.
+ *
+ * @param mantissa The decimal mantissa.
+ * @param exponent The decimal exponent.
+ * @param result Receives the double.
+ * @return True if the conversion was possible.
+ */
+static bool
+str_num_clinger(ullong_t mantissa, sllong_t exponent, double *result)
+{
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0 || FLT_EVAL_METHOD == 1)
+    if (exponent < -22 || exponent > 22
+        || mantissa > (1ull << (STR_NUM_DOUBLE_MANTISSA_BITS + 1)))
+    {
+        return false;
+    }
+
+    *result = exponent < 0 ? (double)mantissa / STR_NUM_POW10_DOUBLE[-exponent]
+                           : (double)mantissa * STR_NUM_POW10_DOUBLE[exponent];
+    return true;
+#else
+    (void)mantissa;
+    (void)exponent;
+    (void)result;
+    return false;
+#endif
+}
+
+/**
+ * @brief Converts mantissa * 10^exponent with the Eisel-Lemire algorithm.
+ *
+ * The mantissa is multiplied by a 128-bit approximation of the power of
+ * ten, the upper bits of the product give the rounded result unless they
+ * lie too close to a halfway point, which is then reported as a failure.
+ *
+ * @param mantissa The decimal mantissa.
+ * @param exponent The decimal exponent.
+ * @param bits Receives the IEEE 754 representation without the sign.
+ * @return True if the result is known to be correctly rounded.
+ */
+static bool
+str_num_eisel_lemire(ullong_t mantissa, sllong_t exponent, ullong_t *bits)
+{
+    if (!mantissa)
+    {
+        *bits = 0;
+        return true;
+    }
+    if (exponent < STR_NUM_POW5_128_MIN || exponent > STR_NUM_POW5_128_MAX)
+    {
+        return false;
+    }
+
+    const ullong_t *pow5 = STR_NUM_POW5_128[exponent - STR_NUM_POW5_128_MIN];
+
+    // 217706 / 65536 approximates log2(10), rounding towards minus infinity.
+    sllong_t binary_exponent =
+        ((217706 * exponent) >> 16) + STR_NUM_DOUBLE_BIAS + 1 + 63;
+    sint_t shift = (sint_t)bitflag_clz64(mantissa);
+    mantissa <<= shift;
+
+    ullong_t upper;
+    ullong_t lower = str_num_mul128(mantissa, pow5[0], &upper);
+    if ((upper & 0x1FF) == 0x1FF && lower + mantissa < lower)
+    {
+        // The truncated power of ten may have hidden a carry; the lower
+        // half of the approximation settles it in most cases.
+        ullong_t middle;
+        ullong_t low = str_num_mul128(mantissa, pow5[1], &middle);
+
+        middle += lower;
+        upper += middle < lower;
+        if (middle + 1 == 0 && (upper & 0x1FF) == 0x1FF && low + mantissa < low)
+        {
+            return false;
+        }
+        lower = middle;
+    }
+
+    const uint_t upper_bit = (uint_t)(upper >> 63);
+    ullong_t     result = upper >> (upper_bit + 9);
+    shift += 1 ^ upper_bit;
+
+    // Exactly between two doubles, the rounding cannot be decided here.
+    if (lower == 0 && (upper & 0x1FF) == 0 && (result & 3) == 1)
+    {
+        return false;
+    }
+
+    result = (result + (result & 1)) >> 1;
+    if (result >= (1ull << (STR_NUM_DOUBLE_MANTISSA_BITS + 1)))
+    {
+        result = 1ull << STR_NUM_DOUBLE_MANTISSA_BITS;
+        --shift;
+    }
+    result &= ~(1ull << STR_NUM_DOUBLE_MANTISSA_BITS);
+
+    // Subnormals and overflows are left to the exact path.
+    binary_exponent -= shift;
+    if (binary_exponent < 1
+        || binary_exponent >= (1 << STR_NUM_DOUBLE_EXPONENT_BITS) - 1)
+    {
+        return false;
+    }
+
+    *bits = result | (ullong_t)binary_exponent << STR_NUM_DOUBLE_MANTISSA_BITS;
+    return true;
+}
+
+/**
+ * @brief Converts the digits of a decimal exactly using the C library.
+ *
+ * The digits are rewritten as an integer with an exponent, which contains
+ * no decimal point and therefore parses the same in every locale. Digits
+ * beyond STR_NUM_SLOW_DIGITS are folded into a single non-zero digit.
+ *
+ * @param begin Pointer to the first digit.
+ * @param end Pointer past the last digit.
+ * @param exponent The explicit decimal exponent.
+ * @return The magnitude of the number.
+ */
+static double
+str_num_parse_slow(const char *begin, const char *end, sllong_t exponent)
+{
+    char    buffer[STR_NUM_SLOW_DIGITS + 2 + STR_NUM_I64_SIZE];
+    usize_t count = 0;
+    bool    fraction = false;
+    bool    sticky = false;
+
+    for (; begin != end; ++begin)
+    {
+        if (*begin == '.')
+        {
+            fraction = true;
+        }
+        else if (count < STR_NUM_SLOW_DIGITS)
+        {
+            if (count || *begin != '0')
+            {
+                buffer[count++] = *begin;
+            }
+            exponent -= fraction;
+        }
+        else
+        {
+            exponent += !fraction;
+            sticky |= *begin != '0';
+        }
+    }
+
+    if (!count)
+    {
+        return 0.0;
+    }
+    if (sticky)
+    {
+        buffer[count++] = '1';
+        --exponent;
+    }
+
+    buffer[count++] = 'e';
+    str_from_i64(buffer + count, sizeof(buffer) - count, exponent);
+    return strtod(buffer, nullptr);
+}
+
+/**
+ * @brief Parses the names of infinity and NaN.
+ *
+ * @param begin Pointer to the first character after the sign.
+ * @param end Pointer past the last character.
+ * @param negative Whether a minus sign preceded the name.
+ * @param value Receives the number.
+ * @param error Receives the error code, may be nullptr.
+ * @return Pointer past the name, or nullptr if there is none.
+ */
+static const char *
+str_num_parse_special(const char *begin, const char *end, bool negative,
+                      double *value, str_num_error_t *error)
+{
+    static const char *const names[] = {"infinity", "inf", "nan"};
+    static const ullong_t    bits[] = {0x7FF0000000000000ull,
+                                       0x7FF0000000000000ull,
+                                       0x7FF8000000000000ull};
+
+    for (usize_t i = 0; i < ARRAY_RAW_SIZE(names); ++i)
+    {
+        usize_t len = str_len(names[i]);
+        usize_t matched = 0;
+
+        if ((usize_t)LIQUID_PTR_DIFF(begin, end) < len)
+        {
+            continue;
+        }
+        // Only letters map onto lowercase letters by setting bit five.
+        while (matched < len && (begin[matched] | 0x20) == names[i][matched])
+        {
+            ++matched;
+        }
+        if (matched == len)
+        {
+            *value = str_num_double_from_bits(bits[i]
+                                              | (ullong_t)negative << 63);
+            return str_num_result(begin + len, STR_NUM_OK, error);
+        }
+    }
+
+    *value = 0.0;
+    return str_num_result(nullptr, STR_NUM_ERROR_SYNTAX, error);
+}
+
+const char *
+str_to_double(const char *begin, const char *end, double *value,
+              str_num_error_t *error)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end && value, nullptr,
+                                  "invalid range or value pointer")
+
+    const char *ptr = begin;
+    bool        negative = false;
+    if (ptr != end && (*ptr == '-' || *ptr == '+'))
+    {
+        negative = *ptr == '-';
+        ++ptr;
+    }
+
+    ullong_t    mantissa = 0;
+    const char *int_begin = ptr;
+    const char *int_end = str_num_parse_digits(ptr, end, &mantissa);
+    const char *frac_begin = int_end;
+    const char *frac_end = int_end;
+    if (int_end != end && *int_end == '.')
+    {
+        frac_begin = int_end + 1;
+        frac_end = str_num_parse_digits(frac_begin, end, &mantissa);
+    }
+
+    usize_t count = LIQUID_PTR_DIFF(int_begin, int_end)
+                    + LIQUID_PTR_DIFF(frac_begin, frac_end);
+    if (!count)
+    {
+        return str_num_parse_special(int_begin, end, negative, value, error);
+    }
+
+    // An exponent marker without digits is not part of the number.
+    sllong_t exponent = 0;
+    ptr = frac_end;
+    if (ptr != end && (*ptr | 0x20) == 'e')
+    {
+        const char *exp_ptr = ptr + 1;
+        bool        exp_negative = false;
+        if (exp_ptr != end && (*exp_ptr == '-' || *exp_ptr == '+'))
+        {
+            exp_negative = *exp_ptr == '-';
+            ++exp_ptr;
+        }
+
+        if (exp_ptr != end && str_num_is_digit(*exp_ptr))
+        {
+            // Larger exponents over- or underflow anyway, clamping keeps
+            // the arithmetic below from overflowing.
+            for (; exp_ptr != end && str_num_is_digit(*exp_ptr); ++exp_ptr)
+            {
+                if (exponent < 0x10000)
+                {
+                    exponent = exponent * 10 + (*exp_ptr - '0');
+                }
+            }
+            exponent = exp_negative ? -exponent : exponent;
+            ptr = exp_ptr;
+        }
+    }
+
+    // Leading zeros do not count towards the 19 digits that fit exactly.
+    if (count > 19)
+    {
+        for (const char *zero = int_begin;
+             zero != frac_end && (*zero == '0' || *zero == '.'); ++zero)
+        {
+            count -= *zero == '0';
+        }
+    }
+
+    sllong_t exp10;
+    bool     truncated = count > 19;
+    if (truncated)
+    {
+        // Keep the 19 leading significant digits, the ones dropped are
+        // accounted for by checking that mantissa + 1 rounds the same.
+        const char *digit = int_begin;
+        mantissa = 0;
+        while (mantissa < STR_NUM_POW10[18] && digit != int_end)
+        {
+            mantissa = mantissa * 10 + (uint_t)(*digit++ - '0');
+        }
+
+        if (mantissa >= STR_NUM_POW10[18])
+        {
+            exp10 = exponent + LIQUID_PTR_DIFF(digit, int_end);
+        }
+        else
+        {
+            digit = frac_begin;
+            while (mantissa < STR_NUM_POW10[18] && digit != frac_end)
+            {
+                mantissa = mantissa * 10 + (uint_t)(*digit++ - '0');
+            }
+            exp10 = exponent - LIQUID_PTR_DIFF(frac_begin, digit);
+        }
+    }
+    else
+    {
+        exp10 = exponent - LIQUID_PTR_DIFF(frac_begin, frac_end);
+    }
+
+    double   result;
+    ullong_t bits;
+    ullong_t bits_up;
+    if (!truncated && str_num_clinger(mantissa, exp10, &result))
+    {
+        result = negative ? -result : result;
+    }
+    else if (str_num_eisel_lemire(mantissa, exp10, &bits)
+             && (!truncated
+                 || (str_num_eisel_lemire(mantissa + 1, exp10, &bits_up)
+                     && bits == bits_up)))
+    {
+        result = str_num_double_from_bits(bits | (ullong_t)negative << 63);
+    }
+    else
+    {
+        result = str_num_parse_slow(int_begin, frac_end, exponent);
+        result = negative ? -result : result;
+    }
+
+    *value = result;
+
+    // Non-zero digits that end up as zero or infinity are out of range.
+    if ((mantissa && result == 0.0) || result - result != 0.0)
+    {
+        return str_num_result(ptr, STR_NUM_ERROR_RANGE, error);
+    }
+    return str_num_result(ptr, STR_NUM_OK, error);
+}
@@ -1,3 +1,4 @@
+#include <liquid/checked.h>
 #include <liquid/str.h>
 #include <string.h>
 
@@ -48,7 +49,13 @@ wstr_raw_cpy(wchar_t *dest, usize_t dest_size, const wchar_t *src,
         src_size = dest_size;
     }
 
-    return array_raw_copy(dest, src, src_size * sizeof(wchar_t));
+    // A wrapped byte count would copy a fraction of the string silently.
+    usize_t bytes;
+    if (!checked_mul_usize(src_size, sizeof(wchar_t), &bytes))
+    {
+        return nullptr;
+    }
+    return array_raw_copy(dest, src, bytes);
 }
 
 char *
@@ -0,0 +1,416 @@
+#include <liquid/alloc.h>
+#include <liquid/exception.h>
+#include <liquid/trace.h>
+
+#if defined(LIQUID_TARGET_OS_WINDOWS)
+    #include <windows.h>
+#elif defined(LIQUID_TARGET_OS_POSIX_LIKE)
+    #include <pthread.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define TRACE_THREAD_LOCAL __thread
+    #define TRACE_ADD(ptr, value)                                              \
+        __atomic_fetch_add(ptr, value, __ATOMIC_RELAXED)
+    #define TRACE_LOAD(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+    #define TRACE_ACQUIRE(ptr) __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+    #define TRACE_RELEASE(ptr, value)                                          \
+        __atomic_store_n(ptr, value, __ATOMIC_RELEASE)
+    #define TRACE_LOCK(ptr) __atomic_exchange_n(ptr, 1, __ATOMIC_ACQUIRE)
+    #define TRACE_PAUSE() ((void)0)
+#elif defined(_MSC_VER)
+    #include <intrin.h>
+    #define TRACE_THREAD_LOCAL __declspec(thread)
+    #define TRACE_ADD(ptr, value)                                              \
+        _InterlockedExchangeAdd64((volatile __int64 *)(ptr), (__int64)(value))
+    #define TRACE_LOAD(ptr) (*(volatile const ullong_t *)(ptr))
+    #define TRACE_ACQUIRE(ptr) (*(volatile const ullong_t *)(ptr))
+    #define TRACE_RELEASE(ptr, value) (*(volatile ullong_t *)(ptr) = (value))
+    #define TRACE_LOCK(ptr) _InterlockedExchange((volatile long *)(ptr), 1)
+    #define TRACE_PAUSE() _mm_pause()
+#else
+    #error "Unsupported compiler"
+#endif
+
+/**
+ * @struct trace_event
+ * @brief A span recorded by a thread.
+ */
+typedef struct trace_event
+{
+    const char *name;     ///< The name of the span.
+    ullong_t    start;    ///< The clock ticks at the start.
+    ullong_t    duration; ///< The clock ticks it lasted.
+} trace_event_t;
+
+/**
+ * @struct trace_buffer
+ * @brief The ring of the spans of a thread.
+ *
+ * The thread is the only writer of the events and the head, the flush the
+ * only writer of the tail.
+ */
+typedef struct trace_buffer
+{
+    struct trace_buffer *next;      ///< The next buffer of the list.
+    ullong_t             head;      ///< The events recorded.
+    ullong_t             tail;      ///< The events flushed.
+    ullong_t             seen_tail; ///< The tail as the thread last read it.
+    ullong_t             exited;    ///< Whether the thread let it go.
+    uint_t               thread;    ///< The number of the thread.
+    trace_event_t        events[TRACE_BUFFER_EVENTS]; ///< The ring.
+} trace_buffer_t;
+
+volatile uint_t trace_active = 0;
+
+static trace_buffer_t *m_buffers = nullptr;
+static uint_t          m_buffers_lock = 0;
+static uint_t          m_threads = 0;
+static ullong_t        m_dropped = 0;
+
+static TRACE_THREAD_LOCAL trace_buffer_t *m_buffer = nullptr;
+
+#if defined(LIQUID_TARGET_OS_WINDOWS)
+static INIT_ONCE m_exit_once = INIT_ONCE_STATIC_INIT;
+static DWORD     m_exit_key = FLS_OUT_OF_INDEXES;
+#elif defined(LIQUID_TARGET_OS_POSIX_LIKE)
+static pthread_once_t m_exit_once = PTHREAD_ONCE_INIT;
+static pthread_key_t  m_exit_key;
+static bool           m_exit_key_created = false;
+#endif
+
+/**
+ * @brief Takes the lock of the list of buffers.
+ */
+static void
+trace_lock(void)
+{
+    while (TRACE_LOCK(&m_buffers_lock))
+    {
+        TRACE_PAUSE();
+    }
+}
+
+/**
+ * @brief Releases the lock of the list of buffers.
+ */
+static void
+trace_unlock(void)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(&m_buffers_lock, 0, __ATOMIC_RELEASE);
+#else
+    *(volatile uint_t *)&m_buffers_lock = 0;
+#endif
+}
+
+/**
+ * @brief Lets the buffer of a thread go.
+ *
+ * An empty buffer is freed at once, one still holding events is freed by
+ * the flush that writes them.
+ *
+ * @param buffer The buffer.
+ */
+static void
+trace_buffer_detach(trace_buffer_t *buffer)
+{
+    trace_lock();
+    if (buffer->head != buffer->tail)
+    {
+        TRACE_RELEASE(&buffer->exited, 1);
+        trace_unlock();
+        return;
+    }
+
+    trace_buffer_t **link = &m_buffers;
+    while (*link != buffer)
+    {
+        link = &(*link)->next;
+    }
+    *link = buffer->next;
+    trace_unlock();
+    alloc_delete(nullptr, buffer, sizeof(trace_buffer_t));
+}
+
+#if defined(LIQUID_TARGET_OS_WINDOWS)
+/**
+ * @brief Lets the buffer of a thread go when the thread exits.
+ * @param buffer The buffer.
+ */
+static VOID WINAPI
+trace_thread_destructor(PVOID buffer)
+{
+    if (buffer)
+    {
+        m_buffer = nullptr;
+        trace_buffer_detach(buffer);
+    }
+}
+
+/**
+ * @brief Allocates the fiber local slot whose callback lets the buffers go.
+ *
+ * @param once The one-time initialization.
+ * @param parameter Unused.
+ * @param context Unused.
+ * @return TRUE on success, FALSE on failure.
+ */
+static BOOL CALLBACK
+trace_exit_key_create(PINIT_ONCE once, PVOID parameter, PVOID *context)
+{
+    (void)once;
+    (void)parameter;
+    (void)context;
+
+    m_exit_key = FlsAlloc(trace_thread_destructor);
+    return m_exit_key != FLS_OUT_OF_INDEXES;
+}
+
+/**
+ * @brief Lets the buffer of the calling thread go when the thread exits.
+ * @param buffer The buffer, nullptr to not let any go.
+ */
+static void
+trace_exit_register(trace_buffer_t *buffer)
+{
+    if (InitOnceExecuteOnce(&m_exit_once, trace_exit_key_create, nullptr,
+                            nullptr))
+    {
+        FlsSetValue(m_exit_key, buffer);
+    }
+}
+#elif defined(LIQUID_TARGET_OS_POSIX_LIKE)
+/**
+ * @brief Lets the buffer of a thread go when the thread exits.
+ * @param buffer The buffer.
+ */
+static void
+trace_thread_destructor(void *buffer)
+{
+    m_buffer = nullptr;
+    trace_buffer_detach(buffer);
+}
+
+/**
+ * @brief Creates the key whose destructor lets the buffers go.
+ */
+static void
+trace_exit_key_create(void)
+{
+    m_exit_key_created = !pthread_key_create(&m_exit_key,
+                                             trace_thread_destructor);
+}
+
+/**
+ * @brief Lets the buffer of the calling thread go when the thread exits.
+ * @param buffer The buffer, nullptr to not let any go.
+ */
+static void
+trace_exit_register(trace_buffer_t *buffer)
+{
+    pthread_once(&m_exit_once, trace_exit_key_create);
+    if (m_exit_key_created)
+    {
+        pthread_setspecific(m_exit_key, buffer);
+    }
+}
+#endif
+
+/**
+ * @brief Gives the calling thread a buffer and adds it to the list.
+ * @return The buffer, nullptr if it could not be allocated.
+ */
+static trace_buffer_t *
+trace_buffer_attach(void)
+{
+    trace_buffer_t *buffer = alloc_new(nullptr, sizeof(trace_buffer_t));
+    if (!buffer)
+    {
+        return nullptr;
+    }
+    buffer->head = 0;
+    buffer->tail = 0;
+    buffer->seen_tail = 0;
+    buffer->exited = 0;
+
+    trace_lock();
+    buffer->thread = ++m_threads;
+    buffer->next = m_buffers;
+    m_buffers = buffer;
+    trace_unlock();
+    m_buffer = buffer;
+    trace_exit_register(buffer);
+    return buffer;
+}
+
+/**
+ * @brief Appends an event to a file in the trace event format, with its
+ *        times in microseconds.
+ *
+ * @param file The file.
+ * @param thread The number of the thread of the event.
+ * @param event The event.
+ * @return True on success, false if the builder could not grow.
+ */
+static bool
+trace_append_event(trace_file_t *file, uint_t thread,
+                   const trace_event_t *event)
+{
+    // The first event follows the opening bracket, the others a comma.
+    ullong_t    start = metric_clock_nanoseconds(event->start);
+    ullong_t    duration = metric_clock_nanoseconds(event->duration);
+    const char *separator = file->events ? ",\n{\"name\":" : "\n{\"name\":";
+    bool        ok =
+        str_builder_append(&file->builder, separator, 0)
+        && str_builder_append_json(&file->builder, event->name)
+        && str_builder_appendf(
+            &file->builder,
+            ",\"ph\":\"X\",\"ts\":%llu.%03u,\"dur\":%llu.%03u,\"pid\":1,"
+            "\"tid\":%u}",
+            start / 1000, (uint_t)(start % 1000), duration / 1000,
+            (uint_t)(duration % 1000), thread);
+    file->events += ok;
+    return ok;
+}
+
+void
+trace_start(void)
+{
+    // A span only compares the flag, the clock is set up beforehand.
+    metric_clock_ticks();
+    trace_active = 1;
+}
+
+void
+trace_stop(void)
+{
+    trace_active = 0;
+}
+
+void
+trace_record(const char *name, ullong_t start, ullong_t end)
+{
+    trace_buffer_t *buffer = m_buffer ? m_buffer : trace_buffer_attach();
+    if (!buffer)
+    {
+        TRACE_ADD(&m_dropped, 1);
+        return;
+    }
+
+    // The tail is read again only when the ring looks full, so that the
+    // thread does not share the line of the flush on every span.
+    ullong_t head = buffer->head;
+    if (head - buffer->seen_tail >= TRACE_BUFFER_EVENTS)
+    {
+        buffer->seen_tail = TRACE_ACQUIRE(&buffer->tail);
+        if (head - buffer->seen_tail >= TRACE_BUFFER_EVENTS)
+        {
+            TRACE_ADD(&m_dropped, 1);
+            return;
+        }
+    }
+
+    trace_event_t *event = &buffer->events[head & (TRACE_BUFFER_EVENTS - 1)];
+    event->name = name;
+    event->start = start;
+    event->duration = end - start;
+    TRACE_RELEASE(&buffer->head, head + 1);
+}
+
+void
+trace_thread_exit(void)
+{
+    if (m_buffer)
+    {
+        trace_exit_register(nullptr);
+        trace_buffer_detach(m_buffer);
+        m_buffer = nullptr;
+    }
+}
+
+ullong_t
+trace_dropped(void)
+{
+    return TRACE_LOAD(&m_dropped);
+}
+
+bool
+trace_file_open(trace_file_t *file, const char_t *path)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(file && path, false,
+                                  "invalid file or path pointer")
+
+    if (!fs_stream_open(&file->stream, path,
+                        FS_WRITE | FS_CREATE | FS_TRUNCATE, nullptr))
+    {
+        return false;
+    }
+    str_builder_init(&file->builder, nullptr);
+    file->events = 0;
+    if (!fs_stream_write(&file->stream, "[", 1))
+    {
+        fs_stream_close(&file->stream);
+        str_builder_free(&file->builder);
+        return false;
+    }
+    return true;
+}
+
+bool
+trace_file_flush(trace_file_t *file)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(file, false, "invalid file pointer")
+
+    // The events are formatted under the lock and written after it, so
+    // that threads starting to trace do not wait for the file.
+    bool ok = true;
+    str_builder_clear(&file->builder);
+    trace_lock();
+    trace_buffer_t **link = &m_buffers;
+    while (*link)
+    {
+        // The thread records nothing more once it has let its buffer go,
+        // so reading the flag first sees every event it recorded.
+        trace_buffer_t *buffer = *link;
+        ullong_t        exited = TRACE_ACQUIRE(&buffer->exited);
+        ullong_t        head = TRACE_ACQUIRE(&buffer->head);
+        ullong_t        tail = buffer->tail;
+        while (ok && tail != head)
+        {
+            ok = trace_append_event(
+                file, buffer->thread,
+                &buffer->events[tail & (TRACE_BUFFER_EVENTS - 1)]);
+            tail += ok;
+        }
+        TRACE_RELEASE(&buffer->tail, tail);
+
+        if (exited && tail == head)
+        {
+            *link = buffer->next;
+            alloc_delete(nullptr, buffer, sizeof(trace_buffer_t));
+        }
+        else
+        {
+            link = &buffer->next;
+        }
+    }
+    trace_unlock();
+
+    return ok
+           && fs_stream_write(&file->stream, STR_BUILDER_DATA(&file->builder),
+                              file->builder.size)
+           && fs_stream_flush(&file->stream);
+}
+
+bool
+trace_file_close(trace_file_t *file)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(file, false, "invalid file pointer")
+
+    bool ok = trace_file_flush(file)
+              && fs_stream_write(&file->stream, "\n]\n", 3);
+    ok = fs_stream_close(&file->stream) && ok;
+    str_builder_free(&file->builder);
+    return ok;
+}
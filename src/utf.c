@@ -0,0 +1,786 @@
+#include <liquid/exception.h>
+#include <liquid/utf.h>
+
+#if (defined(__GNUC__) || defined(__clang__))                                  \
+    && (defined(__x86_64__) || defined(__i386__))
+    #include <tmmintrin.h>
+    #define UTF_SIMD_SSSE3
+    #define UTF_TARGET_SSSE3 __attribute__((target("ssse3")))
+    #define UTF_HAS_SSSE3() __builtin_cpu_supports("ssse3")
+#elif defined(_MSC_VER) && defined(__AVX__)
+    #include <tmmintrin.h>
+    #define UTF_SIMD_SSSE3
+    #define UTF_TARGET_SSSE3
+    #define UTF_HAS_SSSE3() 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define UTF_SIMD_NEON
+#endif
+
+/**
+ * @def UTF_HIGH_BITS
+ * @brief The highest bit of every byte in a word.
+ */
+#define UTF_HIGH_BITS 0x8080808080808080ull
+
+/**
+ * @def UTF_MAX
+ * @brief The largest Unicode code point.
+ */
+#define UTF_MAX 0x10FFFF
+
+#if defined(UTF_SIMD_SSSE3) || defined(UTF_SIMD_NEON)
+    // Error classes of two consecutive bytes, see the tables below.
+    #define UTF8_TOO_SHORT (1 << 0)
+    #define UTF8_TOO_LONG (1 << 1)
+    #define UTF8_OVERLONG_3 (1 << 2)
+    #define UTF8_TOO_LARGE (1 << 3)
+    #define UTF8_SURROGATE (1 << 4)
+    #define UTF8_OVERLONG_2 (1 << 5)
+    #define UTF8_TOO_LARGE_1000 (1 << 6)
+    #define UTF8_OVERLONG_4 (1 << 6)
+    #define UTF8_TWO_CONTS (1 << 7)
+    #define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+/**
+ * @brief Errors possible after a byte, indexed by its high nibble.
+ *
+ * A byte pair is malformed if the classes looked up for the high and low
+ * nibble of the first byte and the high nibble of the second byte share a
+ * bit (the lookup algorithm of Keiser and Lemire).
+ */
+static const uchar_t UTF8_BYTE_1_HIGH[16] = {
+    UTF8_TOO_LONG,
+    UTF8_TOO_LONG,
+    UTF8_TOO_LONG,
+    UTF8_TOO_LONG,
+    UTF8_TOO_LONG,
+    UTF8_TOO_LONG,
+    UTF8_TOO_LONG,
+    UTF8_TOO_LONG,
+    UTF8_TWO_CONTS,
+    UTF8_TWO_CONTS,
+    UTF8_TWO_CONTS,
+    UTF8_TWO_CONTS,
+    UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+    UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+    UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4};
+
+/**
+ * @brief Errors possible after a byte, indexed by its low nibble.
+ */
+static const uchar_t UTF8_BYTE_1_LOW[16] = {
+    UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+    UTF8_CARRY | UTF8_OVERLONG_2,
+    UTF8_CARRY,
+    UTF8_CARRY,
+    UTF8_CARRY | UTF8_TOO_LARGE,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000};
+
+/**
+ * @brief Errors possible before a byte, indexed by its high nibble.
+ */
+static const uchar_t UTF8_BYTE_2_HIGH[16] = {
+    UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3
+        | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3
+        | UTF8_TOO_LARGE,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE
+        | UTF8_TOO_LARGE,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE
+        | UTF8_TOO_LARGE,
+    UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT};
+
+/**
+ * @brief The largest bytes that may end a block without leaving
+ *        a sequence incomplete.
+ */
+static const uchar_t UTF8_INCOMPLETE_MAX[16] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF};
+#endif
+
+/**
+ * @brief Loads eight bytes into a word.
+ * @param src Pointer to the bytes.
+ * @return The bytes packed into a word, the first one lowest.
+ */
+static ullong_t
+utf_load8(const uchar_t *src)
+{
+    return (ullong_t)src[0] | (ullong_t)src[1] << 8 | (ullong_t)src[2] << 16
+           | (ullong_t)src[3] << 24 | (ullong_t)src[4] << 32
+           | (ullong_t)src[5] << 40 | (ullong_t)src[6] << 48
+           | (ullong_t)src[7] << 56;
+}
+
+/**
+ * @brief Counts the bytes of a word that have their highest bit set
+ *        while all other bits are clear.
+ * @param mask The word, only the highest bit of each byte may be set.
+ * @return The number of set bits.
+ */
+static uint_t
+utf_count_high_bits(ullong_t mask)
+{
+    // The multiplication adds all bytes into the highest one.
+    return (uint_t)(((mask >> 7) * 0x0101010101010101ull) >> 56);
+}
+
+/**
+ * @brief Skips a run of ASCII characters eight bytes at a time.
+ *
+ * @param ptr Pointer to the first byte.
+ * @param end Pointer past the last byte.
+ * @return Pointer to the first word that contains a non-ASCII byte or to
+ *         the last few bytes that do not fill a word.
+ */
+static const uchar_t *
+utf8_skip_ascii(const uchar_t *ptr, const uchar_t *end)
+{
+    while (LIQUID_PTR_DIFF(ptr, end) >= 8 && !(utf_load8(ptr) & UTF_HIGH_BITS))
+    {
+        ptr += 8;
+    }
+    return ptr;
+}
+
+/**
+ * @brief Decodes a single UTF-8 sequence.
+ *
+ * @param ptr Pointer to the first byte of the sequence.
+ * @param end Pointer past the last byte of the text.
+ * @param code_point Receives the code point.
+ * @return Pointer past the sequence, or nullptr if it is malformed.
+ */
+static const uchar_t *
+utf8_decode(const uchar_t *ptr, const uchar_t *end, uint_t *code_point)
+{
+    uint_t lead = *ptr++;
+    if (lead < 0x80)
+    {
+        *code_point = lead;
+        return ptr;
+    }
+
+    // Leads C0 and C1 can only start overlong forms of ASCII characters.
+    uint_t value;
+    uint_t count;
+    uint_t min;
+    if (lead < 0xC2)
+    {
+        return nullptr;
+    }
+    else if (lead < 0xE0)
+    {
+        value = lead & 0x1F;
+        count = 1;
+        min = 0x80;
+    }
+    else if (lead < 0xF0)
+    {
+        value = lead & 0x0F;
+        count = 2;
+        min = 0x800;
+    }
+    else if (lead < 0xF5)
+    {
+        value = lead & 0x07;
+        count = 3;
+        min = 0x10000;
+    }
+    else
+    {
+        return nullptr;
+    }
+
+    if ((usize_t)LIQUID_PTR_DIFF(ptr, end) < count)
+    {
+        return nullptr;
+    }
+    for (uint_t i = 0; i < count; ++i)
+    {
+        uint_t next = *ptr++;
+        if ((next & 0xC0) != 0x80)
+        {
+            return nullptr;
+        }
+        value = (value << 6) | (next & 0x3F);
+    }
+
+    if (value < min || value > UTF_MAX || (value - 0xD800) < 0x800)
+    {
+        return nullptr;
+    }
+    *code_point = value;
+    return ptr;
+}
+
+/**
+ * @brief Decodes a single UTF-16 code point.
+ *
+ * @param ptr Pointer to the first unit of the code point.
+ * @param end Pointer past the last unit of the text.
+ * @param code_point Receives the code point.
+ * @return Pointer past the code point, or nullptr for unpaired surrogates.
+ */
+static const ushort_t *
+utf16_decode(const ushort_t *ptr, const ushort_t *end, uint_t *code_point)
+{
+    uint_t unit = *ptr++;
+    if (unit - 0xD800 >= 0x800)
+    {
+        *code_point = unit;
+        return ptr;
+    }
+
+    if (unit >= 0xDC00 || ptr == end || (uint_t)(*ptr - 0xDC00) >= 0x400)
+    {
+        return nullptr;
+    }
+    *code_point = 0x10000 + ((unit - 0xD800) << 10) + (*ptr++ - 0xDC00);
+    return ptr;
+}
+
+/**
+ * @brief Encodes a code point as UTF-8.
+ *
+ * @param out Pointer to the next byte of the output.
+ * @param out_end Pointer past the end of the output buffer.
+ * @param code_point A valid code point.
+ * @return Pointer past the encoded bytes, or nullptr if they do not fit.
+ */
+static char *
+utf8_encode(char *out, const char *out_end, uint_t code_point)
+{
+    usize_t len = 1 + (code_point >= 0x80) + (code_point >= 0x800)
+                  + (code_point >= 0x10000);
+    LIQUID_EXCEPTION_RAISE_IF((usize_t)LIQUID_PTR_DIFF(out, out_end) < len,
+                              nullptr, "destination buffer is too small")
+
+    switch (len)
+    {
+    case 1:
+        out[0] = (char)code_point;
+        break;
+    case 2:
+        out[0] = (char)(0xC0 | (code_point >> 6));
+        out[1] = (char)(0x80 | (code_point & 0x3F));
+        break;
+    case 3:
+        out[0] = (char)(0xE0 | (code_point >> 12));
+        out[1] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (code_point & 0x3F));
+        break;
+    default:
+        out[0] = (char)(0xF0 | (code_point >> 18));
+        out[1] = (char)(0x80 | ((code_point >> 12) & 0x3F));
+        out[2] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        out[3] = (char)(0x80 | (code_point & 0x3F));
+        break;
+    }
+    return out + len;
+}
+
+#if defined(UTF_SIMD_SSSE3)
+/**
+ * @brief Validates UTF-8 text sixteen bytes at a time with SSSE3.
+ *
+ * @param ptr Pointer to the first byte.
+ * @param end Pointer past the last byte.
+ * @return Pointer to the first block that is malformed or does not fill
+ *         a register; sequences may start up to three bytes before it.
+ */
+UTF_TARGET_SSSE3 static const uchar_t *
+utf8_validate_simd(const uchar_t *ptr, const uchar_t *end)
+{
+    const __m128i byte_1_high = _mm_loadu_si128((const void *)UTF8_BYTE_1_HIGH);
+    const __m128i byte_1_low = _mm_loadu_si128((const void *)UTF8_BYTE_1_LOW);
+    const __m128i byte_2_high = _mm_loadu_si128((const void *)UTF8_BYTE_2_HIGH);
+    const __m128i max = _mm_loadu_si128((const void *)UTF8_INCOMPLETE_MAX);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+
+    __m128i prev_input = zero;
+    __m128i prev_incomplete = zero;
+    for (; LIQUID_PTR_DIFF(ptr, end) >= 16; ptr += 16)
+    {
+        __m128i input = _mm_loadu_si128((const void *)ptr);
+        __m128i error = prev_incomplete;
+
+        if (_mm_movemask_epi8(input))
+        {
+            __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+            __m128i special = _mm_and_si128(
+                _mm_and_si128(
+                    _mm_shuffle_epi8(
+                        byte_1_high,
+                        _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+                    _mm_shuffle_epi8(byte_1_low, _mm_and_si128(prev1, nibble))),
+                _mm_shuffle_epi8(
+                    byte_2_high,
+                    _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+
+            // The second and third byte after a three or four byte lead
+            // must be continuations, the pair lookup cannot see that far.
+            __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+            __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+            __m128i must23 = _mm_or_si128(
+                _mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xE0 - 0x80))),
+                _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xF0 - 0x80))));
+
+            error = _mm_xor_si128(
+                _mm_and_si128(must23, _mm_set1_epi8((char)0x80)), special);
+            prev_incomplete = _mm_subs_epu8(input, max);
+        }
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, zero)) != 0xFFFF)
+        {
+            break;
+        }
+        prev_input = input;
+    }
+    return ptr;
+}
+#elif defined(UTF_SIMD_NEON)
+/**
+ * @brief Validates UTF-8 text sixteen bytes at a time with NEON.
+ *
+ * @param ptr Pointer to the first byte.
+ * @param end Pointer past the last byte.
+ * @return Pointer to the first block that is malformed or does not fill
+ *         a register; sequences may start up to three bytes before it.
+ */
+static const uchar_t *
+utf8_validate_simd(const uchar_t *ptr, const uchar_t *end)
+{
+    const uint8x16_t byte_1_high = vld1q_u8(UTF8_BYTE_1_HIGH);
+    const uint8x16_t byte_1_low = vld1q_u8(UTF8_BYTE_1_LOW);
+    const uint8x16_t byte_2_high = vld1q_u8(UTF8_BYTE_2_HIGH);
+    const uint8x16_t max = vld1q_u8(UTF8_INCOMPLETE_MAX);
+    const uint8x16_t nibble = vdupq_n_u8(0x0F);
+
+    uint8x16_t prev_input = vdupq_n_u8(0);
+    uint8x16_t prev_incomplete = vdupq_n_u8(0);
+    for (; LIQUID_PTR_DIFF(ptr, end) >= 16; ptr += 16)
+    {
+        uint8x16_t input = vld1q_u8(ptr);
+        uint8x16_t error = prev_incomplete;
+
+        if (vmaxvq_u8(input) >= 0x80)
+        {
+            uint8x16_t prev1 = vextq_u8(prev_input, input, 15);
+            uint8x16_t special = vandq_u8(
+                vandq_u8(vqtbl1q_u8(byte_1_high, vshrq_n_u8(prev1, 4)),
+                         vqtbl1q_u8(byte_1_low, vandq_u8(prev1, nibble))),
+                vqtbl1q_u8(byte_2_high, vshrq_n_u8(input, 4)));
+
+            // The second and third byte after a three or four byte lead
+            // must be continuations, the pair lookup cannot see that far.
+            uint8x16_t prev2 = vextq_u8(prev_input, input, 14);
+            uint8x16_t prev3 = vextq_u8(prev_input, input, 13);
+            uint8x16_t must23 =
+                vorrq_u8(vqsubq_u8(prev2, vdupq_n_u8(0xE0 - 0x80)),
+                         vqsubq_u8(prev3, vdupq_n_u8(0xF0 - 0x80)));
+
+            error = veorq_u8(vandq_u8(must23, vdupq_n_u8(0x80)), special);
+            prev_incomplete = vqsubq_u8(input, max);
+        }
+
+        if (vmaxvq_u8(error))
+        {
+            break;
+        }
+        prev_input = input;
+    }
+    return ptr;
+}
+#endif
+
+const char *
+utf8_invalid_pos(const char *begin, const char *end)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end, nullptr, "invalid range")
+
+    const uchar_t *ptr = (const uchar_t *)begin;
+    const uchar_t *last = (const uchar_t *)end;
+
+#if defined(UTF_SIMD_SSSE3) || defined(UTF_SIMD_NEON)
+    #if defined(UTF_SIMD_SSSE3)
+    if (UTF_HAS_SSSE3())
+    #endif
+    {
+        // Everything before the stop is valid except for sequences still
+        // open at its start, so resume at the earliest lead that precedes
+        // it by less than a full sequence.
+        const uchar_t *stop = utf8_validate_simd(ptr, last);
+        ptr = stop;
+        for (uint_t back = 3; back > 0; --back)
+        {
+            if ((usize_t)LIQUID_PTR_DIFF((const uchar_t *)begin, stop) >= back
+                && stop[-(sint_t)back] >= 0xC0)
+            {
+                ptr = stop - back;
+                break;
+            }
+        }
+    }
+#endif
+
+    while (ptr != last)
+    {
+        if (*ptr < 0x80)
+        {
+            ptr = utf8_skip_ascii(ptr, last);
+            if (ptr == last)
+            {
+                break;
+            }
+            if (*ptr < 0x80)
+            {
+                ++ptr;
+                continue;
+            }
+        }
+
+        uint_t         code_point;
+        const uchar_t *next = utf8_decode(ptr, last, &code_point);
+        if (!next)
+        {
+            return (const char *)ptr;
+        }
+        ptr = next;
+    }
+    return nullptr;
+}
+
+bool
+utf8_is_valid(const char *begin, const char *end)
+{
+    return begin && end && !utf8_invalid_pos(begin, end);
+}
+
+usize_t
+utf8_utf32_len(const char *begin, const char *end)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end, 0, "invalid range")
+
+    const uchar_t *ptr = (const uchar_t *)begin;
+    const uchar_t *last = (const uchar_t *)end;
+    usize_t        len = 0;
+
+    // Every byte but a continuation starts a code point.
+    for (; LIQUID_PTR_DIFF(ptr, last) >= 8; ptr += 8)
+    {
+        ullong_t chunk = utf_load8(ptr);
+        len += 8 - utf_count_high_bits(chunk & ~(chunk << 1) & UTF_HIGH_BITS);
+    }
+    for (; ptr != last; ++ptr)
+    {
+        len += (*ptr & 0xC0) != 0x80;
+    }
+    return len;
+}
+
+usize_t
+utf8_utf16_len(const char *begin, const char *end)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end, 0, "invalid range")
+
+    const uchar_t *ptr = (const uchar_t *)begin;
+    const uchar_t *last = (const uchar_t *)end;
+    usize_t        len = 0;
+
+    // Code points of four bytes need a surrogate pair.
+    for (; LIQUID_PTR_DIFF(ptr, last) >= 8; ptr += 8)
+    {
+        ullong_t chunk = utf_load8(ptr);
+        ullong_t four = chunk & (chunk << 1) & (chunk << 2) & (chunk << 3);
+        len += 8 - utf_count_high_bits(chunk & ~(chunk << 1) & UTF_HIGH_BITS)
+               + utf_count_high_bits(four & UTF_HIGH_BITS);
+    }
+    for (; ptr != last; ++ptr)
+    {
+        len += ((*ptr & 0xC0) != 0x80) + (*ptr >= 0xF0);
+    }
+    return len;
+}
+
+usize_t
+utf16_utf8_len(const ushort_t *begin, const ushort_t *end)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end, 0, "invalid range")
+
+    // Each half of a surrogate pair accounts for two of its four bytes.
+    usize_t len = 0;
+    for (; begin != end; ++begin)
+    {
+        uint_t unit = *begin;
+        len += 1 + (unit >= 0x80) + (unit >= 0x800 && unit - 0xD800 >= 0x800);
+    }
+    return len;
+}
+
+usize_t
+utf32_utf8_len(const uint_t *begin, const uint_t *end)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(begin && end, 0, "invalid range")
+
+    usize_t len = 0;
+    for (; begin != end; ++begin)
+    {
+        uint_t code_point = *begin;
+        len += 1 + (code_point >= 0x80) + (code_point >= 0x800)
+               + (code_point >= 0x10000);
+    }
+    return len;
+}
+
+ushort_t *
+utf8_to_utf16(ushort_t *dest, usize_t dest_size, const char *begin,
+              const char *end)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && begin && end, nullptr,
+                                  "invalid destination pointer or range")
+
+    const uchar_t *ptr = (const uchar_t *)begin;
+    const uchar_t *last = (const uchar_t *)end;
+    ushort_t      *out = dest;
+    ushort_t      *out_end = dest + dest_size;
+
+    while (ptr != last)
+    {
+        // Runs of ASCII are widened a word at a time.
+        if (LIQUID_PTR_DIFF(ptr, last) >= 8
+            && LIQUID_PTR_DIFF(out, out_end) >= 8
+            && !(utf_load8(ptr) & UTF_HIGH_BITS))
+        {
+            for (uint_t i = 0; i < 8; ++i)
+            {
+                out[i] = ptr[i];
+            }
+            ptr += 8;
+            out += 8;
+            continue;
+        }
+
+        uint_t         code_point;
+        const uchar_t *next = utf8_decode(ptr, last, &code_point);
+        if (!next)
+        {
+            return nullptr;
+        }
+
+        usize_t units = code_point >= 0x10000 ? 2 : 1;
+        LIQUID_EXCEPTION_RAISE_IF(
+            (usize_t)LIQUID_PTR_DIFF(out, out_end) < units, nullptr,
+            "destination buffer is too small")
+        if (units == 2)
+        {
+            code_point -= 0x10000;
+            *out++ = (ushort_t)(0xD800 | (code_point >> 10));
+            *out++ = (ushort_t)(0xDC00 | (code_point & 0x3FF));
+        }
+        else
+        {
+            *out++ = (ushort_t)code_point;
+        }
+        ptr = next;
+    }
+    return out;
+}
+
+uint_t *
+utf8_to_utf32(uint_t *dest, usize_t dest_size, const char *begin,
+              const char *end)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && begin && end, nullptr,
+                                  "invalid destination pointer or range")
+
+    const uchar_t *ptr = (const uchar_t *)begin;
+    const uchar_t *last = (const uchar_t *)end;
+    uint_t        *out = dest;
+    uint_t        *out_end = dest + dest_size;
+
+    while (ptr != last)
+    {
+        // Runs of ASCII are widened a word at a time.
+        if (LIQUID_PTR_DIFF(ptr, last) >= 8
+            && LIQUID_PTR_DIFF(out, out_end) >= 8
+            && !(utf_load8(ptr) & UTF_HIGH_BITS))
+        {
+            for (uint_t i = 0; i < 8; ++i)
+            {
+                out[i] = ptr[i];
+            }
+            ptr += 8;
+            out += 8;
+            continue;
+        }
+
+        uint_t         code_point;
+        const uchar_t *next = utf8_decode(ptr, last, &code_point);
+        if (!next)
+        {
+            return nullptr;
+        }
+
+        LIQUID_EXCEPTION_RAISE_IF(out == out_end, nullptr,
+                                  "destination buffer is too small")
+        *out++ = code_point;
+        ptr = next;
+    }
+    return out;
+}
+
+char *
+utf16_to_utf8(char *dest, usize_t dest_size, const ushort_t *begin,
+              const ushort_t *end)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && begin && end, nullptr,
+                                  "invalid destination pointer or range")
+
+    char *out = dest;
+    char *out_end = dest + dest_size;
+
+    while (begin != end)
+    {
+        // Runs of ASCII are narrowed four units at a time.
+        if (LIQUID_PTR_DIFF(begin, end) >= 4
+            && LIQUID_PTR_DIFF(out, out_end) >= 4
+            && (begin[0] | begin[1] | begin[2] | begin[3]) < 0x80)
+        {
+            out[0] = (char)begin[0];
+            out[1] = (char)begin[1];
+            out[2] = (char)begin[2];
+            out[3] = (char)begin[3];
+            begin += 4;
+            out += 4;
+            continue;
+        }
+
+        uint_t code_point;
+        begin = utf16_decode(begin, end, &code_point);
+        if (!begin)
+        {
+            return nullptr;
+        }
+
+        out = utf8_encode(out, out_end, code_point);
+        if (!out)
+        {
+            return nullptr;
+        }
+    }
+    return out;
+}
+
+char *
+utf32_to_utf8(char *dest, usize_t dest_size, const uint_t *begin,
+              const uint_t *end)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(dest && begin && end, nullptr,
+                                  "invalid destination pointer or range")
+
+    char *out = dest;
+    char *out_end = dest + dest_size;
+
+    for (; begin != end; ++begin)
+    {
+        uint_t code_point = *begin;
+        if (code_point > UTF_MAX || code_point - 0xD800 < 0x800)
+        {
+            return nullptr;
+        }
+
+        out = utf8_encode(out, out_end, code_point);
+        if (!out)
+        {
+            return nullptr;
+        }
+    }
+    return out;
+}
+
+// wchar_t holds UTF-16 on Windows and UTF-32 everywhere else.
+#if WCHAR_MAX <= 0xFFFF
+
+usize_t
+utf8_wstr_len(const char *begin, const char *end)
+{
+    return utf8_utf16_len(begin, end);
+}
+
+usize_t
+wstr_utf8_len(const wchar_t *begin, const wchar_t *end)
+{
+    return utf16_utf8_len((const ushort_t *)begin, (const ushort_t *)end);
+}
+
+wchar_t *
+utf8_to_wstr(wchar_t *dest, usize_t dest_size, const char *begin,
+             const char *end)
+{
+    return (wchar_t *)utf8_to_utf16((ushort_t *)dest, dest_size, begin, end);
+}
+
+char *
+wstr_to_utf8(char *dest, usize_t dest_size, const wchar_t *begin,
+             const wchar_t *end)
+{
+    return utf16_to_utf8(dest, dest_size, (const ushort_t *)begin,
+                         (const ushort_t *)end);
+}
+
+#else
+
+usize_t
+utf8_wstr_len(const char *begin, const char *end)
+{
+    return utf8_utf32_len(begin, end);
+}
+
+usize_t
+wstr_utf8_len(const wchar_t *begin, const wchar_t *end)
+{
+    return utf32_utf8_len((const uint_t *)begin, (const uint_t *)end);
+}
+
+wchar_t *
+utf8_to_wstr(wchar_t *dest, usize_t dest_size, const char *begin,
+             const char *end)
+{
+    return (wchar_t *)utf8_to_utf32((uint_t *)dest, dest_size, begin, end);
+}
+
+char *
+wstr_to_utf8(char *dest, usize_t dest_size, const wchar_t *begin,
+             const wchar_t *end)
+{
+    return utf32_to_utf8(dest, dest_size, (const uint_t *)begin,
+                         (const uint_t *)end);
+}
+
+#endif
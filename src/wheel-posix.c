@@ -0,0 +1,21 @@
+#include <liquid/wheel.h>
+#include <sys/time.h>
+#include <time.h>
+
+ullong_t
+wheel_clock_nanoseconds(void)
+{
+#if defined(CLOCK_MONOTONIC)
+    struct timespec now;
+    if (!clock_gettime(CLOCK_MONOTONIC, &now))
+    {
+        return (ullong_t)now.tv_sec * 1000000000 + (ullong_t)now.tv_nsec;
+    }
+#endif
+
+    // Without a monotonic clock the real-time one stands in, which the tick
+    // sources keep from going back when it is set.
+    struct timeval wall;
+    gettimeofday(&wall, nullptr);
+    return (ullong_t)wall.tv_sec * 1000000000 + (ullong_t)wall.tv_usec * 1000;
+}
@@ -0,0 +1,16 @@
+#include <liquid/wheel.h>
+#include <windows.h>
+
+ullong_t
+wheel_clock_nanoseconds(void)
+{
+    // The performance counter is monotonic on every supported version.
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+
+    ullong_t count = (ullong_t)counter.QuadPart;
+    ullong_t rate = (ullong_t)frequency.QuadPart;
+    return count / rate * 1000000000 + count % rate * 1000000000 / rate;
+}
@@ -0,0 +1,366 @@
+#include <liquid/bitflag.h>
+#include <liquid/exception.h>
+#include <liquid/wheel.h>
+
+/**
+ * @def WHEEL_MASK
+ * @brief The mask that maps a digit of a tick to its slot.
+ */
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+
+/**
+ * @def WHEEL_EXPIRED
+ * @brief The slot index of timers that are about to be called.
+ */
+#define WHEEL_EXPIRED (~0u)
+
+/**
+ * @brief Appends a link to a list.
+ *
+ * @param head The head of the list.
+ * @param link The link.
+ */
+static void
+wheel_append(wheel_link_t *head, wheel_link_t *link)
+{
+    link->next = head;
+    link->prev = head->prev;
+    head->prev->next = link;
+    head->prev = link;
+}
+
+/**
+ * @brief Moves every link of a list to the end of another one.
+ *
+ * @param head The head of the list to empty.
+ * @param into The head of the list to append to.
+ */
+static void
+wheel_splice(wheel_link_t *head, wheel_link_t *into)
+{
+    if (head->next == head)
+    {
+        return;
+    }
+    head->next->prev = into->prev;
+    into->prev->next = head->next;
+    head->prev->next = into;
+    into->prev = head->prev;
+    head->next = head;
+    head->prev = head;
+}
+
+/**
+ * @brief Puts a timer into the slot of its expiry.
+ *
+ * @param wheel The wheel.
+ * @param timer The timer, which expires after the tick of the wheel, or
+ *              at WHEEL_NEVER.
+ */
+static void
+wheel_insert(wheel_t *wheel, wheel_timer_t *timer)
+{
+    // The highest digit in which the expiry differs from the tick picks
+    // the level, and the digit of the expiry there the slot. Only a timer
+    // started at the last tick expires at the tick, on the lowest level.
+    ullong_t differ = timer->expiry ^ wheel->tick;
+    uint_t   level = differ ? (63 - bitflag_clz64(differ)) / WHEEL_BITS : 0;
+    uint_t slot = (uint_t)(timer->expiry >> (level * WHEEL_BITS))
+                  & WHEEL_MASK;
+
+    wheel_append(&wheel->slots[level][slot], &timer->link);
+    wheel->occupied[level] |= 1ull << slot;
+    timer->slot = level * WHEEL_SLOTS + slot;
+}
+
+/**
+ * @brief Removes a timer from its slot or from the expired timers.
+ *
+ * @param wheel The wheel.
+ * @param timer The running timer.
+ */
+static void
+wheel_unlink(wheel_t *wheel, wheel_timer_t *timer)
+{
+    timer->link.prev->next = timer->link.next;
+    timer->link.next->prev = timer->link.prev;
+    timer->link.next = nullptr;
+    timer->link.prev = nullptr;
+    --wheel->count;
+
+    if (timer->slot != WHEEL_EXPIRED)
+    {
+        uint_t level = timer->slot / WHEEL_SLOTS;
+        uint_t slot = timer->slot % WHEEL_SLOTS;
+        if (wheel->slots[level][slot].next == &wheel->slots[level][slot])
+        {
+            wheel->occupied[level] &= ~(1ull << slot);
+        }
+    }
+}
+
+/**
+ * @brief Finds the next tick at which a slot of a wheel is due.
+ *
+ * A slot is due when the tick reaches the start of its span, which no
+ * slot has passed since the tick of the wheel. Every tick can be due, so
+ * whether there is one is returned apart from it.
+ *
+ * @param wheel The wheel.
+ * @param due Receives the tick, WHEEL_NEVER if no slot is due.
+ * @return True if a slot is due, false without timers or with timers only
+ *         beyond the last tick.
+ */
+static bool
+wheel_due(const wheel_t *wheel, ullong_t *due)
+{
+    bool found = false;
+    *due = WHEEL_NEVER;
+    for (uint_t level = 0; level < WHEEL_LEVELS; ++level)
+    {
+        if (!wheel->occupied[level])
+        {
+            continue;
+        }
+
+        // Count the slots from the one after the current digit. A start
+        // that wraps around or cannot be shifted back lies past the last
+        // tick.
+        uint_t   shift = level * WHEEL_BITS;
+        ullong_t span = wheel->tick >> shift;
+        ullong_t bits = bitflag_rotr64(wheel->occupied[level],
+                                       (uint_t)(span + 1) & WHEEL_MASK);
+        ullong_t start = span + 1 + bitflag_ctz64(bits);
+        if (start <= span || (shift && start >> (64 - shift)))
+        {
+            continue;
+        }
+        if (!found || start << shift < *due)
+        {
+            *due = start << shift;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void
+wheel_init(wheel_t *wheel, const allocator_t *allocator, ullong_t now)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(wheel, , "invalid wheel pointer")
+
+    for (uint_t level = 0; level < WHEEL_LEVELS; ++level)
+    {
+        for (uint_t slot = 0; slot < WHEEL_SLOTS; ++slot)
+        {
+            wheel->slots[level][slot].next = &wheel->slots[level][slot];
+            wheel->slots[level][slot].prev = &wheel->slots[level][slot];
+        }
+        wheel->occupied[level] = 0;
+    }
+    pool_init(&wheel->pool, allocator, sizeof(wheel_timer_t), 0);
+    wheel->now = now;
+    wheel->tick = now;
+    wheel->count = 0;
+    wheel->data = nullptr;
+}
+
+void
+wheel_free(wheel_t *wheel)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(wheel, , "invalid wheel pointer")
+
+    pool_free(&wheel->pool);
+}
+
+void
+wheel_timer_init(wheel_timer_t *timer, wheel_callback_t callback,
+                 void *data)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(timer && callback, ,
+                                  "invalid timer or callback pointer")
+
+    timer->link.next = nullptr;
+    timer->link.prev = nullptr;
+    timer->callback = callback;
+    timer->data = data;
+    timer->expiry = 0;
+    timer->slot = 0;
+}
+
+wheel_timer_t *
+wheel_timer_new(wheel_t *wheel, wheel_callback_t callback, void *data)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(wheel && callback, nullptr,
+                                  "invalid wheel or callback pointer")
+
+    wheel_timer_t *timer = pool_alloc(&wheel->pool);
+    if (timer)
+    {
+        wheel_timer_init(timer, callback, data);
+    }
+    return timer;
+}
+
+void
+wheel_timer_delete(wheel_t *wheel, wheel_timer_t *timer)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(wheel, , "invalid wheel pointer")
+
+    if (timer)
+    {
+        wheel_timer_stop(wheel, timer);
+        pool_release(&wheel->pool, timer);
+    }
+}
+
+void
+wheel_timer_start(wheel_t *wheel, wheel_timer_t *timer, ullong_t timeout)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(wheel && timer, ,
+                                  "invalid wheel or timer pointer")
+
+    if (timer->link.next)
+    {
+        wheel_unlink(wheel, timer);
+    }
+
+    // The expiry lies after the tick being advanced to, so that timers
+    // started by callbacks wait for the next advance.
+    ullong_t expiry = wheel->now + (timeout ? timeout : 1);
+    timer->expiry = expiry < wheel->now ? WHEEL_NEVER : expiry;
+    wheel_insert(wheel, timer);
+    ++wheel->count;
+}
+
+void
+wheel_timer_stop(wheel_t *wheel, wheel_timer_t *timer)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(wheel && timer, ,
+                                  "invalid wheel or timer pointer")
+
+    if (timer->link.next)
+    {
+        wheel_unlink(wheel, timer);
+    }
+}
+
+bool
+wheel_timer_active(const wheel_timer_t *timer)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(timer, false, "invalid timer pointer")
+
+    return timer->link.next != nullptr;
+}
+
+usize_t
+wheel_advance(wheel_t *wheel, ullong_t now)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(wheel, 0, "invalid wheel pointer")
+
+    if (now <= wheel->now)
+    {
+        return 0;
+    }
+    wheel->now = now;
+
+    usize_t expired_count = 0;
+    for (;;)
+    {
+        // Step from one due tick to the next, so that no slot is skipped
+        // and the timers expire in order.
+        ullong_t due;
+        if (!wheel_due(wheel, &due) || due > now)
+        {
+            break;
+        }
+        wheel->tick = due;
+
+        wheel_link_t moved;
+        moved.next = &moved;
+        moved.prev = &moved;
+        for (uint_t level = 0; level < WHEEL_LEVELS; ++level)
+        {
+            uint_t shift = level * WHEEL_BITS;
+            if (level && due & ((1ull << shift) - 1))
+            {
+                break;
+            }
+            uint_t slot = (uint_t)(due >> shift) & WHEEL_MASK;
+            if (wheel->occupied[level] & (1ull << slot))
+            {
+                wheel_splice(&wheel->slots[level][slot], &moved);
+                wheel->occupied[level] &= ~(1ull << slot);
+            }
+        }
+
+        // The timers of the tick expire, the others move down a level.
+        wheel_link_t expired;
+        expired.next = &expired;
+        expired.prev = &expired;
+        while (moved.next != &moved)
+        {
+            wheel_timer_t *timer = (wheel_timer_t *)moved.next;
+            moved.next = timer->link.next;
+            if (timer->expiry <= due)
+            {
+                wheel_append(&expired, &timer->link);
+                timer->slot = WHEEL_EXPIRED;
+            }
+            else
+            {
+                wheel_insert(wheel, timer);
+            }
+        }
+
+        // The callbacks may start and stop any timer, including expired
+        // ones that have not been called yet.
+        while (expired.next != &expired)
+        {
+            wheel_timer_t *timer = (wheel_timer_t *)expired.next;
+            wheel_unlink(wheel, timer);
+            ++expired_count;
+            timer->callback(wheel, timer);
+        }
+    }
+    wheel->tick = now;
+    return expired_count;
+}
+
+ullong_t
+wheel_next(const wheel_t *wheel)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(wheel, WHEEL_NEVER, "invalid wheel pointer")
+
+    ullong_t due;
+    if (!wheel_due(wheel, &due))
+    {
+        return WHEEL_NEVER;
+    }
+    return due > wheel->now ? due - wheel->now : 0;
+}
+
+void
+wheel_clock_init(wheel_clock_t *clock, ullong_t resolution)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(clock && resolution, ,
+                                  "invalid clock pointer or resolution")
+
+    clock->resolution = resolution;
+    clock->origin = wheel_clock_nanoseconds();
+    clock->last = clock->origin;
+}
+
+ullong_t
+wheel_clock_read(wheel_clock_t *clock)
+{
+    LIQUID_EXCEPTION_RAISE_IF_NOT(clock, 0, "invalid clock pointer")
+
+    // A real-time clock may be set back, the ticks never go back.
+    ullong_t now = wheel_clock_nanoseconds();
+    if (now > clock->last)
+    {
+        clock->last = now;
+    }
+    return (clock->last - clock->origin) / clock->resolution;
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <liquid/arena.h>
+#include <liquid/pool.h>
+
+/**
+ * @test Test case for growing a block of the system allocator.
+ *
+ * This test verifies that a block keeps its contents while it grows past
+ * LIQUID_ALLOC_MAP_THRESHOLD and is resized between the heap and the pages
+ * mapped from the operating system.
+ */
+TEST(alloc, system_resize_keeps_contents)
+{
+    usize_t size = 1024;
+    auto   *block = (uchar_t *)alloc_new(nullptr, size);
+    ASSERT_NE(block, nullptr);
+
+    for (usize_t i = 0; i < size; ++i)
+    {
+        block[i] = (uchar_t)i;
+    }
+
+    const usize_t sizes[] = {LIQUID_ALLOC_MAP_THRESHOLD * 2,
+                             LIQUID_ALLOC_MAP_THRESHOLD * 8, 512};
+
+    for (usize_t new_size : sizes)
+    {
+        block = (uchar_t *)alloc_resize(nullptr, block, size, new_size);
+        ASSERT_NE(block, nullptr);
+        size = new_size;
+
+        for (usize_t i = 0; i < 512; ++i)
+        {
+            ASSERT_EQ(block[i], (uchar_t)i);
+        }
+    }
+
+    alloc_delete(alloc_system(), block, size);
+}
+
+/**
+ * @test Test case for arena allocations.
+ *
+ * This test checks that arena allocations are aligned, that the most recent
+ * allocation is resized in place and that allocations larger than a chunk
+ * are served by a dedicated chunk.
+ */
+TEST(arena, alloc_and_resize_in_place)
+{
+    arena_t arena;
+    arena_init(&arena, nullptr, 256);
+
+    auto *first = (uchar_t *)arena_alloc(&arena, 3);
+    auto *second = (uchar_t *)arena_alloc(&arena, 5);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+
+    EXPECT_EQ((uptr_t)first % LIQUID_ALLOC_ALIGNMENT, 0u);
+    EXPECT_EQ((uptr_t)second % LIQUID_ALLOC_ALIGNMENT, 0u);
+    EXPECT_EQ(second - first, LIQUID_ALLOC_ALIGNMENT);
+
+    // The last allocation grows without moving.
+    EXPECT_EQ(alloc_resize(&arena.allocator, second, 5, 64), second);
+
+    // A block that does not fit into a chunk gets its own one.
+    auto *large = (uchar_t *)arena_alloc(&arena, 4096);
+    ASSERT_NE(large, nullptr);
+    large[4095] = 0xAB;
+
+    arena_reset(&arena);
+    EXPECT_EQ(arena_alloc(&arena, 16), large);
+
+    arena_free(&arena);
+    EXPECT_EQ(arena.chunk, nullptr);
+}
+
+/**
+ * @test Test case for pool allocations.
+ *
+ * This test verifies that released blocks are reused in LIFO order and that
+ * the pool allocates blocks from a new chunk once the current one is full.
+ */
+TEST(pool, release_reuses_blocks)
+{
+    pool_t pool;
+    pool_init(&pool, nullptr, 24, 4);
+
+    void *items[5];
+    for (auto &item : items)
+    {
+        item = pool_alloc(&pool);
+        ASSERT_NE(item, nullptr);
+    }
+
+    // The blocks of a chunk are handed out in address order.
+    EXPECT_EQ((uchar_t *)items[1] - (uchar_t *)items[0],
+              (ptrdiff_t)pool.item_size);
+
+    pool_release(&pool, items[2]);
+    pool_release(&pool, items[0]);
+    EXPECT_EQ(pool_alloc(&pool), items[0]);
+    EXPECT_EQ(pool_alloc(&pool), items[2]);
+
+    // Blocks larger than an item are forwarded to the parent allocator.
+    void *large = alloc_new(&pool.allocator, 1024);
+    ASSERT_NE(large, nullptr);
+    alloc_delete(&pool.allocator, large, 1024);
+
+    pool_free(&pool);
+}
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include <liquid/arena.h>
+#include <liquid/array.h>
+
+/**
+ * @test Test case for pushing and popping items.
+ *
+ * This test verifies that pushed items are stored in order, that the array
+ * grows geometrically and that popped items are returned in reverse order.
+ */
+TEST(array, push_and_pop)
+{
+    array_t array;
+    ARRAY_INIT(&array, int, nullptr);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        ASSERT_NE(array_push(&array, &i), nullptr);
+    }
+
+    EXPECT_EQ(array.size, 1000u);
+    EXPECT_GE(array.capacity, 1000u);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        ASSERT_EQ(ARRAY_AT(&array, int, i), i);
+    }
+
+    for (int i = 999; i >= 0; --i)
+    {
+        ASSERT_EQ(*(int *)array_pop(&array), i);
+    }
+    EXPECT_EQ(array_pop(&array), nullptr);
+
+    array_free(&array);
+}
+
+/**
+ * @test Test case for inserting and erasing items.
+ *
+ * This test checks that the items following the insertion or removal point
+ * are shifted correctly and that out of range positions are rejected.
+ */
+TEST(array, insert_and_erase)
+{
+    array_t array;
+    ARRAY_INIT(&array, int, nullptr);
+
+    const int head[] = {1, 2, 6};
+    const int middle[] = {3, 4, 5};
+
+    array_insert(&array, 0, head, 3);
+    array_insert(&array, 2, middle, 3);
+
+    for (int i = 0; i < 6; ++i)
+    {
+        EXPECT_EQ(ARRAY_AT(&array, int, i), i + 1);
+    }
+
+    auto *next = (int *)array_erase(&array, 1, 2);
+    ASSERT_NE(next, nullptr);
+    EXPECT_EQ(*next, 4);
+    EXPECT_EQ(array.size, 4u);
+    EXPECT_EQ(ARRAY_AT(&array, int, 0), 1);
+    EXPECT_EQ(ARRAY_AT(&array, int, 3), 6);
+
+    EXPECT_EQ(array_insert(&array, 5, middle, 1), nullptr);
+    EXPECT_EQ(array_erase(&array, 3, 2), nullptr);
+    EXPECT_EQ(array_at(&array, 4), nullptr);
+
+    array_free(&array);
+}
+
+/**
+ * @test Test case for inserting items of the array itself.
+ *
+ * This test inserts ranges of the array into it while it grows, before,
+ * after and around the insertion point, and checks the copies.
+ */
+TEST(array, insert_own_items)
+{
+    array_t array;
+    ARRAY_INIT(&array, int, nullptr);
+
+    const int items[] = {0, 1, 2, 3};
+    array_insert(&array, 0, items, 4);
+    array_shrink(&array);
+
+    // Around the position: 0 1 [1 2] 2 3.
+    ASSERT_NE(array_insert(&array, 2, &ARRAY_AT(&array, int, 1), 2), nullptr);
+    const int around[] = {0, 1, 1, 2, 2, 3};
+    ASSERT_EQ(array.size, 6u);
+    for (int i = 0; i < 6; ++i)
+    {
+        EXPECT_EQ(ARRAY_AT(&array, int, i), around[i]);
+    }
+
+    // After the position, and before it at the end.
+    array_shrink(&array);
+    array_insert(&array, 0, &ARRAY_AT(&array, int, 4), 2);
+    array_shrink(&array);
+    array_insert(&array, 8, &ARRAY_AT(&array, int, 0), 3);
+    const int ends[] = {2, 3, 0, 1, 1, 2, 2, 3, 2, 3, 0};
+    ASSERT_EQ(array.size, 11u);
+    for (int i = 0; i < 11; ++i)
+    {
+        EXPECT_EQ(ARRAY_AT(&array, int, i), ends[i]);
+    }
+
+    array_free(&array);
+}
+
+/**
+ * @test Test case for reserving and shrinking the storage.
+ *
+ * This test verifies that reserve allocates the exact capacity, that the
+ * configured growth factor is applied and that shrink trims the capacity
+ * down to the number of items.
+ */
+TEST(array, reserve_growth_and_shrink)
+{
+    array_t array;
+    ARRAY_INIT(&array, double, nullptr);
+    array_set_growth(&array, 200);
+
+    ASSERT_NE(array_reserve(&array, 10), nullptr);
+    EXPECT_EQ(array.capacity, 10u);
+
+    for (int i = 0; i < 11; ++i)
+    {
+        double value = i;
+        array_push(&array, &value);
+    }
+    EXPECT_EQ(array.capacity, 20u);
+
+    ASSERT_NE(array_shrink(&array), nullptr);
+    EXPECT_EQ(array.capacity, 11u);
+    EXPECT_EQ(ARRAY_AT(&array, double, 10), 10.0);
+
+    array_clear(&array);
+    EXPECT_EQ(array_shrink(&array), nullptr);
+    EXPECT_EQ(array.capacity, 0u);
+
+    array_free(&array);
+}
+
+/**
+ * @test Test case for an array backed by an arena.
+ *
+ * This test checks that an array that is the only user of an arena keeps
+ * growing in place, since the arena extends its most recent allocation.
+ */
+TEST(array, arena_allocator_grows_in_place)
+{
+    arena_t arena;
+    arena_init(&arena, nullptr, 64 * 1024);
+
+    array_t array;
+    ARRAY_INIT(&array, int, &arena.allocator);
+
+    array_push(&array, nullptr);
+    void *data = array.data;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        array_push(&array, &i);
+    }
+    EXPECT_EQ(array.data, data);
+
+    array_free(&array);
+    arena_free(&arena);
+}
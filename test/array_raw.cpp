@@ -162,4 +162,35 @@ TEST(array_raw_compare, empty_arrays)
 
     const void *result = array_raw_compare(arr1, arr1, arr2, arr2);
     EXPECT_EQ(result, nullptr);
-}
\ No newline at end of file
+}
+
+/**
+ * @test Test case for moving overlapping ranges.
+ *
+ * This test checks that array_raw_move produces the same result as memmove
+ * when the destination overlaps the source on either side.
+ */
+TEST(array_raw_move, overlapping_ranges)
+{
+    uchar_t forward[64];
+    uchar_t backward[64];
+    uchar_t expected[64];
+
+    for (int i = 0; i < 64; ++i)
+    {
+        forward[i] = backward[i] = expected[i] = (uchar_t)i;
+    }
+
+    EXPECT_EQ(array_raw_move(forward + 3, forward + 11, 40), forward + 43);
+    memmove(expected + 3, expected + 11, 40);
+    EXPECT_EQ(memcmp(forward, expected, 64), 0);
+
+    for (int i = 0; i < 64; ++i)
+    {
+        expected[i] = (uchar_t)i;
+    }
+
+    EXPECT_EQ(array_raw_move(backward + 11, backward + 3, 40), backward + 51);
+    memmove(expected + 11, expected + 3, 40);
+    EXPECT_EQ(memcmp(backward, expected, 64), 0);
+}
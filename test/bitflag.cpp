@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <liquid/bitflag.h>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Draws values with few, many and random set bits.
+ */
+static std::vector<ullong_t>
+sample_values()
+{
+    std::vector<ullong_t> values = {0, 1, 2, 3, 0x80000000u, 0xFFFFFFFFu,
+                                    0x100000000ull, 0x8000000000000000ull,
+                                    ~0ull};
+    std::mt19937_64       rng(11);
+    for (int i = 0; i < 1000; ++i)
+    {
+        ullong_t value = rng();
+        values.push_back(value >> (rng() % 64));
+    }
+    return values;
+}
+
+/**
+ * @test Test case for counting bits.
+ *
+ * This test compares the counting functions with bit by bit loops,
+ * including for zero, which yields the width of the word.
+ */
+TEST(bitflag, count)
+{
+    for (ullong_t value : sample_values())
+    {
+        uint_t low = (uint_t)value;
+        uint_t ctz = 0;
+        uint_t clz = 0;
+        uint_t popcount = 0;
+        while (ctz < 64 && !(value >> ctz & 1))
+        {
+            ++ctz;
+        }
+        while (clz < 64 && !(value << clz >> 63))
+        {
+            ++clz;
+        }
+        for (uint_t i = 0; i < 64; ++i)
+        {
+            popcount += (uint_t)(value >> i & 1);
+        }
+
+        EXPECT_EQ(bitflag_ctz64(value), ctz);
+        EXPECT_EQ(bitflag_clz64(value), clz);
+        EXPECT_EQ(bitflag_popcount64(value), popcount);
+        EXPECT_EQ(bitflag_ctz32(low), ctz < 32 ? ctz : 32);
+        EXPECT_EQ(bitflag_clz32(low), low ? bitflag_clz64(low) - 32 : 32);
+        EXPECT_EQ(bitflag_popcount32(low), bitflag_popcount64(low));
+    }
+}
+
+/**
+ * @test Test case for rotating and swapping bytes.
+ *
+ * This test checks rotations by every count, including zero and counts of
+ * the full width that the former macros left undefined.
+ */
+TEST(bitflag, rotate_and_swap)
+{
+    for (ullong_t value : sample_values())
+    {
+        uint_t low = (uint_t)value;
+        for (uint_t n = 0; n <= 64; ++n)
+        {
+            ullong_t left = value;
+            for (uint_t i = 0; i < n; ++i)
+            {
+                left = left << 1 | left >> 63;
+            }
+            EXPECT_EQ(bitflag_rotl64(value, n), left);
+            EXPECT_EQ(bitflag_rotr64(left, n), value);
+            EXPECT_EQ(BITFLAG_ROTATE_LEFT(value, n), left);
+            EXPECT_EQ(BITFLAG_ROTATE_RIGHT(left, n), value);
+            EXPECT_EQ(bitflag_rotr32(bitflag_rotl32(low, n), n), low);
+        }
+        EXPECT_EQ(bitflag_rotl32(low, 8), low << 8 | low >> 24);
+
+        ullong_t swapped = 0;
+        for (uint_t i = 0; i < 8; ++i)
+        {
+            swapped |= (value >> (i * 8) & 0xFF) << (56 - i * 8);
+        }
+        EXPECT_EQ(bitflag_bswap64(value), swapped);
+        EXPECT_EQ(bitflag_bswap32((uint_t)(value >> 32)), (uint_t)swapped);
+    }
+    EXPECT_EQ(bitflag_bswap16(0x1234), 0x3412);
+    EXPECT_EQ(bitflag_bswap32(0x12345678u), 0x78563412u);
+}
+
+/**
+ * @test Test case for depositing and extracting bits.
+ *
+ * This test compares both operations with loops over the mask and checks
+ * that extracting the deposited bits restores them.
+ */
+TEST(bitflag, deposit_and_extract)
+{
+    std::vector<ullong_t> values = sample_values();
+    for (size_t i = 0; i + 1 < values.size(); ++i)
+    {
+        ullong_t value = values[i];
+        ullong_t mask = values[i + 1];
+        ullong_t deposited = 0;
+        ullong_t extracted = 0;
+        for (uint_t bit = 0, k = 0; bit < 64; ++bit)
+        {
+            if (mask >> bit & 1)
+            {
+                deposited |= (value >> k & 1) << bit;
+                extracted |= (value >> bit & 1) << k;
+                ++k;
+            }
+        }
+        EXPECT_EQ(bitflag_pdep64(value, mask), deposited);
+        EXPECT_EQ(bitflag_pext64(value, mask), extracted);
+        EXPECT_EQ(bitflag_pext64(deposited, mask), bitflag_pext64(~0ull, mask)
+                                                       & value);
+    }
+}
+
+/**
+ * @test Test case for rounding up to powers of two.
+ */
+TEST(bitflag, next_pow2)
+{
+    EXPECT_EQ(bitflag_next_pow2_32(0), 1u);
+    EXPECT_EQ(bitflag_next_pow2_32(1), 1u);
+    EXPECT_EQ(bitflag_next_pow2_32(2), 2u);
+    EXPECT_EQ(bitflag_next_pow2_32(3), 4u);
+    EXPECT_EQ(bitflag_next_pow2_32(1000), 1024u);
+    EXPECT_EQ(bitflag_next_pow2_32(0x80000000u), 0x80000000u);
+    EXPECT_EQ(bitflag_next_pow2_32(0x80000001u), 0u);
+    EXPECT_EQ(bitflag_next_pow2_64(0x100000001ull), 0x200000000ull);
+    EXPECT_EQ(bitflag_next_pow2_64(0x8000000000000000ull),
+              0x8000000000000000ull);
+    EXPECT_EQ(bitflag_next_pow2_64(~0ull), 0u);
+}
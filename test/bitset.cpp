@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <liquid/bitset.h>
+#include <random>
+#include <set>
+#include <vector>
+
+/**
+ * @brief Fills a bitset and a reference with random bits.
+ */
+static void
+fill_random(bitset_t *bitset, std::vector<bool> &reference,
+            std::mt19937_64 &rng, uint_t density)
+{
+    for (usize_t i = 0; i < bitset->size; ++i)
+    {
+        bool bit = rng() % 100 < density;
+        reference[i] = bit;
+        if (bit)
+        {
+            bitset_set(bitset, i);
+        }
+        else
+        {
+            bitset_unset(bitset, i);
+        }
+    }
+}
+
+/**
+ * @test Test case for setting, testing and counting bits.
+ *
+ * This test compares a bitset of odd sizes with a vector of booleans and
+ * checks that resizing keeps the bits past the size clear.
+ */
+TEST(bitset, set_test_count)
+{
+    std::mt19937_64 rng(3);
+    for (usize_t size : {0u, 1u, 63u, 64u, 65u, 1000u, 4099u})
+    {
+        bitset_t bitset;
+        bitset_init(&bitset, nullptr);
+        ASSERT_TRUE(bitset_resize(&bitset, size));
+
+        std::vector<bool> reference(size);
+        fill_random(&bitset, reference, rng, 30);
+        for (usize_t i = 0; i < size; ++i)
+        {
+            EXPECT_EQ(bitset_test(&bitset, i), reference[i]);
+        }
+        EXPECT_EQ(bitset_count(&bitset),
+                  (usize_t)std::count(reference.begin(), reference.end(),
+                                      true));
+
+        bitset_set_all(&bitset);
+        EXPECT_EQ(bitset_count(&bitset), size);
+
+        ASSERT_TRUE(bitset_resize(&bitset, size / 2));
+        ASSERT_TRUE(bitset_resize(&bitset, size + 100));
+        EXPECT_EQ(bitset_count(&bitset), size / 2);
+
+        bitset_clear(&bitset);
+        EXPECT_EQ(bitset_count(&bitset), 0u);
+        bitset_free(&bitset);
+    }
+}
+
+/**
+ * @test Test case for finding set bits.
+ *
+ * This test iterates over the set bits in both directions and compares the
+ * visited indices with the reference.
+ */
+TEST(bitset, next_and_prev)
+{
+    std::mt19937_64 rng(5);
+    for (uint_t density : {0u, 1u, 50u, 100u})
+    {
+        bitset_t bitset;
+        bitset_init(&bitset, nullptr);
+        ASSERT_TRUE(bitset_resize(&bitset, 1000));
+
+        std::vector<bool> reference(1000);
+        fill_random(&bitset, reference, rng, density);
+
+        std::vector<usize_t> expected;
+        for (usize_t i = 0; i < reference.size(); ++i)
+        {
+            if (reference[i])
+            {
+                expected.push_back(i);
+            }
+        }
+
+        std::vector<usize_t> forward;
+        for (usize_t i = bitset_next(&bitset, 0); i != BITSET_NONE;
+             i = bitset_next(&bitset, i + 1))
+        {
+            forward.push_back(i);
+        }
+        EXPECT_EQ(forward, expected);
+
+        std::vector<usize_t> backward;
+        for (usize_t i = bitset_prev(&bitset, BITSET_NONE); i != BITSET_NONE;
+             i = i ? bitset_prev(&bitset, i - 1) : BITSET_NONE)
+        {
+            backward.push_back(i);
+        }
+        std::reverse(backward.begin(), backward.end());
+        EXPECT_EQ(backward, expected);
+
+        bitset_free(&bitset);
+    }
+}
+
+/**
+ * @test Test case for combining bitsets.
+ *
+ * This test applies every operation to bitsets whose sizes are not a
+ * multiple of the vector width and compares the results with the reference.
+ */
+TEST(bitset, combine)
+{
+    std::mt19937_64 rng(7);
+    for (usize_t size : {5u, 200u, 333u, 4096u, 10007u})
+    {
+        for (int op = 0; op < 4; ++op)
+        {
+            bitset_t a;
+            bitset_t b;
+            bitset_init(&a, nullptr);
+            bitset_init(&b, nullptr);
+            ASSERT_TRUE(bitset_resize(&a, size));
+            ASSERT_TRUE(bitset_resize(&b, size));
+
+            std::vector<bool> ra(size);
+            std::vector<bool> rb(size);
+            fill_random(&a, ra, rng, 50);
+            fill_random(&b, rb, rng, 50);
+
+            switch (op)
+            {
+            case 0:
+                bitset_and(&a, &b);
+                break;
+            case 1:
+                bitset_or(&a, &b);
+                break;
+            case 2:
+                bitset_xor(&a, &b);
+                break;
+            default:
+                bitset_andnot(&a, &b);
+                break;
+            }
+
+            for (usize_t i = 0; i < size; ++i)
+            {
+                bool expected = op == 0   ? ra[i] && rb[i]
+                                : op == 1 ? ra[i] || rb[i]
+                                : op == 2 ? ra[i] != rb[i]
+                                          : ra[i] && !rb[i];
+                ASSERT_EQ(bitset_test(&a, i), expected) << op << " " << i;
+            }
+
+            bitset_free(&a);
+            bitset_free(&b);
+        }
+    }
+}
+
+/**
+ * @brief Draws values that fill some containers densely and others sparsely.
+ */
+static uint_t
+random_value(std::mt19937_64 &rng)
+{
+    uint_t key = (uint_t)(rng() % 6);
+    uint_t spread = key < 2 ? 8000 : 65536;
+    return key << 16 | (uint_t)(rng() % spread);
+}
+
+/**
+ * @brief Verifies that a roaring bitmap holds exactly the reference values.
+ */
+static void
+expect_values(const roaring_t *roaring, const std::set<uint_t> &reference)
+{
+    ASSERT_EQ(roaring_count(roaring), reference.size());
+
+    std::vector<uint_t> values(reference.size());
+    EXPECT_EQ(roaring_to_array(roaring, values.data()), reference.size());
+    EXPECT_TRUE(std::equal(values.begin(), values.end(), reference.begin()));
+
+    auto it = reference.begin();
+    for (ullong_t value = roaring_next(roaring, 0); value != ROARING_END;
+         value = roaring_next(roaring, value + 1), ++it)
+    {
+        ASSERT_NE(it, reference.end());
+        EXPECT_EQ(value, *it);
+    }
+    EXPECT_EQ(it, reference.end());
+}
+
+/**
+ * @test Test case for adding and removing values of a roaring bitmap.
+ *
+ * This test runs random operations that convert containers between arrays
+ * and bitmaps in both directions and compares the bitmap with a set.
+ */
+TEST(roaring, add_remove_contains)
+{
+    roaring_t roaring;
+    roaring_init(&roaring, nullptr);
+    std::set<uint_t> reference;
+    std::mt19937_64  rng(13);
+
+    for (int round = 0; round < 4; ++round)
+    {
+        // Alternate between growing and shrinking phases.
+        uint_t add_percent = round % 2 ? 30 : 80;
+        for (int i = 0; i < 60000; ++i)
+        {
+            uint_t value = random_value(rng);
+            if (rng() % 100 < add_percent)
+            {
+                ASSERT_TRUE(roaring_add(&roaring, value));
+                reference.insert(value);
+            }
+            else
+            {
+                EXPECT_EQ(roaring_remove(&roaring, value),
+                          reference.erase(value) == 1);
+            }
+        }
+        expect_values(&roaring, reference);
+    }
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        uint_t value = random_value(rng);
+        EXPECT_EQ(roaring_contains(&roaring, value), reference.count(value));
+    }
+
+    EXPECT_TRUE(roaring_add(&roaring, LIQUID_UINT_MAX));
+    EXPECT_TRUE(roaring_contains(&roaring, LIQUID_UINT_MAX));
+    EXPECT_EQ(roaring_next(&roaring, LIQUID_UINT_MAX), LIQUID_UINT_MAX);
+    EXPECT_EQ(roaring_next(&roaring, ROARING_END), ROARING_END);
+
+    roaring_free(&roaring);
+}
+
+/**
+ * @test Test case for combining roaring bitmaps.
+ *
+ * This test intersects, unites and subtracts bitmaps mixing array and bitmap
+ * containers and compares the results with sets.
+ */
+TEST(roaring, combine)
+{
+    std::mt19937_64 rng(17);
+    for (int op = 0; op < 3; ++op)
+    {
+        roaring_t        a;
+        roaring_t        b;
+        std::set<uint_t> ra;
+        std::set<uint_t> rb;
+        roaring_init(&a, nullptr);
+        roaring_init(&b, nullptr);
+
+        for (int i = 0; i < 30000; ++i)
+        {
+            uint_t value = random_value(rng);
+            ASSERT_TRUE(roaring_add(&a, value));
+            ra.insert(value);
+            value = random_value(rng) + (1u << 16);
+            ASSERT_TRUE(roaring_add(&b, value));
+            rb.insert(value);
+        }
+
+        std::set<uint_t> expected;
+        switch (op)
+        {
+        case 0:
+            roaring_and(&a, &b);
+            std::set_intersection(ra.begin(), ra.end(), rb.begin(), rb.end(),
+                                  std::inserter(expected, expected.end()));
+            break;
+        case 1:
+            ASSERT_TRUE(roaring_or(&a, &b));
+            std::set_union(ra.begin(), ra.end(), rb.begin(), rb.end(),
+                           std::inserter(expected, expected.end()));
+            break;
+        default:
+            roaring_andnot(&a, &b);
+            std::set_difference(ra.begin(), ra.end(), rb.begin(), rb.end(),
+                                std::inserter(expected, expected.end()));
+            break;
+        }
+        expect_values(&a, expected);
+
+        roaring_free(&a);
+        roaring_free(&b);
+    }
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <liquid/checked.h>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Draws operands close to zero, to the limits and in between.
+ */
+static std::vector<ullong_t>
+sample_operands()
+{
+    std::vector<ullong_t> values = {0, 1, 2, 3, 0x7FFFFFFFu, 0x80000000u,
+                                    0xFFFFFFFFu, 0x100000000ull,
+                                    0x7FFFFFFFFFFFFFFFull,
+                                    0x8000000000000000ull, ~0ull, ~1ull};
+    std::mt19937_64       rng(19);
+    for (int i = 0; i < 200; ++i)
+    {
+        values.push_back(rng() >> (rng() % 64));
+    }
+    return values;
+}
+
+/**
+ * @test Test case for checked unsigned arithmetic.
+ *
+ * This test compares the results and overflow flags with 128-bit
+ * arithmetic.
+ */
+TEST(checked, unsigned_ops)
+{
+    std::vector<ullong_t> values = sample_operands();
+    for (ullong_t a : values)
+    {
+        for (ullong_t b : values)
+        {
+            unsigned __int128 sum = (unsigned __int128)a + b;
+            unsigned __int128 product = (unsigned __int128)a * b;
+            ullong_t          result;
+
+            EXPECT_EQ(checked_add_ullong(a, b, &result), sum >> 64 == 0);
+            EXPECT_EQ(result, (ullong_t)sum);
+            EXPECT_EQ(checked_sub_ullong(a, b, &result), a >= b);
+            EXPECT_EQ(result, a - b);
+            EXPECT_EQ(checked_mul_ullong(a, b, &result), product >> 64 == 0);
+            EXPECT_EQ(result, (ullong_t)product);
+
+            uint_t x = (uint_t)a;
+            uint_t y = (uint_t)b;
+            uint_t small;
+            EXPECT_EQ(checked_add_uint(x, y, &small),
+                      (ullong_t)x + y <= LIQUID_UINT_MAX);
+            EXPECT_EQ(small, x + y);
+            EXPECT_EQ(checked_mul_uint(x, y, &small),
+                      (ullong_t)x * y <= LIQUID_UINT_MAX);
+            EXPECT_EQ(small, x * y);
+
+            EXPECT_EQ(saturating_add_ullong(a, b),
+                      sum >> 64 ? LIQUID_ULLONG_MAX : (ullong_t)sum);
+            EXPECT_EQ(saturating_sub_ullong(a, b), a > b ? a - b : 0);
+            EXPECT_EQ(saturating_mul_ullong(a, b),
+                      product >> 64 ? LIQUID_ULLONG_MAX : (ullong_t)product);
+        }
+    }
+}
+
+/**
+ * @test Test case for checked signed arithmetic.
+ *
+ * This test compares the results and overflow flags with 128-bit
+ * arithmetic, including the products of the minimum value and minus one.
+ */
+TEST(checked, signed_ops)
+{
+    std::vector<ullong_t> values = sample_operands();
+    for (ullong_t ua : values)
+    {
+        for (ullong_t ub : values)
+        {
+            for (int sign = 0; sign < 4; ++sign)
+            {
+                sllong_t a = (sllong_t)(sign & 1 ? 0 - ua : ua);
+                sllong_t b = (sllong_t)(sign & 2 ? 0 - ub : ub);
+                __int128 sum = (__int128)a + b;
+                __int128 diff = (__int128)a - b;
+                __int128 product = (__int128)a * b;
+                sllong_t result;
+
+                EXPECT_EQ(checked_add_sllong(a, b, &result),
+                          sum == (sllong_t)sum);
+                EXPECT_EQ(result, (sllong_t)sum);
+                EXPECT_EQ(checked_sub_sllong(a, b, &result),
+                          diff == (sllong_t)diff);
+                EXPECT_EQ(result, (sllong_t)diff);
+                EXPECT_EQ(checked_mul_sllong(a, b, &result),
+                          product == (sllong_t)product);
+                EXPECT_EQ(result, (sllong_t)product);
+
+                sint_t   x = (sint_t)a;
+                sint_t   y = (sint_t)b;
+                sllong_t wide = (sllong_t)x * y;
+                sint_t   small;
+                EXPECT_EQ(checked_mul_sint(x, y, &small), wide == (sint_t)wide);
+                EXPECT_EQ(small, (sint_t)wide);
+                EXPECT_EQ(checked_sub_sint(x, y, &small),
+                          (sllong_t)x - y == (sint_t)((sllong_t)x - y));
+            }
+        }
+    }
+}
+
+/**
+ * @test Test case for computing allocation sizes.
+ */
+TEST(checked, mul_add_usize)
+{
+    usize_t size;
+    EXPECT_TRUE(checked_mul_add_usize(10, 24, 16, &size));
+    EXPECT_EQ(size, 256u);
+    EXPECT_TRUE(checked_mul_add_usize(0, LIQUID_USIZE_MAX, 7, &size));
+    EXPECT_EQ(size, 7u);
+    EXPECT_FALSE(checked_mul_add_usize(LIQUID_USIZE_MAX / 8 + 1, 8, 0, &size));
+    EXPECT_FALSE(checked_mul_add_usize(LIQUID_USIZE_MAX / 8, 8, 8, &size));
+    EXPECT_TRUE(checked_mul_add_usize(LIQUID_USIZE_MAX / 8, 8, 7, &size));
+    EXPECT_EQ(size, LIQUID_USIZE_MAX);
+
+    EXPECT_EQ(saturating_mul_usize(LIQUID_USIZE_MAX / 2, 3), LIQUID_USIZE_MAX);
+    EXPECT_EQ(saturating_add_usize(LIQUID_USIZE_MAX, 1), LIQUID_USIZE_MAX);
+    EXPECT_EQ(saturating_sub_usize(1, 2), 0u);
+    EXPECT_EQ(saturating_sub_uint(5, 2), 3u);
+    EXPECT_EQ(saturating_mul_uint(0x10000, 0x10000), LIQUID_UINT_MAX);
+}
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <liquid/codec.h>
+#include <random>
+#include <vector>
+
+/**
+ * @test Test case for packing blocks of every bit width.
+ *
+ * This test packs random values of each width from 0 to 32, checks the
+ * size of the output and that unpacking restores the values.
+ */
+TEST(codec, pack_unpack)
+{
+    std::mt19937_64 rng(31);
+    for (uint_t bits = 0; bits <= 32; ++bits)
+    {
+        uint_t              mask = bits < 32 ? (1u << bits) - 1 : ~0u;
+        std::vector<uint_t> values(CODEC_BLOCK_SIZE);
+        for (uint_t &value : values)
+        {
+            value = (uint_t)rng() & mask;
+        }
+        values[7] = mask;
+
+        EXPECT_EQ(codec_bits128(values.data()), bits);
+
+        // The guard word past the output must stay untouched.
+        std::vector<uint_t> packed(4 * bits + 1, 0xDEADBEEF);
+        EXPECT_EQ(codec_pack128(packed.data(), values.data(), bits),
+                  packed.data() + 4 * bits);
+        EXPECT_EQ(packed.back(), 0xDEADBEEF);
+
+        std::vector<uint_t> unpacked(CODEC_BLOCK_SIZE);
+        EXPECT_EQ(codec_unpack128(unpacked.data(), packed.data(), bits),
+                  packed.data() + 4 * bits);
+        EXPECT_EQ(unpacked, values) << bits;
+    }
+}
+
+/**
+ * @test Test case for frame-of-reference blocks.
+ *
+ * This test encodes sorted ids after delta coding them, separately and
+ * fused, including a partial last block, and checks that damaged input is
+ * rejected.
+ */
+TEST(codec, frame_of_reference)
+{
+    std::mt19937_64 rng(37);
+    for (usize_t count : {0u, 1u, 127u, 128u, 1000u, 4096u})
+    {
+        std::vector<uint_t> ids(count);
+        uint_t              id = 1000000;
+        for (uint_t &value : ids)
+        {
+            id += 1 + (uint_t)(rng() % 50);
+            value = id;
+        }
+
+        std::vector<uint_t> deltas(count);
+        codec_delta_encode(deltas.data(), ids.data(), count, 1000000);
+
+        std::vector<uint_t> encoded(codec_for_bound(count));
+        uint_t *end = codec_for_encode(encoded.data(), deltas.data(), count);
+        ASSERT_LE(end, encoded.data() + encoded.size());
+        if (count >= 1000)
+        {
+            // Deltas below 64 need at most six bits each.
+            EXPECT_LT((usize_t)(end - encoded.data()), count / 4);
+        }
+
+        std::vector<uint_t> decoded(count);
+        EXPECT_EQ(codec_for_decode(decoded.data(), encoded.data(), end, count),
+                  end);
+        codec_delta_decode(decoded.data(), decoded.data(), count, 1000000);
+        EXPECT_EQ(decoded, ids);
+
+        // The fused codec produces the same blocks.
+        std::vector<uint_t> fused(encoded.size());
+        EXPECT_EQ(codec_for_delta_encode(fused.data(), ids.data(), count,
+                                         1000000),
+                  fused.data() + (end - encoded.data()));
+        EXPECT_TRUE(std::equal(encoded.data(), end, fused.data()));
+        std::fill(decoded.begin(), decoded.end(), 0);
+        EXPECT_EQ(codec_for_delta_decode(decoded.data(), encoded.data(), end,
+                                         count, 1000000),
+                  end);
+        EXPECT_EQ(decoded, ids);
+
+        if (count)
+        {
+            EXPECT_EQ(codec_for_decode(decoded.data(), encoded.data(), end - 1,
+                                       count),
+                      nullptr);
+            encoded[1] = 33;
+            EXPECT_EQ(codec_for_decode(decoded.data(), encoded.data(), end,
+                                       count),
+                      nullptr);
+        }
+    }
+}
+
+/**
+ * @test Test case for delta and delta-of-delta coding.
+ *
+ * This test decodes deltas in place, encodes timestamps at a fixed interval
+ * with jitter and checks that changes beyond 32 bits are reported.
+ */
+TEST(codec, delta)
+{
+    std::vector<uint_t> values = {5, 3, 10, 10, 0xFFFFFFFF, 2, 7, 8, 9};
+    std::vector<uint_t> deltas(values.size());
+    codec_delta_encode(deltas.data(), values.data(), values.size(), 1);
+    EXPECT_EQ(deltas[0], 4u);
+    EXPECT_EQ(deltas[1], (uint_t)-2);
+    codec_delta_decode(deltas.data(), deltas.data(), deltas.size(), 1);
+    EXPECT_EQ(deltas, values);
+
+    std::vector<ullong_t> stamps(1000);
+    std::mt19937_64       rng(41);
+    ullong_t              start = 1700000000000000000ull;
+    for (usize_t i = 0; i < stamps.size(); ++i)
+    {
+        stamps[i] = start + i * 1000000000ull + (i % 10 ? 0 : rng() % 1000);
+    }
+
+    std::vector<uint_t> encoded(stamps.size());
+    ASSERT_TRUE(codec_delta2_encode64(encoded.data(), stamps.data(),
+                                      stamps.size(), start));
+    // Jitter of a timestamp changes the three differences around it.
+    EXPECT_EQ(encoded[5], 0u);
+    EXPECT_LE(codec_bits128(encoded.data() + 128), 12u);
+
+    std::vector<ullong_t> decoded(stamps.size());
+    codec_delta2_decode64(decoded.data(), encoded.data(), stamps.size(), start);
+    EXPECT_EQ(decoded, stamps);
+
+    stamps[500] += 1ull << 40;
+    EXPECT_FALSE(codec_delta2_encode64(encoded.data(), stamps.data(),
+                                       stamps.size(), start));
+}
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include <liquid/event.h>
+#include <thread>
+#include <vector>
+
+#if !defined(LIQUID_TARGET_OS_WINDOWS)
+    #include <unistd.h>
+#endif
+
+/**
+ * @brief The state shared with the callbacks of a test.
+ */
+struct record
+{
+    std::vector<int>    order;     ///< The data of the timers in order.
+    std::vector<uint_t> events;    ///< The events dispatched to sources.
+    int                 wakes = 0; ///< The number of wake callbacks.
+};
+
+/**
+ * @brief Records the expiry of a timer.
+ * @param loop The loop.
+ * @param timer The timer, its data points to its number.
+ */
+static void
+on_timer(event_loop_t *loop, event_timer_t *timer)
+{
+    static_cast<record *>(loop->data)->order.push_back(
+        *static_cast<int *>(timer->data));
+}
+
+/**
+ * @test Test case for timers.
+ *
+ * This test starts, restarts and stops timers, one of them on the second
+ * level of the wheel, and checks that they expire in order and not early.
+ */
+TEST(event, timers)
+{
+    event_loop_t loop;
+    record       rec;
+    ASSERT_TRUE(event_loop_init(&loop, nullptr));
+    loop.data = &rec;
+
+    int           ids[] = {0, 1, 2, 3, 4};
+    event_timer_t timers[5];
+    for (int i = 0; i < 5; ++i)
+    {
+        event_timer_init(&timers[i], on_timer, &ids[i]);
+    }
+    // The delays count from the time of the current run of the loop.
+    ullong_t start = loop.now;
+    event_timer_start(&loop, &timers[0], 30);
+    event_timer_start(&loop, &timers[1], 10);
+    event_timer_start(&loop, &timers[2], 50);
+    event_timer_start(&loop, &timers[3], 20);
+    event_timer_start(&loop, &timers[4], WHEEL_SLOTS * 2 + 30);
+    event_timer_start(&loop, &timers[2], 40);
+    event_timer_stop(&loop, &timers[3]);
+    EXPECT_TRUE(event_timer_active(&timers[0]));
+    EXPECT_FALSE(event_timer_active(&timers[3]));
+
+    while (rec.order.size() < 3)
+    {
+        ASSERT_TRUE(event_loop_run_once(&loop, EVENT_INFINITE));
+    }
+    EXPECT_GE(event_now() - start, 40u);
+    EXPECT_EQ(rec.order, std::vector<int>({1, 0, 2}));
+
+    while (rec.order.size() < 4)
+    {
+        ASSERT_TRUE(event_loop_run_once(&loop, EVENT_INFINITE));
+    }
+    EXPECT_GE(event_now() - start, WHEEL_SLOTS * 2 + 30u);
+    EXPECT_EQ(rec.order.back(), 4);
+    EXPECT_FALSE(event_timer_active(&timers[4]));
+    event_loop_free(&loop);
+}
+
+/**
+ * @brief Counts a wake-up and stops the loop.
+ * @param loop The loop.
+ */
+static void
+on_wake(event_loop_t *loop)
+{
+    ++static_cast<record *>(loop->data)->wakes;
+    event_loop_stop(loop);
+}
+
+/**
+ * @test Test case for wake-ups.
+ *
+ * This test wakes a loop waiting without timers from other threads and
+ * checks that the wake callback runs on the loop.
+ */
+TEST(event, wake)
+{
+    event_loop_t loop;
+    record       rec;
+    ASSERT_TRUE(event_loop_init(&loop, on_wake));
+    loop.data = &rec;
+
+    for (int round = 0; round < 3; ++round)
+    {
+        std::thread waker(
+            [&]
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                for (int i = 0; i < 100; ++i)
+                {
+                    EXPECT_TRUE(event_loop_wake(&loop));
+                }
+            });
+        EXPECT_TRUE(event_loop_run(&loop));
+        waker.join();
+        EXPECT_GE(rec.wakes, round + 1);
+    }
+
+    // A pending wake-up makes the next run return at once.
+    int wakes = rec.wakes;
+    EXPECT_TRUE(event_loop_wake(&loop));
+    EXPECT_TRUE(event_loop_run_once(&loop, EVENT_INFINITE));
+    EXPECT_EQ(rec.wakes, wakes + 1);
+    event_loop_free(&loop);
+}
+
+#if !defined(LIQUID_TARGET_OS_WINDOWS)
+
+/**
+ * @brief Records the events of a source and removes the source in its data.
+ * @param loop The loop.
+ * @param source The source.
+ * @param event The events.
+ */
+static void
+on_ready(event_loop_t *loop, event_source_t *source, const event_t *event)
+{
+    static_cast<record *>(loop->data)->events.push_back(event->events);
+    if (source->data)
+    {
+        EXPECT_TRUE(event_loop_remove(
+            loop, static_cast<event_source_t *>(source->data)));
+    }
+}
+
+/**
+ * @test Test case for readiness events.
+ *
+ * This test watches pipes and checks that readiness is reported once per
+ * change, that a closed writer is reported as a hang-up, and that a source
+ * removed by another callback of the same batch is not dispatched.
+ */
+TEST(event, readiness)
+{
+    event_loop_t loop;
+    record       rec;
+    ASSERT_TRUE(event_loop_init(&loop, nullptr));
+    loop.data = &rec;
+
+    int pipes[2][2];
+    ASSERT_EQ(pipe(pipes[0]), 0);
+    ASSERT_EQ(pipe(pipes[1]), 0);
+
+    event_source_t first = {on_ready, nullptr, pipes[0][0], EVENT_READ};
+    ASSERT_TRUE(event_loop_add(&loop, &first));
+    EXPECT_TRUE(event_loop_run_once(&loop, 0));
+    EXPECT_TRUE(rec.events.empty());
+
+    ASSERT_EQ(write(pipes[0][1], "a", 1), 1);
+    EXPECT_TRUE(event_loop_run_once(&loop, 1000));
+    EXPECT_EQ(rec.events, std::vector<uint_t>({EVENT_READ}));
+
+    // Unread data is not reported again until more arrives.
+    EXPECT_TRUE(event_loop_run_once(&loop, 0));
+    EXPECT_EQ(rec.events.size(), 1u);
+    ASSERT_EQ(write(pipes[0][1], "b", 1), 1);
+    EXPECT_TRUE(event_loop_run_once(&loop, 1000));
+    EXPECT_EQ(rec.events.size(), 2u);
+
+    close(pipes[0][1]);
+    EXPECT_TRUE(event_loop_run_once(&loop, 1000));
+    ASSERT_EQ(rec.events.size(), 3u);
+    EXPECT_EQ(rec.events[2], (uint_t)(EVENT_READ | EVENT_HANGUP));
+    EXPECT_TRUE(event_loop_remove(&loop, &first));
+
+    // Whichever of two ready sources comes first removes the other.
+    event_source_t second = {on_ready, nullptr, pipes[1][0], EVENT_READ};
+    event_source_t third = {on_ready, &second, pipes[1][1], EVENT_WRITE};
+    second.data = &third;
+    ASSERT_TRUE(event_loop_add(&loop, &second));
+    ASSERT_TRUE(event_loop_add(&loop, &third));
+    ASSERT_EQ(write(pipes[1][1], "c", 1), 1);
+    rec.events.clear();
+    EXPECT_TRUE(event_loop_run_once(&loop, 1000));
+    EXPECT_EQ(rec.events.size(), 1u);
+
+    close(pipes[0][0]);
+    close(pipes[1][0]);
+    close(pipes[1][1]);
+    event_loop_free(&loop);
+}
+
+#endif // !LIQUID_TARGET_OS_WINDOWS
@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <liquid/fs.h>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Generates compressible test content.
+ * @param size The size of the content.
+ * @return The content.
+ */
+static std::vector<uchar_t>
+make_text(usize_t size)
+{
+    static const char *const words[] = {"stream", "file", "block", "frame",
+                                        " ",      "\n",   "=",     "0x"};
+
+    std::mt19937         rng(29);
+    std::vector<uchar_t> text;
+    while (text.size() < size)
+    {
+        for (const char *word = words[rng() % 8]; *word; ++word)
+        {
+            text.push_back((uchar_t)*word);
+        }
+    }
+    text.resize(size);
+    return text;
+}
+
+/**
+ * @brief Writes content through a stream in pieces of varying sizes.
+ *
+ * @param path The path of the file.
+ * @param flags The extra flags of the stream.
+ * @param content The content.
+ */
+static void
+write_stream(const std::string &path, uint_t flags,
+             const std::vector<uchar_t> &content)
+{
+    fs_stream_t stream;
+    ASSERT_TRUE(fs_stream_open(&stream, path.c_str(),
+                               FS_WRITE | FS_CREATE | FS_TRUNCATE | flags,
+                               nullptr));
+
+    std::mt19937 rng(41);
+    usize_t      offset = 0;
+    while (offset < content.size())
+    {
+        usize_t count = std::min<usize_t>(content.size() - offset,
+                                          1 + rng() % 100000);
+        ASSERT_TRUE(fs_stream_write(&stream, content.data() + offset, count));
+        offset += count;
+    }
+    EXPECT_TRUE(fs_stream_close(&stream));
+}
+
+/**
+ * @brief Reads a whole file through a stream in pieces of varying sizes.
+ *
+ * @param path The path of the file.
+ * @param flags The extra flags of the stream.
+ * @param content Receives the content.
+ * @return True if reading succeeded.
+ */
+static bool
+read_stream(const std::string &path, uint_t flags,
+            std::vector<uchar_t> &content)
+{
+    fs_stream_t stream;
+    if (!fs_stream_open(&stream, path.c_str(), FS_READ | flags, nullptr))
+    {
+        return false;
+    }
+
+    std::mt19937 rng(43);
+    bool         ok = true;
+    content.clear();
+    for (;;)
+    {
+        usize_t size = 1 + rng() % 150000;
+        usize_t offset = content.size();
+        usize_t count = 0;
+        content.resize(offset + size);
+        ok = fs_stream_read(&stream, content.data() + offset, size, &count);
+        content.resize(offset + count);
+        if (!ok || count < size)
+        {
+            break;
+        }
+    }
+    fs_stream_close(&stream);
+    return ok;
+}
+
+/**
+ * @brief Reads the raw bytes of a file.
+ * @param path The path of the file.
+ * @return The bytes.
+ */
+static std::vector<uchar_t>
+read_file(const std::string &path)
+{
+    fs_handle_t handle;
+    EXPECT_TRUE(fs_open(&handle, path.c_str(), FS_READ));
+
+    std::vector<uchar_t> bytes;
+    uchar_t              buffer[4096];
+    usize_t              count;
+    while (fs_read(handle, buffer, sizeof(buffer), &count) && count)
+    {
+        bytes.insert(bytes.end(), buffer, buffer + count);
+    }
+    fs_close(handle);
+    return bytes;
+}
+
+/**
+ * @test Test case for files.
+ *
+ * This test writes, appends to and reads back a file, and checks that
+ * opening a missing file fails.
+ */
+TEST(fs, file)
+{
+    std::string path = testing::TempDir() + "liquid_fs_file";
+    fs_handle_t handle;
+    ASSERT_TRUE(fs_open(&handle, path.c_str(),
+                        FS_WRITE | FS_CREATE | FS_TRUNCATE));
+    EXPECT_TRUE(fs_write(handle, "hello", 5));
+    fs_close(handle);
+
+    ASSERT_TRUE(fs_open(&handle, path.c_str(), FS_WRITE | FS_APPEND));
+    EXPECT_TRUE(fs_write(handle, ", world", 7));
+    fs_close(handle);
+
+    std::vector<uchar_t> bytes = read_file(path);
+    EXPECT_EQ(std::string(bytes.begin(), bytes.end()), "hello, world");
+
+    std::string missing = testing::TempDir() + "liquid_fs_missing/file";
+    EXPECT_FALSE(fs_open(&handle, missing.c_str(), FS_READ));
+    remove(path.c_str());
+}
+
+/**
+ * @test Test case for buffered streams.
+ *
+ * This test writes content smaller and larger than the buffer through a
+ * stream and reads it back, both with pieces smaller and larger than the
+ * buffer.
+ */
+TEST(fs, stream)
+{
+    std::string path = testing::TempDir() + "liquid_fs_stream";
+    for (usize_t size : {0u, 10u, 65536u, 1000000u})
+    {
+        std::vector<uchar_t> content = make_text(size);
+        write_stream(path, 0, content);
+        EXPECT_EQ(read_file(path), content) << size;
+
+        std::vector<uchar_t> back;
+        EXPECT_TRUE(read_stream(path, 0, back));
+        EXPECT_EQ(back, content) << size;
+    }
+    remove(path.c_str());
+}
+
+/**
+ * @test Test case for compressed streams.
+ *
+ * This test writes content through a compressed stream, checks that the
+ * file is a valid LZ4 frame smaller than the content and reads it back,
+ * also after a second frame has been appended and after the file has been
+ * damaged.
+ */
+TEST(fs, stream_lz4)
+{
+    std::string path = testing::TempDir() + "liquid_fs_stream.lz4";
+    for (usize_t size : {0u, 10u, 262144u, 1000000u})
+    {
+        std::vector<uchar_t> content = make_text(size);
+        write_stream(path, FS_LZ4, content);
+
+        std::vector<uchar_t> file = read_file(path);
+        std::vector<uchar_t> unpacked(size + 1);
+        EXPECT_EQ(lz4_frame_decompress(unpacked.data(),
+                                       unpacked.data() + size, file.data(),
+                                       file.data() + file.size(), nullptr),
+                  unpacked.data() + size);
+        EXPECT_TRUE(std::equal(content.begin(), content.end(),
+                               unpacked.begin()));
+        if (size >= 1000)
+        {
+            EXPECT_LT(file.size(), size / 2);
+        }
+
+        std::vector<uchar_t> back;
+        EXPECT_TRUE(read_stream(path, FS_LZ4, back));
+        EXPECT_EQ(back, content) << size;
+
+        // Concatenated frames read as one content.
+        fs_handle_t handle;
+        ASSERT_TRUE(fs_open(&handle, path.c_str(), FS_WRITE | FS_APPEND));
+        EXPECT_TRUE(fs_write(handle, file.data(), file.size()));
+        fs_close(handle);
+        EXPECT_TRUE(read_stream(path, FS_LZ4, back));
+        EXPECT_EQ(back.size(), 2 * size);
+        EXPECT_TRUE(std::equal(content.begin(), content.end(), back.begin()));
+        EXPECT_TRUE(std::equal(content.begin(), content.end(),
+                               back.begin() + size));
+
+        // Truncated and corrupted files fail to read.
+        ASSERT_TRUE(fs_open(&handle, path.c_str(),
+                            FS_WRITE | FS_TRUNCATE));
+        EXPECT_TRUE(fs_write(handle, file.data(), file.size() - 1));
+        fs_close(handle);
+        EXPECT_FALSE(read_stream(path, FS_LZ4, back));
+
+        file.back() ^= 1;
+        ASSERT_TRUE(fs_open(&handle, path.c_str(),
+                            FS_WRITE | FS_TRUNCATE));
+        EXPECT_TRUE(fs_write(handle, file.data(), file.size()));
+        fs_close(handle);
+        EXPECT_FALSE(read_stream(path, FS_LZ4, back));
+    }
+    remove(path.c_str());
+}
@@ -0,0 +1,400 @@
+#include <gtest/gtest.h>
+#include <liquid/fs-watch.h>
+
+#if defined(LIQUID_TARGET_OS_POSIX_LIKE)
+    #include <cstdio>
+    #include <cstdlib>
+    #include <ftw.h>
+    #include <map>
+    #include <string>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #include <vector>
+
+/**
+ * @brief The batches a watcher delivered, each path with its flags.
+ */
+typedef std::vector<std::map<std::string, uint_t>> batches_t;
+
+/**
+ * @brief Records a batch of changes.
+ * @param watch The watcher.
+ * @param changes The changes.
+ * @param count The number of changes.
+ */
+static void
+on_changes(fs_watch_t *watch, const fs_watch_change_t *changes,
+           usize_t count)
+{
+    batches_t                    *batches = (batches_t *)watch->data;
+    std::map<std::string, uint_t> batch;
+    for (usize_t i = 0; i < count; ++i)
+    {
+        std::string path(changes[i].path, changes[i].size);
+        EXPECT_EQ(path, changes[i].path);
+        EXPECT_EQ(batch.count(path), 0u);
+        batch[path] = changes[i].events;
+    }
+    batches->push_back(batch);
+}
+
+/**
+ * @brief Removes a file or an empty directory.
+ * @return Zero to go on.
+ */
+static int
+remove_entry(const char *path, const struct stat *, int, struct FTW *)
+{
+    return remove(path);
+}
+
+/**
+ * @brief A temporary directory, removed with its content.
+ */
+struct temp_dir
+{
+    std::string path; ///< The path of the directory.
+
+    temp_dir()
+    {
+        char name[] = "/tmp/liquid-watch-XXXXXX";
+        EXPECT_NE(mkdtemp(name), nullptr);
+        path = name;
+    }
+
+    ~temp_dir()
+    {
+        nftw(path.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+    }
+
+    std::string
+    operator/(const char *name) const
+    {
+        return path + "/" + name;
+    }
+};
+
+/**
+ * @brief Writes a file.
+ * @param path The path of the file.
+ * @param text The content.
+ */
+static void
+write_file(const std::string &path, const char *text)
+{
+    FILE *file = fopen(path.c_str(), "a");
+    ASSERT_NE(file, nullptr);
+    fputs(text, file);
+    fclose(file);
+}
+
+/**
+ * @brief Runs a loop until a number of batches arrived or a timeout.
+ * @param loop The loop.
+ * @param batches The batches.
+ * @param count The number of batches.
+ * @param timeout The timeout in milliseconds.
+ */
+static void
+run_until(event_loop_t *loop, const batches_t &batches, usize_t count,
+          ullong_t timeout)
+{
+    ullong_t start = event_now();
+    while (batches.size() < count && event_now() - start < timeout)
+    {
+        ASSERT_TRUE(event_loop_run_once(loop, 10));
+    }
+}
+
+/**
+ * @brief Merges the batches of a watcher into the flags of each path.
+ * @param batches The batches.
+ * @return The flags of each path.
+ */
+static std::map<std::string, uint_t>
+merge(const batches_t &batches)
+{
+    std::map<std::string, uint_t> merged;
+    for (const auto &batch : batches)
+    {
+        for (const auto &change : batch)
+        {
+            merged[change.first] |= change.second;
+        }
+    }
+    return merged;
+}
+
+/**
+ * @test Test case for the changes to the files of a directory.
+ *
+ * This test creates, writes and deletes files in a watched directory in a
+ * burst and checks that they arrive in one batch, merged by path.
+ */
+TEST(fs_watch, files)
+{
+    temp_dir     dir;
+    event_loop_t loop;
+    fs_watch_t   watch;
+    batches_t    batches;
+    ASSERT_TRUE(event_loop_init(&loop, nullptr));
+    ASSERT_TRUE(fs_watch_init(&watch, &loop, on_changes, 50));
+    watch.data = &batches;
+    ASSERT_TRUE(fs_watch_add(&watch, (dir.path + "/").c_str(), 0));
+
+    write_file(dir / "a", "one");
+    write_file(dir / "a", "two");
+    write_file(dir / "b", "");
+    ASSERT_EQ(remove((dir / "b").c_str()), 0);
+
+    run_until(&loop, batches, 1, 5000);
+    run_until(&loop, batches, 2, 200);
+    ASSERT_EQ(batches.size(), 1u);
+    EXPECT_EQ(batches[0].size(), 2u);
+    EXPECT_EQ(batches[0][dir / "a"], FS_WATCH_CREATED | FS_WATCH_MODIFIED);
+    EXPECT_EQ(batches[0][dir / "b"] & (FS_WATCH_CREATED | FS_WATCH_DELETED),
+              FS_WATCH_CREATED | FS_WATCH_DELETED);
+
+    fs_watch_free(&watch);
+    event_loop_free(&loop);
+}
+
+/**
+ * @test Test case for a recursive watch.
+ *
+ * This test checks that directories below the watched one are watched,
+ * including those created and moved later, and that the entries created in
+ * a new directory before it is watched are reported.
+ */
+TEST(fs_watch, recursive)
+{
+    temp_dir dir;
+    ASSERT_EQ(mkdir((dir / "old").c_str(), 0700), 0);
+    write_file(dir / "old/file", "");
+
+    event_loop_t loop;
+    fs_watch_t   watch;
+    batches_t    batches;
+    ASSERT_TRUE(event_loop_init(&loop, nullptr));
+    ASSERT_TRUE(fs_watch_init(&watch, &loop, on_changes, 20));
+    watch.data = &batches;
+    ASSERT_TRUE(fs_watch_add(&watch, dir.path.c_str(), FS_WATCH_RECURSIVE));
+
+    write_file(dir / "old/file", "changed");
+    ASSERT_EQ(mkdir((dir / "new").c_str(), 0700), 0);
+    ASSERT_EQ(mkdir((dir / "new/deep").c_str(), 0700), 0);
+    write_file(dir / "new/deep/file", "");
+    run_until(&loop, batches, 1, 5000);
+
+    auto merged = merge(batches);
+    EXPECT_TRUE(merged[dir / "old/file"] & FS_WATCH_MODIFIED);
+    EXPECT_TRUE(merged[dir / "new"] & FS_WATCH_CREATED);
+    EXPECT_TRUE(merged[dir / "new/deep"] & FS_WATCH_CREATED);
+    EXPECT_TRUE(merged[dir / "new/deep/file"] & FS_WATCH_CREATED);
+
+    // The moved directory reports its changes under its new path.
+    batches.clear();
+    ASSERT_EQ(rename((dir / "new").c_str(), (dir / "moved").c_str()), 0);
+    run_until(&loop, batches, 1, 5000);
+    write_file(dir / "moved/deep/other", "");
+    run_until(&loop, batches, 2, 5000);
+
+    merged = merge(batches);
+    EXPECT_TRUE(merged[dir / "new"] & FS_WATCH_DELETED);
+    EXPECT_TRUE(merged[dir / "moved"] & FS_WATCH_CREATED);
+    EXPECT_TRUE(merged[dir / "moved/deep/other"] & FS_WATCH_CREATED);
+    EXPECT_EQ(merged.count(dir / "new/deep/other"), 0u);
+
+    fs_watch_free(&watch);
+    event_loop_free(&loop);
+}
+
+/**
+ * @test Test case for a watch of a directory without its tree.
+ *
+ * This test checks that changes below the entries of the directory are
+ * not reported, and that a file can be watched on its own.
+ */
+TEST(fs_watch, entries)
+{
+    temp_dir dir;
+    ASSERT_EQ(mkdir((dir / "sub").c_str(), 0700), 0);
+    write_file(dir / "sub/single", "");
+
+    event_loop_t loop;
+    fs_watch_t   watch;
+    batches_t    batches;
+    ASSERT_TRUE(event_loop_init(&loop, nullptr));
+    ASSERT_TRUE(fs_watch_init(&watch, &loop, on_changes, 20));
+    watch.data = &batches;
+    ASSERT_TRUE(fs_watch_add(&watch, dir.path.c_str(), 0));
+    ASSERT_TRUE(fs_watch_add(&watch, (dir / "sub/single").c_str(), 0));
+    EXPECT_FALSE(fs_watch_add(&watch, (dir / "missing").c_str(), 0));
+
+    write_file(dir / "sub/below", "");
+    write_file(dir / "sub/single", "changed");
+    write_file(dir / "top", "");
+    run_until(&loop, batches, 1, 5000);
+
+    auto merged = merge(batches);
+    EXPECT_TRUE(merged[dir / "sub/single"] & FS_WATCH_MODIFIED);
+    EXPECT_TRUE(merged[dir / "top"] & FS_WATCH_CREATED);
+    EXPECT_EQ(merged.count(dir / "sub/below"), 0u);
+
+    fs_watch_free(&watch);
+    event_loop_free(&loop);
+}
+
+/**
+ * @test Test case for the separators of the reported paths.
+ *
+ * This test watches a directory given with trailing separators, and the
+ * root when it can be written, and checks that the changed paths are
+ * joined to them with exactly one separator.
+ */
+TEST(fs_watch, separator)
+{
+    temp_dir dir;
+    ASSERT_EQ(mkdir((dir / "sub").c_str(), 0700), 0);
+
+    event_loop_t loop;
+    fs_watch_t   watch;
+    batches_t    batches;
+    ASSERT_TRUE(event_loop_init(&loop, nullptr));
+    ASSERT_TRUE(fs_watch_init(&watch, &loop, on_changes, 20));
+    watch.data = &batches;
+    ASSERT_TRUE(
+        fs_watch_add(&watch, (dir.path + "//").c_str(), FS_WATCH_RECURSIVE));
+
+    // The root ends with its separator, it is kept as it is.
+    char name[] = "/liquid-watch-XXXXXX";
+    bool root = !access("/", W_OK) && fs_watch_add(&watch, "/", 0)
+                && mkdtemp(name);
+
+    write_file(dir / "top", "");
+    write_file(dir / "sub/below", "");
+    run_until(&loop, batches, 1, 5000);
+
+    auto merged = merge(batches);
+    EXPECT_TRUE(merged[dir / "top"] & FS_WATCH_CREATED);
+    EXPECT_TRUE(merged[dir / "sub/below"] & FS_WATCH_CREATED);
+    if (root)
+    {
+        EXPECT_TRUE(merged[name] & FS_WATCH_CREATED);
+        EXPECT_EQ(rmdir(name), 0);
+    }
+    for (const auto &change : merged)
+    {
+        EXPECT_EQ(change.first.find("//"), std::string::npos) << change.first;
+    }
+
+    fs_watch_free(&watch);
+    event_loop_free(&loop);
+}
+
+/**
+ * @brief Appends to a file on every tick of a timer, for a while.
+ * @param loop The loop.
+ * @param timer The timer.
+ */
+static void
+on_tick(event_loop_t *loop, event_timer_t *timer)
+{
+    const std::string *path = (const std::string *)timer->data;
+    write_file(*path, "tick");
+    event_timer_start(loop, timer, 5);
+}
+
+/**
+ * @test Test case for the latency of a steady stream of changes.
+ *
+ * This test writes to a file more often than the debounce time and checks
+ * that batches are still delivered while the writes go on.
+ */
+TEST(fs_watch, latency)
+{
+    temp_dir      dir;
+    std::string   path = dir / "log";
+    event_loop_t  loop;
+    event_timer_t tick;
+    fs_watch_t    watch;
+    batches_t     batches;
+    ASSERT_TRUE(event_loop_init(&loop, nullptr));
+    ASSERT_TRUE(fs_watch_init(&watch, &loop, on_changes, 40));
+    watch.data = &batches;
+    ASSERT_TRUE(fs_watch_add(&watch, dir.path.c_str(), 0));
+
+    event_timer_init(&tick, on_tick, &path);
+    event_timer_start(&loop, &tick, 0);
+    run_until(&loop, batches, 2, 2000);
+    EXPECT_TRUE(event_timer_active(&tick));
+    ASSERT_GE(batches.size(), 2u);
+    EXPECT_TRUE(batches[1][path] & FS_WATCH_MODIFIED);
+
+    event_timer_stop(&loop, &tick);
+    fs_watch_free(&watch);
+    event_loop_free(&loop);
+}
+
+    #if defined(LIQUID_TARGET_OS_LINUX)
+/**
+ * @test Test case for the watches of a recursive tree after an overflow.
+ *
+ * This test fills the inotify queue, then creates a directory and removes
+ * two while the events are dropped, and checks that the watcher watches
+ * the new directory and forgets the removed ones.
+ */
+TEST(fs_watch, overflow)
+{
+    uint_t limit = 0;
+    FILE  *file = fopen("/proc/sys/fs/inotify/max_queued_events", "r");
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(fscanf(file, "%u", &limit), 1);
+    fclose(file);
+    if (limit > 1u << 17)
+    {
+        GTEST_SKIP() << "the inotify queue is too long to fill";
+    }
+
+    temp_dir dir;
+    ASSERT_EQ(mkdir((dir / "flood").c_str(), 0700), 0);
+    ASSERT_EQ(mkdir((dir / "gone").c_str(), 0700), 0);
+    ASSERT_EQ(mkdir((dir / "lost").c_str(), 0700), 0);
+
+    event_loop_t loop;
+    fs_watch_t   watch;
+    batches_t    batches;
+    ASSERT_TRUE(event_loop_init(&loop, nullptr));
+    ASSERT_TRUE(fs_watch_init(&watch, &loop, on_changes, 20));
+    watch.data = &batches;
+    ASSERT_TRUE(fs_watch_add(&watch, dir.path.c_str(), FS_WATCH_RECURSIVE));
+    ASSERT_EQ(watch.backend.paths.size, 4u);
+
+    // Every new file is one event, the queue is full before the loop runs.
+    for (uint_t i = 0; i <= limit; ++i)
+    {
+        write_file(dir / "flood/" + std::to_string(i), "");
+    }
+    ASSERT_EQ(mkdir((dir / "late").c_str(), 0700), 0);
+    ASSERT_EQ(rmdir((dir / "gone").c_str()), 0);
+    ASSERT_EQ(rmdir((dir / "lost").c_str()), 0);
+
+    ullong_t start = event_now();
+    while (!(merge(batches)[""] & FS_WATCH_OVERFLOW)
+           && event_now() - start < 5000)
+    {
+        ASSERT_TRUE(event_loop_run_once(&loop, 10));
+    }
+    ASSERT_TRUE(merge(batches)[""] & FS_WATCH_OVERFLOW);
+    EXPECT_EQ(watch.backend.paths.size, 3u);
+
+    batches.clear();
+    write_file(dir / "late/file", "");
+    run_until(&loop, batches, 1, 5000);
+    EXPECT_TRUE(merge(batches)[dir / "late/file"] & FS_WATCH_CREATED);
+
+    fs_watch_free(&watch);
+    event_loop_free(&loop);
+}
+    #endif
+#endif
@@ -0,0 +1,287 @@
+#include <gtest/gtest.h>
+#include <liquid/hash.h>
+#include <random>
+#include <vector>
+
+/**
+ * @struct hash_vector
+ * @brief A hash of a test pattern computed with the reference xxHash.
+ */
+struct hash_vector
+{
+    usize_t  len;  ///< The length of the pattern.
+    ullong_t hash; ///< The 64-bit hash.
+    ullong_t low;  ///< The lower half of the 128-bit hash.
+    ullong_t high; ///< The upper half of the 128-bit hash.
+};
+
+/**
+ * @brief Fills a buffer with the test pattern.
+ * @param len The length of the pattern.
+ * @return The pattern.
+ */
+static std::vector<uchar_t>
+hash_pattern(usize_t len)
+{
+    std::vector<uchar_t> data(len);
+    for (usize_t i = 0; i < len; ++i)
+    {
+        data[i] = (uchar_t)(i * 31 + 7);
+    }
+    return data;
+}
+
+/**
+ * @test Test case for the values of the one-shot hashes.
+ *
+ * This test compares the hashes of every length class, with and without a
+ * seed, against values computed with XXH3 of the reference xxHash library.
+ */
+TEST(hash, known_values)
+{
+    const hash_vector unseeded[] = {
+        {0, 0x2d06800538d394c2ull, 0x6001c324468d497full,
+         0x99aa06d3014798d8ull},
+        {1, 0x4c5cca45d0f4811full, 0x4c5cca45d0f4811full,
+         0x495b62073ef70ca4ull},
+        {3, 0x15f7093b173d005cull, 0x15f7093b173d005cull,
+         0x46f66cb935381565ull},
+        {4, 0xdca012f95811b6b9ull, 0xb987ca5d9241572aull,
+         0x7fefeeffb4d0eab3ull},
+        {8, 0xdec6a9a43575982eull, 0x56bb836ceb6d4baaull,
+         0x803c675a846cc6c2ull},
+        {9, 0xcbe393399f17ffbdull, 0x4376673580310154ull,
+         0xd46556872d230f22ull},
+        {16, 0x7e484c18d74895d0ull, 0xf853dd94614dfa07ull,
+         0x650fe308c566747dull},
+        {17, 0x208bde5ee2bed407ull, 0x78c349fe81b2f26cull,
+         0x18217300b5132d5aull},
+        {128, 0xf92b70eaa21a6288ull, 0x1e04fad9f0cacb4dull,
+         0xb4f87b99d2db8a51ull},
+        {129, 0xf8f76713f2bb60faull, 0xc51bc887976aef63ull,
+         0x6881633650cd8924ull},
+        {240, 0xccc7375172c41f03ull, 0x93e173833f75ab66ull,
+         0xde57aab31e77a2ffull},
+        {241, 0x0b3b630948ce4a00ull, 0x0b3b630948ce4a00ull,
+         0x92b991a7192f3f08ull},
+        {1024, 0x23bc880ebf0d29c6ull, 0x23bc880ebf0d29c6ull,
+         0x4c17271c906df792ull},
+        {2048, 0x19f6f9c987331373ull, 0x19f6f9c987331373ull,
+         0xb318976b177a38c7ull},
+    };
+    const hash_vector seeded[] = {
+        {0, 0x602b0e2cd6662c8bull, 0x4ca5176998171787ull,
+         0xd142977a2cca554bull},
+        {1, 0x2f3acd3805f81de3ull, 0x2f3acd3805f81de3ull,
+         0x00a711eb5a736b26ull},
+        {3, 0x079dd5d54d89480aull, 0x079dd5d54d89480aull,
+         0xbf6c84df5f76651dull},
+        {4, 0x1a246e2efb9c9b2eull, 0x64e9e646b51d20e4ull,
+         0xb51a3f0020dfa57eull},
+        {8, 0x19ef7d3919108affull, 0x3edb070ecf3a9343ull,
+         0xc3612dc11470e721ull},
+        {9, 0x9c98d3e24dc54d34ull, 0x2d1266ad8e2a983eull,
+         0xd073a967e56faabbull},
+        {16, 0xa106510078b0a252ull, 0x4e683254a04c377full,
+         0xbe0f27bac4d1f58full},
+        {17, 0x0b2caf8bf9648effull, 0xec6d60966729df8dull,
+         0x81d87d7004dc4f98ull},
+        {128, 0x95425530beb89fe8ull, 0x8dd13adf89d20a39ull,
+         0xf1355c6816c0b724ull},
+        {129, 0x29fa850b97ed9666ull, 0xa1c74215b3db7ab4ull,
+         0xb8c736db70349640ull},
+        {240, 0x2d882e7899ff64ccull, 0xde896b7f1ae3bc6full,
+         0x5b131678a4a9b8f4ull},
+        {241, 0x422e82e8913e49e0ull, 0x422e82e8913e49e0ull,
+         0xc39cbfb460caf47eull},
+        {1024, 0x7e249adc60e1f9b4ull, 0x7e249adc60e1f9b4ull,
+         0x927c8d2b50d33f53ull},
+        {2048, 0x060600a6317839f9ull, 0x060600a6317839f9ull,
+         0x51a684c4afa32172ull},
+    };
+    const ullong_t seed = 0x9E3779B97F4A7C15ull;
+
+    for (const hash_vector &vector : unseeded)
+    {
+        std::vector<uchar_t> data = hash_pattern(vector.len);
+        const uchar_t       *end = data.data() + data.size();
+
+        EXPECT_EQ(hash64(data.data(), end, 0), vector.hash) << vector.len;
+        hash128_t wide = hash128(data.data(), end, 0);
+        EXPECT_EQ(wide.low, vector.low) << vector.len;
+        EXPECT_EQ(wide.high, vector.high) << vector.len;
+    }
+
+    for (const hash_vector &vector : seeded)
+    {
+        std::vector<uchar_t> data = hash_pattern(vector.len);
+        const uchar_t       *end = data.data() + data.size();
+
+        EXPECT_EQ(hash64(data.data(), end, seed), vector.hash) << vector.len;
+        hash128_t wide = hash128(data.data(), end, seed);
+        EXPECT_EQ(wide.low, vector.low) << vector.len;
+        EXPECT_EQ(wide.high, vector.high) << vector.len;
+    }
+}
+
+/**
+ * @test Test case for incremental hashing.
+ *
+ * This test feeds inputs of many lengths in random pieces and verifies that
+ * the result matches the one-shot hash, also at unaligned addresses and
+ * when the state is finalized and then updated further.
+ */
+TEST(hash, streaming)
+{
+    std::mt19937_64      rng(7);
+    std::vector<uchar_t> data(4096 + 3);
+    for (uchar_t &byte : data)
+    {
+        byte = (uchar_t)rng();
+    }
+
+    hash_state_t state;
+    for (usize_t len = 0; len <= 4096; len += len < 600 ? 1 : 61)
+    {
+        const uchar_t *begin = data.data() + len % 4;
+        const ullong_t seed = len % 3 ? rng() : 0;
+
+        hash_init(&state, seed);
+        usize_t pos = 0;
+        while (pos < len)
+        {
+            usize_t piece = rng() % (rng() % 2 ? 8 : 700);
+            piece = piece < len - pos ? piece : len - pos;
+            hash_update(&state, begin + pos, begin + pos + piece);
+            pos += piece;
+        }
+
+        EXPECT_EQ(hash64_final(&state), hash64(begin, begin + len, seed))
+            << len;
+        hash128_t expected = hash128(begin, begin + len, seed);
+        hash128_t actual = hash128_final(&state);
+        EXPECT_EQ(actual.low, expected.low) << len;
+        EXPECT_EQ(actual.high, expected.high) << len;
+    }
+
+    // Finalizing leaves the state untouched.
+    hash_init(&state, 1);
+    hash_update(&state, data.data(), data.data() + 1000);
+    EXPECT_EQ(hash64_final(&state), hash64(data.data(), data.data() + 1000, 1));
+    hash_update(&state, data.data() + 1000, data.data() + 3000);
+    EXPECT_EQ(hash64_final(&state), hash64(data.data(), data.data() + 3000, 1));
+}
+
+/**
+ * @test Test case for the sensitivity of the hashes.
+ *
+ * This test verifies that flipping any single bit of the input or changing
+ * the seed changes the hash.
+ */
+TEST(hash, sensitivity)
+{
+    for (usize_t len : {1u, 7u, 16u, 100u, 200u, 1000u})
+    {
+        std::vector<uchar_t> data = hash_pattern(len);
+        const uchar_t       *end = data.data() + data.size();
+        const ullong_t       base = hash64(data.data(), end, 0);
+
+        EXPECT_NE(hash64(data.data(), end, 1), base);
+        for (usize_t bit = 0; bit < len * 8; ++bit)
+        {
+            data[bit / 8] ^= (uchar_t)(1 << (bit % 8));
+            EXPECT_NE(hash64(data.data(), end, 0), base) << len << " " << bit;
+            hash128_t wide = hash128(data.data(), end, 0);
+            data[bit / 8] ^= (uchar_t)(1 << (bit % 8));
+            EXPECT_NE(wide.high, hash128(data.data(), end, 0).high);
+        }
+    }
+}
+
+/**
+ * @test Test case for the 32-bit hash.
+ *
+ * This test compares hashes against values computed with XXH32 of the
+ * reference xxHash library and checks that incremental hashing in random
+ * pieces gives the same values.
+ */
+TEST(hash, xxh32)
+{
+    const struct
+    {
+        usize_t len;
+        uint_t  unseeded;
+        uint_t  seeded;
+    } vectors[] = {
+        {0, 0x02cc5d05u, 0x36b78ae7u},    {1, 0x002e0d32u, 0xd40fe509u},
+        {3, 0xaca17380u, 0xed8936d0u},    {4, 0x073faa82u, 0x893f71b0u},
+        {15, 0x9f29f87bu, 0x22dc4620u},   {16, 0x3f6c9665u, 0x17393d4au},
+        {17, 0xe048ecdbu, 0x5981b004u},   {100, 0x75936eb8u, 0x81d373f5u},
+        {1024, 0xead2ce3cu, 0xb3f439f0u},
+    };
+    const uint_t seed = 0x9E3779B1u;
+
+    std::mt19937 rng(32);
+    for (const auto &vector : vectors)
+    {
+        std::vector<uchar_t> data = hash_pattern(vector.len);
+        const uchar_t       *end = data.data() + data.size();
+        EXPECT_EQ(hash32(data.data(), end, 0), vector.unseeded) << vector.len;
+        EXPECT_EQ(hash32(data.data(), end, seed), vector.seeded) << vector.len;
+
+        hash32_state_t state;
+        hash32_init(&state, seed);
+        for (const uchar_t *pos = data.data(); pos < end;)
+        {
+            usize_t piece = rng() % 21;
+            piece = piece < (usize_t)(end - pos) ? piece : (usize_t)(end - pos);
+            hash32_update(&state, pos, pos + piece);
+            pos += piece;
+        }
+        EXPECT_EQ(hash32_final(&state), vector.seeded) << vector.len;
+    }
+}
+
+/**
+ * @test Test case for the CRC-32C checksum.
+ *
+ * This test verifies the standard check value, chaining of consecutive
+ * ranges and the result for every length and alignment against a bitwise
+ * reference implementation.
+ */
+TEST(hash, crc32c)
+{
+    const char check[] = "123456789";
+    EXPECT_EQ(hash_crc32c(check, check + 9, 0), 0xE3069283u);
+    EXPECT_EQ(hash_crc32c(check, check, 0), 0u);
+    uint_t head = hash_crc32c(check, check + 4, 0);
+    EXPECT_EQ(hash_crc32c(check + 4, check + 9, head), 0xE3069283u);
+
+    std::mt19937         rng(3);
+    std::vector<uchar_t> data(300);
+    for (uchar_t &byte : data)
+    {
+        byte = (uchar_t)rng();
+    }
+
+    for (usize_t offset = 0; offset < 8; ++offset)
+    {
+        for (usize_t len = 0; offset + len <= data.size(); len += 7)
+        {
+            uint_t expected = 0xFFFFFFFF;
+            for (usize_t i = offset; i < offset + len; ++i)
+            {
+                expected ^= data[i];
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    uint_t mask = 0 - (expected & 1);
+                    expected = (expected >> 1) ^ (0x82F63B78 & mask);
+                }
+            }
+
+            const uchar_t *begin = data.data() + offset;
+            EXPECT_EQ(hash_crc32c(begin, begin + len, 0), ~expected)
+                << offset << " " << len;
+        }
+    }
+}
@@ -0,0 +1,173 @@
+#include <cstring>
+#include <gtest/gtest.h>
+#include <liquid/interner.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Interns a C++ string.
+ */
+static uint_t
+intern(interner_t *interner, const std::string &str)
+{
+    return interner_intern(interner, str.data(), str.data() + str.size());
+}
+
+/**
+ * @test Test case for interning strings.
+ *
+ * This test checks that equal strings share an id, that ids are handed out
+ * densely and that the strings can be retrieved by their ids.
+ */
+TEST(interner, intern_and_lookup)
+{
+    interner_t interner;
+    ASSERT_TRUE(interner_init(&interner, nullptr));
+
+    EXPECT_EQ(intern(&interner, "http.requests"), 0u);
+    EXPECT_EQ(intern(&interner, "http.errors"), 1u);
+    EXPECT_EQ(intern(&interner, ""), 2u);
+    EXPECT_EQ(intern(&interner, "http.requests"), 0u);
+    EXPECT_EQ(interner_count(&interner), 3u);
+
+    usize_t       size = 0;
+    const char_t *str = interner_str(&interner, 1, &size);
+    ASSERT_NE(str, nullptr);
+    EXPECT_EQ(size, 11u);
+    EXPECT_STREQ(str, "http.errors");
+    EXPECT_STREQ(interner_str(&interner, 2, nullptr), "");
+    EXPECT_EQ(interner_str(&interner, 3, nullptr), nullptr);
+
+    const char_t name[] = "http.errors.total";
+    EXPECT_EQ(interner_find(&interner, name, name + 11), 1u);
+    EXPECT_EQ(interner_find(&interner, name, name + 12), INTERNER_INVALID);
+    EXPECT_EQ(interner_count(&interner), 3u);
+
+    interner_free(&interner);
+}
+
+/**
+ * @test Test case for interning many strings.
+ *
+ * This test interns enough strings to grow the tables of every shard and
+ * to span several chunks of the id table.
+ */
+TEST(interner, many_strings)
+{
+    interner_t interner;
+    ASSERT_TRUE(interner_init(&interner, nullptr));
+
+    const uint_t count = 100000;
+    for (uint_t i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(intern(&interner, "label-" + std::to_string(i)), i);
+    }
+    EXPECT_EQ(interner_count(&interner), count);
+
+    for (uint_t i = 0; i < count; ++i)
+    {
+        std::string str = "label-" + std::to_string(i);
+        EXPECT_EQ(interner_find(&interner, str.data(), str.data() + str.size()),
+                  i);
+        EXPECT_STREQ(interner_str(&interner, i, nullptr), str.c_str());
+    }
+
+    interner_free(&interner);
+}
+
+/**
+ * @test Test case for interning from several threads.
+ *
+ * This test lets threads intern overlapping sets of strings and verifies
+ * that every string ends up with a single id and every id with a single
+ * string.
+ */
+TEST(interner, concurrent)
+{
+    interner_t interner;
+    ASSERT_TRUE(interner_init(&interner, nullptr));
+
+    const uint_t                     strings = 20000;
+    const uint_t                     threads = 8;
+    std::vector<std::vector<uint_t>> ids(threads,
+                                         std::vector<uint_t>(strings));
+    std::vector<std::thread>         workers;
+
+    for (uint_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t] {
+            for (uint_t i = 0; i < strings; ++i)
+            {
+                // Every thread walks the strings in a different order.
+                uint_t      index = (i * 7919u + t * 4001u) % strings;
+                std::string str = "metric." + std::to_string(index);
+                ids[t][index] = intern(&interner, str);
+            }
+        });
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    EXPECT_EQ(interner_count(&interner), strings);
+    std::vector<bool> used(strings);
+    for (uint_t i = 0; i < strings; ++i)
+    {
+        uint_t id = ids[0][i];
+        ASSERT_LT(id, strings);
+        EXPECT_FALSE(used[id]);
+        used[id] = true;
+        for (uint_t t = 1; t < threads; ++t)
+        {
+            EXPECT_EQ(ids[t][i], id);
+        }
+        EXPECT_STREQ(interner_str(&interner, id, nullptr),
+                     ("metric." + std::to_string(i)).c_str());
+    }
+
+    interner_free(&interner);
+}
+
+/**
+ * @test Test case for reading ids while another thread interns.
+ *
+ * This test walks the ids counted so far while strings are interned and
+ * checks that every string it gets is complete, an id whose string is not
+ * written yet giving nullptr.
+ */
+TEST(interner, concurrent_reads)
+{
+    interner_t interner;
+    ASSERT_TRUE(interner_init(&interner, nullptr));
+
+    const uint_t strings = 50000;
+    std::thread  writer([&] {
+        for (uint_t i = 0; i < strings; ++i)
+        {
+            intern(&interner, "metric." + std::to_string(i));
+        }
+    });
+
+    uint_t seen = 0;
+    while (seen < strings)
+    {
+        seen = 0;
+        uint_t count = interner_count(&interner);
+        for (uint_t id = 0; id < count; ++id)
+        {
+            usize_t       size = 0;
+            const char_t *str = interner_str(&interner, id, &size);
+            if (str)
+            {
+                ASSERT_EQ(std::string(str, size),
+                          "metric." + std::to_string(id));
+                ++seen;
+            }
+        }
+    }
+    writer.join();
+
+    interner_free(&interner);
+}
@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <liquid/ipc.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(LIQUID_TARGET_OS_POSIX_LIKE)
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+/**
+ * @brief Makes a name of a region unique to the test and the process.
+ * @param test The name of the test.
+ * @return The name.
+ */
+static std::string
+region_name(const char *test)
+{
+    std::string name = std::string("liquid_ipc_") + test + "_"
+                       + std::to_string(
+                           std::chrono::steady_clock::now()
+                               .time_since_epoch()
+                               .count()
+                           % 1000000007);
+    ipc_shm_remove(name.c_str());
+    return name;
+}
+
+/**
+ * @test Test case for named shared memory.
+ *
+ * This test creates a region, checks that it is zeroed and that a second
+ * mapping of it by name sees the writes to the first, and that a second
+ * region of the same name cannot be created.
+ */
+TEST(ipc, shm)
+{
+    std::string name = region_name("shm");
+    ipc_shm_t   first, second, again;
+    ASSERT_TRUE(ipc_shm_create(&first, name.c_str(), 10000));
+    EXPECT_FALSE(ipc_shm_create(&again, name.c_str(), 10000));
+    ASSERT_TRUE(ipc_shm_open(&second, name.c_str()));
+    EXPECT_GE(second.size, 10000u);
+
+    const char *bytes = (const char *)first.data;
+    EXPECT_EQ(std::count(bytes, bytes + 10000, 0), 10000);
+    std::strcpy((char *)first.data + 5000, "shared");
+    EXPECT_STREQ((const char *)second.data + 5000, "shared");
+
+    ipc_shm_close(&second);
+    ipc_shm_close(&first);
+    EXPECT_TRUE(ipc_shm_remove(name.c_str()));
+}
+
+/**
+ * @test Test case for messages in order.
+ *
+ * This test passes messages of many sizes, including empty ones, through
+ * a small ring so that they wrap around its end many times, and checks
+ * each of them in place. It also checks that a full ring and an empty one
+ * fail at once without a timeout.
+ */
+TEST(ipc, ring)
+{
+    std::string name = region_name("ring");
+    ipc_ring_t  producer, consumer;
+    ASSERT_TRUE(ipc_ring_create(&consumer, name.c_str(), 4096, 0));
+    ASSERT_TRUE(ipc_ring_open(&producer, name.c_str()));
+    EXPECT_EQ(producer.capacity, 4096u);
+
+    usize_t size;
+    EXPECT_EQ(ipc_ring_peek(&consumer, &size, 0), nullptr);
+
+    usize_t sent = 0, received = 0;
+    for (usize_t round = 0; round < 2000; ++round)
+    {
+        for (usize_t i = 0; i < round % 7; ++i, ++sent)
+        {
+            usize_t  length = sent * 37 % 300;
+            uchar_t *message =
+                (uchar_t *)ipc_ring_reserve(&producer, length, 0);
+            ASSERT_NE(message, nullptr);
+            EXPECT_EQ((usize_t)message % IPC_RING_ALIGN, 0u);
+            for (usize_t j = 0; j < length; ++j)
+            {
+                message[j] = (uchar_t)(sent + j);
+            }
+            ipc_ring_commit(&producer, message);
+        }
+        for (; received < sent; ++received)
+        {
+            const uchar_t *message =
+                (const uchar_t *)ipc_ring_peek(&consumer, &size, 0);
+            ASSERT_NE(message, nullptr);
+            ASSERT_EQ(size, received * 37 % 300);
+            for (usize_t j = 0; j < size; ++j)
+            {
+                ASSERT_EQ(message[j], (uchar_t)(received + j));
+            }
+            ipc_ring_release(&consumer);
+        }
+    }
+
+    char message[1000] = {0};
+    usize_t count = 0;
+    while (ipc_ring_send(&producer, message, sizeof(message), 0))
+    {
+        ++count;
+    }
+    EXPECT_GE(count, 3u);
+    EXPECT_LE(count, 4u);
+    EXPECT_FALSE(ipc_ring_receive(&consumer, message, 10, &size, 0));
+    EXPECT_TRUE(ipc_ring_receive(&consumer, message, sizeof(message), &size,
+                                 0));
+    EXPECT_EQ(size, sizeof(message));
+
+    ipc_ring_close(&producer);
+    ipc_ring_close(&consumer);
+    EXPECT_TRUE(ipc_shm_remove(name.c_str()));
+}
+
+/**
+ * @test Test case for many producers.
+ *
+ * This test has producers on threads of their own, each with a ring opened
+ * by name, fill a small ring while the consumer drains it, and checks that
+ * the messages of each producer come in the order in which it sent them.
+ */
+TEST(ipc, producers)
+{
+    constexpr uint_t  PRODUCERS = 4;
+    constexpr ullong_t MESSAGES = 20000;
+
+    std::string name = region_name("producers");
+    ipc_ring_t  consumer;
+    ASSERT_TRUE(ipc_ring_create(&consumer, name.c_str(), 4096, 0));
+
+    std::vector<std::thread> threads;
+    for (uint_t producer = 0; producer < PRODUCERS; ++producer)
+    {
+        threads.emplace_back(
+            [&name, producer]
+            {
+                ipc_ring_t ring;
+                if (!ipc_ring_open(&ring, name.c_str()))
+                {
+                    return;
+                }
+                for (ullong_t i = 0; i < MESSAGES; ++i)
+                {
+                    ullong_t message[2] = {producer, i};
+                    ipc_ring_send(&ring, message,
+                                  sizeof(ullong_t) * (1 + i % 2),
+                                  IPC_INFINITE);
+                }
+                ipc_ring_close(&ring);
+            });
+    }
+
+    std::vector<ullong_t> next(PRODUCERS, 0);
+    for (ullong_t i = 0; i < PRODUCERS * MESSAGES; ++i)
+    {
+        usize_t        size;
+        const ullong_t *message =
+            (const ullong_t *)ipc_ring_peek(&consumer, &size, 5000);
+        ASSERT_NE(message, nullptr);
+        ASSERT_LT(message[0], PRODUCERS);
+        ullong_t expected = next[message[0]]++;
+        ASSERT_EQ(size, sizeof(ullong_t) * (1 + expected % 2));
+        if (size > sizeof(ullong_t))
+        {
+            ASSERT_EQ(message[1], expected);
+        }
+        ipc_ring_release(&consumer);
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(next, std::vector<ullong_t>(PRODUCERS, MESSAGES));
+
+    ipc_ring_close(&consumer);
+    EXPECT_TRUE(ipc_shm_remove(name.c_str()));
+}
+
+/**
+ * @test Test case for timeouts.
+ *
+ * This test checks that the consumer of an empty ring and the producer of
+ * a full one give up once their timeouts pass.
+ */
+TEST(ipc, timeout)
+{
+    std::string name = region_name("timeout");
+    ipc_ring_t  ring;
+    ASSERT_TRUE(ipc_ring_create(&ring, name.c_str(), 4096, 0));
+
+    usize_t size;
+    auto    start = std::chrono::steady_clock::now();
+    EXPECT_EQ(ipc_ring_peek(&ring, &size, 20), nullptr);
+    EXPECT_GE(std::chrono::steady_clock::now() - start,
+              std::chrono::milliseconds(20));
+
+    EXPECT_EQ(ipc_ring_reserve(&ring, 4096, 0), nullptr);
+    while (ipc_ring_reserve(&ring, 1000, 0))
+    {
+    }
+    start = std::chrono::steady_clock::now();
+    EXPECT_EQ(ipc_ring_reserve(&ring, 1000, 20), nullptr);
+    EXPECT_GE(std::chrono::steady_clock::now() - start,
+              std::chrono::milliseconds(20));
+
+    ipc_ring_close(&ring);
+    EXPECT_TRUE(ipc_shm_remove(name.c_str()));
+}
+
+/**
+ * @test Test case for a corrupt ring.
+ *
+ * This test checks that a ring whose capacity is zero cannot be opened,
+ * and that a message whose size runs past the end of the ring is not
+ * returned.
+ */
+TEST(ipc, corrupt)
+{
+    std::string name = region_name("corrupt");
+    ipc_ring_t  ring, other;
+    ASSERT_TRUE(ipc_ring_create(&ring, name.c_str(), 4096, 0));
+
+    ring.header->capacity = 0;
+    EXPECT_FALSE(ipc_ring_open(&other, name.c_str()));
+    ring.header->capacity = 4096;
+
+    // The header of a committed message, with a size beyond the ring.
+    usize_t size;
+    *(ullong_t *)ring.data = (ullong_t)100000 << 32 | 1;
+    EXPECT_EQ(ipc_ring_peek(&ring, &size, 0), nullptr);
+    *(ullong_t *)ring.data = (ullong_t)4000 << 32 | 1;
+    EXPECT_EQ(ipc_ring_peek(&ring, &size, 0), nullptr);
+    *(ullong_t *)ring.data = (ullong_t)100 << 32 | 1;
+    EXPECT_NE(ipc_ring_peek(&ring, &size, 0), nullptr);
+    EXPECT_EQ(size, 100u);
+
+    ipc_ring_close(&ring);
+    EXPECT_TRUE(ipc_shm_remove(name.c_str()));
+}
+
+#if defined(LIQUID_TARGET_OS_POSIX_LIKE)
+/**
+ * @test Test case for a ring between processes.
+ *
+ * This test forks a child which opens the ring by name and echoes each
+ * message back on a second ring, incremented.
+ */
+TEST(ipc, process)
+{
+    std::string requests = region_name("requests");
+    std::string replies = region_name("replies");
+    ipc_ring_t  request, reply;
+    ASSERT_TRUE(ipc_ring_create(&request, requests.c_str(), 4096,
+                                IPC_SINGLE_PRODUCER));
+    ASSERT_TRUE(ipc_ring_create(&reply, replies.c_str(), 4096,
+                                IPC_SINGLE_PRODUCER));
+
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (!child)
+    {
+        ipc_ring_t input, output;
+        if (!ipc_ring_open(&input, requests.c_str())
+            || !ipc_ring_open(&output, replies.c_str()))
+        {
+            _exit(1);
+        }
+        ullong_t value = 0;
+        usize_t size;
+        while (ipc_ring_receive(&input, &value, sizeof(value), &size, 5000)
+               && value)
+        {
+            ++value;
+            ipc_ring_send(&output, &value, sizeof(value), IPC_INFINITE);
+        }
+        _exit(value ? 1 : 0);
+    }
+
+    for (ullong_t value = 1; value < 10000; value += 2)
+    {
+        ullong_t answer = 0;
+        usize_t size;
+        ASSERT_TRUE(ipc_ring_send(&request, &value, sizeof(value), 5000));
+        ASSERT_TRUE(ipc_ring_receive(&reply, &answer, sizeof(answer), &size,
+                                     5000));
+        ASSERT_EQ(answer, value + 1);
+    }
+    ullong_t stop = 0;
+    EXPECT_TRUE(ipc_ring_send(&request, &stop, sizeof(stop), 5000));
+
+    int status = 0;
+    EXPECT_EQ(waitpid(child, &status, 0), child);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    ipc_ring_close(&request);
+    ipc_ring_close(&reply);
+    EXPECT_TRUE(ipc_shm_remove(requests.c_str()));
+    EXPECT_TRUE(ipc_shm_remove(replies.c_str()));
+}
+#endif
@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <liquid/lz4.h>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Generates test content of a given kind.
+ *
+ * @param size The size of the content.
+ * @param kind 0 for random bytes, 1 for text, 2 for zeros and 3 for short
+ *             runs.
+ * @return The content.
+ */
+static std::vector<uchar_t>
+make_content(usize_t size, uint_t kind)
+{
+    static const char *const words[] = {"alpha", "beta",  "gamma", "delta",
+                                        "id=",   "value", ", ",    "\n"};
+
+    std::mt19937         rng((uint_t)size * 4 + kind);
+    std::vector<uchar_t> content;
+    content.reserve(size + 8);
+    while (content.size() < size)
+    {
+        if (kind == 0)
+        {
+            content.push_back((uchar_t)rng());
+        }
+        else if (kind == 1)
+        {
+            for (const char *word = words[rng() % 8]; *word; ++word)
+            {
+                content.push_back((uchar_t)*word);
+            }
+            content.push_back((uchar_t)('0' + rng() % 10));
+        }
+        else if (kind == 2)
+        {
+            content.push_back(0);
+        }
+        else
+        {
+            content.insert(content.end(), rng() % 40, (uchar_t)(rng() % 3));
+            content.push_back((uchar_t)rng());
+        }
+    }
+    content.resize(size);
+    return content;
+}
+
+/**
+ * @test Test case for compressing and decompressing blocks.
+ *
+ * This test compresses content of every kind and many sizes at several
+ * levels, checks that decompression restores the content and that a
+ * destination one byte short is rejected, and that the lazy levels from 3
+ * on compress text better than the greedy ones.
+ */
+TEST(lz4, roundtrip)
+{
+    std::vector<uchar_t> text = make_content(100000, 1);
+    usize_t              text_size = text.size();
+    for (uint_t level : {1u, 2u, 3u, 6u, 9u})
+    {
+        lz4_state_t state;
+        ASSERT_TRUE(lz4_init(&state, level, nullptr));
+        for (uint_t kind = 0; kind < 4; ++kind)
+        {
+            for (usize_t size : {0u, 1u, 5u, 12u, 13u, 100u, 4096u, 70000u,
+                                 300000u})
+            {
+                std::vector<uchar_t> content = make_content(size, kind);
+                std::vector<uchar_t> packed(lz4_bound(size));
+                uchar_t *end = lz4_compress(&state, packed.data(),
+                                            packed.data() + packed.size(),
+                                            content.data(),
+                                            content.data() + size);
+                ASSERT_NE(end, nullptr)
+                    << level << " " << kind << " " << size;
+                if (kind == 2 && size >= 100)
+                {
+                    EXPECT_LT((usize_t)(end - packed.data()),
+                              size / 100 + 16);
+                }
+
+                // One spare byte keeps the destination valid when empty.
+                std::vector<uchar_t> unpacked(size + 1);
+                EXPECT_EQ(lz4_decompress(nullptr, unpacked.data(),
+                                         unpacked.data() + size, packed.data(),
+                                         end),
+                          unpacked.data() + size);
+                EXPECT_TRUE(std::equal(content.begin(), content.end(),
+                                       unpacked.begin()))
+                    << level << " " << kind << " " << size;
+                if (size)
+                {
+                    EXPECT_EQ(lz4_decompress(nullptr, unpacked.data(),
+                                             unpacked.data() + size - 1,
+                                             packed.data(), end),
+                              nullptr);
+                }
+            }
+        }
+
+        // The lazy levels must compress text better than the greedy ones.
+        std::vector<uchar_t> packed(lz4_bound(text.size()));
+        usize_t size = lz4_compress(&state, packed.data(),
+                                    packed.data() + packed.size(), text.data(),
+                                    text.data() + text.size())
+                       - packed.data();
+        if (level >= 3)
+        {
+            EXPECT_LE(size, text_size) << level;
+        }
+        text_size = std::min(text_size, size);
+        lz4_free(&state);
+    }
+}
+
+/**
+ * @test Test case for malformed blocks.
+ *
+ * This test checks that references before the start of the output are
+ * rejected unless history is given, that truncated blocks never decode to
+ * the full content and that random input never writes past the
+ * destination.
+ */
+TEST(lz4, malformed)
+{
+    // A literal 'a' followed by a reference two bytes back.
+    const uchar_t block[] = {0x14, 'a', 0x02, 0x00, 0x50, 'b', 'c', 'd',
+                             'e',  'f'};
+    uchar_t       buffer[32] = {'x'};
+    EXPECT_EQ(lz4_decompress(nullptr, buffer + 1, buffer + 32, block,
+                             block + sizeof(block)),
+              nullptr);
+    EXPECT_EQ(lz4_decompress(buffer, buffer + 1, buffer + 32, block,
+                             block + sizeof(block)),
+              buffer + 15);
+    EXPECT_EQ(std::string((char *)buffer, 15), "xaxaxaxaxabcdef");
+
+    // A block has to end with literals.
+    const uchar_t no_literals[] = {0x10, 'a', 0x01, 0x00};
+    EXPECT_EQ(lz4_decompress(nullptr, buffer, buffer + 32, no_literals,
+                             no_literals + sizeof(no_literals)),
+              nullptr);
+
+    lz4_state_t state;
+    ASSERT_TRUE(lz4_init(&state, LZ4_LEVEL_FAST, nullptr));
+    std::vector<uchar_t> content = make_content(2000, 1);
+    std::vector<uchar_t> packed(lz4_bound(content.size()));
+    uchar_t *end = lz4_compress(&state, packed.data(),
+                                packed.data() + packed.size(), content.data(),
+                                content.data() + content.size());
+    lz4_free(&state);
+    ASSERT_NE(end, nullptr);
+
+    std::vector<uchar_t> unpacked(content.size());
+    for (uchar_t *cut = packed.data(); cut < end; ++cut)
+    {
+        EXPECT_NE(lz4_decompress(nullptr, unpacked.data(),
+                                 unpacked.data() + unpacked.size(),
+                                 packed.data(), cut),
+                  unpacked.data() + unpacked.size());
+    }
+
+    std::mt19937         rng(11);
+    std::vector<uchar_t> output(272);
+    for (int round = 0; round < 2000; ++round)
+    {
+        std::vector<uchar_t> noise(1 + rng() % 64);
+        for (uchar_t &byte : noise)
+        {
+            byte = (uchar_t)rng();
+        }
+        std::fill(output.begin(), output.end(), 0xA5);
+        uchar_t *out = lz4_decompress(nullptr, output.data(),
+                                      output.data() + 256, noise.data(),
+                                      noise.data() + noise.size());
+        EXPECT_TRUE(!out || out <= output.data() + 256);
+        for (usize_t i = 256; i < output.size(); ++i)
+        {
+            ASSERT_EQ(output[i], 0xA5) << round;
+        }
+    }
+}
+
+/**
+ * @test Test case for frames.
+ *
+ * This test round trips frames through the one-shot and the block-wise
+ * functions, decodes concatenated frames and a frame written by the
+ * reference lz4 library with linked blocks, checksums and a content size,
+ * and checks that damaged frames are rejected.
+ */
+TEST(lz4, frame)
+{
+    lz4_state_t state;
+    ASSERT_TRUE(lz4_init(&state, LZ4_LEVEL_FAST, nullptr));
+    for (usize_t size : {0u, 1u, 1000u, 262144u, 600000u})
+    {
+        std::vector<uchar_t> content = make_content(size, 1);
+        std::vector<uchar_t> packed(lz4_frame_bound(size) * 2);
+        uchar_t *end = lz4_frame_compress(&state, packed.data(),
+                                          packed.data() + packed.size() / 2,
+                                          content.data(),
+                                          content.data() + size);
+        ASSERT_NE(end, nullptr) << size;
+
+        // The block-wise functions write the same frame.
+        std::vector<uchar_t> pieces(packed.size() / 2);
+        uchar_t             *dest = lz4_frame_begin(pieces.data());
+        for (usize_t i = 0; i < size; i += LZ4_FRAME_BLOCK_SIZE)
+        {
+            usize_t count = std::min<usize_t>(size - i, LZ4_FRAME_BLOCK_SIZE);
+            dest = lz4_frame_block(&state, dest, content.data() + i,
+                                   content.data() + i + count);
+        }
+        dest = lz4_frame_end(dest, hash32(content.data(),
+                                          content.data() + size, 0));
+        EXPECT_EQ(std::vector<uchar_t>(pieces.data(), dest),
+                  std::vector<uchar_t>(packed.data(), end));
+
+        // Two frames back to back.
+        usize_t length = end - packed.data();
+        std::copy(packed.data(), end, end);
+        std::vector<uchar_t> unpacked(size + 1);
+        const uchar_t       *next = nullptr;
+        EXPECT_EQ(lz4_frame_decompress(unpacked.data(),
+                                       unpacked.data() + size, packed.data(),
+                                       end + length, &next),
+                  unpacked.data() + size);
+        EXPECT_EQ(next, end);
+        EXPECT_TRUE(std::equal(content.begin(), content.end(),
+                               unpacked.begin()));
+        EXPECT_EQ(lz4_frame_decompress(unpacked.data(),
+                                       unpacked.data() + size, next,
+                                       end + length, &next),
+                  unpacked.data() + size);
+        EXPECT_EQ(next, end + length);
+
+        EXPECT_EQ(lz4_frame_decompress(unpacked.data(),
+                                       unpacked.data() + size, packed.data(),
+                                       end - 1, nullptr),
+                  nullptr);
+        end[-1] ^= 1;
+        EXPECT_EQ(lz4_frame_decompress(unpacked.data(),
+                                       unpacked.data() + size, packed.data(),
+                                       end, nullptr),
+                  nullptr);
+    }
+    lz4_free(&state);
+
+    const std::string text = "The quick brown fox jumps over the lazy dog. "
+                             "The quick brown fox jumps over the lazy dog. "
+                             "The lazy dog sleeps while the quick brown fox "
+                             "jumps.";
+    const uchar_t reference[] = {
+        0x04, 0x22, 0x4D, 0x18, 0x7C, 0x40, 0x8E, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x51, 0x4E, 0x00, 0x00, 0x00, 0xFF, 0x1E, 0x54,
+        0x68, 0x65, 0x20, 0x71, 0x75, 0x69, 0x63, 0x6B, 0x20, 0x62, 0x72,
+        0x6F, 0x77, 0x6E, 0x20, 0x66, 0x6F, 0x78, 0x20, 0x6A, 0x75, 0x6D,
+        0x70, 0x73, 0x20, 0x6F, 0x76, 0x65, 0x72, 0x20, 0x74, 0x68, 0x65,
+        0x20, 0x6C, 0x61, 0x7A, 0x79, 0x20, 0x64, 0x6F, 0x67, 0x2E, 0x20,
+        0x2D, 0x00, 0x1E, 0x04, 0x3B, 0x00, 0xD1, 0x20, 0x73, 0x6C, 0x65,
+        0x65, 0x70, 0x73, 0x20, 0x77, 0x68, 0x69, 0x6C, 0x65, 0x55, 0x00,
+        0x0D, 0x74, 0x00, 0x50, 0x75, 0x6D, 0x70, 0x73, 0x2E, 0x0D, 0x5E,
+        0x05, 0x13, 0x00, 0x00, 0x00, 0x00, 0xE4, 0x26, 0x0C, 0xBC};
+    std::vector<uchar_t> unpacked(256);
+    uchar_t *out = lz4_frame_decompress(unpacked.data(),
+                                        unpacked.data() + unpacked.size(),
+                                        reference,
+                                        reference + sizeof(reference), nullptr);
+    ASSERT_NE(out, nullptr);
+    EXPECT_EQ(std::string((char *)unpacked.data(), (char *)out), text);
+
+    // The declared content size has to match, with a valid header.
+    uchar_t damaged[sizeof(reference)];
+    std::copy(reference, reference + sizeof(reference), damaged);
+    damaged[6] ^= 1;
+    damaged[14] = (uchar_t)(hash32(damaged + 4, damaged + 14, 0) >> 8);
+    EXPECT_EQ(lz4_frame_decompress(unpacked.data(),
+                                   unpacked.data() + unpacked.size(), damaged,
+                                   damaged + sizeof(damaged), nullptr),
+              nullptr);
+}
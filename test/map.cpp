@@ -0,0 +1,233 @@
+#include <array>
+#include <gtest/gtest.h>
+#include <liquid/arena.h>
+#include <liquid/map.h>
+#include <random>
+#include <set>
+#include <unordered_map>
+
+/**
+ * @test Test case for inserting, finding and erasing keys.
+ *
+ * This test runs a random sequence of operations against the map and a
+ * standard unordered map and verifies that both always agree.
+ */
+TEST(map, matches_reference)
+{
+    map_t map;
+    MAP_INIT(&map, ullong_t, int, nullptr);
+
+    std::unordered_map<ullong_t, int> reference;
+    std::mt19937_64                   rng(11);
+
+    for (int i = 0; i < 200000; ++i)
+    {
+        ullong_t key = rng() % 5000;
+        switch (rng() % 3)
+        {
+        case 0:
+            ASSERT_NE(map_insert(&map, &key, &i), nullptr);
+            reference[key] = i;
+            break;
+        case 1:
+            EXPECT_EQ(map_erase(&map, &key), reference.erase(key) == 1);
+            break;
+        default:
+            int *value = (int *)map_find(&map, &key);
+            auto it = reference.find(key);
+            ASSERT_EQ(value != nullptr, it != reference.end()) << key;
+            if (value)
+            {
+                EXPECT_EQ(*value, it->second);
+            }
+            break;
+        }
+        ASSERT_EQ(map.size, reference.size());
+    }
+
+    map_free(&map);
+}
+
+/**
+ * @test Test case for emplacing keys.
+ *
+ * This test checks that emplacing reports whether the key was new and
+ * returns the existing value otherwise.
+ */
+TEST(map, emplace)
+{
+    map_t map;
+    MAP_INIT(&map, int, int, nullptr);
+
+    uint_t inserted = 0;
+    int    key = 5;
+    int *value = (int *)map_emplace(&map, &key, &inserted);
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(inserted, 1u);
+    *value = 50;
+
+    value = (int *)map_emplace(&map, &key, &inserted);
+    EXPECT_EQ(inserted, 0u);
+    EXPECT_EQ(*value, 50);
+    EXPECT_EQ(map.size, 1u);
+
+    map_free(&map);
+}
+
+/**
+ * @test Test case for iterating over a map.
+ *
+ * This test verifies that iteration visits every entry exactly once and
+ * that erasing the current entry during the iteration is allowed.
+ */
+TEST(map, iteration)
+{
+    map_t map;
+    MAP_INIT(&map, int, int, nullptr);
+
+    usize_t iter = 0;
+    EXPECT_EQ(map_next(&map, &iter), nullptr);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        int value = i * 2;
+        map_insert(&map, &i, &value);
+    }
+
+    std::set<int> seen;
+    iter = 0;
+    for (void *key = map_next(&map, &iter); key; key = map_next(&map, &iter))
+    {
+        int k = *(int *)key;
+        EXPECT_EQ(*(int *)MAP_VALUE(&map, key), k * 2);
+        EXPECT_TRUE(seen.insert(k).second);
+        if (k % 2)
+        {
+            EXPECT_TRUE(map_erase(&map, key));
+        }
+    }
+    EXPECT_EQ(seen.size(), 1000u);
+    EXPECT_EQ(map.size, 500u);
+
+    usize_t count = 0;
+    iter = 0;
+    for (void *key = map_next(&map, &iter); key; key = map_next(&map, &iter))
+    {
+        EXPECT_EQ(*(int *)key % 2, 0);
+        ++count;
+    }
+    EXPECT_EQ(count, 500u);
+
+    map_free(&map);
+}
+
+/**
+ * @test Test case for reserving and rehashing.
+ *
+ * This test checks that a reserved map does not reallocate while it is
+ * filled, that rehashing shrinks the storage, and that clearing keeps it.
+ */
+TEST(map, reserve_and_rehash)
+{
+    map_t map;
+    MAP_INIT(&map, int, int, nullptr);
+
+    ASSERT_TRUE(map_reserve(&map, 10000));
+    const uchar_t *ctrl = map.ctrl;
+    usize_t        capacity = map.capacity;
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        ASSERT_NE(map_insert(&map, &i, &i), nullptr);
+    }
+    EXPECT_EQ(map.ctrl, ctrl);
+    EXPECT_EQ(map.capacity, capacity);
+
+    for (int i = 100; i < 10000; ++i)
+    {
+        ASSERT_TRUE(map_erase(&map, &i));
+    }
+    ASSERT_TRUE(map_rehash(&map, 0));
+    EXPECT_LT(map.capacity, capacity);
+    for (int i = 0; i < 100; ++i)
+    {
+        ASSERT_NE(map_find(&map, &i), nullptr);
+        EXPECT_EQ(*(int *)map_find(&map, &i), i);
+    }
+
+    map_clear(&map);
+    EXPECT_EQ(map.size, 0u);
+    int key = 1;
+    EXPECT_EQ(map_find(&map, &key), nullptr);
+
+    map_free(&map);
+    EXPECT_EQ(map.capacity, 0u);
+}
+
+/**
+ * @test Test case for churn of insertions and erasures.
+ *
+ * This test repeatedly inserts and erases keys while the number of entries
+ * stays small and verifies that deleted slots do not make the map grow.
+ */
+TEST(map, churn_keeps_capacity)
+{
+    map_t map;
+    MAP_INIT(&map, int, int, nullptr);
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        ASSERT_NE(map_insert(&map, &i, &i), nullptr);
+        if (i >= 50)
+        {
+            int old = i - 50;
+            ASSERT_TRUE(map_erase(&map, &old));
+        }
+    }
+    EXPECT_EQ(map.size, 50u);
+    EXPECT_LE(map.capacity, 128u);
+
+    map_free(&map);
+}
+
+/**
+ * @test Test case for byte keys of odd sizes and sets.
+ *
+ * This test uses keys that are not a multiple of a word and a map without
+ * values, stored in an arena.
+ */
+TEST(map, byte_keys_in_arena)
+{
+    arena_t arena;
+    arena_init(&arena, nullptr, 64 * 1024);
+
+    using key_t = std::array<uchar_t, 13>;
+    map_t set;
+    map_init(&set, sizeof(key_t), 0, &arena.allocator);
+    EXPECT_EQ(set.slot_size, 13u);
+
+    for (int i = 0; i < 3000; ++i)
+    {
+        key_t key{};
+        key[0] = (uchar_t)i;
+        key[7] = (uchar_t)(i >> 8);
+        key[12] = 0x5A;
+        uint_t inserted = 0;
+        ASSERT_NE(map_emplace(&set, key.data(), &inserted), nullptr);
+        EXPECT_EQ(inserted, 1u);
+    }
+
+    for (int i = 0; i < 3000; ++i)
+    {
+        key_t key{};
+        key[0] = (uchar_t)i;
+        key[7] = (uchar_t)(i >> 8);
+        key[12] = 0x5A;
+        EXPECT_NE(map_find(&set, key.data()), nullptr);
+        key[12] ^= 0x80;
+        EXPECT_EQ(map_find(&set, key.data()), nullptr);
+    }
+
+    map_free(&set);
+    arena_free(&arena);
+}
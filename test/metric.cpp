@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <liquid/array-raw.h>
+#include <liquid/exception.h>
+#include <liquid/fs.h>
+#include <liquid/metric.h>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @test Test case for counters.
+ *
+ * This test adds to a counter from several threads at once and checks
+ * that no addition is lost, then resets it.
+ */
+TEST(metric, counter)
+{
+    metric_counter_t counter;
+    metric_counter_init(&counter, "test.counter");
+    EXPECT_EQ(metric_counter_read(&counter), 0u);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&counter, t] {
+            for (int i = 0; i < 100000; ++i)
+            {
+                metric_counter_add(&counter, (ullong_t)t + 1);
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(metric_counter_read(&counter), 3600000u);
+
+    metric_counter_reset(&counter);
+    EXPECT_EQ(metric_counter_read(&counter), 0u);
+}
+
+/**
+ * @test Test case for histograms.
+ *
+ * This test records values of every magnitude, checks the percentiles
+ * against the exact ones within the precision of the buckets, and checks
+ * that merging two halves gives the same statistics as the whole.
+ */
+TEST(metric, histogram)
+{
+    metric_histogram_t whole, low, high;
+    metric_histogram_init(&whole, "test.whole");
+    metric_histogram_init(&low, "test.low");
+    metric_histogram_init(&high, "test.high");
+    EXPECT_EQ(metric_histogram_percentile(&whole, 50.0), 0u);
+
+    std::mt19937_64       rng(44);
+    std::vector<ullong_t> values;
+    for (int i = 0; i < 100000; ++i)
+    {
+        values.push_back(rng() >> (rng() % 64));
+    }
+    values.push_back(0);
+    values.push_back(~0ull);
+    for (usize_t i = 0; i < values.size(); ++i)
+    {
+        metric_histogram_record(&whole, values[i]);
+        metric_histogram_record(i % 2 ? &high : &low, values[i]);
+    }
+    std::sort(values.begin(), values.end());
+
+    for (double percent : {1.0, 25.0, 50.0, 90.0, 99.0, 99.9, 100.0})
+    {
+        usize_t  rank = (usize_t)std::ceil(percent / 100.0 * values.size());
+        ullong_t exact = values[std::max<usize_t>(rank, 1) - 1];
+        ullong_t reported = metric_histogram_percentile(&whole, percent);
+        EXPECT_GE(reported, exact);
+        EXPECT_LE(reported - exact, exact / METRIC_HISTOGRAM_SUB);
+    }
+
+    metric_histogram_merge(&low, &high);
+    metric_summary_t merged, summary;
+    metric_histogram_summarize(&low, &merged);
+    metric_histogram_summarize(&whole, &summary);
+    EXPECT_EQ(summary.count, values.size());
+    EXPECT_EQ(summary.min, 0u);
+    EXPECT_EQ(summary.max, ~0ull);
+    EXPECT_EQ(merged.count, summary.count);
+    EXPECT_EQ(merged.sum, summary.sum);
+    EXPECT_EQ(merged.min, summary.min);
+    EXPECT_EQ(merged.max, summary.max);
+    EXPECT_EQ(merged.p50, summary.p50);
+    EXPECT_EQ(merged.p999, summary.p999);
+
+    metric_histogram_reset(&whole);
+    metric_histogram_record(&whole, 1000);
+    metric_histogram_summarize(&whole, &summary);
+    EXPECT_EQ(summary.count, 1u);
+    EXPECT_EQ(summary.min, 1000u);
+    EXPECT_EQ(summary.p50, 1000u);
+}
+
+/**
+ * @test Test case for timers.
+ *
+ * This test times a sleep with a scoped timer and checks the recorded
+ * duration against the steady clock of the standard library.
+ */
+TEST(metric, timer)
+{
+    metric_histogram_t histogram;
+    metric_histogram_init(&histogram, "test.timer");
+
+    auto start = std::chrono::steady_clock::now();
+    METRIC_SCOPE(&histogram)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    metric_summary_t summary;
+    metric_histogram_summarize(&histogram, &summary);
+    EXPECT_EQ(summary.count, 1u);
+    EXPECT_GE(summary.max, 19000000u);
+    EXPECT_LE(summary.max, (ullong_t)elapsed.count() * 11 / 10);
+
+    metric_timer_t timer = metric_timer_start(&histogram);
+    EXPECT_LT(metric_timer_stop(&timer), 1000000000u);
+    EXPECT_FALSE(timer.running);
+}
+
+/**
+ * @test Test case for the exports.
+ *
+ * This test registers a counter and a histogram and checks that they
+ * appear in the text and JSON exports, along with the metrics of the
+ * library, until they are unregistered.
+ */
+TEST(metric, export)
+{
+    metric_counter_t   counter;
+    metric_histogram_t histogram;
+    metric_counter_init(&counter, "test.export\"count");
+    metric_histogram_init(&histogram, "test.export.ns");
+    metric_register(&counter.base);
+    metric_register(&histogram.base);
+    metric_counter_add(&counter, 42);
+    metric_histogram_record(&histogram, 7);
+
+    str_builder_t builder;
+    str_builder_init(&builder, nullptr);
+    ASSERT_TRUE(metric_export_text(&builder));
+    std::string text = STR_BUILDER_DATA(&builder);
+    EXPECT_NE(text.find("test.export\"count 42\n"), std::string::npos);
+    EXPECT_NE(text.find("test.export.ns count=1 sum=7 min=7 max=7 p50=7"),
+              std::string::npos);
+    EXPECT_NE(text.find("liquid.fs.read_ns count="), std::string::npos);
+
+    str_builder_clear(&builder);
+    ASSERT_TRUE(metric_export_json(&builder));
+    std::string json = STR_BUILDER_DATA(&builder);
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.back(), '}');
+    EXPECT_NE(json.find("\"test.export\\\"count\":42"), std::string::npos);
+    EXPECT_NE(json.find("\"test.export.ns\":{\"count\":1,\"sum\":7,"),
+              std::string::npos);
+    EXPECT_NE(json.find("\"liquid.array.copy_bytes\":"), std::string::npos);
+
+    metric_unregister(&counter.base);
+    metric_unregister(&histogram.base);
+    str_builder_clear(&builder);
+    ASSERT_TRUE(metric_export_text(&builder));
+    EXPECT_EQ(std::string(STR_BUILDER_DATA(&builder)).find("test.export"),
+              std::string::npos);
+    str_builder_free(&builder);
+}
+
+/**
+ * @test Test case for the metrics of the library.
+ *
+ * This test copies, raises an exception and writes and reads a file, and
+ * checks the counters of the library when it is built with them.
+ */
+TEST(metric, library)
+{
+#if !defined(LIQUID_METRICS)
+    GTEST_SKIP() << "the library is built without LIQUID_METRICS";
+#endif
+    ullong_t copied = metric_counter_read(&metric_array_copy_bytes);
+    ullong_t raised = metric_counter_read(&metric_exceptions);
+    ullong_t reads = metric_counter_read(&metric_fs_reads);
+    ullong_t read_bytes = metric_counter_read(&metric_fs_read_bytes);
+    ullong_t writes = metric_counter_read(&metric_fs_writes);
+    ullong_t written = metric_counter_read(&metric_fs_write_bytes);
+
+    char buffer[100] = "instrumented";
+    array_raw_copy(buffer + 50, buffer, 13);
+    EXPECT_EQ(array_raw_copy(buffer, buffer, 1), nullptr);
+
+    std::string path = testing::TempDir() + "liquid_metric_file";
+    fs_handle_t handle;
+    ASSERT_TRUE(fs_open(&handle, path.c_str(),
+                        FS_WRITE | FS_CREATE | FS_TRUNCATE));
+    EXPECT_TRUE(fs_write(handle, buffer, 40));
+    fs_close(handle);
+    ASSERT_TRUE(fs_open(&handle, path.c_str(), FS_READ));
+    usize_t count;
+    EXPECT_TRUE(fs_read(handle, buffer, sizeof(buffer), &count));
+    fs_close(handle);
+    remove(path.c_str());
+
+    EXPECT_EQ(metric_counter_read(&metric_array_copy_bytes) - copied, 13u);
+    EXPECT_EQ(metric_counter_read(&metric_exceptions) - raised, 1u);
+    EXPECT_EQ(metric_counter_read(&metric_fs_reads) - reads, 1u);
+    EXPECT_EQ(metric_counter_read(&metric_fs_read_bytes) - read_bytes, 40u);
+    EXPECT_EQ(metric_counter_read(&metric_fs_writes) - writes, 1u);
+    EXPECT_EQ(metric_counter_read(&metric_fs_write_bytes) - written, 40u);
+
+    metric_summary_t summary;
+    metric_histogram_summarize(&metric_fs_read_ns, &summary);
+    EXPECT_GE(summary.count, 1u);
+}
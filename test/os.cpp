@@ -1,5 +1,8 @@
+#include <chrono>
+#include <cstdio>
 #include <gtest/gtest.h>
 #include <liquid/os.h>
+#include <vector>
 
 /**
  * @brief Test case for setting the last error code.
@@ -18,4 +21,78 @@ TEST(os, set_last_error_code)
 
     set_last_error_code(14);
     EXPECT_EQ(last_error_code(), 14);
-}
\ No newline at end of file
+}
+/**
+ * @test Test case for the resources of the process.
+ *
+ * This test touches memory, opens a file and keeps the CPU busy, and
+ * checks that the usage of the process and the CPU time of the thread
+ * grow accordingly.
+ */
+TEST(os, usage)
+{
+    os_usage_t before, after;
+    usize_t    files_before, files_after;
+    ullong_t   cpu_before, cpu_after;
+    ASSERT_TRUE(os_usage_read(&before));
+    ASSERT_TRUE(os_open_files(&files_before));
+    ASSERT_TRUE(os_thread_cpu_time(&cpu_before));
+    EXPECT_GT(before.rss, 0u);
+    EXPECT_GE(before.peak_rss, before.rss);
+
+    const usize_t      size = 32 << 20;
+    std::vector<char> memory(size);
+    for (usize_t i = 0; i < size; i += 4096)
+    {
+        memory[i] = (char)i;
+    }
+    std::FILE *file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+
+    volatile ullong_t sum = 0;
+    auto              start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start
+           < std::chrono::milliseconds(50))
+    {
+        sum = sum + 1;
+    }
+
+    ASSERT_TRUE(os_usage_read(&after));
+    ASSERT_TRUE(os_open_files(&files_after));
+    ASSERT_TRUE(os_thread_cpu_time(&cpu_after));
+    std::fclose(file);
+
+    EXPECT_GE(after.rss, before.rss + size / 2);
+    EXPECT_GE(after.peak_rss, after.rss);
+    EXPECT_GE(after.minor_faults + after.major_faults,
+              before.minor_faults + before.major_faults + size / 4096 / 2);
+    EXPECT_GE(after.user_ns + after.system_ns,
+              before.user_ns + before.system_ns + 20000000);
+    EXPECT_GE(cpu_after, cpu_before + 20000000);
+    EXPECT_EQ(files_after, files_before + 1);
+}
+
+/**
+ * @test Test case for the load of the system.
+ *
+ * This test checks that the memory of the system is consistent and that
+ * the pressures, when known, are percentages.
+ */
+TEST(os, load)
+{
+    os_load_t load;
+    ASSERT_TRUE(os_load_read(&load));
+    EXPECT_GT(load.memory_total, 0u);
+    EXPECT_GT(load.memory_available, 0u);
+    EXPECT_LE(load.memory_available, load.memory_total);
+    for (double average : load.averages)
+    {
+        EXPECT_GE(average, 0.0);
+    }
+    for (double pressure :
+         {load.cpu_pressure, load.memory_pressure, load.io_pressure})
+    {
+        EXPECT_GE(pressure, 0.0);
+        EXPECT_LE(pressure, 100.0);
+    }
+}
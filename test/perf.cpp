@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <liquid/perf.h>
+#include <vector>
+
+/**
+ * @test Test case for the counters.
+ *
+ * This test counts a loop of known work where counters can be opened, and
+ * checks that the group reads as zeros where they cannot.
+ */
+TEST(perf, counters)
+{
+    perf_t        perf;
+    perf_sample_t start, end, delta;
+    bool          opened = perf_open(&perf);
+    perf_read(&perf, &start);
+
+    std::vector<ullong_t> values(1 << 20);
+    volatile ullong_t     sum = 0;
+    for (int round = 0; round < 10; ++round)
+    {
+        for (usize_t i = 0; i < values.size(); ++i)
+        {
+            values[i] += i * round;
+            sum = sum + values[i];
+        }
+    }
+    perf_read(&perf, &end);
+    perf_sample_delta(&start, &end, &delta);
+    perf_close(&perf);
+
+    if (!opened)
+    {
+        EXPECT_EQ(delta.valid, 0u);
+        for (ullong_t value : delta.values)
+        {
+            EXPECT_EQ(value, 0u);
+        }
+        EXPECT_EQ(perf_ipc(&delta), 0.0);
+        EXPECT_EQ(perf_per_unit(&delta, PERF_CACHE_MISSES, 1000.0), 0.0);
+        GTEST_SKIP() << "no hardware counters can be opened";
+    }
+    if (delta.valid & (1u << PERF_INSTRUCTIONS))
+    {
+        EXPECT_GT(delta.values[PERF_INSTRUCTIONS], 10u << 20);
+    }
+    if (delta.valid & (1u << PERF_CYCLES | 1u << PERF_INSTRUCTIONS))
+    {
+        EXPECT_GT(perf_ipc(&delta), 0.0);
+    }
+}
+
+/**
+ * @test Test case for the arithmetic on samples.
+ *
+ * This test computes differences and ratios of samples with some counters
+ * missing.
+ */
+TEST(perf, samples)
+{
+    perf_sample_t start = {{100, 200, 5, 0, 0}, 0x07};
+    perf_sample_t end = {{1100, 2700, 4, 9, 0}, 0x0F};
+    perf_sample_t delta;
+    perf_sample_delta(&start, &end, &delta);
+    EXPECT_EQ(delta.valid, 0x07u);
+    EXPECT_EQ(delta.values[PERF_CYCLES], 1000u);
+    EXPECT_EQ(delta.values[PERF_INSTRUCTIONS], 2500u);
+    EXPECT_EQ(delta.values[PERF_CACHE_MISSES], 0u);
+    EXPECT_EQ(delta.values[PERF_BRANCH_MISSES], 0u);
+    EXPECT_DOUBLE_EQ(perf_ipc(&delta), 2.5);
+    EXPECT_DOUBLE_EQ(perf_per_unit(&delta, PERF_CYCLES, 500.0), 2.0);
+    EXPECT_EQ(perf_per_unit(&delta, PERF_BRANCH_MISSES, 500.0), 0.0);
+    EXPECT_EQ(perf_per_unit(&delta, PERF_CYCLES, 0.0), 0.0);
+}
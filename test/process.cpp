@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+#include <liquid/process.h>
+#include <string>
+
+#if defined(LIQUID_TARGET_OS_POSIX_LIKE)
+    #include <cerrno>
+    #include <csignal>
+#endif
+#if defined(LIQUID_TARGET_OS_LINUX)
+    #include <liquid/event.h>
+#endif
+
+/**
+ * @brief Reads the end of a pipe of a child until the child closes it.
+ * @param handle The end of the pipe.
+ * @return What was read.
+ */
+static std::string
+read_all(fs_handle_t handle)
+{
+    std::string text;
+    char        buffer[256];
+    usize_t     size;
+    while (fs_read(handle, buffer, sizeof(buffer), &size) && size)
+    {
+        text.append(buffer, size);
+    }
+    return text;
+}
+
+/**
+ * @test Test case for a program that does not exist.
+ *
+ * This test checks that spawning a program that is not in the PATH fails
+ * and leaves no pipes open.
+ */
+TEST(process, missing)
+{
+    const char_t     *argv[] = {"liquid-no-such-program", nullptr};
+    process_options_t options = {
+        argv, nullptr, nullptr, {PROCESS_PIPE, PROCESS_PIPE, PROCESS_NULL},
+        0};
+    process_t process;
+    EXPECT_FALSE(process_spawn(&process, &options));
+#if defined(LIQUID_TARGET_OS_POSIX_LIKE)
+    EXPECT_EQ(errno, ENOENT);
+#endif
+    EXPECT_EQ(process.stdio[PROCESS_STDIN], FS_INVALID_HANDLE);
+    EXPECT_EQ(process.stdio[PROCESS_STDOUT], FS_INVALID_HANDLE);
+}
+
+#if defined(LIQUID_TARGET_OS_POSIX_LIKE)
+/**
+ * @test Test case for the pipes of a child.
+ *
+ * This test writes to the standard input of a shell and reads its output
+ * and error apart, and checks its exit code.
+ */
+TEST(process, pipes)
+{
+    const char_t *argv[] = {
+        "sh", "-c", "read line; echo \"out $line\"; echo err >&2; exit 3",
+        nullptr};
+    process_options_t options = {
+        argv, nullptr, nullptr, {PROCESS_PIPE, PROCESS_PIPE, PROCESS_PIPE},
+        0};
+    process_t process;
+    ASSERT_TRUE(process_spawn(&process, &options));
+    EXPECT_GT(process.id, 0);
+
+    EXPECT_TRUE(fs_write(process.stdio[PROCESS_STDIN], "in\n", 3));
+    process_close_pipe(&process, PROCESS_STDIN);
+    EXPECT_EQ(read_all(process.stdio[PROCESS_STDOUT]), "out in\n");
+    EXPECT_EQ(read_all(process.stdio[PROCESS_STDERR]), "err\n");
+
+    ASSERT_TRUE(process_wait(&process, -1));
+    EXPECT_EQ(process.status, 3);
+    EXPECT_TRUE(process_wait(&process, 0));
+    process_close(&process);
+}
+
+/**
+ * @test Test case for the environment and the directory of a child.
+ *
+ * This test spawns a shell with an environment of its own, in another
+ * directory and with its input from the null device.
+ */
+TEST(process, options)
+{
+    const char_t *argv[] = {
+        "sh", "-c", "cat; echo \"$LIQUID_VALUE $PWD ${HOME:-none}\"",
+        nullptr};
+    const char_t     *env[] = {"LIQUID_VALUE=42", nullptr};
+    process_options_t options = {
+        argv, env, "/", {PROCESS_NULL, PROCESS_PIPE, PROCESS_INHERIT}, 0};
+    process_t process;
+    ASSERT_TRUE(process_spawn(&process, &options));
+    EXPECT_EQ(process.stdio[PROCESS_STDIN], FS_INVALID_HANDLE);
+    EXPECT_EQ(read_all(process.stdio[PROCESS_STDOUT]), "42 / none\n");
+    ASSERT_TRUE(process_wait(&process, -1));
+    EXPECT_EQ(process.status, 0);
+    process_close(&process);
+}
+
+/**
+ * @test Test case for timeouts and signals.
+ *
+ * This test checks that waiting for a child that sleeps times out, and
+ * that the child is terminated by process_kill.
+ */
+TEST(process, kill)
+{
+    const char_t     *argv[] = {"sleep", "10", nullptr};
+    process_options_t options = {
+        argv, nullptr, nullptr, {PROCESS_NULL, PROCESS_NULL, PROCESS_NULL},
+        0};
+    for (bool force : {false, true})
+    {
+        process_t process;
+        ASSERT_TRUE(process_spawn(&process, &options));
+        errno = 0;
+        EXPECT_FALSE(process_wait(&process, 0));
+        EXPECT_EQ(errno, ETIMEDOUT);
+        EXPECT_FALSE(process_wait(&process, 20));
+        EXPECT_EQ(errno, ETIMEDOUT);
+
+        ASSERT_TRUE(process_kill(&process, force));
+        ASSERT_TRUE(process_wait(&process, 5000));
+        EXPECT_EQ(process.status, force ? -SIGKILL : -SIGTERM);
+        EXPECT_TRUE(process_kill(&process, true));
+        process_close(&process);
+    }
+}
+#endif
+
+#if defined(LIQUID_TARGET_OS_LINUX)
+/**
+ * @brief The state of a child watched by a loop.
+ */
+struct watched
+{
+    process_t   process;        ///< The child.
+    std::string output;         ///< What the child wrote.
+    bool        hangup = false; ///< Whether the output ended.
+    bool        exited = false; ///< Whether the child exited.
+};
+
+/**
+ * @brief Drains the output of a child.
+ * @param loop The loop.
+ * @param source The source of the output.
+ * @param event The events.
+ */
+static void
+on_output(event_loop_t *loop, event_source_t *source, const event_t *event)
+{
+    watched *child = static_cast<watched *>(source->data);
+    char     buffer[256];
+    usize_t  size;
+    bool     ok;
+    (void)event;
+    while ((ok = fs_read(source->handle, buffer, sizeof(buffer), &size))
+           && size)
+    {
+        child->output.append(buffer, size);
+    }
+    if (ok || errno != EAGAIN)
+    {
+        child->hangup = true;
+        event_loop_remove(loop, source);
+    }
+}
+
+/**
+ * @brief Collects a child once its pidfd is readable.
+ * @param loop The loop.
+ * @param source The source of the pidfd.
+ * @param event The events.
+ */
+static void
+on_child_exit(event_loop_t *loop, event_source_t *source,
+              const event_t *event)
+{
+    watched *child = static_cast<watched *>(source->data);
+    EXPECT_TRUE(event->events & EVENT_READ);
+    child->exited = process_wait(&child->process, 0);
+    event_loop_remove(loop, source);
+}
+
+/**
+ * @test Test case for a child watched by an event loop.
+ *
+ * This test watches the non-blocking output of a child and its pidfd, and
+ * checks that the loop sees all of the output and the exit.
+ */
+TEST(process, event)
+{
+    const char_t *argv[] = {"sh", "-c", "echo hello; sleep 0.05; exit 7",
+                            nullptr};
+    process_options_t options = {
+        argv, nullptr, nullptr, {PROCESS_NULL, PROCESS_PIPE, PROCESS_NULL},
+        PROCESS_ASYNC};
+    watched child;
+    ASSERT_TRUE(process_spawn(&child.process, &options));
+    ASSERT_NE(child.process.handle, FS_INVALID_HANDLE);
+
+    event_loop_t   loop;
+    event_source_t output = {on_output, &child,
+                             child.process.stdio[PROCESS_STDOUT], EVENT_READ};
+    event_source_t ended = {on_child_exit, &child, child.process.handle,
+                            EVENT_READ};
+    ASSERT_TRUE(event_loop_init(&loop, nullptr));
+    ASSERT_TRUE(event_loop_add(&loop, &output));
+    ASSERT_TRUE(event_loop_add(&loop, &ended));
+
+    ullong_t start = event_now();
+    while ((!child.hangup || !child.exited) && event_now() - start < 5000)
+    {
+        ASSERT_TRUE(event_loop_run_once(&loop, 100));
+    }
+    EXPECT_EQ(child.output, "hello\n");
+    EXPECT_TRUE(child.exited);
+    EXPECT_EQ(child.process.status, 7);
+
+    event_loop_free(&loop);
+    process_close(&child.process);
+}
+#endif
@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+#include <liquid/serial.h>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Encodes a value byte by byte as the reference for the encoders.
+ */
+static std::vector<uchar_t>
+reference_varint(ullong_t value)
+{
+    std::vector<uchar_t> bytes;
+    do
+    {
+        uchar_t byte = value & 0x7F;
+        value >>= 7;
+        bytes.push_back(value ? byte | 0x80 : byte);
+    } while (value);
+    return bytes;
+}
+
+/**
+ * @brief Draws values whose encoded sizes cover every length.
+ */
+static std::vector<ullong_t>
+sample_values(std::mt19937_64 &rng, usize_t count, uint_t max_bits)
+{
+    std::vector<ullong_t> values(count);
+    for (ullong_t &value : values)
+    {
+        uint_t bits = (uint_t)(rng() % (max_bits + 1));
+        value = bits ? rng() >> (64 - bits) : 0;
+    }
+    return values;
+}
+
+/**
+ * @test Test case for loading and storing fixed-width values.
+ */
+TEST(serial, fixed_width)
+{
+    uchar_t buffer[9] = {0};
+    serial_store_le16(buffer + 1, 0x1234);
+    EXPECT_EQ(buffer[1], 0x34);
+    EXPECT_EQ(buffer[2], 0x12);
+    EXPECT_EQ(serial_load_le16(buffer + 1), 0x1234);
+    EXPECT_EQ(serial_load_be16(buffer + 1), 0x3412);
+
+    serial_store_be32(buffer + 1, 0x01020304u);
+    EXPECT_EQ(buffer[1], 0x01);
+    EXPECT_EQ(buffer[4], 0x04);
+    EXPECT_EQ(serial_load_be32(buffer + 1), 0x01020304u);
+    EXPECT_EQ(serial_load_le32(buffer + 1), 0x04030201u);
+
+    serial_store_le64(buffer + 1, 0x0102030405060708ull);
+    EXPECT_EQ(buffer[1], 0x08);
+    EXPECT_EQ(buffer[8], 0x01);
+    EXPECT_EQ(serial_load_le64(buffer + 1), 0x0102030405060708ull);
+    serial_store_be64(buffer + 1, 0x0102030405060708ull);
+    EXPECT_EQ(buffer[1], 0x01);
+    EXPECT_EQ(serial_load_be64(buffer + 1), 0x0102030405060708ull);
+}
+
+/**
+ * @test Test case for zigzag encoding.
+ */
+TEST(serial, zigzag)
+{
+    EXPECT_EQ(serial_zigzag32(0), 0u);
+    EXPECT_EQ(serial_zigzag32(-1), 1u);
+    EXPECT_EQ(serial_zigzag32(1), 2u);
+    EXPECT_EQ(serial_zigzag32(LIQUID_SINT_MAX), LIQUID_UINT_MAX - 1);
+    EXPECT_EQ(serial_zigzag32(LIQUID_SINT_MIN), LIQUID_UINT_MAX);
+    EXPECT_EQ(serial_zigzag64(LIQUID_SLLONG_MIN), LIQUID_ULLONG_MAX);
+
+    for (sllong_t value : {0ll, 1ll, -1ll, 63ll, -64ll, LIQUID_SLLONG_MAX,
+                           LIQUID_SLLONG_MIN, -1234567890123ll})
+    {
+        EXPECT_EQ(serial_unzigzag64(serial_zigzag64(value)), value);
+        EXPECT_EQ(serial_unzigzag32(serial_zigzag32((sint_t)value)),
+                  (sint_t)value);
+    }
+}
+
+/**
+ * @test Test case for encoding and decoding single varints.
+ *
+ * This test compares the encoders with a byte by byte reference and
+ * decodes every value both with and without bytes following it, which
+ * selects the word and the byte decoder.
+ */
+TEST(serial, varint)
+{
+    std::mt19937_64       rng(23);
+    std::vector<ullong_t> values = sample_values(rng, 2000, 64);
+    values.push_back(LIQUID_ULLONG_MAX);
+
+    for (ullong_t value : values)
+    {
+        std::vector<uchar_t> expected = reference_varint(value);
+        uchar_t              buffer[SERIAL_VARINT_MAX64 + 8] = {0};
+        uchar_t             *end = serial_varint_encode64(buffer, value);
+        ASSERT_EQ((usize_t)(end - buffer), expected.size());
+        EXPECT_EQ(serial_varint_size64(value), expected.size());
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(), buffer));
+
+        ullong_t decoded = 0;
+        EXPECT_EQ(serial_varint_decode64(buffer, end, &decoded), end);
+        EXPECT_EQ(decoded, value);
+        decoded = 0;
+        EXPECT_EQ(serial_varint_decode64(buffer, buffer + sizeof(buffer),
+                                         &decoded),
+                  end);
+        EXPECT_EQ(decoded, value);
+        EXPECT_EQ(serial_varint_decode64(buffer, end - 1, &decoded), nullptr);
+
+        uint_t narrow = 0;
+        const uchar_t *next = serial_varint_decode32(buffer, end, &narrow);
+        EXPECT_EQ(next, value >> 32 ? nullptr : end);
+        if (next)
+        {
+            EXPECT_EQ(narrow, value);
+        }
+    }
+
+    // A tenth byte may only hold the most significant bit.
+    uchar_t  overlong[11] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                             0xFF, 0xFF, 0xFF, 0xFF, 0x02};
+    ullong_t decoded;
+    EXPECT_EQ(serial_varint_decode64(overlong, overlong + 10, &decoded),
+              nullptr);
+    overlong[9] = 0xFF;
+    EXPECT_EQ(serial_varint_decode64(overlong, overlong + 11, &decoded),
+              nullptr);
+}
+
+/**
+ * @test Test case for encoding and decoding arrays of varints.
+ *
+ * This test mixes runs of single-byte varints long enough for the vector
+ * decoder with longer varints and checks truncated buffers.
+ */
+TEST(serial, varint_array)
+{
+    std::mt19937_64 rng(29);
+    for (uint_t max_bits : {0u, 7u, 8u, 14u, 32u, 64u})
+    {
+        std::vector<ullong_t> values = sample_values(rng, 1000, max_bits);
+        // Insert long runs of small values between the random ones.
+        for (usize_t i = 100; i < 300; ++i)
+        {
+            values[i] = i % 128;
+        }
+
+        std::vector<uchar_t> buffer(values.size() * SERIAL_VARINT_MAX64);
+        uchar_t             *end = serial_varint_encode_array64(
+            buffer.data(), values.data(), values.size());
+
+        std::vector<ullong_t> decoded(values.size());
+        EXPECT_EQ(serial_varint_decode_array64(buffer.data(), end,
+                                               decoded.data(), values.size()),
+                  end);
+        EXPECT_EQ(decoded, values);
+        EXPECT_EQ(serial_varint_decode_array64(buffer.data(), end - 1,
+                                               decoded.data(), values.size()),
+                  nullptr);
+
+        if (max_bits > 32)
+        {
+            std::vector<uint_t> narrow(values.size());
+            EXPECT_EQ(serial_varint_decode_array32(buffer.data(), end,
+                                                   narrow.data(),
+                                                   narrow.size()),
+                      nullptr);
+            continue;
+        }
+
+        std::vector<uint_t> narrow(values.begin(), values.end());
+        std::vector<uchar_t> narrow_buffer(narrow.size()
+                                           * SERIAL_VARINT_MAX32);
+        uchar_t *narrow_end = serial_varint_encode_array32(
+            narrow_buffer.data(), narrow.data(), narrow.size());
+        ASSERT_EQ(narrow_end - narrow_buffer.data(), end - buffer.data());
+
+        std::vector<uint_t> narrow_decoded(narrow.size());
+        EXPECT_EQ(serial_varint_decode_array32(narrow_buffer.data(), narrow_end,
+                                               narrow_decoded.data(),
+                                               narrow.size()),
+                  narrow_end);
+        EXPECT_EQ(narrow_decoded, narrow);
+    }
+}
+
+/**
+ * @test Test case for malformed varint arrays.
+ *
+ * This test checks that blocks without a terminating byte, alone or after
+ * valid varints, are rejected by the array decoders instead of stalling
+ * them.
+ */
+TEST(serial, varint_array_malformed)
+{
+    std::vector<uchar_t> buffer(32, 0xFF);
+    std::vector<ullong_t> wide(16);
+    std::vector<uint_t>   narrow(16);
+    EXPECT_EQ(serial_varint_decode_array64(buffer.data(),
+                                           buffer.data() + buffer.size(),
+                                           wide.data(), wide.size()),
+              nullptr);
+    EXPECT_EQ(serial_varint_decode_array32(buffer.data(),
+                                           buffer.data() + buffer.size(),
+                                           narrow.data(), narrow.size()),
+              nullptr);
+
+    // The overlong varint follows values that the block decoder consumes.
+    buffer.insert(buffer.begin(), 20, 0x01);
+    wide.resize(40);
+    narrow.resize(40);
+    EXPECT_EQ(serial_varint_decode_array64(buffer.data(),
+                                           buffer.data() + buffer.size(),
+                                           wide.data(), wide.size()),
+              nullptr);
+    EXPECT_EQ(serial_varint_decode_array32(buffer.data(),
+                                           buffer.data() + buffer.size(),
+                                           narrow.data(), narrow.size()),
+              nullptr);
+}
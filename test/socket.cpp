@@ -0,0 +1,437 @@
+#include <chrono>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <liquid/event.h>
+#include <liquid/socket.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(LIQUID_TARGET_OS_WINDOWS)
+    #include <unistd.h>
+#endif
+
+/**
+ * @brief Retries an operation on a non-blocking socket until it succeeds.
+ *
+ * @param operation The operation, returning whether it succeeded.
+ * @return True if the operation succeeded within five seconds.
+ */
+template <typename F>
+static bool
+retry(F operation)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!operation())
+    {
+        if (!socket_would_block()
+            || std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+/**
+ * @brief Makes a buffer of a string.
+ * @param text The string.
+ * @return The buffer.
+ */
+static socket_buffer_t
+make_buffer(std::string &text)
+{
+    socket_buffer_t buffer;
+    buffer.data = &text[0];
+    buffer.size = (uint_t)text.size();
+    return buffer;
+}
+
+/**
+ * @brief Opens a UDP socket bound to a free loopback port.
+ *
+ * @param handle Receives the socket.
+ * @param address Receives the bound address.
+ */
+static void
+open_udp(socket_handle_t *handle, socket_address_t *address)
+{
+    ASSERT_TRUE(socket_address_ip(address, "127.0.0.1", 0));
+    ASSERT_TRUE(socket_open(handle, address, SOCKET_DATAGRAM));
+    ASSERT_TRUE(socket_bind(*handle, address, 0));
+    ASSERT_TRUE(socket_local_address(*handle, address));
+    EXPECT_NE(socket_address_port(address), 0);
+}
+
+/**
+ * @brief Connects a TCP client to a listener on a free loopback port.
+ *
+ * @param client Receives the client socket.
+ * @param server Receives the accepted socket.
+ */
+static void
+connect_tcp(socket_handle_t *client, socket_handle_t *server)
+{
+    socket_address_t address;
+    socket_handle_t  listener;
+    ASSERT_TRUE(socket_address_ip(&address, "127.0.0.1", 0));
+    ASSERT_TRUE(socket_open(&listener, &address, SOCKET_STREAM));
+    ASSERT_TRUE(socket_bind(listener, &address, SOCKET_REUSE_ADDRESS));
+    ASSERT_TRUE(socket_listen(listener, 16));
+    ASSERT_TRUE(socket_local_address(listener, &address));
+
+    ASSERT_TRUE(socket_open(client, &address, SOCKET_STREAM));
+    ASSERT_TRUE(socket_connect(*client, &address));
+    socket_address_t peer;
+    EXPECT_TRUE(retry([&] { return socket_accept(listener, server, &peer); }));
+    EXPECT_TRUE(retry([&] { return socket_connect_result(*client); }));
+    EXPECT_TRUE(socket_set_nodelay(*client, true));
+    socket_close(listener);
+}
+
+/**
+ * @test Test case for datagrams sent and received in batches.
+ *
+ * This test sends datagrams of varying sizes gathered from two buffers in
+ * batches larger than SOCKET_BATCH, receives them in batches and checks
+ * their content, sender and the truncation of one that does not fit.
+ */
+TEST(socket, udp_batch)
+{
+    socket_handle_t  receiver, sender;
+    socket_address_t to, from;
+    open_udp(&receiver, &to);
+    open_udp(&sender, &from);
+    EXPECT_TRUE(socket_set_buffer_sizes(receiver, 1 << 20, 1 << 20));
+
+    const usize_t                count = SOCKET_BATCH * 2 + 10;
+    std::vector<std::string>     heads(count), tails(count);
+    std::vector<socket_buffer_t> out(count * 2);
+    std::vector<socket_message_t> messages(count);
+    for (usize_t i = 0; i < count; ++i)
+    {
+        heads[i] = "datagram " + std::to_string(i);
+        tails[i] = std::string(i % 50, (char)('a' + i % 26));
+        out[i * 2] = make_buffer(heads[i]);
+        out[i * 2 + 1] = make_buffer(tails[i]);
+        messages[i] = {&out[i * 2], 2, &to, 0, 0};
+    }
+    // The last datagram is larger than its receive buffer.
+    tails[count - 1] = std::string(300, 'z');
+    out[count * 2 - 1] = make_buffer(tails[count - 1]);
+
+    usize_t sent = 0;
+    ASSERT_TRUE(socket_send_batch(sender, messages.data(), count, 0, &sent));
+    ASSERT_EQ(sent, count);
+    EXPECT_EQ(messages[3].size, heads[3].size() + tails[3].size());
+
+    std::vector<std::string>      inbox(count, std::string(256, '\0'));
+    std::vector<socket_buffer_t>  in(count);
+    std::vector<socket_address_t> senders(count);
+    for (usize_t i = 0; i < count; ++i)
+    {
+        in[i] = make_buffer(inbox[i]);
+        messages[i] = {&in[i], 1, &senders[i], 0, 0};
+    }
+    usize_t received = 0;
+    while (received < count)
+    {
+        usize_t batch = 0;
+        ASSERT_TRUE(retry(
+            [&]
+            {
+                return socket_recv_batch(receiver, &messages[received],
+                                         count - received, &batch);
+            }));
+        received += batch;
+    }
+    usize_t extra = 0;
+    EXPECT_FALSE(socket_recv_batch(receiver, messages.data(), 1, &extra));
+    EXPECT_TRUE(socket_would_block());
+
+    for (usize_t i = 0; i < count; ++i)
+    {
+        std::string expected = heads[i] + tails[i];
+        if (i < count - 1)
+        {
+            ASSERT_EQ(inbox[i].substr(0, messages[i].size), expected) << i;
+            EXPECT_FALSE(messages[i].truncated) << i;
+        }
+        EXPECT_EQ(socket_address_port(&senders[i]),
+                  socket_address_port(&from));
+    }
+    EXPECT_TRUE(messages[count - 1].truncated);
+
+    socket_close(receiver);
+    socket_close(sender);
+}
+
+/**
+ * @test Test case for stream sockets.
+ *
+ * This test connects over TCP, sends a gathered message and checks that it
+ * arrives whole and that closing the peer reads as the end of the stream.
+ */
+TEST(socket, tcp)
+{
+    socket_handle_t client, server;
+    connect_tcp(&client, &server);
+
+    std::string      head = "hello ", tail = "stream";
+    socket_buffer_t  out[] = {make_buffer(head), make_buffer(tail)};
+    socket_message_t message = {out, 2, nullptr, 0, 0};
+    ASSERT_TRUE(socket_send(client, &message, 0));
+    EXPECT_EQ(message.size, head.size() + tail.size());
+
+    std::string      inbox(64, '\0');
+    std::string      text;
+    socket_buffer_t  in = make_buffer(inbox);
+    socket_message_t reply = {&in, 1, nullptr, 0, 0};
+    while (text.size() < head.size() + tail.size())
+    {
+        ASSERT_TRUE(retry([&] { return socket_recv(server, &reply); }));
+        text += inbox.substr(0, reply.size);
+    }
+    EXPECT_EQ(text, head + tail);
+
+    socket_close(client);
+    EXPECT_TRUE(retry([&] { return socket_recv(server, &reply); }));
+    EXPECT_EQ(reply.size, 0u);
+    socket_close(server);
+}
+
+#if !defined(LIQUID_TARGET_OS_WINDOWS)
+
+/**
+ * @brief Drains the datagrams of a source into the count in the data of
+ *        the loop.
+ * @param loop The loop.
+ * @param source The source of a UDP socket.
+ * @param event The events.
+ */
+static void
+on_datagrams(event_loop_t *loop, event_source_t *source, const event_t *event)
+{
+    ASSERT_TRUE(event->events & EVENT_READ);
+
+    char             inbox[SOCKET_BATCH][64];
+    socket_buffer_t  buffers[SOCKET_BATCH];
+    socket_message_t messages[SOCKET_BATCH];
+    for (int i = 0; i < SOCKET_BATCH; ++i)
+    {
+        buffers[i] = {inbox[i], sizeof(inbox[i])};
+        messages[i] = {&buffers[i], 1, nullptr, 0, 0};
+    }
+
+    // Readiness is edge-triggered, so everything has to be read.
+    usize_t received;
+    while (socket_recv_batch(source->handle, messages, SOCKET_BATCH,
+                             &received))
+    {
+        *static_cast<usize_t *>(loop->data) += received;
+    }
+    EXPECT_TRUE(socket_would_block());
+}
+
+/**
+ * @test Test case for sockets watched by an event loop.
+ *
+ * This test receives bursts of datagrams on a socket watched by a loop and
+ * checks that all of them are drained by the callbacks.
+ */
+TEST(socket, event_loop)
+{
+    socket_handle_t  receiver, sender;
+    socket_address_t to, from;
+    open_udp(&receiver, &to);
+    open_udp(&sender, &from);
+    EXPECT_TRUE(socket_set_buffer_sizes(receiver, 1 << 20, 0));
+
+    event_loop_t loop;
+    usize_t      total = 0;
+    ASSERT_TRUE(event_loop_init(&loop, nullptr));
+    loop.data = &total;
+    event_source_t source = {on_datagrams, nullptr, receiver, EVENT_READ};
+    ASSERT_TRUE(event_loop_add(&loop, &source));
+
+    std::string      payload = "telemetry";
+    socket_buffer_t  buffer = make_buffer(payload);
+    socket_message_t messages[100];
+    for (socket_message_t &message : messages)
+    {
+        message = {&buffer, 1, &to, 0, 0};
+    }
+    for (int burst = 0; burst < 5; ++burst)
+    {
+        usize_t sent = 0;
+        ASSERT_TRUE(socket_send_batch(sender, messages, 100, 0, &sent));
+        ASSERT_EQ(sent, 100u);
+        while (total < (usize_t)(burst + 1) * 100)
+        {
+            ASSERT_TRUE(event_loop_run_once(&loop, 1000));
+        }
+    }
+    EXPECT_EQ(total, 500u);
+
+    EXPECT_TRUE(event_loop_remove(&loop, &source));
+    event_loop_free(&loop);
+    socket_close(receiver);
+    socket_close(sender);
+}
+
+/**
+ * @test Test case for Unix domain sockets.
+ *
+ * This test exchanges a datagram over Unix domain sockets.
+ */
+TEST(socket, unix_domain)
+{
+    std::string path = ::testing::TempDir() + "liquid-socket-test";
+    unlink(path.c_str());
+
+    socket_address_t address;
+    socket_handle_t  receiver, sender;
+    ASSERT_TRUE(socket_address_unix(&address, path.c_str()));
+    ASSERT_TRUE(socket_open(&receiver, &address, SOCKET_DATAGRAM));
+    ASSERT_TRUE(socket_bind(receiver, &address, 0));
+    ASSERT_TRUE(socket_open(&sender, &address, SOCKET_DATAGRAM));
+
+    std::string      payload = "local";
+    socket_buffer_t  buffer = make_buffer(payload);
+    socket_message_t message = {&buffer, 1, &address, 0, 0};
+    ASSERT_TRUE(socket_send(sender, &message, 0));
+
+    std::string      inbox(16, '\0');
+    socket_buffer_t  in = make_buffer(inbox);
+    socket_message_t reply = {&in, 1, nullptr, 0, 0};
+    ASSERT_TRUE(retry([&] { return socket_recv(receiver, &reply); }));
+    EXPECT_EQ(inbox.substr(0, reply.size), payload);
+
+    EXPECT_FALSE(socket_address_unix(&address, std::string(200, 'x').c_str()));
+    socket_close(receiver);
+    socket_close(sender);
+    unlink(path.c_str());
+}
+
+/**
+ * @test Test case for sockets sharing a port.
+ *
+ * This test opens UDP shards on a free port, sends datagrams to the port
+ * and checks that the shards receive all of them between them.
+ */
+TEST(socket, shards)
+{
+    socket_handle_t  shards[4];
+    socket_address_t address, from;
+    ASSERT_TRUE(socket_address_ip(&address, "127.0.0.1", 0));
+    ASSERT_TRUE(socket_shard_open(shards, 4, &address, SOCKET_DATAGRAM));
+    ASSERT_NE(socket_address_port(&address), 0);
+
+    socket_handle_t sender;
+    open_udp(&sender, &from);
+    std::string      payload = "shard";
+    socket_buffer_t  buffer = make_buffer(payload);
+    socket_message_t messages[200];
+    for (socket_message_t &message : messages)
+    {
+        message = {&buffer, 1, &address, 0, 0};
+    }
+    usize_t sent = 0;
+    ASSERT_TRUE(socket_send_batch(sender, messages, 200, 0, &sent));
+    ASSERT_EQ(sent, 200u);
+
+    std::string     inbox(16, '\0');
+    socket_buffer_t in = make_buffer(inbox);
+    for (socket_message_t &message : messages)
+    {
+        message = {&in, 1, nullptr, 0, 0};
+    }
+    auto    deadline = std::chrono::steady_clock::now()
+                    + std::chrono::seconds(5);
+    usize_t total = 0;
+    while (total < 200 && std::chrono::steady_clock::now() < deadline)
+    {
+        for (socket_handle_t shard : shards)
+        {
+            usize_t received = 0;
+            if (socket_recv_batch(shard, messages, 200, &received))
+            {
+                total += received;
+            }
+        }
+    }
+    EXPECT_EQ(total, 200u);
+
+    // The port is taken by the shards.
+    socket_handle_t other;
+    ASSERT_TRUE(socket_open(&other, &address, SOCKET_DATAGRAM));
+    EXPECT_FALSE(socket_bind(other, &address, 0));
+    socket_close(other);
+    for (socket_handle_t shard : shards)
+    {
+        socket_close(shard);
+    }
+    socket_close(sender);
+}
+
+#endif // !LIQUID_TARGET_OS_WINDOWS
+
+#if defined(LIQUID_TARGET_OS_LINUX)
+
+/**
+ * @test Test case for zero-copy sends.
+ *
+ * This test sends large buffers over TCP with SOCKET_ZEROCOPY, receives
+ * them and checks that every send is reported completed.
+ */
+TEST(socket, zerocopy)
+{
+    socket_handle_t client, server;
+    connect_tcp(&client, &server);
+    if (!socket_zerocopy_enable(client))
+    {
+        socket_close(client);
+        socket_close(server);
+        GTEST_SKIP() << "zero-copy is not supported";
+    }
+
+    const uint_t      sends = 8;
+    std::vector<char> payload(64 * 1024, 'q');
+    socket_buffer_t   buffer = {payload.data(), payload.size()};
+    std::vector<char> inbox(payload.size());
+    socket_buffer_t   in = {inbox.data(), inbox.size()};
+    usize_t           total = 0;
+    for (uint_t i = 0; i < sends; ++i)
+    {
+        socket_message_t message = {&buffer, 1, nullptr, 0, 0};
+        ASSERT_TRUE(socket_send(client, &message, SOCKET_ZEROCOPY));
+        ASSERT_EQ(message.size, payload.size());
+
+        // Keep the receive buffer of the peer from filling up.
+        while (total < (i + 1) * payload.size())
+        {
+            socket_message_t reply = {&in, 1, nullptr, 0, 0};
+            ASSERT_TRUE(retry([&] { return socket_recv(server, &reply); }));
+            total += reply.size;
+        }
+    }
+
+    // The completions may be coalesced into ranges.
+    uint_t next = 0;
+    while (next < sends)
+    {
+        socket_completion_t completion;
+        ASSERT_TRUE(retry(
+            [&] { return socket_zerocopy_reap(client, &completion); }));
+        EXPECT_EQ(completion.first, next);
+        EXPECT_GE(completion.last, completion.first);
+        next = completion.last + 1;
+    }
+    EXPECT_EQ(next, sends);
+
+    socket_close(client);
+    socket_close(server);
+}
+
+#endif // LIQUID_TARGET_OS_LINUX
@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <liquid/sort.h>
+#include <limits>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Generates test keys of a given distribution.
+ *
+ * @param count The number of keys.
+ * @param kind 0 for random keys, 1 for sorted, 2 for reversed, 3 for few
+ *             distinct keys, 4 for equal keys, 5 for an organ pipe and 6 for
+ *             sorted keys with a few swapped.
+ * @return The keys.
+ */
+template <typename T>
+static std::vector<T>
+make_keys(usize_t count, uint_t kind)
+{
+    std::mt19937_64 rng(count * 8 + kind);
+    std::vector<T>  keys(count);
+    for (usize_t i = 0; i < count; ++i)
+    {
+        T key = (T)rng();
+        switch (kind)
+        {
+        case 1:
+            key = (T)(i * 3);
+            break;
+        case 2:
+            key = (T)(count - i);
+            break;
+        case 3:
+            key = (T)(rng() % 5) << (sizeof(T) * 8 - 8);
+            break;
+        case 4:
+            key = 7;
+            break;
+        case 5:
+            key = (T)(i < count / 2 ? i : count - i);
+            break;
+        case 6:
+            key = (T)i;
+            break;
+        }
+        keys[i] = key;
+    }
+    if (kind == 6 && count)
+    {
+        for (usize_t i = 0; i < count / 100 + 1; ++i)
+        {
+            std::swap(keys[rng() % count], keys[rng() % count]);
+        }
+    }
+    return keys;
+}
+
+/**
+ * @brief The sizes tested, around the thresholds of the algorithms.
+ */
+static const usize_t sizes[] = {0,   1,   2,    3,    24,    25,    100,
+                                129, 255, 256,  1000, 4097,  65536, 100000};
+
+/**
+ * @test Test case for the radix sorts.
+ *
+ * This test sorts keys of every distribution and many sizes with the
+ * stable and the in-place radix sorts of both widths and compares them to
+ * std::sort.
+ */
+TEST(sort, radix)
+{
+    for (uint_t kind = 0; kind < 7; ++kind)
+    {
+        for (usize_t size : sizes)
+        {
+            std::vector<uint_t> keys = make_keys<uint_t>(size, kind);
+            std::vector<uint_t> expected = keys;
+            std::sort(expected.begin(), expected.end());
+
+            std::vector<uint_t> sorted = keys;
+            std::vector<uint_t> scratch(size);
+            sort_radix_uint(sorted.data(), size, scratch.data());
+            EXPECT_EQ(sorted, expected) << kind << " " << size;
+            sorted = keys;
+            sort_radix_uint(sorted.data(), size, nullptr);
+            EXPECT_EQ(sorted, expected) << kind << " " << size;
+
+            std::vector<ullong_t> wide = make_keys<ullong_t>(size, kind);
+            std::vector<ullong_t> wide_expected = wide;
+            std::sort(wide_expected.begin(), wide_expected.end());
+
+            std::vector<ullong_t> wide_sorted = wide;
+            std::vector<ullong_t> wide_scratch(size);
+            sort_radix_ullong(wide_sorted.data(), size, wide_scratch.data());
+            EXPECT_EQ(wide_sorted, wide_expected) << kind << " " << size;
+            wide_sorted = wide;
+            sort_radix_ullong(wide_sorted.data(), size, nullptr);
+            EXPECT_EQ(wide_sorted, wide_expected) << kind << " " << size;
+        }
+    }
+}
+
+/**
+ * @test Test case for the radix sorts of pairs.
+ *
+ * This test sorts keys with their indices as values, checks that the
+ * values stay with their keys, and that the sorts with scratch space keep
+ * equal keys in their original order.
+ */
+TEST(sort, radix_pairs)
+{
+    for (uint_t kind : {0u, 3u, 4u, 6u})
+    {
+        for (usize_t size : sizes)
+        {
+            std::vector<uint_t> keys = make_keys<uint_t>(size, kind);
+            std::vector<uint_t> order(size);
+            for (usize_t i = 0; i < size; ++i)
+            {
+                order[i] = (uint_t)i;
+            }
+            std::stable_sort(order.begin(), order.end(),
+                             [&](uint_t a, uint_t b)
+                             { return keys[a] < keys[b]; });
+
+            for (bool stable : {true, false})
+            {
+                std::vector<uint_t> sorted = keys;
+                std::vector<uint_t> values(size);
+                std::vector<uint_t> key_scratch(size);
+                std::vector<uint_t> value_scratch(size);
+                for (usize_t i = 0; i < size; ++i)
+                {
+                    values[i] = (uint_t)i;
+                }
+                sort_radix_pairs_uint(sorted.data(), values.data(), size,
+                                      stable ? key_scratch.data() : nullptr,
+                                      stable ? value_scratch.data()
+                                             : nullptr);
+                for (usize_t i = 0; i < size; ++i)
+                {
+                    ASSERT_EQ(sorted[i], keys[order[i]]) << kind << " " << i;
+                    ASSERT_EQ(keys[values[i]], sorted[i]) << kind << " " << i;
+                    if (stable)
+                    {
+                        ASSERT_EQ(values[i], order[i]) << kind << " " << i;
+                    }
+                }
+            }
+
+            std::vector<ullong_t> wide = make_keys<ullong_t>(size, kind);
+            std::vector<ullong_t> wide_sorted = wide;
+            std::vector<ullong_t> values(size);
+            for (usize_t i = 0; i < size; ++i)
+            {
+                values[i] = i;
+            }
+            sort_radix_pairs_ullong(wide_sorted.data(), values.data(), size,
+                                    nullptr, nullptr);
+            EXPECT_TRUE(std::is_sorted(wide_sorted.begin(),
+                                       wide_sorted.end()));
+            for (usize_t i = 0; i < size; ++i)
+            {
+                ASSERT_EQ(wide[values[i]], wide_sorted[i]) << kind << " " << i;
+            }
+        }
+    }
+}
+
+/**
+ * @test Test case for sorting floats.
+ *
+ * This test sorts floats including zeros of both signs, infinities and
+ * denormals with all the float sorts and checks the order of their bits.
+ */
+TEST(sort, floats)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    const float special[] = {0.0f, -0.0f, inf, -inf, 1e-40f, -1e-40f,
+                             std::numeric_limits<float>::max(),
+                             std::numeric_limits<float>::lowest()};
+
+    std::mt19937 rng(3);
+    for (usize_t size : {8u, 300u, 5000u})
+    {
+        std::vector<float> keys(size);
+        for (usize_t i = 0; i < size; ++i)
+        {
+            keys[i] = i < 8 ? special[i]
+                            : std::ldexp((float)rng() / 4e9f - 0.5f,
+                                         (int)(rng() % 60) - 30);
+        }
+        std::vector<float> expected = keys;
+        std::sort(expected.begin(), expected.end());
+
+        std::vector<float> sorted = keys;
+        std::vector<float> scratch(size);
+        sort_radix_float(sorted.data(), size, scratch.data());
+        EXPECT_EQ(sorted, expected);
+        EXPECT_TRUE(std::signbit(*std::find(sorted.begin(), sorted.end(),
+                                            0.0f)));
+        sorted = keys;
+        sort_radix_float(sorted.data(), size, nullptr);
+        EXPECT_EQ(sorted, expected);
+        sorted = keys;
+        sort_float(sorted.data(), size);
+        EXPECT_EQ(sorted, expected);
+
+        sorted = keys;
+        std::vector<uint_t> values(size);
+        std::vector<uint_t> value_scratch(size);
+        for (usize_t i = 0; i < size; ++i)
+        {
+            values[i] = (uint_t)i;
+        }
+        sort_radix_pairs_float(sorted.data(), values.data(), size,
+                               scratch.data(), value_scratch.data());
+        EXPECT_EQ(sorted, expected);
+        for (usize_t i = 0; i < size; ++i)
+        {
+            ASSERT_EQ(keys[values[i]], sorted[i]) << i;
+        }
+    }
+}
+
+/**
+ * @test Test case for the comparison sorts.
+ *
+ * This test sorts keys of every distribution, including patterns that
+ * defeat naive quicksort, and compares them to std::sort.
+ */
+TEST(sort, pdq)
+{
+    for (uint_t kind = 0; kind < 7; ++kind)
+    {
+        for (usize_t size : sizes)
+        {
+            std::vector<uint_t> keys = make_keys<uint_t>(size, kind);
+            std::vector<uint_t> expected = keys;
+            std::sort(expected.begin(), expected.end());
+            sort_uint(keys.data(), size);
+            EXPECT_EQ(keys, expected) << kind << " " << size;
+
+            std::vector<ullong_t> wide = make_keys<ullong_t>(size, kind);
+            std::vector<ullong_t> wide_expected = wide;
+            std::sort(wide_expected.begin(), wide_expected.end());
+            sort_ullong(wide.data(), size);
+            EXPECT_EQ(wide, wide_expected) << kind << " " << size;
+        }
+    }
+
+    // Alternating runs and sawtooth patterns.
+    std::vector<uint_t> keys(100000);
+    for (usize_t i = 0; i < keys.size(); ++i)
+    {
+        keys[i] = (uint_t)(i % 2 ? i : keys.size() - i) + (uint_t)(i % 37);
+    }
+    std::vector<uint_t> expected = keys;
+    std::sort(expected.begin(), expected.end());
+    sort_uint(keys.data(), keys.size());
+    EXPECT_EQ(keys, expected);
+}
+
+/**
+ * @test Test case for the searches.
+ *
+ * This test searches sorted arrays of many sizes with duplicates for keys
+ * in, between and outside them with both the plain and the Eytzinger
+ * searches and compares the results to std::lower_bound.
+ */
+TEST(sort, lower_bound)
+{
+    std::mt19937_64 rng(5);
+    for (usize_t size : sizes)
+    {
+        std::vector<uint_t> keys(size);
+        for (uint_t &key : keys)
+        {
+            key = (uint_t)(rng() % (size * 2 + 1)) + 0x7FFFFF00u;
+        }
+        std::sort(keys.begin(), keys.end());
+        std::vector<uint_t> layout(size);
+        sort_eytzinger_uint(layout.data(), keys.data(), size);
+
+        std::vector<ullong_t> wide(size);
+        for (ullong_t &key : wide)
+        {
+            key = rng() % (size * 2 + 1) * 0x100000001ull;
+        }
+        std::sort(wide.begin(), wide.end());
+        std::vector<ullong_t> wide_layout(size);
+        sort_eytzinger_ullong(wide_layout.data(), wide.data(), size);
+
+        for (usize_t probe = 0; probe < size * 2 + 10; ++probe)
+        {
+            uint_t key = (uint_t)probe + 0x7FFFFF00u - 4;
+            usize_t index = std::lower_bound(keys.begin(), keys.end(), key)
+                            - keys.begin();
+            ASSERT_EQ(sort_lower_bound_uint(keys.data(), size, key), index)
+                << size << " " << probe;
+            usize_t found = sort_eytzinger_lower_bound_uint(layout.data(),
+                                                            size, key);
+            if (index == size)
+            {
+                ASSERT_EQ(found, size) << size << " " << probe;
+            }
+            else
+            {
+                ASSERT_LT(found, size) << size << " " << probe;
+                ASSERT_EQ(layout[found], keys[index]) << size << " " << probe;
+            }
+
+            ullong_t wide_key = (ullong_t)probe * 0x100000001ull - 1;
+            index = std::lower_bound(wide.begin(), wide.end(), wide_key)
+                    - wide.begin();
+            ASSERT_EQ(sort_lower_bound_ullong(wide.data(), size, wide_key),
+                      index)
+                << size << " " << probe;
+            found = sort_eytzinger_lower_bound_ullong(wide_layout.data(), size,
+                                                      wide_key);
+            if (index == size)
+            {
+                ASSERT_EQ(found, size) << size << " " << probe;
+            }
+            else
+            {
+                ASSERT_LT(found, size) << size << " " << probe;
+                ASSERT_EQ(wide_layout[found], wide[index])
+                    << size << " " << probe;
+            }
+        }
+    }
+}
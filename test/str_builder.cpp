@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <liquid/str-builder.h>
+
+/**
+ * @test Test case for short strings kept in the inline storage.
+ *
+ * This test verifies that a string shorter than STR_BUILDER_INLINE never
+ * leaves the builder and that the contents stay null-terminated.
+ */
+TEST(str_builder, short_string_stays_inline)
+{
+    str_builder_t builder;
+    str_builder_init(&builder, nullptr);
+
+    STR_BUILDER_APPEND(&builder, "id=");
+    str_builder_append_uint(&builder, 42);
+    str_builder_append_char(&builder, ';');
+
+    EXPECT_EQ(builder.heap, nullptr);
+    EXPECT_EQ(builder.size, 6u);
+    EXPECT_STREQ(STR_BUILDER_DATA(&builder), "id=42;");
+
+    str_builder_free(&builder);
+}
+
+/**
+ * @test Test case for strings that outgrow the inline storage.
+ *
+ * This test checks that the contents are moved to the heap once they no
+ * longer fit into the builder and that appending keeps working afterwards.
+ */
+TEST(str_builder, long_string_moves_to_heap)
+{
+    str_builder_t builder;
+    str_builder_init(&builder, nullptr);
+
+    std::string expected;
+    for (int i = 0; i < 100; ++i)
+    {
+        str_builder_append(&builder, "abc", 0);
+        expected += "abc";
+    }
+
+    EXPECT_NE(builder.heap, nullptr);
+    EXPECT_GT(builder.capacity, builder.size);
+    EXPECT_EQ(std::string(STR_BUILDER_DATA(&builder)), expected);
+
+    str_builder_clear(&builder);
+    EXPECT_STREQ(STR_BUILDER_DATA(&builder), "");
+
+    str_builder_free(&builder);
+}
+
+/**
+ * @test Test case for appending the contents of the builder itself.
+ *
+ * This test appends the contents to themselves until they move from the
+ * inline storage to the heap and grow there, with both builders.
+ */
+TEST(str_builder, append_own_contents)
+{
+    str_builder_t builder;
+    str_builder_init(&builder, nullptr);
+    STR_BUILDER_APPEND(&builder, "abcdef");
+
+    std::string expected = "abcdef";
+    for (int i = 0; i < 8; ++i)
+    {
+        str_builder_append(&builder, STR_BUILDER_DATA(&builder) + 1,
+                           builder.size - 1);
+        expected += expected.substr(1);
+        ASSERT_EQ(std::string(STR_BUILDER_DATA(&builder)), expected);
+    }
+    str_builder_free(&builder);
+
+    wstr_builder_t wide;
+    wstr_builder_init(&wide, nullptr);
+    WSTR_BUILDER_APPEND(&wide, L"abcdef");
+
+    std::wstring wexpected = L"abcdef";
+    for (int i = 0; i < 8; ++i)
+    {
+        wstr_builder_append(&wide, STR_BUILDER_DATA(&wide) + 1,
+                            wide.size - 1);
+        wexpected += wexpected.substr(1);
+        ASSERT_EQ(std::wstring(STR_BUILDER_DATA(&wide)), wexpected);
+    }
+    wstr_builder_free(&wide);
+}
+
+/**
+ * @test Test case for formatted and integer appends.
+ *
+ * This test verifies that formatted output is appended both when it fits
+ * the free space and when the builder has to grow, and that the extreme
+ * values of signed integers are formatted correctly.
+ */
+TEST(str_builder, appendf_and_integers)
+{
+    str_builder_t builder;
+    str_builder_init(&builder, nullptr);
+
+    str_builder_appendf(&builder, "%d-%s", 7, "x");
+    EXPECT_STREQ(STR_BUILDER_DATA(&builder), "7-x");
+
+    str_builder_appendf(&builder, "|%040d|", 1);
+    EXPECT_EQ(builder.size, 45u);
+
+    str_builder_clear(&builder);
+    str_builder_append_int(&builder, LIQUID_SLLONG_MIN);
+    EXPECT_STREQ(STR_BUILDER_DATA(&builder), "-9223372036854775808");
+
+    str_builder_clear(&builder);
+    str_builder_append_uint(&builder, LIQUID_ULLONG_MAX);
+    EXPECT_STREQ(STR_BUILDER_DATA(&builder), "18446744073709551615");
+
+    str_builder_free(&builder);
+}
+
+/**
+ * @test Test case for JSON strings.
+ *
+ * This test checks that quotes, backslashes and control characters are
+ * escaped and that other bytes are copied as they are.
+ */
+TEST(str_builder, json)
+{
+    str_builder_t builder;
+    str_builder_init(&builder, nullptr);
+
+    str_builder_append_json(&builder, "a\"b\\c\n\x01\xc3\xa9");
+    EXPECT_STREQ(STR_BUILDER_DATA(&builder),
+                 "\"a\\\"b\\\\c\\u000a\\u0001\xc3\xa9\"");
+
+    str_builder_clear(&builder);
+    str_builder_append_json(&builder, "");
+    EXPECT_STREQ(STR_BUILDER_DATA(&builder), "\"\"");
+
+    str_builder_free(&builder);
+}
+
+/**
+ * @test Test case for the wide character builder.
+ *
+ * This test checks that the wide builder supports the same operations as
+ * the raw one, including growth beyond the inline storage.
+ */
+TEST(str_builder, wide_builder)
+{
+    wstr_builder_t builder;
+    wstr_builder_init(&builder, nullptr);
+
+    WSTR_BUILDER_APPEND(&builder, L"value: ");
+    wstr_builder_append_int(&builder, -15);
+    EXPECT_EQ(builder.heap, nullptr);
+    EXPECT_STREQ(STR_BUILDER_DATA(&builder), L"value: -15");
+
+    wstr_builder_appendf(&builder, L", %ls %d", L"and a longer tail", 123456);
+    EXPECT_NE(builder.heap, nullptr);
+    EXPECT_STREQ(STR_BUILDER_DATA(&builder),
+                 L"value: -15, and a longer tail 123456");
+
+    wstr_builder_free(&builder);
+}
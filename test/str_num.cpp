@@ -0,0 +1,368 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <liquid/limits.h>
+#include <liquid/str-builder.h>
+#include <liquid/str-num.h>
+#include <random>
+
+/**
+ * @test Test case for decimal formatting of integers.
+ *
+ * This test verifies the digit count and the output of the integer
+ * formatters at the boundaries of every digit count and at the extremes.
+ */
+TEST(str_num, integer_to_string)
+{
+    char     buffer[STR_NUM_I64_SIZE];
+    ullong_t value = 1;
+
+    EXPECT_EQ(str_u64_digits(0), 1u);
+    for (usize_t digits = 1; digits < 20; ++digits, value *= 10)
+    {
+        EXPECT_EQ(str_u64_digits(value), digits);
+        EXPECT_EQ(str_u64_digits(value * 10 - 1), digits);
+
+        char *end = str_from_u64(buffer, sizeof(buffer), value * 10 - 1);
+        ASSERT_NE(end, nullptr);
+        EXPECT_EQ(std::string(buffer), std::to_string(value * 10 - 1));
+        EXPECT_EQ(end, buffer + digits);
+    }
+    EXPECT_EQ(str_u64_digits(LIQUID_ULLONG_MAX), 20u);
+
+    str_from_u64(buffer, sizeof(buffer), LIQUID_ULLONG_MAX);
+    EXPECT_STREQ(buffer, "18446744073709551615");
+    str_from_i64(buffer, sizeof(buffer), LIQUID_SLLONG_MIN);
+    EXPECT_STREQ(buffer, "-9223372036854775808");
+    str_from_i64(buffer, sizeof(buffer), -7);
+    EXPECT_STREQ(buffer, "-7");
+    str_from_i64(buffer, sizeof(buffer), 0);
+    EXPECT_STREQ(buffer, "0");
+}
+
+/**
+ * @test Test case for hexadecimal and arbitrary base formatting.
+ *
+ * This test checks the hexadecimal shortcut, a few bases against known
+ * strings and that an unsupported base is rejected.
+ */
+TEST(str_num, integer_to_string_base)
+{
+    char buffer[STR_NUM_BASE_SIZE];
+
+    str_from_u64_hex(buffer, sizeof(buffer), 0xdeadbeef0ULL);
+    EXPECT_STREQ(buffer, "deadbeef0");
+    str_from_u64_hex(buffer, sizeof(buffer), 0);
+    EXPECT_STREQ(buffer, "0");
+
+    str_from_u64_base(buffer, sizeof(buffer), LIQUID_ULLONG_MAX, 2);
+    EXPECT_EQ(std::string(buffer), std::string(64, '1'));
+    str_from_u64_base(buffer, sizeof(buffer), 35, 36);
+    EXPECT_STREQ(buffer, "z");
+    str_from_u64_base(buffer, sizeof(buffer), 8, 8);
+    EXPECT_STREQ(buffer, "10");
+
+    EXPECT_EQ(str_from_u64_base(buffer, sizeof(buffer), 1, 1), nullptr);
+    EXPECT_EQ(str_from_u64_base(buffer, sizeof(buffer), 1, 37), nullptr);
+}
+
+/**
+ * @test Test case for destination buffers that are too small.
+ *
+ * This test verifies that the formatters fail instead of truncating.
+ */
+TEST(str_num, buffer_too_small)
+{
+    char buffer[4];
+
+    EXPECT_EQ(str_from_u64(buffer, sizeof(buffer), 1234), nullptr);
+    EXPECT_NE(str_from_u64(buffer, sizeof(buffer), 123), nullptr);
+    EXPECT_EQ(str_from_i64(buffer, sizeof(buffer), -123), nullptr);
+    EXPECT_EQ(str_from_u64_hex(buffer, sizeof(buffer), 0x1000), nullptr);
+    EXPECT_EQ(str_from_double(buffer, sizeof(buffer), 0.25), nullptr);
+    EXPECT_NE(str_from_double(buffer, sizeof(buffer), 0.5), nullptr);
+}
+
+/**
+ * @test Test case for the shortest representation of doubles.
+ *
+ * This test compares the output for values that exercise both notations,
+ * subnormals and special values against their expected strings.
+ */
+TEST(str_num, double_to_string)
+{
+    const struct
+    {
+        double      value;
+        const char *expected;
+    } cases[] = {
+        {0.0, "0"},
+        {-0.0, "-0"},
+        {1.0, "1"},
+        {0.1, "0.1"},
+        {-1.5, "-1.5"},
+        {0.3, "0.3"},
+        {0.1 + 0.2, "0.30000000000000004"},
+        {123456789012345680000.0, "123456789012345680000"},
+        {1e21, "1e+21"},
+        {1e-6, "0.000001"},
+        {1.5e-7, "1.5e-7"},
+        {5e-324, "5e-324"},
+        {1.7976931348623157e308, "1.7976931348623157e+308"},
+        {-2.2250738585072014e-308, "-2.2250738585072014e-308"},
+        {HUGE_VAL, "inf"},
+        {-HUGE_VAL, "-inf"},
+        {NAN, "nan"},
+    };
+
+    for (const auto &test : cases)
+    {
+        char  buffer[STR_NUM_DOUBLE_SIZE];
+        char *end = str_from_double(buffer, sizeof(buffer), test.value);
+        ASSERT_NE(end, nullptr);
+        EXPECT_STREQ(buffer, test.expected);
+        EXPECT_EQ(*end, '\0');
+    }
+}
+
+/**
+ * @test Test case for round trips of random doubles.
+ *
+ * This test checks that formatted random bit patterns parse back to the
+ * identical value and always fit STR_NUM_DOUBLE_SIZE.
+ */
+TEST(str_num, double_round_trip)
+{
+    std::mt19937_64 rng(12345);
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        ullong_t bits = rng();
+        double   value;
+        std::memcpy(&value, &bits, sizeof(value));
+        if (std::isnan(value))
+        {
+            continue;
+        }
+
+        char buffer[STR_NUM_DOUBLE_SIZE];
+        ASSERT_NE(str_from_double(buffer, sizeof(buffer), value), nullptr);
+        EXPECT_EQ(std::strtod(buffer, nullptr), value) << buffer;
+    }
+}
+
+/**
+ * @test Test case for appending doubles to builders.
+ *
+ * This test verifies that raw and wide builders format doubles in place.
+ */
+TEST(str_num, builder_append_double)
+{
+    str_builder_t  builder;
+    wstr_builder_t wbuilder;
+    str_builder_init(&builder, nullptr);
+    wstr_builder_init(&wbuilder, nullptr);
+
+    STR_BUILDER_APPEND(&builder, "x=");
+    str_builder_append_double(&builder, 2.5);
+    str_builder_append_int(&builder, -3);
+    WSTR_BUILDER_APPEND(&wbuilder, L"y=");
+    wstr_builder_append_double(&wbuilder, 1e100);
+
+    EXPECT_STREQ(STR_BUILDER_DATA(&builder), "x=2.5-3");
+    EXPECT_EQ(builder.size, 7u);
+    EXPECT_STREQ(STR_BUILDER_DATA(&wbuilder), L"y=1e+100");
+    EXPECT_EQ(wbuilder.size, 8u);
+
+    str_builder_free(&builder);
+    wstr_builder_free(&wbuilder);
+}
+
+/**
+ * @test Test case for parsing decimal integers.
+ *
+ * This test verifies the returned end pointer, the value and the error code
+ * for plain numbers, leading zeros, trailing characters and the limits.
+ */
+TEST(str_num, string_to_integer)
+{
+    const std::string text = "000000000000000000000018446744073709551615,";
+    ullong_t          u;
+    sllong_t          i;
+    str_num_error_t   error;
+
+    const char *end = str_to_u64(text.data(), text.data() + text.size(), &u,
+                                 &error);
+    EXPECT_EQ(end, text.data() + text.size() - 1);
+    EXPECT_EQ(u, LIQUID_ULLONG_MAX);
+    EXPECT_EQ(error, STR_NUM_OK);
+
+    const std::string big = "18446744073709551616";
+    end = str_to_u64(big.data(), big.data() + big.size(), &u, &error);
+    EXPECT_EQ(end, big.data() + big.size());
+    EXPECT_EQ(u, LIQUID_ULLONG_MAX);
+    EXPECT_EQ(error, STR_NUM_ERROR_RANGE);
+
+    const std::string digits = "1234567890123456789x";
+    end = str_to_u64(digits.data(), digits.data() + digits.size(), &u, &error);
+    EXPECT_EQ(*end, 'x');
+    EXPECT_EQ(u, 1234567890123456789ull);
+
+    const std::string min = "-9223372036854775808";
+    str_to_i64(min.data(), min.data() + min.size(), &i, &error);
+    EXPECT_EQ(i, LIQUID_SLLONG_MIN);
+    EXPECT_EQ(error, STR_NUM_OK);
+
+    const std::string over = "9223372036854775808";
+    str_to_i64(over.data(), over.data() + over.size(), &i, &error);
+    EXPECT_EQ(i, LIQUID_SLLONG_MAX);
+    EXPECT_EQ(error, STR_NUM_ERROR_RANGE);
+
+    const std::string sign = "-";
+    EXPECT_EQ(str_to_i64(sign.data(), sign.data() + 1, &i, &error), nullptr);
+    EXPECT_EQ(error, STR_NUM_ERROR_SYNTAX);
+    EXPECT_EQ(str_to_u64(sign.data(), sign.data(), &u, nullptr), nullptr);
+}
+
+/**
+ * @test Test case for parsing hexadecimal integers.
+ *
+ * This test checks the optional prefix, mixed case digits and overflow.
+ */
+TEST(str_num, string_to_integer_hex)
+{
+    ullong_t        value;
+    str_num_error_t error;
+
+    const std::string prefixed = "0xDeadBeef;";
+    const char       *end = str_to_u64_hex(
+        prefixed.data(), prefixed.data() + prefixed.size(), &value, &error);
+    EXPECT_EQ(*end, ';');
+    EXPECT_EQ(value, 0xdeadbeefull);
+
+    const std::string zero = "0xg";
+    end = str_to_u64_hex(zero.data(), zero.data() + zero.size(), &value,
+                         &error);
+    EXPECT_EQ(end, zero.data() + 1);
+    EXPECT_EQ(value, 0u);
+
+    const std::string big = "1ffffffffffffffff";
+    str_to_u64_hex(big.data(), big.data() + big.size(), &value, &error);
+    EXPECT_EQ(value, LIQUID_ULLONG_MAX);
+    EXPECT_EQ(error, STR_NUM_ERROR_RANGE);
+}
+
+/**
+ * @test Test case for parsing doubles.
+ *
+ * This test compares the parser against strtod for inputs that take the
+ * exact, the Eisel-Lemire and the slow path, and checks the end pointer.
+ */
+TEST(str_num, string_to_double)
+{
+    const char *cases[] = {
+        "0",
+        "-0.0",
+        "1e",
+        "+.5",
+        "7.",
+        "3.14159",
+        "1e-5x",
+        "9007199254740993",
+        "123456789012345678901234567890e-10",
+        "2.2250738585072011e-308",
+        "4.9e-324",
+        "1.7976931348623157e308",
+        "9007199254740993.0000000000000000000001",
+        "2.22507385850720138309023271733240406421921598046233e-308",
+        "0.000000000000000000000000000000000000000000000001234",
+    };
+
+    for (const char *text : cases)
+    {
+        const char     *end = text + std::strlen(text);
+        char           *expected_end;
+        double          value;
+        str_num_error_t error;
+
+        const char *last = str_to_double(text, end, &value, &error);
+        EXPECT_EQ(value, std::strtod(text, &expected_end)) << text;
+        EXPECT_EQ(std::signbit(value), text[0] == '-') << text;
+        EXPECT_EQ(last, expected_end) << text;
+        EXPECT_EQ(error, STR_NUM_OK) << text;
+    }
+}
+
+/**
+ * @test Test case for special and out of range doubles.
+ *
+ * This test verifies infinity and NaN names, range errors and inputs
+ * without any number.
+ */
+TEST(str_num, string_to_double_special)
+{
+    const std::string infinity = "-Infinity";
+    const std::string nan = "nan(";
+    const std::string huge = "1e400";
+    const std::string tiny = "1e-400";
+    const std::string dot = ".e5";
+    double            value;
+    str_num_error_t   error;
+
+    EXPECT_EQ(str_to_double(infinity.data(), infinity.data() + infinity.size(),
+                            &value, &error),
+              infinity.data() + infinity.size());
+    EXPECT_EQ(value, -HUGE_VAL);
+
+    EXPECT_EQ(str_to_double(nan.data(), nan.data() + nan.size(), &value,
+                            &error),
+              nan.data() + 3);
+    EXPECT_TRUE(std::isnan(value));
+
+    str_to_double(huge.data(), huge.data() + huge.size(), &value, &error);
+    EXPECT_EQ(value, HUGE_VAL);
+    EXPECT_EQ(error, STR_NUM_ERROR_RANGE);
+
+    str_to_double(tiny.data(), tiny.data() + tiny.size(), &value, &error);
+    EXPECT_EQ(value, 0.0);
+    EXPECT_EQ(error, STR_NUM_ERROR_RANGE);
+
+    EXPECT_EQ(str_to_double(dot.data(), dot.data() + dot.size(), &value,
+                            &error),
+              nullptr);
+    EXPECT_EQ(error, STR_NUM_ERROR_SYNTAX);
+}
+
+/**
+ * @test Test case for formatting and parsing random doubles.
+ *
+ * This test checks that the parser restores every value from the output
+ * of both the shortest formatting and printf with 17 digits.
+ */
+TEST(str_num, double_parse_round_trip)
+{
+    std::mt19937_64 rng(54321);
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        ullong_t bits = rng();
+        double   value;
+        std::memcpy(&value, &bits, sizeof(value));
+        if (std::isnan(value))
+        {
+            continue;
+        }
+
+        char   buffer[32];
+        double parsed;
+        char  *end = str_from_double(buffer, sizeof(buffer), value);
+        ASSERT_EQ(str_to_double(buffer, end, &parsed, nullptr), end);
+        EXPECT_EQ(parsed, value) << buffer;
+
+        int len = std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+        str_to_double(buffer, buffer + len, &parsed, nullptr);
+        EXPECT_EQ(parsed, value) << buffer;
+    }
+}
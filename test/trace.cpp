@@ -0,0 +1,273 @@
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <liquid/trace.h>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Reads a whole file.
+ * @param path The path of the file.
+ * @return The content.
+ */
+static std::string
+read_file(const std::string &path)
+{
+    std::ifstream      file(path, std::ios::binary);
+    std::ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+/**
+ * @brief Counts the occurrences of a string in another.
+ *
+ * @param text The string searched.
+ * @param pattern The string counted.
+ * @return The count.
+ */
+static usize_t
+count_of(const std::string &text, const std::string &pattern)
+{
+    usize_t count = 0;
+    for (usize_t at = text.find(pattern); at != std::string::npos;
+         at = text.find(pattern, at + 1))
+    {
+        ++count;
+    }
+    return count;
+}
+
+/**
+ * @test Test case for spans of several threads.
+ *
+ * This test records spans from several threads, some while tracing is
+ * stopped, and checks that exactly those recorded while it runs end up in
+ * the file, each with the number of its thread, and that the file is a
+ * complete JSON array.
+ */
+TEST(trace, threads)
+{
+    std::string  path = testing::TempDir() + "liquid_trace_threads.json";
+    trace_file_t file;
+    ASSERT_TRUE(trace_file_open(&file, path.c_str()));
+
+    int runs = 0;
+    TRACE_SCOPE("test.untraced")
+    {
+        ++runs;
+    }
+    EXPECT_EQ(runs, 1);
+
+    trace_start();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([] {
+            for (int i = 0; i < 1000; ++i)
+            {
+                TRACE_SCOPE("test.span")
+                {
+                    std::this_thread::yield();
+                }
+            }
+            trace_thread_exit();
+        });
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_TRUE(trace_file_flush(&file));
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    trace_stop();
+    TRACE_SCOPE("test.untraced")
+    {
+        ++runs;
+    }
+    ASSERT_TRUE(trace_file_close(&file));
+
+    std::string json = read_file(path);
+    std::remove(path.c_str());
+    EXPECT_EQ(json.front(), '[');
+    EXPECT_EQ(json.substr(json.size() - 3), "\n]\n");
+    EXPECT_EQ(count_of(json, "{\"name\":\"test.span\",\"ph\":\"X\",\"ts\":"),
+              4000u);
+    EXPECT_EQ(count_of(json, "test.untraced"), 0u);
+
+    std::set<std::string> tids;
+    for (usize_t at = json.find("test.span"); at != std::string::npos;
+         at = json.find("test.span", at + 1))
+    {
+        usize_t tid = json.find("\"tid\":", at);
+        tids.insert(json.substr(tid, json.find('}', tid) - tid));
+    }
+    EXPECT_EQ(tids.size(), 4u);
+}
+
+/**
+ * @test Test case for threads exiting without letting their buffer go.
+ *
+ * This test records spans from threads that exit without calling
+ * trace_thread_exit and checks that their events are still written, by a
+ * flush after the threads are gone.
+ */
+TEST(trace, thread_exit)
+{
+    std::string  path = testing::TempDir() + "liquid_trace_exit.json";
+    trace_file_t file;
+    ASSERT_TRUE(trace_file_open(&file, path.c_str()));
+
+    trace_start();
+    for (int round = 0; round < 2; ++round)
+    {
+        std::thread thread([] {
+            for (int i = 0; i < 10; ++i)
+            {
+                TRACE_SCOPE("test.exit_thread")
+                {
+                }
+            }
+        });
+        thread.join();
+        EXPECT_TRUE(trace_file_flush(&file));
+    }
+    trace_stop();
+    ASSERT_TRUE(trace_file_close(&file));
+
+    std::string json = read_file(path);
+    std::remove(path.c_str());
+    EXPECT_EQ(count_of(json, "\"test.exit_thread\""), 20u);
+}
+
+/**
+ * @test Test case for full buffers.
+ *
+ * This test records more spans than a buffer holds without flushing, and
+ * checks that the excess is dropped and counted while the rest is kept.
+ */
+TEST(trace, dropped)
+{
+    std::string  path = testing::TempDir() + "liquid_trace_dropped.json";
+    trace_file_t file;
+    ASSERT_TRUE(trace_file_open(&file, path.c_str()));
+    ASSERT_TRUE(trace_file_flush(&file));
+
+    ullong_t dropped = trace_dropped();
+    trace_start();
+    for (int i = 0; i < TRACE_BUFFER_EVENTS + 100; ++i)
+    {
+        TRACE_SCOPE("test.full")
+        {
+        }
+    }
+    trace_stop();
+    EXPECT_EQ(trace_dropped() - dropped, 100u);
+    ASSERT_TRUE(trace_file_close(&file));
+
+    std::string json = read_file(path);
+    std::remove(path.c_str());
+    EXPECT_EQ(count_of(json, "\"test.full\""), (usize_t)TRACE_BUFFER_EVENTS);
+}
+
+/**
+ * @brief Returns from inside a span.
+ * @param runs Counts the runs of the span.
+ */
+static void
+return_from_scope(int *runs)
+{
+    TRACE_SCOPE("test.return")
+    {
+        ++*runs;
+        return;
+    }
+}
+
+/**
+ * @test Test case for leaving a span early.
+ *
+ * This test checks that break and continue leave the span and not the loop
+ * around it, and, with compilers that end spans going out of scope, that
+ * a span left by break or return is still recorded.
+ */
+TEST(trace, scope_exits)
+{
+    std::string  path = testing::TempDir() + "liquid_trace_exits.json";
+    trace_file_t file;
+    ASSERT_TRUE(trace_file_open(&file, path.c_str()));
+
+    trace_start();
+    int runs = 0, rest = 0, iterations = 0;
+    for (int i = 0; i < 4; ++i, ++iterations)
+    {
+        TRACE_SCOPE("test.exit")
+        {
+            ++runs;
+            if (i == 1)
+            {
+                continue;
+            }
+            if (i == 2)
+            {
+                break;
+            }
+            ++rest;
+        }
+    }
+    return_from_scope(&runs);
+    trace_stop();
+    ASSERT_TRUE(trace_file_close(&file));
+    EXPECT_EQ(iterations, 4);
+    EXPECT_EQ(runs, 5);
+    EXPECT_EQ(rest, 2);
+
+    std::string json = read_file(path);
+    std::remove(path.c_str());
+#if defined(__GNUC__) || defined(__clang__)
+    EXPECT_EQ(count_of(json, "\"test.exit\""), 4u);
+    EXPECT_EQ(count_of(json, "\"test.return\""), 1u);
+#else
+    EXPECT_EQ(count_of(json, "\"test.exit\""), 3u);
+    EXPECT_EQ(count_of(json, "\"test.return\""), 0u);
+#endif
+}
+
+/**
+ * @test Test case for the spans of the library.
+ *
+ * This test writes and reads a file while tracing and checks that the I/O
+ * of the library shows up in the trace.
+ */
+TEST(trace, library)
+{
+    std::string  path = testing::TempDir() + "liquid_trace_library.json";
+    std::string  data = testing::TempDir() + "liquid_trace_data";
+    trace_file_t file;
+    ASSERT_TRUE(trace_file_open(&file, path.c_str()));
+
+    trace_start();
+    fs_handle_t handle;
+    char        buffer[64] = "traced";
+    ASSERT_TRUE(fs_open(&handle, data.c_str(),
+                        FS_WRITE | FS_CREATE | FS_TRUNCATE));
+    EXPECT_TRUE(fs_write(handle, buffer, sizeof(buffer)));
+    fs_close(handle);
+    ASSERT_TRUE(fs_open(&handle, data.c_str(), FS_READ));
+    usize_t count;
+    EXPECT_TRUE(fs_read(handle, buffer, sizeof(buffer), &count));
+    fs_close(handle);
+    trace_stop();
+    std::remove(data.c_str());
+    ASSERT_TRUE(trace_file_close(&file));
+
+    std::string json = read_file(path);
+    std::remove(path.c_str());
+    EXPECT_GE(count_of(json, "\"liquid.fs.write\""), 1u);
+    EXPECT_EQ(count_of(json, "\"liquid.fs.read\""), 1u);
+}
@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+#include <liquid/utf.h>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Reference validator that decodes one sequence at a time.
+ * @param text The text to validate.
+ * @return Offset of the first malformed sequence, or npos if valid.
+ */
+static std::size_t
+reference_invalid_pos(const std::string &text)
+{
+    std::size_t i = 0;
+    while (i < text.size())
+    {
+        unsigned char lead = text[i];
+        std::size_t   count = lead < 0x80   ? 0
+                              : lead < 0xC2 ? 4
+                              : lead < 0xE0 ? 1
+                              : lead < 0xF0 ? 2
+                              : lead < 0xF5 ? 3
+                                            : 4;
+        if (count == 4 || text.size() - i - 1 < count)
+        {
+            return i;
+        }
+
+        unsigned int value = lead & (0x7F >> count);
+        for (std::size_t j = 1; j <= count; ++j)
+        {
+            unsigned char next = text[i + j];
+            if ((next & 0xC0) != 0x80)
+            {
+                return i;
+            }
+            value = (value << 6) | (next & 0x3F);
+        }
+
+        const unsigned int min[] = {0, 0x80, 0x800, 0x10000};
+        if (value < min[count] || value > 0x10FFFF
+            || (value >= 0xD800 && value <= 0xDFFF))
+        {
+            return i;
+        }
+        i += count + 1;
+    }
+    return std::string::npos;
+}
+
+/**
+ * @brief Finds the first malformed sequence with the library.
+ * @param text The text to validate.
+ * @return Offset of the first malformed sequence, or npos if valid.
+ */
+static std::size_t
+invalid_pos(const std::string &text)
+{
+    const char *pos = utf8_invalid_pos(text.data(), text.data() + text.size());
+    return pos ? pos - text.data() : std::string::npos;
+}
+
+/**
+ * @test Test case for validating well-formed and malformed text.
+ *
+ * This test places every kind of malformed sequence at all offsets of a
+ * long ASCII text, so that it is found inside and across vector blocks.
+ */
+TEST(utf, validation)
+{
+    const std::string valid = "a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80z";
+    const std::string invalid[] = {
+        "\x80",             // Stray continuation.
+        "\xC0\xAF",         // Overlong ASCII.
+        "\xE0\x80\xAF",     // Overlong three byte form.
+        "\xF0\x80\x80\xAF", // Overlong four byte form.
+        "\xED\xA0\x80",     // Encoded surrogate.
+        "\xF4\x90\x80\x80", // Above U+10FFFF.
+        "\xF5\x80\x80\x80", // Invalid lead.
+        "\xE2\x82",         // Truncated sequence.
+        "\xC3\xA9\xA9",     // Extra continuation.
+    };
+
+    EXPECT_TRUE(utf8_is_valid(valid.data(), valid.data() + valid.size()));
+
+    for (std::size_t offset = 0; offset < 40; ++offset)
+    {
+        std::string text = std::string(offset, 'x') + valid + valid;
+        EXPECT_EQ(invalid_pos(text + std::string(40, 'y')), std::string::npos);
+
+        for (const std::string &bad : invalid)
+        {
+            std::string broken = text + bad;
+            EXPECT_EQ(invalid_pos(broken), reference_invalid_pos(broken));
+            EXPECT_NE(invalid_pos(broken), std::string::npos);
+
+            broken += std::string(40, 'y');
+            EXPECT_EQ(invalid_pos(broken), reference_invalid_pos(broken));
+        }
+    }
+}
+
+/**
+ * @test Test case for validating random byte sequences.
+ *
+ * This test compares the position reported for random mixtures of valid
+ * code points and random bytes against a straightforward decoder.
+ */
+TEST(utf, validation_random)
+{
+    std::mt19937 rng(2024);
+    const char  *pieces[] = {"a", "\xC3\xA9", "\xE2\x82\xAC",
+                             "\xF0\x9F\x98\x80", "0123456789abcdef"};
+
+    for (int i = 0; i < 2000; ++i)
+    {
+        std::string text;
+        std::size_t len = rng() % 200;
+        while (text.size() < len)
+        {
+            text += pieces[rng() % 5];
+        }
+        if (!text.empty() && rng() % 2)
+        {
+            text[rng() % text.size()] = (char)(rng() & 0xFF);
+        }
+
+        EXPECT_EQ(invalid_pos(text), reference_invalid_pos(text));
+    }
+}
+
+/**
+ * @test Test case for conversions between UTF-8, UTF-16 and UTF-32.
+ *
+ * This test checks that precomputed lengths match the converted output
+ * and that converting back restores the original text.
+ */
+TEST(utf, round_trip)
+{
+    const std::string text = "plain ascii text, caf\xC3\xA9, 20\xE2\x82\xAC, "
+                             "\xF0\x9F\x98\x80 and more ascii at the end";
+    const char       *begin = text.data();
+    const char       *end = begin + text.size();
+
+    std::vector<ushort_t> utf16(utf8_utf16_len(begin, end));
+    ushort_t *utf16_end = utf8_to_utf16(utf16.data(), utf16.size(), begin, end);
+    ASSERT_EQ(utf16_end, utf16.data() + utf16.size());
+    EXPECT_EQ(utf16[21], 0xE9);
+    EXPECT_EQ(utf16_utf8_len(utf16.data(), utf16_end), text.size());
+
+    std::vector<uint_t> utf32(utf8_utf32_len(begin, end));
+    uint_t *utf32_end = utf8_to_utf32(utf32.data(), utf32.size(), begin, end);
+    ASSERT_EQ(utf32_end, utf32.data() + utf32.size());
+    EXPECT_EQ(utf16.size(), utf32.size() + 1);
+    EXPECT_EQ(utf32_utf8_len(utf32.data(), utf32_end), text.size());
+
+    std::string back(text.size(), '\0');
+    EXPECT_EQ(utf16_to_utf8(&back[0], back.size(), utf16.data(), utf16_end),
+              &back[0] + back.size());
+    EXPECT_EQ(back, text);
+
+    back.assign(text.size(), '\0');
+    EXPECT_EQ(utf32_to_utf8(&back[0], back.size(), utf32.data(), utf32_end),
+              &back[0] + back.size());
+    EXPECT_EQ(back, text);
+}
+
+/**
+ * @test Test case for conversions between UTF-8 and wide strings.
+ *
+ * This test verifies that the wide variants match the wchar_t literals of
+ * the compiler and reject buffers that are too small.
+ */
+TEST(utf, wide_strings)
+{
+    const std::string  text = "\xC3\xA9t\xC3\xA9 \xF0\x9F\x98\x80";
+    const std::wstring expected = L"été \U0001F600";
+    const char        *begin = text.data();
+    const char        *end = begin + text.size();
+
+    std::wstring wide(utf8_wstr_len(begin, end), L'\0');
+    ASSERT_EQ(wide.size(), expected.size());
+    EXPECT_EQ(utf8_to_wstr(&wide[0], wide.size(), begin, end),
+              &wide[0] + wide.size());
+    EXPECT_EQ(wide, expected);
+
+    const wchar_t *wide_end = wide.data() + wide.size();
+    std::string    narrow(wstr_utf8_len(wide.data(), wide_end), '\0');
+    EXPECT_EQ(wstr_to_utf8(&narrow[0], narrow.size(), wide.data(), wide_end),
+              &narrow[0] + narrow.size());
+    EXPECT_EQ(narrow, text);
+
+    EXPECT_EQ(wstr_to_utf8(&narrow[0], narrow.size() - 1, wide.data(),
+                           wide_end),
+              nullptr);
+}
+
+/**
+ * @test Test case for converting malformed text.
+ *
+ * This test checks that unpaired surrogates and invalid code points are
+ * rejected instead of being converted.
+ */
+TEST(utf, malformed_conversion)
+{
+    const ushort_t unpaired[] = {'a', 0xD800, 'b'};
+    const ushort_t swapped[] = {0xDC00, 0xD800};
+    const uint_t   too_large[] = {0x110000};
+    const uint_t   surrogate[] = {0xDFFF};
+    const char     overlong[] = "\xC0\x80";
+    char           buffer[16];
+    ushort_t       units[16];
+
+    EXPECT_EQ(utf16_to_utf8(buffer, sizeof(buffer), unpaired, unpaired + 3),
+              nullptr);
+    EXPECT_EQ(utf16_to_utf8(buffer, sizeof(buffer), swapped, swapped + 2),
+              nullptr);
+    EXPECT_EQ(utf32_to_utf8(buffer, sizeof(buffer), too_large, too_large + 1),
+              nullptr);
+    EXPECT_EQ(utf32_to_utf8(buffer, sizeof(buffer), surrogate, surrogate + 1),
+              nullptr);
+    EXPECT_EQ(utf8_to_utf16(units, 16, overlong, overlong + 2), nullptr);
+}
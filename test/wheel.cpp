@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <liquid/wheel.h>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The state shared with the callbacks of a test.
+ */
+struct expiry_record
+{
+    std::vector<std::pair<ullong_t, int>> fired;   ///< The ticks and ids.
+    usize_t                               late = 0; ///< Timers called late.
+};
+
+/**
+ * @brief Records the expiry of a timer and checks that it happens at the
+ *        tick of its expiry.
+ *
+ * @param wheel The wheel, its data points to the record.
+ * @param timer The timer, its data points to its id.
+ */
+static void
+on_timer(wheel_t *wheel, wheel_timer_t *timer)
+{
+    expiry_record *rec = static_cast<expiry_record *>(wheel->data);
+    rec->fired.emplace_back(timer->expiry, *static_cast<int *>(timer->data));
+    rec->late += timer->expiry != wheel->tick;
+}
+
+/**
+ * @test Test case for the order of expiry.
+ *
+ * This test starts timers on every level of the wheel, restarts and stops
+ * some of them and checks that they expire in order at their ticks, with
+ * a single advance and with steps that double.
+ */
+TEST(wheel, order)
+{
+    const ullong_t timeouts[] = {
+        5,           1,           WHEEL_SLOTS,     WHEEL_SLOTS + 1,
+        4096 + 7,    1ull << 20,  (1ull << 33) + 5, 1ull << 62,
+        WHEEL_NEVER, 63,          64 * 64 * 64 - 1, 2};
+    const int count = sizeof(timeouts) / sizeof(timeouts[0]);
+
+    for (ullong_t origin : {0ull, 1000ull, (1ull << 40) - 3})
+    {
+        for (ullong_t step : {1ull << 63, 1ull, 977ull})
+        {
+            wheel_t       wheel;
+            expiry_record rec;
+            wheel_init(&wheel, nullptr, origin);
+            wheel.data = &rec;
+
+            std::vector<int>           ids(count);
+            std::vector<wheel_timer_t> timers(count);
+            for (int i = 0; i < count; ++i)
+            {
+                ids[i] = i;
+                wheel_timer_init(&timers[i], on_timer, &ids[i]);
+                wheel_timer_start(&wheel, &timers[i], timeouts[i]);
+            }
+            wheel_timer_start(&wheel, &timers[0], 3);
+            wheel_timer_stop(&wheel, &timers[1]);
+            EXPECT_FALSE(wheel_timer_active(&timers[1]));
+            EXPECT_EQ(wheel.count, (usize_t)count - 1);
+
+            usize_t  expired = 0;
+            ullong_t now = origin;
+            while (wheel.count > 1)
+            {
+                now = step < WHEEL_NEVER - 1 - now ? now + step
+                                                   : WHEEL_NEVER - 1;
+                step = step < 1ull << 63 ? step * 2 : step;
+                expired += wheel_advance(&wheel, now);
+            }
+            EXPECT_EQ(expired, rec.fired.size());
+            EXPECT_EQ(rec.late, 0u);
+            EXPECT_TRUE(std::is_sorted(rec.fired.begin(), rec.fired.end()));
+            for (auto &fired : rec.fired)
+            {
+                EXPECT_NE(fired.second, 1);
+                EXPECT_LE(fired.first, now);
+            }
+            EXPECT_EQ(rec.fired.front(), std::make_pair(origin + 2, 11));
+            EXPECT_EQ(rec.fired[1], std::make_pair(origin + 3, 0));
+            wheel_free(&wheel);
+        }
+    }
+}
+
+/**
+ * @brief Restarts a timer a number of times from its callback.
+ * @param wheel The wheel.
+ * @param timer The timer, its data points to the remaining restarts.
+ */
+static void
+on_periodic(wheel_t *wheel, wheel_timer_t *timer)
+{
+    int *left = static_cast<int *>(timer->data);
+    if (--*left > 0)
+    {
+        wheel_timer_start(wheel, timer, 0);
+    }
+}
+
+/**
+ * @brief Releases a pooled timer from its callback.
+ * @param wheel The wheel.
+ * @param timer The timer.
+ */
+static void
+on_delete(wheel_t *wheel, wheel_timer_t *timer)
+{
+    ++*static_cast<int *>(wheel->data);
+    wheel_timer_delete(wheel, timer);
+}
+
+/**
+ * @test Test case for callbacks that start and release timers.
+ *
+ * This test restarts a timer with a timeout of 0 from its callback, which
+ * expires once per advance, and releases pooled timers from theirs.
+ */
+TEST(wheel, callbacks)
+{
+    wheel_t wheel;
+    int     deleted = 0;
+    wheel_init(&wheel, nullptr, 0);
+    wheel.data = &deleted;
+
+    int           left = 3;
+    wheel_timer_t periodic;
+    wheel_timer_init(&periodic, on_periodic, &left);
+    wheel_timer_start(&wheel, &periodic, 0);
+    EXPECT_EQ(wheel_advance(&wheel, 100), 1u);
+    EXPECT_EQ(wheel_advance(&wheel, 100), 0u);
+    EXPECT_EQ(wheel_advance(&wheel, 101), 1u);
+    EXPECT_EQ(wheel_advance(&wheel, 500), 1u);
+    EXPECT_EQ(left, 0);
+    EXPECT_FALSE(wheel_timer_active(&periodic));
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        wheel_timer_t *timer = wheel_timer_new(&wheel, on_delete, nullptr);
+        ASSERT_NE(timer, nullptr);
+        wheel_timer_start(&wheel, timer, (ullong_t)i * 37 % 5000);
+    }
+    EXPECT_EQ(wheel_advance(&wheel, 2500), 4002u);
+    EXPECT_EQ(wheel_advance(&wheel, 10000), 5998u);
+    EXPECT_EQ(deleted, 10000);
+    EXPECT_EQ(wheel.count, 0u);
+    wheel_free(&wheel);
+}
+
+/**
+ * @test Test case for the delay until the next advance.
+ *
+ * This test checks that the delay is exact on the lowest level and never
+ * beyond the expiry on the others.
+ */
+TEST(wheel, next)
+{
+    wheel_t       wheel;
+    expiry_record rec;
+    wheel_init(&wheel, nullptr, 10);
+    wheel.data = &rec;
+    EXPECT_EQ(wheel_next(&wheel), WHEEL_NEVER);
+
+    int           id = 0;
+    wheel_timer_t timer;
+    wheel_timer_init(&timer, on_timer, &id);
+    wheel_timer_start(&wheel, &timer, 20);
+    EXPECT_EQ(wheel_next(&wheel), 20u);
+
+    wheel_timer_start(&wheel, &timer, 100000);
+    ullong_t steps = 0;
+    while (wheel_timer_active(&timer))
+    {
+        ullong_t next = wheel_next(&wheel);
+        ASSERT_GT(next, 0u);
+        ASSERT_LE(wheel.now + next, 100010u);
+        wheel_advance(&wheel, wheel.now + next);
+        ++steps;
+    }
+    EXPECT_EQ(wheel.now, 100010u);
+    EXPECT_LE(steps, (ullong_t)WHEEL_LEVELS);
+    EXPECT_EQ(wheel_next(&wheel), WHEEL_NEVER);
+    wheel_free(&wheel);
+}
+
+/**
+ * @test Test case for the last tick.
+ *
+ * This test advances a wheel to WHEEL_NEVER, which expires the timers up
+ * to it and returns, and starts a timer once the wheel is there, which can
+ * never expire.
+ */
+TEST(wheel, last_tick)
+{
+    wheel_t       wheel;
+    expiry_record rec;
+    wheel_init(&wheel, nullptr, 0);
+    wheel.data = &rec;
+
+    int           ids[] = {0, 1, 2};
+    wheel_timer_t timers[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        wheel_timer_init(&timers[i], on_timer, &ids[i]);
+    }
+    wheel_timer_start(&wheel, &timers[0], 10);
+    wheel_timer_start(&wheel, &timers[1], WHEEL_NEVER);
+    EXPECT_EQ(wheel_advance(&wheel, WHEEL_NEVER), 2u);
+    ASSERT_EQ(rec.fired.size(), 2u);
+    EXPECT_EQ(rec.fired[0], std::make_pair(10ull, 0));
+    EXPECT_EQ(rec.fired[1], std::make_pair(WHEEL_NEVER, 1));
+    EXPECT_EQ(rec.late, 0u);
+    EXPECT_EQ(wheel_next(&wheel), WHEEL_NEVER);
+
+    wheel_timer_start(&wheel, &timers[2], 10);
+    EXPECT_TRUE(wheel_timer_active(&timers[2]));
+    EXPECT_EQ(wheel_next(&wheel), WHEEL_NEVER);
+    EXPECT_EQ(wheel_advance(&wheel, WHEEL_NEVER), 0u);
+    wheel_timer_stop(&wheel, &timers[2]);
+    EXPECT_EQ(wheel.count, 0u);
+    wheel_free(&wheel);
+}
+
+/**
+ * @test Test case for the tick sources.
+ *
+ * This test checks that a tick source starts at 0 and never goes back.
+ */
+TEST(wheel, clock)
+{
+    wheel_clock_t clock;
+    wheel_clock_init(&clock, 1000);
+    ullong_t last = wheel_clock_read(&clock);
+    EXPECT_LT(last, 1000000u);
+    for (int i = 0; i < 100000; ++i)
+    {
+        ullong_t now = wheel_clock_read(&clock);
+        ASSERT_GE(now, last);
+        last = now;
+    }
+    EXPECT_GT(wheel_clock_nanoseconds(), 0u);
+}
+
+/**
+ * @test Test case for random operations.
+ *
+ * This test starts, restarts and stops timers with timeouts of every
+ * magnitude at random, advances by random steps and compares the expired
+ * timers to a reference model.
+ */
+TEST(wheel, random)
+{
+    std::mt19937_64 rng(43);
+    wheel_t         wheel;
+    expiry_record   rec;
+    wheel_init(&wheel, nullptr, rng() >> 20);
+    wheel.data = &rec;
+
+    const int                  count = 2000;
+    std::vector<int>           ids(count);
+    std::vector<wheel_timer_t> timers(count);
+    std::map<int, ullong_t>    running;
+    for (int i = 0; i < count; ++i)
+    {
+        ids[i] = i;
+        wheel_timer_init(&timers[i], on_timer, &ids[i]);
+    }
+
+    for (int round = 0; round < 2000; ++round)
+    {
+        for (int op = 0; op < 20; ++op)
+        {
+            int id = (int)(rng() % count);
+            if (rng() % 4)
+            {
+                ullong_t timeout = rng() >> (rng() % 64);
+                ullong_t expiry = wheel.now + std::max<ullong_t>(timeout, 1);
+                wheel_timer_start(&wheel, &timers[id], timeout);
+                running[id] = expiry < wheel.now ? WHEEL_NEVER : expiry;
+            }
+            else
+            {
+                wheel_timer_stop(&wheel, &timers[id]);
+                running.erase(id);
+            }
+        }
+        ASSERT_EQ(wheel.count, running.size());
+
+        ullong_t now = wheel.now + (rng() >> (rng() % 52 + 12));
+        std::vector<std::pair<ullong_t, int>> expected;
+        for (auto it = running.begin(); it != running.end();)
+        {
+            if (it->second <= now)
+            {
+                expected.emplace_back(it->second, it->first);
+                it = running.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+
+        rec.fired.clear();
+        ASSERT_EQ(wheel_advance(&wheel, now), expected.size());
+        std::sort(rec.fired.begin(), rec.fired.end());
+        ASSERT_EQ(rec.fired, expected);
+    }
+    EXPECT_EQ(rec.late, 0u);
+    wheel_free(&wheel);
+}